@@ -14,6 +14,8 @@
 
 #include "bindings/python/pyiree/rt/function_abi.h"
 
+#include <cstdint>
+
 #include "absl/memory/memory.h"
 #include "absl/strings/str_cat.h"
 #include "absl/types/span.h"
@@ -32,6 +34,10 @@ namespace python {
 
 namespace {
 
+// Minimum alignment of host memory that is wrapped instead of copied. Matches
+// the alignment of IREE host allocations.
+constexpr uintptr_t kMinWrapAlignment = 16;
+
 // Python friendly entry-point for creating an instance from a list
 // of attributes. This is not particularly efficient and is primarily
 // for testing. Typically, this will be created directly from a function
@@ -51,7 +57,7 @@ std::unique_ptr<FunctionAbi> PyCreateAbi(
 
 VmVariantList PyRawPack(FunctionAbi* self,
                         absl::Span<const FunctionAbi::Description> descs,
-                        py::sequence py_args, bool writable) {
+                        py::sequence py_args, bool writable, bool copy) {
   if (py_args.size() != descs.size()) {
     throw RaiseValueError("Mismatched pack arity");
   }
@@ -59,13 +65,21 @@ VmVariantList PyRawPack(FunctionAbi* self,
   VmVariantList f_args = VmVariantList::Create(py_args.size());
   absl::InlinedVector<py::handle, 8> local_py_args(py_args.begin(),
                                                    py_args.end());
-  self->RawPack(descs, absl::MakeSpan(local_py_args), f_args, writable);
+  self->RawPack(descs, absl::MakeSpan(local_py_args), f_args, writable,
+                copy);
   return f_args;
 }
 
 VmVariantList PyAllocateResults(FunctionAbi* self, VmVariantList& f_args,
                                 bool static_alloc) {
   auto f_results = VmVariantList::Create(self->raw_result_arity());
+  // Results may alias arguments (for example if they are returned directly).
+  // Which ones is only known after the invocation, so the result list carries
+  // the memory wrapped by the arguments and RawUnpack keeps alive only the
+  // owners whose memory a result actually aliases.
+  for (const auto& retained_object : f_args.retained_objects()) {
+    f_results.RetainObject(retained_object.object, retained_object.memory);
+  }
   if (static_alloc) {
     // For static dispatch, attempt to fully allocate and perform shape
     // inference.
@@ -87,6 +101,34 @@ py::object PyRawUnpackResults(FunctionAbi* self, VmVariantList& f_args) {
   return py_result_tuple;
 }
 
+// Returns the owners of host memory in |f_results| that |raw_buffer| aliases,
+// or None if it aliases none. Owners of memory that no result aliases are not
+// kept alive beyond the result list.
+py::object GetAliasedMemoryOwners(const VmVariantList& f_results,
+                                  iree_hal_buffer_t* raw_buffer) {
+  if (f_results.retained_objects().empty()) return py::none();
+  iree_device_size_t byte_length = iree_hal_buffer_byte_length(raw_buffer);
+  iree_hal_mapped_memory_t mapped_memory;
+  CheckApiStatus(iree_hal_buffer_map(raw_buffer, IREE_HAL_MEMORY_ACCESS_READ,
+                                     0 /* element_offset */, byte_length,
+                                     &mapped_memory),
+                 "Could not map memory");
+  const uint8_t* begin = mapped_memory.contents.data;
+  const uint8_t* end = begin + mapped_memory.contents.data_length;
+  py::list owners;
+  for (const auto& retained_object : f_results.retained_objects()) {
+    const uint8_t* memory_begin = retained_object.memory.data();
+    const uint8_t* memory_end = memory_begin + retained_object.memory.size();
+    if (begin < memory_end && memory_begin < end) {
+      owners.append(retained_object.object);
+    }
+  }
+  CheckApiStatus(iree_hal_buffer_unmap(raw_buffer, &mapped_memory),
+                 "Could not unmap memory");
+  if (owners.size() == 0) return py::none();
+  return py::tuple(owners);
+}
+
 // RAII wrapper for a Py_buffer which calls PyBuffer_Release when it goes
 // out of scope.
 class PyBufferReleaser {
@@ -111,6 +153,33 @@ pybind11::error_already_set RaiseBufferMismatchError(
   return RaiseValueError(message.c_str());
 }
 
+// Returns the buffer |format| with any native byte order prefix removed and
+// integer codes folded to 'i' (signed) or 'I' (unsigned). Integer codes of the
+// same item size are interchangeable ('l' and 'q' are both 64-bit on most
+// platforms) and callers verify the item size separately.
+std::string NormalizeBufferFormat(absl::string_view format) {
+  if (!format.empty() && (format.front() == '@' || format.front() == '=')) {
+    format.remove_prefix(1);
+  }
+  if (format.size() != 1) return std::string(format);
+  switch (format.front()) {
+    case 'b':
+    case 'h':
+    case 'i':
+    case 'l':
+    case 'q':
+      return "i";
+    case 'B':
+    case 'H':
+    case 'I':
+    case 'L':
+    case 'Q':
+      return "I";
+    default:
+      return std::string(format);
+  }
+}
+
 // Verifies and maps the py buffer shape and layout to the bound argument.
 // Returns false if not compatible.
 void MapBufferAttrs(Py_buffer& py_view,
@@ -140,7 +209,8 @@ void MapBufferAttrs(Py_buffer& py_view,
   const char* f_expected_format =
       kScalarTypePyFormat[static_cast<int>(desc.buffer.scalar_type)];
   if (f_expected_format != nullptr &&
-      strcmp(f_expected_format, py_view.format) != 0) {
+      NormalizeBufferFormat(f_expected_format) !=
+          NormalizeBufferFormat(py_view.format ? py_view.format : "B")) {
     throw RaiseBufferMismatchError(
         absl::StrCat("Mismatched buffer format (received: ", py_view.format,
                      ", expected: ", f_expected_format, "): "),
@@ -221,7 +291,7 @@ std::unique_ptr<FunctionAbi> FunctionAbi::Create(
 
 void FunctionAbi::RawPack(absl::Span<const Description> descs,
                           absl::Span<py::handle> py_args, VmVariantList& f_args,
-                          bool writable) {
+                          bool writable, bool copy) {
   if (descs.size() != py_args.size()) {
     throw RaiseValueError("Mismatched RawPack() input arity");
   }
@@ -230,7 +300,7 @@ void FunctionAbi::RawPack(absl::Span<const Description> descs,
     const Description& desc = descs[i];
     switch (desc.type) {
       case RawSignatureParser::Type::kBuffer:
-        PackBuffer(desc, py_args[i], f_args, writable);
+        PackBuffer(desc, py_args[i], f_args, writable, copy);
         break;
       case RawSignatureParser::Type::kRefObject:
         throw RaisePyError(PyExc_NotImplementedError,
@@ -260,12 +330,13 @@ void FunctionAbi::RawUnpack(absl::Span<const Description> descs,
           throw RaiseValueError("Could not deref result buffer (wrong type?)");
         }
         HalBuffer buffer = HalBuffer::RetainAndCreate(raw_buffer);
+        py::object parent = GetAliasedMemoryOwners(f_results, raw_buffer);
         // TODO(laurenzo): In the case of dynamic dims, the full dims will
         // need to be splied together based on known static dims and dynamic
         // dims from a subsequent result.
         absl::Span<const int> dims = absl::MakeSpan(desc.dims);
         py_results[i] = host_type_factory_->CreateImmediateNdarray(
-            desc.buffer.scalar_type, dims, std::move(buffer));
+            desc.buffer.scalar_type, dims, std::move(buffer), parent);
         break;
       }
       case RawSignatureParser::Type::kRefObject:
@@ -333,7 +404,7 @@ void FunctionAbi::AllocateResults(absl::Span<const Description> descs,
 
 void FunctionAbi::PackBuffer(const RawSignatureParser::Description& desc,
                              py::handle py_arg, VmVariantList& f_args,
-                             bool writable) {
+                             bool writable, bool copy) {
   // Request a view of the buffer (use the raw python C API to avoid some
   // allocation and copying at the pybind level).
   Py_buffer py_view;
@@ -353,10 +424,6 @@ void FunctionAbi::PackBuffer(const RawSignatureParser::Description& desc,
   }
   PyBufferReleaser py_view_releaser(py_view);
 
-  // Whether the py object needs to be retained with the argument.
-  // Should be set to true if directly mapping, false if copied.
-  bool depends_on_pyobject = false;
-
   // Verify compatibility.
   absl::InlinedVector<int, 2> dynamic_dims;
   MapBufferAttrs(py_view, desc, dynamic_dims);
@@ -365,35 +432,65 @@ void FunctionAbi::PackBuffer(const RawSignatureParser::Description& desc,
                        "Dynamic argument dimensions not implemented");
   }
 
-  // Allocate a HalBuffer.
-  // This is hard-coded to C-contiguous right now.
+  // Wrap the memory in place if the device can access host memory directly,
+  // unless a copy was requested. PyBUF_ND guarantees the view is C-contiguous.
+  // Devices that cannot import host memory fail the wrap and the contents are
+  // copied instead.
   // TODO(laurenzo): Expand to other layouts as needed.
-  // TODO(laurenzo): Wrap and retain original buffer (depends_on_pyobject=true).
-  iree_hal_buffer_t* raw_buffer;
-  CheckApiStatus(iree_hal_allocator_allocate_buffer(
-                     device_.allocator(),
-                     static_cast<iree_hal_memory_type_t>(
-                         IREE_HAL_MEMORY_TYPE_HOST_LOCAL |
-                         IREE_HAL_MEMORY_TYPE_DEVICE_VISIBLE),
-                     IREE_HAL_BUFFER_USAGE_ALL, py_view.len, &raw_buffer),
-                 "Failed to allocate device visible buffer");
-  CheckApiStatus(
-      iree_hal_buffer_write_data(raw_buffer, 0, py_view.buf, py_view.len),
-      "Error writing to input buffer");
+  iree_hal_buffer_t* raw_buffer = nullptr;
+  bool depends_on_pyobject = false;
+  if (!copy && py_view.len > 0 &&
+      reinterpret_cast<uintptr_t>(py_view.buf) % kMinWrapAlignment == 0) {
+    auto status = iree_hal_allocator_wrap_buffer(
+        device_.allocator(),
+        static_cast<iree_hal_memory_type_t>(
+            IREE_HAL_MEMORY_TYPE_HOST_LOCAL |
+            IREE_HAL_MEMORY_TYPE_DEVICE_VISIBLE),
+        writable ? IREE_HAL_MEMORY_ACCESS_ALL : IREE_HAL_MEMORY_ACCESS_READ,
+        IREE_HAL_BUFFER_USAGE_ALL,
+        {static_cast<uint8_t*>(py_view.buf),
+         static_cast<iree_host_size_t>(py_view.len)},
+        &raw_buffer);
+    depends_on_pyobject = status == IREE_STATUS_OK;
+  }
+  if (!depends_on_pyobject) {
+    CheckApiStatus(iree_hal_allocator_allocate_buffer(
+                       device_.allocator(),
+                       static_cast<iree_hal_memory_type_t>(
+                           IREE_HAL_MEMORY_TYPE_HOST_LOCAL |
+                           IREE_HAL_MEMORY_TYPE_DEVICE_VISIBLE),
+                       IREE_HAL_BUFFER_USAGE_ALL, py_view.len, &raw_buffer),
+                   "Failed to allocate device visible buffer");
+    CheckApiStatus(
+        iree_hal_buffer_write_data(raw_buffer, 0, py_view.buf, py_view.len),
+        "Error writing to input buffer");
+  }
+
+  // A memoryview holds its own export of the buffer, which keeps the memory
+  // alive and prevents the exporter from resizing it. Create it before the
+  // buffer is added so that failures do not leave a dangling argument.
+  py::object py_memory_owner;
+  if (depends_on_pyobject) {
+    PyObject* memory_view = PyMemoryView_FromObject(py_arg.ptr());
+    if (!memory_view) {
+      iree_hal_buffer_release(raw_buffer);
+      throw py::error_already_set();
+    }
+    py_memory_owner = py::reinterpret_steal<py::object>(memory_view);
+  }
+
   iree_vm_ref_t buffer_ref = iree_hal_buffer_move_ref(raw_buffer);
   CheckApiStatus(
       iree_vm_variant_list_append_ref_move(f_args.raw_ptr(), &buffer_ref),
       "Error moving buffer");
 
-  // Only capture the reference to the exporting object (incrementing it)
-  // once guaranteed successful.
+  // Only capture the reference to the exporting object once guaranteed
+  // successful.
   if (depends_on_pyobject) {
-    // Note for future implementation: there needs to be a place to stash
-    // references to be kept alive which back a buffer. This is likely an
-    // additional bag of refs returned from this function, which can then
-    // be attached to an invocation.
-    throw RaisePyError(PyExc_NotImplementedError,
-                       "Dependent buffer arguments not implemented");
+    f_args.RetainObject(
+        std::move(py_memory_owner),
+        absl::MakeConstSpan(static_cast<const uint8_t*>(py_view.buf),
+                            static_cast<size_t>(py_view.len)));
   }
 }
 
@@ -404,11 +501,12 @@ void SetupFunctionAbiBindings(pybind11::module m) {
       .def_property_readonly("raw_input_arity", &FunctionAbi::raw_input_arity)
       .def_property_readonly("raw_result_arity", &FunctionAbi::raw_result_arity)
       .def("raw_pack_inputs",
-           [](FunctionAbi* self, py::sequence py_args) {
+           [](FunctionAbi* self, py::sequence py_args, bool copy) {
              return PyRawPack(self,
                               absl::MakeConstSpan(self->raw_config().inputs),
-                              py_args, false /* writable */);
-           })
+                              py_args, false /* writable */, copy);
+           },
+           py::arg("py_args"), py::arg("copy") = false)
       .def("allocate_results", &PyAllocateResults, py::arg("f_results"),
            py::arg("static_alloc") = true)
       .def("raw_unpack_results", &PyRawUnpackResults);
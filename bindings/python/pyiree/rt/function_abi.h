@@ -72,9 +72,13 @@ class FunctionAbi {
   // which can be accessed via the non-prefixed Pack/Unpack methods.
   // Given a span of descriptions, packs the given py_args into the span
   // of function args. All spans must be of the same size.
+  // Unless |copy| is set, buffers are wrapped without copying when the device
+  // can access their memory directly, in which case |args| keeps the py_args
+  // alive and they must not be modified until the invocation using |args|
+  // completes. With |copy| the py_args may be modified once this returns.
   void RawPack(absl::Span<const Description> descs,
                absl::Span<py::handle> py_args, VmVariantList& args,
-               bool writable);
+               bool writable, bool copy = false);
 
   // Raw unpacks f_results into py_results.
   // Note that this consumes entries in f_results as needed, leaving them
@@ -102,7 +106,8 @@ class FunctionAbi {
 
  private:
   void PackBuffer(const RawSignatureParser::Description& desc,
-                  py::handle py_arg, VmVariantList& f_args, bool writable);
+                  py::handle py_arg, VmVariantList& f_args, bool writable,
+                  bool copy);
 
   HalDevice device_;
   std::shared_ptr<HostTypeFactory> host_type_factory_;
@@ -15,6 +15,7 @@
 """Tests for the function abi."""
 
 import re
+import sys
 
 from absl.testing import absltest
 
@@ -28,6 +29,13 @@ ATTRS_1ARG_FLOAT32_10X128X64_TO_SINT32_32X8X64_V1 = (
     ("f", "I15!B11!d10d128d64R15!B11!t6d32d8d64"),
 )
 
+ATTRS_1ARG_SINT64_4_TO_UINT8_4_V1 = (
+    ("fv", "1"),
+    # Equiv to:
+    # (Buffer<sint64[4]>) -> (Buffer<uint8[4]>)
+    ("f", "I8!B5!t7d4R8!B5!t8d4"),
+)
+
 ATTRS_1ARG_FLOAT32_DYNX128X64_TO_SINT32_DYNX8X64_V1 = (
     ("fv", "1"),
     # Equiv to:
@@ -72,10 +80,21 @@ class FunctionAbiTest(absltest.TestCase):
     print(packed)
     self.assertEqual("<VmVariantList(1): [HalBuffer(327680)]>", repr(packed))
 
+  def test_static_arg_copy(self):
+    fabi = rt.FunctionAbi(self.device, self.htf,
+                          ATTRS_1ARG_FLOAT32_10X128X64_TO_SINT32_32X8X64_V1)
+    arg = np.zeros((10, 128, 64), dtype=np.float32)
+    refcount = sys.getrefcount(arg)
+    packed = fabi.raw_pack_inputs([arg], copy=True)
+    self.assertEqual("<VmVariantList(1): [HalBuffer(327680)]>", repr(packed))
+    # Copied arguments are not retained by the packed list.
+    self.assertEqual(refcount, sys.getrefcount(arg))
+
   def test_static_result_success(self):
     fabi = rt.FunctionAbi(self.device, self.htf,
                           ATTRS_1ARG_FLOAT32_10X128X64_TO_SINT32_32X8X64_V1)
     arg = np.zeros((10, 128, 64), dtype=np.float32)
+    refcount = sys.getrefcount(arg)
     f_args = fabi.raw_pack_inputs([arg])
     f_results = fabi.allocate_results(f_args)
     print(f_results)
@@ -83,6 +102,20 @@ class FunctionAbiTest(absltest.TestCase):
     py_result, = fabi.raw_unpack_results(f_results)
     self.assertEqual(np.int32, py_result.dtype)
     self.assertEqual((32, 8, 64), py_result.shape)
+    # The result does not alias the argument and so does not retain it.
+    del f_args, f_results
+    self.assertEqual(refcount, sys.getrefcount(arg))
+
+  def test_integer_formats(self):
+    fabi = rt.FunctionAbi(self.device, self.htf,
+                          ATTRS_1ARG_SINT64_4_TO_UINT8_4_V1)
+    arg = np.zeros((4,), dtype=np.int64)
+    f_args = fabi.raw_pack_inputs([arg])
+    self.assertEqual("<VmVariantList(1): [HalBuffer(32)]>", repr(f_args))
+    f_results = fabi.allocate_results(f_args)
+    py_result, = fabi.raw_unpack_results(f_results)
+    self.assertEqual(np.uint8, py_result.dtype)
+    self.assertEqual((4,), py_result.shape)
 
   def test_dynamic_alloc_result_success(self):
     fabi = rt.FunctionAbi(self.device, self.htf,
@@ -29,14 +29,14 @@ const std::array<const char*, static_cast<unsigned>(
                                   1>
     kScalarTypePyFormat = {
         "f",      // kIeeeFloat32 = 0,
-        nullptr,  // kIeeeFloat16 = 1,
+        "e",      // kIeeeFloat16 = 1,
         "d",      // kIeeeFloat64 = 2,
         nullptr,  // kGoogleBfloat16 = 3,
         "b",      // kSint8 = 4,
         "h",      // kSint16 = 5,
         "i",      // kSint32 = 6,
         "q",      // kSint64 = 7,
-        "c",      // kUint8 = 8,
+        "B",      // kUint8 = 8,
         "H",      // kUint16 = 9,
         "I",      // kUint32 = 10,
         "Q",      // kUint64 = 11,
@@ -87,8 +87,9 @@ class PyMappedMemory {
   };
 
   PyMappedMemory(Description desc, iree_hal_mapped_memory_t mapped_memory,
-                 HalBuffer buffer)
+                 HalBuffer buffer, py::object parent)
       : desc_(std::move(desc)),
+        parent_(std::move(parent)),
         mapped_memory_(mapped_memory),
         buf_(std::move(buffer)) {}
   ~PyMappedMemory() {
@@ -98,12 +99,16 @@ class PyMappedMemory {
     }
   }
   PyMappedMemory(PyMappedMemory&& other)
-      : mapped_memory_(other.mapped_memory_), buf_(std::move(other.buf_)) {}
+      : desc_(std::move(other.desc_)),
+        parent_(std::move(other.parent_)),
+        mapped_memory_(other.mapped_memory_),
+        buf_(std::move(other.buf_)) {}
 
   const Description& desc() const { return desc_; }
 
   static std::unique_ptr<PyMappedMemory> Read(Description desc,
-                                              HalBuffer buffer) {
+                                              HalBuffer buffer,
+                                              py::object parent) {
     iree_device_size_t byte_length =
         iree_hal_buffer_byte_length(buffer.raw_ptr());
     iree_hal_mapped_memory_t mapped_memory;
@@ -112,7 +117,8 @@ class PyMappedMemory {
                        0 /* element_offset */, byte_length, &mapped_memory),
                    "Could not map memory");
     return absl::make_unique<PyMappedMemory>(std::move(desc), mapped_memory,
-                                             std::move(buffer));
+                                             std::move(buffer),
+                                             std::move(parent));
   }
 
   py::buffer_info ToBufferInfo() {
@@ -127,6 +133,8 @@ class PyMappedMemory {
 
  private:
   Description desc_;
+  // Released after the buffer, which may alias its memory.
+  py::object parent_;
   iree_hal_mapped_memory_t mapped_memory_;
   HalBuffer buf_;
 };
@@ -134,12 +142,14 @@ class PyMappedMemory {
 class NumpyHostTypeFactory : public HostTypeFactory {
   py::object CreateImmediateNdarray(AbiConstants::ScalarType element_type,
                                     absl::Span<const int> dims,
-                                    HalBuffer buffer) override {
+                                    HalBuffer buffer,
+                                    py::object parent) override {
     auto mapped_memory = PyMappedMemory::Read(
         PyMappedMemory::Description::ForNdarray(element_type, dims),
-        std::move(buffer));
+        std::move(buffer), std::move(parent));
     // Since an immediate ndarray was requested, we can just return a native
     // ndarray directly (versus a proxy that needs to lazily map on access).
+    // The ndarray is a view of the mapped memory and does not copy.
     auto buffer_info = mapped_memory->ToBufferInfo();
     auto py_mapped_memory = py::cast(mapped_memory.release(),
                                      py::return_value_policy::take_ownership);
@@ -162,7 +172,7 @@ std::shared_ptr<HostTypeFactory> HostTypeFactory::GetNumpyFactory() {
 
 py::object HostTypeFactory::CreateImmediateNdarray(
     AbiConstants::ScalarType element_type, absl::Span<const int> dims,
-    HalBuffer buffer) {
+    HalBuffer buffer, py::object parent) {
   throw RaisePyError(PyExc_NotImplementedError,
                      "CreateImmediateNdarray not implemented");
 }
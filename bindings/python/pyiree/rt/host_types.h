@@ -39,10 +39,11 @@ class HostTypeFactory {
 
   // Creates a C-contiguous ndarray of the given element_type/dims and backed
   // by the given buffer. The resulting array has no synchronization and is
-  // available for use immediately.
+  // available for use immediately. |parent| is kept alive by the array and
+  // must own any host memory the buffer may alias.
   virtual py::object CreateImmediateNdarray(
       AbiConstants::ScalarType element_type, absl::Span<const int> dims,
-      HalBuffer buffer);
+      HalBuffer buffer, py::object parent);
 
   // TODO(laurenzo): Add a CreateDelayedNdarray() which is conditioned on
   // a semaphore. This is actually what should be used for async results.
@@ -25,8 +25,10 @@ and functions.
 
 __all__ = ["load_module", "load_modules", "Config", "SystemContext"]
 
+from concurrent import futures
 import os
 import sys
+import threading
 
 from typing import Optional, Sequence, Tuple
 
@@ -109,8 +111,28 @@ def _get_global_config():
   return _global_config
 
 
+_default_executor = None
+_default_executor_lock = threading.Lock()
+
+
+def _get_default_executor() -> futures.Executor:
+  """Returns the executor used by BoundFunction.call_async by default."""
+  global _default_executor
+  with _default_executor_lock:
+    if _default_executor is None:
+      _default_executor = futures.ThreadPoolExecutor(
+          thread_name_prefix="iree_invoke")
+    return _default_executor
+
+
 class BoundFunction:
-  """Wraps a VmFunction, VmContext and ABI into a pythonic function."""
+  """Wraps a VmFunction, VmContext and ABI into a pythonic function.
+
+  Calls may be made concurrently from multiple threads: each call packs its
+  own arguments and results and the GIL is released while the function
+  executes. Calls against the same SystemContext execute one at a time; load
+  the module into one SystemContext per worker to execute in parallel.
+  """
 
   def __init__(self, context: "SystemContext",
                vm_function: _binding.VmFunction):
@@ -119,10 +141,26 @@ class BoundFunction:
     self._abi = context.create_function_abi(vm_function)
 
   def __call__(self, *args):
-    # NOTE: This is just doing sync dispatch right now. In the future,
-    # this should default to async and potentially have some kind of policy
-    # flag that can allow it to be overriden.
     inputs = self._abi.raw_pack_inputs(args)
+    return self._invoke(inputs)
+
+  def call_async(self,
+                 *args,
+                 executor: Optional[futures.Executor] = None
+                ) -> futures.Future:
+    """Invokes the function on an executor and returns a future of its results.
+
+    Arguments are packed before returning so they may be modified once this
+    returns. If no executor is given a shared thread pool is used.
+    """
+    # Unlike synchronous calls, the caller keeps running while the function
+    # executes, so arguments are always copied rather than used in place.
+    inputs = self._abi.raw_pack_inputs(args, copy=True)
+    if executor is None:
+      executor = _get_default_executor()
+    return executor.submit(self._invoke, inputs)
+
+  def _invoke(self, inputs):
     results = self._abi.allocate_results(inputs, static_alloc=False)
     self._context._vm_context.invoke(self._vm_function, inputs, results)
     unpacked_results = self._abi.raw_unpack_results(results)
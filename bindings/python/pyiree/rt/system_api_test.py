@@ -15,6 +15,7 @@
 
 # pylint: disable=unused-variable
 
+from concurrent import futures
 import re
 
 from absl.testing import absltest
@@ -92,6 +93,28 @@ class SystemApiTest(absltest.TestCase):
     results = f(arg0, arg1)
     np.testing.assert_allclose(results, [4., 10., 18., 28.])
 
+  def test_async_invoke(self):
+    arithmetic = rt.load_module(create_simple_mul_module())
+    arg0 = np.array([1., 2., 3., 4.], dtype=np.float32)
+    arg1 = np.array([4., 5., 6., 7.], dtype=np.float32)
+    future = arithmetic.simple_mul.call_async(arg0, arg1)
+    # Arguments are captured when the call is made.
+    arg0[:] = 0.
+    np.testing.assert_allclose(future.result(), [4., 10., 18., 28.])
+
+  def test_concurrent_invoke(self):
+    arithmetic = rt.load_module(create_simple_mul_module())
+    arg1 = np.array([4., 5., 6., 7.], dtype=np.float32)
+
+    def invoke(i):
+      arg0 = np.full(4, i, dtype=np.float32)
+      return arithmetic.simple_mul(arg0, arg1)
+
+    with futures.ThreadPoolExecutor(max_workers=4) as executor:
+      all_results = list(executor.map(invoke, range(16)))
+    for i, results in enumerate(all_results):
+      np.testing.assert_allclose(results, arg1 * i)
+
   def test_load_module(self):
     arithmetic = rt.load_module(create_simple_mul_module())
     arg0 = np.array([1., 2., 3., 4.], dtype=np.float32)
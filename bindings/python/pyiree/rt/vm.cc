@@ -14,7 +14,11 @@
 
 #include "bindings/python/pyiree/rt/vm.h"
 
+#include <memory>
+
+#include "absl/container/flat_hash_map.h"
 #include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/optional.h"
 #include "bindings/python/pyiree/common/status_utils.h"
 #include "bindings/python/pyiree/rt/function_abi.h"
@@ -36,6 +40,34 @@ VmModule CreateHalModule(HalDevice* device) {
   return VmModule::CreateRetained(module);
 }
 
+// Returns the mutex serializing invocations against |context|.
+// Wrappers are created for contexts in several places (such as when a context
+// is retained from Python more than once) so the mutex is keyed by the
+// underlying context instead of being owned by a wrapper. It lives for as long
+// as any invocation holds it.
+std::shared_ptr<absl::Mutex> GetInvokeMutex(iree_vm_context_t* context) {
+  static auto* registry_mutex = new absl::Mutex();
+  static auto* registry =
+      new absl::flat_hash_map<iree_vm_context_t*, std::weak_ptr<absl::Mutex>>();
+  absl::MutexLock lock(registry_mutex);
+  auto it = registry->find(context);
+  if (it != registry->end()) {
+    if (auto invoke_mutex = it->second.lock()) return invoke_mutex;
+  }
+  // Drop the entries of contexts with no invocations in flight, as those
+  // contexts may have since been released.
+  for (auto it = registry->begin(); it != registry->end();) {
+    if (it->second.expired()) {
+      registry->erase(it++);
+    } else {
+      ++it;
+    }
+  }
+  auto invoke_mutex = std::make_shared<absl::Mutex>();
+  (*registry)[context] = invoke_mutex;
+  return invoke_mutex;
+}
+
 }  // namespace
 
 //------------------------------------------------------------------------------
@@ -120,9 +152,21 @@ std::unique_ptr<FunctionAbi> VmContext::CreateFunctionAbi(
 
 void VmContext::Invoke(iree_vm_function_t f, VmVariantList& inputs,
                        VmVariantList& outputs) {
-  CheckApiStatus(iree_vm_invoke(raw_ptr(), f, nullptr, inputs.raw_ptr(),
-                                outputs.raw_ptr(), IREE_ALLOCATOR_SYSTEM),
-                 "Error invoking function");
+  auto* context = raw_ptr();
+  auto* raw_inputs = inputs.raw_ptr();
+  auto* raw_outputs = outputs.raw_ptr();
+  iree_status_t status;
+  {
+    // The stack is allocated per invocation by iree_vm_invoke and the variant
+    // lists are owned by the caller, so only the context needs guarding.
+    // The GIL must be reacquired before raising any error.
+    py::gil_scoped_release release;
+    auto invoke_mutex = GetInvokeMutex(context);
+    absl::MutexLock lock(invoke_mutex.get());
+    status = iree_vm_invoke(context, f, nullptr, raw_inputs, raw_outputs,
+                            IREE_ALLOCATOR_SYSTEM);
+  }
+  CheckApiStatus(status, "Error invoking function");
 }
 
 //------------------------------------------------------------------------------
@@ -15,7 +15,11 @@
 #ifndef IREE_BINDINGS_PYTHON_PYIREE_RT_VM_H_
 #define IREE_BINDINGS_PYTHON_PYIREE_RT_VM_H_
 
+#include <memory>
+#include <vector>
+
 #include "absl/types/optional.h"
+#include "absl/types/span.h"
 #include "bindings/python/pyiree/common/binding.h"
 #include "bindings/python/pyiree/rt/host_types.h"
 #include "iree/base/api.h"
@@ -71,7 +75,8 @@ class VmVariantList {
     }
   }
 
-  VmVariantList(VmVariantList&& other) {
+  VmVariantList(VmVariantList&& other)
+      : retained_objects_(std::move(other.retained_objects_)) {
     list_ = other.list_;
     other.list_ = nullptr;
   }
@@ -97,10 +102,27 @@ class VmVariantList {
                    "Error appending to list");
   }
 
+  // A Python object owning host |memory| that is aliased by a buffer.
+  struct RetainedObject {
+    py::object object;
+    absl::Span<const uint8_t> memory;
+  };
+
+  // Keeps |object| alive for as long as the list. Used for Python objects
+  // whose |memory| is aliased by buffers in the list.
+  void RetainObject(py::object object, absl::Span<const uint8_t> memory) {
+    retained_objects_.push_back({std::move(object), memory});
+  }
+  const std::vector<RetainedObject>& retained_objects() const {
+    return retained_objects_;
+  }
+
   std::string DebugString() const;
 
  private:
   VmVariantList(iree_vm_variant_list_t* list) : list_(list) {}
+  // Released after list_ has been freed.
+  std::vector<RetainedObject> retained_objects_;
   iree_vm_variant_list_t* list_;
 };
 
@@ -142,6 +164,11 @@ class VmContext : public ApiRefCounted<VmContext, iree_vm_context_t> {
   int context_id() const { return iree_vm_context_id(raw_ptr()); }
 
   // Synchronously invokes the given function.
+  // The GIL is released while the function executes, including any HAL waits
+  // it performs. Module state is thread-compatible so invocations from
+  // multiple threads against the same context are serialized, even when made
+  // through different VmContext wrappers of it; use separate contexts to
+  // execute in parallel.
   void Invoke(iree_vm_function_t f, VmVariantList& inputs,
               VmVariantList& outputs);
 
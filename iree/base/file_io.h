@@ -17,6 +17,7 @@
 
 #include <string>
 
+#include "absl/strings/string_view.h"
 #include "iree/base/status.h"
 
 namespace iree {
@@ -31,6 +32,10 @@ Status FileExists(const std::string& path);
 // Synchronously reads a file's contents into a string.
 StatusOr<std::string> GetFileContents(const std::string& path);
 
+// Synchronously writes |content| to the file at |path|, replacing any
+// existing file.
+Status SetFileContents(const std::string& path, absl::string_view content);
+
 // Deletes the file at the provided path.
 Status DeleteFile(const std::string& path);
 
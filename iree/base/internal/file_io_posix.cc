@@ -66,6 +66,26 @@ StatusOr<std::string> GetFileContents(const std::string& path) {
   return contents;
 }
 
+Status SetFileContents(const std::string& path, absl::string_view content) {
+  std::unique_ptr<FILE, void (*)(FILE*)> file = {std::fopen(path.c_str(), "wb"),
+                                                 +[](FILE* file) {
+                                                   if (file) fclose(file);
+                                                 }};
+  if (file == nullptr) {
+    return ErrnoToCanonicalStatusBuilder(errno, "Failed to open file",
+                                         IREE_LOC);
+  }
+  if (std::fwrite(content.data(), content.size(), 1, file.get()) != 1) {
+    return ErrnoToCanonicalStatusBuilder(errno, "Failed to write file",
+                                         IREE_LOC);
+  }
+  if (std::fflush(file.get()) != 0) {
+    return ErrnoToCanonicalStatusBuilder(errno, "Failed to flush file",
+                                         IREE_LOC);
+  }
+  return OkStatus();
+}
+
 Status DeleteFile(const std::string& path) {
   if (::remove(path.c_str()) == -1) {
     return ErrnoToCanonicalStatusBuilder(errno, "Failed to delete file",
@@ -0,0 +1,222 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/base/lz4.h"
+
+#include <string.h>
+
+// Shortest match that can be encoded.
+#define IREE_LZ4_MIN_MATCH 4
+// The last 5 bytes of the input are always encoded as literals.
+#define IREE_LZ4_LAST_LITERALS 5
+// The last match must start at least 12 bytes before the end of the input.
+#define IREE_LZ4_MF_LIMIT 12
+// Largest offset that can be encoded in the 16-bit match offset.
+#define IREE_LZ4_MAX_OFFSET 65535
+// Length nibbles of 15 are followed by additional length bytes.
+#define IREE_LZ4_RUN_MASK 15
+
+// Number of bits used to index the compressor match table.
+#define IREE_LZ4_HASH_LOG 12
+
+static inline uint32_t iree_lz4_read32(const uint8_t* p) {
+  uint32_t value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+static inline uint32_t iree_lz4_hash(uint32_t sequence) {
+  return (sequence * 2654435761u) >> (32 - IREE_LZ4_HASH_LOG);
+}
+
+iree_host_size_t iree_lz4_compress_bound(iree_host_size_t source_length) {
+  return source_length + source_length / 255 + 16;
+}
+
+// Writes the extension bytes of a length whose nibble was saturated.
+static bool iree_lz4_write_length(uint8_t** op, const uint8_t* op_end,
+                                  iree_host_size_t length) {
+  for (; length >= 255; length -= 255) {
+    if (*op >= op_end) return false;
+    *(*op)++ = 255;
+  }
+  if (*op >= op_end) return false;
+  *(*op)++ = (uint8_t)length;
+  return true;
+}
+
+// Writes one sequence: a token, |literal_length| literals from |literals| and,
+// if |match_length| is non-zero, the match |offset| and length.
+static bool iree_lz4_write_sequence(uint8_t** op, const uint8_t* op_end,
+                                    const uint8_t* literals,
+                                    iree_host_size_t literal_length,
+                                    uint16_t offset,
+                                    iree_host_size_t match_length) {
+  if (*op >= op_end) return false;
+  uint8_t* token = (*op)++;
+  if (literal_length >= IREE_LZ4_RUN_MASK) {
+    *token = IREE_LZ4_RUN_MASK << 4;
+    if (!iree_lz4_write_length(op, op_end,
+                               literal_length - IREE_LZ4_RUN_MASK)) {
+      return false;
+    }
+  } else {
+    *token = (uint8_t)(literal_length << 4);
+  }
+  if ((iree_host_size_t)(op_end - *op) < literal_length) return false;
+  memcpy(*op, literals, literal_length);
+  *op += literal_length;
+  if (!match_length) return true;
+
+  if (op_end - *op < 2) return false;
+  *(*op)++ = (uint8_t)(offset & 0xFF);
+  *(*op)++ = (uint8_t)(offset >> 8);
+  iree_host_size_t length_code = match_length - IREE_LZ4_MIN_MATCH;
+  if (length_code >= IREE_LZ4_RUN_MASK) {
+    *token |= IREE_LZ4_RUN_MASK;
+    return iree_lz4_write_length(op, op_end, length_code - IREE_LZ4_RUN_MASK);
+  }
+  *token |= (uint8_t)length_code;
+  return true;
+}
+
+iree_status_t iree_lz4_compress(iree_const_byte_span_t source,
+                                iree_byte_span_t target,
+                                iree_host_size_t* out_target_length) {
+  if (!out_target_length) return IREE_STATUS_INVALID_ARGUMENT;
+  *out_target_length = 0;
+
+  const uint8_t* ip = source.data;
+  const uint8_t* anchor = ip;
+  const uint8_t* ip_end = source.data + source.data_length;
+  uint8_t* op = target.data;
+  const uint8_t* op_end = target.data + target.data_length;
+
+  if (source.data_length > IREE_LZ4_MF_LIMIT) {
+    const uint8_t* mf_limit = ip_end - IREE_LZ4_MF_LIMIT;
+    const uint8_t* match_limit = ip_end - IREE_LZ4_LAST_LITERALS;
+    // Positions (relative to the start of |source|) of the most recent
+    // occurrence of each hashed 4-byte sequence.
+    uint32_t match_table[1 << IREE_LZ4_HASH_LOG];
+    memset(match_table, 0, sizeof(match_table));
+    while (ip < mf_limit) {
+      uint32_t sequence = iree_lz4_read32(ip);
+      uint32_t hash = iree_lz4_hash(sequence);
+      const uint8_t* match = source.data + match_table[hash];
+      match_table[hash] = (uint32_t)(ip - source.data);
+      if (match >= ip || ip - match > IREE_LZ4_MAX_OFFSET ||
+          iree_lz4_read32(match) != sequence) {
+        ++ip;
+        continue;
+      }
+
+      // Extend the match forward as far as the format allows.
+      const uint8_t* match_end = ip + IREE_LZ4_MIN_MATCH;
+      match += IREE_LZ4_MIN_MATCH;
+      while (match_end < match_limit && *match_end == *match) {
+        ++match_end;
+        ++match;
+      }
+
+      iree_host_size_t match_length = (iree_host_size_t)(match_end - ip);
+      uint16_t offset = (uint16_t)(match_end - match);
+      if (!iree_lz4_write_sequence(&op, op_end, anchor,
+                                   (iree_host_size_t)(ip - anchor), offset,
+                                   match_length)) {
+        return IREE_STATUS_RESOURCE_EXHAUSTED;
+      }
+      ip = match_end;
+      anchor = ip;
+    }
+  }
+
+  // Flush the remaining input as the final literal-only sequence.
+  if (!iree_lz4_write_sequence(&op, op_end, anchor,
+                               (iree_host_size_t)(ip_end - anchor), 0, 0)) {
+    return IREE_STATUS_RESOURCE_EXHAUSTED;
+  }
+  *out_target_length = (iree_host_size_t)(op - target.data);
+  return IREE_STATUS_OK;
+}
+
+// Reads the extension bytes of a length whose nibble was saturated.
+static bool iree_lz4_read_length(const uint8_t** ip, const uint8_t* ip_end,
+                                 iree_host_size_t* length) {
+  uint8_t byte;
+  do {
+    if (*ip >= ip_end) return false;
+    byte = *(*ip)++;
+    *length += byte;
+  } while (byte == 255);
+  return true;
+}
+
+iree_status_t iree_lz4_decompress(iree_const_byte_span_t source,
+                                  iree_byte_span_t target) {
+  const uint8_t* ip = source.data;
+  const uint8_t* ip_end = source.data + source.data_length;
+  uint8_t* op = target.data;
+  uint8_t* op_end = target.data + target.data_length;
+
+  while (ip < ip_end) {
+    uint8_t token = *ip++;
+
+    iree_host_size_t literal_length = token >> 4;
+    if (literal_length == IREE_LZ4_RUN_MASK &&
+        !iree_lz4_read_length(&ip, ip_end, &literal_length)) {
+      return IREE_STATUS_DATA_LOSS;
+    }
+    if ((iree_host_size_t)(ip_end - ip) < literal_length ||
+        (iree_host_size_t)(op_end - op) < literal_length) {
+      return IREE_STATUS_DATA_LOSS;
+    }
+    memcpy(op, ip, literal_length);
+    ip += literal_length;
+    op += literal_length;
+
+    // The final sequence has no match.
+    if (ip == ip_end) break;
+
+    if (ip_end - ip < 2) return IREE_STATUS_DATA_LOSS;
+    iree_host_size_t offset = ip[0] | (ip[1] << 8);
+    ip += 2;
+    if (offset == 0 || offset > (iree_host_size_t)(op - target.data)) {
+      return IREE_STATUS_DATA_LOSS;
+    }
+
+    iree_host_size_t match_length = token & IREE_LZ4_RUN_MASK;
+    if (match_length == IREE_LZ4_RUN_MASK &&
+        !iree_lz4_read_length(&ip, ip_end, &match_length)) {
+      return IREE_STATUS_DATA_LOSS;
+    }
+    match_length += IREE_LZ4_MIN_MATCH;
+    if ((iree_host_size_t)(op_end - op) < match_length) {
+      return IREE_STATUS_DATA_LOSS;
+    }
+
+    // Matches may overlap the bytes they produce (such as for runs) in which
+    // case they must be copied forward one byte at a time.
+    const uint8_t* match = op - offset;
+    if (offset >= match_length) {
+      memcpy(op, match, match_length);
+      op += match_length;
+    } else {
+      for (iree_host_size_t i = 0; i < match_length; ++i) {
+        *op++ = *match++;
+      }
+    }
+  }
+
+  return op == op_end ? IREE_STATUS_OK : IREE_STATUS_DATA_LOSS;
+}
@@ -0,0 +1,58 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Self-contained codec for the LZ4 block format:
+// https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md
+//
+// The compressor is a simple greedy single-pass matcher that favors small code
+// size over compression ratio; its output can be decoded by any conforming LZ4
+// block decoder. The decompressor validates all offsets and lengths against
+// the source and destination spans and is safe to use on untrusted input.
+//
+// Compression is only expected to be used by tooling while decompression is
+// used at runtime (such as when loading compressed module rodata).
+
+#ifndef IREE_BASE_LZ4_H_
+#define IREE_BASE_LZ4_H_
+
+#include "iree/base/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Returns the maximum compressed size of |source_length| bytes of input.
+// Destination buffers of at least this size will never fail to compress.
+iree_host_size_t iree_lz4_compress_bound(iree_host_size_t source_length);
+
+// Compresses |source| into |target| and returns the number of bytes written in
+// |out_target_length|.
+// Returns IREE_STATUS_RESOURCE_EXHAUSTED if |target| is too small to hold the
+// compressed data.
+iree_status_t iree_lz4_compress(iree_const_byte_span_t source,
+                                iree_byte_span_t target,
+                                iree_host_size_t* out_target_length);
+
+// Decompresses |source| into |target|. The decompressed size must exactly
+// match the length of |target|.
+// Returns IREE_STATUS_DATA_LOSS if |source| is malformed or its decompressed
+// size does not match |target|.
+iree_status_t iree_lz4_decompress(iree_const_byte_span_t source,
+                                  iree_byte_span_t target);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_BASE_LZ4_H_
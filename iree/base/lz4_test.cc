@@ -0,0 +1,124 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/base/lz4.h"
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "iree/testing/gtest.h"
+
+namespace iree {
+namespace {
+
+std::vector<uint8_t> Compress(const std::vector<uint8_t>& source) {
+  std::vector<uint8_t> target(iree_lz4_compress_bound(source.size()));
+  iree_host_size_t target_length = 0;
+  EXPECT_EQ(IREE_STATUS_OK,
+            iree_lz4_compress({source.data(), source.size()},
+                              {target.data(), target.size()}, &target_length));
+  target.resize(target_length);
+  return target;
+}
+
+iree_status_t Decompress(const std::vector<uint8_t>& source,
+                         std::vector<uint8_t>* target) {
+  return iree_lz4_decompress({source.data(), source.size()},
+                             {target->data(), target->size()});
+}
+
+void ExpectRoundTrip(const std::vector<uint8_t>& source) {
+  auto compressed = Compress(source);
+  std::vector<uint8_t> decompressed(source.size());
+  ASSERT_EQ(IREE_STATUS_OK, Decompress(compressed, &decompressed));
+  EXPECT_EQ(source, decompressed);
+}
+
+TEST(Lz4Test, Empty) { ExpectRoundTrip({}); }
+
+TEST(Lz4Test, ShortInputs) {
+  // Inputs shorter than the minimum match window are stored as literals.
+  for (int length = 1; length < 32; ++length) {
+    std::vector<uint8_t> source(length);
+    for (int i = 0; i < length; ++i) source[i] = i % 3;
+    ExpectRoundTrip(source);
+  }
+}
+
+TEST(Lz4Test, Runs) {
+  // Overlapping matches and saturated length nibbles.
+  std::vector<uint8_t> source(100000, 0xAB);
+  auto compressed = Compress(source);
+  EXPECT_LT(compressed.size(), source.size() / 100);
+  std::vector<uint8_t> decompressed(source.size());
+  ASSERT_EQ(IREE_STATUS_OK, Decompress(compressed, &decompressed));
+  EXPECT_EQ(source, decompressed);
+}
+
+TEST(Lz4Test, Incompressible) {
+  std::mt19937 rng(0);
+  std::vector<uint8_t> source(70000);
+  for (auto& value : source) value = static_cast<uint8_t>(rng());
+  auto compressed = Compress(source);
+  EXPECT_LE(compressed.size(), iree_lz4_compress_bound(source.size()));
+  std::vector<uint8_t> decompressed(source.size());
+  ASSERT_EQ(IREE_STATUS_OK, Decompress(compressed, &decompressed));
+  EXPECT_EQ(source, decompressed);
+}
+
+TEST(Lz4Test, SparseWeights) {
+  // Mostly-zero data with matches spanning more than the max offset.
+  std::mt19937 rng(0);
+  std::vector<uint8_t> source(1 << 18);
+  for (size_t i = 0; i < source.size(); i += 97) {
+    source[i] = static_cast<uint8_t>(rng());
+  }
+  ExpectRoundTrip(source);
+}
+
+TEST(Lz4Test, TargetTooSmall) {
+  std::vector<uint8_t> source(1000);
+  for (size_t i = 0; i < source.size(); ++i) source[i] = i * 31;
+  std::vector<uint8_t> target(16);
+  iree_host_size_t target_length = 0;
+  EXPECT_EQ(IREE_STATUS_RESOURCE_EXHAUSTED,
+            iree_lz4_compress({source.data(), source.size()},
+                              {target.data(), target.size()}, &target_length));
+}
+
+TEST(Lz4Test, SizeMismatch) {
+  std::vector<uint8_t> source(1000, 7);
+  auto compressed = Compress(source);
+  std::vector<uint8_t> too_small(source.size() - 1);
+  EXPECT_EQ(IREE_STATUS_DATA_LOSS, Decompress(compressed, &too_small));
+  std::vector<uint8_t> too_large(source.size() + 1);
+  EXPECT_EQ(IREE_STATUS_DATA_LOSS, Decompress(compressed, &too_large));
+}
+
+TEST(Lz4Test, MalformedInput) {
+  std::vector<uint8_t> decompressed(64);
+  // Literal length extends past the end of the input.
+  EXPECT_EQ(IREE_STATUS_DATA_LOSS, Decompress({0xF0}, &decompressed));
+  EXPECT_EQ(IREE_STATUS_DATA_LOSS, Decompress({0x50, 1, 2}, &decompressed));
+  // Match offset points before the start of the output.
+  EXPECT_EQ(IREE_STATUS_DATA_LOSS,
+            Decompress({0x10, 1, 0x02, 0x00}, &decompressed));
+  // Zero match offset.
+  EXPECT_EQ(IREE_STATUS_DATA_LOSS,
+            Decompress({0x10, 1, 0x00, 0x00}, &decompressed));
+}
+
+}  // namespace
+}  // namespace iree
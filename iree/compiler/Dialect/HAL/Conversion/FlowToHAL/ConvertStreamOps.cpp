@@ -12,6 +12,8 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <limits>
+
 #include "iree/compiler/Dialect/Flow/IR/FlowOps.h"
 #include "iree/compiler/Dialect/HAL/Conversion/FlowToHAL/ConvertFlowToHAL.h"
 #include "iree/compiler/Dialect/HAL/IR/HALOps.h"
@@ -19,6 +21,9 @@
 #include "iree/compiler/Dialect/HAL/Utils/TypeUtils.h"
 #include "iree/compiler/Dialect/IREE/IR/IREETypes.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/MathExtras.h"
 #include "mlir/Dialect/StandardOps/Ops.h"
 #include "mlir/IR/Attributes.h"
 #include "mlir/IR/Builders.h"
@@ -33,9 +38,22 @@ namespace {
 
 struct BufferRange {
   BufferRange() = default;
-  explicit BufferRange(Value buffer) : buffer(buffer) {}
+  explicit BufferRange(Value buffer) : buffer(buffer), rootBuffer(buffer) {}
+  BufferRange(Value buffer, Value rootBuffer, int64_t byteOffset,
+              int64_t byteLength)
+      : buffer(buffer),
+        rootBuffer(rootBuffer),
+        byteOffset(byteOffset),
+        byteLength(byteLength) {}
 
   Value buffer = nullptr;
+
+  // Allocation that |buffer| is a subspan of and the range it covers within
+  // it. Used to find hazards between commands: ranges of different root
+  // buffers never alias. A byteLength of -1 covers the whole root buffer.
+  Value rootBuffer = nullptr;
+  int64_t byteOffset = 0;
+  int64_t byteLength = -1;
 };
 
 // Allocated buffers used within the stream.
@@ -107,15 +125,24 @@ static void allocateOutputBuffers(IREE::Flow::ExStreamFragmentOp streamOp,
   }
 }
 
+// Returns the memory types and usage used for all transient buffers.
+// TODO(benvanik): compute from SSA use-def chain uses.
+// Transient values are always produced within the stream before they are
+// consumed, so allocators need not clear their contents.
+static IREE::HAL::MemoryTypeBitfield getTransientMemoryTypes() {
+  return IREE::HAL::MemoryTypeBitfield::DeviceLocal |
+         IREE::HAL::MemoryTypeBitfield::Transient;
+}
+static IREE::HAL::BufferUsageBitfield getTransientBufferUsage() {
+  return IREE::HAL::BufferUsageBitfield::Dispatch |
+         IREE::HAL::BufferUsageBitfield::Transfer;
+}
+
 // Allocates a transient buffer for use entirely within the command buffer.
 static Value allocateTransientBuffer(Value streamValue, Value allocator,
                                      ConversionPatternRewriter &rewriter) {
-  // TODO(benvanik): compute from SSA use-def chain uses.
-  IREE::HAL::MemoryTypeBitfield memoryTypes =
-      IREE::HAL::MemoryTypeBitfield::DeviceLocal;
-  IREE::HAL::BufferUsageBitfield bufferUsage =
-      IREE::HAL::BufferUsageBitfield::Dispatch |
-      IREE::HAL::BufferUsageBitfield::Transfer;
+  auto memoryTypes = getTransientMemoryTypes();
+  auto bufferUsage = getTransientBufferUsage();
 
   // Compute the allocation size for the value.
   int elementSize = IREE::HAL::getRoundedElementByteWidth(
@@ -139,21 +166,162 @@ static Value allocateTransientBuffer(Value streamValue, Value allocator,
   return buffer;
 }
 
+// Byte alignment of transient ranges within a slab. Conservatively matches the
+// largest minimum storage buffer offset alignment of the devices we target.
+static constexpr int64_t kTransientSlabAlignment = 256;
+
+// A transient value with a statically-known size that is assigned a range of
+// a slab shared with other transients.
+struct TransientRange {
+  Value value = nullptr;
+  int64_t byteLength = 0;
+  // Positions of the defining op and the last use of the value within the
+  // stream block. The storage must remain valid over [defIndex, lastUseIndex].
+  int defIndex = 0;
+  int lastUseIndex = 0;
+  // Byte offset of the value within the slab once planned.
+  int64_t byteOffset = 0;
+};
+
+// Returns the byte length of |streamValue| if its shape is static.
+static Optional<int64_t> getStaticByteLength(Value streamValue) {
+  auto shapedType = streamValue.getType().cast<ShapedType>();
+  if (!shapedType.hasStaticShape()) return llvm::None;
+  return shapedType.getNumElements() *
+         IREE::HAL::getRoundedElementByteWidth(shapedType.getElementType());
+}
+
+// Assigns byte offsets to each transient such that ranges with overlapping
+// lifetimes never overlap in memory and returns the total slab size required.
+//
+// Uses a greedy first-fit placement in order of decreasing size. This is not
+// optimal but the streams we see are small and it tends to do well when a few
+// large intermediates dominate the working set.
+static int64_t planTransientSlab(MutableArrayRef<TransientRange> ranges) {
+  SmallVector<TransientRange *, 8> sortedRanges;
+  for (auto &range : ranges) sortedRanges.push_back(&range);
+  std::stable_sort(sortedRanges.begin(), sortedRanges.end(),
+                   [](TransientRange *lhs, TransientRange *rhs) {
+                     return lhs->byteLength > rhs->byteLength;
+                   });
+
+  int64_t slabSize = 0;
+  SmallVector<TransientRange *, 8> placedRanges;
+  for (auto *range : sortedRanges) {
+    // Gather the memory ranges of all placed values that are live at the same
+    // time as this one.
+    SmallVector<std::pair<int64_t, int64_t>, 8> liveIntervals;
+    for (auto *placedRange : placedRanges) {
+      if (placedRange->lastUseIndex < range->defIndex ||
+          range->lastUseIndex < placedRange->defIndex) {
+        continue;
+      }
+      liveIntervals.push_back(
+          {placedRange->byteOffset,
+           placedRange->byteOffset + placedRange->byteLength});
+    }
+    llvm::sort(liveIntervals);
+
+    // Take the lowest aligned offset that fits between the live intervals.
+    int64_t byteOffset = 0;
+    for (auto &interval : liveIntervals) {
+      if (byteOffset + range->byteLength <= interval.first) break;
+      byteOffset = std::max(
+          byteOffset, static_cast<int64_t>(llvm::alignTo(
+                          interval.second, kTransientSlabAlignment)));
+    }
+    range->byteOffset = byteOffset;
+    slabSize = std::max(slabSize, byteOffset + range->byteLength);
+    placedRanges.push_back(range);
+  }
+  return slabSize;
+}
+
 // Allocates transient buffers to store the intra-stream results and populates
 // the |bufferSet| with the new mappings.
-static void allocateTransientBuffers(IREE::Flow::ExStreamFragmentOp streamOp,
-                                     BufferSet &bufferSet,
-                                     ConversionPatternRewriter &rewriter) {
-  for (auto &op : streamOp.body().front()) {
+//
+// All transients with static shapes are packed into a single slab allocation
+// based on their lifetimes within the stream such that values that are never
+// live at the same time share memory. Each value is then bound to a subspan of
+// the slab. Values with dynamic shapes receive their own allocations.
+//
+// Fails if the slab cannot be addressed with the device size type.
+static LogicalResult allocateTransientBuffers(
+    IREE::Flow::ExStreamFragmentOp streamOp, BufferSet &bufferSet,
+    ConversionPatternRewriter &rewriter) {
+  auto &streamBlock = streamOp.body().front();
+  DenseMap<Operation *, int> opIndices;
+  int opIndex = 0;
+  for (auto &op : streamBlock) {
+    opIndices[&op] = opIndex++;
+  }
+
+  SmallVector<TransientRange, 8> slabRanges;
+  for (auto &op : streamBlock) {
     for (auto result : op.getResults()) {
       // If the result is an output buffer we can just use that directly.
       if (bufferSet.rangeMap[result].buffer) continue;
 
-      auto buffer =
-          allocateTransientBuffer(result, bufferSet.allocator, rewriter);
-      bufferSet.rangeMap[result] = BufferRange{buffer};
+      auto byteLength = getStaticByteLength(result);
+      if (!byteLength.hasValue()) {
+        auto buffer =
+            allocateTransientBuffer(result, bufferSet.allocator, rewriter);
+        bufferSet.rangeMap[result] = BufferRange{buffer};
+        continue;
+      }
+
+      TransientRange range;
+      range.value = result;
+      range.byteLength = byteLength.getValue();
+      range.defIndex = opIndices[&op];
+      range.lastUseIndex = range.defIndex;
+      for (auto *user : result.getUsers()) {
+        auto *userOp = streamBlock.findAncestorOpInBlock(*user);
+        if (!userOp) continue;
+        range.lastUseIndex = std::max(range.lastUseIndex, opIndices[userOp]);
+      }
+      slabRanges.push_back(range);
+    }
+  }
+  if (slabRanges.empty()) return success();
+
+  // All offsets and lengths are bounded by the slab size so checking it is
+  // enough to ensure they all fit in the (i32) device size type.
+  int64_t slabSize = planTransientSlab(slabRanges);
+  if (slabSize > std::numeric_limits<int32_t>::max()) {
+    return streamOp.emitOpError()
+           << "transient slab of " << slabSize
+           << " bytes exceeds the maximum device size";
+  }
+  auto loc = streamOp.getLoc();
+  auto getDeviceSize = [&](int64_t value) {
+    return rewriter.createOrFold<mlir::ConstantOp>(
+        loc, rewriter.getI32IntegerAttr(static_cast<int32_t>(value)));
+  };
+  auto slabBuffer = rewriter
+                        .create<IREE::HAL::AllocatorAllocateOp>(
+                            loc, bufferSet.allocator, getTransientMemoryTypes(),
+                            getTransientBufferUsage(), getDeviceSize(slabSize))
+                        .getResult();
+  rewriter.create<IREE::HAL::ExDeferReleaseOp>(loc, slabBuffer);
+
+  for (auto &range : slabRanges) {
+    if (range.byteOffset == 0 && range.byteLength == slabSize) {
+      // Covers the whole slab so we can avoid the subspan.
+      bufferSet.rangeMap[range.value] =
+          BufferRange{slabBuffer, slabBuffer, 0, slabSize};
+      continue;
     }
+    auto subspanBuffer = rewriter
+                             .create<IREE::HAL::BufferSubspanOp>(
+                                 range.value.getLoc(), slabBuffer.getType(),
+                                 slabBuffer, getDeviceSize(range.byteOffset),
+                                 getDeviceSize(range.byteLength))
+                             .getResult();
+    bufferSet.rangeMap[range.value] = BufferRange{
+        subspanBuffer, slabBuffer, range.byteOffset, range.byteLength};
   }
+  return success();
 }
 
 // Returns a the (x, y, z) workgroup counts calculated from the given |workload|
@@ -193,8 +361,11 @@ static void recordFullExecutionBarrier(Value commandBuffer, Location loc,
   auto memoryBarrier =
       rewriter
           .create<IREE::HAL::MakeMemoryBarrierOp>(
-              loc, IREE::HAL::AccessScopeBitfield::DispatchWrite,
-              IREE::HAL::AccessScopeBitfield::DispatchRead)
+              loc,
+              IREE::HAL::AccessScopeBitfield::DispatchWrite |
+                  IREE::HAL::AccessScopeBitfield::TransferWrite,
+              IREE::HAL::AccessScopeBitfield::DispatchRead |
+                  IREE::HAL::AccessScopeBitfield::TransferRead)
           .getResult();
   rewriter.create<IREE::HAL::CommandBufferExecutionBarrierOp>(
       loc, commandBuffer, IREE::HAL::ExecutionStageBitfield::CommandRetire,
@@ -259,11 +430,6 @@ static void recordDispatch(Value device, Value commandBuffer,
   rewriter.create<IREE::HAL::CommandBufferDispatchOp>(
       dispatchOp.getLoc(), commandBuffer, executable, entryPointOp,
       workgroupCounts[0], workgroupCounts[1], workgroupCounts[2]);
-
-  // Full barriers for now as we aren't scheduling things.
-  // TODO(benvanik): don't add at the end of the command buffer (we could
-  // also do a canonicalization step that removed trailing barriers).
-  recordFullExecutionBarrier(commandBuffer, dispatchOp.getLoc(), rewriter);
 }
 
 static void recordTensorUpdate(Value device, Value commandBuffer,
@@ -315,31 +481,140 @@ static void recordTensorUpdate(Value device, Value commandBuffer,
                                                updateBuffer.buffer);
   rewriter.create<IREE::HAL::ExDeferReleaseOp>(updateOp.getLoc(),
                                                resultBuffer.buffer);
+}
 
-  // Full barriers for now as we aren't scheduling things.
-  // TODO(benvanik): don't add at the end of the command buffer (we could
-  // also do a canonicalization step that removed trailing barriers).
-  recordFullExecutionBarrier(commandBuffer, updateOp.getLoc(), rewriter);
+// Returns true if |lhs| and |rhs| may refer to the same bytes of memory.
+static bool mayAlias(const BufferRange &lhs, const BufferRange &rhs) {
+  if (!lhs.rootBuffer || lhs.rootBuffer != rhs.rootBuffer) return false;
+  if (lhs.byteLength < 0 || rhs.byteLength < 0) return true;
+  return lhs.byteOffset < rhs.byteOffset + rhs.byteLength &&
+         rhs.byteOffset < lhs.byteOffset + lhs.byteLength;
 }
 
+static bool mayAliasAny(ArrayRef<BufferRange> lhs, ArrayRef<BufferRange> rhs) {
+  for (auto &lhsRange : lhs) {
+    for (auto &rhsRange : rhs) {
+      if (mayAlias(lhsRange, rhsRange)) return true;
+    }
+  }
+  return false;
+}
+
+// A command in the stream along with the buffer ranges it accesses.
+struct StreamCommand {
+  Operation *op = nullptr;
+  SmallVector<BufferRange, 4> reads;
+  SmallVector<BufferRange, 4> writes;
+  // Index of the wave the command executes in. Commands within a wave are
+  // independent and only waves are separated by barriers.
+  int wave = 0;
+};
+
+// Returns true if |command| must execute after |priorCommand| has completed:
+// it reads what |priorCommand| writes (RAW) or writes what |priorCommand|
+// reads (WAR) or writes (WAW). Write-after-read hazards arise from transient
+// values that share slab memory.
+static bool hasHazard(const StreamCommand &priorCommand,
+                      const StreamCommand &command) {
+  return mayAliasAny(priorCommand.writes, command.reads) ||
+         mayAliasAny(priorCommand.writes, command.writes) ||
+         mayAliasAny(priorCommand.reads, command.writes);
+}
+
+// Builds the list of commands in |streamBlock| and assigns each to the
+// earliest wave after all of the commands it has hazards with. The returned
+// commands are sorted by wave and are otherwise in stream order.
+static LogicalResult scheduleStreamCommands(
+    Block &streamBlock, BufferSet &bufferSet,
+    SmallVectorImpl<StreamCommand> &commands) {
+  for (auto &op : streamBlock) {
+    StreamCommand command;
+    command.op = &op;
+    if (auto dispatchOp = dyn_cast<IREE::Flow::DispatchOp>(op)) {
+      for (auto operand : dispatchOp.operands()) {
+        command.reads.push_back(bufferSet.rangeMap[operand]);
+      }
+      for (auto result : dispatchOp.results()) {
+        command.writes.push_back(bufferSet.rangeMap[result]);
+      }
+    } else if (auto updateOp = dyn_cast<IREE::Flow::TensorUpdateOp>(op)) {
+      command.reads.push_back(bufferSet.rangeMap[updateOp.update()]);
+      command.reads.push_back(bufferSet.rangeMap[updateOp.target()]);
+      command.writes.push_back(bufferSet.rangeMap[updateOp.result()]);
+    } else if (isa<IREE::Flow::ReturnOp>(op)) {
+      // No-op; handled by the buffer allocation.
+      continue;
+    } else {
+      return op.emitOpError() << "unexpected in stream";
+    }
+    for (auto &priorCommand : commands) {
+      if (hasHazard(priorCommand, command)) {
+        command.wave = std::max(command.wave, priorCommand.wave + 1);
+      }
+    }
+    commands.push_back(std::move(command));
+  }
+  std::stable_sort(commands.begin(), commands.end(),
+                   [](const StreamCommand &lhs, const StreamCommand &rhs) {
+                     return lhs.wave < rhs.wave;
+                   });
+  return success();
+}
+
+// Records the commands of |streamBlock| grouped into waves of independent
+// commands. Barriers are only inserted between waves so that commands within
+// a wave may execute concurrently.
 static LogicalResult recordStreamCommands(Value device, Value commandBuffer,
                                           Block &streamBlock,
                                           BufferSet &bufferSet,
                                           ConversionPatternRewriter &rewriter) {
-  for (auto &op : streamBlock) {
+  SmallVector<StreamCommand, 8> commands;
+  if (failed(scheduleStreamCommands(streamBlock, bufferSet, commands))) {
+    return failure();
+  }
+  for (int i = 0; i < commands.size(); ++i) {
+    auto *op = commands[i].op;
+    if (i > 0 && commands[i].wave != commands[i - 1].wave) {
+      recordFullExecutionBarrier(commandBuffer, op->getLoc(), rewriter);
+    }
     if (auto dispatchOp = dyn_cast<IREE::Flow::DispatchOp>(op)) {
       recordDispatch(device, commandBuffer, dispatchOp, bufferSet, rewriter);
     } else if (auto updateOp = dyn_cast<IREE::Flow::TensorUpdateOp>(op)) {
       recordTensorUpdate(device, commandBuffer, updateOp, bufferSet, rewriter);
-    } else if (auto returnOp = dyn_cast<IREE::Flow::ReturnOp>(op)) {
-      // No-op; handled by the buffer allocation.
-    } else {
-      return op.emitOpError() << "unexpected in stream";
     }
   }
   return success();
 }
 
+// Returns true if |op| consumes stream results on the device such that it is
+// ordered after the stream by the queue and no host wait is required.
+static bool isDeviceOrderedUser(Operation *op) {
+  return isa<IREE::Flow::ExStreamFragmentOp>(op);
+}
+
+// Inserts a wait on |fence| prior to the first op that requires the results of
+// |streamOp| on the host. Ops that consume the results in later streams are
+// ordered on the device queue and can be recorded while the stream executes.
+// If the results are not used on the host we still wait prior to leaving the
+// block so that execution errors surface where they did previously.
+static void insertStreamWait(IREE::Flow::ExStreamFragmentOp streamOp,
+                             Value device, Value fence,
+                             ConversionPatternRewriter &rewriter) {
+  auto *parentBlock = streamOp.getOperation()->getBlock();
+  Operation *waitBeforeOp = parentBlock->getTerminator();
+  for (auto result : streamOp.getResults()) {
+    for (auto *user : result.getUsers()) {
+      auto *userOp = parentBlock->findAncestorOpInBlock(*user);
+      if (!userOp || isDeviceOrderedUser(userOp)) continue;
+      if (userOp->isBeforeInBlock(waitBeforeOp)) waitBeforeOp = userOp;
+    }
+  }
+
+  OpBuilder::InsertionGuard g(rewriter);
+  rewriter.setInsertionPoint(waitBeforeOp);
+  rewriter.create<IREE::HAL::ExWaitFenceOp>(streamOp.getLoc(), device, fence);
+}
+
 class ExStreamFragmentOpConversion
     : public OpConversionPattern<IREE::Flow::ExStreamFragmentOp> {
  public:
@@ -377,7 +652,9 @@ class ExStreamFragmentOpConversion
 
     // Allocate buffers for outputs and transient buffers.
     allocateOutputBuffers(streamOp, bufferSet, rewriter);
-    allocateTransientBuffers(streamOp, bufferSet, rewriter);
+    if (failed(allocateTransientBuffers(streamOp, bufferSet, rewriter))) {
+      return matchFailure();
+    }
 
     // Allocate and begin the command buffer.
     // In a real version we would want to pick the device based on the placement
@@ -396,11 +673,14 @@ class ExStreamFragmentOpConversion
 
     // End and submit the command buffer.
     // In a real version we'd want to setup a semaphore chain instead of
-    // submitting and waiting.
+    // waiting on the host for results.
     rewriter.create<IREE::HAL::CommandBufferEndOp>(streamOp.getLoc(),
                                                    commandBuffer);
-    rewriter.create<IREE::HAL::ExSubmitAndWaitOp>(streamOp.getLoc(), device,
-                                                  commandBuffer);
+    auto fence = rewriter
+                     .create<IREE::HAL::ExSubmitOp>(streamOp.getLoc(), device,
+                                                    commandBuffer)
+                     .getResult();
+    insertStreamWait(streamOp, device, fence, rewriter);
 
     // It's annoying, but we need to do this replacement at the very end as
     // otherwise we lose access to the original values (which we need for
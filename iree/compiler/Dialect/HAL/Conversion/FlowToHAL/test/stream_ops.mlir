@@ -12,14 +12,13 @@ func @multipleDispatches(%arg0: tensor<128xf32>) -> tensor<128xf32> {
   // CHECK-DAG: [[C1:%.+]] = constant 1
   // CHECK-DAG: [[C4:%.+]] = constant 4
   // CHECK-DAG: [[C128:%.+]] = constant 128
+  // CHECK-DAG: [[C512:%.+]] = constant 512
   %cst = constant dense<[128, 1, 1]> : vector<3xi32>
   // CHECK: [[RET_BUF:%.+]] = hal.allocator.allocate.shaped {{.+}}, "HostVisible|DeviceVisible|DeviceLocal", "Constant|Transfer|Mapping|Dispatch", shape=[
   // CHECK-SAME:   [[C128]]
   // CHECK-SAME: ], element_size=4 : !iree.ref<!hal.buffer>
   // CHECK-NEXT: hal.ex.defer_release [[RET_BUF]]
-  // CHECK-NEXT: [[TMP_BUF:%.+]] = hal.allocator.allocate.shaped {{.+}}, "DeviceVisible|DeviceLocal", "Transfer|Dispatch", shape=[
-  // CHECK-SAME:   [[C128]]
-  // CHECK-SAME: ], element_size=4 : !iree.ref<!hal.buffer>
+  // CHECK-NEXT: [[TMP_BUF:%.+]] = hal.allocator.allocate {{.+}}, "Transient|DeviceVisible|DeviceLocal", "Transfer|Dispatch", [[C512]] : !iree.ref<!hal.buffer>
   // CHECK-NEXT: hal.ex.defer_release [[TMP_BUF]]
   // CHECK-NEXT: [[CMD:%.+]] = hal.command_buffer.create {{.+}}, "OneShot", "Transfer|Dispatch"
   // CHECK-NEXT: hal.command_buffer.begin [[CMD]]
@@ -49,18 +48,125 @@ func @multipleDispatches(%arg0: tensor<128xf32>) -> tensor<128xf32> {
     // CHECK-NEXT: hal.command_buffer.dispatch [[CMD]], {{.+}}, entry_point=0, workgroup_xyz=[
     // CHECK-SAME:   [[C4]], [[C1]], [[C1]]
     // CHECK-SAME: ]
-    // CHECK: hal.command_buffer.execution_barrier
+    // CHECK-NOT: hal.command_buffer.execution_barrier
     %2 = flow.dispatch @ex0::@entry0[%arg1 : vector<3xi32>](%1) : (tensor<128xf32>) -> tensor<128xf32>
     flow.return %2 : tensor<128xf32>
   }
   // CHECK: hal.command_buffer.end [[CMD]]
-  // CHECK-NEXT: hal.ex.submit_and_wait {{.+}}, [[CMD]]
+  // CHECK-NEXT: [[FENCE:%.+]] = hal.ex.submit {{.+}}, [[CMD]] : !iree.ref<!hal.fence>
+  // CHECK-NEXT: hal.ex.wait_fence {{.+}}, [[FENCE]]
   // CHECK-NEXT: return [[RET_BUF]]
   return %0 : tensor<128xf32>
 }
 
 // -----
 
+hal.executable @ex0 {
+  hal.executable.entry_point @entry0 attributes {
+    ordinal = 0 : i32,
+    workgroup_size = dense<[32, 1, 1]> : vector<3xi32>
+  }
+}
+
+// CHECK-LABEL: func @independentDispatches
+func @independentDispatches(%arg0: tensor<128xf32>) -> (tensor<128xf32>, tensor<128xf32>) {
+  %cst = constant dense<[128, 1, 1]> : vector<3xi32>
+  // CHECK: hal.command_buffer.begin
+  %0:2 = flow.ex.stream.fragment(%arg1 = %cst : vector<3xi32>, %arg2 = %arg0 : tensor<128xf32>) -> (tensor<128xf32>, tensor<128xf32>) {
+    // Both dispatches reading only %arg0 are recorded in the first wave.
+    // CHECK: hal.ex.push_binding {{.+}}, 0, %arg0
+    // CHECK-NEXT: hal.ex.defer_release
+    // CHECK-NEXT: hal.ex.push_binding {{.+}}, 1, [[TMP_BUF:%[^,]+]],
+    // CHECK: hal.command_buffer.dispatch
+    // CHECK-NOT: hal.command_buffer.execution_barrier
+    // CHECK: hal.ex.push_binding {{.+}}, 0, %arg0
+    // CHECK: hal.command_buffer.dispatch
+    // CHECK: hal.command_buffer.execution_barrier
+    // CHECK: hal.ex.push_binding {{.+}}, 0, [[TMP_BUF]],
+    // CHECK: hal.command_buffer.dispatch
+    // CHECK-NOT: hal.command_buffer.execution_barrier
+    // CHECK: hal.command_buffer.end
+    %1 = flow.dispatch @ex0::@entry0[%arg1 : vector<3xi32>](%arg2) : (tensor<128xf32>) -> tensor<128xf32>
+    %2 = flow.dispatch @ex0::@entry0[%arg1 : vector<3xi32>](%1) : (tensor<128xf32>) -> tensor<128xf32>
+    %3 = flow.dispatch @ex0::@entry0[%arg1 : vector<3xi32>](%arg2) : (tensor<128xf32>) -> tensor<128xf32>
+    flow.return %2, %3 : tensor<128xf32>, tensor<128xf32>
+  }
+  return %0#0, %0#1 : tensor<128xf32>, tensor<128xf32>
+}
+
+// -----
+
+hal.executable @ex0 {
+  hal.executable.entry_point @entry0 attributes {
+    ordinal = 0 : i32,
+    workgroup_size = dense<[32, 1, 1]> : vector<3xi32>
+  }
+}
+
+// CHECK-LABEL: func @transientAliasing
+func @transientAliasing(%arg0: tensor<128xf32>) -> tensor<128xf32> {
+  // CHECK-DAG: [[C0:%.+]] = constant 0
+  // CHECK-DAG: [[C512:%.+]] = constant 512
+  // CHECK-DAG: [[C1024:%.+]] = constant 1024
+  %cst = constant dense<[128, 1, 1]> : vector<3xi32>
+  // CHECK: [[RET_BUF:%.+]] = hal.allocator.allocate.shaped
+  // CHECK-NEXT: hal.ex.defer_release [[RET_BUF]]
+  // CHECK-NEXT: [[SLAB:%.+]] = hal.allocator.allocate {{.+}}, "Transient|DeviceVisible|DeviceLocal", "Transfer|Dispatch", [[C1024]] : !iree.ref<!hal.buffer>
+  // CHECK-NEXT: hal.ex.defer_release [[SLAB]]
+  // CHECK-NEXT: [[TMP0:%.+]] = hal.buffer.subspan [[SLAB]], [[C0]], [[C512]] : !iree.ref<!hal.buffer>
+  // CHECK-NEXT: [[TMP1:%.+]] = hal.buffer.subspan [[SLAB]], [[C512]], [[C512]] : !iree.ref<!hal.buffer>
+  // CHECK-NEXT: [[TMP2:%.+]] = hal.buffer.subspan [[SLAB]], [[C0]], [[C512]] : !iree.ref<!hal.buffer>
+  // CHECK-NEXT: [[CMD:%.+]] = hal.command_buffer.create
+  %0 = flow.ex.stream.fragment(%arg1 = %cst : vector<3xi32>, %arg2 = %arg0 : tensor<128xf32>) -> tensor<128xf32> {
+    // CHECK: hal.ex.push_binding [[CMD]], 0, %arg0
+    // CHECK: hal.ex.push_binding [[CMD]], 1, [[TMP0]]
+    %1 = flow.dispatch @ex0::@entry0[%arg1 : vector<3xi32>](%arg2) : (tensor<128xf32>) -> tensor<128xf32>
+    // CHECK: hal.ex.push_binding [[CMD]], 0, [[TMP0]]
+    // CHECK: hal.ex.push_binding [[CMD]], 1, [[TMP1]]
+    %2 = flow.dispatch @ex0::@entry0[%arg1 : vector<3xi32>](%1) : (tensor<128xf32>) -> tensor<128xf32>
+    // CHECK: hal.ex.push_binding [[CMD]], 0, [[TMP1]]
+    // CHECK: hal.ex.push_binding [[CMD]], 1, [[TMP2]]
+    %3 = flow.dispatch @ex0::@entry0[%arg1 : vector<3xi32>](%2) : (tensor<128xf32>) -> tensor<128xf32>
+    // CHECK: hal.ex.push_binding [[CMD]], 0, [[TMP2]]
+    // CHECK: hal.ex.push_binding [[CMD]], 1, [[RET_BUF]]
+    %4 = flow.dispatch @ex0::@entry0[%arg1 : vector<3xi32>](%3) : (tensor<128xf32>) -> tensor<128xf32>
+    flow.return %4 : tensor<128xf32>
+  }
+  // CHECK: return [[RET_BUF]]
+  return %0 : tensor<128xf32>
+}
+
+// -----
+
+hal.executable @ex0 {
+  hal.executable.entry_point @entry0 attributes {
+    ordinal = 0 : i32,
+    workgroup_size = dense<[32, 1, 1]> : vector<3xi32>
+  }
+}
+
+// CHECK-LABEL: func @pipelinedStreams
+func @pipelinedStreams(%arg0: tensor<128xf32>) -> tensor<128xf32> {
+  %cst = constant dense<[128, 1, 1]> : vector<3xi32>
+  // CHECK: [[FENCE0:%.+]] = hal.ex.submit
+  // CHECK-NOT: hal.ex.wait_fence
+  %0 = flow.ex.stream.fragment(%arg1 = %cst : vector<3xi32>, %arg2 = %arg0 : tensor<128xf32>) -> tensor<128xf32> {
+    %1 = flow.dispatch @ex0::@entry0[%arg1 : vector<3xi32>](%arg2) : (tensor<128xf32>) -> tensor<128xf32>
+    flow.return %1 : tensor<128xf32>
+  }
+  // CHECK: [[FENCE1:%.+]] = hal.ex.submit
+  %2 = flow.ex.stream.fragment(%arg1 = %cst : vector<3xi32>, %arg2 = %0 : tensor<128xf32>) -> tensor<128xf32> {
+    %3 = flow.dispatch @ex0::@entry0[%arg1 : vector<3xi32>](%arg2) : (tensor<128xf32>) -> tensor<128xf32>
+    flow.return %3 : tensor<128xf32>
+  }
+  // CHECK-NEXT: hal.ex.wait_fence {{.+}}, [[FENCE0]]
+  // CHECK-NEXT: hal.ex.wait_fence {{.+}}, [[FENCE1]]
+  // CHECK-NEXT: return
+  return %2 : tensor<128xf32>
+}
+
+// -----
+
 // CHECK-LABEL: @tensorUpdate
 // CHECK-SAME: ([[UBUF:%.+]]:{{.+}}, [[TBUF:%.+]]:{{.+}})
 func @tensorUpdate(%arg0 : tensor<1x1x10xf32>, %arg1 : tensor<5x1x10xf32>) -> tensor<5x1x10xf32> {
@@ -0,0 +1,22 @@
+// RUN: iree-opt -split-input-file -iree-convert-flow-to-hal -verify-diagnostics %s
+
+hal.executable @ex0 {
+  hal.executable.entry_point @entry0 attributes {
+    ordinal = 0 : i32,
+    workgroup_size = dense<[32, 1, 1]> : vector<3xi32>
+  }
+}
+
+// Two live 1GiB transients require a slab larger than the device size range.
+func @transientSlabTooLarge(%arg0: tensor<268435456xf32>) -> tensor<268435456xf32> {
+  %cst = constant dense<[268435456, 1, 1]> : vector<3xi32>
+  // expected-error@+2 {{transient slab of 2147483648 bytes exceeds the maximum device size}}
+  // expected-error@+1 {{failed to legalize operation 'flow.ex.stream.fragment'}}
+  %0 = flow.ex.stream.fragment(%arg1 = %cst : vector<3xi32>, %arg2 = %arg0 : tensor<268435456xf32>) -> tensor<268435456xf32> {
+    %1 = flow.dispatch @ex0::@entry0[%arg1 : vector<3xi32>](%arg2) : (tensor<268435456xf32>) -> tensor<268435456xf32>
+    %2 = flow.dispatch @ex0::@entry0[%arg1 : vector<3xi32>](%1) : (tensor<268435456xf32>) -> tensor<268435456xf32>
+    %3 = flow.dispatch @ex0::@entry0[%arg1 : vector<3xi32>](%1, %2) : (tensor<268435456xf32>, tensor<268435456xf32>) -> tensor<268435456xf32>
+    flow.return %3 : tensor<268435456xf32>
+  }
+  return %0 : tensor<268435456xf32>
+}
@@ -35,6 +35,10 @@ void populateHALExperimentalToVMPatterns(MLIRContext *context,
       context, importSymbols, typeConverter, "hal.ex.defer_release");
   patterns.insert<VMImportOpConversion<IREE::HAL::ExSubmitAndWaitOp>>(
       context, importSymbols, typeConverter, "hal.ex.submit_and_wait");
+  patterns.insert<VMImportOpConversion<IREE::HAL::ExSubmitOp>>(
+      context, importSymbols, typeConverter, "hal.ex.submit");
+  patterns.insert<VMImportOpConversion<IREE::HAL::ExWaitFenceOp>>(
+      context, importSymbols, typeConverter, "hal.ex.wait_fence");
 }
 
 }  // namespace iree_compiler
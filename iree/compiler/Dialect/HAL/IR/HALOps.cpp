@@ -281,6 +281,74 @@ static void printExSubmitAndWaitOp(OpAsmPrinter &p, ExSubmitAndWaitOp op) {
   p.printOptionalAttrDictWithKeyword(op.getAttrs());
 }
 
+//===----------------------------------------------------------------------===//
+// hal.ex.submit
+//===----------------------------------------------------------------------===//
+
+void ExSubmitOp::getAsmResultNames(
+    function_ref<void(Value, StringRef)> setNameFn) {
+  setNameFn(result(), "fence");
+}
+
+static ParseResult parseExSubmitOp(OpAsmParser &parser,
+                                   OperationState *result) {
+  SmallVector<OpAsmParser::OperandType, 2> operands;
+  Type fenceType;
+  auto operandsLoc = parser.getCurrentLocation();
+  if (failed(parser.parseOperandList(operands)) ||
+      failed(parser.resolveOperands(
+          operands,
+          ArrayRef<Type>{
+              RefPtrType::get(DeviceType::get(result->getContext())),
+              RefPtrType::get(CommandBufferType::get(result->getContext()))},
+          operandsLoc, result->operands)) ||
+      failed(parser.parseOptionalAttrDictWithKeyword(result->attributes)) ||
+      failed(parser.parseColonType(fenceType))) {
+    return failure();
+  }
+  result->addTypes(fenceType);
+  return success();
+}
+
+static void printExSubmitOp(OpAsmPrinter &p, ExSubmitOp op) {
+  p << op.getOperationName() << ' ';
+  p.printOperand(op.device());
+  p << ", ";
+  p.printOperand(op.command_buffer());
+  p.printOptionalAttrDictWithKeyword(op.getAttrs());
+  p << " : ";
+  p.printType(op.result().getType());
+}
+
+//===----------------------------------------------------------------------===//
+// hal.ex.wait_fence
+//===----------------------------------------------------------------------===//
+
+static ParseResult parseExWaitFenceOp(OpAsmParser &parser,
+                                      OperationState *result) {
+  SmallVector<OpAsmParser::OperandType, 2> operands;
+  auto operandsLoc = parser.getCurrentLocation();
+  if (failed(parser.parseOperandList(operands)) ||
+      failed(parser.resolveOperands(
+          operands,
+          ArrayRef<Type>{
+              RefPtrType::get(DeviceType::get(result->getContext())),
+              RefPtrType::get(FenceType::get(result->getContext()))},
+          operandsLoc, result->operands)) ||
+      failed(parser.parseOptionalAttrDictWithKeyword(result->attributes))) {
+    return failure();
+  }
+  return success();
+}
+
+static void printExWaitFenceOp(OpAsmPrinter &p, ExWaitFenceOp op) {
+  p << op.getOperationName() << ' ';
+  p.printOperand(op.device());
+  p << ", ";
+  p.printOperand(op.fence());
+  p.printOptionalAttrDictWithKeyword(op.getAttrs());
+}
+
 //===----------------------------------------------------------------------===//
 // hal.make_memory_barrier
 //===----------------------------------------------------------------------===//
@@ -30,3 +30,25 @@ func @submit_and_wait() {
   hal.ex.submit_and_wait %0, %1
   return
 }
+
+// -----
+
+// CHECK-LABEL: @submit
+func @submit() -> !iree.ref<!hal.fence> {
+  %0 = "test_hal.device"() : () -> !iree.ref<!hal.device>
+  %1 = "test_hal.command_buffer"() : () -> !iree.ref<!hal.command_buffer>
+  // CHECK: %fence = hal.ex.submit %0, %1 : !iree.ref<!hal.fence>
+  %fence = hal.ex.submit %0, %1 : !iree.ref<!hal.fence>
+  return %fence : !iree.ref<!hal.fence>
+}
+
+// -----
+
+// CHECK-LABEL: @wait_fence
+func @wait_fence() {
+  %0 = "test_hal.device"() : () -> !iree.ref<!hal.device>
+  %1 = "test_hal.fence"() : () -> !iree.ref<!hal.fence>
+  // CHECK: hal.ex.wait_fence %0, %1
+  hal.ex.wait_fence %0, %1
+  return
+}
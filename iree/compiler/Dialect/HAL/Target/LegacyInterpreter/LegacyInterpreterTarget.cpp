@@ -112,6 +112,11 @@ static void buildInterpreterConversionPassPipeline(OpPassManager *passManager) {
   passManager->addNestedPass<FuncOp>(createCSEPass());
   passManager->addNestedPass<FuncOp>(createCanonicalizerPass());
 
+  // Evaluate chains of elementwise ops in a single pass. This runs after
+  // canonicalization so that ops with dedicated fused forms (such as
+  // matmul_bias_f) are formed first.
+  passManager->addNestedPass<FuncOp>(createFuseElementwiseOpsPass());
+
   // Drop all functions that are not reachable.
   passManager->addPass(createDropUnreachableExecutableFunctionsPass());
 }
@@ -14,8 +14,21 @@
 
 #include "iree/compiler/Dialect/HAL/Target/VMLA/VMLATarget.h"
 
+#include <string>
+
+#include "iree/compiler/Dialect/Flow/IR/FlowOps.h"
+#include "iree/compiler/Dialect/HAL/IR/HALOps.h"
+#include "iree/compiler/Dialect/VM/Target/Bytecode/BytecodeModuleTarget.h"
+#include "iree/compiler/Dialect/VM/Transforms/Passes.h"
+#include "iree/compiler/Dialect/VMLA/Transforms/Passes.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/raw_ostream.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/Module.h"
+#include "mlir/Pass/PassManager.h"
 #include "mlir/Support/LogicalResult.h"
+#include "mlir/Transforms/Passes.h"
 
 namespace mlir {
 namespace iree_compiler {
@@ -32,15 +45,116 @@ VMLATargetOptions getVMLATargetOptionsFromFlags() {
   return targetOptions;
 }
 
+// Marks all dispatch entry functions as VM module exports and records their
+// HAL entry point ordinal in the iree.reflection "hal.entry_point_ordinal"
+// attribute. VM export ordinals are allocated by name so the runtime uses the
+// attribute to map HAL entry point ordinals to exports.
+static LogicalResult makeVMLAExecutableABI(IREE::Flow::ExecutableOp sourceOp,
+                                           ModuleOp moduleOp,
+                                           IREE::HAL::ExecutableOp targetOp) {
+  Builder builder(moduleOp.getContext());
+  for (auto &op : sourceOp.getBlock()) {
+    if (auto entryOp = dyn_cast<IREE::Flow::DispatchEntryOp>(&op)) {
+      auto targetEntryOp =
+          targetOp.lookupSymbol<IREE::HAL::ExecutableEntryPointOp>(
+              entryOp.sym_name());
+      auto funcOp = moduleOp.lookupSymbol<FuncOp>(entryOp.function_ref());
+      funcOp.setAttr("iree.executable.export", builder.getUnitAttr());
+      funcOp.setAttr("iree.module.export", builder.getUnitAttr());
+
+      SmallVector<NamedAttribute, 4> reflectionAttrs;
+      if (auto existingAttrs =
+              funcOp.getAttrOfType<DictionaryAttr>("iree.reflection")) {
+        reflectionAttrs.append(existingAttrs.begin(), existingAttrs.end());
+      }
+      reflectionAttrs.push_back(builder.getNamedAttr(
+          "hal.entry_point_ordinal",
+          builder.getStringAttr(
+              std::to_string(targetEntryOp.ordinal().getZExtValue()))));
+      funcOp.setAttr("iree.reflection",
+                     builder.getDictionaryAttr(reflectionAttrs));
+    } else if (auto entryOp = dyn_cast<IREE::Flow::ReductionEntryOp>(&op)) {
+      return entryOp.emitOpError()
+             << "reductions are not yet supported by the VMLA backend";
+    }
+  }
+  return success();
+}
+
+// Reports every op in the dispatch entry functions of |moduleOp| that the VMLA
+// backend cannot lower so that unsupported programs fail to compile with a
+// full list instead of at the first unconvertible op (or at runtime).
+static LogicalResult verifyVMLASupportedOps(ModuleOp moduleOp) {
+  bool allSupported = true;
+  for (auto funcOp : moduleOp.getOps<FuncOp>()) {
+    if (!funcOp.getAttr("iree.executable.export")) continue;
+    funcOp.walk([&](Operation *op) {
+      if (op == funcOp.getOperation() || IREE::VMLA::isConvertibleOp(op)) {
+        return;
+      }
+      op->emitOpError() << "is not supported by the VMLA backend";
+      allSupported = false;
+    });
+  }
+  return success(allSupported);
+}
+
+// Builds a pass pipeline that converts the xla_hlo/std input to the VMLA
+// dialect and then lowers that to a VM module.
+static void buildVMLATransformPassPipeline(OpPassManager &passManager) {
+  passManager.addNestedPass<FuncOp>(createCanonicalizerPass());
+  passManager.addNestedPass<FuncOp>(createCSEPass());
+  passManager.addPass(IREE::VMLA::createConversionPass());
+  passManager.addNestedPass<FuncOp>(createCanonicalizerPass());
+  passManager.addNestedPass<FuncOp>(createCSEPass());
+  IREE::VM::buildVMTransformPassPipeline(passManager);
+}
+
 LogicalResult translateToVMLAExecutable(
     IREE::Flow::ExecutableOp sourceOp, IREE::HAL::ExecutableOp targetOp,
     ExecutableTargetOptions executableOptions,
     VMLATargetOptions targetOptions) {
+  // Clone the module containing the things we want to translate. We do this so
+  // that multiple targets can pull from the same source without conflicting.
+  auto moduleOp = sourceOp.getInnerModule().clone();
+  if (failed(makeVMLAExecutableABI(sourceOp, moduleOp, targetOp)) ||
+      failed(verifyVMLASupportedOps(moduleOp))) {
+    moduleOp.erase();
+    return failure();
+  }
+
+  PassManager conversionPassManager(moduleOp.getContext());
+  buildVMLATransformPassPipeline(conversionPassManager);
+  if (failed(conversionPassManager.run(moduleOp))) {
+    moduleOp.erase();
+    return targetOp.emitError() << "failed to run VMLA conversion passes";
+  }
+
+  // Serialize the VM module to bytecode.
+  IREE::VM::BytecodeTargetOptions bytecodeOptions;
+  std::string bytecode;
+  llvm::raw_string_ostream bytecodeStream(bytecode);
+  if (failed(IREE::VM::translateModuleToBytecode(moduleOp, bytecodeOptions,
+                                                 bytecodeStream))) {
+    moduleOp.erase();
+    return targetOp.emitError() << "failed to serialize VMLA bytecode module";
+  }
+  bytecodeStream.flush();
+
+  // Add the binary data to the target executable.
+  OpBuilder targetBuilder(&targetOp.getBlock());
+  targetBuilder.setInsertionPoint(&targetOp.getBlock().back());
+  auto binaryOp = targetBuilder.create<IREE::HAL::ExecutableBinaryOp>(
+      targetOp.getLoc(),
+      static_cast<uint32_t>(IREE::HAL::ExecutableFormat::VMLA),
+      std::vector<uint8_t>(bytecode.begin(), bytecode.end()));
+  binaryOp.getBlock().getOperations().insert(
+      Block::iterator(binaryOp.getBlock().back()), moduleOp);
   return success();
 }
 
 static ExecutableTargetRegistration targetRegistration(
-    "vm-la",
+    "vmla",
     +[](IREE::Flow::ExecutableOp sourceOp, IREE::HAL::ExecutableOp targetOp,
         ExecutableTargetOptions executableOptions) {
       return translateToVMLAExecutable(sourceOp, targetOp, executableOptions,
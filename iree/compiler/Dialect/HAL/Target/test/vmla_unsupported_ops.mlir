@@ -0,0 +1,18 @@
+// RUN: iree-opt -split-input-file -iree-hal-translate-executables -iree-hal-target-backends=vmla -verify-diagnostics %s
+
+// expected-error@+1 {{failed translation to target vmla}}
+flow.executable @unsupportedOps_ex_dispatch_0 {
+  flow.dispatch.entry @unsupportedOps_rgn_dispatch_0 attributes {
+      workload = dense<[4, 4, 1]> : vector<3xi32>
+  }
+  module {
+    func @unsupportedOps_rgn_dispatch_0(%arg0: tensor<4x4xf32>) -> tensor<4x4xf32> {
+      // expected-error@+1 {{'xla_hlo.transpose' op is not supported by the VMLA backend}}
+      %0 = "xla_hlo.transpose"(%arg0) {permutation = dense<[1, 0]> : tensor<2xi64>} : (tensor<4x4xf32>) -> tensor<4x4xf32>
+      %1 = xla_hlo.add %0, %arg0 : tensor<4x4xf32>
+      // expected-error@+1 {{'xla_hlo.reverse' op is not supported by the VMLA backend}}
+      %2 = "xla_hlo.reverse"(%1) {dimensions = dense<[0]> : tensor<1xi64>} : (tensor<4x4xf32>) -> tensor<4x4xf32>
+      return %2 : tensor<4x4xf32>
+    }
+  }
+}
@@ -51,6 +51,19 @@ vm.import @ex.submit_and_wait(
   %command_buffer : !iree.ref<!hal.command_buffer>
 )
 
+// Submits the command buffer without waiting and returns a fence that is
+// signaled when execution completes.
+vm.import @ex.submit(
+  %device : !iree.ref<!hal.device>,
+  %command_buffer : !iree.ref<!hal.command_buffer>
+) -> !iree.ref<!hal.fence>
+
+// Waits for the fence returned by a prior ex.submit to be signaled.
+vm.import @ex.wait_fence(
+  %device : !iree.ref<!hal.device>,
+  %fence : !iree.ref<!hal.fence>
+)
+
 //===----------------------------------------------------------------------===//
 // iree::hal::Allocator
 //===----------------------------------------------------------------------===//
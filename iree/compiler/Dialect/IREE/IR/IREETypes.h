@@ -34,6 +34,7 @@ enum Kind {
 
   FIRST_HAL_TYPE = Type::FIRST_IREE_TYPE + 20,
   FIRST_SEQ_TYPE = Type::FIRST_IREE_TYPE + 40,
+  FIRST_VMLA_TYPE = Type::FIRST_IREE_TYPE + 50,
 };
 }  // namespace TypeKind
 
@@ -68,6 +69,14 @@ enum Kind {
 }  // namespace TypeKind
 }  // namespace SEQ
 
+namespace VMLA {
+namespace TypeKind {
+enum Kind {
+  Buffer = IREE::TypeKind::FIRST_VMLA_TYPE,
+};
+}  // namespace TypeKind
+}  // namespace VMLA
+
 /// Base type for RefObject-derived types.
 /// These can be wrapped in RefPtrType.
 class RefObjectType : public Type {
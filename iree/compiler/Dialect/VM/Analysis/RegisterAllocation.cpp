@@ -118,12 +118,19 @@ struct RegisterUsage {
 
   Optional<uint8_t> allocateRegister(Type type) {
     if (type.isIntOrIndexOrFloat()) {
+      // 64-bit values need two consecutive free registers.
+      int width = isWideRegisterType(type) ? 2 : 1;
       int ordinal = intRegisters.find_first_unset();
-      if (ordinal >= kIntRegisterCount) {
+      while (ordinal != -1 && width == 2 && ordinal + 1 < kIntRegisterCount &&
+             intRegisters.test(ordinal + 1)) {
+        ordinal = intRegisters.find_next_unset(ordinal);
+      }
+      if (ordinal == -1 || ordinal + width > kIntRegisterCount) {
         return {};
       }
-      intRegisters.set(ordinal);
-      maxI32RegisterOrdinal = std::max(ordinal, maxI32RegisterOrdinal);
+      intRegisters.set(ordinal, ordinal + width);
+      maxI32RegisterOrdinal =
+          std::max(ordinal + width - 1, maxI32RegisterOrdinal);
       return makeRegisterByte(type, ordinal, /*isMove=*/false);
     } else {
       int ordinal = refRegisters.find_first_unset();
@@ -136,22 +143,25 @@ struct RegisterUsage {
     }
   }
 
-  void markRegisterUsed(uint8_t reg) {
+  void markRegisterUsed(uint8_t reg, Type type) {
     int ordinal = getRegisterOrdinal(reg);
     if (isRefRegister(reg)) {
       refRegisters.set(ordinal);
       maxRefRegisterOrdinal = std::max(ordinal, maxRefRegisterOrdinal);
     } else {
-      intRegisters.set(ordinal);
-      maxI32RegisterOrdinal = std::max(ordinal, maxI32RegisterOrdinal);
+      int width = isWideRegisterType(type) ? 2 : 1;
+      intRegisters.set(ordinal, ordinal + width);
+      maxI32RegisterOrdinal =
+          std::max(ordinal + width - 1, maxI32RegisterOrdinal);
     }
   }
 
-  void releaseRegister(uint8_t reg) {
+  void releaseRegister(uint8_t reg, Type type) {
     if (isRefRegister(reg)) {
       refRegisters.reset(reg & 0x3F);
     } else {
-      intRegisters.reset(reg & 0x7F);
+      int ordinal = reg & 0x7F;
+      intRegisters.reset(ordinal, ordinal + (isWideRegisterType(type) ? 2 : 1));
     }
   }
 };
@@ -204,6 +214,7 @@ LogicalResult RegisterAllocation::recalculate(IREE::VM::FuncOp funcOp) {
   // We are accumulating value->register mappings in |map_| as we go and since
   // we are traversing in order know that for each block we will have values in
   // the |map_| for all implicitly captured values.
+  bool hasWideRegisters = false;
   auto orderedBlocks = sortBlocksInDominanceOrder(funcOp);
   for (auto *block : orderedBlocks) {
     // Use the block live-in info to populate the register usage info at block
@@ -212,11 +223,13 @@ LogicalResult RegisterAllocation::recalculate(IREE::VM::FuncOp funcOp) {
     // only working with the minimal set.
     RegisterUsage registerUsage;
     for (auto liveInValue : liveness_.getBlockLiveIns(block)) {
-      registerUsage.markRegisterUsed(mapToRegister(liveInValue));
+      registerUsage.markRegisterUsed(mapToRegister(liveInValue),
+                                     liveInValue.getType());
     }
 
     // Allocate arguments first from left-to-right.
     for (auto blockArg : block->getArguments()) {
+      hasWideRegisters |= isWideRegisterType(blockArg.getType());
       auto reg = registerUsage.allocateRegister(blockArg.getType());
       if (!reg.hasValue()) {
         return funcOp.emitError() << "register allocation failed for block arg "
@@ -231,17 +244,19 @@ LogicalResult RegisterAllocation::recalculate(IREE::VM::FuncOp funcOp) {
     // removes unused block arguments would prevent this from happening.
     for (auto blockArg : block->getArguments()) {
       if (blockArg.use_empty()) {
-        registerUsage.releaseRegister(map_[blockArg]);
+        registerUsage.releaseRegister(map_[blockArg], blockArg.getType());
       }
     }
 
     for (auto &op : block->getOperations()) {
       for (auto &operand : op.getOpOperands()) {
         if (liveness_.isLastValueUse(operand.get(), &op)) {
-          registerUsage.releaseRegister(map_[operand.get()]);
+          registerUsage.releaseRegister(map_[operand.get()],
+                                        operand.get().getType());
         }
       }
       for (auto result : op.getResults()) {
+        hasWideRegisters |= isWideRegisterType(result.getType());
         auto reg = registerUsage.allocateRegister(result.getType());
         if (!reg.hasValue()) {
           return op.emitError() << "register allocation failed for result "
@@ -249,7 +264,7 @@ LogicalResult RegisterAllocation::recalculate(IREE::VM::FuncOp funcOp) {
         }
         map_[result] = reg.getValue();
         if (result.use_empty()) {
-          registerUsage.releaseRegister(reg.getValue());
+          registerUsage.releaseRegister(reg.getValue(), result.getType());
         }
       }
     }
@@ -265,9 +280,12 @@ LogicalResult RegisterAllocation::recalculate(IREE::VM::FuncOp funcOp) {
   // These scratch registers are used during remapping registers during branches
   // that may have hazards (such as a remap set of 0->1 and 1->0). If we
   // precomputed whether remappings were required here then we could avoid this
-  // but it doesn't seem worth it for a single register (yet).
+  // but it doesn't seem worth it for a single register (yet). 64-bit values are
+  // remapped as two independent halves so a swap of two of them needs two.
+  scratchI32RegisterCount_ = 0;
   if (maxI32RegisterOrdinal_ > 0) {
-    ++maxI32RegisterOrdinal_;
+    scratchI32RegisterCount_ = hasWideRegisters ? 2 : 1;
+    maxI32RegisterOrdinal_ += scratchI32RegisterCount_;
   }
   if (maxRefRegisterOrdinal_ > 0) {
     ++maxRefRegisterOrdinal_;
@@ -500,6 +518,9 @@ RegisterAllocation::remapSuccessorRegisters(Operation *op, int successorIndex) {
     uint8_t dstReg = mapToRegister(targetArg);
     if (!compareRegistersEqual(srcReg, dstReg)) {
       srcDstRegs.push_back({srcReg, dstReg});
+      if (isWideRegisterType(targetArg.getType())) {
+        srcDstRegs.push_back({srcReg + 1, dstReg + 1});
+      }
     }
   }
 
@@ -517,16 +538,25 @@ RegisterAllocation::remapSuccessorRegisters(Operation *op, int successorIndex) {
     return feedbackArcSet.acyclicEdges;
   }
 
-  assert(feedbackArcSet.feedbackEdges.size() == 1 &&
+  int feedbackRefEdgeCount = llvm::count_if(
+      feedbackArcSet.feedbackEdges, [](const FeedbackArcSet::Edge &edge) {
+        return isRefRegister(edge.first);
+      });
+  int feedbackI32EdgeCount =
+      feedbackArcSet.feedbackEdges.size() - feedbackRefEdgeCount;
+  assert(feedbackRefEdgeCount <= 1 &&
+         feedbackI32EdgeCount <= scratchI32RegisterCount_ &&
          "liveness tracking of scratch registers not yet implemented");
+  (void)feedbackI32EdgeCount;
 
-  // The last register in each bank is reserved for swapping, when required.
-  uint8_t scratchI32Reg = maxI32RegisterOrdinal_;
+  // The last registers in each bank are reserved for swapping, when required.
   uint8_t scratchRefReg = kRefRegisterTypeBit | maxRefRegisterOrdinal_;
+  uint8_t nextScratchI32Reg = maxI32RegisterOrdinal_;
 
   for (auto feedbackEdge : feedbackArcSet.feedbackEdges) {
-    uint8_t scratchReg =
-        isRefRegister(feedbackEdge.first) ? scratchRefReg : scratchI32Reg;
+    uint8_t scratchReg = isRefRegister(feedbackEdge.first)
+                             ? scratchRefReg
+                             : nextScratchI32Reg--;
     feedbackArcSet.acyclicEdges.insert(feedbackArcSet.acyclicEdges.begin(),
                                        {feedbackEdge.first, scratchReg});
     feedbackArcSet.acyclicEdges.push_back({scratchReg, feedbackEdge.second});
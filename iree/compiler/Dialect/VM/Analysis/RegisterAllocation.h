@@ -24,12 +24,18 @@ namespace mlir {
 namespace iree_compiler {
 
 // The VM contains multiple register banks:
-// - 128 32-bit integer registers
+// - 128 32-bit primitive registers
+//   - i32 and f32 values use a single register
+//   - i64 and f64 values use two consecutive registers
 //   - may be aliased as 32 128-bit registers
 // - 64 ref_ptr registers
 //
 // Registers are represented in bytecode as an 8-bit integer with the high bit
-// indicating whether it is from the integer (0b0) or ref_ptr bank (0b1).
+// indicating whether it is from the primitive (0b0) or ref_ptr bank (0b1).
+// 64-bit values are referenced by the ordinal of their first register. When
+// passed in register lists (such as call arguments and results) they expand to
+// both of their registers so that the lists can be remapped register by
+// register.
 //
 // ref_ptr register bytes also include a bit denoting whether the register
 // reference has move semantics. When set the VM can assume that the value is
@@ -42,6 +48,11 @@ constexpr int kRefRegisterCount = 64;
 constexpr uint8_t kRefRegisterTypeBit = 0x80;
 constexpr uint8_t kRefRegisterMoveBit = 0x40;
 
+// Returns true if values of |type| span two consecutive primitive registers.
+inline bool isWideRegisterType(Type type) {
+  return type.isInteger(64) || type.isF64();
+}
+
 // Returns true if |reg| is a register in the ref_ptr bank.
 constexpr bool isRefRegister(uint8_t reg) {
   return (reg & kRefRegisterTypeBit) == kRefRegisterTypeBit;
@@ -115,6 +126,9 @@ class RegisterAllocation {
   int maxI32RegisterOrdinal_ = -1;
   int maxRefRegisterOrdinal_ = -1;
 
+  // Number of scratch registers reserved at the end of the primitive bank.
+  int scratchI32RegisterCount_ = 0;
+
   // Cached liveness information.
   ValueLiveness liveness_;
 
@@ -69,6 +69,18 @@ vm.module @module {
     vm.return %0 : i32
   }
 
+  // CHECK-LABEL: @wide_values
+  vm.func @wide_values(%arg0 : i32, %arg1 : i64) -> i64 {
+    // CHECK: vm.ext.i32.i64.s
+    // CHECK-SAME: block_registers = ["0", "1"]
+    // CHECK-SAME: result_registers = ["3"]
+    %0 = vm.ext.i32.i64.s %arg0 : i32 -> i64
+    // CHECK: vm.add.i64
+    // CHECK-SAME: result_registers = ["0"]
+    %1 = vm.add.i64 %0, %arg1 : i64
+    vm.return %1 : i64
+  }
+
   // CHECK-LABEL: @branch_args_cycle
   vm.func @branch_args_cycle(%arg0 : i32, %arg1 : i32) -> i32 {
     // CHECK: vm.br
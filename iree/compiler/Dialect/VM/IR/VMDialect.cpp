@@ -52,10 +52,11 @@ struct VMOpAsmInterface : public OpAsmDialectInterface {
       os << globalLoadOp.global();
     } else if (isa<ConstRefZeroOp>(op)) {
       os << "null";
-    } else if (isa<ConstI32ZeroOp>(op)) {
+    } else if (isa<ConstI32ZeroOp>(op) || isa<ConstI64ZeroOp>(op) ||
+               isa<ConstF32ZeroOp>(op) || isa<ConstF64ZeroOp>(op)) {
       os << "zero";
-    } else if (auto constOp = dyn_cast<ConstI32Op>(op)) {
-      if (auto intAttr = constOp.value().dyn_cast<IntegerAttr>()) {
+    } else if (isa<ConstI32Op>(op) || isa<ConstI64Op>(op)) {
+      if (auto intAttr = op->getAttrOfType<IntegerAttr>("value")) {
         if (intAttr.getValue() == 0) {
           os << "zero";
         } else {
@@ -68,18 +69,24 @@ struct VMOpAsmInterface : public OpAsmDialectInterface {
       os << rodataOp.rodata();
     } else if (op->getResult(0).getType().isa<RefPtrType>()) {
       os << "ref";
-    } else if (isa<CmpEQI32Op>(op)) {
+    } else if (isa<CmpEQI32Op>(op) || isa<CmpEQI64Op>(op) ||
+               isa<CmpEQF32Op>(op) || isa<CmpEQF64Op>(op)) {
       os << "eq";
-    } else if (isa<CmpNEI32Op>(op)) {
+    } else if (isa<CmpNEI32Op>(op) || isa<CmpNEI64Op>(op) ||
+               isa<CmpNEF32Op>(op) || isa<CmpNEF64Op>(op)) {
       os << "ne";
-    } else if (isa<CmpLTI32SOp>(op)) {
+    } else if (isa<CmpLTI32SOp>(op) || isa<CmpLTI64SOp>(op)) {
       os << "slt";
-    } else if (isa<CmpLTI32UOp>(op)) {
+    } else if (isa<CmpLTI32UOp>(op) || isa<CmpLTI64UOp>(op)) {
       os << "ult";
-    } else if (isa<CmpLTEI32SOp>(op)) {
+    } else if (isa<CmpLTF32Op>(op) || isa<CmpLTF64Op>(op)) {
+      os << "lt";
+    } else if (isa<CmpLTEI32SOp>(op) || isa<CmpLTEI64SOp>(op)) {
       os << "slte";
-    } else if (isa<CmpLTEI32UOp>(op)) {
+    } else if (isa<CmpLTEI32UOp>(op) || isa<CmpLTEI64UOp>(op)) {
       os << "ulte";
+    } else if (isa<CmpLTEF32Op>(op) || isa<CmpLTEF64Op>(op)) {
+      os << "lte";
     } else if (isa<CmpGTI32SOp>(op)) {
       os << "sgt";
     } else if (isa<CmpGTI32UOp>(op)) {
@@ -187,7 +194,17 @@ VMDialect::VMDialect(MLIRContext *context)
 
 Operation *VMDialect::materializeConstant(OpBuilder &builder, Attribute value,
                                           Type type, Location loc) {
-  if (ConstI32Op::isBuildableWith(value, type)) {
+  if (type.isInteger(64) && ConstI64Op::isBuildableWith(value, type)) {
+    auto convertedValue = ConstI64Op::convertConstValue(value);
+    if (convertedValue.cast<IntegerAttr>().getValue() == 0) {
+      return builder.create<VM::ConstI64ZeroOp>(loc);
+    }
+    return builder.create<VM::ConstI64Op>(loc, convertedValue);
+  } else if (type.isF32() && ConstF32Op::isBuildableWith(value, type)) {
+    return builder.create<VM::ConstF32Op>(loc, value);
+  } else if (type.isF64() && ConstF64Op::isBuildableWith(value, type)) {
+    return builder.create<VM::ConstF64Op>(loc, value);
+  } else if (ConstI32Op::isBuildableWith(value, type)) {
     auto convertedValue = ConstI32Op::convertConstValue(value);
     if (convertedValue.cast<IntegerAttr>().getValue() == 0) {
       return builder.create<VM::ConstI32ZeroOp>(loc);
@@ -627,19 +627,19 @@ static LogicalResult verifyGlobalResetRefOp(GlobalResetRefOp &op) {
 // Constants
 //===----------------------------------------------------------------------===//
 
-static ParseResult parseConstI32Op(OpAsmParser &parser,
-                                   OperationState *result) {
+template <typename T>
+static ParseResult parseConstOp(OpAsmParser &parser, OperationState *result) {
   Attribute valueAttr;
   SmallVector<NamedAttribute, 1> dummyAttrs;
   if (failed(parser.parseAttribute(valueAttr, "value", dummyAttrs))) {
     return parser.emitError(parser.getCurrentLocation())
            << "Invalid attribute encoding";
   }
-  if (!ConstI32Op::isBuildableWith(valueAttr, valueAttr.getType())) {
+  if (!T::isBuildableWith(valueAttr, valueAttr.getType())) {
     return parser.emitError(parser.getCurrentLocation())
            << "Incompatible type or invalid type value formatting";
   }
-  valueAttr = ConstI32Op::convertConstValue(valueAttr);
+  valueAttr = T::convertConstValue(valueAttr);
   result->addAttribute("value", valueAttr);
   if (failed(parser.parseOptionalAttrDict(result->attributes))) {
     return parser.emitError(parser.getCurrentLocation())
@@ -648,14 +648,16 @@ static ParseResult parseConstI32Op(OpAsmParser &parser,
   return parser.addTypeToList(valueAttr.getType(), result->types);
 }
 
-static void printConstI32Op(OpAsmPrinter &p, ConstI32Op &op) {
+template <typename T>
+static void printConstOp(OpAsmPrinter &p, T &op) {
   p << op.getOperationName() << ' ';
   p.printAttribute(op.value());
   p.printOptionalAttrDict(op.getAttrs(), /*elidedAttrs=*/{"value"});
 }
 
-// static
-bool ConstI32Op::isBuildableWith(Attribute value, Type type) {
+// Returns true if |value| is an integer attribute of |type| that can be
+// converted to a constant integer value.
+static bool isConstIntegerBuildableWith(Attribute value, Type type) {
   // FlatSymbolRefAttr can only be used with a function type.
   if (value.isa<FlatSymbolRefAttr>()) {
     return false;
@@ -673,23 +675,23 @@ bool ConstI32Op::isBuildableWith(Attribute value, Type type) {
                                            .isa<IntegerType>());
 }
 
-// static
-Attribute ConstI32Op::convertConstValue(Attribute value) {
-  assert(isBuildableWith(value, value.getType()));
+// Converts |value| to an integer attribute of the given |bitWidth|,
+// truncating or zero extending as required.
+static Attribute convertConstIntegerValue(Attribute value, int bitWidth) {
+  assert(isConstIntegerBuildableWith(value, value.getType()));
   Builder builder(value.getContext());
+  auto integerType = builder.getIntegerType(bitWidth);
   int32_t dims = 1;
-  Attribute newValue;
   if (value.isa<UnitAttr>()) {
-    return builder.getI32IntegerAttr(1);
+    return builder.getIntegerAttr(integerType, 1);
   } else if (auto v = value.dyn_cast<BoolAttr>()) {
-    return builder.getI32IntegerAttr(v.getValue() ? 1 : 0);
+    return builder.getIntegerAttr(integerType, v.getValue() ? 1 : 0);
   } else if (auto v = value.dyn_cast<IntegerAttr>()) {
-    return builder.getI32IntegerAttr(
-        static_cast<int32_t>(v.getValue().getLimitedValue()));
+    return builder.getIntegerAttr(integerType,
+                                  v.getValue().zextOrTrunc(bitWidth));
   } else if (auto v = value.dyn_cast<ElementsAttr>()) {
     dims = v.getNumElements();
-    ShapedType adjustedType =
-        VectorType::get({dims}, builder.getIntegerType(32));
+    ShapedType adjustedType = VectorType::get({dims}, integerType);
     if (auto elements = v.dyn_cast<SplatElementsAttr>()) {
       return SplatElementsAttr::get(adjustedType, elements.getSplatValue());
     } else {
@@ -701,6 +703,53 @@ Attribute ConstI32Op::convertConstValue(Attribute value) {
   return Attribute();
 }
 
+// Returns true if |value| is a floating-point attribute of |type| that can be
+// converted to a constant floating-point value.
+static bool isConstFloatBuildableWith(Attribute value, Type type) {
+  if (value.getType() != type) {
+    return false;
+  }
+  return value.isa<FloatAttr>() ||
+         (value.isa<ElementsAttr>() && value.cast<ElementsAttr>()
+                                           .getType()
+                                           .getElementType()
+                                           .isa<FloatType>());
+}
+
+// Converts |value| to a floating-point attribute of |floatType|, rounding to
+// nearest if the value is not exactly representable.
+static Attribute convertConstFloatValue(Attribute value, FloatType floatType) {
+  assert(isConstFloatBuildableWith(value, value.getType()));
+  if (auto v = value.dyn_cast<FloatAttr>()) {
+    APFloat floatValue = v.getValue();
+    bool losesInfo = false;
+    floatValue.convert(floatType.getFloatSemantics(),
+                       APFloat::rmNearestTiesToEven, &losesInfo);
+    return FloatAttr::get(floatType, floatValue);
+  } else if (auto v = value.dyn_cast<ElementsAttr>()) {
+    int32_t dims = v.getNumElements();
+    ShapedType adjustedType = VectorType::get({dims}, floatType);
+    if (auto elements = v.dyn_cast<SplatElementsAttr>()) {
+      return SplatElementsAttr::get(adjustedType, elements.getSplatValue());
+    } else {
+      return DenseElementsAttr::get(
+          adjustedType, llvm::to_vector<4>(v.getValues<Attribute>()));
+    }
+  }
+  llvm_unreachable("unexpected attribute type");
+  return Attribute();
+}
+
+// static
+bool ConstI32Op::isBuildableWith(Attribute value, Type type) {
+  return isConstIntegerBuildableWith(value, type);
+}
+
+// static
+Attribute ConstI32Op::convertConstValue(Attribute value) {
+  return convertConstIntegerValue(value, 32);
+}
+
 void ConstI32Op::build(Builder *builder, OperationState &result,
                        Attribute value) {
   Attribute newValue = convertConstValue(value);
@@ -713,12 +762,80 @@ void ConstI32Op::build(Builder *builder, OperationState &result,
   return build(builder, result, builder->getI32IntegerAttr(value));
 }
 
-static ParseResult parseConstI32ZeroOp(OpAsmParser &parser,
-                                       OperationState *result) {
+// static
+bool ConstI64Op::isBuildableWith(Attribute value, Type type) {
+  return isConstIntegerBuildableWith(value, type);
+}
+
+// static
+Attribute ConstI64Op::convertConstValue(Attribute value) {
+  return convertConstIntegerValue(value, 64);
+}
+
+void ConstI64Op::build(Builder *builder, OperationState &result,
+                       Attribute value) {
+  Attribute newValue = convertConstValue(value);
+  result.addAttribute("value", newValue);
+  result.addTypes(newValue.getType());
+}
+
+void ConstI64Op::build(Builder *builder, OperationState &result,
+                       int64_t value) {
+  return build(builder, result, builder->getI64IntegerAttr(value));
+}
+
+// static
+bool ConstF32Op::isBuildableWith(Attribute value, Type type) {
+  return isConstFloatBuildableWith(value, type);
+}
+
+// static
+Attribute ConstF32Op::convertConstValue(Attribute value) {
+  return convertConstFloatValue(value,
+                                FloatType::getF32(value.getContext()));
+}
+
+void ConstF32Op::build(Builder *builder, OperationState &result,
+                       Attribute value) {
+  Attribute newValue = convertConstValue(value);
+  result.addAttribute("value", newValue);
+  result.addTypes(newValue.getType());
+}
+
+void ConstF32Op::build(Builder *builder, OperationState &result,
+                       float value) {
+  return build(builder, result, builder->getF32FloatAttr(value));
+}
+
+// static
+bool ConstF64Op::isBuildableWith(Attribute value, Type type) {
+  return isConstFloatBuildableWith(value, type);
+}
+
+// static
+Attribute ConstF64Op::convertConstValue(Attribute value) {
+  return convertConstFloatValue(value,
+                                FloatType::getF64(value.getContext()));
+}
+
+void ConstF64Op::build(Builder *builder, OperationState &result,
+                       Attribute value) {
+  Attribute newValue = convertConstValue(value);
+  result.addAttribute("value", newValue);
+  result.addTypes(newValue.getType());
+}
+
+void ConstF64Op::build(Builder *builder, OperationState &result,
+                       double value) {
+  return build(builder, result, builder->getF64FloatAttr(value));
+}
+
+static ParseResult parseConstZeroOp(OpAsmParser &parser,
+                                    OperationState *result) {
   Type valueType;
   if (failed(parser.parseColonType(valueType))) {
     return parser.emitError(parser.getCurrentLocation())
-           << "Invalid integer type";
+           << "Invalid value type";
   }
   if (failed(parser.parseOptionalAttrDict(result->attributes))) {
     return parser.emitError(parser.getCurrentLocation())
@@ -727,17 +844,29 @@ static ParseResult parseConstI32ZeroOp(OpAsmParser &parser,
   return parser.addTypeToList(valueType, result->types);
 }
 
-static void printConstI32ZeroOp(OpAsmPrinter &p, ConstI32ZeroOp &op) {
-  p << op.getOperationName();
+static void printConstZeroOp(OpAsmPrinter &p, Operation *op) {
+  p << op->getName();
   p << " : ";
-  p.printType(op.getResult().getType());
-  p.printOptionalAttrDict(op.getAttrs());
+  p.printType(op->getResult(0).getType());
+  p.printOptionalAttrDict(op->getAttrs());
 }
 
 void ConstI32ZeroOp::build(Builder *builder, OperationState &result) {
   result.addTypes(builder->getIntegerType(32));
 }
 
+void ConstI64ZeroOp::build(Builder *builder, OperationState &result) {
+  result.addTypes(builder->getIntegerType(64));
+}
+
+void ConstF32ZeroOp::build(Builder *builder, OperationState &result) {
+  result.addTypes(builder->getF32Type());
+}
+
+void ConstF64ZeroOp::build(Builder *builder, OperationState &result) {
+  result.addTypes(builder->getF64Type());
+}
+
 static ParseResult parseConstRefZeroOp(OpAsmParser &parser,
                                        OperationState *result) {
   Type objectType;
@@ -938,6 +1067,29 @@ static void printShiftArithmeticOp(OpAsmPrinter &p, Operation *op) {
 // Casting and type conversion/emulation
 //===----------------------------------------------------------------------===//
 
+static ParseResult parseConversionOp(OpAsmParser &parser,
+                                     OperationState *result) {
+  OpAsmParser::OperandType op;
+  Type sourceType;
+  Type resultType;
+  if (failed(parser.parseOperand(op)) ||
+      failed(parser.parseOptionalAttrDict(result->attributes)) ||
+      failed(parser.parseColonType(sourceType)) ||
+      failed(parser.parseArrow()) || failed(parser.parseType(resultType)) ||
+      failed(parser.resolveOperand(op, sourceType, result->operands))) {
+    return failure();
+  }
+  result->addTypes({resultType});
+  return success();
+}
+
+static void printConversionOp(OpAsmPrinter &p, Operation *op) {
+  p << op->getName() << ' ' << op->getOperand(0);
+  p.printOptionalAttrDict(op->getAttrs());
+  p << " : " << op->getOperand(0).getType() << " -> "
+    << op->getResult(0).getType();
+}
+
 //===----------------------------------------------------------------------===//
 // Native reduction (horizontal) arithmetic
 //===----------------------------------------------------------------------===//
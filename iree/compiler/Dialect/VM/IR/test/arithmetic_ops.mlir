@@ -153,3 +153,46 @@ vm.module @my_module {
     vm.return %0 : i32
   }
 }
+
+// -----
+
+// CHECK-LABEL: @arithmetic_i64
+vm.module @my_module {
+  vm.func @arithmetic_i64(%arg0 : i64, %arg1 : i64) -> i64 {
+    // CHECK: %0 = vm.add.i64 %arg0, %arg1 : i64
+    %0 = vm.add.i64 %arg0, %arg1 : i64
+    // CHECK-NEXT: %1 = vm.div.i64.u %0, %arg1 : i64
+    %1 = vm.div.i64.u %0, %arg1 : i64
+    // CHECK-NEXT: %2 = vm.not.i64 %1 : i64
+    %2 = vm.not.i64 %1 : i64
+    // CHECK-NEXT: %3 = vm.shr.i64.s %2, 33 : i64
+    %3 = vm.shr.i64.s %2, 33 : i64
+    vm.return %3 : i64
+  }
+}
+
+// -----
+
+// CHECK-LABEL: @arithmetic_f32
+vm.module @my_module {
+  vm.func @arithmetic_f32(%arg0 : f32, %arg1 : f32) -> f32 {
+    // CHECK: %0 = vm.mul.f32 %arg0, %arg1 : f32
+    %0 = vm.mul.f32 %arg0, %arg1 : f32
+    // CHECK-NEXT: %1 = vm.abs.f32 %0 : f32
+    %1 = vm.abs.f32 %0 : f32
+    vm.return %1 : f32
+  }
+}
+
+// -----
+
+// CHECK-LABEL: @arithmetic_f64
+vm.module @my_module {
+  vm.func @arithmetic_f64(%arg0 : f64, %arg1 : f64) -> f64 {
+    // CHECK: %0 = vm.sub.f64 %arg0, %arg1 : f64
+    %0 = vm.sub.f64 %arg0, %arg1 : f64
+    // CHECK-NEXT: %1 = vm.neg.f64 %0 : f64
+    %1 = vm.neg.f64 %0 : f64
+    vm.return %1 : f64
+  }
+}
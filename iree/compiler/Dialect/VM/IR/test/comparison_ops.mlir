@@ -144,3 +144,29 @@ vm.module @my_module {
     vm.return %rnz : i32
   }
 }
+
+// -----
+
+// CHECK-LABEL: @cmp_i64
+vm.module @my_module {
+  vm.func @cmp_i64(%arg0 : i64, %arg1 : i64) -> (i32, i32) {
+    // CHECK: %eq = vm.cmp.eq.i64 %arg0, %arg1 : i64
+    %eq = vm.cmp.eq.i64 %arg0, %arg1 : i64
+    // CHECK: %slt = vm.cmp.lt.i64.s %arg0, %arg1 : i64
+    %slt = vm.cmp.lt.i64.s %arg0, %arg1 : i64
+    vm.return %eq, %slt : i32, i32
+  }
+}
+
+// -----
+
+// CHECK-LABEL: @cmp_f32
+vm.module @my_module {
+  vm.func @cmp_f32(%arg0 : f32, %arg1 : f32) -> (i32, i32) {
+    // CHECK: %ne = vm.cmp.ne.f32 %arg0, %arg1 : f32
+    %ne = vm.cmp.ne.f32 %arg0, %arg1 : f32
+    // CHECK: %lte = vm.cmp.lte.f32 %arg0, %arg1 : f32
+    %lte = vm.cmp.lte.f32 %arg0, %arg1 : f32
+    vm.return %ne, %lte : i32, i32
+  }
+}
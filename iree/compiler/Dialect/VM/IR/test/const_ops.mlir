@@ -44,3 +44,42 @@ vm.module @my_module {
     vm.return %buf0 : !iree.byte_buffer_ref
   }
 }
+
+// -----
+
+vm.module @my_module {
+  // CHECK-LABEL: @const_i64
+  vm.func @const_i64() -> (i64, i64) {
+    // CHECK: %zero = vm.const.i64.zero : i64
+    %zero = vm.const.i64.zero : i64
+    // CHECK: %c-1 = vm.const.i64 -1 : i64
+    %c-1 = vm.const.i64 -1 : i64
+    vm.return %zero, %c-1 : i64, i64
+  }
+}
+
+// -----
+
+vm.module @my_module {
+  // CHECK-LABEL: @const_f32
+  vm.func @const_f32() -> (f32, f32) {
+    // CHECK: %zero = vm.const.f32.zero : f32
+    %zero = vm.const.f32.zero : f32
+    // CHECK: %0 = vm.const.f32 1.500000e+00 : f32
+    %0 = vm.const.f32 1.5 : f32
+    vm.return %zero, %0 : f32, f32
+  }
+}
+
+// -----
+
+vm.module @my_module {
+  // CHECK-LABEL: @const_f64
+  vm.func @const_f64() -> (f64, f64) {
+    // CHECK: %zero = vm.const.f64.zero : f64
+    %zero = vm.const.f64.zero : f64
+    // CHECK: %0 = vm.const.f64 2.500000e-01 : f64
+    %0 = vm.const.f64 0.25 : f64
+    vm.return %zero, %0 : f64, f64
+  }
+}
@@ -25,3 +25,20 @@ vm.module @my_module {
     vm.return %1 : i32
   }
 }
+
+// -----
+
+// CHECK-LABEL: @conversions_64
+vm.module @my_module {
+  vm.func @conversions_64(%arg0 : i32) -> i32 {
+    // CHECK: %0 = vm.ext.i32.i64.u %arg0 : i32 -> i64
+    %0 = vm.ext.i32.i64.u %arg0 : i32 -> i64
+    // CHECK-NEXT: %1 = vm.cast.si64.f64 %0 : i64 -> f64
+    %1 = vm.cast.si64.f64 %0 : i64 -> f64
+    // CHECK-NEXT: %2 = vm.trunc.f64.f32 %1 : f64 -> f32
+    %2 = vm.trunc.f64.f32 %1 : f64 -> f32
+    // CHECK-NEXT: %3 = vm.cast.f32.si32 %2 : f32 -> i32
+    %3 = vm.cast.f32.si32 %2 : f32 -> i32
+    vm.return %3 : i32
+  }
+}
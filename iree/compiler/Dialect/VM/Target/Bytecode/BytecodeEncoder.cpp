@@ -14,6 +14,8 @@
 
 #include "iree/compiler/Dialect/VM/Target/Bytecode/BytecodeEncoder.h"
 
+#include <algorithm>
+
 #include "iree/compiler/Dialect/IREE/IR/IREETypes.h"
 #include "iree/compiler/Dialect/VM/Analysis/RegisterAllocation.h"
 #include "iree/compiler/Dialect/VM/IR/VMDialect.h"
@@ -103,6 +105,22 @@ class V0BytecodeEncoder : public BytecodeEncoder {
         return writeUint16(static_cast<uint16_t>(limitedValue));
       case 32:
         return writeUint32(static_cast<uint32_t>(limitedValue));
+      case 64:
+        return writeUint64(limitedValue);
+      default:
+        return currentOp_->emitOpError()
+               << "attribute of bitwidth " << bitWidth << " not supported";
+    }
+  }
+
+  LogicalResult encodeFloatAttr(FloatAttr value) override {
+    int bitWidth = value.getType().getIntOrFloatBitWidth();
+    APInt bits = value.getValue().bitcastToAPInt();
+    switch (bitWidth) {
+      case 32:
+        return writeUint32(static_cast<uint32_t>(bits.getZExtValue()));
+      case 64:
+        return writeUint64(bits.getZExtValue());
       default:
         return currentOp_->emitOpError()
                << "attribute of bitwidth " << bitWidth << " not supported";
@@ -144,9 +162,21 @@ class V0BytecodeEncoder : public BytecodeEncoder {
     // Compute required remappings - we only need to emit them when the source
     // and dest registers differ. Hopefully the allocator did a good job and
     // this list is small :)
+    //
+    // The list is split by register bank with all i32 pairs before all ref
+    // pairs so that the runtime can remap each bank without checking the type
+    // of every register. Order within each bank is preserved.
     auto srcDstRegs = registerAllocation_->remapSuccessorRegisters(
         currentOp_, successorIndex);
-    writeUint8(srcDstRegs.size());
+    auto refBegin = std::stable_partition(
+        srcDstRegs.begin(), srcDstRegs.end(),
+        [](std::pair<uint8_t, uint8_t> srcDstReg) {
+          return !isRefRegister(srcDstReg.first);
+        });
+    if (failed(writeUint8(std::distance(srcDstRegs.begin(), refBegin))) ||
+        failed(writeUint8(std::distance(refBegin, srcDstRegs.end())))) {
+      return failure();
+    }
     for (auto srcDstReg : srcDstRegs) {
       if (failed(writeUint8(srcDstReg.first)) ||
           failed(writeUint8(srcDstReg.second))) {
@@ -164,11 +194,13 @@ class V0BytecodeEncoder : public BytecodeEncoder {
   }
 
   LogicalResult encodeOperands(Operation::operand_range values) override {
-    writeUint8(std::distance(values.begin(), values.end()));
+    if (failed(writeRegisterListSize(values))) {
+      return failure();
+    }
     for (auto it : llvm::enumerate(values)) {
       uint8_t reg = registerAllocation_->mapUseToRegister(
           it.value(), currentOp_, it.index());
-      if (failed(writeUint8(reg))) {
+      if (failed(writeRegisterListEntry(reg, it.value().getType()))) {
         return failure();
       }
     }
@@ -181,10 +213,12 @@ class V0BytecodeEncoder : public BytecodeEncoder {
   }
 
   LogicalResult encodeResults(Operation::result_range values) override {
-    writeUint8(std::distance(values.begin(), values.end()));
+    if (failed(writeRegisterListSize(values))) {
+      return failure();
+    }
     for (auto value : values) {
       uint8_t reg = registerAllocation_->mapToRegister(value);
-      if (failed(writeUint8(reg))) {
+      if (failed(writeRegisterListEntry(reg, value.getType()))) {
         return failure();
       }
     }
@@ -234,6 +268,31 @@ class V0BytecodeEncoder : public BytecodeEncoder {
     return writeBytes(&value, sizeof(value));
   }
 
+  LogicalResult writeUint64(uint64_t value) {
+    return writeBytes(&value, sizeof(value));
+  }
+
+  // Writes the size of a register list holding |values|.
+  // 64-bit values occupy two entries in the list (see RegisterAllocation.h).
+  template <typename RangeT>
+  LogicalResult writeRegisterListSize(RangeT values) {
+    int size = 0;
+    for (auto value : values) {
+      size += isWideRegisterType(value.getType()) ? 2 : 1;
+    }
+    if (size > UINT8_MAX) {
+      return currentOp_->emitOpError() << "register list size out of bounds";
+    }
+    return writeUint8(size);
+  }
+
+  // Writes the register list entries for |reg| holding a value of |type|.
+  LogicalResult writeRegisterListEntry(uint8_t reg, Type type) {
+    if (failed(writeUint8(reg))) return failure();
+    if (isWideRegisterType(type)) return writeUint8(reg + 1);
+    return success();
+  }
+
   LogicalResult fixupOffsets() {
     for (const auto &fixup : blockOffsetFixups_) {
       auto blockOffset = blockOffsets_.find(fixup.first);
@@ -258,6 +317,97 @@ class V0BytecodeEncoder : public BytecodeEncoder {
   std::vector<std::pair<Block *, size_t>> blockOffsetFixups_;
 };
 
+//===----------------------------------------------------------------------===//
+// Superinstruction selection
+//===----------------------------------------------------------------------===//
+// Common op sequences are encoded as a single fused opcode to reduce the
+// number of dispatches in hot loops. These are selected here instead of as
+// IR rewrites as the fused forms have no meaning outside of the bytecode.
+
+// Returns the fused compare-and-branch opcode for |op| if it is an i32
+// comparison whose result is only used as the condition of |nextOp|.
+static Optional<Opcode> matchFusedCondBranch(Operation *op,
+                                             Operation *nextOp) {
+  auto condBranchOp = dyn_cast_or_null<CondBranchOp>(nextOp);
+  if (!condBranchOp || op->getNumResults() != 1 ||
+      !op->getResult(0).hasOneUse() ||
+      condBranchOp.getCondition() != op->getResult(0)) {
+    return llvm::None;
+  }
+  if (isa<CmpEQI32Op>(op)) return Opcode::CondBranchEQI32;
+  if (isa<CmpNEI32Op>(op)) return Opcode::CondBranchNEI32;
+  if (isa<CmpLTI32SOp>(op)) return Opcode::CondBranchLTI32S;
+  if (isa<CmpLTI32UOp>(op)) return Opcode::CondBranchLTI32U;
+  if (isa<CmpLTEI32SOp>(op)) return Opcode::CondBranchLTEI32S;
+  if (isa<CmpLTEI32UOp>(op)) return Opcode::CondBranchLTEI32U;
+  if (isa<CmpGTI32SOp>(op)) return Opcode::CondBranchGTI32S;
+  if (isa<CmpGTI32UOp>(op)) return Opcode::CondBranchGTI32U;
+  if (isa<CmpGTEI32SOp>(op)) return Opcode::CondBranchGTEI32S;
+  if (isa<CmpGTEI32UOp>(op)) return Opcode::CondBranchGTEI32U;
+  return llvm::None;
+}
+
+// Returns the index of the operand of |addOp| that will be encoded as an
+// immediate in a fused vm.add.i32 with a vm.const.i32 operand, if any.
+static Optional<unsigned> matchFusedAddImmOperand(AddI32Op addOp) {
+  if (isa_and_nonnull<ConstI32Op>(addOp.rhs().getDefiningOp())) return 1u;
+  if (isa_and_nonnull<ConstI32Op>(addOp.lhs().getDefiningOp())) return 0u;
+  return llvm::None;
+}
+
+// Returns true if all uses of |constOp| have been folded into fused
+// immediates and the constant itself need not be encoded.
+static bool isFoldedIntoFusedUses(ConstI32Op constOp) {
+  if (constOp.getResult().use_empty()) return false;
+  for (auto &use : constOp.getResult().getUses()) {
+    auto addOp = dyn_cast<AddI32Op>(use.getOwner());
+    if (!addOp) return false;
+    auto immOperand = matchFusedAddImmOperand(addOp);
+    if (!immOperand || immOperand.getValue() != use.getOperandNumber()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Encodes |cmpOp| and the vm.cond_br |condBranchOp| consuming its result as a
+// single fused compare-and-branch |opcode|.
+static LogicalResult encodeFusedCondBranch(Operation *cmpOp,
+                                           CondBranchOp condBranchOp,
+                                           Opcode opcode,
+                                           BytecodeEncoder &e) {
+  if (failed(e.beginOp(cmpOp)) ||
+      failed(e.encodeOpcode(stringifyOpcode(opcode),
+                            static_cast<int>(opcode))) ||
+      failed(e.encodeOperand(cmpOp->getOperand(0), 0)) ||
+      failed(e.encodeOperand(cmpOp->getOperand(1), 1)) ||
+      failed(e.endOp(cmpOp))) {
+    return failure();
+  }
+  return failure(
+      failed(e.beginOp(condBranchOp)) ||
+      failed(e.encodeBranch(condBranchOp.getTrueDest(),
+                            condBranchOp.getTrueOperands(), 0)) ||
+      failed(e.encodeBranch(condBranchOp.getFalseDest(),
+                            condBranchOp.getFalseOperands(), 1)) ||
+      failed(e.endOp(condBranchOp)));
+}
+
+// Encodes |addOp| with the vm.const.i32 operand |immOperand| as a fused
+// add-immediate.
+static LogicalResult encodeFusedAddImm(AddI32Op addOp, unsigned immOperand,
+                                       BytecodeEncoder &e) {
+  auto constOp = cast<ConstI32Op>(addOp.getOperand(immOperand).getDefiningOp());
+  unsigned srcOperand = immOperand == 0 ? 1 : 0;
+  return failure(
+      failed(e.beginOp(addOp)) ||
+      failed(e.encodeOpcode(stringifyOpcode(Opcode::AddI32Imm),
+                            static_cast<int>(Opcode::AddI32Imm))) ||
+      failed(e.encodeOperand(addOp.getOperand(srcOperand), srcOperand)) ||
+      failed(e.encodeIntAttr(constOp.getAttrOfType<IntegerAttr>("value"))) ||
+      failed(e.encodeResult(addOp.result())) || failed(e.endOp(addOp)));
+}
+
 }  // namespace
 
 // static
@@ -283,7 +433,34 @@ Optional<EncodedBytecodeFunction> BytecodeEncoder::encodeFunction(
       return llvm::None;
     }
 
-    for (auto &op : block.getOperations()) {
+    for (auto it = block.begin(); it != block.end(); ++it) {
+      auto &op = *it;
+
+      // Try to select a superinstruction for the op (and possibly its
+      // successor) before falling back to the op's own encoding.
+      auto nextIt = std::next(it);
+      auto *nextOp = nextIt != block.end() ? &*nextIt : nullptr;
+      if (auto fusedOpcode = matchFusedCondBranch(&op, nextOp)) {
+        if (failed(encodeFusedCondBranch(&op, cast<CondBranchOp>(nextOp),
+                                         fusedOpcode.getValue(), encoder))) {
+          op.emitOpError() << "failed to encode fused cond_br";
+          return llvm::None;
+        }
+        it = nextIt;
+        continue;
+      } else if (auto constOp = dyn_cast<ConstI32Op>(&op)) {
+        if (isFoldedIntoFusedUses(constOp)) continue;
+      } else if (auto addOp = dyn_cast<AddI32Op>(&op)) {
+        if (auto immOperand = matchFusedAddImmOperand(addOp)) {
+          if (failed(encodeFusedAddImm(addOp, immOperand.getValue(),
+                                       encoder))) {
+            op.emitOpError() << "failed to encode fused add";
+            return llvm::None;
+          }
+          continue;
+        }
+      }
+
       auto *serializableOp =
           op.getAbstractOperation()->getInterface<IREE::VM::VMSerializableOp>();
       if (!serializableOp) {
@@ -18,6 +18,7 @@
 
 #include "flatbuffers/flatbuffers.h"
 #include "flatbuffers/minireflect.h"
+#include "iree/base/lz4.h"
 #include "iree/compiler/Dialect/IREE/IR/IREETypes.h"
 #include "iree/compiler/Dialect/VM/Analysis/RegisterAllocation.h"
 #include "iree/compiler/Dialect/VM/Analysis/ValueLiveness.h"
@@ -251,6 +252,59 @@ static Offset<iree::vm::FunctionSignatureDef> makeFunctionSignatureDef(
   return fsd.Finish();
 }
 
+// Rodata segments smaller than this are never compressed as the savings would
+// not be worth the decompression.
+static constexpr size_t kMinCompressedRodataSize = 256;
+
+// Serialized contents of a rodata segment.
+struct SerializedRodata {
+  Offset<Vector<uint8_t>> dataOffset;
+  // Size of the data once decompressed or 0 if the data is uncompressed.
+  uint64_t uncompressedSize = 0;
+};
+
+// Serializes the contents of |rodataOp|, compressing them if enabled and the
+// compressed data is at least 1/8th smaller.
+static Optional<SerializedRodata> serializeRodata(
+    IREE::VM::RodataOp rodataOp, BytecodeTargetOptions targetOptions,
+    FlatBufferBuilder &fbb) {
+  SerializedRodata result;
+  if (!targetOptions.compressRodata) {
+    result.dataOffset =
+        serializeConstant(rodataOp.getLoc(), rodataOp.value(), fbb);
+    if (result.dataOffset.IsNull()) return llvm::None;
+    return result;
+  }
+
+  // Serialize to a scratch buffer so that we can decide whether to keep the
+  // compressed or uncompressed form.
+  FlatBufferBuilder scratchFbb;
+  auto scratchOffset =
+      serializeConstant(rodataOp.getLoc(), rodataOp.value(), scratchFbb);
+  if (scratchOffset.IsNull()) return llvm::None;
+  const auto *scratchData =
+      flatbuffers::GetTemporaryPointer(scratchFbb, scratchOffset);
+  if (scratchData->size() >= kMinCompressedRodataSize) {
+    std::vector<uint8_t> compressedData(
+        iree_lz4_compress_bound(scratchData->size()));
+    iree_host_size_t compressedLength = 0;
+    if (iree_lz4_compress({scratchData->Data(), scratchData->size()},
+                          {compressedData.data(), compressedData.size()},
+                          &compressedLength) != IREE_STATUS_OK) {
+      return llvm::None;
+    }
+    if (compressedLength <= scratchData->size() - scratchData->size() / 8) {
+      result.dataOffset =
+          fbb.CreateVector(compressedData.data(), compressedLength);
+      result.uncompressedSize = scratchData->size();
+      return result;
+    }
+  }
+  result.dataOffset =
+      fbb.CreateVector(scratchData->Data(), scratchData->size());
+  return result;
+}
+
 // Builds a complete BytecodeModuleDef FlatBuffer object in |fbb|.
 // The order of the encoding is ordered to ensure that all metadata is at the
 // front of the resulting buffer. Large read-only data and bytecode blobs always
@@ -291,16 +345,25 @@ static Offset<iree::vm::BytecodeModuleDef> buildFlatBufferModule(
   // Serialize read-only data first so that it ends up at the end of the file.
   // This is where large things like parameters live and we don't want that to
   // get paged in until it is needed.
-  std::vector<Offset<Vector<uint8_t>>> rodataContentOffsets;
-  rodataContentOffsets.reserve(rodataOps.size());
+  //
+  // Attributes are uniqued so rodata with identical contents shares the same
+  // value attribute and the serialized data can be shared by all segments.
+  std::vector<SerializedRodata> rodataContents;
+  rodataContents.reserve(rodataOps.size());
+  llvm::DenseMap<Attribute, size_t> uniqueRodataContents;
   for (auto rodataOp : rodataOps) {
-    auto dataOffset =
-        serializeConstant(rodataOp.getLoc(), rodataOp.value(), fbb);
-    if (dataOffset.IsNull()) {
+    auto it = uniqueRodataContents.find(rodataOp.value());
+    if (it != uniqueRodataContents.end()) {
+      rodataContents.push_back(rodataContents[it->second]);
+      continue;
+    }
+    auto serializedRodata = serializeRodata(rodataOp, targetOptions, fbb);
+    if (!serializedRodata) {
       rodataOp.emitOpError() << "failed to encode";
       return {};
     }
-    rodataContentOffsets.push_back(dataOffset);
+    uniqueRodataContents[rodataOp.value()] = rodataContents.size();
+    rodataContents.push_back(serializedRodata.getValue());
   }
 
   // Find all types in the module to build the type table.
@@ -347,9 +410,19 @@ static Offset<iree::vm::BytecodeModuleDef> buildFlatBufferModule(
   // Serialize metadata that should be near the front of the file.
   std::vector<Offset<iree::vm::RodataSegmentDef>> rodataSegmentOffsets;
   rodataSegmentOffsets.reserve(rodataOps.size());
-  for (auto rodataContentOffset : rodataContentOffsets) {
+  for (auto &rodataContent : rodataContents) {
+    Offset<iree::vm::LZ4CompressedDataDef> lz4Offset;
+    if (rodataContent.uncompressedSize) {
+      lz4Offset = iree::vm::CreateLZ4CompressedDataDef(
+          fbb, rodataContent.uncompressedSize);
+    }
     iree::vm::RodataSegmentDefBuilder rsd(fbb);
-    rsd.add_data(rodataContentOffset);
+    if (!lz4Offset.IsNull()) {
+      rsd.add_compression_type_type(
+          iree::vm::CompressionTypeDef::LZ4CompressedDataDef);
+      rsd.add_compression_type(lz4Offset.Union());
+    }
+    rsd.add_data(rodataContent.dataOffset);
     rodataSegmentOffsets.push_back(rsd.Finish());
   }
   std::vector<Offset<iree::vm::RwdataSegmentDef>> rwdataSegmentOffsets;
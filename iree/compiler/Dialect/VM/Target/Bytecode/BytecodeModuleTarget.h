@@ -53,6 +53,10 @@ struct BytecodeTargetOptions {
   bool stripSourceMap = false;
   // Strips vm ops with the VM_DebugOnly trait.
   bool stripDebugOps = false;
+
+  // Compresses rodata segments that benefit from it. Compressed segments are
+  // decompressed by the runtime on first use.
+  bool compressRodata = false;
 };
 
 // Translates a vm.module to a bytecode module flatbuffer.
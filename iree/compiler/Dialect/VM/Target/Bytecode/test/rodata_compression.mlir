@@ -0,0 +1,27 @@
+// RUN: iree-translate -iree-vm-ir-to-bytecode-module -iree-vm-bytecode-module-output-format=flatbuffer-text -iree-vm-bytecode-module-compress-rodata %s | IreeFileCheck %s
+
+// CHECK: name: "rodata_compression"
+vm.module @rodata_compression {
+  // Large compressible segments are compressed and identical segments share
+  // their data.
+  vm.rodata @zeros dense<0> : tensor<1024xi32>
+  vm.rodata @zeros_dup dense<0> : tensor<1024xi32>
+  // Small segments are always stored uncompressed.
+  vm.rodata @small dense<[1, 2, 3]> : tensor<3xi32>
+
+  vm.export @func
+  vm.func @func() -> (!iree.byte_buffer_ref, !iree.byte_buffer_ref,
+                      !iree.byte_buffer_ref) {
+    %0 = vm.const.ref.rodata @zeros : !iree.byte_buffer_ref
+    %1 = vm.const.ref.rodata @zeros_dup : !iree.byte_buffer_ref
+    %2 = vm.const.ref.rodata @small : !iree.byte_buffer_ref
+    vm.return %0, %1, %2 : !iree.byte_buffer_ref, !iree.byte_buffer_ref,
+                           !iree.byte_buffer_ref
+  }
+
+  // CHECK: rodata_segments: [
+  // CHECK: uncompressed_size: 4096
+  // CHECK: uncompressed_size: 4096
+  // CHECK-NOT: uncompressed_size
+  // CHECK: data: [ 1, 0, 0, 0, 2, 0, 0, 0, 3, 0, 0, 0 ]
+}
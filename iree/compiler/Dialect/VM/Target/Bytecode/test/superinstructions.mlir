@@ -0,0 +1,39 @@
+// RUN: iree-translate -split-input-file -iree-vm-ir-to-bytecode-module -iree-vm-bytecode-module-output-format=flatbuffer-text %s | IreeFileCheck %s
+
+// CHECK: name: "fused_cond_branch"
+vm.module @fused_cond_branch {
+  vm.export @func
+  vm.func @func(%arg0 : i32, %arg1 : i32) -> i32 {
+    %0 = vm.cmp.lt.i32.s %arg0, %arg1 : i32
+    vm.cond_br %0, ^bb1, ^bb2
+  ^bb1:
+    vm.return %arg0 : i32
+  ^bb2:
+    vm.return %arg1 : i32
+  }
+
+  // CondBranchLTI32S lhs rhs, ^bb1 (no remaps), ^bb2 (no remaps).
+  // CHECK: function_descriptors:
+  // CHECK-NEXT: bytecode_offset: 0
+  // CHECK-NEXT: bytecode_length: 21
+  // CHECK: bytecode_data: [ 211, 0, 1, 15, 0, 0, 0, 0, 0, 18, 0, 0, 0, 0, 0, 84, 1, 0, 84, 1, 1 ]
+}
+
+// -----
+
+// CHECK: name: "fused_add_imm"
+vm.module @fused_add_imm {
+  vm.export @func
+  vm.func @func(%arg0 : i32) -> i32 {
+    %c5 = vm.const.i32 5 : i32
+    %0 = vm.add.i32 %arg0, %c5 : i32
+    vm.return %0 : i32
+  }
+
+  // The constant is folded into the AddI32Imm and not encoded on its own.
+  // CHECK: function_descriptors:
+  // CHECK-NEXT: bytecode_offset: 0
+  // CHECK-NEXT: bytecode_length: 10
+  // CHECK: bytecode_data: [ 208, 0, 5, 0, 0, 0, [[RESULT:[0-9]+]], 84, 1, [[RESULT]] ]
+}
+
@@ -30,11 +30,11 @@ using ::llvm::formatv;
 using ::llvm::Record;
 
 // Finds all serializable ops and emits a enum and template table for their
-// opcode and name.
+// opcode and name. Opcodes that have no op (such as the fused
+// superinstructions selected by the bytecode encoder) are included as well.
 bool emitOpTableDefs(const llvm::RecordKeeper &recordKeeper, raw_ostream &os) {
   llvm::emitSourceFileHeader("IREE VM Operation Tables", os);
 
-  std::vector<const Record *> opRecords(256);
   std::vector<const Record *> opEncodings(256);
   auto defs = recordKeeper.getAllDerivedDefinitions("VM_Op");
   for (const auto *def : defs) {
@@ -43,18 +43,19 @@ bool emitOpTableDefs(const llvm::RecordKeeper &recordKeeper, raw_ostream &os) {
     for (auto encodingExpr : encodingExprs) {
       if (encodingExpr->getType()->getAsString() == "VM_EncOpcode") {
         auto *opcode = encodingExpr->getValueAsDef("opcode");
-        opRecords[opcode->getValueAsInt("value")] = def;
         opEncodings[opcode->getValueAsInt("value")] = opcode;
         break;
       }
     }
   }
+  for (const auto *opcode : recordKeeper.getAllDerivedDefinitions("VM_OPC")) {
+    auto &opEncoding = opEncodings[opcode->getValueAsInt("value")];
+    if (!opEncoding) opEncoding = opcode;
+  }
 
   os << "typedef enum {\n";
   for (int i = 0; i < 256; ++i) {
-    auto *def = opRecords[i];
-    if (def) {
-      auto *opcode = opEncodings[i];
+    if (auto *opcode = opEncodings[i]) {
       os << formatv("  IREE_VM_OP_{0} = {1}",
                     opcode->getValueAsString("symbol"), format_hex(i, 4, true));
     } else {
@@ -67,9 +68,7 @@ bool emitOpTableDefs(const llvm::RecordKeeper &recordKeeper, raw_ostream &os) {
 
   os << "#define IREE_VM_OP_TABLE(OPC, RSV) \\\n";
   for (int i = 0; i < 256; ++i) {
-    auto *def = opRecords[i];
-    if (def) {
-      auto *opcode = opEncodings[i];
+    if (auto *opcode = opEncodings[i]) {
       os << formatv("    OPC({0}, {1})", format_hex(i, 4, true),
                     opcode->getValueAsString("symbol"));
     } else {
@@ -14,6 +14,8 @@
 
 #include "iree/compiler/Dialect/VM/Transforms/Passes.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
 #include "mlir/IR/Attributes.h"
 #include "mlir/IR/MLIRContext.h"
 #include "mlir/Pass/Pass.h"
@@ -37,6 +39,10 @@ namespace VM {
 // optimize the time spent moving a physical laser carridge around. Functions
 // related to each other and global data accessed in proximity should be
 // clustered together to make use of paging in memory mapped files.
+//
+// Exports and imports are the exception: they are assigned ordinals in name
+// order so that the runtime can binary search their tables when resolving
+// functions by name.
 class OrdinalAllocationPass
     : public OperationPass<OrdinalAllocationPass, ModuleOp> {
  public:
@@ -49,14 +55,16 @@ class OrdinalAllocationPass
     int nextGlobalBytesOrdinal = 0;
     int nextGlobalRefOrdinal = 0;
     int nextRodataOrdinal = 0;
+    SmallVector<ExportOp, 8> exportOps;
+    SmallVector<ImportOp, 8> importOps;
     for (auto &op : getOperation().getBlock().getOperations()) {
       Optional<int> ordinal = llvm::None;
       if (auto funcOp = dyn_cast<FuncOp>(op)) {
         ordinal = nextFuncOrdinal++;
-      } else if (isa<ExportOp>(op)) {
-        ordinal = nextExportOrdinal++;
-      } else if (isa<ImportOp>(op)) {
-        ordinal = nextImportOrdinal++;
+      } else if (auto exportOp = dyn_cast<ExportOp>(op)) {
+        exportOps.push_back(exportOp);
+      } else if (auto importOp = dyn_cast<ImportOp>(op)) {
+        importOps.push_back(importOp);
       } else if (isa<GlobalI32Op>(op)) {
         ordinal = nextGlobalBytesOrdinal;
         nextGlobalBytesOrdinal += 4;
@@ -69,6 +77,21 @@ class OrdinalAllocationPass
         op.setAttr("ordinal", builder.getI32IntegerAttr(ordinal.getValue()));
       }
     }
+
+    llvm::sort(exportOps, [](ExportOp lhs, ExportOp rhs) {
+      return lhs.export_name() < rhs.export_name();
+    });
+    for (auto exportOp : exportOps) {
+      exportOp.setAttr("ordinal",
+                       builder.getI32IntegerAttr(nextExportOrdinal++));
+    }
+    llvm::sort(importOps, [](ImportOp lhs, ImportOp rhs) {
+      return lhs.getName() < rhs.getName();
+    });
+    for (auto importOp : importOps) {
+      importOp.setAttr("ordinal",
+                       builder.getI32IntegerAttr(nextImportOrdinal++));
+    }
   }
 };
 
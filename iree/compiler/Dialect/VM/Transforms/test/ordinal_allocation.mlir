@@ -0,0 +1,35 @@
+// RUN: iree-opt -split-input-file -pass-pipeline='vm.module(iree-vm-ordinal-allocation)' %s | IreeFileCheck %s
+
+// CHECK-LABEL: @sortedExports
+vm.module @sortedExports {
+  // CHECK: vm.export @c attributes {ordinal = 2 : i32
+  vm.export @c
+  // CHECK: vm.export @a attributes {ordinal = 0 : i32
+  vm.export @a
+  // CHECK: vm.export @b as("a.b") attributes {ordinal = 1 : i32
+  vm.export @b as("a.b")
+  // CHECK: vm.func @c(){{.*}}ordinal = 0 : i32
+  vm.func @c() {
+    vm.return
+  }
+  // CHECK: vm.func @a(){{.*}}ordinal = 1 : i32
+  vm.func @a() {
+    vm.return
+  }
+  // CHECK: vm.func @b(){{.*}}ordinal = 2 : i32
+  vm.func @b() {
+    vm.return
+  }
+}
+
+// -----
+
+// CHECK-LABEL: @sortedImports
+vm.module @sortedImports {
+  // CHECK: vm.import @other.b({{.*}}ordinal = 2 : i32
+  vm.import @other.b(%arg : i32)
+  // CHECK: vm.import @other.a({{.*}}ordinal = 1 : i32
+  vm.import @other.a(%arg : i32)
+  // CHECK: vm.import @hal.z({{.*}}ordinal = 0 : i32
+  vm.import @hal.z(%arg : i32)
+}
@@ -0,0 +1,174 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/compiler/Dialect/VMLA/Conversion/VMLAToVM/ConvertVMLAToVM.h"
+
+#include <string>
+
+#include "iree/compiler/Dialect/VM/Conversion/ImportUtils.h"
+#include "iree/compiler/Dialect/VM/IR/VMOps.h"
+#include "iree/compiler/Dialect/VMLA/IR/VMLAOps.h"
+#include "mlir/IR/Attributes.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/StandardTypes.h"
+#include "mlir/Transforms/DialectConversion.h"
+
+namespace mlir {
+namespace iree_compiler {
+
+namespace {
+
+// Returns the import name suffix used for ops operating on |elementType|, such
+// as `f32` or `i32`.
+static std::string getElementTypeSuffix(Type elementType) {
+  if (auto integerType = elementType.dyn_cast<IntegerType>()) {
+    return "i" + std::to_string(integerType.getWidth());
+  } else if (auto floatType = elementType.dyn_cast<FloatType>()) {
+    return "f" + std::to_string(floatType.getWidth());
+  }
+  return "";
+}
+
+// Converts a typed VMLA op to a vm.call of the import specialized for the
+// element type of the op, such as vmla.add -> @vmla.add.f32.
+template <typename T>
+class VMLATypedImportOpConversion : public OpConversionPattern<T> {
+ public:
+  VMLATypedImportOpConversion(MLIRContext *context, SymbolTable &importSymbols,
+                              TypeConverter &typeConverter,
+                              StringRef importPrefix)
+      : OpConversionPattern<T>(context),
+        importSymbols(importSymbols),
+        importPrefix(importPrefix) {}
+
+  PatternMatchResult matchAndRewrite(
+      T op, llvm::ArrayRef<Value> operands,
+      ConversionPatternRewriter &rewriter) const override {
+    auto importName =
+        importPrefix + "." + getElementTypeSuffix(op.element_type());
+    auto importOp = importSymbols.lookup<IREE::VM::ImportOp>(importName);
+    if (!importOp) {
+      op.emitOpError() << "element type " << op.element_type()
+                       << " is not supported by the VMLA runtime";
+      return OpConversionPattern<T>::matchFailure();
+    }
+    rewriter.replaceOpWithNewOp<IREE::VM::CallOp>(
+        op, rewriter.getSymbolRefAttr(importOp),
+        importOp.getType().getResults(), operands);
+    return OpConversionPattern<T>::matchSuccess();
+  }
+
+ private:
+  SymbolTable &importSymbols;
+  std::string importPrefix;
+};
+
+// Encodes the constant value into a rodata segment and calls
+// @vmla.buffer.const to wrap it in a buffer.
+class BufferConstOpConversion
+    : public OpConversionPattern<IREE::VMLA::BufferConstOp> {
+ public:
+  BufferConstOpConversion(MLIRContext *context, SymbolTable &importSymbols,
+                          TypeConverter &typeConverter, StringRef importName)
+      : OpConversionPattern(context) {
+    importOp = importSymbols.lookup<IREE::VM::ImportOp>(importName);
+    assert(importOp);
+  }
+
+  PatternMatchResult matchAndRewrite(
+      IREE::VMLA::BufferConstOp op, llvm::ArrayRef<Value> operands,
+      ConversionPatternRewriter &rewriter) const override {
+    auto ip = rewriter.saveInsertionPoint();
+    auto parentFuncOp = op.getParentOfType<IREE::VM::FuncOp>();
+    rewriter.setInsertionPoint(parentFuncOp);
+    auto constName = (parentFuncOp.getName() + "_const_" +
+                      std::to_string(allocateUniqueId(parentFuncOp)))
+                         .str();
+    auto rodataOp =
+        rewriter.create<IREE::VM::RodataOp>(op.getLoc(), constName, op.value());
+    rewriter.restoreInsertionPoint(ip);
+    auto loadRodataOp =
+        rewriter.create<IREE::VM::ConstRefRodataOp>(op.getLoc(), rodataOp);
+
+    rewriter.replaceOpWithNewOp<IREE::VM::CallOp>(
+        op, rewriter.getSymbolRefAttr(importOp),
+        importOp.getType().getResults(),
+        ArrayRef<Value>{loadRodataOp.getResult()});
+    return matchSuccess();
+  }
+
+ private:
+  // TODO(b/145839814): find a name that's unique or make the rewriter support
+  // assigning unique names.
+  int allocateUniqueId(Operation *context) const {
+    if (uniqueContext != context) {
+      uniqueContext = context;
+      uniqueCounter = 0;
+    }
+    return uniqueCounter++;
+  }
+  mutable Operation *uniqueContext = nullptr;
+  mutable int uniqueCounter = 0;
+
+  mutable IREE::VM::ImportOp importOp;
+};
+
+}  // namespace
+
+void populateVMLAToVMPatterns(MLIRContext *context, SymbolTable &importSymbols,
+                              OwningRewritePatternList &patterns,
+                              TypeConverter &typeConverter) {
+  patterns.insert<VMImportOpConversion<IREE::VMLA::BufferAllocOp>>(
+      context, importSymbols, typeConverter, "vmla.buffer.alloc");
+  patterns.insert<BufferConstOpConversion>(context, importSymbols,
+                                           typeConverter, "vmla.buffer.const");
+  patterns.insert<VMImportOpConversion<IREE::VMLA::BufferCopyOp>>(
+      context, importSymbols, typeConverter, "vmla.buffer.copy");
+
+  patterns.insert<VMLATypedImportOpConversion<IREE::VMLA::AbsOp>>(
+      context, importSymbols, typeConverter, "vmla.abs");
+  patterns.insert<VMLATypedImportOpConversion<IREE::VMLA::NegOp>>(
+      context, importSymbols, typeConverter, "vmla.neg");
+  patterns.insert<VMLATypedImportOpConversion<IREE::VMLA::ExpOp>>(
+      context, importSymbols, typeConverter, "vmla.exp");
+  patterns.insert<VMLATypedImportOpConversion<IREE::VMLA::LogOp>>(
+      context, importSymbols, typeConverter, "vmla.log");
+  patterns.insert<VMLATypedImportOpConversion<IREE::VMLA::SqrtOp>>(
+      context, importSymbols, typeConverter, "vmla.sqrt");
+  patterns.insert<VMLATypedImportOpConversion<IREE::VMLA::RsqrtOp>>(
+      context, importSymbols, typeConverter, "vmla.rsqrt");
+  patterns.insert<VMLATypedImportOpConversion<IREE::VMLA::TanhOp>>(
+      context, importSymbols, typeConverter, "vmla.tanh");
+  patterns.insert<VMLATypedImportOpConversion<IREE::VMLA::FloorOp>>(
+      context, importSymbols, typeConverter, "vmla.floor");
+  patterns.insert<VMLATypedImportOpConversion<IREE::VMLA::CeilOp>>(
+      context, importSymbols, typeConverter, "vmla.ceil");
+  patterns.insert<VMLATypedImportOpConversion<IREE::VMLA::AddOp>>(
+      context, importSymbols, typeConverter, "vmla.add");
+  patterns.insert<VMLATypedImportOpConversion<IREE::VMLA::SubOp>>(
+      context, importSymbols, typeConverter, "vmla.sub");
+  patterns.insert<VMLATypedImportOpConversion<IREE::VMLA::MulOp>>(
+      context, importSymbols, typeConverter, "vmla.mul");
+  patterns.insert<VMLATypedImportOpConversion<IREE::VMLA::DivOp>>(
+      context, importSymbols, typeConverter, "vmla.div");
+  patterns.insert<VMLATypedImportOpConversion<IREE::VMLA::MinOp>>(
+      context, importSymbols, typeConverter, "vmla.min");
+  patterns.insert<VMLATypedImportOpConversion<IREE::VMLA::MaxOp>>(
+      context, importSymbols, typeConverter, "vmla.max");
+  patterns.insert<VMLATypedImportOpConversion<IREE::VMLA::MatMulOp>>(
+      context, importSymbols, typeConverter, "vmla.matmul");
+}
+
+}  // namespace iree_compiler
+}  // namespace mlir
@@ -0,0 +1,40 @@
+// RUN: iree-opt -split-input-file -iree-vm-conversion %s | IreeFileCheck %s
+
+// CHECK-LABEL: @buffer_alloc_copy
+module @buffer_alloc_copy {
+  func @fn(%arg0 : !iree.ref<!vmla.buffer>) -> !iree.ref<!vmla.buffer> {
+    %c0 = constant 0 : i32
+    %c16 = constant 16 : i32
+    // CHECK: %[[DST:.+]] = vm.call @vmla.buffer.alloc(%{{.+}}) : (i32) -> !iree.ref<!vmla.buffer>
+    %0 = "vmla.buffer.alloc"(%c16) : (i32) -> !iree.ref<!vmla.buffer>
+    // CHECK: vm.call @vmla.buffer.copy(%arg0, %{{.+}}, %[[DST]], %{{.+}}, %{{.+}})
+    "vmla.buffer.copy"(%arg0, %c0, %0, %c0, %c16) : (!iree.ref<!vmla.buffer>, i32, !iree.ref<!vmla.buffer>, i32, i32) -> ()
+    return %0 : !iree.ref<!vmla.buffer>
+  }
+}
+
+// -----
+
+// CHECK-LABEL: @buffer_const
+module @buffer_const {
+  // CHECK: vm.rodata @fn_const_0 dense<[1, 2, 3]> : tensor<3xi32>
+  func @fn() -> !iree.ref<!vmla.buffer> {
+    // CHECK: %[[RODATA:.+]] = vm.const.ref.rodata @fn_const_0 : !iree.byte_buffer_ref
+    // CHECK-NEXT: vm.call @vmla.buffer.const(%[[RODATA]])
+    %0 = "vmla.buffer.const"() {value = dense<[1, 2, 3]> : tensor<3xi32>} : () -> !iree.ref<!vmla.buffer>
+    return %0 : !iree.ref<!vmla.buffer>
+  }
+}
+
+// -----
+
+// CHECK-LABEL: @typed_ops
+module @typed_ops {
+  func @fn(%arg0 : !iree.ref<!vmla.buffer>, %arg1 : !iree.ref<!vmla.buffer>) {
+    // CHECK: vm.call @vmla.add.f32(%arg0, %arg0, %arg1)
+    "vmla.add"(%arg0, %arg0, %arg1) {element_type = f32} : (!iree.ref<!vmla.buffer>, !iree.ref<!vmla.buffer>, !iree.ref<!vmla.buffer>) -> ()
+    // CHECK: vm.call @vmla.neg.i32(%arg0, %arg1)
+    "vmla.neg"(%arg0, %arg1) {element_type = i32} : (!iree.ref<!vmla.buffer>, !iree.ref<!vmla.buffer>) -> ()
+    return
+  }
+}
@@ -0,0 +1,47 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef IREE_COMPILER_DIALECT_VMLA_IR_VMLATYPES_H_
+#define IREE_COMPILER_DIALECT_VMLA_IR_VMLATYPES_H_
+
+#include "iree/compiler/Dialect/IREE/IR/IREETypes.h"
+#include "mlir/IR/StandardTypes.h"
+#include "mlir/IR/TypeSupport.h"
+#include "mlir/IR/Types.h"
+#include "mlir/Support/LLVM.h"
+
+namespace mlir {
+namespace iree_compiler {
+namespace IREE {
+namespace VMLA {
+
+//===----------------------------------------------------------------------===//
+// RefObject types
+//===----------------------------------------------------------------------===//
+
+class BufferType : public Type::TypeBase<BufferType, RefObjectType> {
+ public:
+  using Base::Base;
+  static BufferType get(MLIRContext *context) {
+    return Base::get(context, TypeKind::Buffer);
+  }
+  static bool kindof(unsigned kind) { return kind == TypeKind::Buffer; }
+};
+
+}  // namespace VMLA
+}  // namespace IREE
+}  // namespace iree_compiler
+}  // namespace mlir
+
+#endif  // IREE_COMPILER_DIALECT_VMLA_IR_VMLATYPES_H_
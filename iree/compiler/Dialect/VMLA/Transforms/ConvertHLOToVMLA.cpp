@@ -0,0 +1,344 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <utility>
+
+#include "iree/compiler/Dialect/IREE/IR/IREETypes.h"
+#include "iree/compiler/Dialect/VMLA/IR/VMLAOps.h"
+#include "iree/compiler/Dialect/VMLA/IR/VMLATypes.h"
+#include "iree/compiler/Dialect/VMLA/Transforms/Passes.h"
+#include "llvm/ADT/STLExtras.h"
+#include "mlir/Dialect/StandardOps/Ops.h"
+#include "mlir/IR/Attributes.h"
+#include "mlir/IR/BlockAndValueMapping.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/Function.h"
+#include "mlir/IR/StandardTypes.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Pass/PassRegistry.h"
+#include "mlir/Support/LogicalResult.h"
+#include "tensorflow/compiler/mlir/xla/ir/hlo_ops.h"
+
+namespace mlir {
+namespace iree_compiler {
+namespace IREE {
+namespace VMLA {
+
+namespace {
+
+// Returns the byte length of a statically-shaped tensor of |type| or -1 if the
+// type cannot be stored in a VMLA buffer.
+static int64_t getStaticByteLength(ShapedType type) {
+  if (!type.hasStaticShape() || !type.getElementType().isIntOrFloat()) {
+    return -1;
+  }
+  auto elementBitWidth = type.getElementType().getIntOrFloatBitWidth();
+  if (elementBitWidth % 8 != 0) return -1;
+  return type.getNumElements() * (elementBitWidth / 8);
+}
+
+// Converts a single entry function body from tensors to VMLA buffers.
+class EntryFunctionConverter {
+ public:
+  EntryFunctionConverter(FuncOp oldFunction, FuncOp newFunction)
+      : oldFunction(oldFunction),
+        newFunction(newFunction),
+        builder(newFunction.getBody()) {}
+
+  LogicalResult convert() {
+    if (oldFunction.getBlocks().size() != 1) {
+      return oldFunction.emitError()
+             << "only single-block entry functions are supported";
+    }
+    auto &oldBlock = oldFunction.front();
+    auto *newBlock = builder.createBlock(&newFunction.getBody());
+    for (auto oldArg : oldBlock.getArguments()) {
+      mapping.map(oldArg, newBlock->addArgument(getBufferRefType()));
+    }
+    for (unsigned i = 0; i < oldFunction.getType().getNumResults(); ++i) {
+      outputArgs.push_back(newBlock->addArgument(getBufferRefType()));
+    }
+
+    builder.setInsertionPointToEnd(newBlock);
+    for (auto &oldOp : oldBlock) {
+      if (failed(convertOperation(&oldOp))) return failure();
+    }
+    elideOutputCopies();
+    return success();
+  }
+
+ private:
+  Type getBufferRefType() {
+    return RefPtrType::get(BufferType::get(builder.getContext()));
+  }
+
+  Value createI32Constant(Location loc, int64_t value) {
+    return builder.create<mlir::ConstantIntOp>(loc, value, 32).getResult();
+  }
+
+  // Allocates a new buffer large enough to hold the given tensor |value|.
+  // Returns nullptr and emits an error if the tensor type is unsupported.
+  Value allocateBufferFor(Value value) {
+    auto type = value.getType().dyn_cast<ShapedType>();
+    int64_t byteLength = type ? getStaticByteLength(type) : -1;
+    if (byteLength < 0) {
+      emitError(value.getLoc())
+          << "unsupported tensor type for VMLA buffers: " << value.getType();
+      return nullptr;
+    }
+    return builder
+        .create<BufferAllocOp>(value.getLoc(), getBufferRefType(),
+                               createI32Constant(value.getLoc(), byteLength))
+        .getResult();
+  }
+
+  // Returns the element type shared by all operands and results of |op| if it
+  // can be handled by a VMLA elementwise op. Returns nullptr and emits an
+  // error otherwise.
+  Type getElementwiseElementType(Operation *op) {
+    auto resultType = op->getResult(0).getType();
+    for (auto operand : op->getOperands()) {
+      if (operand.getType() != resultType) {
+        op->emitOpError()
+            << "implicit broadcasting is not yet supported by VMLA";
+        return nullptr;
+      }
+    }
+    auto elementType = resultType.cast<ShapedType>().getElementType();
+    if (!elementType.isF32() && !elementType.isInteger(32)) {
+      op->emitOpError() << "element type " << elementType
+                        << " is not supported by VMLA elementwise ops";
+      return nullptr;
+    }
+    return elementType;
+  }
+
+  template <typename T>
+  LogicalResult convertUnaryOp(Operation *op) {
+    auto elementType = getElementwiseElementType(op);
+    if (!elementType) return failure();
+    auto dst = allocateBufferFor(op->getResult(0));
+    if (!dst) return failure();
+    builder.create<T>(op->getLoc(), mapping.lookup(op->getOperand(0)), dst,
+                      TypeAttr::get(elementType));
+    mapping.map(op->getResult(0), dst);
+    return success();
+  }
+
+  template <typename T>
+  LogicalResult convertBinaryOp(Operation *op) {
+    auto elementType = getElementwiseElementType(op);
+    if (!elementType) return failure();
+    auto dst = allocateBufferFor(op->getResult(0));
+    if (!dst) return failure();
+    builder.create<T>(op->getLoc(), mapping.lookup(op->getOperand(0)),
+                      mapping.lookup(op->getOperand(1)), dst,
+                      TypeAttr::get(elementType));
+    mapping.map(op->getResult(0), dst);
+    return success();
+  }
+
+  LogicalResult convertConstant(Operation *op, ElementsAttr value) {
+    if (getStaticByteLength(value.getType()) < 0) {
+      return op->emitOpError() << "unsupported constant type for VMLA";
+    }
+    auto constOp = builder.create<BufferConstOp>(op->getLoc(),
+                                                 getBufferRefType(), value);
+    mapping.map(op->getResult(0), constOp.getResult());
+    return success();
+  }
+
+  LogicalResult convertDotOp(xla_hlo::DotOp op) {
+    auto lhsType = op.lhs().getType().cast<ShapedType>();
+    auto rhsType = op.rhs().getType().cast<ShapedType>();
+    if (lhsType.getRank() != 2 || rhsType.getRank() != 2 ||
+        !lhsType.getElementType().isF32() ||
+        lhsType.getElementType() != rhsType.getElementType()) {
+      return op.emitOpError() << "only 2D f32 matrix-matrix dots are "
+                                 "supported by VMLA";
+    }
+    auto dst = allocateBufferFor(op.getResult());
+    if (!dst) return failure();
+    auto loc = op.getLoc();
+    builder.create<MatMulOp>(
+        loc, mapping.lookup(op.lhs()), mapping.lookup(op.rhs()), dst,
+        createI32Constant(loc, lhsType.getDimSize(0)),
+        createI32Constant(loc, lhsType.getDimSize(1)),
+        createI32Constant(loc, rhsType.getDimSize(1)),
+        TypeAttr::get(lhsType.getElementType()));
+    mapping.map(op.getResult(), dst);
+    return success();
+  }
+
+  // Copies each returned buffer into its output argument.
+  LogicalResult convertReturnOp(mlir::ReturnOp op) {
+    auto loc = op.getLoc();
+    for (auto operand : llvm::enumerate(op.getOperands())) {
+      auto type = operand.value().getType().cast<ShapedType>();
+      auto zero = createI32Constant(loc, 0);
+      auto copyOp = builder.create<BufferCopyOp>(
+          loc, mapping.lookup(operand.value()), zero,
+          outputArgs[operand.index()], zero,
+          createI32Constant(loc, getStaticByteLength(type)));
+      outputCopies.push_back(copyOp);
+    }
+    builder.create<mlir::ReturnOp>(loc);
+    return success();
+  }
+
+  LogicalResult convertOperation(Operation *op) {
+    // Shape-only ops alias their operand buffer as the contents are unchanged.
+    if (isa<xla_hlo::ReshapeOp>(op) || isa<xla_hlo::CopyOp>(op)) {
+      mapping.map(op->getResult(0), mapping.lookup(op->getOperand(0)));
+      return success();
+    }
+
+    if (auto constOp = dyn_cast<xla_hlo::ConstOp>(op)) {
+      return convertConstant(op, constOp.value());
+    } else if (auto constOp = dyn_cast<mlir::ConstantOp>(op)) {
+      if (auto value = constOp.getValue().dyn_cast<ElementsAttr>()) {
+        return convertConstant(op, value);
+      }
+    } else if (auto dotOp = dyn_cast<xla_hlo::DotOp>(op)) {
+      return convertDotOp(dotOp);
+    } else if (auto returnOp = dyn_cast<mlir::ReturnOp>(op)) {
+      return convertReturnOp(returnOp);
+    }
+
+    if (isa<xla_hlo::AbsOp>(op)) return convertUnaryOp<AbsOp>(op);
+    if (isa<xla_hlo::NegOp>(op)) return convertUnaryOp<NegOp>(op);
+    if (isa<xla_hlo::ExpOp>(op)) return convertUnaryOp<ExpOp>(op);
+    if (isa<xla_hlo::LogOp>(op)) return convertUnaryOp<LogOp>(op);
+    if (isa<xla_hlo::SqrtOp>(op)) return convertUnaryOp<SqrtOp>(op);
+    if (isa<xla_hlo::RsqrtOp>(op)) return convertUnaryOp<RsqrtOp>(op);
+    if (isa<xla_hlo::TanhOp>(op)) return convertUnaryOp<TanhOp>(op);
+    if (isa<xla_hlo::FloorOp>(op)) return convertUnaryOp<FloorOp>(op);
+    if (isa<xla_hlo::CeilOp>(op)) return convertUnaryOp<CeilOp>(op);
+
+    if (isa<xla_hlo::AddOp>(op) || isa<mlir::AddFOp>(op) ||
+        isa<mlir::AddIOp>(op)) {
+      return convertBinaryOp<AddOp>(op);
+    } else if (isa<xla_hlo::SubOp>(op) || isa<mlir::SubFOp>(op) ||
+               isa<mlir::SubIOp>(op)) {
+      return convertBinaryOp<SubOp>(op);
+    } else if (isa<xla_hlo::MulOp>(op) || isa<mlir::MulFOp>(op) ||
+               isa<mlir::MulIOp>(op)) {
+      return convertBinaryOp<MulOp>(op);
+    } else if (isa<xla_hlo::DivOp>(op) || isa<mlir::DivFOp>(op)) {
+      return convertBinaryOp<DivOp>(op);
+    } else if (isa<xla_hlo::MinOp>(op)) {
+      return convertBinaryOp<MinOp>(op);
+    } else if (isa<xla_hlo::MaxOp>(op)) {
+      return convertBinaryOp<MaxOp>(op);
+    }
+
+    return op->emitOpError() << "not yet supported by the VMLA backend";
+  }
+
+  // Results computed into a freshly allocated buffer that is only copied to
+  // an output argument can be computed directly into the output argument.
+  void elideOutputCopies() {
+    for (auto copyOp : outputCopies) {
+      auto allocOp =
+          dyn_cast_or_null<BufferAllocOp>(copyOp.src().getDefiningOp());
+      if (!allocOp || !copyOp.dst().hasOneUse()) continue;
+      allocOp.getResult().replaceAllUsesWith(copyOp.dst());
+      copyOp.erase();
+      allocOp.erase();
+    }
+  }
+
+  FuncOp oldFunction;
+  FuncOp newFunction;
+  OpBuilder builder;
+  BlockAndValueMapping mapping;
+  SmallVector<Value, 4> outputArgs;
+  SmallVector<BufferCopyOp, 4> outputCopies;
+};
+
+class ConversionPass : public ModulePass<ConversionPass> {
+ public:
+  void runOnModule() override {
+    auto moduleOp = getModule();
+    Builder builder(moduleOp.getContext());
+    auto bufferRefType =
+        RefPtrType::get(BufferType::get(moduleOp.getContext()));
+
+    SmallVector<FuncOp, 4> entryFunctions;
+    for (auto funcOp : moduleOp.getOps<FuncOp>()) {
+      if (funcOp.getAttr("iree.executable.export")) {
+        entryFunctions.push_back(funcOp);
+      }
+    }
+
+    for (auto oldFunction : entryFunctions) {
+      auto oldFunctionType = oldFunction.getType();
+      SmallVector<Type, 4> newInputTypes(
+          oldFunctionType.getNumInputs() + oldFunctionType.getNumResults(),
+          bufferRefType);
+      auto newFunction = FuncOp::create(
+          oldFunction.getLoc(), oldFunction.getName(),
+          builder.getFunctionType(newInputTypes, {}));
+      for (auto attr : oldFunction.getAttrs()) {
+        if (attr.first != oldFunction.getTypeAttrName()) {
+          newFunction.setAttr(attr.first, attr.second);
+        }
+      }
+
+      // Insert the new function in place of the old one so that the order of
+      // functions in the module (and thus export ordinals) is preserved.
+      moduleOp.insert(Block::iterator(oldFunction.getOperation()),
+                      newFunction);
+      if (failed(EntryFunctionConverter(oldFunction, newFunction).convert())) {
+        return signalPassFailure();
+      }
+      oldFunction.erase();
+    }
+  }
+};
+
+}  // namespace
+
+bool isConvertibleOp(Operation *op) {
+  if (auto constOp = dyn_cast<mlir::ConstantOp>(op)) {
+    return constOp.getValue().isa<ElementsAttr>();
+  }
+  return isa<xla_hlo::ReshapeOp>(op) || isa<xla_hlo::CopyOp>(op) ||
+         isa<xla_hlo::ConstOp>(op) || isa<xla_hlo::DotOp>(op) ||
+         isa<mlir::ReturnOp>(op) || isa<xla_hlo::AbsOp>(op) ||
+         isa<xla_hlo::NegOp>(op) || isa<xla_hlo::ExpOp>(op) ||
+         isa<xla_hlo::LogOp>(op) || isa<xla_hlo::SqrtOp>(op) ||
+         isa<xla_hlo::RsqrtOp>(op) || isa<xla_hlo::TanhOp>(op) ||
+         isa<xla_hlo::FloorOp>(op) || isa<xla_hlo::CeilOp>(op) ||
+         isa<xla_hlo::AddOp>(op) || isa<mlir::AddFOp>(op) ||
+         isa<mlir::AddIOp>(op) || isa<xla_hlo::SubOp>(op) ||
+         isa<mlir::SubFOp>(op) || isa<mlir::SubIOp>(op) ||
+         isa<xla_hlo::MulOp>(op) || isa<mlir::MulFOp>(op) ||
+         isa<mlir::MulIOp>(op) || isa<xla_hlo::DivOp>(op) ||
+         isa<mlir::DivFOp>(op) || isa<xla_hlo::MinOp>(op) ||
+         isa<xla_hlo::MaxOp>(op);
+}
+
+std::unique_ptr<OpPassBase<ModuleOp>> createConversionPass() {
+  return std::make_unique<ConversionPass>();
+}
+
+static PassRegistration<ConversionPass> pass(
+    "iree-vmla-conversion",
+    "Converts xla_hlo/std tensor ops in entry functions to the VMLA dialect");
+
+}  // namespace VMLA
+}  // namespace IREE
+}  // namespace iree_compiler
+}  // namespace mlir
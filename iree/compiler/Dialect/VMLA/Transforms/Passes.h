@@ -0,0 +1,44 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef IREE_COMPILER_DIALECT_VMLA_TRANSFORMS_PASSES_H_
+#define IREE_COMPILER_DIALECT_VMLA_TRANSFORMS_PASSES_H_
+
+#include "mlir/IR/Module.h"
+#include "mlir/Pass/Pass.h"
+
+namespace mlir {
+namespace iree_compiler {
+namespace IREE {
+namespace VMLA {
+
+// Converts exported executable entry functions (those with the
+// `iree.executable.export` attribute) operating on tensors in the xla_hlo and
+// std dialects to the VMLA dialect operating on buffers.
+//
+// Entry functions are rewritten to take one !vmla.buffer ref per input
+// followed by one per output and return nothing; results are written into the
+// output buffers.
+std::unique_ptr<OpPassBase<ModuleOp>> createConversionPass();
+
+// Returns true if |op| is of a kind that createConversionPass can convert.
+// The operand and result types of the op are checked during conversion.
+bool isConvertibleOp(Operation *op);
+
+}  // namespace VMLA
+}  // namespace IREE
+}  // namespace iree_compiler
+}  // namespace mlir
+
+#endif  // IREE_COMPILER_DIALECT_VMLA_TRANSFORMS_PASSES_H_
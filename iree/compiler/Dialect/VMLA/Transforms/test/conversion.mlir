@@ -0,0 +1,43 @@
+// RUN: iree-opt -split-input-file -iree-vmla-conversion %s | IreeFileCheck %s
+
+// CHECK-LABEL: func @elementwise
+// CHECK-SAME: (%[[ARG0:.+]]: !iree.ref<!vmla.buffer>, %[[ARG1:.+]]: !iree.ref<!vmla.buffer>, %[[OUT:.+]]: !iree.ref<!vmla.buffer>)
+// CHECK-SAME: attributes {iree.executable.export}
+func @elementwise(%arg0 : tensor<4xf32>, %arg1 : tensor<4xf32>) -> tensor<4xf32>
+    attributes {iree.executable.export} {
+  // CHECK: %[[C16:.+]] = constant 16 : i32
+  // CHECK-NEXT: %[[TMP:.+]] = "vmla.buffer.alloc"(%[[C16]])
+  // CHECK-NEXT: "vmla.add"(%[[ARG0]], %[[ARG1]], %[[TMP]]) {element_type = f32}
+  %0 = xla_hlo.add %arg0, %arg1 : tensor<4xf32>
+  // CHECK-NEXT: "vmla.exp"(%[[TMP]], %[[OUT]]) {element_type = f32}
+  %1 = "xla_hlo.exp"(%0) : (tensor<4xf32>) -> tensor<4xf32>
+  // CHECK-NOT: vmla.buffer.copy
+  // CHECK: return
+  return %1 : tensor<4xf32>
+}
+
+// -----
+
+// CHECK-LABEL: func @reshape_output
+// CHECK-SAME: (%[[ARG0:.+]]: !iree.ref<!vmla.buffer>, %[[OUT:.+]]: !iree.ref<!vmla.buffer>)
+func @reshape_output(%arg0 : tensor<2x2xi32>) -> tensor<4xi32>
+    attributes {iree.executable.export} {
+  // CHECK: %[[C0:.+]] = constant 0 : i32
+  // CHECK-NEXT: %[[C16:.+]] = constant 16 : i32
+  // CHECK-NEXT: "vmla.buffer.copy"(%[[ARG0]], %[[C0]], %[[OUT]], %[[C0]], %[[C16]])
+  %0 = "xla_hlo.reshape"(%arg0) : (tensor<2x2xi32>) -> tensor<4xi32>
+  return %0 : tensor<4xi32>
+}
+
+// -----
+
+// CHECK-LABEL: func @matmul
+// CHECK-SAME: (%[[LHS:.+]]: !iree.ref<!vmla.buffer>, %[[OUT:.+]]: !iree.ref<!vmla.buffer>)
+func @matmul(%arg0 : tensor<2x3xf32>) -> tensor<2x4xf32>
+    attributes {iree.executable.export} {
+  // CHECK: %[[RHS:.+]] = "vmla.buffer.const"() {value = dense<1.000000e+00> : tensor<3x4xf32>}
+  %cst = xla_hlo.constant dense<1.0> : tensor<3x4xf32>
+  // CHECK: "vmla.matmul"(%[[LHS]], %[[RHS]], %[[OUT]], %{{.+}}, %{{.+}}, %{{.+}}) {element_type = f32}
+  %0 = "xla_hlo.dot"(%arg0, %cst) : (tensor<2x3xf32>, tensor<3x4xf32>) -> tensor<2x4xf32>
+  return %0 : tensor<2x4xf32>
+}
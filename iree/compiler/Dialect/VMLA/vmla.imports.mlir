@@ -0,0 +1,180 @@
+// IREE VMLA (VM Linear Algebra) runtime module imports.
+//
+// This is embedded in the compiler binary and inserted into any module
+// containing VMLA dialect ops (vmla.*) that is lowered to the VM dialect.
+//
+// Each import has a matching function exported from the native module in
+// iree/hal/vmla/vmla_module.cc. Typed ops (such as vmla.add) map to the import
+// with the suffix of their element type (such as @add.f32).
+vm.module @vmla {
+
+//===----------------------------------------------------------------------===//
+// Buffer management
+//===----------------------------------------------------------------------===//
+
+// Allocates a buffer with undefined contents.
+vm.import @buffer.alloc(
+  %byte_length : i32
+) -> !iree.ref<!vmla.buffer>
+attributes {nosideeffects}
+
+// Returns a buffer aliasing the given constant rodata.
+vm.import @buffer.const(
+  %value : !iree.byte_buffer_ref
+) -> !iree.ref<!vmla.buffer>
+attributes {nosideeffects}
+
+// Copies a byte range from %src to %dst.
+vm.import @buffer.copy(
+  %src : !iree.ref<!vmla.buffer>,
+  %src_byte_offset : i32,
+  %dst : !iree.ref<!vmla.buffer>,
+  %dst_byte_offset : i32,
+  %byte_length : i32
+)
+
+//===----------------------------------------------------------------------===//
+// Elementwise arithmetic
+//===----------------------------------------------------------------------===//
+
+vm.import @abs.i32(
+  %src : !iree.ref<!vmla.buffer>,
+  %dst : !iree.ref<!vmla.buffer>
+)
+
+vm.import @neg.i32(
+  %src : !iree.ref<!vmla.buffer>,
+  %dst : !iree.ref<!vmla.buffer>
+)
+
+vm.import @add.i32(
+  %lhs : !iree.ref<!vmla.buffer>,
+  %rhs : !iree.ref<!vmla.buffer>,
+  %dst : !iree.ref<!vmla.buffer>
+)
+
+vm.import @sub.i32(
+  %lhs : !iree.ref<!vmla.buffer>,
+  %rhs : !iree.ref<!vmla.buffer>,
+  %dst : !iree.ref<!vmla.buffer>
+)
+
+vm.import @mul.i32(
+  %lhs : !iree.ref<!vmla.buffer>,
+  %rhs : !iree.ref<!vmla.buffer>,
+  %dst : !iree.ref<!vmla.buffer>
+)
+
+vm.import @div.i32(
+  %lhs : !iree.ref<!vmla.buffer>,
+  %rhs : !iree.ref<!vmla.buffer>,
+  %dst : !iree.ref<!vmla.buffer>
+)
+
+vm.import @min.i32(
+  %lhs : !iree.ref<!vmla.buffer>,
+  %rhs : !iree.ref<!vmla.buffer>,
+  %dst : !iree.ref<!vmla.buffer>
+)
+
+vm.import @max.i32(
+  %lhs : !iree.ref<!vmla.buffer>,
+  %rhs : !iree.ref<!vmla.buffer>,
+  %dst : !iree.ref<!vmla.buffer>
+)
+
+vm.import @abs.f32(
+  %src : !iree.ref<!vmla.buffer>,
+  %dst : !iree.ref<!vmla.buffer>
+)
+
+vm.import @neg.f32(
+  %src : !iree.ref<!vmla.buffer>,
+  %dst : !iree.ref<!vmla.buffer>
+)
+
+vm.import @exp.f32(
+  %src : !iree.ref<!vmla.buffer>,
+  %dst : !iree.ref<!vmla.buffer>
+)
+
+vm.import @log.f32(
+  %src : !iree.ref<!vmla.buffer>,
+  %dst : !iree.ref<!vmla.buffer>
+)
+
+vm.import @sqrt.f32(
+  %src : !iree.ref<!vmla.buffer>,
+  %dst : !iree.ref<!vmla.buffer>
+)
+
+vm.import @rsqrt.f32(
+  %src : !iree.ref<!vmla.buffer>,
+  %dst : !iree.ref<!vmla.buffer>
+)
+
+vm.import @tanh.f32(
+  %src : !iree.ref<!vmla.buffer>,
+  %dst : !iree.ref<!vmla.buffer>
+)
+
+vm.import @floor.f32(
+  %src : !iree.ref<!vmla.buffer>,
+  %dst : !iree.ref<!vmla.buffer>
+)
+
+vm.import @ceil.f32(
+  %src : !iree.ref<!vmla.buffer>,
+  %dst : !iree.ref<!vmla.buffer>
+)
+
+vm.import @add.f32(
+  %lhs : !iree.ref<!vmla.buffer>,
+  %rhs : !iree.ref<!vmla.buffer>,
+  %dst : !iree.ref<!vmla.buffer>
+)
+
+vm.import @sub.f32(
+  %lhs : !iree.ref<!vmla.buffer>,
+  %rhs : !iree.ref<!vmla.buffer>,
+  %dst : !iree.ref<!vmla.buffer>
+)
+
+vm.import @mul.f32(
+  %lhs : !iree.ref<!vmla.buffer>,
+  %rhs : !iree.ref<!vmla.buffer>,
+  %dst : !iree.ref<!vmla.buffer>
+)
+
+vm.import @div.f32(
+  %lhs : !iree.ref<!vmla.buffer>,
+  %rhs : !iree.ref<!vmla.buffer>,
+  %dst : !iree.ref<!vmla.buffer>
+)
+
+vm.import @min.f32(
+  %lhs : !iree.ref<!vmla.buffer>,
+  %rhs : !iree.ref<!vmla.buffer>,
+  %dst : !iree.ref<!vmla.buffer>
+)
+
+vm.import @max.f32(
+  %lhs : !iree.ref<!vmla.buffer>,
+  %rhs : !iree.ref<!vmla.buffer>,
+  %dst : !iree.ref<!vmla.buffer>
+)
+
+//===----------------------------------------------------------------------===//
+// Linear algebra
+//===----------------------------------------------------------------------===//
+
+vm.import @matmul.f32(
+  %lhs : !iree.ref<!vmla.buffer>,
+  %rhs : !iree.ref<!vmla.buffer>,
+  %dst : !iree.ref<!vmla.buffer>,
+  %m : i32,
+  %k : i32,
+  %n : i32
+)
+
+}  // vm.module
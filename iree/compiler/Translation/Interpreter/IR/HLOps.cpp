@@ -237,6 +237,46 @@ void ConcatOp::getCanonicalizationPatterns(OwningRewritePatternList &results,
   results.insert<ConcatToCopies>(context);
 }
 
+//===----------------------------------------------------------------------===//
+// iree_hl_interp.add_f
+//===----------------------------------------------------------------------===//
+
+namespace {
+// Folds add_f(matmul_f(lhs, rhs), tile(bias)) into matmul_bias_f when the bias
+// is a [1, n] row tiled to the [m, n] matmul result.
+struct FuseMatMulBiasAdd : public OpRewritePattern<AddFOp> {
+  using OpRewritePattern::OpRewritePattern;
+  PatternMatchResult matchAndRewrite(AddFOp addOp,
+                                     PatternRewriter &rewriter) const override {
+    for (auto operands : {std::make_pair(addOp.lhs(), addOp.rhs()),
+                          std::make_pair(addOp.rhs(), addOp.lhs())}) {
+      auto matMulOp =
+          dyn_cast_or_null<MatMulFOp>(operands.first.getDefiningOp());
+      auto tileOp = dyn_cast_or_null<TileOp>(operands.second.getDefiningOp());
+      if (!matMulOp || !tileOp || !operands.first.hasOneUse()) continue;
+      auto resultType = addOp.getType().cast<ShapedType>();
+      auto biasType = tileOp.operand().getType().cast<ShapedType>();
+      if (!resultType.hasStaticShape() || !biasType.hasStaticShape() ||
+          resultType.getRank() != 2 || biasType.getRank() != 2 ||
+          biasType.getDimSize(0) != 1 ||
+          biasType.getDimSize(1) != resultType.getDimSize(1)) {
+        continue;
+      }
+      rewriter.replaceOpWithNewOp<MatMulBiasFOp>(
+          addOp, addOp.getType(), matMulOp.lhs(), matMulOp.rhs(),
+          tileOp.operand());
+      return matchSuccess();
+    }
+    return matchFailure();
+  }
+};
+}  // namespace
+
+void AddFOp::getCanonicalizationPatterns(OwningRewritePatternList &results,
+                                         MLIRContext *context) {
+  results.insert<FuseMatMulBiasAdd>(context);
+}
+
 #define GET_OP_CLASSES
 #include "iree/compiler/Translation/Interpreter/IR/HLOps.cpp.inc"
 
@@ -158,6 +158,24 @@ LogicalResult writeOp(IREEInterp::LL::StaticCopyOp op, BytecodeWriter *writer) {
   return success();
 }
 
+LogicalResult writeOp(IREEInterp::LL::ElementwiseFOp op,
+                      BytecodeWriter *writer) {
+  RETURN_IF_FAILURE(
+      writer->WriteOpcode(iree::InterpreterOpcode::kElementwiseF));
+  RETURN_IF_FAILURE(writer->WriteLocals(op.args()));
+  RETURN_IF_FAILURE(writer->WriteShapePieces(op.program()));
+  RETURN_IF_FAILURE(writer->WriteLocal(op.dst()));
+  return success();
+}
+
+LogicalResult writeOp(IREEInterp::LL::DimOp op, BytecodeWriter *writer) {
+  RETURN_IF_FAILURE(writer->WriteOpcode(iree::InterpreterOpcode::kDim));
+  RETURN_IF_FAILURE(writer->WriteInt32(op.dimension().getSExtValue()));
+  RETURN_IF_FAILURE(writer->WriteLocal(op.input()));
+  RETURN_IF_FAILURE(writer->WriteLocal(op.dst()));
+  return success();
+}
+
 LogicalResult writeReduceOperands(Operation *op, BytecodeWriter *writer,
                                   APInt dimension) {
   RETURN_IF_FAILURE(writer->WriteLocal(op->getOperand(0)));
@@ -218,6 +236,8 @@ void registerInterpreterCustomWriters(VMFunctionBuilder *builder) {
   REGISTER_CUSTOM_WRITER_IMPL(IREEInterp::LL::CmpFOp);
   REGISTER_CUSTOM_WRITER_IMPL(IREEInterp::LL::AllocHeapOp);
   REGISTER_CUSTOM_WRITER_IMPL(IREEInterp::LL::StaticCopyOp);
+  REGISTER_CUSTOM_WRITER_IMPL(IREEInterp::LL::ElementwiseFOp);
+  REGISTER_CUSTOM_WRITER_IMPL(IREEInterp::LL::DimOp);
   REGISTER_CUSTOM_WRITER_IMPL(IREEInterp::LL::ReduceSumIOp);
   REGISTER_CUSTOM_WRITER_IMPL(IREEInterp::LL::ReduceSumFOp);
   REGISTER_CUSTOM_WRITER_IMPL(IREEInterp::LL::ReduceMinIOp);
@@ -0,0 +1,29 @@
+// RUN: iree-opt -pass-pipeline='func(canonicalize)' %s --split-input-file | IreeFileCheck %s
+
+// CHECK-LABEL: func @matmul_bias
+// CHECK-SAME: [[LHS:%[a-zA-Z0-9]+]]
+// CHECK-SAME: [[RHS:%[a-zA-Z0-9]+]]
+// CHECK-SAME: [[BIAS:%[a-zA-Z0-9]+]]
+func @matmul_bias(%lhs : memref<4x8xf32>, %rhs : memref<8x16xf32>, %bias : memref<1x16xf32>) -> memref<4x16xf32> {
+  %0 = "iree_hl_interp.matmul_f"(%lhs, %rhs) : (memref<4x8xf32>, memref<8x16xf32>) -> memref<4x16xf32>
+  %shape = iree_interp.constant[dense<[4, 16]> : tensor<2xi64>] : memref<2xi64>
+  %1 = "iree_hl_interp.tile"(%bias, %shape) : (memref<1x16xf32>, memref<2xi64>) -> memref<4x16xf32>
+  // CHECK-NEXT: [[RESULT:%.+]] = "iree_hl_interp.matmul_bias_f"([[LHS]], [[RHS]], [[BIAS]])
+  %2 = "iree_hl_interp.add_f"(%1, %0) : (memref<4x16xf32>, memref<4x16xf32>) -> memref<4x16xf32>
+  // CHECK-NEXT: return [[RESULT]]
+  return %2 : memref<4x16xf32>
+}
+
+// -----
+
+// CHECK-LABEL: func @matmul_result_reused
+func @matmul_result_reused(%lhs : memref<4x8xf32>, %rhs : memref<8x16xf32>, %bias : memref<1x16xf32>) -> (memref<4x16xf32>, memref<4x16xf32>) {
+  // CHECK: "iree_hl_interp.matmul_f"
+  %0 = "iree_hl_interp.matmul_f"(%lhs, %rhs) : (memref<4x8xf32>, memref<8x16xf32>) -> memref<4x16xf32>
+  %shape = iree_interp.constant[dense<[4, 16]> : tensor<2xi64>] : memref<2xi64>
+  %1 = "iree_hl_interp.tile"(%bias, %shape) : (memref<1x16xf32>, memref<2xi64>) -> memref<4x16xf32>
+  // CHECK: "iree_hl_interp.add_f"
+  // CHECK-NOT: matmul_bias_f
+  %2 = "iree_hl_interp.add_f"(%0, %1) : (memref<4x16xf32>, memref<4x16xf32>) -> memref<4x16xf32>
+  return %0, %2 : memref<4x16xf32>, memref<4x16xf32>
+}
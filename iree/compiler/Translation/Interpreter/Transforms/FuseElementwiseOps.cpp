@@ -0,0 +1,199 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <functional>
+#include <memory>
+
+#include "iree/compiler/Translation/Interpreter/IR/HLOps.h"
+#include "iree/schemas/bytecode/interpreter_bytecode_v0.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "mlir/IR/Attributes.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/StandardTypes.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Pass/PassRegistry.h"
+
+namespace mlir {
+namespace iree_compiler {
+
+namespace {
+
+// Maximum number of ops fused into a single elementwise_f op. Keeps the
+// encoded program well within the 255 entry limit of bytecode index lists.
+constexpr int kMaxFusedOps = 32;
+
+// Returns the interpreter opcode that evaluates |op| or None if |op| is not a
+// fusable float elementwise op.
+llvm::Optional<iree::InterpreterOpcode> getFusableOpcode(Operation *op) {
+#define FUSABLE_OP(op_type, opcode) \
+  if (isa<IREEInterp::HL::op_type>(op)) return iree::InterpreterOpcode::opcode;
+  FUSABLE_OP(AddFOp, kAddF);
+  FUSABLE_OP(SubFOp, kSubF);
+  FUSABLE_OP(AbsFOp, kAbsF);
+  FUSABLE_OP(MulFOp, kMulF);
+  FUSABLE_OP(DivFOp, kDivF);
+  FUSABLE_OP(RemFOp, kRemF);
+  FUSABLE_OP(MulAddFOp, kMulAddF);
+  FUSABLE_OP(ExpFOp, kExpF);
+  FUSABLE_OP(LogFOp, kLogF);
+  FUSABLE_OP(RsqrtFOp, kRsqrtF);
+  FUSABLE_OP(SqrtFOp, kSqrtF);
+  FUSABLE_OP(CosFOp, kCosF);
+  FUSABLE_OP(SinFOp, kSinF);
+  FUSABLE_OP(TanhFOp, kTanhF);
+  FUSABLE_OP(MinFOp, kMinF);
+  FUSABLE_OP(MaxFOp, kMaxF);
+  FUSABLE_OP(ClampFOp, kClampF);
+  FUSABLE_OP(FloorFOp, kFloorF);
+  FUSABLE_OP(CeilFOp, kCeilF);
+#undef FUSABLE_OP
+  return llvm::None;
+}
+
+// Returns true if |op| can be evaluated as part of a fused elementwise op.
+// All operands must match the result type as the interpreter kernels do not
+// broadcast.
+bool isFusable(Operation *op) {
+  if (!getFusableOpcode(op) || op->getNumResults() != 1) return false;
+  auto resultType = op->getResult(0).getType().dyn_cast<MemRefType>();
+  if (!resultType || !resultType.hasStaticShape()) return false;
+  for (auto operand : op->getOperands()) {
+    if (operand.getType() != resultType) return false;
+  }
+  return true;
+}
+
+// Returns true if |producer| can be fused into the op using its result.
+// Producers with multiple uses are left alone as their result must still be
+// materialized.
+bool isFusableInto(Operation *producer, Operation *user) {
+  return isFusable(producer) && isFusable(user) &&
+         producer->getBlock() == user->getBlock() &&
+         producer->getResult(0).hasOneUse();
+}
+
+// Replaces the tree of fusable ops rooted at |root| with an elementwise_f op.
+void fuseTree(Operation *root, SmallVectorImpl<Operation *> *worklist) {
+  // Grow the tree through single-use producers. Producers beyond the size
+  // limit become the roots of their own trees.
+  llvm::SmallPtrSet<Operation *, 8> fusedOps;
+  SmallVector<Operation *, 8> queue = {root};
+  fusedOps.insert(root);
+  for (size_t i = 0; i < queue.size(); ++i) {
+    for (auto operand : queue[i]->getOperands()) {
+      auto *producer = operand.getDefiningOp();
+      if (!producer || fusedOps.count(producer) ||
+          !isFusableInto(producer, queue[i])) {
+        continue;
+      }
+      if (fusedOps.size() >= kMaxFusedOps) {
+        worklist->push_back(producer);
+        continue;
+      }
+      fusedOps.insert(producer);
+      queue.push_back(producer);
+    }
+  }
+  if (fusedOps.size() < 2) return;
+
+  // The fused op reads all of its operands at the position of the root so the
+  // tree must not span ops that may write to memory.
+  size_t remainingOps = fusedOps.size() - 1;
+  for (auto *op = root->getPrevNode(); remainingOps; op = op->getPrevNode()) {
+    if (fusedOps.count(op)) {
+      --remainingOps;
+    } else if (!op->hasNoSideEffect()) {
+      return;
+    }
+  }
+
+  // Order the ops such that producers precede their users and assign the
+  // unique values used from outside of the tree to the leading registers.
+  SmallVector<Operation *, 8> postOrder;
+  SmallVector<Value, 8> args;
+  llvm::DenseMap<Value, int32_t> registers;
+  std::function<void(Operation *)> visit = [&](Operation *op) {
+    for (auto operand : op->getOperands()) {
+      auto *producer = operand.getDefiningOp();
+      if (producer && fusedOps.count(producer)) {
+        visit(producer);
+      } else if (!registers.count(operand)) {
+        registers[operand] = args.size();
+        args.push_back(operand);
+      }
+    }
+    postOrder.push_back(op);
+  };
+  visit(root);
+
+  SmallVector<int32_t, 32> program;
+  int32_t nextRegister = args.size();
+  for (auto *op : postOrder) {
+    program.push_back(static_cast<int32_t>(getFusableOpcode(op).getValue()));
+    for (auto operand : op->getOperands()) {
+      program.push_back(registers[operand]);
+    }
+    registers[op->getResult(0)] = nextRegister++;
+  }
+
+  OpBuilder builder(root);
+  auto programAttr = DenseIntElementsAttr::get(
+      RankedTensorType::get(program.size(), builder.getIntegerType(32)),
+      llvm::makeArrayRef(program));
+  auto fusedOp = builder.create<IREEInterp::HL::ElementwiseFOp>(
+      root->getLoc(), root->getResult(0).getType(), args, programAttr);
+  root->getResult(0).replaceAllUsesWith(fusedOp.getResult());
+  // Users are erased before the producers they reference.
+  for (auto *op : llvm::reverse(postOrder)) {
+    op->erase();
+  }
+}
+
+}  // namespace
+
+// Fuses trees of float elementwise ops into elementwise_f ops that evaluate
+// the whole tree in a single pass without materializing intermediate buffers.
+class FuseElementwiseOpsPass : public FunctionPass<FuseElementwiseOpsPass> {
+ public:
+  void runOnFunction() override {
+    // Roots are ops whose result is not fused into a user.
+    SmallVector<Operation *, 16> worklist;
+    getFunction().walk([&](Operation *op) {
+      if (!isFusable(op)) return;
+      auto result = op->getResult(0);
+      if (result.hasOneUse() &&
+          isFusableInto(op, result.use_begin()->getOwner())) {
+        return;
+      }
+      worklist.push_back(op);
+    });
+    while (!worklist.empty()) {
+      fuseTree(worklist.pop_back_val(), &worklist);
+    }
+  }
+};
+
+std::unique_ptr<OpPassBase<FuncOp>> createFuseElementwiseOpsPass() {
+  return std::make_unique<FuseElementwiseOpsPass>();
+}
+
+static PassRegistration<FuseElementwiseOpsPass> pass(
+    "iree-fuse-elementwise-ops",
+    "Fuses chains of float elementwise ops into single elementwise_f ops");
+
+}  // namespace iree_compiler
+}  // namespace mlir
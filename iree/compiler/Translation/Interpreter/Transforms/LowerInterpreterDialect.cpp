@@ -169,12 +169,14 @@ void populateInterpreterLoweringPatterns(OwningRewritePatternList &patterns,
       SAME_NAME_SIMPLE_PATTERN(DivFOp),
       SAME_NAME_SIMPLE_PATTERN(DivISOp),
       SAME_NAME_SIMPLE_PATTERN(DivIUOp),
+      SAME_NAME_SIMPLE_PATTERN(ElementwiseFOp),
       SAME_NAME_SIMPLE_PATTERN(ExpFOp),
       SAME_NAME_SIMPLE_PATTERN(LogFOp),
       SAME_NAME_SIMPLE_PATTERN(RsqrtFOp),
       SAME_NAME_SIMPLE_PATTERN(SqrtFOp),
       SAME_NAME_SIMPLE_PATTERN(FloorFOp),
       SAME_NAME_SIMPLE_PATTERN(LengthOp),
+      SAME_NAME_SIMPLE_PATTERN(MatMulBiasFOp),
       SAME_NAME_SIMPLE_PATTERN(MatMulFOp),
       SAME_NAME_SIMPLE_PATTERN(MatMulIOp),
       SAME_NAME_SIMPLE_PATTERN(MaxFOp),
@@ -134,6 +134,28 @@ struct CmpFOpLowering
   using CompareOpLowering::CompareOpLowering;
 };
 
+struct DimOpLowering : public OpConversionPattern<DimOp> {
+  using OpConversionPattern::OpConversionPattern;
+
+  PatternMatchResult matchAndRewrite(
+      DimOp op, ArrayRef<Value> operands,
+      ConversionPatternRewriter &rewriter) const override {
+    auto value = loadAccessValue(op.getLoc(), operands[0], rewriter);
+    value = wrapAsMemRef(value, op, rewriter);
+
+    // The axis is encoded in the bytecode so it must be carried along.
+    auto dimension = rewriter.getI32IntegerAttr(op.getIndex());
+
+    auto dstType = convertTypeToMemRef(op.getResult());
+    auto dstOp = rewriter.create<IREEInterp::HL::DimOp>(op.getLoc(), dstType,
+                                                        value, dimension);
+    auto result = wrapAsTensor(dstOp.getResult(), op, rewriter);
+    rewriter.replaceOp(
+        op, {loadResultValue(op.getLoc(), op.getType(), result, rewriter)});
+    return matchSuccess();
+  }
+};
+
 struct AllocOpLowering : public OpConversionPattern<AllocOp> {
   using OpConversionPattern::OpConversionPattern;
 
@@ -222,7 +244,6 @@ struct StoreOpLowering : public OpRewritePattern<StoreOp> {
   };
 
 // UNARY_OP_LOWERING(RankOp, IREEInterp::HL::RankOp);
-UNARY_OP_LOWERING(DimOp, IREEInterp::HL::DimOp);
 // UNARY_OP_LOWERING(ShapeOp, IREEInterp::HL::ShapeOp);
 // UNARY_OP_LOWERING(LengthOp, IREEInterp::HL::LengthOp);
 
@@ -45,6 +45,10 @@ std::unique_ptr<OpPassBase<ModuleOp>> createLegalizeTypeStoragePass();
 // Expands reduction functions to their interpreter ops.
 std::unique_ptr<OpPassBase<ModuleOp>> createExpandReductionsToOpsPass();
 
+// Fuses trees of float elementwise HL ops into elementwise_f ops that evaluate
+// them in a single pass without intermediate buffers.
+std::unique_ptr<OpPassBase<FuncOp>> createFuseElementwiseOpsPass();
+
 // Lowers IREE HL ops (iree_hl_interp.*) to LL ops (iree_ll_interp.*).
 std::unique_ptr<OpPassBase<FuncOp>> createLowerInterpreterDialectPass();
 
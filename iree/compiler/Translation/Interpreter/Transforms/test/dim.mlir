@@ -0,0 +1,11 @@
+// RUN: iree-opt --lower-iree-interpreter-hl-to-ll %s | IreeFileCheck %s
+
+// CHECK-LABEL: @dim
+// CHECK-SAME: [[ARG:%[a-zA-Z0-9]+]]
+func @dim(%arg : memref<2x4xf32>) -> memref<i32> {
+  // CHECK-NEXT: [[DST:%.+]] = "iree_ll_interp.alloc_heap"() : () -> memref<i32>
+  // CHECK-NEXT: "iree_ll_interp.dim"([[ARG]], [[DST]]) {dimension = 1 : i32}
+  %0 = "iree_hl_interp.dim"(%arg) {dimension = 1 : i32} : (memref<2x4xf32>) -> memref<i32>
+  // CHECK-NEXT: return [[DST]]
+  return %0 : memref<i32>
+}
@@ -0,0 +1,55 @@
+// RUN: iree-opt -iree-fuse-elementwise-ops %s --split-input-file | IreeFileCheck %s
+
+// CHECK-LABEL: func @chain
+// CHECK-SAME: [[A:%[a-zA-Z0-9]+]]
+// CHECK-SAME: [[B:%[a-zA-Z0-9]+]]
+// CHECK-SAME: [[C:%[a-zA-Z0-9]+]]
+func @chain(%a : memref<4x8xf32>, %b : memref<4x8xf32>, %c : memref<4x8xf32>) -> memref<4x8xf32> {
+  %0 = "iree_hl_interp.mul_f"(%a, %b) : (memref<4x8xf32>, memref<4x8xf32>) -> memref<4x8xf32>
+  %1 = "iree_hl_interp.add_f"(%0, %c) : (memref<4x8xf32>, memref<4x8xf32>) -> memref<4x8xf32>
+  // CHECK-NEXT: [[RESULT:%.+]] = "iree_hl_interp.elementwise_f"([[A]], [[B]], [[C]]) {program = dense<[119, 0, 1, 113, 3, 2, 127, 4]> : tensor<8xi32>}
+  %2 = "iree_hl_interp.tanh_f"(%1) : (memref<4x8xf32>) -> memref<4x8xf32>
+  // CHECK-NEXT: return [[RESULT]]
+  return %2 : memref<4x8xf32>
+}
+
+// -----
+
+// CHECK-LABEL: func @repeated_operand
+// CHECK-SAME: [[A:%[a-zA-Z0-9]+]]
+func @repeated_operand(%a : memref<16xf32>) -> memref<16xf32> {
+  %0 = "iree_hl_interp.mul_f"(%a, %a) : (memref<16xf32>, memref<16xf32>) -> memref<16xf32>
+  // CHECK-NEXT: [[RESULT:%.+]] = "iree_hl_interp.elementwise_f"([[A]]) {program = dense<[119, 0, 0, 113, 1, 0]> : tensor<6xi32>}
+  %1 = "iree_hl_interp.add_f"(%0, %a) : (memref<16xf32>, memref<16xf32>) -> memref<16xf32>
+  // CHECK-NEXT: return [[RESULT]]
+  return %1 : memref<16xf32>
+}
+
+// -----
+
+// CHECK-LABEL: func @shared_intermediate
+func @shared_intermediate(%a : memref<16xf32>, %b : memref<16xf32>) -> (memref<16xf32>, memref<16xf32>) {
+  // CHECK: "iree_hl_interp.exp_f"
+  %0 = "iree_hl_interp.exp_f"(%a) : (memref<16xf32>) -> memref<16xf32>
+  // CHECK-NEXT: "iree_hl_interp.add_f"
+  %1 = "iree_hl_interp.add_f"(%0, %b) : (memref<16xf32>, memref<16xf32>) -> memref<16xf32>
+  // CHECK-NEXT: "iree_hl_interp.mul_f"
+  %2 = "iree_hl_interp.mul_f"(%0, %b) : (memref<16xf32>, memref<16xf32>) -> memref<16xf32>
+  // CHECK-NOT: elementwise_f
+  return %1, %2 : memref<16xf32>, memref<16xf32>
+}
+
+// -----
+
+// CHECK-LABEL: func @side_effect_between
+func @side_effect_between(%a : memref<16xf32>, %b : memref<16xf32>) -> memref<16xf32> {
+  // CHECK: "iree_hl_interp.exp_f"
+  %0 = "iree_hl_interp.exp_f"(%a) : (memref<16xf32>) -> memref<16xf32>
+  %src_indices = iree_interp.constant[dense<0> : tensor<1xi64>] : memref<1xi64>
+  %lengths = iree_interp.constant[dense<16> : tensor<1xi64>] : memref<1xi64>
+  "iree_hl_interp.copy"(%b, %src_indices, %a, %src_indices, %lengths) : (memref<16xf32>, memref<1xi64>, memref<16xf32>, memref<1xi64>, memref<1xi64>) -> ()
+  // CHECK: "iree_hl_interp.add_f"
+  // CHECK-NOT: elementwise_f
+  %1 = "iree_hl_interp.add_f"(%0, %a) : (memref<16xf32>, memref<16xf32>) -> memref<16xf32>
+  return %1 : memref<16xf32>
+}
@@ -55,6 +55,10 @@ constexpr ExecutableFormat kExecutableFormatIreeBytecode =
 constexpr ExecutableFormat kExecutableFormatSpirV =
     MakeExecutableFormatID("SPVE");
 
+// VM bytecode module calling into the VMLA (VM linear algebra) native module.
+constexpr ExecutableFormat kExecutableFormatVMLA =
+    MakeExecutableFormatID("VMLA");
+
 // LINT.ThenChange(//iree/iree/compiler/Dialect/HAL/IR/HALBase.td:executable_format)
 
 }  // namespace hal
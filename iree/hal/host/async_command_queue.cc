@@ -15,15 +15,26 @@
 #include "iree/hal/host/async_command_queue.h"
 
 #include "absl/base/thread_annotations.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "iree/base/status.h"
 #include "iree/base/tracing.h"
 
 namespace iree {
 namespace hal {
 
+namespace {
+
+// Binary semaphores provide no notification when they are signaled by another
+// queue so batches blocked on them are re-evaluated at this interval.
+constexpr absl::Duration kBlockedPollInterval = absl::Milliseconds(1);
+
+}  // namespace
+
 AsyncCommandQueue::AsyncCommandQueue(std::unique_ptr<CommandQueue> target_queue)
     : CommandQueue(target_queue->name(), target_queue->supported_categories()),
-      target_queue_(std::move(target_queue)) {
+      target_queue_(std::move(target_queue)),
+      wake_state_(std::make_shared<WakeState>()) {
   IREE_TRACE_SCOPE0("AsyncCommandQueue::ctor");
   thread_ = std::thread([this]() { ThreadMain(); });
 }
@@ -37,6 +48,7 @@ AsyncCommandQueue::~AsyncCommandQueue() {
     absl::MutexLock lock(&submission_mutex_);
     submission_queue_.SignalShutdown();
   }
+  Wake(wake_state_.get());
   thread_.join();
 
   // Ensure we shut down OK.
@@ -52,15 +64,22 @@ void AsyncCommandQueue::ThreadMain() {
   IREE_TRACE_THREAD_ENABLE(target_queue_->name().c_str());
 
   bool is_exiting = false;
+  bool is_blocked = false;
   while (!is_exiting) {
-    // Block until we are either requested to exit or there are pending
-    // submissions.
+    // Block until we are either requested to exit, there are new submissions,
+    // or a semaphore a pending batch is waiting on has been signaled.
+    {
+      absl::MutexLock lock(&wake_state_->mutex);
+      auto condition = absl::Condition(&wake_state_->wake_pending);
+      if (is_blocked) {
+        wake_state_->mutex.AwaitWithTimeout(condition, kBlockedPollInterval);
+      } else {
+        wake_state_->mutex.Await(condition);
+      }
+      wake_state_->wake_pending = false;
+    }
+
     submission_mutex_.Lock();
-    submission_mutex_.Await(absl::Condition(
-        +[](HostSubmissionQueue* queue) {
-          return queue->has_shutdown() || !queue->empty();
-        },
-        &submission_queue_));
     if (!submission_queue_.empty()) {
       // Run all ready submissions (this may be called many times).
       submission_mutex_.AssertHeld();
@@ -88,6 +107,7 @@ void AsyncCommandQueue::ThreadMain() {
           .IgnoreError();
       submission_mutex_.AssertHeld();
     }
+    is_blocked = !submission_queue_.empty();
     if (submission_queue_.has_shutdown()) {
       // Exit when there are no more submissions to process and an exit was
       // requested (or we errored out).
@@ -100,8 +120,34 @@ void AsyncCommandQueue::ThreadMain() {
 Status AsyncCommandQueue::Submit(absl::Span<const SubmissionBatch> batches,
                                  FenceValue fence) {
   IREE_TRACE_SCOPE0("AsyncCommandQueue::Submit");
-  absl::MutexLock lock(&submission_mutex_);
-  return submission_queue_.Enqueue(batches, fence);
+  {
+    absl::MutexLock lock(&submission_mutex_);
+    RETURN_IF_ERROR(submission_queue_.Enqueue(batches, fence));
+  }
+
+  // Wake the queue thread when any timeline semaphore we are waiting on is
+  // signaled. The timepoints only retain the wake state so they are safe to
+  // outlive the queue.
+  for (auto& batch : batches) {
+    for (auto& semaphore_value : batch.wait_semaphores) {
+      if (semaphore_value.index() != 1) continue;
+      auto& timeline_value = absl::get<1>(semaphore_value);
+      auto* timeline_semaphore =
+          reinterpret_cast<HostTimelineSemaphore*>(timeline_value.first);
+      auto wake_state = wake_state_;
+      timeline_semaphore->NotifyAtValue(
+          timeline_value.second, [wake_state]() { Wake(wake_state.get()); });
+    }
+  }
+
+  Wake(wake_state_.get());
+  return OkStatus();
+}
+
+// static
+void AsyncCommandQueue::Wake(WakeState* wake_state) {
+  absl::MutexLock lock(&wake_state->mutex);
+  wake_state->wake_pending = true;
 }
 
 Status AsyncCommandQueue::WaitIdle(absl::Time deadline) {
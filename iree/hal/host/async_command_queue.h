@@ -36,6 +36,10 @@ namespace hal {
 // all semaphore synchronization is handled by the wrapper. Fences will also be
 // omitted and code should safely handle nullptr.
 //
+// Batches waiting on HostTimelineSemaphores are woken as soon as the
+// semaphores are signaled, either by the host or by another queue, so deep
+// pipelines may keep many submissions in flight without waiting for idle.
+//
 // AsyncCommandQueue (as with CommandQueue) is thread-safe. Multiple threads
 // may submit command buffers concurrently, though the order of execution in
 // such a case depends entirely on the synchronization primitives provided.
@@ -50,16 +54,28 @@ class AsyncCommandQueue final : public CommandQueue {
   Status WaitIdle(absl::Time deadline) override;
 
  private:
+  // Wake flag shared with the timepoints registered on semaphores that pending
+  // batches wait on. Timepoints may outlive the queue and only ever touch this.
+  struct WakeState {
+    absl::Mutex mutex;
+    bool wake_pending ABSL_GUARDED_BY(mutex) = false;
+  };
+
   // Thread entry point for the async worker thread.
   // Waits for submissions to be queued up and processes them eagerly.
   void ThreadMain();
 
+  // Wakes the queue thread so that it re-evaluates pending batches.
+  static void Wake(WakeState* wake_state);
+
   // CommandQueue that the async queue relays submissions into.
   std::unique_ptr<CommandQueue> target_queue_;
 
   // Thread that runs the ThreadMain() function and processes submissions.
   std::thread thread_;
 
+  std::shared_ptr<WakeState> wake_state_;
+
   // Queue that manages submission ordering.
   mutable absl::Mutex submission_mutex_;
   HostSubmissionQueue submission_queue_ ABSL_GUARDED_BY(submission_mutex_);
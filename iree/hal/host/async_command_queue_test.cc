@@ -39,6 +39,11 @@ using ::testing::_;
 using testing::MockCommandBuffer;
 using testing::MockCommandQueue;
 
+// Returns a SemaphoreValue referencing |semaphore| at the given |value|.
+SemaphoreValue TimelineValue(TimelineSemaphore* semaphore, uint64_t value) {
+  return std::make_pair(semaphore, value);
+}
+
 struct AsyncCommandQueueTest : public ::testing::Test {
   MockCommandQueue* mock_target_queue;
   std::unique_ptr<CommandQueue> command_queue;
@@ -227,6 +232,91 @@ TEST_F(AsyncCommandQueueTest, FailuresCascadeAcrossSubmits) {
   EXPECT_TRUE(IsDataLoss(command_queue->WaitIdle()));
 }
 
+// Tests that a batch waiting on a timeline semaphore is held until the host
+// signals the semaphore.
+TEST_F(AsyncCommandQueueTest, TimelineWaitOnHostSignal) {
+  EXPECT_CALL(*mock_target_queue, Submit(_, _))
+      .WillOnce(
+          [](absl::Span<const SubmissionBatch> batches, FenceValue fence) {
+            return OkStatus();
+          });
+
+  auto cmd_buffer = make_ref<MockCommandBuffer>(
+      nullptr, CommandBufferMode::kOneShot, CommandCategory::kTransfer);
+
+  HostTimelineSemaphore semaphore(0u);
+  HostFence fence(0u);
+  ASSERT_OK(command_queue->Submit(
+      {{TimelineValue(&semaphore, 1u)}, {cmd_buffer.get()}, {}}, {&fence, 1u}));
+
+  EXPECT_TRUE(IsDeadlineExceeded(
+      HostFence::WaitForFences({{&fence, 1u}}, /*wait_all=*/true,
+                               absl::Now() + absl::Milliseconds(50))));
+
+  ASSERT_OK(semaphore.Signal(1u));
+  ASSERT_OK(HostFence::WaitForFences({{&fence, 1u}}, /*wait_all=*/true,
+                                     absl::InfiniteFuture()));
+  ASSERT_OK(command_queue->WaitIdle());
+}
+
+// Tests that batches chained through a timeline semaphore execute in timeline
+// order regardless of their submission order.
+TEST_F(AsyncCommandQueueTest, TimelineChainOutOfOrder) {
+  auto cmd_buffer_0 = make_ref<MockCommandBuffer>(
+      nullptr, CommandBufferMode::kOneShot, CommandCategory::kTransfer);
+  auto cmd_buffer_1 = make_ref<MockCommandBuffer>(
+      nullptr, CommandBufferMode::kOneShot, CommandCategory::kTransfer);
+
+  ::testing::InSequence sequence;
+  EXPECT_CALL(*mock_target_queue, Submit(_, _))
+      .WillOnce([&](absl::Span<const SubmissionBatch> batches,
+                    FenceValue fence) {
+        CHECK_EQ(cmd_buffer_0.get(), batches[0].command_buffers[0]);
+        return OkStatus();
+      });
+  EXPECT_CALL(*mock_target_queue, Submit(_, _))
+      .WillOnce([&](absl::Span<const SubmissionBatch> batches,
+                    FenceValue fence) {
+        CHECK_EQ(cmd_buffer_1.get(), batches[0].command_buffers[0]);
+        return OkStatus();
+      });
+
+  HostTimelineSemaphore semaphore(0u);
+  SemaphoreValue value_1 = TimelineValue(&semaphore, 1u);
+  SemaphoreValue value_2 = TimelineValue(&semaphore, 2u);
+  HostFence fence_1(0u);
+  ASSERT_OK(command_queue->Submit(
+      {{value_1}, {cmd_buffer_1.get()}, {value_2}}, {&fence_1, 1u}));
+  HostFence fence_0(0u);
+  ASSERT_OK(command_queue->Submit({{}, {cmd_buffer_0.get()}, {value_1}},
+                                  {&fence_0, 1u}));
+
+  ASSERT_OK(semaphore.Wait(2u, absl::InfiniteFuture()));
+  ASSERT_OK(command_queue->WaitIdle());
+}
+
+// Tests that a failed batch fails the timeline semaphores it would have
+// signaled so that host waiters observe the error.
+TEST_F(AsyncCommandQueueTest, TimelineFailurePropagates) {
+  EXPECT_CALL(*mock_target_queue, Submit(_, _))
+      .WillOnce(
+          [](absl::Span<const SubmissionBatch> batches, FenceValue fence) {
+            return DataLossErrorBuilder(IREE_LOC);
+          });
+
+  auto cmd_buffer = make_ref<MockCommandBuffer>(
+      nullptr, CommandBufferMode::kOneShot, CommandCategory::kTransfer);
+
+  HostTimelineSemaphore semaphore(0u);
+  HostFence fence(0u);
+  ASSERT_OK(command_queue->Submit(
+      {{}, {cmd_buffer.get()}, {TimelineValue(&semaphore, 1u)}}, {&fence, 1u}));
+
+  EXPECT_TRUE(IsDataLoss(semaphore.Wait(1u, absl::InfiniteFuture())));
+  EXPECT_TRUE(IsDataLoss(semaphore.QueryValue().status()));
+  EXPECT_TRUE(IsDataLoss(command_queue->WaitIdle()));
+}
+
 }  // namespace
 }  // namespace hal
 }  // namespace iree
@@ -107,5 +107,26 @@ StatusOr<ref_ptr<Buffer>> HostLocalAllocator::Allocate(
   return buffer;
 }
 
+StatusOr<ref_ptr<Buffer>> HostLocalAllocator::WrapMutable(
+    MemoryTypeBitfield memory_type, MemoryAccessBitfield allowed_access,
+    BufferUsageBitfield buffer_usage, void* data, size_t data_length) {
+  IREE_TRACE_SCOPE0("HostLocalAllocator::WrapMutable");
+
+  if (!CanAllocate(memory_type, buffer_usage, data_length)) {
+    return FailedPreconditionErrorBuilder(IREE_LOC)
+           << "Wrapping not supported; memory_type="
+           << MemoryTypeString(memory_type)
+           << ", buffer_usage=" << BufferUsageString(buffer_usage)
+           << ", data_length=" << data_length;
+  }
+
+  // Make compatible with our requirements.
+  RETURN_IF_ERROR(MakeCompatible(&memory_type, &buffer_usage));
+
+  auto buffer = make_ref<HostBuffer>(this, memory_type, allowed_access,
+                                     buffer_usage, data_length, data, false);
+  return buffer;
+}
+
 }  // namespace hal
 }  // namespace iree
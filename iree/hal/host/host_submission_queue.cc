@@ -14,8 +14,12 @@
 
 #include "iree/hal/host/host_submission_queue.h"
 
+#include <algorithm>
 #include <atomic>
+#include <iterator>
 #include <cstdint>
+#include <memory>
+#include <utility>
 
 #include "absl/synchronization/mutex.h"
 #include "iree/base/status.h"
@@ -88,6 +92,204 @@ Status HostBinarySemaphore::EndWaiting() {
   return OkStatus();
 }
 
+HostTimelineSemaphore::HostTimelineSemaphore(uint64_t initial_value)
+    : value_(initial_value) {}
+
+HostTimelineSemaphore::~HostTimelineSemaphore() = default;
+
+Status HostTimelineSemaphore::status() const {
+  absl::MutexLock lock(&mutex_);
+  return status_;
+}
+
+StatusOr<uint64_t> HostTimelineSemaphore::QueryValue() const {
+  uint64_t value = value_.load(std::memory_order_acquire);
+  if (value == UINT64_MAX) {
+    RETURN_IF_ERROR(status());
+  }
+  return value;
+}
+
+Status HostTimelineSemaphore::Signal(uint64_t value) {
+  return SetValue(value, /*require_increase=*/true);
+}
+
+Status HostTimelineSemaphore::Advance(uint64_t value) {
+  return SetValue(value, /*require_increase=*/false);
+}
+
+Status HostTimelineSemaphore::SetValue(uint64_t value, bool require_increase) {
+  std::vector<Timepoint> reached_timepoints;
+  {
+    absl::MutexLock lock(&mutex_);
+    if (!status_.ok()) {
+      return status_;
+    }
+    uint64_t current_value = value_.load(std::memory_order_acquire);
+    if (value <= current_value) {
+      if (require_increase) {
+        return InvalidArgumentErrorBuilder(IREE_LOC)
+               << "Timeline semaphore values must be monotonically increasing";
+      }
+      return OkStatus();
+    }
+    value_.store(value, std::memory_order_release);
+
+    // Split off the timepoints that have been reached so we can issue them
+    // once the lock is released.
+    auto it = std::partition(timepoints_.begin(), timepoints_.end(),
+                             [value](const Timepoint& timepoint) {
+                               return timepoint.value > value;
+                             });
+    std::move(it, timepoints_.end(), std::back_inserter(reached_timepoints));
+    timepoints_.erase(it, timepoints_.end());
+  }
+  for (auto& timepoint : reached_timepoints) {
+    timepoint.callback();
+  }
+  return OkStatus();
+}
+
+void HostTimelineSemaphore::Fail(Status status) {
+  std::vector<Timepoint> timepoints;
+  {
+    absl::MutexLock lock(&mutex_);
+    if (!status_.ok()) return;
+    status_ = std::move(status);
+    value_.store(UINT64_MAX, std::memory_order_release);
+    timepoints.swap(timepoints_);
+  }
+  for (auto& timepoint : timepoints) {
+    timepoint.callback();
+  }
+}
+
+Status HostTimelineSemaphore::Wait(uint64_t value, absl::Time deadline) {
+  TimelineValue semaphore_value = {this, value};
+  return WaitForSemaphores(absl::MakeConstSpan(&semaphore_value, 1),
+                           /*wait_all=*/true, deadline);
+}
+
+void HostTimelineSemaphore::NotifyAtValue(uint64_t value,
+                                          std::function<void()> callback,
+                                          const void* owner) {
+  {
+    absl::MutexLock lock(&mutex_);
+    if (!IsReached(value)) {
+      timepoints_.push_back({value, owner, std::move(callback)});
+      return;
+    }
+  }
+  callback();
+}
+
+void HostTimelineSemaphore::CancelNotify(const void* owner) {
+  if (!owner) return;
+  // Destroy the cancelled callbacks outside of the lock as they may release
+  // arbitrary state.
+  std::vector<Timepoint> cancelled_timepoints;
+  {
+    absl::MutexLock lock(&mutex_);
+    auto it = std::partition(timepoints_.begin(), timepoints_.end(),
+                             [owner](const Timepoint& timepoint) {
+                               return timepoint.owner != owner;
+                             });
+    std::move(it, timepoints_.end(), std::back_inserter(cancelled_timepoints));
+    timepoints_.erase(it, timepoints_.end());
+  }
+}
+
+// static
+Status HostTimelineSemaphore::WaitForSemaphores(
+    absl::Span<const TimelineValue> semaphores, bool wait_all,
+    absl::Time deadline) {
+  IREE_TRACE_SCOPE0("HostTimelineSemaphore::WaitForSemaphores");
+
+  // Some of the semaphores may already be signaled; we only need to wait for
+  // those that have not yet reached the expected value.
+  using HostTimelineValue = std::pair<HostTimelineSemaphore*, uint64_t>;
+  absl::InlinedVector<HostTimelineValue, 4> waitable_semaphores;
+  waitable_semaphores.reserve(semaphores.size());
+  for (auto& semaphore_value : semaphores) {
+    auto* semaphore =
+        reinterpret_cast<HostTimelineSemaphore*>(semaphore_value.first);
+    ASSIGN_OR_RETURN(uint64_t current_value, semaphore->QueryValue());
+    if (current_value < semaphore_value.second) {
+      waitable_semaphores.push_back({semaphore, semaphore_value.second});
+    } else if (!wait_all) {
+      // Any one reached value satisfies the wait.
+      return OkStatus();
+    }
+  }
+  if (waitable_semaphores.empty()) {
+    return OkStatus();
+  }
+
+  if (wait_all || waitable_semaphores.size() == 1) {
+    // Loop over the semaphores and wait for them each in turn.
+    for (auto& semaphore_value : waitable_semaphores) {
+      auto* semaphore = semaphore_value.first;
+      absl::MutexLock lock(&semaphore->mutex_);
+      if (!semaphore->mutex_.AwaitWithDeadline(
+              absl::Condition(
+                  +[](HostTimelineValue* semaphore_value) {
+                    return semaphore_value->first->IsReached(
+                        semaphore_value->second);
+                  },
+                  &semaphore_value),
+              deadline)) {
+        return DeadlineExceededErrorBuilder(IREE_LOC)
+               << "Deadline exceeded waiting for timeline semaphores";
+      }
+      if (!semaphore->status_.ok()) {
+        return semaphore->status_;
+      }
+    }
+    return OkStatus();
+  }
+
+  // Waiting for any semaphore: register a timepoint on each that wakes us.
+  // The timepoints retain the shared state as a signal racing with our return
+  // may still issue them after they have been cancelled.
+  struct WaitAnyState {
+    absl::Mutex mutex;
+    bool notified ABSL_GUARDED_BY(mutex) = false;
+  };
+  auto state = std::make_shared<WaitAnyState>();
+  for (auto& semaphore_value : waitable_semaphores) {
+    semaphore_value.first->NotifyAtValue(
+        semaphore_value.second,
+        [state]() {
+          absl::MutexLock lock(&state->mutex);
+          state->notified = true;
+        },
+        /*owner=*/state.get());
+  }
+  bool notified;
+  {
+    absl::MutexLock lock(&state->mutex);
+    notified = state->mutex.AwaitWithDeadline(
+        absl::Condition(&state->notified), deadline);
+  }
+  // Unregister the timepoints that did not fire so that they do not accumulate
+  // on semaphores that are signaled late or never.
+  for (auto& semaphore_value : waitable_semaphores) {
+    semaphore_value.first->CancelNotify(state.get());
+  }
+  if (!notified) {
+    return DeadlineExceededErrorBuilder(IREE_LOC)
+           << "Deadline exceeded waiting for timeline semaphores";
+  }
+  for (auto& semaphore_value : waitable_semaphores) {
+    auto* semaphore = semaphore_value.first;
+    if (!semaphore->IsReached(semaphore_value.second)) continue;
+    RETURN_IF_ERROR(semaphore->status());
+    return OkStatus();
+  }
+  return InternalErrorBuilder(IREE_LOC)
+         << "Woken without any timeline semaphore reaching its value";
+}
+
 HostSubmissionQueue::HostSubmissionQueue() = default;
 
 HostSubmissionQueue::~HostSubmissionQueue() = default;
@@ -101,8 +303,12 @@ bool HostSubmissionQueue::IsBatchReady(const PendingBatch& batch) const {
         return false;
       }
     } else {
-      // TODO(b/140141417): implement timeline semaphores.
-      return false;
+      auto& timeline_value = absl::get<1>(wait_point);
+      auto* timeline_semaphore =
+          reinterpret_cast<HostTimelineSemaphore*>(timeline_value.first);
+      if (!timeline_semaphore->IsReached(timeline_value.second)) {
+        return false;
+      }
     }
   }
   return true;
@@ -128,19 +334,15 @@ Status HostSubmissionQueue::Enqueue(absl::Span<const SubmissionBatch> batches,
         auto* binary_semaphore = reinterpret_cast<HostBinarySemaphore*>(
             absl::get<0>(semaphore_value));
         RETURN_IF_ERROR(binary_semaphore->BeginWaiting());
-      } else {
-        // TODO(b/140141417): implement timeline semaphores.
-        return UnimplementedErrorBuilder(IREE_LOC) << "Timeline semaphores NYI";
       }
+      // Timeline semaphores may be waited on by any number of batches and
+      // require no preparation.
     }
     for (auto& semaphore_value : batch.signal_semaphores) {
       if (semaphore_value.index() == 0) {
         auto* binary_semaphore = reinterpret_cast<HostBinarySemaphore*>(
             absl::get<0>(semaphore_value));
         RETURN_IF_ERROR(binary_semaphore->BeginSignaling());
-      } else {
-        // TODO(b/140141417): implement timeline semaphores.
-        return UnimplementedErrorBuilder(IREE_LOC) << "Timeline semaphores NYI";
       }
     }
   }
@@ -189,6 +391,9 @@ Status HostSubmissionQueue::ProcessBatches(ExecuteFn execute_fn) {
         // Batch can run! Process now and remove it from the list so we don't
         // try to run it again.
         auto batch_status = ProcessBatch(batch, execute_fn);
+        if (!batch_status.ok()) {
+          FailSignalSemaphores(batch, batch_status);
+        }
         submission->pending_batches.erase(submission->pending_batches.begin() +
                                           i);
         if (batch_status.ok()) {
@@ -204,6 +409,9 @@ Status HostSubmissionQueue::ProcessBatches(ExecuteFn execute_fn) {
           // Batch failed; set the permanent error flag and abort so we don't
           // try to process anything else.
           permanent_error_ = batch_status;
+          for (auto& pending_batch : submission->pending_batches) {
+            FailSignalSemaphores(pending_batch, batch_status);
+          }
           RETURN_IF_ERROR(CompleteSubmission(submission, batch_status));
           list_.take(submission).reset();
         }
@@ -235,8 +443,11 @@ Status HostSubmissionQueue::ProcessBatch(const PendingBatch& batch,
           reinterpret_cast<HostBinarySemaphore*>(absl::get<0>(semaphore_value));
       RETURN_IF_ERROR(binary_semaphore->EndWaiting());
     } else {
-      // TODO(b/140141417): implement timeline semaphores.
-      return UnimplementedErrorBuilder(IREE_LOC) << "Timeline semaphores NYI";
+      // The semaphore may have been reached by failing; if so the failure
+      // propagates to this batch.
+      auto* timeline_semaphore = reinterpret_cast<HostTimelineSemaphore*>(
+          absl::get<1>(semaphore_value).first);
+      RETURN_IF_ERROR(timeline_semaphore->status());
     }
   }
 
@@ -250,14 +461,27 @@ Status HostSubmissionQueue::ProcessBatch(const PendingBatch& batch,
           reinterpret_cast<HostBinarySemaphore*>(absl::get<0>(semaphore_value));
       RETURN_IF_ERROR(binary_semaphore->EndSignaling());
     } else {
-      // TODO(b/140141417): implement timeline semaphores.
-      return UnimplementedErrorBuilder(IREE_LOC) << "Timeline semaphores NYI";
+      auto& timeline_value = absl::get<1>(semaphore_value);
+      auto* timeline_semaphore =
+          reinterpret_cast<HostTimelineSemaphore*>(timeline_value.first);
+      RETURN_IF_ERROR(timeline_semaphore->Advance(timeline_value.second));
     }
   }
 
   return OkStatus();
 }
 
+void HostSubmissionQueue::FailSignalSemaphores(const PendingBatch& batch,
+                                               const Status& status) {
+  for (auto& semaphore_value : batch.signal_semaphores) {
+    if (semaphore_value.index() == 1) {
+      auto* timeline_semaphore = reinterpret_cast<HostTimelineSemaphore*>(
+          absl::get<1>(semaphore_value).first);
+      timeline_semaphore->Fail(status);
+    }
+  }
+}
+
 Status HostSubmissionQueue::CompleteSubmission(Submission* submission,
                                                Status status) {
   IREE_TRACE_SCOPE0("HostSubmissionQueue::CompleteSubmission");
@@ -281,6 +505,9 @@ void HostSubmissionQueue::FailAllPending(Status status) {
   IREE_TRACE_SCOPE0("HostSubmissionQueue::FailAllPending");
   while (!list_.empty()) {
     auto submission = list_.take(list_.front());
+    for (auto& batch : submission->pending_batches) {
+      FailSignalSemaphores(batch, status);
+    }
     CompleteSubmission(submission.get(), status).IgnoreError();
     submission.reset();
   }
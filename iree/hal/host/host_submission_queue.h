@@ -15,9 +15,17 @@
 #ifndef IREE_HAL_HOST_HOST_SUBMISSION_QUEUE_H_
 #define IREE_HAL_HOST_HOST_SUBMISSION_QUEUE_H_
 
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
 #include "absl/base/thread_annotations.h"
 #include "absl/container/inlined_vector.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
 #include "iree/base/intrusive_list.h"
 #include "iree/base/status.h"
 #include "iree/hal/command_queue.h"
@@ -67,11 +75,87 @@ class HostBinarySemaphore final : public BinarySemaphore {
 };
 
 // Simple host-only timeline semaphore implemented with a mutex.
+// The payload may be signaled from the host or by a HostSubmissionQueue and
+// waited on by any number of host threads and queued batches.
+//
+// Failing the semaphore sets its payload to UINT64_MAX so that all waiters
+// wake; they must then check status() to see whether the wait succeeded.
 //
 // Thread-safe (as instances may be imported and used by others).
 class HostTimelineSemaphore final : public TimelineSemaphore {
  public:
-  // TODO(b/140141417): implement timeline semaphores.
+  using TimelineValue = std::pair<TimelineSemaphore*, uint64_t>;
+
+  // Waits for one or more (or all) semaphores to reach or exceed the given
+  // values. Returns the status of the first failed semaphore encountered.
+  static Status WaitForSemaphores(absl::Span<const TimelineValue> semaphores,
+                                  bool wait_all, absl::Time deadline);
+
+  explicit HostTimelineSemaphore(uint64_t initial_value);
+  ~HostTimelineSemaphore() override;
+
+  // Returns the permanent failure status of the semaphore, if it has failed.
+  Status status() const;
+
+  // Returns the current payload value or the failure status.
+  StatusOr<uint64_t> QueryValue() const;
+
+  // Sets the payload to |value|, which must be greater than the current
+  // payload, and wakes all waiters that are now satisfied.
+  Status Signal(uint64_t value);
+
+  // Permanently fails the semaphore with |status| and wakes all waiters.
+  void Fail(Status status);
+
+  // Blocks the calling thread until the payload reaches or exceeds |value|.
+  Status Wait(uint64_t value, absl::Time deadline);
+
+  // Registers |callback| to be called once the payload reaches or exceeds
+  // |value| or the semaphore fails. If that has already happened the callback
+  // is called immediately on the calling thread; otherwise it is called on the
+  // signaling thread. No locks are held while the callback runs.
+  //
+  // Registrations made with a non-null |owner| may be withdrawn with
+  // CancelNotify before they fire.
+  void NotifyAtValue(uint64_t value, std::function<void()> callback,
+                     const void* owner = nullptr);
+
+  // Withdraws all pending NotifyAtValue registrations made with |owner|.
+  // Callbacks already claimed by a concurrent signal may still run.
+  void CancelNotify(const void* owner);
+
+ private:
+  friend class HostSubmissionQueue;
+
+  // A pending NotifyAtValue registration.
+  struct Timepoint {
+    uint64_t value;
+    const void* owner;
+    std::function<void()> callback;
+  };
+
+  // Returns true if the payload has reached |value| (or the semaphore failed).
+  bool IsReached(uint64_t value) const {
+    return value_.load(std::memory_order_acquire) >= value;
+  }
+
+  // Advances the payload to the maximum of |value| and the current payload as
+  // required by SubmissionBatch::signal_semaphores.
+  Status Advance(uint64_t value);
+
+  // Updates the payload and issues any timepoints that are now reached.
+  // If |require_increase| is true it is an error for |value| to not exceed the
+  // current payload.
+  Status SetValue(uint64_t value, bool require_increase);
+
+  // The mutex is not required to query the value; this lets us quickly check if
+  // a required value has been reached. The mutex is only used to update and
+  // notify waiters.
+  std::atomic<uint64_t> value_{0};
+
+  mutable absl::Mutex mutex_;
+  Status status_ ABSL_GUARDED_BY(mutex_);
+  std::vector<Timepoint> timepoints_ ABSL_GUARDED_BY(mutex_);
 };
 
 // A queue managing CommandQueue submissions that uses host-local
@@ -129,6 +213,8 @@ class HostSubmissionQueue {
   };
 
   // Returns true if all wait semaphores in the |batch| are signaled.
+  // Batches waiting on failed timeline semaphores are considered ready so that
+  // processing them propagates the failure.
   bool IsBatchReady(const PendingBatch& batch) const;
 
   // Processes a batch by resetting semaphores, dispatching the command buffers
@@ -137,6 +223,10 @@ class HostSubmissionQueue {
   // Preconditions: IsBatchReady(batch) == true
   Status ProcessBatch(const PendingBatch& batch, const ExecuteFn& execute_fn);
 
+  // Fails all timeline semaphores the |batch| would have signaled so that
+  // waiters on other queues or the host observe the |status|.
+  void FailSignalSemaphores(const PendingBatch& batch, const Status& status);
+
   // Completes a submission by signaling the fence with the given |status|.
   Status CompleteSubmission(Submission* submission, Status status);
 
@@ -14,14 +14,118 @@
 
 #include "iree/hal/host/host_submission_queue.h"
 
+#include <cstdint>
+#include <thread>  // NOLINT
+
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "iree/base/status.h"
+#include "iree/base/status_matchers.h"
 #include "iree/testing/gtest.h"
 
 namespace iree {
 namespace hal {
 namespace {
 
-TEST(HostSubmissionQueueTest, TBD) {
-  // TODO(benvanik): test!
+// Tests that timeline semaphore values may only increase.
+TEST(HostTimelineSemaphoreTest, SignalMonotonic) {
+  HostTimelineSemaphore semaphore(2u);
+  ASSERT_OK_AND_ASSIGN(uint64_t value, semaphore.QueryValue());
+  EXPECT_EQ(2u, value);
+
+  ASSERT_OK(semaphore.Signal(3u));
+  ASSERT_OK_AND_ASSIGN(value, semaphore.QueryValue());
+  EXPECT_EQ(3u, value);
+
+  EXPECT_TRUE(IsInvalidArgument(semaphore.Signal(3u)));
+  EXPECT_TRUE(IsInvalidArgument(semaphore.Signal(1u)));
+}
+
+// Tests that waits on reached values return immediately and that waits on
+// unreached values respect the deadline.
+TEST(HostTimelineSemaphoreTest, WaitDeadline) {
+  HostTimelineSemaphore semaphore(1u);
+  EXPECT_OK(semaphore.Wait(1u, absl::InfinitePast()));
+  EXPECT_TRUE(IsDeadlineExceeded(semaphore.Wait(2u, absl::InfinitePast())));
+  EXPECT_TRUE(IsDeadlineExceeded(
+      semaphore.Wait(2u, absl::Now() + absl::Milliseconds(10))));
+}
+
+// Tests that a waiting thread is woken by a signal from another thread.
+TEST(HostTimelineSemaphoreTest, WaitForSignal) {
+  HostTimelineSemaphore semaphore(0u);
+  std::thread thread([&]() { CHECK_OK(semaphore.Signal(5u)); });
+  EXPECT_OK(semaphore.Wait(4u, absl::InfiniteFuture()));
+  thread.join();
+}
+
+// Tests waiting for all or any of several semaphores.
+TEST(HostTimelineSemaphoreTest, WaitAllAndAny) {
+  HostTimelineSemaphore semaphore_a(0u);
+  HostTimelineSemaphore semaphore_b(0u);
+  HostTimelineSemaphore::TimelineValue values[] = {{&semaphore_a, 1u},
+                                                   {&semaphore_b, 1u}};
+
+  EXPECT_TRUE(IsDeadlineExceeded(HostTimelineSemaphore::WaitForSemaphores(
+      values, /*wait_all=*/false, absl::InfinitePast())));
+
+  std::thread thread([&]() { CHECK_OK(semaphore_b.Signal(1u)); });
+  EXPECT_OK(HostTimelineSemaphore::WaitForSemaphores(
+      values, /*wait_all=*/false, absl::InfiniteFuture()));
+  thread.join();
+  EXPECT_TRUE(IsDeadlineExceeded(HostTimelineSemaphore::WaitForSemaphores(
+      values, /*wait_all=*/true, absl::InfinitePast())));
+
+  ASSERT_OK(semaphore_a.Signal(1u));
+  EXPECT_OK(HostTimelineSemaphore::WaitForSemaphores(values, /*wait_all=*/true,
+                                                     absl::InfinitePast()));
+}
+
+// Tests that failure wakes waiters and is sticky.
+TEST(HostTimelineSemaphoreTest, Fail) {
+  HostTimelineSemaphore semaphore(0u);
+  std::thread thread([&]() { semaphore.Fail(DataLossErrorBuilder(IREE_LOC)); });
+  EXPECT_TRUE(IsDataLoss(semaphore.Wait(1u, absl::InfiniteFuture())));
+  thread.join();
+
+  EXPECT_TRUE(IsDataLoss(semaphore.status()));
+  EXPECT_TRUE(IsDataLoss(semaphore.QueryValue().status()));
+  EXPECT_TRUE(IsDataLoss(semaphore.Signal(2u)));
+}
+
+// Tests that timepoints are issued once their value is reached.
+TEST(HostTimelineSemaphoreTest, NotifyAtValue) {
+  HostTimelineSemaphore semaphore(1u);
+  int notify_count = 0;
+  semaphore.NotifyAtValue(1u, [&]() { ++notify_count; });
+  EXPECT_EQ(1, notify_count);
+
+  semaphore.NotifyAtValue(3u, [&]() { ++notify_count; });
+  ASSERT_OK(semaphore.Signal(2u));
+  EXPECT_EQ(1, notify_count);
+  ASSERT_OK(semaphore.Signal(4u));
+  EXPECT_EQ(2, notify_count);
+  ASSERT_OK(semaphore.Signal(5u));
+  EXPECT_EQ(2, notify_count);
+
+  semaphore.NotifyAtValue(10u, [&]() { ++notify_count; });
+  semaphore.Fail(DataLossErrorBuilder(IREE_LOC));
+  EXPECT_EQ(3, notify_count);
+}
+
+// Tests that cancelled timepoints are never issued.
+TEST(HostTimelineSemaphoreTest, CancelNotify) {
+  HostTimelineSemaphore semaphore(0u);
+  int owner_0 = 0;
+  int owner_1 = 0;
+  int notify_count_0 = 0;
+  int notify_count_1 = 0;
+  semaphore.NotifyAtValue(1u, [&]() { ++notify_count_0; }, &owner_0);
+  semaphore.NotifyAtValue(1u, [&]() { ++notify_count_1; }, &owner_1);
+  semaphore.CancelNotify(&owner_0);
+  ASSERT_OK(semaphore.Signal(1u));
+  EXPECT_EQ(0, notify_count_0);
+  EXPECT_EQ(1, notify_count_1);
 }
 
 }  // namespace
@@ -0,0 +1,199 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/hal/host/host_thread_pool.h"
+
+#include <algorithm>
+#include <cstdint>
+
+#include "absl/memory/memory.h"
+#include "iree/base/tracing.h"
+
+namespace iree {
+namespace hal {
+
+// State shared by all tiles of a single ParallelFor call.
+// Tasks retain the job so that it outlives the last tile even if the caller
+// has already returned from its wait.
+struct HostThreadPool::Job {
+  std::function<Status(int)> fn;
+  absl::Mutex mutex;
+  int remaining_tile_count ABSL_GUARDED_BY(mutex) = 0;
+  Status status ABSL_GUARDED_BY(mutex);
+};
+
+// static
+int HostThreadPool::GetDefaultWorkerCount() {
+  // The calling thread participates in ParallelFor so we reserve one hardware
+  // thread for it.
+  return std::max(0, static_cast<int>(std::thread::hardware_concurrency()) - 1);
+}
+
+HostThreadPool::HostThreadPool(int worker_count) {
+  IREE_TRACE_SCOPE0("HostThreadPool::ctor");
+  // All workers must exist prior to starting any thread as workers will try to
+  // steal from each other as soon as they are running.
+  workers_.reserve(worker_count);
+  for (int i = 0; i < worker_count; ++i) {
+    workers_.push_back(absl::make_unique<Worker>());
+  }
+  for (int i = 0; i < worker_count; ++i) {
+    workers_[i]->thread = std::thread([this, i]() { ThreadMain(i); });
+  }
+}
+
+HostThreadPool::~HostThreadPool() {
+  IREE_TRACE_SCOPE0("HostThreadPool::dtor");
+  {
+    // Workers will drain any remaining tasks prior to exiting.
+    absl::MutexLock lock(&mutex_);
+    shutdown_ = true;
+  }
+  for (auto& worker : workers_) {
+    worker->thread.join();
+  }
+}
+
+void HostThreadPool::ThreadMain(int worker_index) {
+  IREE_TRACE_THREAD_ENABLE("HostThreadPool worker");
+
+  while (true) {
+    Task task;
+    if (TryDequeueTask(worker_index, &task)) {
+      RunTask(std::move(task));
+      continue;
+    }
+
+    // Sleep until more tasks are enqueued or we are asked to exit.
+    absl::MutexLock lock(&mutex_);
+    mutex_.Await(
+        absl::Condition(this, &HostThreadPool::HasPendingTasksOrShutdown));
+    if (shutdown_ && pending_task_count_ <= 0) {
+      break;
+    }
+  }
+}
+
+bool HostThreadPool::HasPendingTasksOrShutdown() const {
+  return shutdown_ || pending_task_count_ > 0;
+}
+
+bool HostThreadPool::TryDequeueTask(int worker_index, Task* out_task) {
+  bool found_task = false;
+
+  // Prefer our own tasks in the order they were distributed.
+  if (worker_index >= 0) {
+    auto* worker = workers_[worker_index].get();
+    absl::MutexLock lock(&worker->mutex);
+    if (!worker->tasks.empty()) {
+      *out_task = std::move(worker->tasks.front());
+      worker->tasks.pop_front();
+      found_task = true;
+    }
+  }
+
+  // Steal from the back of the other workers' deques. Starting with our
+  // neighbor spreads thieves out across the victims.
+  int worker_count = static_cast<int>(workers_.size());
+  int start_index = worker_index + 1;
+  for (int i = 0; !found_task && i < worker_count; ++i) {
+    int victim_index = (start_index + i) % worker_count;
+    if (victim_index == worker_index) continue;
+    auto* victim = workers_[victim_index].get();
+    absl::MutexLock lock(&victim->mutex);
+    if (!victim->tasks.empty()) {
+      *out_task = std::move(victim->tasks.back());
+      victim->tasks.pop_back();
+      found_task = true;
+    }
+  }
+
+  if (found_task) {
+    absl::MutexLock lock(&mutex_);
+    --pending_task_count_;
+  }
+  return found_task;
+}
+
+// static
+void HostThreadPool::RunTask(Task task) {
+  IREE_TRACE_SCOPE0("HostThreadPool::RunTask");
+  auto status = task.job->fn(task.tile_index);
+  absl::MutexLock lock(&task.job->mutex);
+  if (!status.ok() && task.job->status.ok()) {
+    task.job->status = std::move(status);
+  }
+  --task.job->remaining_tile_count;
+}
+
+Status HostThreadPool::ParallelFor(int tile_count,
+                                   std::function<Status(int)> fn) {
+  IREE_TRACE_SCOPE0("HostThreadPool::ParallelFor");
+  if (tile_count <= 0) return OkStatus();
+
+  // Run inline when there is nothing to gain from the workers.
+  if (workers_.empty() || tile_count == 1) {
+    Status result;
+    for (int i = 0; i < tile_count; ++i) {
+      auto status = fn(i);
+      if (!status.ok() && result.ok()) result = std::move(status);
+    }
+    return result;
+  }
+
+  auto job = std::make_shared<Job>();
+  job->fn = std::move(fn);
+  {
+    absl::MutexLock lock(&job->mutex);
+    job->remaining_tile_count = tile_count;
+  }
+
+  // Hand each worker a contiguous run of tiles.
+  int worker_count = static_cast<int>(workers_.size());
+  for (int i = 0; i < worker_count; ++i) {
+    int begin = static_cast<int>(int64_t{tile_count} * i / worker_count);
+    int end = static_cast<int>(int64_t{tile_count} * (i + 1) / worker_count);
+    if (begin == end) continue;
+    auto* worker = workers_[i].get();
+    absl::MutexLock lock(&worker->mutex);
+    for (int tile_index = begin; tile_index < end; ++tile_index) {
+      worker->tasks.push_back({job, tile_index});
+    }
+  }
+  {
+    absl::MutexLock lock(&mutex_);
+    pending_task_count_ += tile_count;
+  }
+
+  // Help execute tiles until there are none left to steal or our job is done.
+  while (true) {
+    {
+      absl::MutexLock lock(&job->mutex);
+      if (job->remaining_tile_count == 0) break;
+    }
+    Task task;
+    if (!TryDequeueTask(-1, &task)) break;
+    RunTask(std::move(task));
+  }
+
+  // Wait for any tiles still in-flight on workers.
+  absl::MutexLock lock(&job->mutex);
+  job->mutex.Await(absl::Condition(
+      +[](int* remaining_tile_count) { return *remaining_tile_count == 0; },
+      &job->remaining_tile_count));
+  return job->status;
+}
+
+}  // namespace hal
+}  // namespace iree
@@ -0,0 +1,103 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef IREE_HAL_HOST_HOST_THREAD_POOL_H_
+#define IREE_HAL_HOST_HOST_THREAD_POOL_H_
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "iree/base/status.h"
+
+namespace iree {
+namespace hal {
+
+// Work-stealing pool of host threads used to execute tiles of parallel work.
+//
+// Each worker thread owns a deque of pending tiles. ParallelFor distributes
+// contiguous runs of tiles across the worker deques so that each worker starts
+// with a cache-friendly chunk of the range; workers that drain their own deque
+// steal from the back of other workers' deques. The thread calling ParallelFor
+// participates in executing tiles until the whole range has completed, which
+// keeps nested use (such as from within a tile) from deadlocking.
+//
+// Thread-safe.
+class HostThreadPool final {
+ public:
+  // Returns a worker count that, together with the calling thread, uses all of
+  // the hardware threads available to the process.
+  static int GetDefaultWorkerCount();
+
+  // Creates a pool with |worker_count| threads. A count of 0 creates no threads
+  // and all work will execute on the thread calling ParallelFor.
+  explicit HostThreadPool(int worker_count);
+  ~HostThreadPool();
+
+  // Total number of worker threads owned by the pool.
+  int worker_count() const { return static_cast<int>(workers_.size()); }
+
+  // Maximum number of tiles that may execute concurrently (the workers plus
+  // the thread calling ParallelFor).
+  int concurrency() const { return worker_count() + 1; }
+
+  // Executes |fn| once for each tile index in [0, tile_count) and blocks until
+  // all tiles have completed. Tiles may execute in any order and on any thread.
+  // Returns the first error returned by any tile; remaining tiles still execute
+  // but their results are ignored.
+  Status ParallelFor(int tile_count, std::function<Status(int)> fn);
+
+ private:
+  struct Job;
+  struct Task {
+    std::shared_ptr<Job> job;
+    int tile_index = 0;
+  };
+  struct Worker {
+    absl::Mutex mutex;
+    std::deque<Task> tasks ABSL_GUARDED_BY(mutex);
+    std::thread thread;
+  };
+
+  // Thread entry point for worker |worker_index|.
+  void ThreadMain(int worker_index);
+
+  // Returns true if workers should wake to dequeue tasks or exit.
+  bool HasPendingTasksOrShutdown() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  // Pops a task from the front of |worker_index|'s deque or, if empty, steals
+  // one from the back of another worker's deque. |worker_index| may be -1 to
+  // only steal (as is done by threads outside of the pool).
+  bool TryDequeueTask(int worker_index, Task* out_task);
+
+  // Executes |task| and records its completion on the owning job.
+  static void RunTask(Task task);
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+
+  // Guards the sleep/wake state of the workers. The deques themselves are
+  // guarded by their per-worker mutexes.
+  mutable absl::Mutex mutex_;
+  int pending_task_count_ ABSL_GUARDED_BY(mutex_) = 0;
+  bool shutdown_ ABSL_GUARDED_BY(mutex_) = false;
+};
+
+}  // namespace hal
+}  // namespace iree
+
+#endif  // IREE_HAL_HOST_HOST_THREAD_POOL_H_
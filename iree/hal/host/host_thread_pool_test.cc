@@ -0,0 +1,113 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/hal/host/host_thread_pool.h"
+
+#include <atomic>
+#include <vector>
+
+#include "iree/base/status.h"
+#include "iree/base/status_matchers.h"
+#include "iree/testing/gtest.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+// Tests that a pool that is never used properly cleans itself up.
+TEST(HostThreadPoolTest, NoOp) {
+  HostThreadPool thread_pool(4);
+  EXPECT_EQ(4, thread_pool.worker_count());
+  EXPECT_EQ(5, thread_pool.concurrency());
+}
+
+// Tests that empty ranges complete immediately.
+TEST(HostThreadPoolTest, EmptyRange) {
+  HostThreadPool thread_pool(2);
+  EXPECT_OK(thread_pool.ParallelFor(0, [](int tile_index) -> Status {
+    return UnknownErrorBuilder(IREE_LOC) << "Should not be called";
+  }));
+}
+
+// Tests that a pool with no workers executes all tiles on the caller.
+TEST(HostThreadPoolTest, NoWorkers) {
+  HostThreadPool thread_pool(0);
+  std::vector<int> results(16, 0);
+  EXPECT_OK(thread_pool.ParallelFor(results.size(), [&](int tile_index) {
+    results[tile_index] = tile_index * 2;
+    return OkStatus();
+  }));
+  for (int i = 0; i < results.size(); ++i) {
+    EXPECT_EQ(i * 2, results[i]);
+  }
+}
+
+// Tests that every tile executes exactly once.
+TEST(HostThreadPoolTest, AllTilesExecuteOnce) {
+  HostThreadPool thread_pool(4);
+  std::vector<std::atomic<int>> counts(1000);
+  for (auto& count : counts) count = 0;
+  EXPECT_OK(thread_pool.ParallelFor(counts.size(), [&](int tile_index) {
+    ++counts[tile_index];
+    return OkStatus();
+  }));
+  for (auto& count : counts) {
+    EXPECT_EQ(1, count.load());
+  }
+}
+
+// Tests that the pool can be reused for many sequential ranges.
+TEST(HostThreadPoolTest, SequentialRanges) {
+  HostThreadPool thread_pool(3);
+  std::atomic<int> total{0};
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_OK(thread_pool.ParallelFor(7, [&](int tile_index) {
+      total += tile_index;
+      return OkStatus();
+    }));
+  }
+  EXPECT_EQ(100 * (0 + 1 + 2 + 3 + 4 + 5 + 6), total.load());
+}
+
+// Tests that ParallelFor may be called from within a tile without deadlocking.
+TEST(HostThreadPoolTest, NestedRanges) {
+  HostThreadPool thread_pool(2);
+  std::atomic<int> total{0};
+  EXPECT_OK(thread_pool.ParallelFor(8, [&](int outer_index) {
+    return thread_pool.ParallelFor(8, [&](int inner_index) {
+      ++total;
+      return OkStatus();
+    });
+  }));
+  EXPECT_EQ(64, total.load());
+}
+
+// Tests that errors from a tile are returned to the caller.
+TEST(HostThreadPoolTest, ErrorPropagation) {
+  HostThreadPool thread_pool(4);
+  std::atomic<int> executed_count{0};
+  auto status = thread_pool.ParallelFor(64, [&](int tile_index) -> Status {
+    ++executed_count;
+    if (tile_index == 13) {
+      return UnknownErrorBuilder(IREE_LOC) << "Tile failed";
+    }
+    return OkStatus();
+  });
+  EXPECT_TRUE(IsUnknown(status));
+  EXPECT_EQ(64, executed_count.load());
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
@@ -14,6 +14,7 @@
 
 #include "iree/hal/host/inproc_command_buffer.h"
 
+#include "absl/container/inlined_vector.h"
 #include "iree/base/tracing.h"
 
 namespace iree {
@@ -182,28 +183,63 @@ void* InProcCommandBuffer::AppendCmdData(const void* source_buffer,
   return allocated_bytes;
 }
 
+namespace {
+
+void LogCommandFailure(const Status& command_status) {
+  LOG(ERROR) << "DeviceQueue failure while executing command; permanently "
+                "failing all future commands: "
+             << command_status;
+}
+
+}  // namespace
+
 Status InProcCommandBuffer::Process(CommandBuffer* command_processor) const {
+  return Process(command_processor, /*thread_pool=*/nullptr);
+}
+
+Status InProcCommandBuffer::Process(CommandBuffer* command_processor,
+                                    HostThreadPool* thread_pool) const {
   IREE_TRACE_SCOPE0("InProcCommandBuffer::Process");
 
   RETURN_IF_ERROR(command_processor->Begin());
 
-  // Process each command in the order they were recorded.
+  // Process each command in the order they were recorded. Consecutive
+  // dispatches are batched up until the next non-dispatch command (such as a
+  // barrier) and then issued together.
+  absl::InlinedVector<CmdHeader*, 8> pending_dispatches;
   auto* cmd_list = &current_cmd_list_;
   for (CmdHeader* cmd_header = cmd_list->head; cmd_header != nullptr;
        cmd_header = cmd_header->next) {
-    auto command_status = ProcessCmd(cmd_header, command_processor);
-    if (!command_status.ok()) {
-      LOG(ERROR) << "DeviceQueue failure while executing command; permanently "
-                    "failing all future commands: "
-                 << command_status;
+    if (thread_pool && cmd_header->type == CmdType::kDispatch) {
+      pending_dispatches.push_back(cmd_header);
+      continue;
     }
+    ProcessDispatchCmds(pending_dispatches, command_processor, thread_pool);
+    pending_dispatches.clear();
+    auto command_status = ProcessCmd(cmd_header, command_processor);
+    if (!command_status.ok()) LogCommandFailure(command_status);
   }
+  ProcessDispatchCmds(pending_dispatches, command_processor, thread_pool);
 
   RETURN_IF_ERROR(command_processor->End());
 
   return OkStatus();
 }
 
+void InProcCommandBuffer::ProcessDispatchCmds(
+    absl::Span<CmdHeader* const> cmd_headers, CommandBuffer* command_processor,
+    HostThreadPool* thread_pool) const {
+  if (cmd_headers.empty()) return;
+  IREE_TRACE_SCOPE0("InProcCommandBuffer::ProcessDispatchCmds");
+  auto status = thread_pool->ParallelFor(
+      static_cast<int>(cmd_headers.size()), [&](int i) -> Status {
+        auto command_status = ProcessCmd(cmd_headers[i], command_processor);
+        if (!command_status.ok()) LogCommandFailure(command_status);
+        return OkStatus();
+      });
+  status.IgnoreError();
+}
+
 Status InProcCommandBuffer::ProcessCmd(CmdHeader* cmd_header,
                                        CommandBuffer* command_processor) const {
   switch (cmd_header->type) {
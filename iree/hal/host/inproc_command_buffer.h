@@ -19,6 +19,7 @@
 #include "iree/base/intrusive_list.h"
 #include "iree/base/status.h"
 #include "iree/hal/command_buffer.h"
+#include "iree/hal/host/host_thread_pool.h"
 
 namespace iree {
 namespace hal {
@@ -79,6 +80,14 @@ class InProcCommandBuffer final : public CommandBuffer {
   // The commands are issued in the order they were recorded.
   Status Process(CommandBuffer* command_processor) const;
 
+  // Processes all commands in the buffer using the given |command_processor|.
+  // Runs of dispatches recorded without any barrier or other command between
+  // them have no ordering requirements and are issued concurrently on
+  // |thread_pool|; all other commands are issued in the order they were
+  // recorded. |command_processor| must support concurrent Dispatch calls.
+  Status Process(CommandBuffer* command_processor,
+                 HostThreadPool* thread_pool) const;
+
  private:
   // Type of Cmd, used by CmdHeader to identify the command payload.
   enum class CmdType {
@@ -229,6 +238,11 @@ class InProcCommandBuffer final : public CommandBuffer {
   Status ProcessCmd(CmdHeader* cmd_header,
                     CommandBuffer* command_processor) const;
 
+  // Processes the dispatch commands in |cmd_headers| concurrently.
+  void ProcessDispatchCmds(absl::Span<CmdHeader* const> cmd_headers,
+                           CommandBuffer* command_processor,
+                           HostThreadPool* thread_pool) const;
+
   bool is_recording_ = false;
 
   // NOTE: not synchronized. Expected to be used from a single thread.
@@ -0,0 +1,159 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/hal/host/inproc_command_buffer.h"
+
+#include <vector>
+
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "iree/base/status.h"
+#include "iree/base/status_matchers.h"
+#include "iree/hal/host/host_local_command_processor.h"
+#include "iree/hal/host/host_thread_pool.h"
+#include "iree/testing/gtest.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+// Command processor that tracks the dispatches it executes by entry point.
+class TrackingCommandProcessor : public HostLocalCommandProcessor {
+ public:
+  TrackingCommandProcessor()
+      : HostLocalCommandProcessor(nullptr, CommandBufferMode::kOneShot,
+                                  CommandCategory::kDispatch) {}
+
+  // Makes each dispatch wait until |count| dispatches have started before it
+  // completes. overlapped() returns false if any wait timed out.
+  void set_wait_for_started_count(int count) {
+    wait_for_started_count_ = count;
+  }
+
+  Status Dispatch(const DispatchRequest& dispatch_request) override {
+    absl::MutexLock lock(&mutex_);
+    ++started_count_;
+    started_entry_points_.push_back(dispatch_request.entry_point);
+    completed_counts_at_start_.push_back(completed_count_);
+    if (wait_for_started_count_) {
+      auto condition = [this]() {
+        mutex_.AssertHeld();
+        return started_count_ >= wait_for_started_count_;
+      };
+      if (!mutex_.AwaitWithTimeout(absl::Condition(&condition),
+                                   absl::Seconds(10))) {
+        overlapped_ = false;
+      }
+    }
+    ++completed_count_;
+    return OkStatus();
+  }
+
+  bool overlapped() {
+    absl::MutexLock lock(&mutex_);
+    return overlapped_;
+  }
+  std::vector<int> started_entry_points() {
+    absl::MutexLock lock(&mutex_);
+    return started_entry_points_;
+  }
+  std::vector<int> completed_counts_at_start() {
+    absl::MutexLock lock(&mutex_);
+    return completed_counts_at_start_;
+  }
+
+ private:
+  absl::Mutex mutex_;
+  int wait_for_started_count_ = 0;
+  int started_count_ ABSL_GUARDED_BY(mutex_) = 0;
+  int completed_count_ ABSL_GUARDED_BY(mutex_) = 0;
+  bool overlapped_ ABSL_GUARDED_BY(mutex_) = true;
+  std::vector<int> started_entry_points_ ABSL_GUARDED_BY(mutex_);
+  std::vector<int> completed_counts_at_start_ ABSL_GUARDED_BY(mutex_);
+};
+
+Status RecordDispatch(CommandBuffer* command_buffer, int entry_point) {
+  DispatchRequest dispatch_request;
+  dispatch_request.entry_point = entry_point;
+  return command_buffer->Dispatch(dispatch_request);
+}
+
+Status RecordBarrier(CommandBuffer* command_buffer) {
+  return command_buffer->ExecutionBarrier(
+      ExecutionStage::kCommandRetire, ExecutionStage::kCommandIssue, {}, {});
+}
+
+// Tests that without a thread pool commands are processed in order.
+TEST(InProcCommandBufferTest, SerialProcessing) {
+  InProcCommandBuffer command_buffer(nullptr, CommandBufferMode::kOneShot,
+                                     CommandCategory::kDispatch);
+  ASSERT_OK(command_buffer.Begin());
+  ASSERT_OK(RecordDispatch(&command_buffer, 0));
+  ASSERT_OK(RecordDispatch(&command_buffer, 1));
+  ASSERT_OK(RecordDispatch(&command_buffer, 2));
+  ASSERT_OK(command_buffer.End());
+
+  TrackingCommandProcessor command_processor;
+  ASSERT_OK(command_buffer.Process(&command_processor));
+  EXPECT_EQ((std::vector<int>{0, 1, 2}),
+            command_processor.started_entry_points());
+  EXPECT_EQ((std::vector<int>{0, 1, 2}),
+            command_processor.completed_counts_at_start());
+}
+
+// Tests that dispatches without a barrier between them execute concurrently.
+TEST(InProcCommandBufferTest, ConcurrentDispatches) {
+  InProcCommandBuffer command_buffer(nullptr, CommandBufferMode::kOneShot,
+                                     CommandCategory::kDispatch);
+  ASSERT_OK(command_buffer.Begin());
+  ASSERT_OK(RecordDispatch(&command_buffer, 0));
+  ASSERT_OK(RecordDispatch(&command_buffer, 1));
+  ASSERT_OK(command_buffer.End());
+
+  HostThreadPool thread_pool(2);
+  TrackingCommandProcessor command_processor;
+  command_processor.set_wait_for_started_count(2);
+  ASSERT_OK(command_buffer.Process(&command_processor, &thread_pool));
+  EXPECT_TRUE(command_processor.overlapped());
+}
+
+// Tests that dispatches after a barrier wait for all prior dispatches.
+TEST(InProcCommandBufferTest, BarrierOrdersDispatches) {
+  InProcCommandBuffer command_buffer(nullptr, CommandBufferMode::kOneShot,
+                                     CommandCategory::kDispatch);
+  ASSERT_OK(command_buffer.Begin());
+  ASSERT_OK(RecordDispatch(&command_buffer, 0));
+  ASSERT_OK(RecordDispatch(&command_buffer, 1));
+  ASSERT_OK(RecordDispatch(&command_buffer, 2));
+  ASSERT_OK(RecordBarrier(&command_buffer));
+  ASSERT_OK(RecordDispatch(&command_buffer, 3));
+  ASSERT_OK(RecordBarrier(&command_buffer));
+  ASSERT_OK(RecordDispatch(&command_buffer, 4));
+  ASSERT_OK(command_buffer.End());
+
+  HostThreadPool thread_pool(4);
+  TrackingCommandProcessor command_processor;
+  ASSERT_OK(command_buffer.Process(&command_processor, &thread_pool));
+  auto entry_points = command_processor.started_entry_points();
+  auto completed_counts = command_processor.completed_counts_at_start();
+  ASSERT_EQ(5, entry_points.size());
+  EXPECT_EQ(3, entry_points[3]);
+  EXPECT_EQ(3, completed_counts[3]);
+  EXPECT_EQ(4, entry_points[4]);
+  EXPECT_EQ(4, completed_counts[4]);
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
@@ -0,0 +1,292 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/hal/host/pooled_host_local_allocator.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "iree/base/source_location.h"
+#include "iree/base/status.h"
+#include "iree/base/tracing.h"
+#include "iree/hal/host/host_buffer.h"
+
+namespace iree {
+namespace hal {
+
+namespace {
+
+// Smallest size class; all smaller allocations are rounded up to this.
+constexpr int kMinSizeClassShift = 6;
+constexpr size_t kMinSizeClassSize = size_t{1} << kMinSizeClassShift;
+
+// Number of size classes each power-of-two range is divided into. Larger
+// values waste less memory to rounding at the cost of less reuse.
+constexpr int kSizeClassesPerPowerOfTwoShift = 2;
+constexpr int kSizeClassesPerPowerOfTwo = 1 << kSizeClassesPerPowerOfTwoShift;
+
+// Returns the index of the smallest size class that can hold |size| bytes.
+int SizeClassIndex(size_t size) {
+  if (size <= kMinSizeClassSize) return 0;
+  // (size - 1) is in [2^shift, 2^(shift+1)) and shift >= kMinSizeClassShift.
+  int shift = 0;
+  while ((size - 1) >> (shift + 1)) ++shift;
+  size_t step = size_t{1} << (shift - kSizeClassesPerPowerOfTwoShift);
+  int subclass = static_cast<int>((size - 1 - (size_t{1} << shift)) / step);
+  return (shift - kMinSizeClassShift) * kSizeClassesPerPowerOfTwo + subclass +
+         1;
+}
+
+// Returns the size in bytes of the size class at |index|.
+size_t SizeClassSize(int index) {
+  if (index == 0) return kMinSizeClassSize;
+  int shift = (index - 1) / kSizeClassesPerPowerOfTwo + kMinSizeClassShift;
+  int subclass = (index - 1) % kSizeClassesPerPowerOfTwo;
+  return (size_t{1} << shift) +
+         (subclass + 1) *
+             (size_t{1} << (shift - kSizeClassesPerPowerOfTwoShift));
+}
+
+}  // namespace
+
+// Storage shared between the allocator and all buffers it has allocated.
+class PooledHostLocalAllocator::StoragePool {
+ public:
+  explicit StoragePool(Options options)
+      : options_(options),
+        free_lists_(SizeClassIndex(std::max(options.max_pooled_allocation_size,
+                                            kMinSizeClassSize)) +
+                    1) {}
+
+  ~StoragePool() { Trim(); }
+
+  // Returns true if allocations of |size| bytes are serviced by the pool.
+  bool IsPooled(size_t size) const {
+    return size <= options_.max_pooled_allocation_size;
+  }
+
+  Statistics statistics() const {
+    absl::MutexLock lock(&mutex_);
+    return statistics_;
+  }
+
+  // Acquires storage from the size class |size_class_index|, allocating new
+  // storage if none is retained. |out_recycled| is set to true if the storage
+  // was previously used and false if it is freshly zeroed. Returns nullptr if
+  // the allocation failed.
+  void* Acquire(int size_class_index, bool* out_recycled) {
+    size_t size_class_size = SizeClassSize(size_class_index);
+    {
+      absl::MutexLock lock(&mutex_);
+      auto& free_list = free_lists_[size_class_index];
+      if (!free_list.empty()) {
+        void* data = free_list.back();
+        free_list.pop_back();
+        statistics_.bytes_retained -= size_class_size;
+        ++statistics_.hit_count;
+        AddBytesInUse(size_class_size);
+        *out_recycled = true;
+        return data;
+      }
+      ++statistics_.miss_count;
+    }
+
+    *out_recycled = false;
+    void* data = std::calloc(1, size_class_size);
+    if (!data) return nullptr;
+    absl::MutexLock lock(&mutex_);
+    AddBytesInUse(size_class_size);
+    return data;
+  }
+
+  // Returns storage previously acquired from |size_class_index| to the pool.
+  void Release(void* data, int size_class_index) {
+    size_t size_class_size = SizeClassSize(size_class_index);
+    {
+      absl::MutexLock lock(&mutex_);
+      statistics_.bytes_in_use -= size_class_size;
+      if (statistics_.bytes_retained + size_class_size <=
+          options_.max_retained_bytes) {
+        free_lists_[size_class_index].push_back(data);
+        statistics_.bytes_retained += size_class_size;
+        return;
+      }
+    }
+    std::free(data);
+  }
+
+  // Tracks storage that was allocated outside of the pool.
+  void AcquireUnpooled(size_t size) {
+    absl::MutexLock lock(&mutex_);
+    ++statistics_.unpooled_count;
+    AddBytesInUse(size);
+  }
+  void ReleaseUnpooled(size_t size) {
+    absl::MutexLock lock(&mutex_);
+    statistics_.bytes_in_use -= size;
+  }
+
+  void Trim() {
+    std::vector<std::vector<void*>> free_lists;
+    {
+      absl::MutexLock lock(&mutex_);
+      free_lists.swap(free_lists_);
+      free_lists_.resize(free_lists.size());
+      statistics_.bytes_retained = 0;
+    }
+    for (auto& free_list : free_lists) {
+      for (void* data : free_list) {
+        std::free(data);
+      }
+    }
+  }
+
+ private:
+  void AddBytesInUse(size_t size) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    statistics_.bytes_in_use += size;
+    statistics_.bytes_in_use_high_water = std::max(
+        statistics_.bytes_in_use_high_water, statistics_.bytes_in_use);
+  }
+
+  const Options options_;
+
+  mutable absl::Mutex mutex_;
+  std::vector<std::vector<void*>> free_lists_ ABSL_GUARDED_BY(mutex_);
+  Statistics statistics_ ABSL_GUARDED_BY(mutex_);
+};
+
+// A HostBuffer that returns its storage to the pool it came from when freed.
+class PooledHostLocalAllocator::PooledBuffer final : public HostBuffer {
+ public:
+  PooledBuffer(Allocator* allocator, MemoryTypeBitfield memory_type,
+               BufferUsageBitfield usage, device_size_t allocation_size,
+               void* data, int size_class_index,
+               std::shared_ptr<StoragePool> storage_pool)
+      : HostBuffer(allocator, memory_type, MemoryAccess::kAll, usage,
+                   allocation_size, data, /*owns_data=*/false),
+        data_(data),
+        size_class_index_(size_class_index),
+        storage_pool_(std::move(storage_pool)) {}
+
+  ~PooledBuffer() override {
+    storage_pool_->Release(data_, size_class_index_);
+  }
+
+ private:
+  void* data_;
+  int size_class_index_;
+  std::shared_ptr<StoragePool> storage_pool_;
+};
+
+// A HostBuffer too large to be pooled that still reports to the pool
+// statistics.
+class PooledHostLocalAllocator::UnpooledBuffer final : public HostBuffer {
+ public:
+  UnpooledBuffer(Allocator* allocator, MemoryTypeBitfield memory_type,
+                 BufferUsageBitfield usage, device_size_t allocation_size,
+                 void* data, std::shared_ptr<StoragePool> storage_pool)
+      : HostBuffer(allocator, memory_type, MemoryAccess::kAll, usage,
+                   allocation_size, data, /*owns_data=*/true),
+        storage_pool_(std::move(storage_pool)) {}
+
+  ~UnpooledBuffer() override {
+    storage_pool_->ReleaseUnpooled(allocation_size());
+  }
+
+ private:
+  std::shared_ptr<StoragePool> storage_pool_;
+};
+
+PooledHostLocalAllocator::PooledHostLocalAllocator()
+    : PooledHostLocalAllocator(Options{}) {}
+
+PooledHostLocalAllocator::PooledHostLocalAllocator(Options options)
+    : storage_pool_(std::make_shared<StoragePool>(options)) {}
+
+PooledHostLocalAllocator::~PooledHostLocalAllocator() = default;
+
+PooledHostLocalAllocator::Statistics PooledHostLocalAllocator::statistics()
+    const {
+  return storage_pool_->statistics();
+}
+
+void PooledHostLocalAllocator::Trim() {
+  IREE_TRACE_SCOPE0("PooledHostLocalAllocator::Trim");
+  storage_pool_->Trim();
+}
+
+StatusOr<ref_ptr<Buffer>> PooledHostLocalAllocator::Allocate(
+    MemoryTypeBitfield memory_type, BufferUsageBitfield buffer_usage,
+    size_t allocation_size) {
+  IREE_TRACE_SCOPE0("PooledHostLocalAllocator::Allocate");
+
+  if (!CanAllocate(memory_type, buffer_usage, allocation_size)) {
+    return FailedPreconditionErrorBuilder(IREE_LOC)
+           << "Allocation not supported; memory_type="
+           << MemoryTypeString(memory_type)
+           << ", buffer_usage=" << BufferUsageString(buffer_usage)
+           << ", allocation_size=" << allocation_size;
+  }
+
+  // Make compatible with our requirements.
+  RETURN_IF_ERROR(MakeCompatible(&memory_type, &buffer_usage));
+
+  ref_ptr<Buffer> buffer;
+  void* data = nullptr;
+  bool recycled = false;
+  if (storage_pool_->IsPooled(allocation_size)) {
+    int size_class_index = SizeClassIndex(allocation_size);
+    data = storage_pool_->Acquire(size_class_index, &recycled);
+    if (!data) {
+      return ResourceExhaustedErrorBuilder(IREE_LOC)
+             << "Failed to allocate " << SizeClassSize(size_class_index)
+             << " bytes";
+    }
+    buffer = make_ref<PooledBuffer>(this, memory_type, buffer_usage,
+                                    allocation_size, data, size_class_index,
+                                    storage_pool_);
+  } else {
+    data = std::calloc(1, allocation_size);
+    if (!data) {
+      return ResourceExhaustedErrorBuilder(IREE_LOC)
+             << "Failed to allocate " << allocation_size << " bytes";
+    }
+    storage_pool_->AcquireUnpooled(allocation_size);
+    buffer = make_ref<UnpooledBuffer>(this, memory_type, buffer_usage,
+                                      allocation_size, data, storage_pool_);
+  }
+
+  // New storage comes from calloc and only recycled storage may be dirty.
+  // Transient buffers are always written before they are read and so may skip
+  // clearing it.
+  if (!AnyBitSet(memory_type & MemoryType::kTransient)) {
+    if (recycled) std::memset(data, 0, allocation_size);
+  } else {
+    // Scribble over recycled contents to make reads of uninitialized memory
+    // easier to spot, matching what HostBuffer does for discarded mappings.
+#ifndef NDEBUG
+    std::memset(data, 0xCD, allocation_size);
+#endif  // !NDEBUG
+  }
+
+  return buffer;
+}
+
+}  // namespace hal
+}  // namespace iree
@@ -0,0 +1,99 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef IREE_HAL_HOST_POOLED_HOST_LOCAL_ALLOCATOR_H_
+#define IREE_HAL_HOST_POOLED_HOST_LOCAL_ALLOCATOR_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "iree/base/status.h"
+#include "iree/hal/buffer.h"
+#include "iree/hal/host/host_local_allocator.h"
+
+namespace iree {
+namespace hal {
+
+// A HostLocalAllocator that recycles the host memory backing its buffers.
+//
+// Allocation sizes are rounded up to a size class (4 classes per power of two)
+// and when the last reference to a buffer is released its storage is returned
+// to the free list of its class instead of to the system. Subsequent
+// allocations of the same class reuse that storage without touching the system
+// allocator. Allocations larger than Options::max_pooled_allocation_size
+// bypass the pool entirely.
+//
+// As with HostLocalAllocator the contents of allocated buffers are zeroed,
+// except for allocations with MemoryType::kTransient: their contents are
+// undefined and recycled storage is handed out without being cleared.
+//
+// Buffers may safely outlive the allocator; any storage they return after the
+// allocator has been destroyed is freed when the last buffer is released.
+//
+// Thread-safe.
+class PooledHostLocalAllocator final : public HostLocalAllocator {
+ public:
+  struct Options {
+    // Allocations larger than this many bytes are always serviced by the
+    // system allocator and never retained.
+    size_t max_pooled_allocation_size = 64 * 1024 * 1024;
+
+    // Maximum total bytes of unused storage retained across all size classes.
+    // Storage released when the pool is at capacity is freed immediately.
+    size_t max_retained_bytes = 256 * 1024 * 1024;
+  };
+
+  struct Statistics {
+    // Number of allocations serviced from retained storage.
+    int64_t hit_count = 0;
+    // Number of pooled allocations that required new storage.
+    int64_t miss_count = 0;
+    // Number of allocations too large to be pooled.
+    int64_t unpooled_count = 0;
+    // Total bytes of storage (including size class rounding) currently backing
+    // live buffers.
+    size_t bytes_in_use = 0;
+    // Maximum value bytes_in_use has reached.
+    size_t bytes_in_use_high_water = 0;
+    // Total bytes of unused storage held in the free lists.
+    size_t bytes_retained = 0;
+  };
+
+  PooledHostLocalAllocator();
+  explicit PooledHostLocalAllocator(Options options);
+  ~PooledHostLocalAllocator() override;
+
+  // Returns a snapshot of the allocation statistics.
+  Statistics statistics() const;
+
+  // Frees all unused storage retained by the pool.
+  void Trim();
+
+  StatusOr<ref_ptr<Buffer>> Allocate(MemoryTypeBitfield memory_type,
+                                     BufferUsageBitfield buffer_usage,
+                                     size_t allocation_size) override;
+
+ private:
+  class StoragePool;
+  class PooledBuffer;
+  class UnpooledBuffer;
+
+  std::shared_ptr<StoragePool> storage_pool_;
+};
+
+}  // namespace hal
+}  // namespace iree
+
+#endif  // IREE_HAL_HOST_POOLED_HOST_LOCAL_ALLOCATOR_H_
@@ -0,0 +1,222 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/hal/host/pooled_host_local_allocator.h"
+
+#include <cstdint>
+
+#include "iree/base/status.h"
+#include "iree/base/status_matchers.h"
+#include "iree/testing/gtest.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+const MemoryTypeBitfield kMemoryType =
+    MemoryType::kHostLocal | MemoryType::kDeviceVisible;
+const BufferUsageBitfield kBufferUsage =
+    BufferUsage::kTransfer | BufferUsage::kMapping | BufferUsage::kDispatch;
+
+// Returns the host pointer backing |buffer|.
+const void* GetBufferData(Buffer* buffer) {
+  auto mapping_or = buffer->MapMemory<uint8_t>(MemoryAccess::kRead);
+  CHECK_OK(mapping_or.status());
+  return mapping_or.ValueOrDie().data();
+}
+
+// Tests that released storage is reused by allocations of the same size.
+TEST(PooledHostLocalAllocatorTest, RecyclesStorage) {
+  PooledHostLocalAllocator allocator;
+
+  ASSERT_OK_AND_ASSIGN(auto buffer_0,
+                       allocator.Allocate(kMemoryType, kBufferUsage, 1000));
+  EXPECT_EQ(1000, buffer_0->byte_length());
+  const void* data_0 = GetBufferData(buffer_0.get());
+  buffer_0.reset();
+
+  ASSERT_OK_AND_ASSIGN(auto buffer_1,
+                       allocator.Allocate(kMemoryType, kBufferUsage, 1000));
+  EXPECT_EQ(data_0, GetBufferData(buffer_1.get()));
+
+  auto statistics = allocator.statistics();
+  EXPECT_EQ(1, statistics.hit_count);
+  EXPECT_EQ(1, statistics.miss_count);
+  EXPECT_EQ(0, statistics.bytes_retained);
+}
+
+// Tests that sizes within the same size class share storage while sizes in
+// different classes do not.
+TEST(PooledHostLocalAllocatorTest, SizeClasses) {
+  PooledHostLocalAllocator allocator;
+
+  ASSERT_OK_AND_ASSIGN(auto buffer_0,
+                       allocator.Allocate(kMemoryType, kBufferUsage, 1000));
+  buffer_0.reset();
+  ASSERT_OK_AND_ASSIGN(auto buffer_1,
+                       allocator.Allocate(kMemoryType, kBufferUsage, 1020));
+  EXPECT_EQ(1020, buffer_1->byte_length());
+  EXPECT_EQ(1, allocator.statistics().hit_count);
+  buffer_1.reset();
+
+  ASSERT_OK_AND_ASSIGN(auto buffer_2,
+                       allocator.Allocate(kMemoryType, kBufferUsage, 4000));
+  EXPECT_EQ(1, allocator.statistics().hit_count);
+  EXPECT_EQ(2, allocator.statistics().miss_count);
+}
+
+// Tests that live buffers never share storage.
+TEST(PooledHostLocalAllocatorTest, DistinctLiveBuffers) {
+  PooledHostLocalAllocator allocator;
+  ASSERT_OK_AND_ASSIGN(auto buffer_0,
+                       allocator.Allocate(kMemoryType, kBufferUsage, 128));
+  ASSERT_OK_AND_ASSIGN(auto buffer_1,
+                       allocator.Allocate(kMemoryType, kBufferUsage, 128));
+  EXPECT_NE(GetBufferData(buffer_0.get()), GetBufferData(buffer_1.get()));
+  EXPECT_EQ(0, allocator.statistics().hit_count);
+  EXPECT_EQ(256, allocator.statistics().bytes_in_use);
+}
+
+// Tests that allocations larger than the pooling limit are not retained.
+TEST(PooledHostLocalAllocatorTest, LargeAllocationsBypassPool) {
+  PooledHostLocalAllocator::Options options;
+  options.max_pooled_allocation_size = 1024;
+  PooledHostLocalAllocator allocator(options);
+
+  ASSERT_OK_AND_ASSIGN(auto buffer,
+                       allocator.Allocate(kMemoryType, kBufferUsage, 4096));
+  EXPECT_EQ(4096, allocator.statistics().bytes_in_use);
+  buffer.reset();
+
+  auto statistics = allocator.statistics();
+  EXPECT_EQ(1, statistics.unpooled_count);
+  EXPECT_EQ(0, statistics.miss_count);
+  EXPECT_EQ(0, statistics.bytes_in_use);
+  EXPECT_EQ(0, statistics.bytes_retained);
+}
+
+// Tests that recycled storage is cleared by default.
+TEST(PooledHostLocalAllocatorTest, ZeroFill) {
+  PooledHostLocalAllocator allocator;
+
+  ASSERT_OK_AND_ASSIGN(auto buffer_0,
+                       allocator.Allocate(kMemoryType, kBufferUsage, 64));
+  EXPECT_OK(buffer_0->Fill8(0xFF));
+  buffer_0.reset();
+
+  ASSERT_OK_AND_ASSIGN(auto buffer_1,
+                       allocator.Allocate(kMemoryType, kBufferUsage, 64));
+  EXPECT_EQ(1, allocator.statistics().hit_count);
+  ASSERT_OK_AND_ASSIGN(auto mapping,
+                       buffer_1->MapMemory<uint8_t>(MemoryAccess::kRead));
+  for (uint8_t value : mapping.contents()) {
+    EXPECT_EQ(0, value);
+  }
+}
+
+// Tests that recycled storage of transient allocations is not cleared.
+TEST(PooledHostLocalAllocatorTest, TransientSkipsZeroFill) {
+  PooledHostLocalAllocator allocator;
+
+  ASSERT_OK_AND_ASSIGN(auto buffer_0,
+                       allocator.Allocate(kMemoryType, kBufferUsage, 64));
+  EXPECT_OK(buffer_0->Fill8(0xFF));
+  buffer_0.reset();
+
+  ASSERT_OK_AND_ASSIGN(
+      auto buffer_1,
+      allocator.Allocate(kMemoryType | MemoryType::kTransient, kBufferUsage,
+                         64));
+  EXPECT_EQ(1, allocator.statistics().hit_count);
+  ASSERT_OK_AND_ASSIGN(auto mapping,
+                       buffer_1->MapMemory<uint8_t>(MemoryAccess::kRead));
+#ifndef NDEBUG
+  const uint8_t kExpectedValue = 0xCD;
+#else
+  const uint8_t kExpectedValue = 0xFF;
+#endif  // !NDEBUG
+  for (uint8_t value : mapping.contents()) {
+    EXPECT_EQ(kExpectedValue, value);
+  }
+}
+
+// Tests that the high-water mark tracks the peak bytes in use.
+TEST(PooledHostLocalAllocatorTest, HighWater) {
+  PooledHostLocalAllocator allocator;
+  {
+    ASSERT_OK_AND_ASSIGN(auto buffer_0,
+                         allocator.Allocate(kMemoryType, kBufferUsage, 512));
+    ASSERT_OK_AND_ASSIGN(auto buffer_1,
+                         allocator.Allocate(kMemoryType, kBufferUsage, 512));
+  }
+  ASSERT_OK_AND_ASSIGN(auto buffer_2,
+                       allocator.Allocate(kMemoryType, kBufferUsage, 512));
+
+  auto statistics = allocator.statistics();
+  EXPECT_EQ(512, statistics.bytes_in_use);
+  EXPECT_EQ(1024, statistics.bytes_in_use_high_water);
+  EXPECT_EQ(512, statistics.bytes_retained);
+}
+
+// Tests that storage beyond the retention limit is freed and that Trim frees
+// all retained storage.
+TEST(PooledHostLocalAllocatorTest, RetentionLimitAndTrim) {
+  PooledHostLocalAllocator::Options options;
+  options.max_retained_bytes = 1024;
+  PooledHostLocalAllocator allocator(options);
+  {
+    ASSERT_OK_AND_ASSIGN(auto buffer_0,
+                         allocator.Allocate(kMemoryType, kBufferUsage, 1024));
+    ASSERT_OK_AND_ASSIGN(auto buffer_1,
+                         allocator.Allocate(kMemoryType, kBufferUsage, 1024));
+  }
+  EXPECT_EQ(1024, allocator.statistics().bytes_retained);
+
+  allocator.Trim();
+  EXPECT_EQ(0, allocator.statistics().bytes_retained);
+  ASSERT_OK_AND_ASSIGN(auto buffer_2,
+                       allocator.Allocate(kMemoryType, kBufferUsage, 1024));
+  EXPECT_EQ(0, allocator.statistics().hit_count);
+}
+
+// Tests that buffers may outlive the allocator that created them.
+TEST(PooledHostLocalAllocatorTest, BufferOutlivesAllocator) {
+  ref_ptr<Buffer> buffer;
+  {
+    PooledHostLocalAllocator allocator;
+    ASSERT_OK_AND_ASSIGN(buffer,
+                         allocator.Allocate(kMemoryType, kBufferUsage, 256));
+  }
+  EXPECT_OK(buffer->Fill8(0x12));
+  buffer.reset();
+}
+
+// Tests that wrapped host memory is used in place and never pooled.
+TEST(PooledHostLocalAllocatorTest, WrapsHostMemory) {
+  PooledHostLocalAllocator allocator;
+
+  uint32_t data[4] = {1, 2, 3, 4};
+  ASSERT_OK_AND_ASSIGN(
+      auto buffer, allocator.WrapMutable(kMemoryType, MemoryAccess::kRead,
+                                         kBufferUsage, data, sizeof(data)));
+  EXPECT_EQ(sizeof(data), buffer->byte_length());
+  EXPECT_EQ(data, GetBufferData(buffer.get()));
+  EXPECT_FALSE(buffer->Fill32(0u).ok());
+  buffer.reset();
+  EXPECT_EQ(0, allocator.statistics().bytes_retained);
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
@@ -14,17 +14,52 @@
 
 #include "iree/hal/interpreter/bytecode_cache.h"
 
+#include <cstring>
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "iree/base/file_io.h"
+#include "iree/base/file_mapping.h"
+#include "iree/base/file_path.h"
+#include "iree/base/logging.h"
 #include "iree/base/source_location.h"
 #include "iree/base/status.h"
 #include "iree/base/tracing.h"
 #include "iree/hal/executable_format.h"
-#include "iree/hal/interpreter/bytecode_executable.h"
 
 namespace iree {
 namespace hal {
 
+namespace {
+
+// Returns a 64-bit FNV-1a hash of |data|.
+// The hash must be stable across processes as it names persistent files.
+uint64_t HashExecutableData(absl::Span<const uint8_t> data) {
+  uint64_t hash = 0xCBF29CE484222325ull;
+  for (uint8_t value : data) {
+    hash ^= value;
+    hash *= 0x100000001B3ull;
+  }
+  return hash;
+}
+
+// Returns true if |a| and |b| have identical contents.
+bool IsSameData(absl::Span<const uint8_t> a, absl::Span<const uint8_t> b) {
+  if (a.size() != b.size()) return false;
+  if (a.data() == b.data()) return true;
+  return std::memcmp(a.data(), b.data(), a.size()) == 0;
+}
+
+}  // namespace
+
 BytecodeCache::BytecodeCache(hal::Allocator* allocator)
-    : allocator_(allocator) {}
+    : BytecodeCache(allocator, Options{}) {}
+
+BytecodeCache::BytecodeCache(hal::Allocator* allocator, Options options)
+    : allocator_(allocator), options_(std::move(options)) {}
 
 BytecodeCache::~BytecodeCache() = default;
 
@@ -40,15 +75,113 @@ StatusOr<ref_ptr<Executable>> BytecodeCache::PrepareExecutable(
            << "Unsupported format: " << spec.format;
   }
 
-  // Wrap the data (or copy it).
-  bool allow_aliasing_data =
-      AllBitsSet(mode, ExecutableCachingMode::kAliasProvidedData);
-  ASSIGN_OR_RETURN(
-      auto executable,
-      BytecodeExecutable::Load(allocator_, spec, !allow_aliasing_data));
+  uint64_t hash = HashExecutableData(spec.executable_data);
+  CacheKey key{spec.format, spec.executable_data.size(), hash};
+  {
+    absl::MutexLock lock(&mutex_);
+    auto it = executables_.find(key);
+    if (it != executables_.end() &&
+        IsSameData(it->second.executable->executable_data(),
+                   spec.executable_data)) {
+      it->second.last_use = ++use_count_;
+      return add_ref(it->second.executable);
+    }
+  }
+
+  // Load outside of the lock so that unrelated executables can be prepared
+  // concurrently.
+  ASSIGN_OR_RETURN(auto executable, LoadExecutable(mode, spec, hash));
 
+  absl::MutexLock lock(&mutex_);
+  auto it = executables_.find(key);
+  if (it == executables_.end()) {
+    executables_.emplace(key, CacheEntry{add_ref(executable), ++use_count_});
+    EvictExecutables();
+  } else if (IsSameData(it->second.executable->executable_data(),
+                        spec.executable_data)) {
+    // Another thread prepared the same executable while we were loading; use
+    // theirs so that all callers share one instance.
+    it->second.last_use = ++use_count_;
+    return add_ref(it->second.executable);
+  }
+  // On a hash collision the first executable keeps the cache entry and this
+  // one is returned uncached.
   return executable;
 }
 
+void BytecodeCache::EvictExecutables() {
+  // Programs only use a handful of executables so a scan on insertion is
+  // cheaper than maintaining a recency list on every hit.
+  while (executables_.size() > options_.max_retained_executables) {
+    auto oldest_it = executables_.begin();
+    for (auto it = executables_.begin(); it != executables_.end(); ++it) {
+      if (it->second.last_use < oldest_it->second.last_use) oldest_it = it;
+    }
+    executables_.erase(oldest_it);
+  }
+}
+
+StatusOr<ref_ptr<BytecodeExecutable>> BytecodeCache::LoadExecutable(
+    ExecutableCachingModeBitfield mode, const ExecutableSpec& spec,
+    uint64_t hash) {
+  if (!options_.persistent_cache_path.empty() &&
+      AllBitsSet(mode, ExecutableCachingMode::kAllowPersistentCaching)) {
+    auto executable_or = LoadPersistentExecutable(spec, hash);
+    if (executable_or.ok()) {
+      return std::move(executable_or);
+    }
+    LOG(WARNING) << "Persistent executable cache unavailable; loading from "
+                    "provided data: "
+                 << executable_or.status();
+  }
+
+  // Cached executables are handed to every caller preparing the same data and
+  // may outlive the caller that provided it, so the data is always copied even
+  // when kAliasProvidedData is set.
+  return BytecodeExecutable::Load(allocator_, spec,
+                                  /*allow_aliasing_data=*/false);
+}
+
+StatusOr<ref_ptr<BytecodeExecutable>> BytecodeCache::LoadPersistentExecutable(
+    const ExecutableSpec& spec, uint64_t hash) {
+  IREE_TRACE_SCOPE0("BytecodeCache::LoadPersistentExecutable");
+
+  std::string path = file_path::JoinPaths(
+      options_.persistent_cache_path,
+      absl::StrCat(absl::Hex(spec.format, absl::kZeroPad8), "-",
+                   absl::Hex(hash, absl::kZeroPad16), ".ireebc"));
+  if (!file_io::FileExists(path).ok()) {
+    // Write to a unique temporary file and move it into place so that other
+    // processes never observe a partially written file.
+    std::string temp_path =
+        absl::StrCat(path, ".", absl::ToUnixNanos(absl::Now()), ".",
+                     reinterpret_cast<uintptr_t>(this), ".tmp");
+    RETURN_IF_ERROR(file_io::SetFileContents(
+        temp_path,
+        absl::string_view(
+            reinterpret_cast<const char*>(spec.executable_data.data()),
+            spec.executable_data.size())));
+    auto move_status = file_io::MoveFile(temp_path, path);
+    if (!move_status.ok()) {
+      file_io::DeleteFile(temp_path).IgnoreError();
+      // Another process may have stored the same executable first.
+      if (!file_io::FileExists(path).ok()) {
+        return move_status;
+      }
+    }
+  }
+
+  // Hash collisions or corrupted files must never be loaded in place of the
+  // requested executable.
+  ASSIGN_OR_RETURN(auto file_mapping, FileMapping::OpenRead(path));
+  if (!IsSameData(file_mapping->data(), spec.executable_data)) {
+    return DataLossErrorBuilder(IREE_LOC)
+           << "Persistent cache entry " << path
+           << " does not match the executable data";
+  }
+  return BytecodeExecutable::LoadMapped(allocator_, spec.format,
+                                        std::move(file_mapping));
+}
+
 }  // namespace hal
 }  // namespace iree
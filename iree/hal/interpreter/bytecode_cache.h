@@ -15,16 +15,53 @@
 #ifndef IREE_HAL_INTERPRETER_BYTECODE_CACHE_H_
 #define IREE_HAL_INTERPRETER_BYTECODE_CACHE_H_
 
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <tuple>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
 #include "iree/hal/allocator.h"
 #include "iree/hal/executable.h"
 #include "iree/hal/executable_cache.h"
+#include "iree/hal/interpreter/bytecode_executable.h"
 
 namespace iree {
 namespace hal {
 
+// Prepares bytecode executables for the interpreter.
+//
+// Executables are content-addressed by their format and a hash of their data.
+// Preparing an executable that was already prepared returns the same instance
+// without reloading it, no matter which VM context it came from. Up to
+// Options::max_retained_executables prepared executables are retained by the
+// cache and the least recently prepared are released beyond that; callers may
+// keep using executables after the cache has released them. As executables are
+// shared between callers ExecutableCachingMode::kAliasProvidedData is ignored
+// and the provided data is always copied (or persistently mapped, below).
+//
+// If Options::persistent_cache_path is set, executables prepared with
+// ExecutableCachingMode::kAllowPersistentCaching are stored in that directory
+// and loaded from read-only file mappings of the stored files. Processes that
+// prepare the same executables (including the same program after a restart)
+// then share the data through the page cache instead of each holding a copy.
+//
+// Thread-safe.
 class BytecodeCache final : public ExecutableCache {
  public:
+  struct Options {
+    // Directory used to store prepared executables across processes.
+    // Persistent caching is disabled when empty.
+    std::string persistent_cache_path;
+
+    // Maximum number of prepared executables retained in memory.
+    size_t max_retained_executables = 64;
+  };
+
   explicit BytecodeCache(hal::Allocator* allocator);
+  BytecodeCache(hal::Allocator* allocator, Options options);
   ~BytecodeCache() override;
 
   bool CanPrepareFormat(ExecutableFormat format) const override;
@@ -33,7 +70,34 @@ class BytecodeCache final : public ExecutableCache {
       ExecutableCachingModeBitfield mode, const ExecutableSpec& spec) override;
 
  private:
+  // Format, data length, and data hash of an executable.
+  using CacheKey = std::tuple<ExecutableFormat, size_t, uint64_t>;
+
+  struct CacheEntry {
+    ref_ptr<BytecodeExecutable> executable;
+    // Value of use_count_ when the entry was last prepared.
+    uint64_t last_use = 0;
+  };
+
+  // Releases the least recently used entries beyond the retention limit.
+  void EvictExecutables() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  // Loads a new executable for |spec| that is not yet in the cache.
+  StatusOr<ref_ptr<BytecodeExecutable>> LoadExecutable(
+      ExecutableCachingModeBitfield mode, const ExecutableSpec& spec,
+      uint64_t hash);
+
+  // Loads an executable from the persistent cache, storing it first if needed.
+  StatusOr<ref_ptr<BytecodeExecutable>> LoadPersistentExecutable(
+      const ExecutableSpec& spec, uint64_t hash);
+
   hal::Allocator* allocator_;
+  Options options_;
+
+  absl::Mutex mutex_;
+  absl::flat_hash_map<CacheKey, CacheEntry> executables_
+      ABSL_GUARDED_BY(mutex_);
+  uint64_t use_count_ ABSL_GUARDED_BY(mutex_) = 0;
 };
 
 }  // namespace hal
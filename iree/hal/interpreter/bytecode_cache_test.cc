@@ -0,0 +1,217 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/hal/interpreter/bytecode_cache.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "flatbuffers/flatbuffers.h"
+#include "iree/base/file_io.h"
+#include "iree/base/file_path.h"
+#include "iree/base/status.h"
+#include "iree/base/status_matchers.h"
+#include "iree/hal/executable_format.h"
+#include "iree/hal/host/host_local_allocator.h"
+#include "iree/schemas/interpreter_module_def_generated.h"
+#include "iree/testing/gtest.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+// Returns the data of an interpreter module named |name| with no functions.
+std::vector<uint8_t> MakeModuleData(absl::string_view name) {
+  ::flatbuffers::FlatBufferBuilder fbb;
+  auto functions =
+      fbb.CreateVector(std::vector<::flatbuffers::Offset<FunctionDef>>{});
+  auto function_table = CreateFunctionTableDef(fbb, functions);
+  auto module_def =
+      CreateModuleDef(fbb, fbb.CreateString(name.data(), name.size()),
+                      function_table);
+  FinishModuleDefBuffer(fbb, module_def);
+  return {fbb.GetBufferPointer(), fbb.GetBufferPointer() + fbb.GetSize()};
+}
+
+ExecutableSpec MakeSpec(const std::vector<uint8_t>& data) {
+  ExecutableSpec spec;
+  spec.format = kExecutableFormatIreeBytecode;
+  spec.executable_data = absl::MakeConstSpan(data);
+  return spec;
+}
+
+// Returns the path of the persistent cache entry for |data|.
+// Entry names are stable across processes so they can be computed here.
+std::string PersistentPath(const std::string& cache_path,
+                           absl::Span<const uint8_t> data) {
+  uint64_t hash = 0xCBF29CE484222325ull;
+  for (uint8_t value : data) {
+    hash ^= value;
+    hash *= 0x100000001B3ull;
+  }
+  return file_path::JoinPaths(
+      cache_path,
+      absl::StrCat(absl::Hex(kExecutableFormatIreeBytecode, absl::kZeroPad8),
+                   "-", absl::Hex(hash, absl::kZeroPad16), ".ireebc"));
+}
+
+absl::Span<const uint8_t> ExecutableData(
+    const ref_ptr<Executable>& executable) {
+  return static_cast<BytecodeExecutable*>(executable.get())->executable_data();
+}
+
+class BytecodeCacheTest : public ::testing::Test {
+ protected:
+  HostLocalAllocator allocator_;
+};
+
+TEST_F(BytecodeCacheTest, DeduplicatesByContent) {
+  auto data = MakeModuleData("a");
+  auto same_data = data;
+  auto other_data = MakeModuleData("b");
+  BytecodeCache cache(&allocator_);
+  auto prepare = [&](const std::vector<uint8_t>& module_data) {
+    return cache.PrepareExecutable(ExecutableCachingMode::kDefault,
+                                   MakeSpec(module_data));
+  };
+
+  ASSERT_OK_AND_ASSIGN(auto executable, prepare(data));
+  ASSERT_OK_AND_ASSIGN(auto same_executable, prepare(same_data));
+  ASSERT_OK_AND_ASSIGN(auto other_executable, prepare(other_data));
+  EXPECT_EQ(executable.get(), same_executable.get());
+  EXPECT_NE(executable.get(), other_executable.get());
+
+  // Without kAliasProvidedData the cached executable owns a copy of the data.
+  EXPECT_NE(data.data(), ExecutableData(executable).data());
+  EXPECT_EQ(data, std::vector<uint8_t>(ExecutableData(executable).begin(),
+                                       ExecutableData(executable).end()));
+}
+
+TEST_F(BytecodeCacheTest, CopiesAliasedData) {
+  // Executables are shared with later callers so they must not alias data that
+  // only the first caller keeps alive.
+  auto data = MakeModuleData("a");
+  auto same_data = data;
+  BytecodeCache cache(&allocator_);
+  ASSERT_OK_AND_ASSIGN(
+      auto executable,
+      cache.PrepareExecutable(ExecutableCachingMode::kAliasProvidedData,
+                              MakeSpec(data)));
+  EXPECT_NE(data.data(), ExecutableData(executable).data());
+  std::fill(data.begin(), data.end(), 0);
+  data.clear();
+  data.shrink_to_fit();
+
+  ASSERT_OK_AND_ASSIGN(
+      auto same_executable,
+      cache.PrepareExecutable(ExecutableCachingMode::kAliasProvidedData,
+                              MakeSpec(same_data)));
+  EXPECT_EQ(executable.get(), same_executable.get());
+  EXPECT_EQ(same_data,
+            std::vector<uint8_t>(ExecutableData(same_executable).begin(),
+                                 ExecutableData(same_executable).end()));
+}
+
+TEST_F(BytecodeCacheTest, EvictsLeastRecentlyUsed) {
+  auto data_a = MakeModuleData("a");
+  auto data_b = MakeModuleData("b");
+  auto data_c = MakeModuleData("c");
+  BytecodeCache::Options options;
+  options.max_retained_executables = 2;
+  BytecodeCache cache(&allocator_, options);
+  auto prepare = [&](const std::vector<uint8_t>& module_data) {
+    return cache.PrepareExecutable(ExecutableCachingMode::kDefault,
+                                   MakeSpec(module_data));
+  };
+
+  ASSERT_OK_AND_ASSIGN(auto executable_a, prepare(data_a));
+  ASSERT_OK_AND_ASSIGN(auto executable_b, prepare(data_b));
+  ASSERT_OK_AND_ASSIGN(auto reused_a, prepare(data_a));
+  EXPECT_EQ(executable_a.get(), reused_a.get());
+
+  // A is more recently used than B so B is released to make room for C.
+  ASSERT_OK_AND_ASSIGN(auto executable_c, prepare(data_c));
+  ASSERT_OK_AND_ASSIGN(reused_a, prepare(data_a));
+  EXPECT_EQ(executable_a.get(), reused_a.get());
+  ASSERT_OK_AND_ASSIGN(auto reused_c, prepare(data_c));
+  EXPECT_EQ(executable_c.get(), reused_c.get());
+  ASSERT_OK_AND_ASSIGN(auto reloaded_b, prepare(data_b));
+  EXPECT_NE(executable_b.get(), reloaded_b.get());
+
+  // Released executables remain valid for their existing users.
+  EXPECT_EQ(data_b.size(), ExecutableData(executable_b).size());
+}
+
+TEST_F(BytecodeCacheTest, PersistsAcrossCaches) {
+  auto data = MakeModuleData("persists_across_caches");
+  BytecodeCache::Options options;
+  options.persistent_cache_path = ::testing::TempDir();
+  std::string path = PersistentPath(options.persistent_cache_path, data);
+  file_io::DeleteFile(path).IgnoreError();
+
+  {
+    BytecodeCache cache(&allocator_, options);
+    ASSERT_OK(cache
+                  .PrepareExecutable(
+                      ExecutableCachingMode::kAllowPersistentCaching,
+                      MakeSpec(data))
+                  .status());
+  }
+  ASSERT_OK(file_io::FileExists(path));
+
+  // A new cache loads the stored file instead of aliasing the provided data.
+  BytecodeCache cache(&allocator_, options);
+  ASSERT_OK_AND_ASSIGN(
+      auto executable,
+      cache.PrepareExecutable(ExecutableCachingMode::kAllowPersistentCaching |
+                                  ExecutableCachingMode::kAliasProvidedData,
+                              MakeSpec(data)));
+  EXPECT_NE(data.data(), ExecutableData(executable).data());
+  EXPECT_EQ(data, std::vector<uint8_t>(ExecutableData(executable).begin(),
+                                       ExecutableData(executable).end()));
+
+  executable.reset();
+  EXPECT_OK(file_io::DeleteFile(path));
+}
+
+TEST_F(BytecodeCacheTest, IgnoresMismatchedPersistentEntry) {
+  // Store different data under the name of |data|, as happens on a hash
+  // collision or when the file is corrupted.
+  auto data = MakeModuleData("mismatched_persistent_entry");
+  auto other_data = MakeModuleData("mismatched_persistent_entrz");
+  BytecodeCache::Options options;
+  options.persistent_cache_path = ::testing::TempDir();
+  std::string path = PersistentPath(options.persistent_cache_path, data);
+  ASSERT_OK(file_io::SetFileContents(
+      path, std::string(other_data.begin(), other_data.end())));
+
+  // The stored file must not be used and the provided data is loaded instead.
+  BytecodeCache cache(&allocator_, options);
+  ASSERT_OK_AND_ASSIGN(
+      auto executable,
+      cache.PrepareExecutable(ExecutableCachingMode::kAllowPersistentCaching |
+                                  ExecutableCachingMode::kAliasProvidedData,
+                              MakeSpec(data)));
+  EXPECT_EQ(data, std::vector<uint8_t>(ExecutableData(executable).begin(),
+                                       ExecutableData(executable).end()));
+
+  EXPECT_OK(file_io::DeleteFile(path));
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
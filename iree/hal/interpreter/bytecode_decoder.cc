@@ -0,0 +1,332 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/hal/interpreter/bytecode_decoder.h"
+
+#include <cstring>
+#include <utility>
+
+#include "absl/base/macros.h"
+#include "iree/base/status.h"
+#include "iree/base/tracing.h"
+#include "iree/hal/interpreter/bytecode_tables_interpreter.h"
+
+namespace iree {
+namespace hal {
+
+namespace {
+
+// Opcodes that are defined (not reserved) in the opcode list.
+static const bool kDefinedOpcodes[256] = {
+#define DECLARE_DEFINED(ordinal, name, ...) true,
+#define DECLARE_RESERVED(ordinal, name, ...) false,
+    IREE_INTERPRETER_OPCODE_LIST(DECLARE_DEFINED, DECLARE_RESERVED)
+#undef DECLARE_DEFINED
+#undef DECLARE_RESERVED
+};
+
+bool IsTerminator(InterpreterOpcode opcode) {
+  return opcode == InterpreterOpcode::kReturn ||
+         opcode == InterpreterOpcode::kBranch ||
+         opcode == InterpreterOpcode::kCondBranch;
+}
+
+class FunctionDecoder {
+ public:
+  FunctionDecoder(absl::Span<const uint8_t> bytecode, int32_t local_count,
+                  absl::Span<const bool> callable_functions)
+      : bytecode_(bytecode),
+        local_count_(local_count),
+        callable_functions_(callable_functions) {}
+
+  StatusOr<DecodedFunction> Decode() {
+    if (local_count_ < 0) {
+      return InvalidArgumentErrorBuilder(IREE_LOC)
+             << "Invalid local count " << local_count_;
+    } else if (bytecode_.empty()) {
+      return InvalidArgumentErrorBuilder(IREE_LOC) << "Function has no body";
+    }
+    function_.local_count = local_count_;
+
+    // Word offsets of each instruction indexed by bytecode offset, used to
+    // translate branch targets once all instructions are decoded.
+    std::vector<int32_t> instruction_offsets(bytecode_.size(), -1);
+    auto last_opcode = InterpreterOpcode::kReturn;
+    while (offset_ < bytecode_.size()) {
+      instruction_offsets[offset_] = function_.code.size();
+      ASSIGN_OR_RETURN(last_opcode, DecodeInstruction());
+    }
+    if (!IsTerminator(last_opcode)) {
+      return InvalidArgumentErrorBuilder(IREE_LOC)
+             << "Function must end with a terminator";
+    }
+
+    for (const auto& block_offset : block_offsets_) {
+      uint32_t target = function_.code[block_offset];
+      if (target >= bytecode_.size() || instruction_offsets[target] == -1) {
+        return OutOfRangeErrorBuilder(IREE_LOC)
+               << "Branch target " << target
+               << " is not the start of an instruction";
+      }
+      function_.code[block_offset] = instruction_offsets[target];
+    }
+
+    return std::move(function_);
+  }
+
+ private:
+  template <typename T>
+  StatusOr<T> ReadValue() {
+    if (bytecode_.size() - offset_ < sizeof(T)) {
+      return OutOfRangeErrorBuilder(IREE_LOC)
+             << "Bytecode underflow reading " << sizeof(T) << "b at offset "
+             << offset_;
+    }
+    T value;
+    std::memcpy(&value, bytecode_.data() + offset_, sizeof(T));
+    offset_ += sizeof(T);
+    return value;
+  }
+
+  void Emit(uint32_t value) { function_.code.push_back(value); }
+
+  Status DecodeLocals(int count) {
+    for (int i = 0; i < count; ++i) {
+      ASSIGN_OR_RETURN(uint16_t local, ReadValue<uint16_t>());
+      if (local >= local_count_) {
+        return OutOfRangeErrorBuilder(IREE_LOC)
+               << "Out of bounds local access " << local << " of "
+               << local_count_;
+      }
+      Emit(local);
+    }
+    return OkStatus();
+  }
+
+  // Decodes a count followed by |stride| locals per counted item.
+  Status DecodeLocalList(int stride) {
+    ASSIGN_OR_RETURN(uint8_t count, ReadValue<uint8_t>());
+    Emit(count);
+    return DecodeLocals(count * stride);
+  }
+
+  StatusOr<absl::Span<const int32_t>> DecodeIndexList() {
+    ASSIGN_OR_RETURN(uint8_t count, ReadValue<uint8_t>());
+    Emit(count);
+    size_t list_offset = function_.code.size();
+    for (int i = 0; i < count; ++i) {
+      ASSIGN_OR_RETURN(int32_t value, ReadValue<int32_t>());
+      Emit(static_cast<uint32_t>(value));
+    }
+    return absl::MakeConstSpan(
+        reinterpret_cast<const int32_t*>(function_.code.data()) + list_offset,
+        count);
+  }
+
+  StatusOr<Type> DecodeType() {
+    ASSIGN_OR_RETURN(uint8_t type_index, ReadValue<uint8_t>());
+    ASSIGN_OR_RETURN(auto type, Type::FromTypeIndex(type_index));
+    Emit(type_index);
+    return type;
+  }
+
+  Status DecodeConstant() {
+    DecodedConstant constant;
+    ASSIGN_OR_RETURN(uint8_t type_index, ReadValue<uint8_t>());
+    ASSIGN_OR_RETURN(constant.type, Type::FromTypeIndex(type_index));
+    size_t element_size = constant.type.element_size();
+    if (!element_size) {
+      return InvalidArgumentErrorBuilder(IREE_LOC)
+             << "Constants of type " << constant.type << " are not supported";
+    }
+
+    ASSIGN_OR_RETURN(uint8_t rank, ReadValue<uint8_t>());
+    if (rank > kMaxRank) {
+      return UnimplementedErrorBuilder(IREE_LOC)
+             << "Shapes limited to rank " << kMaxRank << " right now";
+    }
+    for (int i = 0; i < rank; ++i) {
+      ASSIGN_OR_RETURN(int32_t dim, ReadValue<int32_t>());
+      if (dim < 0) {
+        return InvalidArgumentErrorBuilder(IREE_LOC)
+               << "Constants must have a static shape";
+      }
+      constant.shape.push_back(dim);
+    }
+
+    ASSIGN_OR_RETURN(constant.encoding, ReadValue<ConstantEncoding>());
+    size_t data_length = 0;
+    switch (constant.encoding) {
+      case ConstantEncoding::kDense:
+        data_length = element_size * constant.shape.element_count();
+        break;
+      case ConstantEncoding::kSplat:
+        data_length = element_size;
+        break;
+      default:
+        return UnimplementedErrorBuilder(IREE_LOC)
+               << "Unimplemented constant encoding "
+               << static_cast<int>(constant.encoding);
+    }
+    if (bytecode_.size() - offset_ < data_length) {
+      return OutOfRangeErrorBuilder(IREE_LOC) << "Constant data out of bounds";
+    }
+    constant.data = bytecode_.subspan(offset_, data_length);
+    offset_ += data_length;
+
+    Emit(function_.constants.size());
+    function_.constants.push_back(std::move(constant));
+    return OkStatus();
+  }
+
+  // Shape pieces are an index list of dims followed by one local for each
+  // dynamic (-1) dim.
+  Status DecodeShapePieces() {
+    ASSIGN_OR_RETURN(auto shape_dims, DecodeIndexList());
+    if (shape_dims.size() >= kMaxRank) {
+      return UnimplementedErrorBuilder(IREE_LOC)
+             << "Shapes limited to rank " << kMaxRank << " right now";
+    }
+    int expected_dynamic_dims = 0;
+    for (int32_t dim : shape_dims) {
+      if (dim == -1) ++expected_dynamic_dims;
+    }
+    ASSIGN_OR_RETURN(uint8_t dynamic_dims, ReadValue<uint8_t>());
+    if (dynamic_dims != expected_dynamic_dims) {
+      return InvalidArgumentErrorBuilder(IREE_LOC)
+             << "Expected " << expected_dynamic_dims
+             << " dynamic dims but only " << static_cast<int>(dynamic_dims)
+             << " provided";
+    }
+    Emit(dynamic_dims);
+    return DecodeLocals(dynamic_dims);
+  }
+
+  StatusOr<InterpreterOpcode> DecodeInstruction() {
+    size_t instruction_offset = offset_;
+    ASSIGN_OR_RETURN(uint8_t opcode_value, ReadValue<uint8_t>());
+    if (!kDefinedOpcodes[opcode_value]) {
+      return UnimplementedErrorBuilder(IREE_LOC)
+             << "Unknown opcode " << static_cast<int>(opcode_value)
+             << " at offset " << instruction_offset;
+    }
+    auto opcode = static_cast<InterpreterOpcode>(opcode_value);
+    Emit(opcode_value);
+
+    const auto& opcode_info =
+        GetOpcodeInfo(interpreter_opcode_table(), opcode);
+    const auto* operands = opcode_info.operands;
+    for (int i = 0; i < ABSL_ARRAYSIZE(opcode_info.operands_value); ++i) {
+      // alloc_heap encodes its shape as pieces (an index list followed by the
+      // dynamic dim locals).
+      if (opcode == InterpreterOpcode::kAllocHeap &&
+          operands[i] == OperandEncoding::kIndexList) {
+        RETURN_IF_ERROR(DecodeShapePieces());
+        ++i;
+        continue;
+      }
+      switch (operands[i]) {
+        case OperandEncoding::kNone:
+          return opcode;
+        case OperandEncoding::kInputSlot:
+        case OperandEncoding::kOutputSlot:
+        case OperandEncoding::kResultSlot:
+          RETURN_IF_ERROR(DecodeLocals(1));
+          break;
+        case OperandEncoding::kVariadicInputSlots:
+        case OperandEncoding::kVariadicOutputSlots:
+        case OperandEncoding::kVariadicResultSlots:
+          RETURN_IF_ERROR(DecodeLocalList(1));
+          break;
+        case OperandEncoding::kVariadicTransferSlots:
+          RETURN_IF_ERROR(DecodeLocalList(2));
+          break;
+        case OperandEncoding::kConstant:
+          RETURN_IF_ERROR(DecodeConstant());
+          break;
+        case OperandEncoding::kFunctionOrdinal: {
+          ASSIGN_OR_RETURN(uint32_t ordinal, ReadValue<uint32_t>());
+          if (ordinal >= callable_functions_.size() ||
+              !callable_functions_[ordinal]) {
+            return InvalidArgumentErrorBuilder(IREE_LOC)
+                   << "Function ordinal " << ordinal << " is not callable";
+          }
+          Emit(ordinal);
+          break;
+        }
+        case OperandEncoding::kBlockOffset: {
+          ASSIGN_OR_RETURN(uint32_t target, ReadValue<uint32_t>());
+          block_offsets_.push_back(function_.code.size());
+          Emit(target);
+          break;
+        }
+        case OperandEncoding::kTypeIndex:
+          RETURN_IF_ERROR(DecodeType().status());
+          break;
+        case OperandEncoding::kIndex: {
+          ASSIGN_OR_RETURN(int32_t value, ReadValue<int32_t>());
+          Emit(static_cast<uint32_t>(value));
+          break;
+        }
+        case OperandEncoding::kIndexList:
+          RETURN_IF_ERROR(DecodeIndexList().status());
+          break;
+        case OperandEncoding::kCmpIPredicate: {
+          ASSIGN_OR_RETURN(uint8_t predicate, ReadValue<uint8_t>());
+          if (predicate > static_cast<uint8_t>(CmpIPredicate::kUge)) {
+            return InvalidArgumentErrorBuilder(IREE_LOC)
+                   << "Invalid cmp_i predicate " << static_cast<int>(predicate);
+          }
+          Emit(predicate);
+          break;
+        }
+        case OperandEncoding::kCmpFPredicate: {
+          ASSIGN_OR_RETURN(uint8_t predicate, ReadValue<uint8_t>());
+          if (predicate > static_cast<uint8_t>(CmpFPredicate::kTrue)) {
+            return InvalidArgumentErrorBuilder(IREE_LOC)
+                   << "Invalid cmp_f predicate " << static_cast<int>(predicate);
+          }
+          Emit(predicate);
+          break;
+        }
+        default:
+          return UnimplementedErrorBuilder(IREE_LOC)
+                 << "Operand encoding '" << static_cast<char>(operands[i])
+                 << "' of " << opcode_info.mnemonic
+                 << " is not supported by the interpreter";
+      }
+    }
+    return opcode;
+  }
+
+  absl::Span<const uint8_t> bytecode_;
+  int32_t local_count_;
+  absl::Span<const bool> callable_functions_;
+  size_t offset_ = 0;
+  DecodedFunction function_;
+  // Words in the code holding bytecode branch targets pending translation.
+  std::vector<size_t> block_offsets_;
+};
+
+}  // namespace
+
+StatusOr<DecodedFunction> DecodeFunction(
+    absl::Span<const uint8_t> bytecode, int32_t local_count,
+    absl::Span<const bool> callable_functions) {
+  IREE_TRACE_SCOPE0("DecodeFunction");
+  return FunctionDecoder(bytecode, local_count, callable_functions).Decode();
+}
+
+}  // namespace hal
+}  // namespace iree
@@ -0,0 +1,69 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef IREE_HAL_INTERPRETER_BYTECODE_DECODER_H_
+#define IREE_HAL_INTERPRETER_BYTECODE_DECODER_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "iree/base/shape.h"
+#include "iree/base/status.h"
+#include "iree/hal/interpreter/type.h"
+#include "iree/schemas/bytecode/interpreter_bytecode_v0.h"
+
+namespace iree {
+namespace hal {
+
+// A constant parsed from the bytecode of a function.
+struct DecodedConstant {
+  Type type = Type::FromBuiltin(BuiltinType::kI8);
+  Shape shape;
+  ConstantEncoding encoding = ConstantEncoding::kDense;
+  // Dense contents or the single splat element, aliasing the bytecode.
+  absl::Span<const uint8_t> data;
+};
+
+// Function bytecode translated into a form that can be executed without any
+// further validation.
+//
+// Each instruction is stored as its opcode followed by its operands with one
+// uint32_t word per value, in the order of the opcode operand encoding:
+//   s/o/r: local index, validated to be less than |local_count|.
+//   S/O/R: count followed by that many local indices.
+//   T:     count followed by that many (src, dst) local index pairs.
+//   b:     word offset of the target instruction within |code|.
+//   f:     internal function ordinal, validated to have bytecode.
+//   t:     type index, validated to be a supported type.
+//   c:     index into |constants|.
+//   i/p/P: value.
+//   I:     count followed by that many int32_t values.
+struct DecodedFunction {
+  int32_t local_count = 0;
+  std::vector<uint32_t> code;
+  std::vector<DecodedConstant> constants;
+};
+
+// Decodes and validates the |bytecode| of a function that has |local_count|
+// locals. |callable_functions| has one entry per internal function ordinal
+// of the module that is true if the function has bytecode and may be called.
+StatusOr<DecodedFunction> DecodeFunction(
+    absl::Span<const uint8_t> bytecode, int32_t local_count,
+    absl::Span<const bool> callable_functions);
+
+}  // namespace hal
+}  // namespace iree
+
+#endif  // IREE_HAL_INTERPRETER_BYTECODE_DECODER_H_
@@ -0,0 +1,211 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/hal/interpreter/bytecode_decoder.h"
+
+#include <cstring>
+#include <vector>
+
+#include "iree/base/status.h"
+#include "iree/base/status_matchers.h"
+#include "iree/testing/gtest.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+using ::testing::ElementsAre;
+
+// Assembles function bytecode as written by the compiler.
+class BytecodeBuilder {
+ public:
+  BytecodeBuilder& Opcode(InterpreterOpcode opcode) {
+    return Uint8(static_cast<uint8_t>(opcode));
+  }
+  BytecodeBuilder& Local(uint16_t local) { return Append(local); }
+  BytecodeBuilder& Uint8(uint8_t value) { return Append(value); }
+  BytecodeBuilder& Int32(int32_t value) { return Append(value); }
+  BytecodeBuilder& Uint32(uint32_t value) { return Append(value); }
+  BytecodeBuilder& Float(float value) { return Append(value); }
+
+  size_t offset() const { return bytes_.size(); }
+  absl::Span<const uint8_t> bytes() const { return bytes_; }
+
+ private:
+  template <typename T>
+  BytecodeBuilder& Append(T value) {
+    size_t offset = bytes_.size();
+    bytes_.resize(offset + sizeof(T));
+    std::memcpy(bytes_.data() + offset, &value, sizeof(T));
+    return *this;
+  }
+
+  std::vector<uint8_t> bytes_;
+};
+
+uint32_t Op(InterpreterOpcode opcode) { return static_cast<uint32_t>(opcode); }
+
+const bool kSingleFunction[] = {true};
+
+TEST(BytecodeDecoderTest, WidensOperands) {
+  BytecodeBuilder builder;
+  builder.Opcode(InterpreterOpcode::kAddI).Local(0).Local(1).Local(2);
+  builder.Opcode(InterpreterOpcode::kReturn).Uint8(1).Local(2);
+  ASSERT_OK_AND_ASSIGN(auto function,
+                       DecodeFunction(builder.bytes(), 3, kSingleFunction));
+  EXPECT_EQ(3, function.local_count);
+  EXPECT_THAT(function.code, ElementsAre(Op(InterpreterOpcode::kAddI), 0, 1, 2,
+                                         Op(InterpreterOpcode::kReturn), 1, 2));
+}
+
+TEST(BytecodeDecoderTest, TranslatesBranchTargets) {
+  BytecodeBuilder builder;
+  builder.Opcode(InterpreterOpcode::kBranch).Uint32(0).Uint8(1);
+  builder.Local(0).Local(1);
+  uint32_t return_offset = builder.offset();
+  builder.Opcode(InterpreterOpcode::kReturn).Uint8(0);
+  std::vector<uint8_t> bytecode(builder.bytes().begin(), builder.bytes().end());
+  std::memcpy(bytecode.data() + 1, &return_offset, sizeof(return_offset));
+  ASSERT_OK_AND_ASSIGN(auto function,
+                       DecodeFunction(bytecode, 2, kSingleFunction));
+  EXPECT_THAT(function.code, ElementsAre(Op(InterpreterOpcode::kBranch), 5, 1,
+                                         0, 1, Op(InterpreterOpcode::kReturn),
+                                         0));
+}
+
+TEST(BytecodeDecoderTest, ReadsDimAxis) {
+  // The compiler writes the axis before the locals.
+  BytecodeBuilder builder;
+  builder.Opcode(InterpreterOpcode::kDim).Int32(-1).Local(0).Local(1);
+  builder.Opcode(InterpreterOpcode::kReturn).Uint8(1).Local(1);
+  ASSERT_OK_AND_ASSIGN(auto function,
+                       DecodeFunction(builder.bytes(), 2, kSingleFunction));
+  EXPECT_THAT(function.code, ElementsAre(Op(InterpreterOpcode::kDim),
+                                         static_cast<uint32_t>(-1), 0, 1,
+                                         Op(InterpreterOpcode::kReturn), 1, 1));
+}
+
+TEST(BytecodeDecoderTest, RejectsBranchIntoInstruction) {
+  BytecodeBuilder builder;
+  builder.Opcode(InterpreterOpcode::kBranch).Uint32(2).Uint8(0);
+  builder.Opcode(InterpreterOpcode::kReturn).Uint8(0);
+  EXPECT_FALSE(DecodeFunction(builder.bytes(), 0, kSingleFunction).ok());
+}
+
+TEST(BytecodeDecoderTest, RejectsOutOfRangeLocal) {
+  BytecodeBuilder builder;
+  builder.Opcode(InterpreterOpcode::kAssign).Local(0).Local(2);
+  builder.Opcode(InterpreterOpcode::kReturn).Uint8(0);
+  EXPECT_FALSE(DecodeFunction(builder.bytes(), 2, kSingleFunction).ok());
+}
+
+TEST(BytecodeDecoderTest, RejectsTruncatedInstruction) {
+  BytecodeBuilder builder;
+  builder.Opcode(InterpreterOpcode::kReturn).Uint8(2).Local(0);
+  EXPECT_FALSE(DecodeFunction(builder.bytes(), 1, kSingleFunction).ok());
+}
+
+TEST(BytecodeDecoderTest, RejectsReservedOpcode) {
+  BytecodeBuilder builder;
+  builder.Uint8(0x02);
+  builder.Opcode(InterpreterOpcode::kReturn).Uint8(0);
+  EXPECT_FALSE(DecodeFunction(builder.bytes(), 0, kSingleFunction).ok());
+}
+
+TEST(BytecodeDecoderTest, RequiresTerminator) {
+  BytecodeBuilder builder;
+  builder.Opcode(InterpreterOpcode::kAssign).Local(0).Local(1);
+  EXPECT_FALSE(DecodeFunction(builder.bytes(), 2, kSingleFunction).ok());
+  EXPECT_FALSE(DecodeFunction({}, 0, kSingleFunction).ok());
+}
+
+TEST(BytecodeDecoderTest, ParsesConstants) {
+  BytecodeBuilder builder;
+  builder.Opcode(InterpreterOpcode::kConstant);
+  builder.Uint8(static_cast<uint8_t>(BuiltinType::kF32));
+  builder.Uint8(2).Int32(2).Int32(3);
+  builder.Uint8(static_cast<uint8_t>(ConstantEncoding::kSplat)).Float(1.5f);
+  builder.Local(0);
+  builder.Opcode(InterpreterOpcode::kReturn).Uint8(1).Local(0);
+  ASSERT_OK_AND_ASSIGN(auto function,
+                       DecodeFunction(builder.bytes(), 1, kSingleFunction));
+  EXPECT_THAT(function.code,
+              ElementsAre(Op(InterpreterOpcode::kConstant), 0, 0,
+                          Op(InterpreterOpcode::kReturn), 1, 0));
+  ASSERT_EQ(1, function.constants.size());
+  const auto& constant = function.constants[0];
+  EXPECT_EQ(Type::FromBuiltin(BuiltinType::kF32), constant.type);
+  EXPECT_EQ(Shape({2, 3}), constant.shape);
+  EXPECT_EQ(ConstantEncoding::kSplat, constant.encoding);
+  ASSERT_EQ(sizeof(float), constant.data.size());
+  float value = 0.0f;
+  std::memcpy(&value, constant.data.data(), sizeof(value));
+  EXPECT_EQ(1.5f, value);
+}
+
+TEST(BytecodeDecoderTest, RejectsTruncatedDenseConstant) {
+  BytecodeBuilder builder;
+  builder.Opcode(InterpreterOpcode::kConstant);
+  builder.Uint8(static_cast<uint8_t>(BuiltinType::kI32));
+  builder.Uint8(1).Int32(4);
+  builder.Uint8(static_cast<uint8_t>(ConstantEncoding::kDense));
+  builder.Int32(1).Int32(2).Int32(3);
+  EXPECT_FALSE(DecodeFunction(builder.bytes(), 1, kSingleFunction).ok());
+}
+
+TEST(BytecodeDecoderTest, ValidatesShapePieces) {
+  BytecodeBuilder builder;
+  builder.Opcode(InterpreterOpcode::kAllocHeap).Int32(0);
+  builder.Uint8(static_cast<uint8_t>(BuiltinType::kF32));
+  builder.Uint8(2).Int32(4).Int32(-1);
+  builder.Uint8(1).Local(0);
+  builder.Local(1);
+  builder.Opcode(InterpreterOpcode::kReturn).Uint8(1).Local(1);
+  ASSERT_OK_AND_ASSIGN(auto function,
+                       DecodeFunction(builder.bytes(), 2, kSingleFunction));
+  EXPECT_THAT(function.code,
+              ElementsAre(Op(InterpreterOpcode::kAllocHeap), 0,
+                          static_cast<uint32_t>(BuiltinType::kF32), 2, 4,
+                          static_cast<uint32_t>(-1), 1, 0, 1,
+                          Op(InterpreterOpcode::kReturn), 1, 1));
+
+  BytecodeBuilder mismatched_builder;
+  mismatched_builder.Opcode(InterpreterOpcode::kAllocHeap).Int32(0);
+  mismatched_builder.Uint8(static_cast<uint8_t>(BuiltinType::kF32));
+  mismatched_builder.Uint8(2).Int32(4).Int32(-1);
+  mismatched_builder.Uint8(0);
+  mismatched_builder.Local(1);
+  mismatched_builder.Opcode(InterpreterOpcode::kReturn).Uint8(1).Local(1);
+  EXPECT_FALSE(
+      DecodeFunction(mismatched_builder.bytes(), 2, kSingleFunction).ok());
+}
+
+TEST(BytecodeDecoderTest, ValidatesCallees) {
+  const bool callable_functions[] = {true, false};
+  BytecodeBuilder builder;
+  builder.Opcode(InterpreterOpcode::kCall).Uint32(0).Uint8(0).Uint8(0);
+  builder.Opcode(InterpreterOpcode::kReturn).Uint8(0);
+  EXPECT_OK(DecodeFunction(builder.bytes(), 0, callable_functions).status());
+
+  BytecodeBuilder uncallable_builder;
+  uncallable_builder.Opcode(InterpreterOpcode::kCall).Uint32(1);
+  uncallable_builder.Uint8(0).Uint8(0);
+  uncallable_builder.Opcode(InterpreterOpcode::kReturn).Uint8(0);
+  EXPECT_FALSE(
+      DecodeFunction(uncallable_builder.bytes(), 0, callable_functions).ok());
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
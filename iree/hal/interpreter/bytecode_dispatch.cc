@@ -67,11 +67,16 @@ Status Dispatch(hal::Allocator* allocator,
   // for every instruction executed). The stack_frame will change as we call
   // into different functions.
   BytecodeReader reader;
-  RETURN_IF_ERROR(reader.SwitchStackFrame(entry_stack_frame));
+  reader.SwitchStackFrame(entry_stack_frame);
 
+  // Commas in template arguments would split the dispatch macro bodies.
+  using BufferViewPtrList = absl::InlinedVector<BufferView*, 8>;
+
+  // Functions are decoded and validated when the module is loaded so operands
+  // can be read without any checks and dispatch is a single table jump.
 #define DISPATCH_NEXT()                                                     \
   {                                                                         \
-    uint8_t opcode = *reader.AdvanceOffset().ValueOrDie();                  \
+    uint8_t opcode = reader.ReadOpcode();                                   \
     DVLOG(1) << "Interpreter dispatching op code: "                         \
              << GetOpcodeInfo(interpreter_opcode_table(), opcode).mnemonic; \
     goto* kDispatchTable[opcode];                                           \
@@ -90,22 +95,20 @@ Status Dispatch(hal::Allocator* allocator,
 
   DISPATCH_CORE_OPCODE(kConstant, {
     ASSIGN_OR_RETURN(auto value, reader.ReadConstant());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    auto* dst_local = reader.ReadLocal();
     *dst_local = std::move(value);
   });
 
   DISPATCH_CORE_OPCODE(kCall, {
     auto* old_stack_frame = stack->current_frame();
-    ASSIGN_OR_RETURN(const auto& target_function, reader.ReadFunction());
-    // TODO(benvanik): rework register storage interface.
-    ASSIGN_OR_RETURN(const auto* function_def,
-                     target_function.module()->GetFunctionDef(
-                         target_function.linkage(), target_function.ordinal()));
+    const auto target_function = reader.ReadFunction();
     ASSIGN_OR_RETURN(auto* new_stack_frame, stack->PushFrame(target_function));
+    // TODO(benvanik): rework register storage interface.
     new_stack_frame->mutable_registers()->buffer_views.resize(
-        function_def->bytecode()->local_count());
-    RETURN_IF_ERROR(
-        reader.CopyInputsAndSwitchStackFrame(old_stack_frame, new_stack_frame));
+        target_function.module()
+            ->decoded_function(target_function.ordinal())
+            .local_count);
+    reader.CopyInputsAndSwitchStackFrame(old_stack_frame, new_stack_frame);
   });
 
   DISPATCH_CORE_OPCODE(kReturn, {
@@ -113,11 +116,10 @@ Status Dispatch(hal::Allocator* allocator,
     auto* new_stack_frame = stack->caller_frame();
     if (old_stack_frame == entry_stack_frame) {
       // Returning from entry function. Marshal results from the return stmt.
-      ASSIGN_OR_RETURN(int32_t src_count, reader.ReadCount());
+      int32_t src_count = reader.ReadCount();
       for (int i = 0; i < src_count; ++i) {
-        ASSIGN_OR_RETURN(
-            auto* src_local,
-            reader.ReadLocal(old_stack_frame->mutable_registers()));
+        auto* src_local =
+            reader.ReadLocal(old_stack_frame->mutable_registers());
         entry_results[i] = std::move(*src_local);
       }
       DVLOG(1) << "Returning to entry";
@@ -131,34 +133,34 @@ Status Dispatch(hal::Allocator* allocator,
   });
 
   DISPATCH_CORE_OPCODE(kBranch, {
-    ASSIGN_OR_RETURN(int32_t offset, reader.ReadBlockOffset());
-    RETURN_IF_ERROR(reader.CopySlots());
-    RETURN_IF_ERROR(reader.BranchToOffset(offset));
+    int32_t offset = reader.ReadBlockOffset();
+    reader.CopySlots();
+    reader.BranchToOffset(offset);
   });
 
   DISPATCH_CORE_OPCODE(kCondBranch, {
     // Evaluate condition first so we can do the copies as we read them for
     // which side of the branch we take.
-    ASSIGN_OR_RETURN(auto* cond_local, reader.ReadLocal());
+    auto* cond_local = reader.ReadLocal();
     bool cond_value = BufferViewIsTrue(*cond_local);
-    ASSIGN_OR_RETURN(int32_t true_offset, reader.ReadBlockOffset());
+    int32_t true_offset = reader.ReadBlockOffset();
     if (cond_value) {
-      RETURN_IF_ERROR(reader.CopySlots());
-      RETURN_IF_ERROR(reader.BranchToOffset(true_offset));
+      reader.CopySlots();
+      reader.BranchToOffset(true_offset);
     } else {
-      ASSIGN_OR_RETURN(int32_t true_op_count, reader.ReadCount());
-      RETURN_IF_ERROR(reader.SkipLocals(2 * true_op_count));
-      ASSIGN_OR_RETURN(int32_t false_offset, reader.ReadBlockOffset());
-      RETURN_IF_ERROR(reader.CopySlots());
-      RETURN_IF_ERROR(reader.BranchToOffset(false_offset));
+      int32_t true_op_count = reader.ReadCount();
+      reader.SkipLocals(2 * true_op_count);
+      int32_t false_offset = reader.ReadBlockOffset();
+      reader.CopySlots();
+      reader.BranchToOffset(false_offset);
     }
   });
 
   DISPATCH_CORE_OPCODE(kCmpI, {
-    ASSIGN_OR_RETURN(uint8_t predicate, reader.ReadUint8_t());
-    ASSIGN_OR_RETURN(auto* lhs_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto* rhs_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    uint8_t predicate = reader.ReadUint8_t();
+    auto* lhs_local = reader.ReadLocal();
+    auto* rhs_local = reader.ReadLocal();
+    auto* dst_local = reader.ReadLocal();
 
     switch (static_cast<CmpIPredicate>(predicate)) {
       case CmpIPredicate::kEq:
@@ -205,10 +207,10 @@ Status Dispatch(hal::Allocator* allocator,
   });
 
   DISPATCH_FLOAT_OPCODE(kCmpF, {
-    ASSIGN_OR_RETURN(uint8_t p, reader.ReadUint8_t());
-    ASSIGN_OR_RETURN(auto* lhs_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto* rhs_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    uint8_t p = reader.ReadUint8_t();
+    auto* lhs_local = reader.ReadLocal();
+    auto* rhs_local = reader.ReadLocal();
+    auto* dst_local = reader.ReadLocal();
 
     auto predicate = static_cast<CmpFPredicate>(p);
     switch (predicate) {
@@ -253,8 +255,8 @@ Status Dispatch(hal::Allocator* allocator,
   });
 
   DISPATCH_CORE_OPCODE(kAllocHeap, {
-    ASSIGN_OR_RETURN(auto heap_type, reader.ReadInt32());
-    ASSIGN_OR_RETURN(auto type, reader.ReadType());
+    auto heap_type = reader.ReadInt32();
+    auto type = reader.ReadType();
     size_t element_size = type.element_size();
 
     // TODO(benvanik): more efficient reading and storage.
@@ -262,7 +264,7 @@ Status Dispatch(hal::Allocator* allocator,
     ASSIGN_OR_RETURN(auto shape, reader.ReadShapePieces(&element_count));
     size_t allocation_size = element_size * element_count;
 
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    auto* dst_local = reader.ReadLocal();
     dst_local->element_size = element_size;
     dst_local->shape = shape;
 
@@ -276,60 +278,60 @@ Status Dispatch(hal::Allocator* allocator,
 
   DISPATCH_CORE_OPCODE(kDiscard, {
     // NOTE: if we were an encoder we would actually discard the buffer.
-    ASSIGN_OR_RETURN(auto* local, reader.ReadLocal());
+    auto* local = reader.ReadLocal();
     *local = {};
   });
 
   DISPATCH_CORE_OPCODE(kRank, {
-    ASSIGN_OR_RETURN(auto* src_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    auto* src_local = reader.ReadLocal();
+    auto* dst_local = reader.ReadLocal();
     int32_t rank = src_local->shape.size();
     RETURN_IF_ERROR(dst_local->buffer->WriteData(0, &rank, sizeof(int32_t)));
   });
 
   DISPATCH_CORE_OPCODE(kDim, {
-    ASSIGN_OR_RETURN(int32_t axis, reader.ReadUint8_t());
-    ASSIGN_OR_RETURN(auto* src_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    int32_t axis = reader.ReadInt32();
+    auto* src_local = reader.ReadLocal();
+    auto* dst_local = reader.ReadLocal();
     ASSIGN_OR_RETURN(int32_t dim, src_local->shape.ResolveAxis(axis));
     RETURN_IF_ERROR(dst_local->buffer->WriteData(0, &dim, sizeof(int32_t)));
   });
 
   DISPATCH_CORE_OPCODE(kShape, {
-    ASSIGN_OR_RETURN(auto* src_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    auto* src_local = reader.ReadLocal();
+    auto* dst_local = reader.ReadLocal();
     RETURN_IF_ERROR(dst_local->buffer->WriteData(
         0, src_local->shape.subspan().data(),
         src_local->shape.subspan().size() * sizeof(int32_t)));
   });
 
   DISPATCH_CORE_OPCODE(kLength, {
-    ASSIGN_OR_RETURN(auto* src_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    auto* src_local = reader.ReadLocal();
+    auto* dst_local = reader.ReadLocal();
     int32_t length = src_local->shape.element_count();
     RETURN_IF_ERROR(dst_local->buffer->WriteData(0, &length, sizeof(int32_t)));
   });
 
   DISPATCH_CORE_OPCODE(kDynamicSlice, {
-    ASSIGN_OR_RETURN(auto* src_local, reader.ReadLocal());
+    auto* src_local = reader.ReadLocal();
     ASSIGN_OR_RETURN(auto indices, reader.ReadSlotElements<int32_t>());
     ASSIGN_OR_RETURN(auto lengths, reader.ReadSlotElements<int32_t>());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    auto* dst_local = reader.ReadLocal();
     ASSIGN_OR_RETURN(*dst_local, src_local->Slice(indices, lengths));
   });
 
   DISPATCH_CORE_OPCODE(kStaticSlice, {
-    ASSIGN_OR_RETURN(auto* src_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto indices, reader.ReadIndexList());
-    ASSIGN_OR_RETURN(auto lengths, reader.ReadIndexList());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    auto* src_local = reader.ReadLocal();
+    auto indices = reader.ReadIndexList();
+    auto lengths = reader.ReadIndexList();
+    auto* dst_local = reader.ReadLocal();
     ASSIGN_OR_RETURN(*dst_local, src_local->Slice(indices, lengths));
   });
 
   DISPATCH_CORE_OPCODE(kDynamicCopy, {
-    ASSIGN_OR_RETURN(auto* src_local, reader.ReadLocal());
+    auto* src_local = reader.ReadLocal();
     ASSIGN_OR_RETURN(auto src_indices, reader.ReadSlotElements<int32_t>());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    auto* dst_local = reader.ReadLocal();
     ASSIGN_OR_RETURN(auto dst_indices, reader.ReadSlotElements<int32_t>());
     ASSIGN_OR_RETURN(auto lengths, reader.ReadSlotElements<int32_t>());
     RETURN_IF_ERROR(
@@ -337,18 +339,18 @@ Status Dispatch(hal::Allocator* allocator,
   });
 
   DISPATCH_CORE_OPCODE(kStaticCopy, {
-    ASSIGN_OR_RETURN(auto* src_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto src_indices, reader.ReadIndexList());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto dst_indices, reader.ReadIndexList());
-    ASSIGN_OR_RETURN(auto lengths, reader.ReadIndexList());
+    auto* src_local = reader.ReadLocal();
+    auto src_indices = reader.ReadIndexList();
+    auto* dst_local = reader.ReadLocal();
+    auto dst_indices = reader.ReadIndexList();
+    auto lengths = reader.ReadIndexList();
     RETURN_IF_ERROR(
         ApplyCopy(src_local, src_indices, dst_local, dst_indices, lengths));
   });
 
   DISPATCH_CORE_OPCODE(kClone, {
-    ASSIGN_OR_RETURN(auto* src_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    auto* src_local = reader.ReadLocal();
+    auto* dst_local = reader.ReadLocal();
     dst_local->element_size = src_local->element_size;
     dst_local->shape = src_local->shape;
     dst_local->buffer = HeapBuffer::Allocate(src_local->buffer->usage(),
@@ -357,24 +359,24 @@ Status Dispatch(hal::Allocator* allocator,
   });
 
   DISPATCH_CORE_OPCODE(kAssign, {
-    ASSIGN_OR_RETURN(auto* src_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    auto* src_local = reader.ReadLocal();
+    auto* dst_local = reader.ReadLocal();
     *dst_local = *src_local;
   });
 
   DISPATCH_CORE_OPCODE(kCondAssign, {
-    ASSIGN_OR_RETURN(auto* cond_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto* lhs_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto* rhs_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    auto* cond_local = reader.ReadLocal();
+    auto* lhs_local = reader.ReadLocal();
+    auto* rhs_local = reader.ReadLocal();
+    auto* dst_local = reader.ReadLocal();
     *dst_local = BufferViewIsTrue(*cond_local) ? *lhs_local : *rhs_local;
   });
 
   DISPATCH_CORE_OPCODE(kReshape, {
     // TODO(benvanik): more logic required if strides differ.
-    ASSIGN_OR_RETURN(auto* src_local, reader.ReadLocal());
+    auto* src_local = reader.ReadLocal();
     ASSIGN_OR_RETURN(auto shape_data, reader.ReadSlotElements<int32_t>());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    auto* dst_local = reader.ReadLocal();
     Shape new_shape = Shape{shape_data};
     if (src_local->shape.element_count() != new_shape.element_count()) {
       return InvalidArgumentErrorBuilder(IREE_LOC)
@@ -387,10 +389,10 @@ Status Dispatch(hal::Allocator* allocator,
   });
 
   DISPATCH_CORE_OPCODE(kSelect, {
-    ASSIGN_OR_RETURN(auto* cond_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto* lhs_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto* rhs_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    auto* cond_local = reader.ReadLocal();
+    auto* lhs_local = reader.ReadLocal();
+    auto* rhs_local = reader.ReadLocal();
+    auto* dst_local = reader.ReadLocal();
     ASSIGN_OR_RETURN(auto cond_buffer, cond_local->buffer->MapMemory<uint8_t>(
                                            MemoryAccess::kRead));
     ASSIGN_OR_RETURN(auto lhs_buffer, lhs_local->buffer->MapMemory<uint8_t>(
@@ -444,31 +446,31 @@ Status Dispatch(hal::Allocator* allocator,
   });
 
   DISPATCH_CORE_OPCODE(kTranspose, {
-    ASSIGN_OR_RETURN(auto* src_local, reader.ReadLocal());
+    auto* src_local = reader.ReadLocal();
     ASSIGN_OR_RETURN(auto perm_data, reader.ReadSlotElements<int32_t>());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    auto* dst_local = reader.ReadLocal();
     RETURN_IF_ERROR(ApplyUnaryOpIU<kernels::Transpose>(
         src_local, dst_local, src_local->shape,
         absl::MakeConstSpan(perm_data)));
   });
 
   DISPATCH_CORE_OPCODE(kReverse, {
-    ASSIGN_OR_RETURN(auto* src_local, reader.ReadLocal());
+    auto* src_local = reader.ReadLocal();
     ASSIGN_OR_RETURN(auto perm_data, reader.ReadSlotElements<int32_t>());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    auto* dst_local = reader.ReadLocal();
     RETURN_IF_ERROR(
         ApplyUnaryOpIU<kernels::Reverse>(src_local, dst_local, src_local->shape,
                                          absl::MakeConstSpan(perm_data)));
   });
 
   DISPATCH_CORE_OPCODE(kPad, {
-    ASSIGN_OR_RETURN(auto* src_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto* padding_value, reader.ReadLocal());
+    auto* src_local = reader.ReadLocal();
+    auto* padding_value = reader.ReadLocal();
     ASSIGN_OR_RETURN(auto edge_padding_low, reader.ReadSlotElements<int32_t>());
     ASSIGN_OR_RETURN(auto edge_padding_high,
                      reader.ReadSlotElements<int32_t>());
     ASSIGN_OR_RETURN(auto interior_padding, reader.ReadSlotElements<int32_t>());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    auto* dst_local = reader.ReadLocal();
 
     RETURN_IF_ERROR(ApplyBinaryOpIU<kernels::Pad>(
         src_local, padding_value, dst_local, src_local->shape, dst_local->shape,
@@ -478,203 +480,243 @@ Status Dispatch(hal::Allocator* allocator,
   });
 
   DISPATCH_CORE_OPCODE(kBroadcast, {
-    ASSIGN_OR_RETURN(auto* src_local, reader.ReadLocal());
+    auto* src_local = reader.ReadLocal();
     ASSIGN_OR_RETURN(auto shape_data, reader.ReadSlotElements<int32_t>());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    auto* dst_local = reader.ReadLocal();
     dst_local->shape = Shape{shape_data};
     RETURN_IF_ERROR(ApplyUnaryOpIU<kernels::Broadcast>(src_local, dst_local));
   });
 
   DISPATCH_CORE_OPCODE(kTile, {
-    ASSIGN_OR_RETURN(auto* src_local, reader.ReadLocal());
+    auto* src_local = reader.ReadLocal();
     ASSIGN_OR_RETURN(auto shape_data, reader.ReadSlotElements<int32_t>());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    auto* dst_local = reader.ReadLocal();
     dst_local->shape = Shape{shape_data};
     RETURN_IF_ERROR(ApplyUnaryOpIU<kernels::Tile>(
         src_local, dst_local, src_local->shape, dst_local->shape));
   });
 
   DISPATCH_CORE_OPCODE(kNot, {
-    RETURN_IF_ERROR(DispatchElementwiseUnaryOpIU<kernels::Not>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseUnaryOpIU<kernels::Not>(
+        kernel_runtime_state, &reader));
   });
   DISPATCH_CORE_OPCODE(kAnd, {
-    RETURN_IF_ERROR(DispatchElementwiseBinaryOpIU<kernels::And>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseBinaryOpIU<kernels::And>(
+        kernel_runtime_state, &reader));
   });
   DISPATCH_CORE_OPCODE(kOr, {
-    RETURN_IF_ERROR(DispatchElementwiseBinaryOpIU<kernels::Or>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseBinaryOpIU<kernels::Or>(
+        kernel_runtime_state, &reader));
   });
   DISPATCH_CORE_OPCODE(kXor, {
-    RETURN_IF_ERROR(DispatchElementwiseBinaryOpIU<kernels::Xor>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseBinaryOpIU<kernels::Xor>(
+        kernel_runtime_state, &reader));
   });
   DISPATCH_CORE_OPCODE(kShiftLeft, {
-    RETURN_IF_ERROR(DispatchElementwiseBinaryOpIU<kernels::ShiftLeft>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseBinaryOpIU<kernels::ShiftLeft>(
+        kernel_runtime_state, &reader));
   });
   DISPATCH_CORE_OPCODE(kShiftRightLogical, {
-    RETURN_IF_ERROR(
-        DispatchElementwiseBinaryOpIU<kernels::ShiftRight>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseBinaryOpIU<kernels::ShiftRight>(
+        kernel_runtime_state, &reader));
   });
   DISPATCH_CORE_OPCODE(kShiftRightArithmetic, {
-    RETURN_IF_ERROR(
-        DispatchElementwiseBinaryOpIS<kernels::ShiftRight>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseBinaryOpIS<kernels::ShiftRight>(
+        kernel_runtime_state, &reader));
   });
 
   DISPATCH_CORE_OPCODE(kAddI, {
-    RETURN_IF_ERROR(DispatchElementwiseBinaryOpIU<kernels::Add>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseBinaryOpIU<kernels::Add>(
+        kernel_runtime_state, &reader));
   });
   DISPATCH_FLOAT_OPCODE(kAddF, {
-    RETURN_IF_ERROR(DispatchElementwiseBinaryOpF<kernels::Add>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseBinaryOpF<kernels::Add>(
+        kernel_runtime_state, &reader));
   });
 
   DISPATCH_CORE_OPCODE(kSubI, {
-    RETURN_IF_ERROR(DispatchElementwiseBinaryOpIU<kernels::Sub>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseBinaryOpIU<kernels::Sub>(
+        kernel_runtime_state, &reader));
   });
   DISPATCH_FLOAT_OPCODE(kSubF, {
-    RETURN_IF_ERROR(DispatchElementwiseBinaryOpF<kernels::Sub>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseBinaryOpF<kernels::Sub>(
+        kernel_runtime_state, &reader));
   });
 
   DISPATCH_CORE_OPCODE(kAbsI, {
-    RETURN_IF_ERROR(DispatchElementwiseUnaryOpIS<kernels::Abs>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseUnaryOpIS<kernels::Abs>(
+        kernel_runtime_state, &reader));
   });
   DISPATCH_FLOAT_OPCODE(kAbsF, {
-    RETURN_IF_ERROR(DispatchElementwiseUnaryOpF<kernels::Abs>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseUnaryOpF<kernels::Abs>(
+        kernel_runtime_state, &reader));
   });
 
   DISPATCH_CORE_OPCODE(kMulI, {
-    RETURN_IF_ERROR(DispatchElementwiseBinaryOpIU<kernels::Mul>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseBinaryOpIU<kernels::Mul>(
+        kernel_runtime_state, &reader));
   });
   DISPATCH_FLOAT_OPCODE(kMulF, {
-    RETURN_IF_ERROR(DispatchElementwiseBinaryOpF<kernels::Mul>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseBinaryOpF<kernels::Mul>(
+        kernel_runtime_state, &reader));
   });
 
   DISPATCH_CORE_OPCODE(kDivIS, {
-    RETURN_IF_ERROR(DispatchElementwiseBinaryOpIS<kernels::Div>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseBinaryOpIS<kernels::Div>(
+        kernel_runtime_state, &reader));
   });
   DISPATCH_CORE_OPCODE(kDivIU, {
-    RETURN_IF_ERROR(DispatchElementwiseBinaryOpIU<kernels::Div>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseBinaryOpIU<kernels::Div>(
+        kernel_runtime_state, &reader));
   });
   DISPATCH_FLOAT_OPCODE(kDivF, {
-    RETURN_IF_ERROR(DispatchElementwiseBinaryOpF<kernels::Div>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseBinaryOpF<kernels::Div>(
+        kernel_runtime_state, &reader));
   });
 
   DISPATCH_CORE_OPCODE(kRemIS, {
-    RETURN_IF_ERROR(DispatchElementwiseBinaryOpIS<kernels::Rem>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseBinaryOpIS<kernels::Rem>(
+        kernel_runtime_state, &reader));
   });
   DISPATCH_CORE_OPCODE(kRemIU, {
-    RETURN_IF_ERROR(DispatchElementwiseBinaryOpIU<kernels::Rem>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseBinaryOpIU<kernels::Rem>(
+        kernel_runtime_state, &reader));
   });
   DISPATCH_FLOAT_OPCODE(kRemF, {
-    RETURN_IF_ERROR(DispatchElementwiseBinaryOpF<kernels::Rem>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseBinaryOpF<kernels::Rem>(
+        kernel_runtime_state, &reader));
   });
 
   DISPATCH_CORE_OPCODE(kMulAddI, {
-    RETURN_IF_ERROR(DispatchElementwiseTernaryOpIU<kernels::MulAdd>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseTernaryOpIU<kernels::MulAdd>(
+        kernel_runtime_state, &reader));
   });
   DISPATCH_FLOAT_OPCODE(kMulAddF, {
-    RETURN_IF_ERROR(DispatchElementwiseTernaryOpF<kernels::MulAdd>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseTernaryOpF<kernels::MulAdd>(
+        kernel_runtime_state, &reader));
   });
   DISPATCH_FLOAT_OPCODE(kExpF, {
-    RETURN_IF_ERROR(DispatchElementwiseUnaryOpF<kernels::Exp>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseUnaryOpF<kernels::Exp>(
+        kernel_runtime_state, &reader));
   });
   DISPATCH_FLOAT_OPCODE(kLogF, {
-    RETURN_IF_ERROR(DispatchElementwiseUnaryOpF<kernels::Log>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseUnaryOpF<kernels::Log>(
+        kernel_runtime_state, &reader));
   });
   DISPATCH_FLOAT_OPCODE(kRsqrtF, {
-    RETURN_IF_ERROR(DispatchElementwiseUnaryOpF<kernels::Rsqrt>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseUnaryOpF<kernels::Rsqrt>(
+        kernel_runtime_state, &reader));
   });
   DISPATCH_FLOAT_OPCODE(kSqrtF, {
-    RETURN_IF_ERROR(DispatchElementwiseUnaryOpF<kernels::Sqrt>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseUnaryOpF<kernels::Sqrt>(
+        kernel_runtime_state, &reader));
   });
   DISPATCH_FLOAT_OPCODE(kCosF, {
-    RETURN_IF_ERROR(DispatchElementwiseUnaryOpF<kernels::Cos>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseUnaryOpF<kernels::Cos>(
+        kernel_runtime_state, &reader));
   });
   DISPATCH_FLOAT_OPCODE(kSinF, {
-    RETURN_IF_ERROR(DispatchElementwiseUnaryOpF<kernels::Sin>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseUnaryOpF<kernels::Sin>(
+        kernel_runtime_state, &reader));
   });
   DISPATCH_FLOAT_OPCODE(kTanhF, {
-    RETURN_IF_ERROR(DispatchElementwiseUnaryOpF<kernels::Tanh>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseUnaryOpF<kernels::Tanh>(
+        kernel_runtime_state, &reader));
   });
   DISPATCH_FLOAT_OPCODE(kAtan2F, {
-    RETURN_IF_ERROR(DispatchElementwiseBinaryOpF<kernels::Atan2>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseBinaryOpF<kernels::Atan2>(
+        kernel_runtime_state, &reader));
   });
 
   DISPATCH_CORE_OPCODE(kMinIS, {
-    RETURN_IF_ERROR(DispatchElementwiseBinaryOpIS<kernels::Min>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseBinaryOpIS<kernels::Min>(
+        kernel_runtime_state, &reader));
   });
   DISPATCH_CORE_OPCODE(kMinIU, {
-    RETURN_IF_ERROR(DispatchElementwiseBinaryOpIU<kernels::Min>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseBinaryOpIU<kernels::Min>(
+        kernel_runtime_state, &reader));
   });
   DISPATCH_FLOAT_OPCODE(kMinF, {
-    RETURN_IF_ERROR(DispatchElementwiseBinaryOpF<kernels::Min>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseBinaryOpF<kernels::Min>(
+        kernel_runtime_state, &reader));
   });
 
   DISPATCH_CORE_OPCODE(kMaxIS, {
-    RETURN_IF_ERROR(DispatchElementwiseBinaryOpIS<kernels::Max>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseBinaryOpIS<kernels::Max>(
+        kernel_runtime_state, &reader));
   });
   DISPATCH_CORE_OPCODE(kMaxIU, {
-    RETURN_IF_ERROR(DispatchElementwiseBinaryOpIU<kernels::Max>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseBinaryOpIU<kernels::Max>(
+        kernel_runtime_state, &reader));
   });
   DISPATCH_FLOAT_OPCODE(kMaxF, {
-    RETURN_IF_ERROR(DispatchElementwiseBinaryOpF<kernels::Max>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseBinaryOpF<kernels::Max>(
+        kernel_runtime_state, &reader));
   });
 
   DISPATCH_CORE_OPCODE(kClampIS, {
-    RETURN_IF_ERROR(DispatchElementwiseTernaryOpIS<kernels::Clamp>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseTernaryOpIS<kernels::Clamp>(
+        kernel_runtime_state, &reader));
   });
   DISPATCH_CORE_OPCODE(kClampIU, {
-    RETURN_IF_ERROR(DispatchElementwiseTernaryOpIS<kernels::Clamp>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseTernaryOpIS<kernels::Clamp>(
+        kernel_runtime_state, &reader));
   });
   DISPATCH_FLOAT_OPCODE(kClampF, {
-    RETURN_IF_ERROR(DispatchElementwiseTernaryOpF<kernels::Clamp>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseTernaryOpF<kernels::Clamp>(
+        kernel_runtime_state, &reader));
   });
 
   DISPATCH_FLOAT_OPCODE(kFloorF, {
-    RETURN_IF_ERROR(DispatchElementwiseUnaryOpF<kernels::Floor>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseUnaryOpF<kernels::Floor>(
+        kernel_runtime_state, &reader));
   });
   DISPATCH_FLOAT_OPCODE(kCeilF, {
-    RETURN_IF_ERROR(DispatchElementwiseUnaryOpF<kernels::Ceil>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseUnaryOpF<kernels::Ceil>(
+        kernel_runtime_state, &reader));
   });
 
   DISPATCH_CORE_OPCODE(kConvertSS, {
-    ASSIGN_OR_RETURN(auto src_type, reader.ReadType());
-    ASSIGN_OR_RETURN(auto* src_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto dst_type, reader.ReadType());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    auto src_type = reader.ReadType();
+    auto* src_local = reader.ReadLocal();
+    auto dst_type = reader.ReadType();
+    auto* dst_local = reader.ReadLocal();
     RETURN_IF_ERROR(
         ApplyConvertSS::Apply(src_type, src_local, dst_type, dst_local));
   });
   DISPATCH_CORE_OPCODE(kConvertUU, {
-    ASSIGN_OR_RETURN(auto src_type, reader.ReadType());
-    ASSIGN_OR_RETURN(auto* src_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto dst_type, reader.ReadType());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    auto src_type = reader.ReadType();
+    auto* src_local = reader.ReadLocal();
+    auto dst_type = reader.ReadType();
+    auto* dst_local = reader.ReadLocal();
     RETURN_IF_ERROR(
         ApplyConvertUU::Apply(src_type, src_local, dst_type, dst_local));
   });
   DISPATCH_CORE_OPCODE(kConvertSU, {
-    ASSIGN_OR_RETURN(auto src_type, reader.ReadType());
-    ASSIGN_OR_RETURN(auto* src_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto dst_type, reader.ReadType());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    auto src_type = reader.ReadType();
+    auto* src_local = reader.ReadLocal();
+    auto dst_type = reader.ReadType();
+    auto* dst_local = reader.ReadLocal();
     RETURN_IF_ERROR(
         ApplyConvertSU::Apply(src_type, src_local, dst_type, dst_local));
   });
   DISPATCH_CORE_OPCODE(kConvertUS, {
-    ASSIGN_OR_RETURN(auto src_type, reader.ReadType());
-    ASSIGN_OR_RETURN(auto* src_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto dst_type, reader.ReadType());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    auto src_type = reader.ReadType();
+    auto* src_local = reader.ReadLocal();
+    auto dst_type = reader.ReadType();
+    auto* dst_local = reader.ReadLocal();
     RETURN_IF_ERROR(
         ApplyConvertUS::Apply(src_type, src_local, dst_type, dst_local));
   });
 
   DISPATCH_CORE_OPCODE(kMatMulI, {
-    ASSIGN_OR_RETURN(auto* lhs_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto* rhs_local, reader.ReadLocal());
+    auto* lhs_local = reader.ReadLocal();
+    auto* rhs_local = reader.ReadLocal();
     // TODO(benvanik): add fused matmul-with-bias op in MLIR and lower to this.
     BufferView* bias_local = nullptr;
-    ASSIGN_OR_RETURN(auto* multiplier_mantissa_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto* multiplier_exponent_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    auto* multiplier_mantissa_local = reader.ReadLocal();
+    auto* multiplier_exponent_local = reader.ReadLocal();
+    auto* dst_local = reader.ReadLocal();
     RETURN_IF_ERROR(ValidateMatMulOpI(lhs_local, rhs_local, bias_local,
                                       multiplier_mantissa_local,
                                       multiplier_exponent_local, dst_local));
@@ -709,10 +751,33 @@ Status Dispatch(hal::Allocator* allocator,
   });
 
   DISPATCH_FLOAT_OPCODE(kMatMulF, {
-    ASSIGN_OR_RETURN(auto* lhs_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto* rhs_local, reader.ReadLocal());
+    auto* lhs_local = reader.ReadLocal();
+    auto* rhs_local = reader.ReadLocal();
     BufferView* bias_local = nullptr;
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    auto* dst_local = reader.ReadLocal();
+    RETURN_IF_ERROR(
+        ValidateMatMulOpF(lhs_local, rhs_local, bias_local, dst_local));
+    auto* mat_mul_state = kernel_runtime_state->mat_mul_state.get();
+    switch (lhs_local->element_size) {
+      case 4:
+        RETURN_IF_ERROR(ApplyMatMulOpF<float>(
+            mat_mul_state, lhs_local, rhs_local, bias_local, dst_local));
+        break;
+      case 8:
+        RETURN_IF_ERROR(ApplyMatMulOpF<double>(
+            mat_mul_state, lhs_local, rhs_local, bias_local, dst_local));
+        break;
+      default:
+        return UnimplementedErrorBuilder(IREE_LOC)
+               << "Unimplemented element size: " << lhs_local->element_size;
+    }
+  });
+
+  DISPATCH_FLOAT_OPCODE(kMatMulBiasF, {
+    auto* lhs_local = reader.ReadLocal();
+    auto* rhs_local = reader.ReadLocal();
+    auto* bias_local = reader.ReadLocal();
+    auto* dst_local = reader.ReadLocal();
     RETURN_IF_ERROR(
         ValidateMatMulOpF(lhs_local, rhs_local, bias_local, dst_local));
     auto* mat_mul_state = kernel_runtime_state->mat_mul_state.get();
@@ -731,11 +796,36 @@ Status Dispatch(hal::Allocator* allocator,
     }
   });
 
+  DISPATCH_FLOAT_OPCODE(kElementwiseF, {
+    int32_t src_count = reader.ReadCount();
+    BufferViewPtrList src_locals(src_count);
+    for (int i = 0; i < src_count; ++i) {
+      src_locals[i] = reader.ReadLocal();
+    }
+    auto program = reader.ReadIndexList();
+    auto* dst_local = reader.ReadLocal();
+    RETURN_IF_ERROR(ValidateFusedElementwiseOp(src_locals, dst_local));
+    auto* thread_pool = kernel_runtime_state->thread_pool;
+    switch (dst_local->element_size) {
+      case 4:
+        RETURN_IF_ERROR(ApplyFusedElementwiseOpF<float>(
+            src_locals, program, dst_local, thread_pool));
+        break;
+      case 8:
+        RETURN_IF_ERROR(ApplyFusedElementwiseOpF<double>(
+            src_locals, program, dst_local, thread_pool));
+        break;
+      default:
+        return UnimplementedErrorBuilder(IREE_LOC)
+               << "Unimplemented element size: " << dst_local->element_size;
+    }
+  });
+
   DISPATCH_CORE_OPCODE(kReduceSumI, {
-    ASSIGN_OR_RETURN(auto* src_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto* init_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto dimension, reader.ReadInt32());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    auto* src_local = reader.ReadLocal();
+    auto* init_local = reader.ReadLocal();
+    auto dimension = reader.ReadInt32();
+    auto* dst_local = reader.ReadLocal();
     // TODO(scotttodd): validate
     RETURN_IF_ERROR(ApplyBinaryOpIS<kernels::ReduceSum>(
         src_local, init_local, dst_local, dimension, src_local->shape,
@@ -743,10 +833,10 @@ Status Dispatch(hal::Allocator* allocator,
   });
 
   DISPATCH_FLOAT_OPCODE(kReduceSumF, {
-    ASSIGN_OR_RETURN(auto* src_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto* init_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto dimension, reader.ReadInt32());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    auto* src_local = reader.ReadLocal();
+    auto* init_local = reader.ReadLocal();
+    auto dimension = reader.ReadInt32();
+    auto* dst_local = reader.ReadLocal();
     // TODO(scotttodd): validate
     RETURN_IF_ERROR(ApplyBinaryOpF<kernels::ReduceSum>(
         src_local, init_local, dst_local, dimension, src_local->shape,
@@ -754,10 +844,10 @@ Status Dispatch(hal::Allocator* allocator,
   });
 
   DISPATCH_CORE_OPCODE(kReduceMinI, {
-    ASSIGN_OR_RETURN(auto* src_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto* init_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto dimension, reader.ReadInt32());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    auto* src_local = reader.ReadLocal();
+    auto* init_local = reader.ReadLocal();
+    auto dimension = reader.ReadInt32();
+    auto* dst_local = reader.ReadLocal();
     // TODO(scotttodd): validate
     RETURN_IF_ERROR(ApplyBinaryOpIS<kernels::ReduceMin>(
         src_local, init_local, dst_local, dimension, src_local->shape,
@@ -765,10 +855,10 @@ Status Dispatch(hal::Allocator* allocator,
   });
 
   DISPATCH_FLOAT_OPCODE(kReduceMinF, {
-    ASSIGN_OR_RETURN(auto* src_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto* init_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto dimension, reader.ReadInt32());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    auto* src_local = reader.ReadLocal();
+    auto* init_local = reader.ReadLocal();
+    auto dimension = reader.ReadInt32();
+    auto* dst_local = reader.ReadLocal();
     // TODO(scotttodd): validate
     RETURN_IF_ERROR(ApplyBinaryOpF<kernels::ReduceMin>(
         src_local, init_local, dst_local, dimension, src_local->shape,
@@ -776,10 +866,10 @@ Status Dispatch(hal::Allocator* allocator,
   });
 
   DISPATCH_CORE_OPCODE(kReduceMaxI, {
-    ASSIGN_OR_RETURN(auto* src_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto* init_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto dimension, reader.ReadInt32());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    auto* src_local = reader.ReadLocal();
+    auto* init_local = reader.ReadLocal();
+    auto dimension = reader.ReadInt32();
+    auto* dst_local = reader.ReadLocal();
     // TODO(scotttodd): validate
     RETURN_IF_ERROR(ApplyBinaryOpIS<kernels::ReduceMax>(
         src_local, init_local, dst_local, dimension, src_local->shape,
@@ -787,10 +877,10 @@ Status Dispatch(hal::Allocator* allocator,
   });
 
   DISPATCH_FLOAT_OPCODE(kReduceMaxF, {
-    ASSIGN_OR_RETURN(auto* src_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto* init_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto dimension, reader.ReadInt32());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    auto* src_local = reader.ReadLocal();
+    auto* init_local = reader.ReadLocal();
+    auto dimension = reader.ReadInt32();
+    auto* dst_local = reader.ReadLocal();
     // TODO(scotttodd): validate
     RETURN_IF_ERROR(ApplyBinaryOpF<kernels::ReduceMax>(
         src_local, init_local, dst_local, dimension, src_local->shape,
@@ -0,0 +1,172 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstring>
+#include <vector>
+
+#include "absl/container/inlined_vector.h"
+#include "benchmark/benchmark.h"
+#include "flatbuffers/flatbuffers.h"
+#include "iree/base/logging.h"
+#include "iree/hal/heap_buffer.h"
+#include "iree/hal/host/host_local_allocator.h"
+#include "iree/hal/interpreter/bytecode_kernels.h"
+#include "iree/hal/interpreter/interpreter_module.h"
+#include "iree/hal/interpreter/stack.h"
+#include "iree/schemas/interpreter_module_def_generated.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+// Assembles function bytecode as written by the compiler.
+class BytecodeBuilder {
+ public:
+  BytecodeBuilder& Opcode(InterpreterOpcode opcode) {
+    return Uint8(static_cast<uint8_t>(opcode));
+  }
+  BytecodeBuilder& Local(uint16_t local) { return Append(local); }
+  BytecodeBuilder& Uint8(uint8_t value) { return Append(value); }
+  BytecodeBuilder& Int32(int32_t value) { return Append(value); }
+  BytecodeBuilder& Uint32(uint32_t value) { return Append(value); }
+
+  // Overwrites the uint32_t at |offset| with |value|.
+  void Patch(size_t offset, uint32_t value) {
+    std::memcpy(bytes_.data() + offset, &value, sizeof(value));
+  }
+
+  size_t offset() const { return bytes_.size(); }
+  const std::vector<uint8_t>& bytes() const { return bytes_; }
+
+ private:
+  template <typename T>
+  BytecodeBuilder& Append(T value) {
+    size_t offset = bytes_.size();
+    bytes_.resize(offset + sizeof(T));
+    std::memcpy(bytes_.data() + offset, &value, sizeof(T));
+    return *this;
+  }
+
+  std::vector<uint8_t> bytes_;
+};
+
+// Locals of the loop function. All are passed in as arguments.
+enum LoopLocal : uint16_t {
+  kCounter = 0,  // i32 decremented until zero and returned.
+  kOne,          // i32 constant 1.
+  kZero,         // i32 constant 0.
+  kCond,         // i8 loop condition.
+  kShaped,       // f32 buffer queried with dim each iteration.
+  kDimResult,    // i32 result of dim.
+  kLoopLocalCount,
+};
+
+// Number of instructions executed by each iteration of the loop.
+constexpr int kInstructionsPerIteration = 4;
+
+// Returns the bytecode of a function that loops until kCounter reaches zero
+// while executing only cheap scalar instructions, such that the time is
+// dominated by instruction dispatch:
+//   loop:
+//     dim = dim(shaped, -1)
+//     counter = counter - one
+//     cond = counter != zero
+//     cond_br cond, loop, exit
+//   exit:
+//     return counter
+std::vector<uint8_t> MakeLoopBytecode() {
+  BytecodeBuilder builder;
+  builder.Opcode(InterpreterOpcode::kDim).Int32(-1);
+  builder.Local(kShaped).Local(kDimResult);
+  builder.Opcode(InterpreterOpcode::kSubI).Local(kCounter).Local(kOne);
+  builder.Local(kCounter);
+  builder.Opcode(InterpreterOpcode::kCmpI);
+  builder.Uint8(static_cast<uint8_t>(CmpIPredicate::kNe));
+  builder.Local(kCounter).Local(kZero).Local(kCond);
+  builder.Opcode(InterpreterOpcode::kCondBranch).Local(kCond);
+  builder.Uint32(0).Uint8(0);
+  size_t exit_offset_offset = builder.offset();
+  builder.Uint32(0).Uint8(0);
+  builder.Patch(exit_offset_offset, builder.offset());
+  builder.Opcode(InterpreterOpcode::kReturn).Uint8(1).Local(kCounter);
+  return builder.bytes();
+}
+
+// Returns a module containing only the loop function.
+std::vector<uint8_t> MakeLoopModuleData() {
+  ::flatbuffers::FlatBufferBuilder fbb;
+  auto bytecode = MakeLoopBytecode();
+  auto bytecode_def = CreateBytecodeDef(
+      fbb, kLoopLocalCount,
+      fbb.CreateVector(reinterpret_cast<const int8_t*>(bytecode.data()),
+                       bytecode.size()));
+  auto function_type = CreateFunctionTypeDef(fbb);
+  auto function_def =
+      CreateFunctionDef(fbb, fbb.CreateString("loop"), function_type,
+                        /*attrs=*/0, bytecode_def);
+  auto function_table = CreateFunctionTableDef(
+      fbb, fbb.CreateVector(
+               std::vector<::flatbuffers::Offset<FunctionDef>>{function_def}));
+  auto module_def =
+      CreateModuleDef(fbb, fbb.CreateString("dispatch"), function_table);
+  FinishModuleDefBuffer(fbb, module_def);
+  return {fbb.GetBufferPointer(), fbb.GetBufferPointer() + fbb.GetSize()};
+}
+
+template <typename T>
+BufferView MakeBufferView(std::vector<T> contents, Shape shape) {
+  return BufferView(HeapBuffer::AllocateCopy(BufferUsage::kAll,
+                                             absl::MakeConstSpan(contents)),
+                    shape, sizeof(T));
+}
+
+// Runs the loop function for state.range(0) iterations. Items processed are
+// executed instructions.
+static void BM_DispatchLoop(benchmark::State& state) {
+  int32_t iteration_count = state.range(0);
+  HostLocalAllocator allocator;
+  auto module_data = MakeLoopModuleData();
+  auto module_or = InterpreterModule::FromDef(
+      &allocator, *::flatbuffers::GetRoot<ModuleDef>(module_data.data()));
+  CHECK_OK(module_or.status());
+  auto module = std::move(module_or).ValueOrDie();
+  Function function(module.get(), Function::Linkage::kInternal, 0);
+  kernels::RuntimeState kernel_runtime_state;
+  Stack stack;
+
+  auto counter = MakeBufferView<int32_t>({iteration_count}, {});
+  absl::InlinedVector<BufferView, 8> arguments = {
+      counter,
+      MakeBufferView<int32_t>({1}, {}),
+      MakeBufferView<int32_t>({0}, {}),
+      MakeBufferView<uint8_t>({0}, {}),
+      MakeBufferView<float>(std::vector<float>(16), {16}),
+      MakeBufferView<int32_t>({0}, {}),
+  };
+  for (auto _ : state) {
+    CHECK_OK(counter.buffer->WriteData(0, &iteration_count,
+                                       sizeof(iteration_count)));
+    absl::InlinedVector<BufferView, 8> results(1);
+    CHECK_OK(module->Execute(&kernel_runtime_state, &stack, function,
+                             arguments, &results));
+    benchmark::DoNotOptimize(results[0].buffer.get());
+  }
+  state.SetItemsProcessed(state.iterations() * iteration_count *
+                          kInstructionsPerIteration);
+}
+BENCHMARK(BM_DispatchLoop)->Arg(1)->Arg(1024);
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
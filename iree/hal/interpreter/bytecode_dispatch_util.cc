@@ -53,19 +53,58 @@ Status ValidateElementwiseTernaryOp(BufferView* a_local, BufferView* b_local,
   return OkStatus();
 }
 
+Status ValidateFusedElementwiseOp(absl::Span<BufferView* const> src_locals,
+                                  BufferView* dst_local) {
+  for (auto* src_local : src_locals) {
+    if (src_local->element_size != dst_local->element_size ||
+        src_local->shape.element_count() != dst_local->shape.element_count()) {
+      return InvalidArgumentErrorBuilder(IREE_LOC)
+             << "Fused elementwise input " << src_local->shape << " does not "
+             << "match output " << dst_local->shape;
+    }
+  }
+  return OkStatus();
+}
+
+namespace {
+
+// Validates that |dst_local| = |lhs_local| * |rhs_local| + |bias_local| is a
+// [m, k] * [k, n] + [n] matrix multiplication.
+Status ValidateMatMulShapes(BufferView* lhs_local, BufferView* rhs_local,
+                            BufferView* bias_local, BufferView* dst_local) {
+  const auto& lhs_shape = lhs_local->shape;
+  const auto& rhs_shape = rhs_local->shape;
+  const auto& dst_shape = dst_local->shape;
+  if (lhs_shape.size() != 2 || rhs_shape.size() != 2 ||
+      dst_shape.size() != 2 || lhs_shape[1] != rhs_shape[0] ||
+      dst_shape[0] != lhs_shape[0] || dst_shape[1] != rhs_shape[1]) {
+    return InvalidArgumentErrorBuilder(IREE_LOC)
+           << "MatMul shapes do not match: " << lhs_shape << " * "
+           << rhs_shape << " -> " << dst_shape;
+  }
+  if (bias_local && bias_local->buffer && !bias_local->shape.empty() &&
+      bias_local->shape.element_count() != dst_shape[1]) {
+    return InvalidArgumentErrorBuilder(IREE_LOC)
+           << "MatMul bias " << bias_local->shape
+           << " must have one element per destination column of "
+           << dst_shape;
+  }
+  return OkStatus();
+}
+
+}  // namespace
+
 Status ValidateMatMulOpI(BufferView* lhs_local, BufferView* rhs_local,
                          BufferView* bias_local,
                          BufferView* multiplier_mantissa_local,
                          BufferView* multiplier_exponent_local,
                          BufferView* dst_local) {
-  // TODO(benvanik): validate shapes.
-  return OkStatus();
+  return ValidateMatMulShapes(lhs_local, rhs_local, bias_local, dst_local);
 }
 
 Status ValidateMatMulOpF(BufferView* lhs_local, BufferView* rhs_local,
                          BufferView* bias_local, BufferView* dst_local) {
-  // TODO(benvanik): validate shapes.
-  return OkStatus();
+  return ValidateMatMulShapes(lhs_local, rhs_local, bias_local, dst_local);
 }
 
 Status ApplyCopy(BufferView* src_local, absl::Span<const int32_t> src_indices,
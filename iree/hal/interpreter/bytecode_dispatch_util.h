@@ -18,11 +18,15 @@
 #ifndef IREE_HAL_INTERPRETER_BYTECODE_DISPATCH_UTIL_H_
 #define IREE_HAL_INTERPRETER_BYTECODE_DISPATCH_UTIL_H_
 
+#include <algorithm>
+#include <vector>
+
 #include "absl/base/attributes.h"
 #include "absl/container/inlined_vector.h"
 #include "iree/base/status.h"
 #include "iree/hal/buffer_view.h"
 #include "iree/hal/heap_buffer.h"
+#include "iree/hal/host/host_thread_pool.h"
 #include "iree/hal/interpreter/bytecode_kernels.h"
 #include "iree/hal/interpreter/bytecode_reader.h"
 #include "iree/hal/interpreter/stack.h"
@@ -53,6 +57,8 @@ Status ValidateMatMulOpI(BufferView* lhs_local, BufferView* rhs_local,
                          BufferView* dst_local);
 Status ValidateMatMulOpF(BufferView* lhs_local, BufferView* rhs_local,
                          BufferView* bias_local, BufferView* dst_local);
+Status ValidateFusedElementwiseOp(absl::Span<BufferView* const> src_locals,
+                                  BufferView* dst_local);
 
 template <typename KERNEL, typename T, typename... ARGS>
 Status ApplyUnaryOp(BufferView* src_local, BufferView* dst_local,
@@ -418,88 +424,219 @@ Status ApplyMatMulOpF(kernels::MatMul::RuntimeState* runtime_state,
   return kernels::MatMul::Execute(runtime_state, buffers);
 }
 
+// Minimum number of elements processed by a single tile when elementwise
+// kernels are split across the thread pool. Smaller buffers execute inline as
+// the scheduling overhead would dominate.
+constexpr size_t kMinElementsPerTile = 16 * 1024;
+
+// Splits [0, element_count) into tiles and calls |fn(offset, length)| for each.
+// Tiles execute on |thread_pool| when one is provided and the range is large
+// enough to be worth splitting.
+template <typename FN>
+Status ParallelForElements(HostThreadPool* thread_pool, size_t element_count,
+                           FN fn) {
+  size_t tile_count = 1;
+  if (thread_pool) {
+    tile_count = std::min(element_count / kMinElementsPerTile,
+                          static_cast<size_t>(thread_pool->concurrency()) * 4);
+  }
+  if (tile_count <= 1) {
+    return fn(0, element_count);
+  }
+  size_t tile_size = (element_count + tile_count - 1) / tile_count;
+  return thread_pool->ParallelFor(
+      static_cast<int>(tile_count), [&](int tile_index) -> Status {
+        size_t offset = tile_index * tile_size;
+        if (offset >= element_count) return OkStatus();
+        return fn(offset, std::min(tile_size, element_count - offset));
+      });
+}
+
+// Wraps an elementwise KERNEL such that its execution is split into tiles.
+// As each element is computed independently the results are identical to
+// executing the kernel on the whole buffer.
+template <typename KERNEL>
+struct ParallelElementwise {
+  template <typename T>
+  static Status Execute(absl::Span<const T> src_buffer,
+                        absl::Span<T> dst_buffer, HostThreadPool* thread_pool) {
+    return ParallelForElements(
+        thread_pool, dst_buffer.size(), [&](size_t offset, size_t length) {
+          return KERNEL::Execute(src_buffer.subspan(offset, length),
+                                 dst_buffer.subspan(offset, length));
+        });
+  }
+
+  template <typename T>
+  static Status Execute(absl::Span<const T> lhs_buffer,
+                        absl::Span<const T> rhs_buffer,
+                        absl::Span<T> dst_buffer, HostThreadPool* thread_pool) {
+    return ParallelForElements(
+        thread_pool, dst_buffer.size(), [&](size_t offset, size_t length) {
+          return KERNEL::Execute(lhs_buffer.subspan(offset, length),
+                                 rhs_buffer.subspan(offset, length),
+                                 dst_buffer.subspan(offset, length));
+        });
+  }
+
+  template <typename T>
+  static Status Execute(absl::Span<const T> a_buffer,
+                        absl::Span<const T> b_buffer,
+                        absl::Span<const T> c_buffer, absl::Span<T> dst_buffer,
+                        HostThreadPool* thread_pool) {
+    return ParallelForElements(
+        thread_pool, dst_buffer.size(), [&](size_t offset, size_t length) {
+          return KERNEL::Execute(a_buffer.subspan(offset, length),
+                                 b_buffer.subspan(offset, length),
+                                 c_buffer.subspan(offset, length),
+                                 dst_buffer.subspan(offset, length));
+        });
+  }
+};
+
+// Returns storage of at least |size| elements owned by the calling thread.
+// Tiles never yield so the storage is free again by the time the thread runs
+// another tile, and it is reused across dispatches once warm.
+template <typename T>
+absl::Span<T> GetThreadScratch(size_t size) {
+  static thread_local std::vector<T> scratch;
+  if (scratch.size() < size) scratch.resize(size);
+  return absl::MakeSpan(scratch.data(), size);
+}
+
+template <typename T>
+Status ApplyFusedElementwiseOpF(absl::Span<BufferView* const> src_locals,
+                                absl::Span<const int32_t> program,
+                                BufferView* dst_local,
+                                HostThreadPool* thread_pool) {
+  // Decoded once here and shared by all tiles.
+  ASSIGN_OR_RETURN(auto instructions, kernels::FusedElementwise::Decode(
+                                          program, src_locals.size()));
+  size_t scratch_size =
+      kernels::FusedElementwise::GetScratchSize(instructions);
+  absl::InlinedVector<MappedMemory<T>, 8> src_mappings;
+  absl::InlinedVector<absl::Span<const T>, 8> src_buffers;
+  for (auto* src_local : src_locals) {
+    ASSIGN_OR_RETURN(auto src_mapping,
+                     src_local->buffer->MapMemory<T>(MemoryAccess::kRead));
+    src_buffers.push_back(src_mapping.contents());
+    src_mappings.push_back(std::move(src_mapping));
+  }
+  ASSIGN_OR_RETURN(auto dst_buffer, dst_local->buffer->MapMemory<T>(
+                                        MemoryAccess::kDiscardWrite));
+  auto dst_contents = dst_buffer.mutable_contents();
+  return ParallelForElements(
+      thread_pool, dst_contents.size(), [&](size_t offset, size_t length) {
+        absl::InlinedVector<absl::Span<const T>, 8> src_tiles;
+        for (const auto& src_buffer : src_buffers) {
+          src_tiles.push_back(src_buffer.subspan(offset, length));
+        }
+        return kernels::FusedElementwise::Execute<T>(
+            src_tiles, instructions, GetThreadScratch<T>(scratch_size),
+            dst_contents.subspan(offset, length));
+      });
+}
+
 template <typename KERNEL>
-Status DispatchElementwiseUnaryOpIS(BytecodeReader* reader) {
-  ASSIGN_OR_RETURN(auto* src_local, reader->ReadLocal());
-  ASSIGN_OR_RETURN(auto* dst_local, reader->ReadLocal());
+Status DispatchElementwiseUnaryOpIS(kernels::RuntimeState* kernel_runtime_state,
+                                    BytecodeReader* reader) {
+  auto* src_local = reader->ReadLocal();
+  auto* dst_local = reader->ReadLocal();
   RETURN_IF_ERROR(ValidateElementwiseUnaryOp(src_local, dst_local));
-  return ApplyUnaryOpIS<KERNEL>(src_local, dst_local);
+  return ApplyUnaryOpIS<ParallelElementwise<KERNEL>>(
+      src_local, dst_local, kernel_runtime_state->thread_pool);
 }
 
 template <typename KERNEL>
-Status DispatchElementwiseUnaryOpIU(BytecodeReader* reader) {
-  ASSIGN_OR_RETURN(auto* src_local, reader->ReadLocal());
-  ASSIGN_OR_RETURN(auto* dst_local, reader->ReadLocal());
+Status DispatchElementwiseUnaryOpIU(kernels::RuntimeState* kernel_runtime_state,
+                                    BytecodeReader* reader) {
+  auto* src_local = reader->ReadLocal();
+  auto* dst_local = reader->ReadLocal();
   RETURN_IF_ERROR(ValidateElementwiseUnaryOp(src_local, dst_local));
-  return ApplyUnaryOpIU<KERNEL>(src_local, dst_local);
+  return ApplyUnaryOpIU<ParallelElementwise<KERNEL>>(
+      src_local, dst_local, kernel_runtime_state->thread_pool);
 }
 
 template <typename KERNEL>
-Status DispatchElementwiseUnaryOpF(BytecodeReader* reader) {
-  ASSIGN_OR_RETURN(auto* src_local, reader->ReadLocal());
-  ASSIGN_OR_RETURN(auto* dst_local, reader->ReadLocal());
+Status DispatchElementwiseUnaryOpF(kernels::RuntimeState* kernel_runtime_state,
+                                   BytecodeReader* reader) {
+  auto* src_local = reader->ReadLocal();
+  auto* dst_local = reader->ReadLocal();
   RETURN_IF_ERROR(ValidateElementwiseUnaryOp(src_local, dst_local));
-  return ApplyUnaryOpF<KERNEL>(src_local, dst_local);
+  return ApplyUnaryOpF<ParallelElementwise<KERNEL>>(
+      src_local, dst_local, kernel_runtime_state->thread_pool);
 }
 
 template <typename KERNEL>
-Status DispatchElementwiseBinaryOpIS(BytecodeReader* reader) {
-  ASSIGN_OR_RETURN(auto* lhs_local, reader->ReadLocal());
-  ASSIGN_OR_RETURN(auto* rhs_local, reader->ReadLocal());
-  ASSIGN_OR_RETURN(auto* dst_local, reader->ReadLocal());
+Status DispatchElementwiseBinaryOpIS(
+    kernels::RuntimeState* kernel_runtime_state, BytecodeReader* reader) {
+  auto* lhs_local = reader->ReadLocal();
+  auto* rhs_local = reader->ReadLocal();
+  auto* dst_local = reader->ReadLocal();
   RETURN_IF_ERROR(ValidateElementwiseBinaryOp(lhs_local, rhs_local, dst_local));
-  return ApplyBinaryOpIS<KERNEL>(lhs_local, rhs_local, dst_local);
+  return ApplyBinaryOpIS<ParallelElementwise<KERNEL>>(
+      lhs_local, rhs_local, dst_local, kernel_runtime_state->thread_pool);
 }
 
 template <typename KERNEL>
-Status DispatchElementwiseBinaryOpIU(BytecodeReader* reader) {
-  ASSIGN_OR_RETURN(auto* lhs_local, reader->ReadLocal());
-  ASSIGN_OR_RETURN(auto* rhs_local, reader->ReadLocal());
-  ASSIGN_OR_RETURN(auto* dst_local, reader->ReadLocal());
+Status DispatchElementwiseBinaryOpIU(
+    kernels::RuntimeState* kernel_runtime_state, BytecodeReader* reader) {
+  auto* lhs_local = reader->ReadLocal();
+  auto* rhs_local = reader->ReadLocal();
+  auto* dst_local = reader->ReadLocal();
   RETURN_IF_ERROR(ValidateElementwiseBinaryOp(lhs_local, rhs_local, dst_local));
-  return ApplyBinaryOpIU<KERNEL>(lhs_local, rhs_local, dst_local);
+  return ApplyBinaryOpIU<ParallelElementwise<KERNEL>>(
+      lhs_local, rhs_local, dst_local, kernel_runtime_state->thread_pool);
 }
 
 template <typename KERNEL>
-Status DispatchElementwiseBinaryOpF(BytecodeReader* reader) {
-  ASSIGN_OR_RETURN(auto* lhs_local, reader->ReadLocal());
-  ASSIGN_OR_RETURN(auto* rhs_local, reader->ReadLocal());
-  ASSIGN_OR_RETURN(auto* dst_local, reader->ReadLocal());
+Status DispatchElementwiseBinaryOpF(kernels::RuntimeState* kernel_runtime_state,
+                                    BytecodeReader* reader) {
+  auto* lhs_local = reader->ReadLocal();
+  auto* rhs_local = reader->ReadLocal();
+  auto* dst_local = reader->ReadLocal();
   RETURN_IF_ERROR(ValidateElementwiseBinaryOp(lhs_local, rhs_local, dst_local));
-  return ApplyBinaryOpF<KERNEL>(lhs_local, rhs_local, dst_local);
+  return ApplyBinaryOpF<ParallelElementwise<KERNEL>>(
+      lhs_local, rhs_local, dst_local, kernel_runtime_state->thread_pool);
 }
 
 template <typename KERNEL>
-Status DispatchElementwiseTernaryOpIS(BytecodeReader* reader) {
-  ASSIGN_OR_RETURN(auto* a_local, reader->ReadLocal());
-  ASSIGN_OR_RETURN(auto* b_local, reader->ReadLocal());
-  ASSIGN_OR_RETURN(auto* c_local, reader->ReadLocal());
-  ASSIGN_OR_RETURN(auto* dst_local, reader->ReadLocal());
+Status DispatchElementwiseTernaryOpIS(
+    kernels::RuntimeState* kernel_runtime_state, BytecodeReader* reader) {
+  auto* a_local = reader->ReadLocal();
+  auto* b_local = reader->ReadLocal();
+  auto* c_local = reader->ReadLocal();
+  auto* dst_local = reader->ReadLocal();
   RETURN_IF_ERROR(
       ValidateElementwiseTernaryOp(a_local, b_local, c_local, dst_local));
-  return ApplyTernaryOpIS<KERNEL>(a_local, b_local, c_local, dst_local);
+  return ApplyTernaryOpIS<ParallelElementwise<KERNEL>>(
+      a_local, b_local, c_local, dst_local, kernel_runtime_state->thread_pool);
 }
 
 template <typename KERNEL>
-Status DispatchElementwiseTernaryOpIU(BytecodeReader* reader) {
-  ASSIGN_OR_RETURN(auto* a_local, reader->ReadLocal());
-  ASSIGN_OR_RETURN(auto* b_local, reader->ReadLocal());
-  ASSIGN_OR_RETURN(auto* c_local, reader->ReadLocal());
-  ASSIGN_OR_RETURN(auto* dst_local, reader->ReadLocal());
+Status DispatchElementwiseTernaryOpIU(
+    kernels::RuntimeState* kernel_runtime_state, BytecodeReader* reader) {
+  auto* a_local = reader->ReadLocal();
+  auto* b_local = reader->ReadLocal();
+  auto* c_local = reader->ReadLocal();
+  auto* dst_local = reader->ReadLocal();
   RETURN_IF_ERROR(
       ValidateElementwiseTernaryOp(a_local, b_local, c_local, dst_local));
-  return ApplyTernaryOpIU<KERNEL>(a_local, b_local, c_local, dst_local);
+  return ApplyTernaryOpIU<ParallelElementwise<KERNEL>>(
+      a_local, b_local, c_local, dst_local, kernel_runtime_state->thread_pool);
 }
 
 template <typename KERNEL>
-Status DispatchElementwiseTernaryOpF(BytecodeReader* reader) {
-  ASSIGN_OR_RETURN(auto* a_local, reader->ReadLocal());
-  ASSIGN_OR_RETURN(auto* b_local, reader->ReadLocal());
-  ASSIGN_OR_RETURN(auto* c_local, reader->ReadLocal());
-  ASSIGN_OR_RETURN(auto* dst_local, reader->ReadLocal());
+Status DispatchElementwiseTernaryOpF(
+    kernels::RuntimeState* kernel_runtime_state, BytecodeReader* reader) {
+  auto* a_local = reader->ReadLocal();
+  auto* b_local = reader->ReadLocal();
+  auto* c_local = reader->ReadLocal();
+  auto* dst_local = reader->ReadLocal();
   RETURN_IF_ERROR(
       ValidateElementwiseTernaryOp(a_local, b_local, c_local, dst_local));
-  return ApplyTernaryOpF<KERNEL>(a_local, b_local, c_local, dst_local);
+  return ApplyTernaryOpF<ParallelElementwise<KERNEL>>(
+      a_local, b_local, c_local, dst_local, kernel_runtime_state->thread_pool);
 }
 
 Status ApplyCopy(BufferView* src_local, absl::Span<const int32_t> src_indices,
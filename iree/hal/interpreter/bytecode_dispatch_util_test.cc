@@ -0,0 +1,127 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/hal/interpreter/bytecode_dispatch_util.h"
+
+#include <cmath>
+#include <vector>
+
+#include "iree/base/shape.h"
+#include "iree/base/status.h"
+#include "iree/base/status_matchers.h"
+#include "iree/hal/heap_buffer.h"
+#include "iree/hal/host/host_thread_pool.h"
+#include "iree/testing/gtest.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+// Returns a zeroed f32 buffer view of |shape|.
+BufferView MakeBufferView(Shape shape) {
+  auto buffer = HeapBuffer::Allocate(BufferUsage::kAll,
+                                     shape.element_count() * sizeof(float));
+  return BufferView(std::move(buffer), shape, sizeof(float));
+}
+
+TEST(ValidateMatMulOpF, AcceptsMatchingShapes) {
+  auto lhs = MakeBufferView({2, 3});
+  auto rhs = MakeBufferView({3, 4});
+  auto bias = MakeBufferView({4});
+  auto dst = MakeBufferView({2, 4});
+  EXPECT_OK(ValidateMatMulOpF(&lhs, &rhs, &bias, &dst));
+  BufferView no_bias;
+  EXPECT_OK(ValidateMatMulOpF(&lhs, &rhs, &no_bias, &dst));
+}
+
+TEST(ValidateMatMulOpF, RejectsMismatchedShapes) {
+  auto lhs = MakeBufferView({2, 3});
+  auto rhs = MakeBufferView({3, 4});
+  auto dst = MakeBufferView({2, 4});
+  BufferView no_bias;
+
+  // Contraction dimensions differ.
+  auto rhs_k = MakeBufferView({4, 4});
+  EXPECT_TRUE(IsInvalidArgument(
+      ValidateMatMulOpF(&lhs, &rhs_k, &no_bias, &dst)));
+
+  // Destination is transposed.
+  auto dst_transposed = MakeBufferView({4, 2});
+  EXPECT_TRUE(IsInvalidArgument(
+      ValidateMatMulOpF(&lhs, &rhs, &no_bias, &dst_transposed)));
+
+  // Operands are not matrices.
+  auto lhs_3d = MakeBufferView({1, 2, 3});
+  EXPECT_TRUE(IsInvalidArgument(
+      ValidateMatMulOpF(&lhs_3d, &rhs, &no_bias, &dst)));
+
+  // Bias has one element per destination row instead of per column.
+  auto row_bias = MakeBufferView({2});
+  EXPECT_TRUE(IsInvalidArgument(
+      ValidateMatMulOpF(&lhs, &rhs, &row_bias, &dst)));
+}
+
+TEST(ValidateMatMulOpI, RejectsMismatchedShapes) {
+  auto lhs = MakeBufferView({2, 3});
+  auto rhs = MakeBufferView({3, 4});
+  auto dst = MakeBufferView({2, 4});
+  auto multiplier = MakeBufferView({1});
+  BufferView no_bias;
+  EXPECT_OK(ValidateMatMulOpI(&lhs, &rhs, &no_bias, &multiplier, &multiplier,
+                              &dst));
+  auto dst_n = MakeBufferView({2, 3});
+  EXPECT_TRUE(IsInvalidArgument(ValidateMatMulOpI(
+      &lhs, &rhs, &no_bias, &multiplier, &multiplier, &dst_n)));
+}
+
+TEST(ApplyFusedElementwiseOpF, SplitsIntoTiles) {
+  // Large enough to be split into several tiles that each reuse the decoded
+  // program and their thread's scratch storage.
+  const int count = 8 * kMinElementsPerTile + 3;
+  std::vector<float> src_data(count);
+  for (int i = 0; i < count; ++i) src_data[i] = (i % 31) * 0.5f;
+  BufferView src(HeapBuffer::AllocateCopy(BufferUsage::kAll,
+                                          absl::MakeConstSpan(src_data)),
+                 {count}, sizeof(float));
+  auto dst = MakeBufferView({count});
+
+  // abs(a * a - a) + a
+  std::vector<int32_t> program = {
+      static_cast<int32_t>(InterpreterOpcode::kMulF), 0, 0,  // r1
+      static_cast<int32_t>(InterpreterOpcode::kSubF), 1, 0,  // r2
+      static_cast<int32_t>(InterpreterOpcode::kAbsF), 2,     // r3
+      static_cast<int32_t>(InterpreterOpcode::kAddF), 3, 0,  // r4
+  };
+  std::vector<BufferView*> src_locals = {&src};
+  HostThreadPool thread_pool(3);
+  EXPECT_OK(ApplyFusedElementwiseOpF<float>(src_locals, program, &dst,
+                                            &thread_pool));
+
+  ASSERT_OK_AND_ASSIGN(auto dst_mapping,
+                       dst.buffer->MapMemory<float>(MemoryAccess::kRead));
+  auto dst_data = dst_mapping.contents();
+  for (int i = 0; i < count; ++i) {
+    float a = src_data[i];
+    ASSERT_EQ(std::abs(a * a - a) + a, dst_data[i]) << "element " << i;
+  }
+
+  std::vector<int32_t> invalid_program = {
+      static_cast<int32_t>(InterpreterOpcode::kAddF), 0, 1};
+  EXPECT_TRUE(IsInvalidArgument(ApplyFusedElementwiseOpF<float>(
+      src_locals, invalid_program, &dst, &thread_pool)));
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
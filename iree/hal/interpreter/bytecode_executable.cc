@@ -15,6 +15,7 @@
 #include "iree/hal/interpreter/bytecode_executable.h"
 
 #include <iostream>
+#include <utility>
 
 #include "iree/hal/interpreter/interpreter_module.h"
 
@@ -40,6 +41,19 @@ StatusOr<ref_ptr<BytecodeExecutable>> BytecodeExecutable::Load(
   return executable;
 }
 
+// static
+StatusOr<ref_ptr<BytecodeExecutable>> BytecodeExecutable::LoadMapped(
+    hal::Allocator* allocator, ExecutableFormat format,
+    ref_ptr<FileMapping> file_mapping) {
+  ExecutableSpec spec;
+  spec.format = format;
+  spec.executable_data = file_mapping->data();
+  ASSIGN_OR_RETURN(auto executable,
+                   Load(allocator, spec, /*allow_aliasing_data=*/true));
+  executable->file_mapping_ = std::move(file_mapping);
+  return executable;
+}
+
 BytecodeExecutable::BytecodeExecutable(hal::Allocator* allocator,
                                        ExecutableSpec spec,
                                        bool allow_aliasing_data)
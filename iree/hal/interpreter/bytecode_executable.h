@@ -18,6 +18,7 @@
 #include <vector>
 
 #include "absl/types/span.h"
+#include "iree/base/file_mapping.h"
 #include "iree/base/status.h"
 #include "iree/hal/allocator.h"
 #include "iree/hal/executable.h"
@@ -33,6 +34,12 @@ class BytecodeExecutable final : public Executable {
                                                     ExecutableSpec spec,
                                                     bool allow_aliasing_data);
 
+  // Loads an executable whose data is the contents of |file_mapping|.
+  // The mapping is retained for the lifetime of the executable.
+  static StatusOr<ref_ptr<BytecodeExecutable>> LoadMapped(
+      hal::Allocator* allocator, ExecutableFormat format,
+      ref_ptr<FileMapping> file_mapping);
+
   BytecodeExecutable(hal::Allocator* allocator, ExecutableSpec spec,
                      bool allow_aliasing_data);
   ~BytecodeExecutable() override;
@@ -52,6 +59,7 @@ class BytecodeExecutable final : public Executable {
  private:
   ExecutableSpec spec_;
   std::vector<uint8_t> cloned_executable_data_;
+  ref_ptr<FileMapping> file_mapping_;
 
   ref_ptr<InterpreterModule> module_;
 };
@@ -36,13 +36,18 @@
 
 #include <cstdint>
 
+#include "absl/container/inlined_vector.h"
 #include "absl/types/span.h"
 #include "iree/base/shape.h"
 #include "iree/base/status.h"
 #include "iree/base/tracing.h"
+#include "iree/schemas/bytecode/interpreter_bytecode_v0.h"
 
 namespace iree {
 namespace hal {
+
+class HostThreadPool;
+
 namespace kernels {
 
 struct CompareEQ {
@@ -199,6 +204,12 @@ struct Abs {
                         absl::Span<T> dst_buffer);
 };
 
+struct Neg {
+  template <typename T>
+  static Status Execute(absl::Span<const T> src_buffer,
+                        absl::Span<T> dst_buffer);
+};
+
 struct Mul {
   template <typename T>
   static Status Execute(absl::Span<const T> lhs_buffer,
@@ -311,6 +322,44 @@ struct Ceil {
                         absl::Span<T> dst_buffer);
 };
 
+// Evaluates a chain of floating-point elementwise ops in a single pass without
+// materializing intermediate buffers.
+//
+// |program| is a sequence of instructions, each an InterpreterOpcode of a
+// fusable op (such as kAddF) followed by the register index of each of its
+// operands. Registers [0, src_buffers.size()) hold the inputs and every
+// instruction defines the next register. The result of the last instruction is
+// written to |dst_buffer|. All buffers have the same number of elements.
+struct FusedElementwise {
+  struct Instruction {
+    InterpreterOpcode opcode;
+    int32_t operands[3];
+  };
+  using Instructions = absl::InlinedVector<Instruction, 8>;
+
+  // Decodes and validates |program| for |src_count| inputs. Callers executing
+  // the same program over many tiles should decode it once.
+  static StatusOr<Instructions> Decode(absl::Span<const int32_t> program,
+                                       size_t src_count);
+
+  // Returns the number of elements of scratch storage required to execute
+  // |instructions| on any number of elements.
+  static size_t GetScratchSize(absl::Span<const Instruction> instructions);
+
+  // Executes decoded |instructions| using |scratch| of at least
+  // GetScratchSize elements for the intermediate results.
+  template <typename T>
+  static Status Execute(absl::Span<const absl::Span<const T>> src_buffers,
+                        absl::Span<const Instruction> instructions,
+                        absl::Span<T> scratch, absl::Span<T> dst_buffer);
+
+  // Decodes |program| and executes it with temporary scratch storage.
+  template <typename T>
+  static Status Execute(absl::Span<const absl::Span<const T>> src_buffers,
+                        absl::Span<const int32_t> program,
+                        absl::Span<T> dst_buffer);
+};
+
 struct Convert {
   template <typename SRC, typename DST>
   static Status Execute(absl::Span<const SRC> src_buffer,
@@ -320,7 +369,12 @@ struct Convert {
 struct MatMul {
   struct RuntimeState;
 
-  static std::unique_ptr<RuntimeState> CreateRuntimeState();
+  // Creates state for matmuls that share up to |max_thread_count| threads,
+  // including the calling threads. |max_concurrency| is the number of matmuls
+  // expected to execute at the same time, such as the concurrency of the
+  // thread pool executing dispatches.
+  static std::unique_ptr<RuntimeState> CreateRuntimeState(
+      int max_thread_count = 1, int max_concurrency = 1);
 
   template <typename T, typename ACC>
   struct Buffers {
@@ -331,12 +385,13 @@ struct MatMul {
     Shape dst_shape;
     absl::Span<T> dst_buffer;
 
-    // Optional bias buffer.
+    // Optional bias buffer with one element per column of the destination
+    // matrix.
     absl::Span<const ACC> bias_buffer;
 
     // Fixed-point multiplier mantissa/exponent. May be a single value (for
-    // uniform quantization) or one element per row of the destination matrix
-    // for per-channel.
+    // uniform quantization) or one element per column of the destination
+    // matrix for per-channel.
     absl::Span<const ACC> multiplier_mantissa_buffer;
     absl::Span<const int32_t> multiplier_exponent_buffer;
   };
@@ -366,6 +421,10 @@ struct MatMul {
 struct RuntimeState {
   std::unique_ptr<MatMul::RuntimeState> mat_mul_state =
       MatMul::CreateRuntimeState();
+
+  // Optional thread pool used to split kernel execution into tiles.
+  // When null all kernels execute on the calling thread.
+  HostThreadPool* thread_pool = nullptr;
 };
 
 struct ReduceSum {
@@ -397,6 +456,7 @@ struct ReduceMax {
 }  // namespace iree
 
 #include "iree/hal/interpreter/bytecode_kernels_generic.h"  // IWYU pragma: export
+#include "iree/hal/interpreter/bytecode_kernels_simd.h"  // IWYU pragma: export
 #include "iree/hal/interpreter/bytecode_kernels_ruy.h"  // IWYU pragma: export
 
 #endif  // IREE_HAL_INTERPRETER_BYTECODE_KERNELS_H_
@@ -0,0 +1,319 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cmath>
+#include <numeric>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "iree/base/logging.h"
+#include "iree/hal/interpreter/bytecode_kernels.h"
+
+namespace iree {
+namespace hal {
+namespace kernels {
+namespace {
+
+// Reduces a [rows, cols] float buffer along |dimension| with either the
+// generic (recursive) or blocked reduction.
+template <typename KernelImpl, bool kBlocked>
+static void RunReduce(benchmark::State& state, int32_t dimension) {
+  int rows = state.range(0);
+  int cols = state.range(1);
+  Shape src_shape = {rows, cols};
+  Shape dst_shape = {dimension == 0 ? cols : rows};
+  std::vector<float> src_buffer(src_shape.element_count());
+  std::iota(src_buffer.begin(), src_buffer.end(), 0.0f);
+  std::vector<float> init_buffer = {0.0f};
+  std::vector<float> dst_buffer(dst_shape.element_count());
+  for (auto _ : state) {
+    if (kBlocked) {
+      CHECK_OK((impl::BlockedReduce<float, KernelImpl>(
+          src_buffer, init_buffer, absl::MakeSpan(dst_buffer), dimension,
+          src_shape, dst_shape)));
+    } else {
+      CHECK_OK((impl::GenericReduce<float, KernelImpl>(
+          src_buffer, init_buffer, absl::MakeSpan(dst_buffer), dimension,
+          src_shape, dst_shape)));
+    }
+    benchmark::DoNotOptimize(dst_buffer.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * src_shape.element_count());
+}
+
+static void BM_ReduceSumInnermostGeneric(benchmark::State& state) {
+  RunReduce<impl::SumKernel, false>(state, 1);
+}
+BENCHMARK(BM_ReduceSumInnermostGeneric)->Args({64, 1024})->Args({1024, 64});
+
+static void BM_ReduceSumInnermostBlocked(benchmark::State& state) {
+  RunReduce<impl::SumKernel, true>(state, 1);
+}
+BENCHMARK(BM_ReduceSumInnermostBlocked)->Args({64, 1024})->Args({1024, 64});
+
+static void BM_ReduceSumOuterGeneric(benchmark::State& state) {
+  RunReduce<impl::SumKernel, false>(state, 0);
+}
+BENCHMARK(BM_ReduceSumOuterGeneric)->Args({64, 1024})->Args({1024, 64});
+
+static void BM_ReduceSumOuterBlocked(benchmark::State& state) {
+  RunReduce<impl::SumKernel, true>(state, 0);
+}
+BENCHMARK(BM_ReduceSumOuterBlocked)->Args({64, 1024})->Args({1024, 64});
+
+static void BM_ReduceMaxInnermostGeneric(benchmark::State& state) {
+  RunReduce<impl::MaxKernel, false>(state, 1);
+}
+BENCHMARK(BM_ReduceMaxInnermostGeneric)->Args({64, 1024})->Args({1024, 64});
+
+static void BM_ReduceMaxInnermostBlocked(benchmark::State& state) {
+  RunReduce<impl::MaxKernel, true>(state, 1);
+}
+BENCHMARK(BM_ReduceMaxInnermostBlocked)->Args({64, 1024})->Args({1024, 64});
+
+static void BM_ReduceMaxOuterGeneric(benchmark::State& state) {
+  RunReduce<impl::MaxKernel, false>(state, 0);
+}
+BENCHMARK(BM_ReduceMaxOuterGeneric)->Args({64, 1024})->Args({1024, 64});
+
+static void BM_ReduceMaxOuterBlocked(benchmark::State& state) {
+  RunReduce<impl::MaxKernel, true>(state, 0);
+}
+BENCHMARK(BM_ReduceMaxOuterBlocked)->Args({64, 1024})->Args({1024, 64});
+
+// Transposes a float buffer of |src_shape| by |perm| with either the generic
+// (per-element index math) or blocked transpose.
+template <bool kBlocked>
+static void RunTranspose(benchmark::State& state, const Shape& src_shape,
+                         std::vector<int32_t> perm) {
+  std::vector<float> src_buffer(src_shape.element_count());
+  std::iota(src_buffer.begin(), src_buffer.end(), 0.0f);
+  std::vector<float> dst_buffer(src_buffer.size());
+  for (auto _ : state) {
+    if (kBlocked) {
+      CHECK_OK(impl::BlockedTranspose<float>(
+          src_buffer, absl::MakeSpan(dst_buffer), src_shape, perm));
+    } else {
+      CHECK_OK(impl::GenericTranspose<float>(
+          src_buffer, absl::MakeSpan(dst_buffer), src_shape, perm));
+    }
+    benchmark::DoNotOptimize(dst_buffer.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(state.iterations() * src_buffer.size() *
+                          sizeof(float));
+}
+
+static void BM_Transpose2DGeneric(benchmark::State& state) {
+  RunTranspose<false>(state, {512, 768}, {1, 0});
+}
+BENCHMARK(BM_Transpose2DGeneric);
+
+static void BM_Transpose2DBlocked(benchmark::State& state) {
+  RunTranspose<true>(state, {512, 768}, {1, 0});
+}
+BENCHMARK(BM_Transpose2DBlocked);
+
+static void BM_Transpose3DInnerSwapGeneric(benchmark::State& state) {
+  RunTranspose<false>(state, {64, 96, 128}, {0, 2, 1});
+}
+BENCHMARK(BM_Transpose3DInnerSwapGeneric);
+
+static void BM_Transpose3DInnerSwapBlocked(benchmark::State& state) {
+  RunTranspose<true>(state, {64, 96, 128}, {0, 2, 1});
+}
+BENCHMARK(BM_Transpose3DInnerSwapBlocked);
+
+static void BM_Transpose3DReverseGeneric(benchmark::State& state) {
+  RunTranspose<false>(state, {64, 96, 128}, {2, 1, 0});
+}
+BENCHMARK(BM_Transpose3DReverseGeneric);
+
+static void BM_Transpose3DReverseBlocked(benchmark::State& state) {
+  RunTranspose<true>(state, {64, 96, 128}, {2, 1, 0});
+}
+BENCHMARK(BM_Transpose3DReverseBlocked);
+
+// Attention heads: [batch, seq, heads, dim] -> [batch, heads, seq, dim].
+static void BM_Transpose4DSplitHeadsGeneric(benchmark::State& state) {
+  RunTranspose<false>(state, {8, 128, 12, 64}, {0, 2, 1, 3});
+}
+BENCHMARK(BM_Transpose4DSplitHeadsGeneric);
+
+static void BM_Transpose4DSplitHeadsBlocked(benchmark::State& state) {
+  RunTranspose<true>(state, {8, 128, 12, 64}, {0, 2, 1, 3});
+}
+BENCHMARK(BM_Transpose4DSplitHeadsBlocked);
+
+// Attention keys: [batch, seq, heads, dim] -> [batch, heads, dim, seq].
+static void BM_Transpose4DKeyTransposeGeneric(benchmark::State& state) {
+  RunTranspose<false>(state, {8, 128, 12, 64}, {0, 2, 3, 1});
+}
+BENCHMARK(BM_Transpose4DKeyTransposeGeneric);
+
+static void BM_Transpose4DKeyTransposeBlocked(benchmark::State& state) {
+  RunTranspose<true>(state, {8, 128, 12, 64}, {0, 2, 3, 1});
+}
+BENCHMARK(BM_Transpose4DKeyTransposeBlocked);
+
+// Applies |fn| to a float buffer of state.range(0) elements spanning
+// [-10, 10] (shifted to be positive for log).
+static void RunUnary(benchmark::State& state,
+                     void (*fn)(const float*, float*, size_t),
+                     bool positive_inputs = false) {
+  int count = state.range(0);
+  std::vector<float> src_buffer(count);
+  for (int i = 0; i < count; ++i) {
+    src_buffer[i] = -10.0f + 20.0f * i / count;
+    if (positive_inputs) src_buffer[i] += 10.5f;
+  }
+  std::vector<float> dst_buffer(count);
+  for (auto _ : state) {
+    fn(src_buffer.data(), dst_buffer.data(), count);
+    benchmark::DoNotOptimize(dst_buffer.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+
+static void LibmExp(const float* src, float* dst, size_t count) {
+  for (size_t i = 0; i < count; ++i) dst[i] = std::exp(src[i]);
+}
+static void LibmLog(const float* src, float* dst, size_t count) {
+  for (size_t i = 0; i < count; ++i) dst[i] = std::log(src[i]);
+}
+static void LibmTanh(const float* src, float* dst, size_t count) {
+  for (size_t i = 0; i < count; ++i) dst[i] = std::tanh(src[i]);
+}
+
+static void BM_ExpLibm(benchmark::State& state) { RunUnary(state, LibmExp); }
+BENCHMARK(BM_ExpLibm)->Arg(4096);
+
+static void BM_ExpScalar(benchmark::State& state) {
+  RunUnary(state, simd::scalar::kF32Kernels.exp);
+}
+BENCHMARK(BM_ExpScalar)->Arg(4096);
+
+static void BM_ExpSimd(benchmark::State& state) {
+  RunUnary(state, simd::GetF32Kernels().exp);
+}
+BENCHMARK(BM_ExpSimd)->Arg(4096);
+
+static void BM_LogLibm(benchmark::State& state) {
+  RunUnary(state, LibmLog, /*positive_inputs=*/true);
+}
+BENCHMARK(BM_LogLibm)->Arg(4096);
+
+static void BM_LogScalar(benchmark::State& state) {
+  RunUnary(state, simd::scalar::kF32Kernels.log, /*positive_inputs=*/true);
+}
+BENCHMARK(BM_LogScalar)->Arg(4096);
+
+static void BM_LogSimd(benchmark::State& state) {
+  RunUnary(state, simd::GetF32Kernels().log, /*positive_inputs=*/true);
+}
+BENCHMARK(BM_LogSimd)->Arg(4096);
+
+static void BM_TanhLibm(benchmark::State& state) { RunUnary(state, LibmTanh); }
+BENCHMARK(BM_TanhLibm)->Arg(4096);
+
+static void BM_TanhScalar(benchmark::State& state) {
+  RunUnary(state, simd::scalar::kF32Kernels.tanh);
+}
+BENCHMARK(BM_TanhScalar)->Arg(4096);
+
+static void BM_TanhSimd(benchmark::State& state) {
+  RunUnary(state, simd::GetF32Kernels().tanh);
+}
+BENCHMARK(BM_TanhSimd)->Arg(4096);
+
+// Adds two float buffers of state.range(0) elements.
+static void RunAdd(benchmark::State& state,
+                   void (*fn)(const float*, const float*, float*, size_t)) {
+  int count = state.range(0);
+  std::vector<float> lhs_buffer(count);
+  std::iota(lhs_buffer.begin(), lhs_buffer.end(), 0.0f);
+  std::vector<float> rhs_buffer = lhs_buffer;
+  std::vector<float> dst_buffer(count);
+  for (auto _ : state) {
+    fn(lhs_buffer.data(), rhs_buffer.data(), dst_buffer.data(), count);
+    benchmark::DoNotOptimize(dst_buffer.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+
+static void BM_AddScalar(benchmark::State& state) {
+  RunAdd(state, simd::scalar::kF32Kernels.add);
+}
+BENCHMARK(BM_AddScalar)->Arg(4096);
+
+static void BM_AddSimd(benchmark::State& state) {
+  RunAdd(state, simd::GetF32Kernels().add);
+}
+BENCHMARK(BM_AddSimd)->Arg(4096);
+
+// Evaluates tanh(a + b * c) - abs(a) over buffers of state.range(0) elements
+// either as separate kernels or as a single fused elementwise program.
+template <bool kFused>
+static void RunElementwiseChain(benchmark::State& state) {
+  int count = state.range(0);
+  std::vector<float> a_buffer(count);
+  std::iota(a_buffer.begin(), a_buffer.end(), -count / 2.0f);
+  std::vector<float> b_buffer(count, 0.5f);
+  std::vector<float> c_buffer(count, 0.001f);
+  std::vector<float> dst_buffer(count);
+  std::vector<float> mul_add_buffer(count);
+  std::vector<float> tanh_buffer(count);
+  std::vector<float> abs_buffer(count);
+  std::vector<int32_t> program = {
+      static_cast<int32_t>(InterpreterOpcode::kMulAddF), 0, 1, 2,
+      static_cast<int32_t>(InterpreterOpcode::kTanhF),   3,
+      static_cast<int32_t>(InterpreterOpcode::kAbsF),    0,
+      static_cast<int32_t>(InterpreterOpcode::kSubF),    4, 5,
+  };
+  std::vector<absl::Span<const float>> src_buffers = {a_buffer, b_buffer,
+                                                      c_buffer};
+  auto dst = absl::MakeSpan(dst_buffer);
+  for (auto _ : state) {
+    if (kFused) {
+      FusedElementwise::Execute<float>(src_buffers, program, dst);
+    } else {
+      MulAdd::Execute<float>(a_buffer, b_buffer, c_buffer,
+                             absl::MakeSpan(mul_add_buffer));
+      Tanh::Execute<float>(mul_add_buffer, absl::MakeSpan(tanh_buffer));
+      Abs::Execute<float>(a_buffer, absl::MakeSpan(abs_buffer));
+      Sub::Execute<float>(tanh_buffer, abs_buffer, dst);
+    }
+    benchmark::DoNotOptimize(dst_buffer.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+
+static void BM_ElementwiseChainUnfused(benchmark::State& state) {
+  RunElementwiseChain<false>(state);
+}
+BENCHMARK(BM_ElementwiseChainUnfused)->Arg(4096)->Arg(1 << 20);
+
+static void BM_ElementwiseChainFused(benchmark::State& state) {
+  RunElementwiseChain<true>(state);
+}
+BENCHMARK(BM_ElementwiseChainFused)->Arg(4096)->Arg(1 << 20);
+
+}  // namespace
+}  // namespace kernels
+}  // namespace hal
+}  // namespace iree
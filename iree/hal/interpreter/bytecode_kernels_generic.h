@@ -15,10 +15,22 @@
 #ifndef IREE_HAL_INTERPRETER_BYTECODE_KERNELS_GENERIC_H_
 #define IREE_HAL_INTERPRETER_BYTECODE_KERNELS_GENERIC_H_
 
+#include <algorithm>
+#include <numeric>
+#include <type_traits>
+#include <vector>
+
 #include "absl/container/flat_hash_set.h"
 #include "absl/container/inlined_vector.h"
 #include "absl/types/span.h"
 #include "iree/base/status.h"
+#include "iree/schemas/bytecode/interpreter_bytecode_v0.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif  // __SSE2__
 
 namespace iree {
 namespace hal {
@@ -144,14 +156,26 @@ Status Copy::Execute(absl::Span<const uint8_t> src_buffer,
     return OkStatus();
   }
 
-  // TODO(gcmn) Maybe we can fast-path earlier if we detect contiguous memory
-  // across multiple rows.
   auto src_strides = impl::ComputeCopyStrides(src_shape, element_size);
   auto dst_strides = impl::ComputeCopyStrides(dst_shape, element_size);
   DCHECK_EQ(src_strides.size(), lengths.size());
   DCHECK_EQ(dst_strides.size(), lengths.size());
-  impl::CopyRegion(src_buffer, src_strides, src_indices, dst_buffer,
-                   dst_strides, dst_indices, lengths);
+
+  // Trailing dimensions that are copied in full are contiguous in both
+  // buffers and are folded into the rows so that each memcpy covers as much
+  // memory as possible (a single memcpy for a fully contiguous region).
+  int row_dim = lengths.size() - 1;
+  while (row_dim > 0 && lengths[row_dim] == src_shape[row_dim] &&
+         lengths[row_dim] == dst_shape[row_dim]) {
+    --row_dim;
+  }
+  int region_rank = row_dim + 1;
+  impl::CopyRegion(src_buffer,
+                   absl::MakeConstSpan(src_strides).subspan(0, region_rank),
+                   src_indices.subspan(0, region_rank), dst_buffer,
+                   absl::MakeConstSpan(dst_strides).subspan(0, region_rank),
+                   dst_indices.subspan(0, region_rank),
+                   lengths.subspan(0, region_rank));
   return OkStatus();
 }
 
@@ -166,11 +190,14 @@ Status Select::Execute(absl::Span<const uint8_t> cond_buffer,
   return OkStatus();
 }
 
+namespace impl {
+
+// Transposes by computing the source index of every destination element.
+// Kept as a reference implementation for testing and benchmarking.
 template <typename T>
-Status Transpose::Execute(absl::Span<const T> src_buffer,
-                          absl::Span<T> dst_buffer, const Shape& src_shape,
-                          absl::Span<const int32_t> perm) {
-  // This implementation is .... not fast.
+Status GenericTranspose(absl::Span<const T> src_buffer,
+                        absl::Span<T> dst_buffer, const Shape& src_shape,
+                        absl::Span<const int32_t> perm) {
   int rank = src_shape.size();
   absl::InlinedVector<int, 8> src_strides(rank);
   absl::InlinedVector<int, 8> dst_strides(rank);
@@ -195,29 +222,275 @@ Status Transpose::Execute(absl::Span<const T> src_buffer,
   return OkStatus();
 }
 
-namespace impl {
-inline void IncrementShapeIndex(absl::Span<int32_t> indices,
-                                const Shape& shape) {
-  for (int i = indices.size() - 1; i >= 0; --i) {
-    if (++indices[i] < shape[i]) return;
-    indices[i] = 0;
-  }
-}
-
-inline bool IsPadding(absl::Span<const int32_t> indices, const Shape& shape,
-                      absl::Span<const int32_t> edge_padding_low,
-                      absl::Span<const int32_t> edge_padding_high,
-                      absl::Span<const int32_t> interior_padding) {
-  for (int i = 0; i < indices.size(); ++i) {
-    auto index = indices[i];
-    if (index < edge_padding_low[i] ||
-        index >= shape[i] - edge_padding_high[i] ||
-        (index - edge_padding_low[i]) % (interior_padding[i] + 1) != 0) {
-      return true;
+// Reduces a transpose of |src_shape| by |perm| to the smallest equivalent
+// transpose by dropping unit dimensions and merging runs of source dimensions
+// that remain adjacent and in order in the destination. For example a
+// [2, 3, 4, 5] transpose with perm [2, 3, 0, 1] is a [6, 20] transpose with
+// perm [1, 0].
+inline void CoalesceTranspose(const Shape& src_shape,
+                              absl::Span<const int32_t> perm,
+                              absl::InlinedVector<size_t, 8>* out_src_dims,
+                              absl::InlinedVector<int, 8>* out_perm) {
+  absl::InlinedVector<int, 8> squeezed_dims(src_shape.size(), -1);
+  int squeezed_rank = 0;
+  for (int i = 0; i < src_shape.size(); ++i) {
+    if (src_shape[i] != 1) squeezed_dims[i] = squeezed_rank++;
+  }
+
+  // Runs of squeezed source dimensions in destination order, as the first
+  // dimension of the run and the run's total size.
+  absl::InlinedVector<std::pair<int, size_t>, 8> runs;
+  int last_dim = -2;
+  for (int dst_i = 0; dst_i < perm.size(); ++dst_i) {
+    int dim = squeezed_dims[perm[dst_i]];
+    if (dim < 0) continue;
+    if (dim == last_dim + 1) {
+      runs.back().second *= src_shape[perm[dst_i]];
+    } else {
+      runs.push_back({dim, src_shape[perm[dst_i]]});
+    }
+    last_dim = dim;
+  }
+
+  // Renumber the runs by their order in the source.
+  absl::InlinedVector<int, 8> src_order(runs.size());
+  std::iota(src_order.begin(), src_order.end(), 0);
+  std::sort(src_order.begin(), src_order.end(), [&runs](int a, int b) {
+    return runs[a].first < runs[b].first;
+  });
+  out_src_dims->resize(runs.size());
+  out_perm->resize(runs.size());
+  for (int i = 0; i < runs.size(); ++i) {
+    (*out_src_dims)[i] = runs[src_order[i]].second;
+    (*out_perm)[src_order[i]] = i;
+  }
+}
+
+// Transposes a 4x4 block of 32-bit elements from |src| (rows |src_stride|
+// elements apart) into |dst| (rows |dst_stride| elements apart).
+template <typename T>
+inline void Transpose4x4(const T* src, size_t src_stride, T* dst,
+                         size_t dst_stride) {
+  static_assert(sizeof(T) == 4, "4x4 block transposes require 32-bit types");
+#if defined(__SSE2__)
+  // The shuffles only move bits so this is exact for integer types as well.
+  __m128 row0 = _mm_loadu_ps(reinterpret_cast<const float*>(src));
+  __m128 row1 = _mm_loadu_ps(reinterpret_cast<const float*>(src + src_stride));
+  __m128 row2 =
+      _mm_loadu_ps(reinterpret_cast<const float*>(src + 2 * src_stride));
+  __m128 row3 =
+      _mm_loadu_ps(reinterpret_cast<const float*>(src + 3 * src_stride));
+  _MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+  _mm_storeu_ps(reinterpret_cast<float*>(dst), row0);
+  _mm_storeu_ps(reinterpret_cast<float*>(dst + dst_stride), row1);
+  _mm_storeu_ps(reinterpret_cast<float*>(dst + 2 * dst_stride), row2);
+  _mm_storeu_ps(reinterpret_cast<float*>(dst + 3 * dst_stride), row3);
+#elif defined(__ARM_NEON)
+  uint32x4x2_t rows01 = vtrnq_u32(
+      vld1q_u32(reinterpret_cast<const uint32_t*>(src)),
+      vld1q_u32(reinterpret_cast<const uint32_t*>(src + src_stride)));
+  uint32x4x2_t rows23 = vtrnq_u32(
+      vld1q_u32(reinterpret_cast<const uint32_t*>(src + 2 * src_stride)),
+      vld1q_u32(reinterpret_cast<const uint32_t*>(src + 3 * src_stride)));
+  vst1q_u32(reinterpret_cast<uint32_t*>(dst),
+            vcombine_u32(vget_low_u32(rows01.val[0]),
+                         vget_low_u32(rows23.val[0])));
+  vst1q_u32(reinterpret_cast<uint32_t*>(dst + dst_stride),
+            vcombine_u32(vget_low_u32(rows01.val[1]),
+                         vget_low_u32(rows23.val[1])));
+  vst1q_u32(reinterpret_cast<uint32_t*>(dst + 2 * dst_stride),
+            vcombine_u32(vget_high_u32(rows01.val[0]),
+                         vget_high_u32(rows23.val[0])));
+  vst1q_u32(reinterpret_cast<uint32_t*>(dst + 3 * dst_stride),
+            vcombine_u32(vget_high_u32(rows01.val[1]),
+                         vget_high_u32(rows23.val[1])));
+#else
+  for (size_t i = 0; i < 4; ++i) {
+    for (size_t j = 0; j < 4; ++j) {
+      dst[j * dst_stride + i] = src[i * src_stride + j];
+    }
+  }
+#endif  // __SSE2__
+}
+
+// Transposes the leading multiple-of-4 rows of a [rows, cols] tile in 4x4
+// register blocks and returns the number of rows transposed. Only 32-bit
+// element types have a block transpose.
+template <typename T>
+inline size_t TransposeTileBlocks(const T* src, size_t src_stride, T* dst,
+                                  size_t dst_stride, size_t rows, size_t cols,
+                                  std::false_type) {
+  return 0;
+}
+template <typename T>
+inline size_t TransposeTileBlocks(const T* src, size_t src_stride, T* dst,
+                                  size_t dst_stride, size_t rows, size_t cols,
+                                  std::true_type) {
+  size_t row = 0;
+  for (; row + 4 <= rows; row += 4) {
+    const T* src_rows = src + row * src_stride;
+    size_t col = 0;
+    for (; col + 4 <= cols; col += 4) {
+      Transpose4x4(src_rows + col, src_stride, dst + col * dst_stride + row,
+                   dst_stride);
+    }
+    for (; col < cols; ++col) {
+      for (size_t i = 0; i < 4; ++i) {
+        dst[col * dst_stride + row + i] = src_rows[i * src_stride + col];
+      }
     }
   }
+  return row;
+}
+
+// Transposes a [rows, cols] tile of |src| into a [cols, rows] tile of |dst|.
+template <typename T>
+inline void TransposeTile(const T* src, size_t src_stride, T* dst,
+                          size_t dst_stride, size_t rows, size_t cols) {
+  size_t row = TransposeTileBlocks(
+      src, src_stride, dst, dst_stride, rows, cols,
+      std::integral_constant<bool, sizeof(T) == 4>());
+  for (; row < rows; ++row) {
+    for (size_t col = 0; col < cols; ++col) {
+      dst[col * dst_stride + row] = src[row * src_stride + col];
+    }
+  }
+}
 
-  return false;
+// Transposes a [rows, cols] plane of |src| into a [cols, rows] plane of |dst|
+// in square tiles sized such that the source and destination lines touched by
+// a tile stay resident in L1.
+template <typename T>
+inline void TransposePlane(const T* src, size_t src_stride, T* dst,
+                           size_t dst_stride, size_t rows, size_t cols) {
+  constexpr size_t kTileSize = 32;
+  for (size_t row = 0; row < rows; row += kTileSize) {
+    size_t tile_rows = std::min(kTileSize, rows - row);
+    for (size_t col = 0; col < cols; col += kTileSize) {
+      size_t tile_cols = std::min(kTileSize, cols - col);
+      TransposeTile(src + row * src_stride + col, src_stride,
+                    dst + col * dst_stride + row, dst_stride, tile_rows,
+                    tile_cols);
+    }
+  }
+}
+
+// Transposes by first coalescing the permutation and then either copying
+// contiguous rows (when the innermost dimension is unchanged) or transposing
+// the plane formed by the innermost source and destination dimensions in
+// cache-sized tiles for each index of the remaining outer dimensions.
+template <typename T>
+Status BlockedTranspose(absl::Span<const T> src_buffer,
+                        absl::Span<T> dst_buffer, const Shape& src_shape,
+                        absl::Span<const int32_t> perm) {
+  if (perm.size() != src_shape.size()) {
+    return InvalidArgumentErrorBuilder(IREE_LOC)
+           << "Permutation rank " << perm.size()
+           << " does not match source rank " << src_shape.size();
+  }
+  absl::InlinedVector<size_t, 8> dims;
+  absl::InlinedVector<int, 8> dims_perm;
+  if (src_buffer.empty()) return OkStatus();
+  CoalesceTranspose(src_shape, perm, &dims, &dims_perm);
+  int rank = dims.size();
+  if (rank <= 1) {
+    // Identity permutation (after dropping unit dimensions).
+    std::copy(src_buffer.begin(), src_buffer.end(), dst_buffer.begin());
+    return OkStatus();
+  }
+
+  absl::InlinedVector<size_t, 8> src_strides(rank);
+  absl::InlinedVector<size_t, 8> dst_strides(rank);
+  size_t src_stride = 1;
+  size_t dst_stride = 1;
+  for (int dim_i = rank - 1; dim_i >= 0; --dim_i) {
+    src_strides[dim_i] = src_stride;
+    dst_strides[dim_i] = dst_stride;
+    src_stride *= dims[dim_i];
+    dst_stride *= dims[dims_perm[dim_i]];
+  }
+
+  // If the innermost dimension is unchanged each step of the outer loop
+  // copies one contiguous row. Otherwise each step transposes the plane formed
+  // by the innermost source dimension and the source dimension that becomes
+  // innermost in the destination. The remaining destination dimensions are
+  // walked in order with running source and destination offsets.
+  bool copy_rows = dims_perm[rank - 1] == rank - 1;
+  int plane_row_dim = dims_perm[rank - 1];
+  int plane_col_dst_dim =
+      std::find(dims_perm.begin(), dims_perm.end(), rank - 1) -
+      dims_perm.begin();
+  size_t plane_rows = copy_rows ? 1 : dims[plane_row_dim];
+  size_t plane_cols = dims[rank - 1];
+  absl::InlinedVector<int, 8> outer_dst_dims;
+  for (int dst_i = 0; dst_i < rank - 1; ++dst_i) {
+    if (dst_i != plane_col_dst_dim) outer_dst_dims.push_back(dst_i);
+  }
+  absl::InlinedVector<size_t, 8> outer_indices(outer_dst_dims.size(), 0);
+  size_t outer_count = src_buffer.size() / (plane_rows * plane_cols);
+  size_t src_offset = 0;
+  size_t dst_offset = 0;
+  for (size_t outer_i = 0; outer_i < outer_count; ++outer_i) {
+    if (copy_rows) {
+      std::copy_n(src_buffer.data() + src_offset, plane_cols,
+                  dst_buffer.data() + dst_offset);
+    } else {
+      TransposePlane(src_buffer.data() + src_offset,
+                     src_strides[plane_row_dim],
+                     dst_buffer.data() + dst_offset,
+                     dst_strides[plane_col_dst_dim], plane_rows, plane_cols);
+    }
+    for (int i = outer_dst_dims.size() - 1; i >= 0; --i) {
+      int dst_i = outer_dst_dims[i];
+      int src_i = dims_perm[dst_i];
+      src_offset += src_strides[src_i];
+      dst_offset += dst_strides[dst_i];
+      if (++outer_indices[i] < dims[src_i]) break;
+      src_offset -= src_strides[src_i] * dims[src_i];
+      dst_offset -= dst_strides[dst_i] * dims[src_i];
+      outer_indices[i] = 0;
+    }
+  }
+  return OkStatus();
+}
+
+}  // namespace impl
+
+template <typename T>
+Status Transpose::Execute(absl::Span<const T> src_buffer,
+                          absl::Span<T> dst_buffer, const Shape& src_shape,
+                          absl::Span<const int32_t> perm) {
+  return impl::BlockedTranspose(src_buffer, dst_buffer, src_shape, perm);
+}
+
+namespace impl {
+// Copies the source of a pad into |dst|, which must already hold the padding
+// value, starting at |dim|. Dimensions after |row_dim| are not padded and are
+// copied as contiguous blocks of |inner_size| elements.
+template <typename T>
+void PadDimension(const T* src, T* dst, int dim, int row_dim,
+                  const Shape& src_shape, absl::Span<const size_t> src_strides,
+                  absl::Span<const size_t> dst_strides,
+                  absl::Span<const int32_t> edge_padding_low,
+                  absl::Span<const int32_t> interior_padding,
+                  size_t inner_size) {
+  T* dst_start = dst + edge_padding_low[dim] * dst_strides[dim];
+  size_t dst_step = (interior_padding[dim] + 1) * dst_strides[dim];
+  if (dim == row_dim) {
+    if (interior_padding[dim] == 0) {
+      std::copy_n(src, src_shape[dim] * inner_size, dst_start);
+    } else {
+      for (int i = 0; i < src_shape[dim]; ++i) {
+        std::copy_n(src + i * inner_size, inner_size, dst_start + i * dst_step);
+      }
+    }
+    return;
+  }
+  for (int i = 0; i < src_shape[dim]; ++i) {
+    PadDimension(src + i * src_strides[dim], dst_start + i * dst_step, dim + 1,
+                 row_dim, src_shape, src_strides, dst_strides,
+                 edge_padding_low, interior_padding, inner_size);
+  }
 }
 }  // namespace impl
 
@@ -229,14 +502,6 @@ Status Pad::Execute(absl::Span<const T> src_buffer,
                     absl::Span<const int32_t> edge_padding_low,
                     absl::Span<const int32_t> edge_padding_high,
                     absl::Span<const int32_t> interior_padding) {
-  // This implementation is not at all fast, as it iterates every index in the
-  // destination buffer individually. Potential improvements:
-  // 1. Fill the dst buffer with padded value initially. Only need to iterate
-  //    through source buffer and can exit early.
-  // 2. Use striding to advance through larger swaths of the buffer with a
-  //    memcpy from src and filling (or skipping) padded incides. Especially
-  //    useful when e.g. entire rows are padded.
-
   // TODO(b/140836672) support negative padding
 
   if (padding_value_buffer.size() != 1) {
@@ -245,21 +510,42 @@ Status Pad::Execute(absl::Span<const T> src_buffer,
   }
   auto padding_value = padding_value_buffer.front();
 
-  absl::InlinedVector<int, 8> dst_indices(src_shape.size(), 0);
+  // Fill all of the padding in bulk so that only the source rows need to be
+  // copied. Without padding every element is overwritten by the copy.
+  if (dst_buffer.size() != src_buffer.size()) {
+    std::fill(dst_buffer.begin(), dst_buffer.end(), padding_value);
+  }
+  if (src_buffer.empty()) return OkStatus();
+  int rank = src_shape.size();
+  if (rank == 0) {
+    dst_buffer[0] = src_buffer[0];
+    return OkStatus();
+  }
 
-  const T* src_ptr = src_buffer.begin();
-  T* dst_ptr = dst_buffer.begin();
-  while (dst_ptr != dst_buffer.end()) {
-    if (impl::IsPadding(dst_indices, dst_shape, edge_padding_low,
-                        edge_padding_high, interior_padding)) {
-      *dst_ptr++ = padding_value;
-    } else {
-      DCHECK(src_ptr != src_buffer.end());
-      *dst_ptr++ = *src_ptr++;
-    }
-    impl::IncrementShapeIndex(absl::MakeSpan(dst_indices), dst_shape);
+  // Trailing dimensions without any padding are identical in the source and
+  // destination and are copied along with the rows of the innermost padded
+  // dimension.
+  int row_dim = rank - 1;
+  size_t inner_size = 1;
+  while (row_dim > 0 && edge_padding_low[row_dim] == 0 &&
+         edge_padding_high[row_dim] == 0 && interior_padding[row_dim] == 0) {
+    inner_size *= src_shape[row_dim];
+    --row_dim;
   }
 
+  absl::InlinedVector<size_t, 8> src_strides(rank);
+  absl::InlinedVector<size_t, 8> dst_strides(rank);
+  size_t src_stride = 1;
+  size_t dst_stride = 1;
+  for (int dim_i = rank - 1; dim_i >= 0; --dim_i) {
+    src_strides[dim_i] = src_stride;
+    dst_strides[dim_i] = dst_stride;
+    src_stride *= src_shape[dim_i];
+    dst_stride *= dst_shape[dim_i];
+  }
+  impl::PadDimension(src_buffer.data(), dst_buffer.data(), 0, row_dim,
+                     src_shape, src_strides, dst_strides, edge_padding_low,
+                     interior_padding, inner_size);
   return OkStatus();
 }
 
@@ -294,19 +580,48 @@ Status Reverse::Execute(absl::Span<const T> src_buffer,
 template <typename T>
 Status Broadcast::Execute(absl::Span<const T> src_buffer,
                           absl::Span<T> dst_buffer) {
-  for (size_t i = 0; i < dst_buffer.size(); ++i) {
-    dst_buffer[i] = src_buffer[0];
-  }
+  std::fill(dst_buffer.begin(), dst_buffer.end(), src_buffer[0]);
   return OkStatus();
 }
 
+namespace impl {
+// Tiles |src| into the destination slab of |dim|. The first src_shape[dim]
+// slices are tiled recursively (or copied directly for the innermost
+// dimension) and the rest of the slab is filled with copies of that prefix.
+template <typename T>
+void TileDimension(const T* src, T* dst, int dim, const Shape& src_shape,
+                   const Shape& dst_shape, absl::Span<const size_t> src_strides,
+                   absl::Span<const size_t> dst_strides) {
+  size_t src_size = std::min(src_shape[dim], dst_shape[dim]);
+  if (dim == src_shape.size() - 1) {
+    std::copy_n(src, src_size, dst);
+  } else {
+    for (size_t i = 0; i < src_size; ++i) {
+      TileDimension(src + i * src_strides[dim], dst + i * dst_strides[dim],
+                    dim + 1, src_shape, dst_shape, src_strides, dst_strides);
+    }
+  }
+  size_t prefix_size = src_size * dst_strides[dim];
+  size_t slab_size = dst_shape[dim] * dst_strides[dim];
+  if (prefix_size == 0) return;
+  for (size_t offset = prefix_size; offset < slab_size;
+       offset += prefix_size) {
+    std::copy_n(dst, std::min(prefix_size, slab_size - offset), dst + offset);
+  }
+}
+}  // namespace impl
+
 template <typename T>
 Status Tile::Execute(absl::Span<const T> src_buffer, absl::Span<T> dst_buffer,
                      const Shape& src_shape, const Shape& dst_shape) {
-  // This implementation is .... not fast.
+  if (dst_buffer.empty()) return OkStatus();
   int rank = dst_shape.size();
-  absl::InlinedVector<int, 8> src_strides(rank);
-  absl::InlinedVector<int, 8> dst_strides(rank);
+  if (rank == 0) {
+    dst_buffer[0] = src_buffer[0];
+    return OkStatus();
+  }
+  absl::InlinedVector<size_t, 8> src_strides(rank);
+  absl::InlinedVector<size_t, 8> dst_strides(rank);
   size_t src_stride = 1;
   size_t dst_stride = 1;
   for (int dim_i = rank - 1; dim_i >= 0; --dim_i) {
@@ -315,15 +630,8 @@ Status Tile::Execute(absl::Span<const T> src_buffer, absl::Span<T> dst_buffer,
     src_stride *= src_shape[dim_i];
     dst_stride *= dst_shape[dim_i];
   }
-  for (size_t dst_i = 0; dst_i < dst_buffer.size(); ++dst_i) {
-    size_t src_i = 0;
-    size_t t = dst_i;
-    for (int dim_i = 0; dim_i < rank; ++dim_i) {
-      src_i += t / dst_strides[dim_i] % src_shape[dim_i] * src_strides[dim_i];
-      t %= dst_strides[dim_i];
-    }
-    dst_buffer[dst_i] = src_buffer[src_i];
-  }
+  impl::TileDimension(src_buffer.data(), dst_buffer.data(), 0, src_shape,
+                      dst_shape, src_strides, dst_strides);
   return OkStatus();
 }
 
@@ -408,6 +716,14 @@ Status Abs::Execute(absl::Span<const T> src_buffer, absl::Span<T> dst_buffer) {
   return OkStatus();
 }
 
+template <typename T>
+Status Neg::Execute(absl::Span<const T> src_buffer, absl::Span<T> dst_buffer) {
+  for (size_t i = 0; i < dst_buffer.size(); ++i) {
+    dst_buffer[i] = -src_buffer[i];
+  }
+  return OkStatus();
+}
+
 template <typename T>
 Status Mul::Execute(absl::Span<const T> lhs_buffer,
                     absl::Span<const T> rhs_buffer, absl::Span<T> dst_buffer) {
@@ -561,6 +877,192 @@ Status Ceil::Execute(absl::Span<const T> src_buffer, absl::Span<T> dst_buffer) {
   return OkStatus();
 }
 
+namespace impl {
+
+// Number of elements evaluated at a time by FusedElementwise. Intermediate
+// results of a block stay resident in the L1 cache.
+constexpr size_t kFusedElementwiseBlockSize = 512;
+
+// Returns the operand count of a fusable elementwise |opcode| or 0 if the
+// opcode cannot be fused.
+inline int GetFusedElementwiseArity(InterpreterOpcode opcode) {
+  switch (opcode) {
+    case InterpreterOpcode::kAbsF:
+    case InterpreterOpcode::kExpF:
+    case InterpreterOpcode::kLogF:
+    case InterpreterOpcode::kRsqrtF:
+    case InterpreterOpcode::kSqrtF:
+    case InterpreterOpcode::kCosF:
+    case InterpreterOpcode::kSinF:
+    case InterpreterOpcode::kTanhF:
+    case InterpreterOpcode::kFloorF:
+    case InterpreterOpcode::kCeilF:
+      return 1;
+    case InterpreterOpcode::kAddF:
+    case InterpreterOpcode::kSubF:
+    case InterpreterOpcode::kMulF:
+    case InterpreterOpcode::kDivF:
+    case InterpreterOpcode::kRemF:
+    case InterpreterOpcode::kAtan2F:
+    case InterpreterOpcode::kMinF:
+    case InterpreterOpcode::kMaxF:
+      return 2;
+    case InterpreterOpcode::kMulAddF:
+    case InterpreterOpcode::kClampF:
+      return 3;
+    default:
+      return 0;
+  }
+}
+
+template <typename T>
+Status ExecuteFusedElementwiseInstruction(
+    const FusedElementwise::Instruction& instruction,
+    absl::Span<const absl::Span<const T>> registers, absl::Span<T> dst) {
+  auto a = registers[instruction.operands[0]];
+  switch (instruction.opcode) {
+    case InterpreterOpcode::kAbsF:
+      return Abs::Execute<T>(a, dst);
+    case InterpreterOpcode::kExpF:
+      return Exp::Execute<T>(a, dst);
+    case InterpreterOpcode::kLogF:
+      return Log::Execute<T>(a, dst);
+    case InterpreterOpcode::kRsqrtF:
+      return Rsqrt::Execute<T>(a, dst);
+    case InterpreterOpcode::kSqrtF:
+      return Sqrt::Execute<T>(a, dst);
+    case InterpreterOpcode::kCosF:
+      return Cos::Execute<T>(a, dst);
+    case InterpreterOpcode::kSinF:
+      return Sin::Execute<T>(a, dst);
+    case InterpreterOpcode::kTanhF:
+      return Tanh::Execute<T>(a, dst);
+    case InterpreterOpcode::kFloorF:
+      return Floor::Execute<T>(a, dst);
+    case InterpreterOpcode::kCeilF:
+      return Ceil::Execute<T>(a, dst);
+    default:
+      break;
+  }
+  auto b = registers[instruction.operands[1]];
+  switch (instruction.opcode) {
+    case InterpreterOpcode::kAddF:
+      return Add::Execute<T>(a, b, dst);
+    case InterpreterOpcode::kSubF:
+      return Sub::Execute<T>(a, b, dst);
+    case InterpreterOpcode::kMulF:
+      return Mul::Execute<T>(a, b, dst);
+    case InterpreterOpcode::kDivF:
+      return Div::Execute<T>(a, b, dst);
+    case InterpreterOpcode::kRemF:
+      return Rem::Execute<T>(a, b, dst);
+    case InterpreterOpcode::kAtan2F:
+      return Atan2::Execute<T>(a, b, dst);
+    case InterpreterOpcode::kMinF:
+      return Min::Execute<T>(a, b, dst);
+    case InterpreterOpcode::kMaxF:
+      return Max::Execute<T>(a, b, dst);
+    default:
+      break;
+  }
+  auto c = registers[instruction.operands[2]];
+  switch (instruction.opcode) {
+    case InterpreterOpcode::kMulAddF:
+      return MulAdd::Execute<T>(a, b, c, dst);
+    case InterpreterOpcode::kClampF:
+      return Clamp::Execute<T>(a, b, c, dst);
+    default:
+      return UnimplementedErrorBuilder(IREE_LOC)
+             << "Unfusable opcode "
+             << static_cast<int>(instruction.opcode);
+  }
+}
+
+}  // namespace impl
+
+inline StatusOr<FusedElementwise::Instructions> FusedElementwise::Decode(
+    absl::Span<const int32_t> program, size_t src_count) {
+  Instructions instructions;
+  size_t register_count = src_count;
+  for (size_t pc = 0; pc < program.size(); ++register_count) {
+    Instruction instruction;
+    instruction.opcode = static_cast<InterpreterOpcode>(program[pc++]);
+    int arity = impl::GetFusedElementwiseArity(instruction.opcode);
+    if (!arity) {
+      return InvalidArgumentErrorBuilder(IREE_LOC)
+             << "Opcode " << program[pc - 1] << " cannot be fused";
+    } else if (pc + arity > program.size()) {
+      return InvalidArgumentErrorBuilder(IREE_LOC)
+             << "Fused elementwise program is truncated";
+    }
+    for (int i = 0; i < arity; ++i) {
+      int32_t operand = program[pc++];
+      if (operand < 0 || static_cast<size_t>(operand) >= register_count) {
+        return InvalidArgumentErrorBuilder(IREE_LOC)
+               << "Register " << operand << " used before definition";
+      }
+      instruction.operands[i] = operand;
+    }
+    instructions.push_back(instruction);
+  }
+  if (instructions.empty()) {
+    return InvalidArgumentErrorBuilder(IREE_LOC)
+           << "Fused elementwise program is empty";
+  }
+  return instructions;
+}
+
+inline size_t FusedElementwise::GetScratchSize(
+    absl::Span<const Instruction> instructions) {
+  // The last instruction writes directly to the destination.
+  if (instructions.empty()) return 0;
+  return (instructions.size() - 1) * impl::kFusedElementwiseBlockSize;
+}
+
+template <typename T>
+Status FusedElementwise::Execute(
+    absl::Span<const absl::Span<const T>> src_buffers,
+    absl::Span<const Instruction> instructions, absl::Span<T> scratch,
+    absl::Span<T> dst_buffer) {
+  if (scratch.size() < GetScratchSize(instructions)) {
+    return InvalidArgumentErrorBuilder(IREE_LOC)
+           << "Fused elementwise scratch of " << scratch.size()
+           << " elements is too small";
+  }
+
+  // Each instruction is applied to a block of elements before moving on to the
+  // next so that intermediates never round-trip through memory. The last
+  // instruction writes directly to the destination.
+  size_t block_size = impl::kFusedElementwiseBlockSize;
+  absl::InlinedVector<absl::Span<const T>, 16> registers(src_buffers.size() +
+                                                         instructions.size());
+  for (size_t offset = 0; offset < dst_buffer.size(); offset += block_size) {
+    size_t length = std::min(block_size, dst_buffer.size() - offset);
+    for (size_t i = 0; i < src_buffers.size(); ++i) {
+      registers[i] = src_buffers[i].subspan(offset, length);
+    }
+    for (size_t i = 0; i < instructions.size(); ++i) {
+      auto result = i + 1 == instructions.size()
+                        ? dst_buffer.subspan(offset, length)
+                        : scratch.subspan(i * block_size, length);
+      RETURN_IF_ERROR(impl::ExecuteFusedElementwiseInstruction<T>(
+          instructions[i], registers, result));
+      registers[src_buffers.size() + i] = result;
+    }
+  }
+  return OkStatus();
+}
+
+template <typename T>
+Status FusedElementwise::Execute(
+    absl::Span<const absl::Span<const T>> src_buffers,
+    absl::Span<const int32_t> program, absl::Span<T> dst_buffer) {
+  ASSIGN_OR_RETURN(auto instructions, Decode(program, src_buffers.size()));
+  std::vector<T> scratch(GetScratchSize(instructions));
+  return Execute<T>(src_buffers, instructions, absl::MakeSpan(scratch),
+                    dst_buffer);
+}
+
 template <typename SRC, typename DST>
 Status Convert::Execute(absl::Span<const SRC> src_buffer,
                         absl::Span<DST> dst_buffer) {
@@ -689,6 +1191,100 @@ Status GenericReduce(absl::Span<const T> src_buffer,
   return OkStatus();
 }
 
+// Reduces each contiguous row of a [outer_size, reduce_size] source into the
+// matching element of |dst|. Rows are accumulated into several independent
+// lanes to break the dependency chain on the accumulator so that the compiler
+// can vectorize the loop. Note that this reassociates floating-point sums.
+template <typename T, typename KernelImpl>
+inline void ReduceInnermostDimension(const T* src, T* dst, size_t outer_size,
+                                     size_t reduce_size) {
+  constexpr size_t kLaneCount = 8;
+  for (size_t outer_i = 0; outer_i < outer_size; ++outer_i) {
+    const T* src_row = src + outer_i * reduce_size;
+    size_t reduce_i = 0;
+    if (reduce_size >= 2 * kLaneCount) {
+      T lanes[kLaneCount];
+      std::copy_n(src_row, kLaneCount, lanes);
+      for (reduce_i = kLaneCount; reduce_i + kLaneCount <= reduce_size;
+           reduce_i += kLaneCount) {
+        for (size_t lane_i = 0; lane_i < kLaneCount; ++lane_i) {
+          KernelImpl()(&lanes[lane_i], src_row[reduce_i + lane_i]);
+        }
+      }
+      for (size_t lane_i = 0; lane_i < kLaneCount; ++lane_i) {
+        KernelImpl()(&dst[outer_i], lanes[lane_i]);
+      }
+    }
+    for (; reduce_i < reduce_size; ++reduce_i) {
+      KernelImpl()(&dst[outer_i], src_row[reduce_i]);
+    }
+  }
+}
+
+// Reduces the middle dimension of a [outer_size, reduce_size, inner_size]
+// source into a [outer_size, inner_size] destination. Each reduced slice is a
+// contiguous run that is accumulated elementwise into the destination row.
+// The inner dimension is processed in blocks so that the destination block
+// stays resident in cache while all slices are accumulated into it.
+template <typename T, typename KernelImpl>
+inline void ReduceOuterDimension(const T* src, T* dst, size_t outer_size,
+                                 size_t reduce_size, size_t inner_size) {
+  constexpr size_t kInnerBlockSize = 4096 / sizeof(T);
+  for (size_t outer_i = 0; outer_i < outer_size; ++outer_i) {
+    const T* src_slice = src + outer_i * reduce_size * inner_size;
+    T* dst_row = dst + outer_i * inner_size;
+    for (size_t block_i = 0; block_i < inner_size;
+         block_i += kInnerBlockSize) {
+      size_t block_size = std::min(kInnerBlockSize, inner_size - block_i);
+      T* dst_block = dst_row + block_i;
+      for (size_t reduce_i = 0; reduce_i < reduce_size; ++reduce_i) {
+        const T* src_block = src_slice + reduce_i * inner_size + block_i;
+        for (size_t i = 0; i < block_size; ++i) {
+          KernelImpl()(&dst_block[i], src_block[i]);
+        }
+      }
+    }
+  }
+}
+
+// Reduces |dimension| of |src_buffer| by viewing the source as a
+// [outer, reduce, inner] region and walking it in memory order, which avoids
+// the per-element index math of GenericReduce.
+template <typename T, typename KernelImpl>
+Status BlockedReduce(absl::Span<const T> src_buffer,
+                     absl::Span<const T> init_buffer, absl::Span<T> dst_buffer,
+                     int32_t dimension, const Shape& src_shape,
+                     const Shape& dst_shape) {
+  if (dimension < 0 || dimension >= src_shape.size()) {
+    return InvalidArgumentErrorBuilder(IREE_LOC)
+           << "Reduction dimension " << dimension
+           << " is out of range for rank " << src_shape.size();
+  }
+
+  // Initialize using init_buffer, which is expected to be a scalar.
+  std::fill_n(dst_buffer.data(), dst_buffer.size(), init_buffer[0]);
+
+  size_t outer_size = 1;
+  for (int i = 0; i < dimension; ++i) {
+    outer_size *= src_shape[i];
+  }
+  size_t reduce_size = src_shape[dimension];
+  size_t inner_size = 1;
+  for (int i = dimension + 1; i < src_shape.size(); ++i) {
+    inner_size *= src_shape[i];
+  }
+
+  if (inner_size == 1) {
+    ReduceInnermostDimension<T, KernelImpl>(src_buffer.data(),
+                                            dst_buffer.data(), outer_size,
+                                            reduce_size);
+  } else {
+    ReduceOuterDimension<T, KernelImpl>(src_buffer.data(), dst_buffer.data(),
+                                        outer_size, reduce_size, inner_size);
+  }
+  return OkStatus();
+}
+
 }  // namespace impl
 
 template <typename T>
@@ -696,7 +1292,7 @@ Status ReduceSum::Execute(absl::Span<const T> src_buffer,
                           absl::Span<const T> init_buffer,
                           absl::Span<T> dst_buffer, int32_t dimension,
                           const Shape& src_shape, const Shape& dst_shape) {
-  return impl::GenericReduce<T, impl::SumKernel>(
+  return impl::BlockedReduce<T, impl::SumKernel>(
       src_buffer, init_buffer, dst_buffer, dimension, src_shape, dst_shape);
 }
 
@@ -705,7 +1301,7 @@ Status ReduceMin::Execute(absl::Span<const T> src_buffer,
                           absl::Span<const T> init_buffer,
                           absl::Span<T> dst_buffer, int32_t dimension,
                           const Shape& src_shape, const Shape& dst_shape) {
-  return impl::GenericReduce<T, impl::MinKernel>(
+  return impl::BlockedReduce<T, impl::MinKernel>(
       src_buffer, init_buffer, dst_buffer, dimension, src_shape, dst_shape);
 }
 
@@ -714,7 +1310,7 @@ Status ReduceMax::Execute(absl::Span<const T> src_buffer,
                           absl::Span<const T> init_buffer,
                           absl::Span<T> dst_buffer, int32_t dimension,
                           const Shape& src_shape, const Shape& dst_shape) {
-  return impl::GenericReduce<T, impl::MaxKernel>(
+  return impl::BlockedReduce<T, impl::MaxKernel>(
       src_buffer, init_buffer, dst_buffer, dimension, src_shape, dst_shape);
 }
 
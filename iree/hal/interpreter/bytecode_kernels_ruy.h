@@ -15,8 +15,12 @@
 #ifndef IREE_HAL_INTERPRETER_BYTECODE_KERNELS_RUY_H_
 #define IREE_HAL_INTERPRETER_BYTECODE_KERNELS_RUY_H_
 
+#include <algorithm>
+#include <vector>
+
 #include "absl/base/thread_annotations.h"
 #include "absl/memory/memory.h"
+#include "absl/synchronization/mutex.h"
 #include "iree/base/status.h"
 #include "iree/hal/buffer_view.h"
 #include "tensorflow/lite/experimental/ruy/context.h"
@@ -29,12 +33,77 @@ namespace kernels {
 // TODO(benvanik): something more clever for making this shareable.
 // Maybe a factory fn based on the impl selected?
 struct MatMul::RuntimeState {
-  // TODO(benvanik): share the thread pool but keep context per-fiber?
-  ruy::Context context;
+  // State used by one matmul at a time. Each ruy context owns its worker
+  // threads and packing allocations so contexts are recycled across calls and
+  // only matmuls executing concurrently on different fibers require distinct
+  // contexts.
+  struct FiberContext {
+    ruy::Context context;
+    // Scratch storage for the transposed rhs, reused across calls.
+    std::vector<uint8_t> scratch;
+    // True for the single context that owns the shared ruy worker threads.
+    bool threaded = false;
+  };
+
+  // Returns a context for exclusive use by the caller until it is passed back
+  // to ReleaseContext.
+  //
+  // Only one context is ever allowed more than the calling thread, so the
+  // device-wide number of ruy worker threads is bounded by max_thread_count.
+  // Matmuls that execute while it is in use run single-threaded on their
+  // calling thread (which is already a thread pool worker). The threaded
+  // context gives up one thread for each other matmul in flight when it is
+  // acquired so that concurrent dispatches do not oversubscribe the cores.
+  std::unique_ptr<FiberContext> AcquireContext() {
+    absl::MutexLock lock(&mutex);
+    std::unique_ptr<FiberContext> fiber_context;
+    if (threaded_context) {
+      fiber_context = std::move(threaded_context);
+      fiber_context->context.max_num_threads =
+          std::max(1, max_thread_count - active_context_count);
+    } else if (!free_contexts.empty()) {
+      fiber_context = std::move(free_contexts.back());
+      free_contexts.pop_back();
+    } else {
+      fiber_context = absl::make_unique<FiberContext>();
+      fiber_context->context.max_num_threads = 1;
+    }
+    ++active_context_count;
+    return fiber_context;
+  }
+
+  void ReleaseContext(std::unique_ptr<FiberContext> fiber_context) {
+    absl::MutexLock lock(&mutex);
+    --active_context_count;
+    if (fiber_context->threaded) {
+      threaded_context = std::move(fiber_context);
+    } else if (free_contexts.size() < max_free_context_count) {
+      free_contexts.push_back(std::move(fiber_context));
+    }
+  }
+
+  // Maximum number of threads used by all matmuls combined, including the
+  // calling threads. Must be set before the first matmul executes.
+  int max_thread_count = 1;
+  // Maximum number of idle single-threaded contexts retained for reuse.
+  size_t max_free_context_count = 1;
+
+  absl::Mutex mutex;
+  std::unique_ptr<FiberContext> threaded_context ABSL_GUARDED_BY(mutex);
+  std::vector<std::unique_ptr<FiberContext>> free_contexts
+      ABSL_GUARDED_BY(mutex);
+  int active_context_count ABSL_GUARDED_BY(mutex) = 0;
 };
 
-inline std::unique_ptr<MatMul::RuntimeState> MatMul::CreateRuntimeState() {
-  return absl::make_unique<RuntimeState>();
+inline std::unique_ptr<MatMul::RuntimeState> MatMul::CreateRuntimeState(
+    int max_thread_count, int max_concurrency) {
+  auto runtime_state = absl::make_unique<RuntimeState>();
+  runtime_state->max_thread_count = std::max(1, max_thread_count);
+  runtime_state->max_free_context_count = std::max(1, max_concurrency);
+  runtime_state->threaded_context =
+      absl::make_unique<RuntimeState::FiberContext>();
+  runtime_state->threaded_context->threaded = true;
+  return runtime_state;
 }
 
 template <typename T>
@@ -131,54 +200,47 @@ template <typename T, typename ACC>
 Status MatMul::Execute(RuntimeState* runtime_state,
                        const Buffers<T, ACC>& buffers) {
   // Note that it is important to invoke RUY in RCC mode (LHS=Row Major,
-  // RHS=Col Major, Result=Col Major), which necessitates some transposes. This
-  // is not a long term solution and is just to get it on the optimized paths
-  // until the compiler can reason properly about layout and pre-packing, which
-  // is the anticipated future state. This is doing (A * B^T)^T.
-  // If needed, it can also be re-arranged to (B * A^T).
-  T* a_data;
-  int a_d0, a_d1;
-  T* b_data;
-  int b_d0, b_d1;
-  T* r_data;
-  int r_d0, r_d1;
-
-  bool transpose_dst = false;
-  T* temp1_buffer = nullptr;
-  T* temp2_buffer = nullptr;
+  // RHS=Col Major, Result=Col Major). This is done by computing
+  // (B^T * A^T) = (A * B)^T: a row-major A is a col-major A^T and a col-major
+  // result of (A * B)^T is the row-major A * B, so only B needs to be
+  // transposed. This also makes the ruy per-row bias and multipliers apply per
+  // column of the destination. This is not a long term solution and is just to
+  // get it on the optimized paths until the compiler can reason properly about
+  // layout and pre-packing, which is the anticipated future state.
+  int m = buffers.lhs_shape[0];
+  int k = buffers.lhs_shape[1];
+  int n = buffers.rhs_shape[1];
+
+  auto fiber_context = runtime_state->AcquireContext();
+  auto& scratch = fiber_context->scratch;
+  if (scratch.size() < n * k * sizeof(T)) {
+    scratch.resize(n * k * sizeof(T));
+  }
+  T* rhs_transposed = reinterpret_cast<T*>(scratch.data());
   {
-    // Do (A * B^T)^T
     IREE_TRACE_SCOPE0("MatMul#TransposeRhs");
-    // A = LHS
-    a_d0 = buffers.lhs_shape[0];
-    a_d1 = buffers.lhs_shape[1];
-    a_data = const_cast<T*>(buffers.lhs_buffer.data());
-    // B = RHS^T
-    b_d0 = buffers.rhs_shape[0];
-    b_d1 = buffers.rhs_shape[1];
-    b_data = temp1_buffer = new T[b_d0 * b_d1];
-    Transpose2D(b_d0, b_d1, buffers.rhs_buffer.data(), b_data);
-    // R
-    transpose_dst = true;
-    r_d0 = buffers.dst_shape[0];
-    r_d1 = buffers.dst_shape[1];
-    r_data = temp2_buffer = new T[r_d0 * r_d1];
+    Transpose2D(k, n, buffers.rhs_buffer.data(), rhs_transposed);
   }
 
-  ruy::Matrix<T> a_matrix;
-  ruy::MakeSimpleLayout(a_d0, a_d1, ruy::Order::kRowMajor, &a_matrix.layout);
-  a_matrix.data.set(a_data);
+  // B^T as an [n, k] row-major matrix.
+  ruy::Matrix<T> lhs_matrix;
+  ruy::MakeSimpleLayout(n, k, ruy::Order::kRowMajor, &lhs_matrix.layout);
+  lhs_matrix.data.set(rhs_transposed);
 
-  ruy::Matrix<T> b_matrix;
-  ruy::MakeSimpleLayout(b_d0, b_d1, ruy::Order::kColMajor, &b_matrix.layout);
-  b_matrix.data.set(b_data);
+  // A^T as a [k, m] col-major matrix.
+  ruy::Matrix<T> rhs_matrix;
+  ruy::MakeSimpleLayout(k, m, ruy::Order::kColMajor, &rhs_matrix.layout);
+  rhs_matrix.data.set(buffers.lhs_buffer.data());
 
-  ruy::Matrix<T> r_matrix;
-  ruy::MakeSimpleLayout(r_d0, r_d1, ruy::Order::kColMajor, &r_matrix.layout);
-  r_matrix.data.set(r_data);
+  // (A * B)^T as an [n, m] col-major matrix.
+  ruy::Matrix<T> dst_matrix;
+  ruy::MakeSimpleLayout(n, m, ruy::Order::kColMajor, &dst_matrix.layout);
+  dst_matrix.data.set(buffers.dst_buffer.data());
 
   ruy::BasicSpec<ACC, T> spec;
-  spec.bias = buffers.bias_buffer.data();
+  if (!buffers.bias_buffer.empty()) {
+    spec.bias = buffers.bias_buffer.data();
+  }
 
   if (buffers.multiplier_mantissa_buffer.size() == 1) {
     spec.multiplier_fixedpoint = buffers.multiplier_mantissa_buffer[0];
@@ -190,17 +252,9 @@ Status MatMul::Execute(RuntimeState* runtime_state,
         buffers.multiplier_exponent_buffer.data();
   }
 
-  ruy::Mul<ruy::kAllPaths>(a_matrix, b_matrix, spec, &runtime_state->context,
-                           &r_matrix);
-
-  if (transpose_dst) {
-    IREE_TRACE_SCOPE0("MatMul#TransposeDst");
-    // Dims reversed because it is written in col major and the transpose
-    // treats the dims as row major.
-    Transpose2D(r_d1, r_d0, r_data, buffers.dst_buffer.data());
-  }
-  delete[] temp1_buffer;
-  delete[] temp2_buffer;
+  ruy::Mul<ruy::kAllPaths>(lhs_matrix, rhs_matrix, spec,
+                           &fiber_context->context, &dst_matrix);
+  runtime_state->ReleaseContext(std::move(fiber_context));
 
   return OkStatus();
 }
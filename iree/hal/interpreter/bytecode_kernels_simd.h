@@ -0,0 +1,486 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// SIMD specializations of the float32 elementwise kernels.
+//
+// The kernels in bytecode_kernels_simd_math.h are written once against a small
+// vector type and instantiated for each instruction set available to the
+// compiler: scalar (always), SSE2, AVX2+FMA and NEON (aarch64). The AVX2
+// variant is compiled with a target pragma so that binaries built for baseline
+// x86-64 still use it; the best variant supported by the CPU is selected once
+// at runtime by GetF32Kernels.
+//
+// exp, log and tanh use polynomial approximations instead of libm. See
+// bytecode_kernels_simd_math.h for their error bounds.
+
+#ifndef IREE_HAL_INTERPRETER_BYTECODE_KERNELS_SIMD_H_
+#define IREE_HAL_INTERPRETER_BYTECODE_KERNELS_SIMD_H_
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "iree/base/status.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define IREE_HAL_INTERPRETER_SIMD_SSE2 1
+#if defined(__GNUC__) || defined(__clang__)
+#define IREE_HAL_INTERPRETER_SIMD_AVX2 1
+#endif  // __GNUC__ || __clang__
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#define IREE_HAL_INTERPRETER_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace iree {
+namespace hal {
+namespace kernels {
+namespace simd {
+
+// Table of float32 elementwise kernels for a single instruction set.
+// All buffers contain |count| elements and |dst| may alias any source.
+struct F32Kernels {
+  // Name of the instruction set, such as "avx2".
+  const char* name;
+  void (*add)(const float* lhs, const float* rhs, float* dst, size_t count);
+  void (*sub)(const float* lhs, const float* rhs, float* dst, size_t count);
+  void (*mul)(const float* lhs, const float* rhs, float* dst, size_t count);
+  void (*div)(const float* lhs, const float* rhs, float* dst, size_t count);
+  void (*min)(const float* lhs, const float* rhs, float* dst, size_t count);
+  void (*max)(const float* lhs, const float* rhs, float* dst, size_t count);
+  // dst = a + b * c. May be evaluated with a fused multiply-add.
+  void (*mul_add)(const float* a, const float* b, const float* c, float* dst,
+                  size_t count);
+  void (*abs)(const float* src, float* dst, size_t count);
+  void (*neg)(const float* src, float* dst, size_t count);
+  void (*sqrt)(const float* src, float* dst, size_t count);
+  void (*rsqrt)(const float* src, float* dst, size_t count);
+  void (*exp)(const float* src, float* dst, size_t count);
+  void (*log)(const float* src, float* dst, size_t count);
+  void (*tanh)(const float* src, float* dst, size_t count);
+};
+
+namespace scalar {
+
+constexpr char kName[] = "scalar";
+
+// Single-lane reference vector type. Vector types for the other instruction
+// sets must match these semantics lane-wise.
+struct Vec {
+  static constexpr size_t kWidth = 1;
+  using Mask = bool;
+
+  static Vec Load(const float* p) { return {*p}; }
+  static void Store(float* p, Vec a) { *p = a.v; }
+  static Vec Set(float value) { return {value}; }
+
+  static Vec Add(Vec a, Vec b) { return {a.v + b.v}; }
+  static Vec Sub(Vec a, Vec b) { return {a.v - b.v}; }
+  static Vec Mul(Vec a, Vec b) { return {a.v * b.v}; }
+  static Vec Div(Vec a, Vec b) { return {a.v / b.v}; }
+  // Returns |a| if a < b and otherwise |b| (including when either is NaN).
+  static Vec Min(Vec a, Vec b) { return {a.v < b.v ? a.v : b.v}; }
+  // Returns |a| if a > b and otherwise |b| (including when either is NaN).
+  static Vec Max(Vec a, Vec b) { return {a.v > b.v ? a.v : b.v}; }
+  // Returns a * b + c, possibly fused.
+  static Vec MulAdd(Vec a, Vec b, Vec c) { return {a.v * b.v + c.v}; }
+  static Vec Sqrt(Vec a) { return {std::sqrt(a.v)}; }
+  static Vec Abs(Vec a) { return {std::fabs(a.v)}; }
+  static Vec Neg(Vec a) { return {-a.v}; }
+
+  // Rounds to the nearest integer with ties to even. |a| must be within the
+  // int32 range.
+  static Vec Round(Vec a) { return {std::nearbyint(a.v)}; }
+  // Returns 2^n for integral |n| in [-126, 127].
+  static Vec Pow2(Vec n) {
+    uint32_t bits = static_cast<uint32_t>(static_cast<int32_t>(n.v) + 127)
+                    << 23;
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return {value};
+  }
+  // Splits a positive normal |a| into a mantissa in [0.5, 1) (returned) and an
+  // integral |exponent| such that a = mantissa * 2^exponent.
+  static Vec Frexp(Vec a, Vec* exponent) {
+    uint32_t bits;
+    std::memcpy(&bits, &a.v, sizeof(bits));
+    exponent->v = static_cast<float>(static_cast<int32_t>(bits >> 23) - 126);
+    bits = (bits & 0x807FFFFFu) | 0x3F000000u;
+    float mantissa;
+    std::memcpy(&mantissa, &bits, sizeof(mantissa));
+    return {mantissa};
+  }
+
+  static Mask Less(Vec a, Vec b) { return a.v < b.v; }
+  static Mask Equal(Vec a, Vec b) { return a.v == b.v; }
+  static Mask IsNan(Vec a) { return a.v != a.v; }
+  static Vec Select(Mask mask, Vec a, Vec b) { return mask ? a : b; }
+
+  float v;
+};
+
+#include "iree/hal/interpreter/bytecode_kernels_simd_math.h"  // NOLINT
+
+}  // namespace scalar
+
+#if defined(IREE_HAL_INTERPRETER_SIMD_SSE2)
+namespace sse2 {
+
+constexpr char kName[] = "sse2";
+
+struct Vec {
+  static constexpr size_t kWidth = 4;
+  using Mask = __m128;
+
+  static Vec Load(const float* p) { return {_mm_loadu_ps(p)}; }
+  static void Store(float* p, Vec a) { _mm_storeu_ps(p, a.v); }
+  static Vec Set(float value) { return {_mm_set1_ps(value)}; }
+
+  static Vec Add(Vec a, Vec b) { return {_mm_add_ps(a.v, b.v)}; }
+  static Vec Sub(Vec a, Vec b) { return {_mm_sub_ps(a.v, b.v)}; }
+  static Vec Mul(Vec a, Vec b) { return {_mm_mul_ps(a.v, b.v)}; }
+  static Vec Div(Vec a, Vec b) { return {_mm_div_ps(a.v, b.v)}; }
+  static Vec Min(Vec a, Vec b) { return {_mm_min_ps(a.v, b.v)}; }
+  static Vec Max(Vec a, Vec b) { return {_mm_max_ps(a.v, b.v)}; }
+  static Vec MulAdd(Vec a, Vec b, Vec c) {
+    return {_mm_add_ps(_mm_mul_ps(a.v, b.v), c.v)};
+  }
+  static Vec Sqrt(Vec a) { return {_mm_sqrt_ps(a.v)}; }
+  static Vec Abs(Vec a) { return {_mm_andnot_ps(_mm_set1_ps(-0.0f), a.v)}; }
+  static Vec Neg(Vec a) { return {_mm_xor_ps(_mm_set1_ps(-0.0f), a.v)}; }
+
+  static Vec Round(Vec a) {
+    return {_mm_cvtepi32_ps(_mm_cvtps_epi32(a.v))};
+  }
+  static Vec Pow2(Vec n) {
+    __m128i biased =
+        _mm_add_epi32(_mm_cvtps_epi32(n.v), _mm_set1_epi32(127));
+    return {_mm_castsi128_ps(_mm_slli_epi32(biased, 23))};
+  }
+  static Vec Frexp(Vec a, Vec* exponent) {
+    __m128i bits = _mm_castps_si128(a.v);
+    exponent->v = _mm_cvtepi32_ps(
+        _mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(126)));
+    bits = _mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x807FFFFF)),
+                        _mm_set1_epi32(0x3F000000));
+    return {_mm_castsi128_ps(bits)};
+  }
+
+  static Mask Less(Vec a, Vec b) { return _mm_cmplt_ps(a.v, b.v); }
+  static Mask Equal(Vec a, Vec b) { return _mm_cmpeq_ps(a.v, b.v); }
+  static Mask IsNan(Vec a) { return _mm_cmpunord_ps(a.v, a.v); }
+  static Vec Select(Mask mask, Vec a, Vec b) {
+    return {_mm_or_ps(_mm_and_ps(mask, a.v), _mm_andnot_ps(mask, b.v))};
+  }
+
+  __m128 v;
+};
+
+#include "iree/hal/interpreter/bytecode_kernels_simd_math.h"  // NOLINT
+
+}  // namespace sse2
+#endif  // IREE_HAL_INTERPRETER_SIMD_SSE2
+
+#if defined(IREE_HAL_INTERPRETER_SIMD_AVX2)
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2,fma"))), \
+                             apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx2,fma")
+#endif  // __clang__
+namespace avx2 {
+
+constexpr char kName[] = "avx2";
+
+struct Vec {
+  static constexpr size_t kWidth = 8;
+  using Mask = __m256;
+
+  static Vec Load(const float* p) { return {_mm256_loadu_ps(p)}; }
+  static void Store(float* p, Vec a) { _mm256_storeu_ps(p, a.v); }
+  static Vec Set(float value) { return {_mm256_set1_ps(value)}; }
+
+  static Vec Add(Vec a, Vec b) { return {_mm256_add_ps(a.v, b.v)}; }
+  static Vec Sub(Vec a, Vec b) { return {_mm256_sub_ps(a.v, b.v)}; }
+  static Vec Mul(Vec a, Vec b) { return {_mm256_mul_ps(a.v, b.v)}; }
+  static Vec Div(Vec a, Vec b) { return {_mm256_div_ps(a.v, b.v)}; }
+  static Vec Min(Vec a, Vec b) { return {_mm256_min_ps(a.v, b.v)}; }
+  static Vec Max(Vec a, Vec b) { return {_mm256_max_ps(a.v, b.v)}; }
+  static Vec MulAdd(Vec a, Vec b, Vec c) {
+    return {_mm256_fmadd_ps(a.v, b.v, c.v)};
+  }
+  static Vec Sqrt(Vec a) { return {_mm256_sqrt_ps(a.v)}; }
+  static Vec Abs(Vec a) {
+    return {_mm256_andnot_ps(_mm256_set1_ps(-0.0f), a.v)};
+  }
+  static Vec Neg(Vec a) { return {_mm256_xor_ps(_mm256_set1_ps(-0.0f), a.v)}; }
+
+  static Vec Round(Vec a) {
+    return {
+        _mm256_round_ps(a.v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC)};
+  }
+  static Vec Pow2(Vec n) {
+    __m256i biased =
+        _mm256_add_epi32(_mm256_cvtps_epi32(n.v), _mm256_set1_epi32(127));
+    return {_mm256_castsi256_ps(_mm256_slli_epi32(biased, 23))};
+  }
+  static Vec Frexp(Vec a, Vec* exponent) {
+    __m256i bits = _mm256_castps_si256(a.v);
+    exponent->v = _mm256_cvtepi32_ps(
+        _mm256_sub_epi32(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(126)));
+    bits = _mm256_or_si256(
+        _mm256_and_si256(bits, _mm256_set1_epi32(0x807FFFFF)),
+        _mm256_set1_epi32(0x3F000000));
+    return {_mm256_castsi256_ps(bits)};
+  }
+
+  static Mask Less(Vec a, Vec b) { return _mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ); }
+  static Mask Equal(Vec a, Vec b) {
+    return _mm256_cmp_ps(a.v, b.v, _CMP_EQ_OQ);
+  }
+  static Mask IsNan(Vec a) { return _mm256_cmp_ps(a.v, a.v, _CMP_UNORD_Q); }
+  static Vec Select(Mask mask, Vec a, Vec b) {
+    return {_mm256_blendv_ps(b.v, a.v, mask)};
+  }
+
+  __m256 v;
+};
+
+#include "iree/hal/interpreter/bytecode_kernels_simd_math.h"  // NOLINT
+
+}  // namespace avx2
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif  // __clang__
+#endif  // IREE_HAL_INTERPRETER_SIMD_AVX2
+
+#if defined(IREE_HAL_INTERPRETER_SIMD_NEON)
+namespace neon {
+
+constexpr char kName[] = "neon";
+
+struct Vec {
+  static constexpr size_t kWidth = 4;
+  using Mask = uint32x4_t;
+
+  static Vec Load(const float* p) { return {vld1q_f32(p)}; }
+  static void Store(float* p, Vec a) { vst1q_f32(p, a.v); }
+  static Vec Set(float value) { return {vdupq_n_f32(value)}; }
+
+  static Vec Add(Vec a, Vec b) { return {vaddq_f32(a.v, b.v)}; }
+  static Vec Sub(Vec a, Vec b) { return {vsubq_f32(a.v, b.v)}; }
+  static Vec Mul(Vec a, Vec b) { return {vmulq_f32(a.v, b.v)}; }
+  static Vec Div(Vec a, Vec b) { return {vdivq_f32(a.v, b.v)}; }
+  // vminq/vmaxq propagate NaN so the comparison is spelled out.
+  static Vec Min(Vec a, Vec b) {
+    return {vbslq_f32(vcltq_f32(a.v, b.v), a.v, b.v)};
+  }
+  static Vec Max(Vec a, Vec b) {
+    return {vbslq_f32(vcgtq_f32(a.v, b.v), a.v, b.v)};
+  }
+  static Vec MulAdd(Vec a, Vec b, Vec c) { return {vfmaq_f32(c.v, a.v, b.v)}; }
+  static Vec Sqrt(Vec a) { return {vsqrtq_f32(a.v)}; }
+  static Vec Abs(Vec a) { return {vabsq_f32(a.v)}; }
+  static Vec Neg(Vec a) { return {vnegq_f32(a.v)}; }
+
+  static Vec Round(Vec a) { return {vrndnq_f32(a.v)}; }
+  static Vec Pow2(Vec n) {
+    int32x4_t biased = vaddq_s32(vcvtq_s32_f32(n.v), vdupq_n_s32(127));
+    return {vreinterpretq_f32_s32(vshlq_n_s32(biased, 23))};
+  }
+  static Vec Frexp(Vec a, Vec* exponent) {
+    uint32x4_t bits = vreinterpretq_u32_f32(a.v);
+    exponent->v = vcvtq_f32_s32(vsubq_s32(
+        vreinterpretq_s32_u32(vshrq_n_u32(bits, 23)), vdupq_n_s32(126)));
+    bits = vorrq_u32(vandq_u32(bits, vdupq_n_u32(0x807FFFFFu)),
+                     vdupq_n_u32(0x3F000000u));
+    return {vreinterpretq_f32_u32(bits)};
+  }
+
+  static Mask Less(Vec a, Vec b) { return vcltq_f32(a.v, b.v); }
+  static Mask Equal(Vec a, Vec b) { return vceqq_f32(a.v, b.v); }
+  static Mask IsNan(Vec a) { return vmvnq_u32(vceqq_f32(a.v, a.v)); }
+  static Vec Select(Mask mask, Vec a, Vec b) {
+    return {vbslq_f32(mask, a.v, b.v)};
+  }
+
+  float32x4_t v;
+};
+
+#include "iree/hal/interpreter/bytecode_kernels_simd_math.h"  // NOLINT
+
+}  // namespace neon
+#endif  // IREE_HAL_INTERPRETER_SIMD_NEON
+
+// Returns the kernels for every instruction set supported by the current CPU,
+// from the least to the most preferred.
+inline std::vector<const F32Kernels*> GetSupportedF32Kernels() {
+  std::vector<const F32Kernels*> kernels = {&scalar::kF32Kernels};
+#if defined(IREE_HAL_INTERPRETER_SIMD_SSE2)
+  kernels.push_back(&sse2::kF32Kernels);
+#endif  // IREE_HAL_INTERPRETER_SIMD_SSE2
+#if defined(IREE_HAL_INTERPRETER_SIMD_AVX2)
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+    kernels.push_back(&avx2::kF32Kernels);
+  }
+#endif  // IREE_HAL_INTERPRETER_SIMD_AVX2
+#if defined(IREE_HAL_INTERPRETER_SIMD_NEON)
+  kernels.push_back(&neon::kF32Kernels);
+#endif  // IREE_HAL_INTERPRETER_SIMD_NEON
+  return kernels;
+}
+
+// Returns the preferred kernels for the current CPU.
+inline const F32Kernels& GetF32Kernels() {
+  static const F32Kernels* kernels = GetSupportedF32Kernels().back();
+  return *kernels;
+}
+
+}  // namespace simd
+
+template <>
+inline Status Add::Execute<float>(absl::Span<const float> lhs_buffer,
+                                  absl::Span<const float> rhs_buffer,
+                                  absl::Span<float> dst_buffer) {
+  simd::GetF32Kernels().add(lhs_buffer.data(), rhs_buffer.data(),
+                            dst_buffer.data(), dst_buffer.size());
+  return OkStatus();
+}
+
+template <>
+inline Status Sub::Execute<float>(absl::Span<const float> lhs_buffer,
+                                  absl::Span<const float> rhs_buffer,
+                                  absl::Span<float> dst_buffer) {
+  simd::GetF32Kernels().sub(lhs_buffer.data(), rhs_buffer.data(),
+                            dst_buffer.data(), dst_buffer.size());
+  return OkStatus();
+}
+
+template <>
+inline Status Abs::Execute<float>(absl::Span<const float> src_buffer,
+                                  absl::Span<float> dst_buffer) {
+  simd::GetF32Kernels().abs(src_buffer.data(), dst_buffer.data(),
+                            dst_buffer.size());
+  return OkStatus();
+}
+
+template <>
+inline Status Neg::Execute<float>(absl::Span<const float> src_buffer,
+                                  absl::Span<float> dst_buffer) {
+  simd::GetF32Kernels().neg(src_buffer.data(), dst_buffer.data(),
+                            dst_buffer.size());
+  return OkStatus();
+}
+
+template <>
+inline Status Mul::Execute<float>(absl::Span<const float> lhs_buffer,
+                                  absl::Span<const float> rhs_buffer,
+                                  absl::Span<float> dst_buffer) {
+  simd::GetF32Kernels().mul(lhs_buffer.data(), rhs_buffer.data(),
+                            dst_buffer.data(), dst_buffer.size());
+  return OkStatus();
+}
+
+template <>
+inline Status Div::Execute<float>(absl::Span<const float> lhs_buffer,
+                                  absl::Span<const float> rhs_buffer,
+                                  absl::Span<float> dst_buffer) {
+  simd::GetF32Kernels().div(lhs_buffer.data(), rhs_buffer.data(),
+                            dst_buffer.data(), dst_buffer.size());
+  return OkStatus();
+}
+
+template <>
+inline Status MulAdd::Execute<float>(absl::Span<const float> a_buffer,
+                                     absl::Span<const float> b_buffer,
+                                     absl::Span<const float> c_buffer,
+                                     absl::Span<float> dst_buffer) {
+  simd::GetF32Kernels().mul_add(a_buffer.data(), b_buffer.data(),
+                                c_buffer.data(), dst_buffer.data(),
+                                dst_buffer.size());
+  return OkStatus();
+}
+
+template <>
+inline Status Exp::Execute<float>(absl::Span<const float> src_buffer,
+                                  absl::Span<float> dst_buffer) {
+  simd::GetF32Kernels().exp(src_buffer.data(), dst_buffer.data(),
+                            dst_buffer.size());
+  return OkStatus();
+}
+
+template <>
+inline Status Log::Execute<float>(absl::Span<const float> src_buffer,
+                                  absl::Span<float> dst_buffer) {
+  simd::GetF32Kernels().log(src_buffer.data(), dst_buffer.data(),
+                            dst_buffer.size());
+  return OkStatus();
+}
+
+template <>
+inline Status Rsqrt::Execute<float>(absl::Span<const float> src_buffer,
+                                    absl::Span<float> dst_buffer) {
+  simd::GetF32Kernels().rsqrt(src_buffer.data(), dst_buffer.data(),
+                              dst_buffer.size());
+  return OkStatus();
+}
+
+template <>
+inline Status Sqrt::Execute<float>(absl::Span<const float> src_buffer,
+                                   absl::Span<float> dst_buffer) {
+  simd::GetF32Kernels().sqrt(src_buffer.data(), dst_buffer.data(),
+                             dst_buffer.size());
+  return OkStatus();
+}
+
+template <>
+inline Status Tanh::Execute<float>(absl::Span<const float> src_buffer,
+                                   absl::Span<float> dst_buffer) {
+  simd::GetF32Kernels().tanh(src_buffer.data(), dst_buffer.data(),
+                             dst_buffer.size());
+  return OkStatus();
+}
+
+template <>
+inline Status Min::Execute<float>(absl::Span<const float> lhs_buffer,
+                                  absl::Span<const float> rhs_buffer,
+                                  absl::Span<float> dst_buffer) {
+  simd::GetF32Kernels().min(lhs_buffer.data(), rhs_buffer.data(),
+                            dst_buffer.data(), dst_buffer.size());
+  return OkStatus();
+}
+
+template <>
+inline Status Max::Execute<float>(absl::Span<const float> lhs_buffer,
+                                  absl::Span<const float> rhs_buffer,
+                                  absl::Span<float> dst_buffer) {
+  simd::GetF32Kernels().max(lhs_buffer.data(), rhs_buffer.data(),
+                            dst_buffer.data(), dst_buffer.size());
+  return OkStatus();
+}
+
+}  // namespace kernels
+}  // namespace hal
+}  // namespace iree
+
+#endif  // IREE_HAL_INTERPRETER_BYTECODE_KERNELS_SIMD_H_
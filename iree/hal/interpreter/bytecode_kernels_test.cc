@@ -209,6 +209,69 @@ TEST(Copy, ScalarMultiByte) {
   EXPECT_EQ(dst_buffer_int32_t, expected_dst);
 }
 
+TEST(Transpose, Identity) {
+  Shape src_shape = {2, 3};
+  auto src_buffer = MakeIota<int32_t>(6);
+  std::vector<int32_t> perm = {0, 1};
+  std::vector<int32_t> dst_buffer(6);
+
+  EXPECT_OK(Transpose::Execute<int32_t>(src_buffer, absl::MakeSpan(dst_buffer),
+                                        src_shape, perm));
+  EXPECT_EQ(dst_buffer, src_buffer);
+}
+
+TEST(Transpose, TwoDimensions) {
+  Shape src_shape = {2, 3};
+  auto src_buffer = MakeIota<int32_t>(6);
+  std::vector<int32_t> perm = {1, 0};
+  std::vector<int32_t> dst_buffer(6);
+  std::vector<int32_t> expected_dst = {1, 4, 2, 5, 3, 6};
+
+  EXPECT_OK(Transpose::Execute<int32_t>(src_buffer, absl::MakeSpan(dst_buffer),
+                                        src_shape, perm));
+  EXPECT_EQ(dst_buffer, expected_dst);
+}
+
+TEST(Transpose, InnermostUnchanged) {
+  Shape src_shape = {2, 2, 2};
+  auto src_buffer = MakeIota<uint8_t>(8);
+  std::vector<int32_t> perm = {1, 0, 2};
+  std::vector<uint8_t> dst_buffer(8);
+  std::vector<uint8_t> expected_dst = {1, 2, 5, 6, 3, 4, 7, 8};
+
+  EXPECT_OK(Transpose::Execute<uint8_t>(src_buffer, absl::MakeSpan(dst_buffer),
+                                        src_shape, perm));
+  EXPECT_EQ(dst_buffer, expected_dst);
+}
+
+// Tests that the blocked transpose matches the generic transpose for every
+// permutation of shapes that are not multiples of the tile sizes and that
+// contain unit dimensions.
+template <typename T>
+void ExpectMatchesGenericTranspose(const Shape& src_shape) {
+  std::vector<T> src_buffer = MakeIota<T>(src_shape.element_count());
+  std::vector<int32_t> perm(src_shape.size());
+  std::iota(perm.begin(), perm.end(), 0);
+  do {
+    std::vector<T> dst_buffer(src_buffer.size());
+    std::vector<T> expected_dst(src_buffer.size());
+    EXPECT_OK(impl::GenericTranspose<T>(
+        src_buffer, absl::MakeSpan(expected_dst), src_shape, perm));
+    EXPECT_OK(Transpose::Execute<T>(src_buffer, absl::MakeSpan(dst_buffer),
+                                    src_shape, perm));
+    EXPECT_EQ(expected_dst, dst_buffer)
+        << "perm " << ::testing::PrintToString(perm);
+  } while (std::next_permutation(perm.begin(), perm.end()));
+}
+
+TEST(Transpose, MatchesGenericTranspose) {
+  ExpectMatchesGenericTranspose<float>({37, 70});
+  ExpectMatchesGenericTranspose<float>({3, 1, 9, 6});
+  ExpectMatchesGenericTranspose<int32_t>({2, 5, 1, 7, 3});
+  ExpectMatchesGenericTranspose<uint16_t>({33, 5, 34});
+  ExpectMatchesGenericTranspose<double>({4, 6, 5});
+}
+
 TEST(Pad, NoPadding) {
   Shape src_shape = {2, 3};
   auto src_buffer = MakeIota<uint16_t>(src_shape.element_count());
@@ -364,6 +427,43 @@ TEST(Pad, HighRank) {
   EXPECT_EQ(dst_buffer, expected_dst);
 }
 
+TEST(Broadcast, Scalar) {
+  std::vector<float> src_buffer = {3.5f};
+  std::vector<float> dst_buffer(5);
+  std::vector<float> expected_dst(5, 3.5f);
+
+  EXPECT_OK(Broadcast::Execute<float>(src_buffer, absl::MakeSpan(dst_buffer)));
+  EXPECT_EQ(dst_buffer, expected_dst);
+}
+
+TEST(Tile, Rows) {
+  Shape src_shape = {2, 2};
+  auto src_buffer = MakeIota<int32_t>(src_shape.element_count());
+  Shape dst_shape = {4, 2};
+  std::vector<int32_t> dst_buffer(dst_shape.element_count());
+  std::vector<int32_t> expected_dst = {1, 2, 3, 4, 1, 2, 3, 4};
+
+  EXPECT_OK(Tile::Execute<int32_t>(src_buffer, absl::MakeSpan(dst_buffer),
+                                   src_shape, dst_shape));
+  EXPECT_EQ(dst_buffer, expected_dst);
+}
+
+TEST(Tile, PartialTiles) {
+  Shape src_shape = {2, 3};
+  auto src_buffer = MakeIota<uint8_t>(src_shape.element_count());
+  Shape dst_shape = {3, 7};
+  std::vector<uint8_t> dst_buffer(dst_shape.element_count());
+  // clang-format off
+  std::vector<uint8_t> expected_dst = {1, 2, 3, 1, 2, 3, 1,
+                                       4, 5, 6, 4, 5, 6, 4,
+                                       1, 2, 3, 1, 2, 3, 1};
+  // clang-format on
+
+  EXPECT_OK(Tile::Execute<uint8_t>(src_buffer, absl::MakeSpan(dst_buffer),
+                                   src_shape, dst_shape));
+  EXPECT_EQ(dst_buffer, expected_dst);
+}
+
 TEST(ReduceSum, Scalar) {
   Shape src_shape = {5};
   int32_t dimension = 0;
@@ -400,6 +500,400 @@ TEST(ReduceMin, TwoDimensionsToOne) {
   }
 }
 
+TEST(ReduceMax, InnermostDimension) {
+  Shape src_shape = {2, 37};
+  int32_t dimension = 1;
+  Shape dst_shape = {2};
+  std::vector<float> src_buffer = MakeIota<float>(src_shape.element_count());
+  std::vector<float> init_buffer = {std::numeric_limits<float>::lowest()};
+  std::vector<float> dst_buffer(dst_shape.element_count(), 0.0f);
+  std::vector<float> expected_dst = {37.0f, 74.0f};
+
+  EXPECT_OK(ReduceMax::Execute<float>(src_buffer, init_buffer,
+                                      absl::MakeSpan(dst_buffer), dimension,
+                                      src_shape, dst_shape));
+
+  for (int i = 0; i < dst_buffer.size(); ++i) {
+    EXPECT_NEAR(expected_dst[i], dst_buffer[i], kEpsilon);
+  }
+}
+
+// Tests that the blocked reduction matches the generic reduction along every
+// dimension of a rank-3 shape.
+TEST(ReduceSum, MatchesGenericReduce) {
+  Shape src_shape = {3, 19, 5};
+  std::vector<int32_t> src_buffer =
+      MakeIota<int32_t>(src_shape.element_count());
+  std::vector<int32_t> init_buffer = {7};
+  for (int32_t dimension = 0; dimension < src_shape.size(); ++dimension) {
+    std::vector<int> dst_dims;
+    for (int i = 0; i < src_shape.size(); ++i) {
+      if (i != dimension) dst_dims.push_back(src_shape[i]);
+    }
+    Shape dst_shape(dst_dims.data(), dst_dims.size());
+    std::vector<int32_t> dst_buffer(dst_shape.element_count(), 0);
+    std::vector<int32_t> expected_dst(dst_shape.element_count(), 0);
+
+    EXPECT_OK((impl::GenericReduce<int32_t, impl::SumKernel>(
+        src_buffer, init_buffer, absl::MakeSpan(expected_dst), dimension,
+        src_shape, dst_shape)));
+    EXPECT_OK(ReduceSum::Execute<int32_t>(src_buffer, init_buffer,
+                                          absl::MakeSpan(dst_buffer),
+                                          dimension, src_shape, dst_shape));
+    EXPECT_EQ(expected_dst, dst_buffer) << "dimension " << dimension;
+  }
+}
+
+TEST(Neg, Float) {
+  std::vector<float> src_buffer = {1.0f, -2.0f, 0.0f, 4.5f};
+  std::vector<float> dst_buffer(src_buffer.size(), 0.0f);
+  std::vector<float> expected_dst = {-1.0f, 2.0f, 0.0f, -4.5f};
+
+  EXPECT_OK(Neg::Execute<float>(src_buffer, absl::MakeSpan(dst_buffer)));
+
+  for (int i = 0; i < dst_buffer.size(); ++i) {
+    EXPECT_NEAR(expected_dst[i], dst_buffer[i], kEpsilon);
+  }
+}
+
+// Expects |actual| to be within |max_ulps| float ulps of |expected|.
+void ExpectNearUlps(double expected, float actual, double max_ulps) {
+  float rounded = static_cast<float>(expected);
+  double ulp = std::nextafter(std::fabs(rounded),
+                              std::numeric_limits<float>::infinity()) -
+               std::fabs(rounded);
+  EXPECT_NEAR(expected, actual, max_ulps * ulp) << "expected " << expected;
+}
+
+TEST(SimdKernels, ExpAccuracy) {
+  std::vector<float> src_buffer;
+  for (float x = -87.0f; x < 88.5f; x += 0.0371f) src_buffer.push_back(x);
+  std::vector<float> dst_buffer(src_buffer.size());
+  for (const auto* kernels : simd::GetSupportedF32Kernels()) {
+    SCOPED_TRACE(kernels->name);
+    kernels->exp(src_buffer.data(), dst_buffer.data(), src_buffer.size());
+    for (int i = 0; i < src_buffer.size(); ++i) {
+      ExpectNearUlps(std::exp(static_cast<double>(src_buffer[i])),
+                     dst_buffer[i], 2.0);
+    }
+  }
+}
+
+TEST(SimdKernels, LogAccuracy) {
+  std::vector<float> src_buffer;
+  for (float x = 1e-37f; x < 1e38f; x *= 1.0137f) src_buffer.push_back(x);
+  std::vector<float> dst_buffer(src_buffer.size());
+  for (const auto* kernels : simd::GetSupportedF32Kernels()) {
+    SCOPED_TRACE(kernels->name);
+    kernels->log(src_buffer.data(), dst_buffer.data(), src_buffer.size());
+    for (int i = 0; i < src_buffer.size(); ++i) {
+      ExpectNearUlps(std::log(static_cast<double>(src_buffer[i])),
+                     dst_buffer[i], 1.0);
+    }
+  }
+}
+
+TEST(SimdKernels, TanhAccuracy) {
+  std::vector<float> src_buffer;
+  for (float x = -10.0f; x < 10.0f; x += 0.00731f) src_buffer.push_back(x);
+  std::vector<float> dst_buffer(src_buffer.size());
+  for (const auto* kernels : simd::GetSupportedF32Kernels()) {
+    SCOPED_TRACE(kernels->name);
+    kernels->tanh(src_buffer.data(), dst_buffer.data(), src_buffer.size());
+    for (int i = 0; i < src_buffer.size(); ++i) {
+      EXPECT_NEAR(std::tanh(static_cast<double>(src_buffer[i])),
+                  dst_buffer[i], 4e-7)
+          << "x = " << src_buffer[i];
+    }
+  }
+}
+
+TEST(SimdKernels, SpecialValues) {
+  const float kInf = std::numeric_limits<float>::infinity();
+  const float kNaN = std::numeric_limits<float>::quiet_NaN();
+  std::vector<float> src_buffer = {kNaN, -kInf, kInf, 0.0f, -0.0f,
+                                   1.0f, -1.0f, 89.0f, -200.0f};
+  std::vector<float> dst_buffer(src_buffer.size());
+  for (const auto* kernels : simd::GetSupportedF32Kernels()) {
+    SCOPED_TRACE(kernels->name);
+    kernels->exp(src_buffer.data(), dst_buffer.data(), src_buffer.size());
+    EXPECT_TRUE(std::isnan(dst_buffer[0]));
+    EXPECT_EQ(0.0f, dst_buffer[1]);
+    EXPECT_EQ(kInf, dst_buffer[2]);
+    EXPECT_EQ(1.0f, dst_buffer[3]);
+    EXPECT_EQ(1.0f, dst_buffer[4]);
+    EXPECT_EQ(kInf, dst_buffer[7]);
+    EXPECT_EQ(0.0f, dst_buffer[8]);
+
+    kernels->log(src_buffer.data(), dst_buffer.data(), src_buffer.size());
+    EXPECT_TRUE(std::isnan(dst_buffer[0]));
+    EXPECT_TRUE(std::isnan(dst_buffer[1]));
+    EXPECT_EQ(kInf, dst_buffer[2]);
+    EXPECT_EQ(-kInf, dst_buffer[3]);
+    EXPECT_EQ(-kInf, dst_buffer[4]);
+    EXPECT_EQ(0.0f, dst_buffer[5]);
+    EXPECT_TRUE(std::isnan(dst_buffer[6]));
+
+    kernels->tanh(src_buffer.data(), dst_buffer.data(), src_buffer.size());
+    EXPECT_TRUE(std::isnan(dst_buffer[0]));
+    EXPECT_EQ(-1.0f, dst_buffer[1]);
+    EXPECT_EQ(1.0f, dst_buffer[2]);
+    EXPECT_EQ(0.0f, dst_buffer[3]);
+    EXPECT_TRUE(std::signbit(dst_buffer[4]));
+    EXPECT_EQ(1.0f, dst_buffer[7]);
+    EXPECT_EQ(-1.0f, dst_buffer[8]);
+  }
+}
+
+// Tests that the exact kernels match C++ semantics for every length so that
+// the vector tails are covered.
+TEST(SimdKernels, MatchesScalarSemantics) {
+  std::vector<float> lhs_buffer = MakeIota<float>(37);
+  std::vector<float> rhs_buffer(lhs_buffer.size());
+  for (int i = 0; i < rhs_buffer.size(); ++i) {
+    rhs_buffer[i] = (i % 3 - 1) * 19.5f + 0.25f * i;
+  }
+  rhs_buffer[5] = std::numeric_limits<float>::quiet_NaN();
+  for (const auto* kernels : simd::GetSupportedF32Kernels()) {
+    SCOPED_TRACE(kernels->name);
+    for (size_t count = 0; count <= lhs_buffer.size(); ++count) {
+      std::vector<float> dst_buffer(count);
+      auto expect_binary = [&](void (*fn)(const float*, const float*, float*,
+                                          size_t),
+                               float (*reference)(float, float)) {
+        fn(lhs_buffer.data(), rhs_buffer.data(), dst_buffer.data(), count);
+        for (int i = 0; i < count; ++i) {
+          float expected = reference(lhs_buffer[i], rhs_buffer[i]);
+          EXPECT_EQ(::testing::PrintToString(expected),
+                    ::testing::PrintToString(dst_buffer[i]));
+        }
+      };
+      expect_binary(kernels->add, [](float a, float b) { return a + b; });
+      expect_binary(kernels->sub, [](float a, float b) { return a - b; });
+      expect_binary(kernels->mul, [](float a, float b) { return a * b; });
+      expect_binary(kernels->div, [](float a, float b) { return a / b; });
+      expect_binary(kernels->min,
+                    [](float a, float b) { return std::min(a, b); });
+      expect_binary(kernels->max,
+                    [](float a, float b) { return std::max(a, b); });
+
+      kernels->neg(rhs_buffer.data(), dst_buffer.data(), count);
+      for (int i = 0; i < count; ++i) {
+        EXPECT_EQ(::testing::PrintToString(-rhs_buffer[i]),
+                  ::testing::PrintToString(dst_buffer[i]));
+      }
+      kernels->sqrt(lhs_buffer.data(), dst_buffer.data(), count);
+      for (int i = 0; i < count; ++i) {
+        EXPECT_EQ(std::sqrt(lhs_buffer[i]), dst_buffer[i]);
+      }
+      kernels->mul_add(lhs_buffer.data(), lhs_buffer.data(), lhs_buffer.data(),
+                       dst_buffer.data(), count);
+      for (int i = 0; i < count; ++i) {
+        EXPECT_NEAR(lhs_buffer[i] + lhs_buffer[i] * lhs_buffer[i],
+                    dst_buffer[i], kEpsilon);
+      }
+    }
+  }
+}
+
+TEST(Tanh, Float) {
+  std::vector<float> src_buffer = {-2.0f, -0.5f, 0.0f, 0.25f, 3.0f};
+  std::vector<float> dst_buffer(src_buffer.size(), 0.0f);
+
+  EXPECT_OK(Tanh::Execute<float>(src_buffer, absl::MakeSpan(dst_buffer)));
+
+  for (int i = 0; i < dst_buffer.size(); ++i) {
+    EXPECT_NEAR(std::tanh(src_buffer[i]), dst_buffer[i], kEpsilon);
+  }
+}
+
+// Returns the row-major [m, n] product of row-major |lhs| [m, k] and |rhs|
+// [k, n] with |bias| added to each row when not empty.
+std::vector<float> ReferenceMatMul(int m, int k, int n,
+                                   absl::Span<const float> lhs,
+                                   absl::Span<const float> rhs,
+                                   absl::Span<const float> bias) {
+  std::vector<float> dst(m * n);
+  for (int i = 0; i < m; ++i) {
+    for (int j = 0; j < n; ++j) {
+      float acc = bias.empty() ? 0.0f : bias[j];
+      for (int p = 0; p < k; ++p) {
+        acc += lhs[i * k + p] * rhs[p * n + j];
+      }
+      dst[i * n + j] = acc;
+    }
+  }
+  return dst;
+}
+
+TEST(MatMul, NonSquare) {
+  // Distinct m, k, and n so that any transposed dimension is caught. k and n
+  // also cover both the blocked and the remainder paths of the transpose.
+  const int m = 3, k = 5, n = 6;
+  Shape lhs_shape = {m, k};
+  auto lhs_buffer = MakeIota<float>(m * k);
+  Shape rhs_shape = {k, n};
+  auto rhs_buffer = MakeIota<float>(k * n);
+  Shape dst_shape = {m, n};
+  std::vector<float> dst_buffer(m * n);
+  auto expected_dst =
+      ReferenceMatMul(m, k, n, lhs_buffer, rhs_buffer, /*bias=*/{});
+
+  auto mat_mul_state = MatMul::CreateRuntimeState();
+  MatMul::Buffers<float, float> buffers;
+  buffers.lhs_shape = lhs_shape;
+  buffers.lhs_buffer = lhs_buffer;
+  buffers.rhs_shape = rhs_shape;
+  buffers.rhs_buffer = rhs_buffer;
+  buffers.dst_shape = dst_shape;
+  buffers.dst_buffer = absl::MakeSpan(dst_buffer);
+  EXPECT_OK(MatMul::Execute(mat_mul_state.get(), buffers));
+  for (int i = 0; i < dst_buffer.size(); ++i) {
+    EXPECT_NEAR(expected_dst[i], dst_buffer[i], kEpsilon);
+  }
+}
+
+TEST(MatMul, NonSquareWithBias) {
+  const int m = 2, k = 3, n = 4;
+  Shape lhs_shape = {m, k};
+  auto lhs_buffer = MakeIota<float>(m * k);
+  Shape rhs_shape = {k, n};
+  auto rhs_buffer = MakeIota<float>(k * n);
+  // One distinct value per destination column.
+  std::vector<float> bias_buffer = {1.0f, -2.0f, 3.0f, -4.0f};
+  Shape dst_shape = {m, n};
+  std::vector<float> dst_buffer(m * n);
+  auto expected_dst =
+      ReferenceMatMul(m, k, n, lhs_buffer, rhs_buffer, bias_buffer);
+
+  auto mat_mul_state = MatMul::CreateRuntimeState();
+  MatMul::Buffers<float, float> buffers;
+  buffers.lhs_shape = lhs_shape;
+  buffers.lhs_buffer = lhs_buffer;
+  buffers.rhs_shape = rhs_shape;
+  buffers.rhs_buffer = rhs_buffer;
+  buffers.dst_shape = dst_shape;
+  buffers.dst_buffer = absl::MakeSpan(dst_buffer);
+  buffers.bias_buffer = bias_buffer;
+  EXPECT_OK(MatMul::Execute(mat_mul_state.get(), buffers));
+  for (int i = 0; i < dst_buffer.size(); ++i) {
+    EXPECT_NEAR(expected_dst[i], dst_buffer[i], kEpsilon);
+  }
+}
+
+TEST(MatMul, ConcurrentCallsShareThreads) {
+  auto mat_mul_state = MatMul::CreateRuntimeState(/*max_thread_count=*/4,
+                                                  /*max_concurrency=*/2);
+  // The first matmul gets all of the threads.
+  auto context_a = mat_mul_state->AcquireContext();
+  EXPECT_EQ(4, context_a->context.max_num_threads);
+  // Matmuls executing at the same time run on their calling thread only.
+  auto context_b = mat_mul_state->AcquireContext();
+  auto context_c = mat_mul_state->AcquireContext();
+  EXPECT_EQ(1, context_b->context.max_num_threads);
+  EXPECT_EQ(1, context_c->context.max_num_threads);
+  mat_mul_state->ReleaseContext(std::move(context_a));
+
+  // The threaded context leaves a thread for each matmul still in flight.
+  context_a = mat_mul_state->AcquireContext();
+  EXPECT_EQ(2, context_a->context.max_num_threads);
+  mat_mul_state->ReleaseContext(std::move(context_a));
+  mat_mul_state->ReleaseContext(std::move(context_b));
+  mat_mul_state->ReleaseContext(std::move(context_c));
+  context_a = mat_mul_state->AcquireContext();
+  EXPECT_EQ(4, context_a->context.max_num_threads);
+  mat_mul_state->ReleaseContext(std::move(context_a));
+}
+
+TEST(FusedElementwise, MatchesUnfusedKernels) {
+  // Long enough to cover several blocks and a partial trailing block.
+  const int count = 1500;
+  std::vector<float> a_buffer(count);
+  std::vector<float> b_buffer(count);
+  std::vector<float> c_buffer(count);
+  for (int i = 0; i < count; ++i) {
+    a_buffer[i] = (i % 97) * 0.05f - 2.0f;
+    b_buffer[i] = (i % 13) * 0.25f;
+    c_buffer[i] = (i % 7) * -0.5f;
+  }
+
+  // tanh(a + b * c) - abs(a)
+  std::vector<int32_t> program = {
+      static_cast<int32_t>(InterpreterOpcode::kMulAddF), 0, 1, 2,  // r3
+      static_cast<int32_t>(InterpreterOpcode::kTanhF),   3,        // r4
+      static_cast<int32_t>(InterpreterOpcode::kAbsF),    0,        // r5
+      static_cast<int32_t>(InterpreterOpcode::kSubF),    4, 5,     // r6
+  };
+  std::vector<absl::Span<const float>> src_buffers = {a_buffer, b_buffer,
+                                                      c_buffer};
+  std::vector<float> dst_buffer(count);
+  EXPECT_OK(FusedElementwise::Execute<float>(src_buffers, program,
+                                             absl::MakeSpan(dst_buffer)));
+
+  std::vector<float> mul_add_buffer(count);
+  std::vector<float> tanh_buffer(count);
+  std::vector<float> abs_buffer(count);
+  std::vector<float> expected_buffer(count);
+  EXPECT_OK(MulAdd::Execute<float>(a_buffer, b_buffer, c_buffer,
+                                   absl::MakeSpan(mul_add_buffer)));
+  EXPECT_OK(
+      Tanh::Execute<float>(mul_add_buffer, absl::MakeSpan(tanh_buffer)));
+  EXPECT_OK(Abs::Execute<float>(a_buffer, absl::MakeSpan(abs_buffer)));
+  EXPECT_OK(Sub::Execute<float>(tanh_buffer, abs_buffer,
+                                absl::MakeSpan(expected_buffer)));
+  EXPECT_EQ(expected_buffer, dst_buffer);
+}
+
+TEST(FusedElementwise, InvalidProgram) {
+  std::vector<float> src_buffer = {1.0f, 2.0f};
+  std::vector<absl::Span<const float>> src_buffers = {src_buffer};
+  std::vector<float> dst_buffer(src_buffer.size());
+  auto execute = [&](std::vector<int32_t> program) {
+    return FusedElementwise::Execute<float>(src_buffers, program,
+                                            absl::MakeSpan(dst_buffer));
+  };
+  auto add_f = static_cast<int32_t>(InterpreterOpcode::kAddF);
+  EXPECT_TRUE(IsInvalidArgument(execute({})));
+  EXPECT_TRUE(IsInvalidArgument(execute({add_f, 0})));
+  EXPECT_TRUE(IsInvalidArgument(execute({add_f, 0, 1})));
+  EXPECT_TRUE(IsInvalidArgument(
+      execute({static_cast<int32_t>(InterpreterOpcode::kMatMulF), 0, 0})));
+  EXPECT_OK(execute({add_f, 0, 0, add_f, 1, 0}));
+  EXPECT_EQ((std::vector<float>{3.0f, 6.0f}), dst_buffer);
+}
+
+TEST(FusedElementwise, DecodedProgramReusedAcrossTiles) {
+  const int count = 1500;
+  auto a_buffer = MakeIota<float>(count);
+  std::vector<absl::Span<const float>> src_buffers = {a_buffer};
+  auto add_f = static_cast<int32_t>(InterpreterOpcode::kAddF);
+  auto mul_f = static_cast<int32_t>(InterpreterOpcode::kMulF);
+  ASSERT_OK_AND_ASSIGN(auto instructions,
+                       FusedElementwise::Decode({add_f, 0, 0, mul_f, 1, 0},
+                                                src_buffers.size()));
+  ASSERT_EQ(2, instructions.size());
+
+  // Tiles share the decoded instructions and scratch storage.
+  std::vector<float> scratch(FusedElementwise::GetScratchSize(instructions));
+  std::vector<float> dst_buffer(count);
+  for (int offset = 0; offset < count; offset += 700) {
+    int length = std::min(700, count - offset);
+    std::vector<absl::Span<const float>> src_tiles = {
+        src_buffers[0].subspan(offset, length)};
+    EXPECT_OK(FusedElementwise::Execute<float>(
+        src_tiles, instructions, absl::MakeSpan(scratch),
+        absl::MakeSpan(dst_buffer).subspan(offset, length)));
+  }
+  for (int i = 0; i < count; ++i) {
+    EXPECT_EQ(2.0f * a_buffer[i] * a_buffer[i], dst_buffer[i]);
+  }
+
+  std::vector<float> small_scratch(scratch.size() - 1);
+  EXPECT_TRUE(IsInvalidArgument(FusedElementwise::Execute<float>(
+      src_buffers, instructions, absl::MakeSpan(small_scratch),
+      absl::MakeSpan(dst_buffer))));
+}
+
 }  // namespace
 }  // namespace kernels
 }  // namespace hal
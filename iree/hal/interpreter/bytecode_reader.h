@@ -19,6 +19,7 @@
 #include "absl/container/inlined_vector.h"
 #include "iree/base/status.h"
 #include "iree/hal/buffer_view.h"
+#include "iree/hal/interpreter/bytecode_decoder.h"
 #include "iree/hal/interpreter/stack.h"
 #include "iree/hal/interpreter/type.h"
 #include "iree/schemas/bytecode/interpreter_bytecode_v0.h"
@@ -26,75 +27,72 @@
 namespace iree {
 namespace hal {
 
+// Reads instructions from the pre-decoded form of a function (see
+// DecodedFunction). All operands were validated when the function was decoded
+// so reads are unchecked and only operations that touch buffer contents may
+// fail.
 class BytecodeReader {
  public:
-  int offset() const { return static_cast<int>(bytecode_pc_ - bytecode_base_); }
+  int offset() const { return static_cast<int>(code_pc_ - code_base_); }
 
-  StatusOr<const uint8_t*> AdvanceOffset();
+  ABSL_ATTRIBUTE_ALWAYS_INLINE uint8_t ReadOpcode() {
+    return static_cast<uint8_t>(ReadValue());
+  }
 
-  Status SwitchStackFrame(StackFrame* new_stack_frame);
-  Status BranchToOffset(int32_t offset);
+  // Switches to |new_stack_frame|, which must be for an internal function.
+  void SwitchStackFrame(StackFrame* new_stack_frame);
+  ABSL_ATTRIBUTE_ALWAYS_INLINE void BranchToOffset(uint32_t offset) {
+    code_pc_ = code_base_ + offset;
+  }
 
-  Status CopyInputsAndSwitchStackFrame(StackFrame* src_stack_frame,
-                                       StackFrame* dst_stack_frame);
+  void CopyInputsAndSwitchStackFrame(StackFrame* src_stack_frame,
+                                     StackFrame* dst_stack_frame);
   Status CopyResultsAndSwitchStackFrame(StackFrame* src_stack_frame,
                                         StackFrame* dst_stack_frame);
-  Status CopySlots();
+  void CopySlots();
 
   StatusOr<hal::BufferView> ReadConstant();
 
-  ABSL_ATTRIBUTE_ALWAYS_INLINE StatusOr<int> ReadCount() {
-    return ReadValue<uint8_t>();
-  }
+  ABSL_ATTRIBUTE_ALWAYS_INLINE int ReadCount() { return ReadValue(); }
 
-  ABSL_ATTRIBUTE_ALWAYS_INLINE StatusOr<const Type> ReadType() {
-    ASSIGN_OR_RETURN(uint8_t type_index, ReadValue<uint8_t>());
-    return Type::FromTypeIndex(type_index);
+  ABSL_ATTRIBUTE_ALWAYS_INLINE const Type ReadType() {
+    return Type::FromValidatedTypeIndex(static_cast<uint8_t>(ReadValue()));
   }
 
-  ABSL_ATTRIBUTE_ALWAYS_INLINE StatusOr<const Function> ReadFunction() {
-    ASSIGN_OR_RETURN(auto value, ReadValue<uint32_t>());
-    const auto& module = stack_frame_->module();
-    return module.LookupFunctionByOrdinal(Function::Linkage::kInternal, value);
+  ABSL_ATTRIBUTE_ALWAYS_INLINE const Function ReadFunction() {
+    return Function(&stack_frame_->module(), Function::Linkage::kInternal,
+                    ReadValue());
   }
 
-  ABSL_ATTRIBUTE_ALWAYS_INLINE StatusOr<hal::BufferView*> ReadLocal(
+  ABSL_ATTRIBUTE_ALWAYS_INLINE hal::BufferView* ReadLocal(
       Registers* registers) {
-    ASSIGN_OR_RETURN(auto value, ReadValue<uint16_t>());
-    if (value > registers->buffer_views.size()) {
-      return OutOfRangeErrorBuilder(IREE_LOC)
-             << "Out of bounds local access " << value << " of "
-             << registers->buffer_views.size();
-    }
-    return &registers->buffer_views[value];
+    return &registers->buffer_views[ReadValue()];
   }
 
-  ABSL_ATTRIBUTE_ALWAYS_INLINE StatusOr<hal::BufferView*> ReadLocal() {
+  ABSL_ATTRIBUTE_ALWAYS_INLINE hal::BufferView* ReadLocal() {
     return ReadLocal(registers_);
   }
 
-  Status SkipLocals(int count);
-
-  ABSL_ATTRIBUTE_ALWAYS_INLINE StatusOr<uint8_t> ReadUint8_t() {
-    return ReadValue<uint8_t>();
+  ABSL_ATTRIBUTE_ALWAYS_INLINE void SkipLocals(int count) {
+    code_pc_ += count;
   }
 
-  ABSL_ATTRIBUTE_ALWAYS_INLINE StatusOr<uint16_t> ReadUint16_t() {
-    return ReadValue<uint16_t>();
+  ABSL_ATTRIBUTE_ALWAYS_INLINE uint8_t ReadUint8_t() {
+    return static_cast<uint8_t>(ReadValue());
   }
 
-  ABSL_ATTRIBUTE_ALWAYS_INLINE StatusOr<int32_t> ReadInt32() {
-    return ReadValue<int32_t>();
+  ABSL_ATTRIBUTE_ALWAYS_INLINE int32_t ReadInt32() {
+    return static_cast<int32_t>(ReadValue());
   }
 
-  ABSL_ATTRIBUTE_ALWAYS_INLINE StatusOr<uint32_t> ReadBlockOffset() {
-    return ReadValue<uint32_t>();
+  ABSL_ATTRIBUTE_ALWAYS_INLINE uint32_t ReadBlockOffset() {
+    return ReadValue();
   }
 
   template <typename T, size_t N = 8>
   ABSL_ATTRIBUTE_ALWAYS_INLINE StatusOr<absl::InlinedVector<T, N>>
   ReadSlotElements() {
-    ASSIGN_OR_RETURN(auto* local, ReadLocal(registers_));
+    auto* local = ReadLocal(registers_);
     absl::InlinedVector<T, N> result(local->shape.element_count());
     if (sizeof(T) == local->element_size) {
       // Fast(ish) path: requested element size matches the actual element size.
@@ -127,26 +125,24 @@ class BytecodeReader {
     return result;
   }
 
-  Status ReadShape(Shape* out_shape);
-
   StatusOr<Shape> ReadShapePieces();
   StatusOr<Shape> ReadShapePieces(size_t* out_element_count);
 
-  StatusOr<absl::Span<const int32_t>> ReadIndexList();
+  ABSL_ATTRIBUTE_ALWAYS_INLINE absl::Span<const int32_t> ReadIndexList() {
+    int count = ReadCount();
+    auto list = absl::MakeConstSpan(
+        reinterpret_cast<const int32_t*>(code_pc_), count);
+    code_pc_ += count;
+    return list;
+  }
 
  private:
-  template <typename T>
-  ABSL_ATTRIBUTE_ALWAYS_INLINE StatusOr<T> ReadValue() {
-    // TODO(benvanik): validate bounds.
-    T value = *reinterpret_cast<const T*>(bytecode_pc_);
-    bytecode_pc_ += sizeof(T);
-    return value;
-  }
+  ABSL_ATTRIBUTE_ALWAYS_INLINE uint32_t ReadValue() { return *code_pc_++; }
 
   StackFrame* stack_frame_ = nullptr;
-  const uint8_t* bytecode_base_ = nullptr;
-  const uint8_t* bytecode_limit_ = nullptr;
-  const uint8_t* bytecode_pc_ = nullptr;
+  const DecodedFunction* function_ = nullptr;
+  const uint32_t* code_base_ = nullptr;
+  const uint32_t* code_pc_ = nullptr;
   Registers* registers_ = nullptr;
 };
 
@@ -0,0 +1,111 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/hal/interpreter/constant_pool.h"
+
+#include <cstring>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "iree/base/tracing.h"
+#include "iree/hal/heap_buffer.h"
+
+namespace iree {
+namespace hal {
+
+constexpr device_size_t ConstantPool::kEagerSplatByteLength;
+
+// static
+StatusOr<std::unique_ptr<ConstantPool>> ConstantPool::Create(
+    absl::Span<const DecodedFunction> functions) {
+  IREE_TRACE_SCOPE0("ConstantPool::Create");
+
+  auto constant_pool = absl::WrapUnique(new ConstantPool());
+  constant_pool->function_offsets_.resize(functions.size());
+  int32_t entry_count = 0;
+  for (int i = 0; i < functions.size(); ++i) {
+    constant_pool->function_offsets_[i] = entry_count;
+    entry_count += functions[i].constants.size();
+  }
+  constant_pool->entries_ = absl::make_unique<Entry[]>(entry_count);
+
+  int32_t entry_index = 0;
+  for (const auto& function : functions) {
+    for (const auto& constant : function.constants) {
+      auto& entry = constant_pool->entries_[entry_index++];
+      entry.constant = &constant;
+      device_size_t byte_length =
+          constant.shape.element_count() * constant.type.element_size();
+      if (constant.encoding == ConstantEncoding::kSplat &&
+          byte_length > kEagerSplatByteLength) {
+        continue;
+      }
+      RETURN_IF_ERROR(Materialize(entry));
+    }
+  }
+
+  return constant_pool;
+}
+
+ConstantPool::~ConstantPool() = default;
+
+// static
+Status ConstantPool::Materialize(const Entry& entry) {
+  absl::call_once(entry.once, [&entry]() {
+    IREE_TRACE_SCOPE0("ConstantPool::Materialize");
+    const auto& constant = *entry.constant;
+    auto& buffer_view = entry.buffer_view;
+    buffer_view.element_size = constant.type.element_size();
+    buffer_view.shape = constant.shape;
+    switch (constant.encoding) {
+      case ConstantEncoding::kDense:
+        buffer_view.buffer = HeapBuffer::Wrap(
+            MemoryType::kHostLocal, BufferUsage::kAll, constant.data.data(),
+            constant.data.size());
+        break;
+      case ConstantEncoding::kSplat: {
+        // Broadcast into a staging copy so that the pooled buffer can be
+        // allocated read-only.
+        size_t element_size = constant.data.size();
+        std::vector<uint8_t> contents(buffer_view.byte_length());
+        for (size_t offset = 0; offset < contents.size();
+             offset += element_size) {
+          std::memcpy(contents.data() + offset, constant.data.data(),
+                      element_size);
+        }
+        buffer_view.buffer =
+            HeapBuffer::AllocateCopy(BufferUsage::kAll, MemoryAccess::kRead,
+                                     contents.data(), contents.size());
+        break;
+      }
+      default:
+        entry.status = UnimplementedErrorBuilder(IREE_LOC)
+                       << "Unimplemented constant encoding "
+                       << static_cast<int>(constant.encoding);
+        break;
+    }
+  });
+  return entry.status;
+}
+
+StatusOr<BufferView> ConstantPool::GetConstant(int32_t function_ordinal,
+                                               int32_t constant_index) const {
+  const auto& entry =
+      entries_[function_offsets_[function_ordinal] + constant_index];
+  RETURN_IF_ERROR(Materialize(entry));
+  return entry.buffer_view;
+}
+
+}  // namespace hal
+}  // namespace iree
@@ -0,0 +1,77 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef IREE_HAL_INTERPRETER_CONSTANT_POOL_H_
+#define IREE_HAL_INTERPRETER_CONSTANT_POOL_H_
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "absl/base/call_once.h"
+#include "absl/types/span.h"
+#include "iree/base/status.h"
+#include "iree/hal/buffer_view.h"
+#include "iree/hal/interpreter/bytecode_decoder.h"
+
+namespace iree {
+namespace hal {
+
+// Immutable buffers for the constants of all functions in a module.
+//
+// Each constant is materialized once and every execution receives a view of
+// the same read-only buffer. Dense constants alias the module bytecode. Splat
+// constants are broadcast into their own buffer; small ones when the pool is
+// created and larger ones the first time they are used so that rarely taken
+// paths do not hold on to memory.
+//
+// Thread-safe.
+class ConstantPool {
+ public:
+  // Splats with a byte length up to this are materialized by Create.
+  static constexpr device_size_t kEagerSplatByteLength = 64 * 1024;
+
+  // Creates a pool for the constants of |functions|, indexed by internal
+  // function ordinal. |functions| must outlive the pool.
+  static StatusOr<std::unique_ptr<ConstantPool>> Create(
+      absl::Span<const DecodedFunction> functions);
+
+  ~ConstantPool();
+
+  // Returns a view of constant |constant_index| of the function with internal
+  // ordinal |function_ordinal|. The view must not be written.
+  StatusOr<BufferView> GetConstant(int32_t function_ordinal,
+                                   int32_t constant_index) const;
+
+ private:
+  struct Entry {
+    const DecodedConstant* constant = nullptr;
+    mutable absl::once_flag once;
+    mutable Status status;
+    mutable BufferView buffer_view;
+  };
+
+  ConstantPool() = default;
+
+  static Status Materialize(const Entry& entry);
+
+  std::unique_ptr<Entry[]> entries_;
+  // Index of the first entry of each function.
+  std::vector<int32_t> function_offsets_;
+};
+
+}  // namespace hal
+}  // namespace iree
+
+#endif  // IREE_HAL_INTERPRETER_CONSTANT_POOL_H_
@@ -0,0 +1,146 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/hal/interpreter/constant_pool.h"
+
+#include <cstring>
+#include <vector>
+
+#include "iree/base/status.h"
+#include "iree/base/status_matchers.h"
+#include "iree/testing/gtest.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+using ::testing::Each;
+using ::testing::ElementsAre;
+
+template <typename T>
+DecodedConstant MakeConstant(BuiltinType builtin_type, Shape shape,
+                             ConstantEncoding encoding,
+                             absl::Span<const T> data) {
+  DecodedConstant constant;
+  constant.type = Type::FromBuiltin(builtin_type);
+  constant.shape = shape;
+  constant.encoding = encoding;
+  constant.data = absl::MakeConstSpan(
+      reinterpret_cast<const uint8_t*>(data.data()), data.size() * sizeof(T));
+  return constant;
+}
+
+template <typename T>
+std::vector<T> ReadContents(const BufferView& buffer_view) {
+  std::vector<T> contents(buffer_view.shape.element_count());
+  EXPECT_OK(buffer_view.buffer->ReadData(0, contents.data(),
+                                         contents.size() * sizeof(T)));
+  return contents;
+}
+
+TEST(ConstantPoolTest, DenseConstantsAliasData) {
+  const int32_t data[] = {1, 2, 3, 4};
+  std::vector<DecodedFunction> functions(1);
+  functions[0].constants.push_back(MakeConstant<int32_t>(
+      BuiltinType::kI32, Shape({2, 2}), ConstantEncoding::kDense, data));
+  ASSERT_OK_AND_ASSIGN(auto constant_pool, ConstantPool::Create(functions));
+
+  ASSERT_OK_AND_ASSIGN(auto buffer_view, constant_pool->GetConstant(0, 0));
+  EXPECT_EQ(Shape({2, 2}), buffer_view.shape);
+  EXPECT_EQ(4, buffer_view.element_size);
+  EXPECT_THAT(ReadContents<int32_t>(buffer_view), ElementsAre(1, 2, 3, 4));
+  ASSERT_OK_AND_ASSIGN(auto mapping, buffer_view.buffer->MapMemory<int32_t>(
+                                         MemoryAccess::kRead));
+  EXPECT_EQ(data, mapping.data());
+}
+
+TEST(ConstantPoolTest, SplatConstantsAreBroadcast) {
+  const uint8_t i8_value[] = {7};
+  const uint16_t i16_value[] = {0x1234};
+  const float f32_value[] = {1.5f};
+  const int64_t i64_value[] = {0x123456789LL};
+  std::vector<DecodedFunction> functions(1);
+  auto& constants = functions[0].constants;
+  constants.push_back(MakeConstant<uint8_t>(
+      BuiltinType::kI8, Shape({3}), ConstantEncoding::kSplat, i8_value));
+  constants.push_back(MakeConstant<uint16_t>(
+      BuiltinType::kI16, Shape({5}), ConstantEncoding::kSplat, i16_value));
+  constants.push_back(MakeConstant<float>(
+      BuiltinType::kF32, Shape({2, 3}), ConstantEncoding::kSplat, f32_value));
+  constants.push_back(MakeConstant<int64_t>(
+      BuiltinType::kI64, Shape({4}), ConstantEncoding::kSplat, i64_value));
+  ASSERT_OK_AND_ASSIGN(auto constant_pool, ConstantPool::Create(functions));
+
+  ASSERT_OK_AND_ASSIGN(auto i8_view, constant_pool->GetConstant(0, 0));
+  EXPECT_THAT(ReadContents<uint8_t>(i8_view), ElementsAre(7, 7, 7));
+  ASSERT_OK_AND_ASSIGN(auto i16_view, constant_pool->GetConstant(0, 1));
+  EXPECT_THAT(ReadContents<uint16_t>(i16_view), Each(0x1234));
+  ASSERT_OK_AND_ASSIGN(auto f32_view, constant_pool->GetConstant(0, 2));
+  EXPECT_EQ(6, f32_view.shape.element_count());
+  EXPECT_THAT(ReadContents<float>(f32_view), Each(1.5f));
+  ASSERT_OK_AND_ASSIGN(auto i64_view, constant_pool->GetConstant(0, 3));
+  EXPECT_THAT(ReadContents<int64_t>(i64_view), Each(0x123456789LL));
+}
+
+TEST(ConstantPoolTest, ConstantsAreSharedAndReadOnly) {
+  const float value[] = {2.0f};
+  std::vector<DecodedFunction> functions(1);
+  functions[0].constants.push_back(MakeConstant<float>(
+      BuiltinType::kF32, Shape({16}), ConstantEncoding::kSplat, value));
+  ASSERT_OK_AND_ASSIGN(auto constant_pool, ConstantPool::Create(functions));
+
+  ASSERT_OK_AND_ASSIGN(auto first_view, constant_pool->GetConstant(0, 0));
+  ASSERT_OK_AND_ASSIGN(auto second_view, constant_pool->GetConstant(0, 0));
+  EXPECT_EQ(first_view.buffer.get(), second_view.buffer.get());
+  EXPECT_FALSE(first_view.buffer->Fill32(0.0f).ok());
+  EXPECT_THAT(ReadContents<float>(second_view), Each(2.0f));
+}
+
+TEST(ConstantPoolTest, LargeSplatsAreMaterializedOnUse) {
+  const float value[] = {3.0f};
+  int32_t element_count =
+      ConstantPool::kEagerSplatByteLength / sizeof(float) + 1;
+  std::vector<DecodedFunction> functions(1);
+  functions[0].constants.push_back(
+      MakeConstant<float>(BuiltinType::kF32, Shape({element_count}),
+                          ConstantEncoding::kSplat, value));
+  ASSERT_OK_AND_ASSIGN(auto constant_pool, ConstantPool::Create(functions));
+
+  ASSERT_OK_AND_ASSIGN(auto buffer_view, constant_pool->GetConstant(0, 0));
+  EXPECT_EQ(element_count * sizeof(float), buffer_view.byte_length());
+  EXPECT_THAT(ReadContents<float>(buffer_view), Each(3.0f));
+}
+
+TEST(ConstantPoolTest, IndexedByFunctionOrdinal) {
+  const int32_t first_value[] = {1};
+  const int32_t second_value[] = {2};
+  const int32_t third_value[] = {3};
+  std::vector<DecodedFunction> functions(3);
+  functions[0].constants.push_back(MakeConstant<int32_t>(
+      BuiltinType::kI32, Shape({1}), ConstantEncoding::kDense, first_value));
+  functions[2].constants.push_back(MakeConstant<int32_t>(
+      BuiltinType::kI32, Shape({1}), ConstantEncoding::kDense, second_value));
+  functions[2].constants.push_back(MakeConstant<int32_t>(
+      BuiltinType::kI32, Shape({1}), ConstantEncoding::kDense, third_value));
+  ASSERT_OK_AND_ASSIGN(auto constant_pool, ConstantPool::Create(functions));
+
+  ASSERT_OK_AND_ASSIGN(auto first_view, constant_pool->GetConstant(0, 0));
+  EXPECT_THAT(ReadContents<int32_t>(first_view), ElementsAre(1));
+  ASSERT_OK_AND_ASSIGN(auto third_view, constant_pool->GetConstant(2, 1));
+  EXPECT_THAT(ReadContents<int32_t>(third_view), ElementsAre(3));
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
@@ -28,8 +28,10 @@ namespace hal {
 
 InterpreterCommandProcessor::InterpreterCommandProcessor(
     Allocator* allocator, CommandBufferModeBitfield mode,
-    CommandCategoryBitfield command_categories)
-    : HostLocalCommandProcessor(allocator, mode, command_categories) {}
+    CommandCategoryBitfield command_categories,
+    kernels::RuntimeState* kernel_runtime_state)
+    : HostLocalCommandProcessor(allocator, mode, command_categories),
+      kernel_runtime_state_(kernel_runtime_state) {}
 
 InterpreterCommandProcessor::~InterpreterCommandProcessor() = default;
 
@@ -56,8 +58,12 @@ Status InterpreterCommandProcessor::Dispatch(
   }
   absl::InlinedVector<BufferView, 8> results;
 
+  // NOTE: legacy executables compute the entire workload in a single
+  // invocation; kernels within the function are split into tiles across the
+  // device thread pool (see kernels::RuntimeState::thread_pool).
   RETURN_IF_ERROR(executable->module()->Execute(
-      &stack, entry_function, std::move(arguments), &results));
+      kernel_runtime_state_, &stack, entry_function, std::move(arguments),
+      &results));
 
   return OkStatus();
 }
@@ -16,6 +16,7 @@
 #define IREE_HAL_INTERPRETER_INTERPRETER_COMMAND_PROCESSOR_H_
 
 #include "iree/hal/host/host_local_command_processor.h"
+#include "iree/hal/interpreter/bytecode_kernels.h"
 
 namespace iree {
 namespace hal {
@@ -24,10 +25,14 @@ class InterpreterCommandProcessor final : public HostLocalCommandProcessor {
  public:
   InterpreterCommandProcessor(Allocator* allocator,
                               CommandBufferModeBitfield mode,
-                              CommandCategoryBitfield command_categories);
+                              CommandCategoryBitfield command_categories,
+                              kernels::RuntimeState* kernel_runtime_state);
   ~InterpreterCommandProcessor() override;
 
   Status Dispatch(const DispatchRequest& dispatch_request) override;
+
+ private:
+  kernels::RuntimeState* kernel_runtime_state_;
 };
 
 }  // namespace hal
@@ -45,10 +45,13 @@ namespace {
 // that is dependent on how it is performing its synchronization.
 class UnsynchronizedCommandQueue final : public CommandQueue {
  public:
-  UnsynchronizedCommandQueue(Allocator* allocator, std::string name,
+  UnsynchronizedCommandQueue(Allocator* allocator,
+                             kernels::RuntimeState* kernel_runtime_state,
+                             std::string name,
                              CommandCategoryBitfield supported_categories)
       : CommandQueue(std::move(name), supported_categories),
-        allocator_(allocator) {}
+        allocator_(allocator),
+        kernel_runtime_state_(kernel_runtime_state) {}
   ~UnsynchronizedCommandQueue() override = default;
 
   Status Submit(absl::Span<const SubmissionBatch> batches,
@@ -85,22 +88,50 @@ class UnsynchronizedCommandQueue final : public CommandQueue {
       auto* inproc_command_buffer =
           static_cast<InProcCommandBuffer*>(command_buffer->impl());
       InterpreterCommandProcessor command_processor(
-          allocator_, command_buffer->mode(), supported_categories());
-      RETURN_IF_ERROR(inproc_command_buffer->Process(&command_processor));
+          allocator_, command_buffer->mode(), supported_categories(),
+          kernel_runtime_state_);
+      RETURN_IF_ERROR(inproc_command_buffer->Process(
+          &command_processor, kernel_runtime_state_->thread_pool));
     }
     return OkStatus();
   }
 
   Allocator* const allocator_;
+  kernels::RuntimeState* const kernel_runtime_state_;
 };
 
 }  // namespace
 
-InterpreterDevice::InterpreterDevice(DeviceInfo device_info)
+InterpreterDevice::InterpreterDevice(DeviceInfo device_info, Options options)
     : Device(std::move(device_info)) {
-  // We currently only expose a single command queue.
+  if (options.pool_allocations) {
+    allocator_ = make_ref<PooledHostLocalAllocator>();
+  } else {
+    allocator_ = make_ref<HostLocalAllocator>();
+  }
+
+  int worker_count = options.worker_count < 0
+                         ? HostThreadPool::GetDefaultWorkerCount()
+                         : options.worker_count;
+  thread_pool_ = absl::make_unique<HostThreadPool>(worker_count);
+  int matmul_thread_count = options.matmul_thread_count < 0
+                                ? thread_pool_->concurrency()
+                                : options.matmul_thread_count;
+  kernel_runtime_state_.mat_mul_state =
+      kernels::MatMul::CreateRuntimeState(matmul_thread_count,
+                                          thread_pool_->concurrency());
+
+  BytecodeCache::Options cache_options;
+  cache_options.persistent_cache_path = options.executable_cache_path;
+  executable_cache_ =
+      make_ref<BytecodeCache>(allocator_.get(), std::move(cache_options));
+  kernel_runtime_state_.thread_pool = thread_pool_.get();
+
+  // We currently only expose a single command queue. Dispatches recorded
+  // without barriers between them are executed concurrently on the device
+  // thread pool and share the (thread-safe) kernel runtime state.
   auto command_queue = absl::make_unique<UnsynchronizedCommandQueue>(
-      &allocator_, "cpu0",
+      allocator_.get(), &kernel_runtime_state_, "cpu0",
       CommandCategory::kTransfer | CommandCategory::kDispatch);
 
   // TODO(benvanik): allow injection of the wrapper type to support
@@ -113,7 +144,7 @@ InterpreterDevice::InterpreterDevice(DeviceInfo device_info)
 InterpreterDevice::~InterpreterDevice() = default;
 
 ref_ptr<ExecutableCache> InterpreterDevice::CreateExecutableCache() {
-  return make_ref<BytecodeCache>(&allocator_);
+  return add_ref(executable_cache_);
 }
 
 StatusOr<ref_ptr<CommandBuffer>> InterpreterDevice::CreateCommandBuffer(
@@ -121,7 +152,7 @@ StatusOr<ref_ptr<CommandBuffer>> InterpreterDevice::CreateCommandBuffer(
     CommandCategoryBitfield command_categories) {
   // TODO(b/140026716): conditionally enable validation.
   auto impl =
-      make_ref<InProcCommandBuffer>(&allocator_, mode, command_categories);
+      make_ref<InProcCommandBuffer>(allocator_.get(), mode, command_categories);
   return WrapCommandBufferWithValidation(std::move(impl));
 }
 
@@ -138,10 +169,7 @@ StatusOr<ref_ptr<BinarySemaphore>> InterpreterDevice::CreateBinarySemaphore(
 StatusOr<ref_ptr<TimelineSemaphore>> InterpreterDevice::CreateTimelineSemaphore(
     uint64_t initial_value) {
   IREE_TRACE_SCOPE0("InterpreterDevice::CreateTimelineSemaphore");
-
-  // TODO(b/140141417): implement timeline semaphores.
-  return UnimplementedErrorBuilder(IREE_LOC)
-         << "Timeline semaphores not yet implemented";
+  return make_ref<HostTimelineSemaphore>(initial_value);
 }
 
 StatusOr<ref_ptr<Fence>> InterpreterDevice::CreateFence(
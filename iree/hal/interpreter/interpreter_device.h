@@ -15,11 +15,16 @@
 #ifndef IREE_HAL_INTERPRETER_INTERPRETER_DEVICE_H_
 #define IREE_HAL_INTERPRETER_INTERPRETER_DEVICE_H_
 
+#include <string>
+
 #include "absl/container/inlined_vector.h"
 #include "absl/types/span.h"
 #include "iree/base/memory.h"
 #include "iree/hal/device.h"
 #include "iree/hal/host/host_local_allocator.h"
+#include "iree/hal/host/host_thread_pool.h"
+#include "iree/hal/host/pooled_host_local_allocator.h"
+#include "iree/hal/interpreter/bytecode_cache.h"
 #include "iree/hal/interpreter/bytecode_kernels.h"
 
 namespace iree {
@@ -27,14 +32,43 @@ namespace hal {
 
 class InterpreterDevice final : public Device {
  public:
-  explicit InterpreterDevice(DeviceInfo device_info);
+  struct Options {
+    // Number of worker threads in the device thread pool used to execute
+    // dispatch tiles. The queue thread also participates in execution.
+    // A negative value selects a count based on the available hardware threads
+    // and 0 executes all tiles on the queue thread.
+    int worker_count = -1;
+
+    // Maximum number of threads used by matrix multiplications, including the
+    // thread executing the dispatch. Matmul threads are owned by the device
+    // and shared by all executables; matmuls executing concurrently in
+    // parallel dispatches split the budget instead of each starting their own
+    // threads. A negative value uses as many threads as the device thread pool
+    // and 1 disables matmul threading.
+    int matmul_thread_count = -1;
+
+    // Recycles the storage of released buffers through a
+    // PooledHostLocalAllocator instead of allocating each buffer from the
+    // system. Buffers are zeroed on allocation either way, except for
+    // MemoryType::kTransient buffers whose pooled storage is not cleared.
+    bool pool_allocations = false;
+
+    // Directory in which prepared executables are stored for reuse across
+    // processes. Persistent caching is disabled when empty.
+    std::string executable_cache_path;
+  };
+
+  InterpreterDevice(DeviceInfo device_info, Options options);
   ~InterpreterDevice() override;
 
   kernels::RuntimeState* kernel_runtime_state() {
     return &kernel_runtime_state_;
   }
 
-  Allocator* allocator() const override { return &allocator_; }
+  // Thread pool shared by all dispatches executed on the device.
+  HostThreadPool* thread_pool() const { return thread_pool_.get(); }
+
+  Allocator* allocator() const override { return allocator_.get(); }
 
   absl::Span<CommandQueue*> dispatch_queues() const override {
     return RawPtrSpan(absl::MakeSpan(command_queues_));
@@ -66,8 +100,12 @@ class InterpreterDevice final : public Device {
   Status WaitIdle(absl::Time deadline) override;
 
  private:
+  std::unique_ptr<HostThreadPool> thread_pool_;
   kernels::RuntimeState kernel_runtime_state_;
-  mutable HostLocalAllocator allocator_;
+  ref_ptr<HostLocalAllocator> allocator_;
+  // Shared by all executable caches created from the device so that executables
+  // are only prepared once regardless of how many contexts load them.
+  ref_ptr<BytecodeCache> executable_cache_;
   mutable absl::InlinedVector<std::unique_ptr<CommandQueue>, 1> command_queues_;
 };
 
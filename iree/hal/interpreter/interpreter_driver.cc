@@ -37,7 +37,9 @@ DeviceInfo GetDefaultDeviceInfo() {
 
 }  // namespace
 
-InterpreterDriver::InterpreterDriver() : Driver("interpreter") {}
+InterpreterDriver::InterpreterDriver(
+    InterpreterDevice::Options device_options)
+    : Driver("interpreter"), device_options_(std::move(device_options)) {}
 
 InterpreterDriver::~InterpreterDriver() = default;
 
@@ -54,7 +56,8 @@ StatusOr<ref_ptr<Device>> InterpreterDriver::CreateDefaultDevice() {
 
 StatusOr<ref_ptr<Device>> InterpreterDriver::CreateDevice(
     DriverDeviceID device_id) {
-  auto device = make_ref<InterpreterDevice>(GetDefaultDeviceInfo());
+  auto device =
+      make_ref<InterpreterDevice>(GetDefaultDeviceInfo(), device_options_);
   return device;
 }
 
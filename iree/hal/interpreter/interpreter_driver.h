@@ -16,13 +16,14 @@
 #define IREE_HAL_INTERPRETER_INTERPRETER_DRIVER_H_
 
 #include "iree/hal/driver.h"
+#include "iree/hal/interpreter/interpreter_device.h"
 
 namespace iree {
 namespace hal {
 
 class InterpreterDriver final : public Driver {
  public:
-  InterpreterDriver();
+  explicit InterpreterDriver(InterpreterDevice::Options device_options);
   ~InterpreterDriver() override;
 
   StatusOr<std::vector<DeviceInfo>> EnumerateAvailableDevices() override;
@@ -30,6 +31,9 @@ class InterpreterDriver final : public Driver {
   StatusOr<ref_ptr<Device>> CreateDefaultDevice() override;
 
   StatusOr<ref_ptr<Device>> CreateDevice(DriverDeviceID device_id) override;
+
+ private:
+  InterpreterDevice::Options device_options_;
 };
 
 }  // namespace hal
@@ -13,18 +13,41 @@
 // limitations under the License.
 
 #include <memory>
+#include <string>
 
+#include "absl/flags/flag.h"
 #include "iree/base/init.h"
 #include "iree/base/status.h"
 #include "iree/hal/driver_registry.h"
 #include "iree/hal/interpreter/interpreter_driver.h"
 
+ABSL_FLAG(int32_t, interpreter_worker_count, -1,
+          "Number of worker threads used to execute interpreter dispatch "
+          "tiles. -1 uses all hardware threads and 0 disables threading.");
+ABSL_FLAG(int32_t, interpreter_matmul_thread_count, -1,
+          "Maximum number of threads shared by matrix multiplications. "
+          "-1 matches the dispatch thread pool and 1 disables threading.");
+ABSL_FLAG(bool, interpreter_pool_allocations, false,
+          "Recycles buffer storage across allocations instead of allocating "
+          "each buffer from the system.");
+ABSL_FLAG(std::string, interpreter_executable_cache_path, "",
+          "Directory in which prepared executables are stored and reused "
+          "across runs. Disabled when empty.");
+
 namespace iree {
 namespace hal {
 namespace {
 
 StatusOr<ref_ptr<Driver>> CreateInterpreterDriver() {
-  return make_ref<InterpreterDriver>();
+  InterpreterDevice::Options device_options;
+  device_options.worker_count = absl::GetFlag(FLAGS_interpreter_worker_count);
+  device_options.matmul_thread_count =
+      absl::GetFlag(FLAGS_interpreter_matmul_thread_count);
+  device_options.pool_allocations =
+      absl::GetFlag(FLAGS_interpreter_pool_allocations);
+  device_options.executable_cache_path =
+      absl::GetFlag(FLAGS_interpreter_executable_cache_path);
+  return make_ref<InterpreterDriver>(device_options);
 }
 
 }  // namespace
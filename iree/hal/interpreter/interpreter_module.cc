@@ -164,10 +164,14 @@ StatusOr<ref_ptr<InterpreterModule>> InterpreterModule::FromDef(
     return InvalidArgumentErrorBuilder(IREE_LOC) << "No root ModuleDef present";
   }
 
+  RETURN_IF_ERROR(ValidateStructure(*module_file->root()));
+
   auto module =
       assign_ref(new InterpreterModule(allocator, std::move(module_file)));
 
-  // TODO(benvanik): validate internals here? or make explicit?
+  // Translate all bytecode up front so that execution does not need to decode
+  // or validate any instructions.
+  RETURN_IF_ERROR(module->DecodeFunctions());
 
   return {std::move(module)};
 }
@@ -178,6 +182,35 @@ InterpreterModule::InterpreterModule(hal::Allocator* allocator,
       module_file_(std::move(module_file)),
       module_def_(*module_file_->root()) {}
 
+Status InterpreterModule::DecodeFunctions() {
+  IREE_TRACE_SCOPE0("InterpreterModule::DecodeFunctions");
+  const auto& function_defs = *function_table_def().functions();
+  absl::InlinedVector<bool, 32> callable_functions(function_defs.size());
+  for (int i = 0; i < function_defs.size(); ++i) {
+    callable_functions[i] = function_defs.Get(i)->bytecode() != nullptr;
+  }
+
+  decoded_functions_.resize(function_defs.size());
+  for (int i = 0; i < function_defs.size(); ++i) {
+    const auto* bytecode_def = function_defs.Get(i)->bytecode();
+    if (!bytecode_def) continue;
+    absl::Span<const uint8_t> bytecode;
+    if (bytecode_def->contents()) {
+      bytecode = absl::MakeConstSpan(bytecode_def->contents()->Data(),
+                                     bytecode_def->contents()->size());
+    }
+    auto decoded_function_or = DecodeFunction(
+        bytecode, bytecode_def->local_count(), callable_functions);
+    if (!decoded_function_or.ok()) {
+      return StatusBuilder(std::move(decoded_function_or).status(), IREE_LOC)
+             << "Invalid bytecode in function ordinal " << i;
+    }
+    decoded_functions_[i] = std::move(decoded_function_or).ValueOrDie();
+  }
+  ASSIGN_OR_RETURN(constant_pool_, ConstantPool::Create(decoded_functions_));
+  return OkStatus();
+}
+
 StatusOr<int32_t> InterpreterModule::MapFunctionOrdinal(
     Function::Linkage linkage, int32_t ordinal) const {
   const auto& function_table = function_table_def();
@@ -231,19 +264,27 @@ StatusOr<const FunctionDef*> InterpreterModule::GetFunctionDef(
 }
 
 Status InterpreterModule::Execute(
-    Stack* stack, const Function function,
+    kernels::RuntimeState* kernel_runtime_state, Stack* stack,
+    const Function function,
     absl::InlinedVector<hal::BufferView, 8> arguments,
     absl::InlinedVector<hal::BufferView, 8>* results) const {
   IREE_TRACE_SCOPE0("InterperterModule::Execute");
 
-  // Push stack frame for the function we are calling.
-  ASSIGN_OR_RETURN(auto* callee_stack_frame, stack->PushFrame(function));
+  // Push stack frame for the function we are calling. Frames always reference
+  // functions by internal ordinal.
+  ASSIGN_OR_RETURN(int32_t ordinal,
+                   MapFunctionOrdinal(function.linkage(), function.ordinal()));
+  if (!function_table_def().functions()->Get(ordinal)->bytecode()) {
+    return InvalidArgumentErrorBuilder(IREE_LOC)
+           << "Function ordinal " << ordinal << " has no bytecode";
+  }
+  ASSIGN_OR_RETURN(auto* callee_stack_frame,
+                   stack->PushFrame(Function(this, Function::Linkage::kInternal,
+                                             ordinal)));
 
   // TODO(benvanik): rework register storage interface.
-  ASSIGN_OR_RETURN(const auto* function_def,
-                   GetFunctionDef(function.linkage(), function.ordinal()));
   auto* registers = callee_stack_frame->mutable_registers();
-  registers->buffer_views.resize(function_def->bytecode()->local_count());
+  registers->buffer_views.resize(decoded_function(ordinal).local_count);
 
   // Marshal input arguments.
   for (int i = 0; i < arguments.size(); ++i) {
@@ -251,7 +292,7 @@ Status InterpreterModule::Execute(
   }
 
   // Run main dispatch loop until it exits (or errors).
-  RETURN_IF_ERROR(Dispatch(allocator_, &kernel_runtime_state_, stack,
+  RETURN_IF_ERROR(Dispatch(allocator_, kernel_runtime_state, stack,
                            callee_stack_frame, absl::MakeSpan(*results)));
 
   // Pop the callee frame to balance out the stack.
@@ -16,6 +16,7 @@
 #define IREE_HAL_INTERPRETER_INTERPRETER_MODULE_H_
 
 #include <memory>
+#include <vector>
 
 #include "absl/container/inlined_vector.h"
 #include "absl/strings/string_view.h"
@@ -25,8 +26,10 @@
 #include "iree/base/status.h"
 #include "iree/hal/allocator.h"
 #include "iree/hal/buffer_view.h"
+#include "iree/hal/interpreter/bytecode_decoder.h"
 #include "iree/hal/interpreter/bytecode_kernels.h"
 #include "iree/hal/interpreter/bytecode_tables_interpreter.h"
+#include "iree/hal/interpreter/constant_pool.h"
 #include "iree/schemas/interpreter_module_def_generated.h"
 
 namespace iree {
@@ -94,7 +97,20 @@ class InterpreterModule final : public RefObject<InterpreterModule> {
   StatusOr<const FunctionDef*> GetFunctionDef(Function::Linkage linkage,
                                               int32_t ordinal) const;
 
-  Status Execute(Stack* stack, const Function function,
+  // Returns the pre-decoded form of the function with the given internal
+  // |ordinal|. All functions with bytecode are decoded when the module is
+  // loaded.
+  const DecodedFunction& decoded_function(int32_t ordinal) const {
+    return decoded_functions_[ordinal];
+  }
+
+  // Shared read-only buffers for the constants of all decoded functions.
+  const ConstantPool& constant_pool() const { return *constant_pool_; }
+
+  // Executes |function| using the kernel state in |kernel_runtime_state|.
+  // The runtime state may be shared by concurrent executions.
+  Status Execute(kernels::RuntimeState* kernel_runtime_state, Stack* stack,
+                 const Function function,
                  absl::InlinedVector<hal::BufferView, 8> arguments,
                  absl::InlinedVector<hal::BufferView, 8>* results) const;
 
@@ -104,13 +120,19 @@ class InterpreterModule final : public RefObject<InterpreterModule> {
 
   InterpreterModule(hal::Allocator* allocator, ref_ptr<ModuleFile> module_file);
 
+  // Decodes the bytecode of all functions into decoded_functions_ and creates
+  // the constant_pool_ for them.
+  Status DecodeFunctions();
+
   StatusOr<int32_t> MapFunctionOrdinal(Function::Linkage linkage,
                                        int32_t ordinal) const;
 
   hal::Allocator* allocator_;
-  mutable kernels::RuntimeState kernel_runtime_state_;
   ref_ptr<ModuleFile> module_file_;
   const ModuleDef& module_def_;
+  // Indexed by internal function ordinal.
+  std::vector<DecodedFunction> decoded_functions_;
+  std::unique_ptr<ConstantPool> constant_pool_;
 };
 
 }  // namespace hal
@@ -25,6 +25,10 @@ namespace hal {
 class Type {
  public:
   static StatusOr<const Type> FromTypeIndex(uint8_t type_index);
+  // Returns the type of a |type_index| previously accepted by FromTypeIndex.
+  static const Type FromValidatedTypeIndex(uint8_t type_index) {
+    return Type(type_index);
+  }
   static const Type FromBuiltin(BuiltinType type);
 
   std::string DebugString() const;
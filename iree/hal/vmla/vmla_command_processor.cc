@@ -0,0 +1,67 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/hal/vmla/vmla_command_processor.h"
+
+#include "absl/container/inlined_vector.h"
+#include "iree/base/source_location.h"
+#include "iree/base/status.h"
+#include "iree/base/tracing.h"
+#include "iree/hal/buffer.h"
+#include "iree/hal/vmla/vmla_executable.h"
+#include "iree/hal/vmla/vmla_module.h"
+
+namespace iree {
+namespace hal {
+namespace vmla {
+
+VMLACommandProcessor::VMLACommandProcessor(
+    Allocator* allocator, CommandBufferModeBitfield mode,
+    CommandCategoryBitfield command_categories)
+    : HostLocalCommandProcessor(allocator, mode, command_categories) {}
+
+VMLACommandProcessor::~VMLACommandProcessor() = default;
+
+Status VMLACommandProcessor::Dispatch(
+    const DispatchRequest& dispatch_request) {
+  IREE_TRACE_SCOPE0("VMLACommandProcessor::Dispatch");
+  auto* executable = static_cast<VMLAExecutable*>(dispatch_request.executable);
+
+  // Map each binding for the duration of the invocation and wrap the mapped
+  // memory so that the executable reads and writes the bindings in-place.
+  absl::InlinedVector<MappedMemory<uint8_t>, 8> mappings;
+  absl::InlinedVector<vm::ref<Buffer>, 8> arguments;
+  mappings.reserve(dispatch_request.bindings.size());
+  arguments.reserve(dispatch_request.bindings.size());
+  for (const auto& binding : dispatch_request.bindings) {
+    ASSIGN_OR_RETURN(auto mapping,
+                     binding.buffer->MapMemory<uint8_t>(binding.access));
+    vm::ref<Buffer> argument;
+    if (AnyBitSet(binding.access & MemoryAccess::kWrite)) {
+      ASSIGN_OR_RETURN(argument, Buffer::Wrap(mapping.mutable_contents()));
+    } else {
+      ASSIGN_OR_RETURN(argument, Buffer::WrapReadOnly(mapping.contents()));
+    }
+    mappings.push_back(std::move(mapping));
+    arguments.push_back(std::move(argument));
+  }
+
+  // NOTE: VMLA executables compute the entire workload in a single invocation.
+  return executable->Invoke(dispatch_request.entry_point,
+                            absl::MakeSpan(arguments));
+}
+
+}  // namespace vmla
+}  // namespace hal
+}  // namespace iree
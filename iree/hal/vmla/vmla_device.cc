@@ -0,0 +1,191 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/hal/vmla/vmla_device.h"
+
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "iree/base/api_util.h"
+#include "iree/base/source_location.h"
+#include "iree/base/status.h"
+#include "iree/base/tracing.h"
+#include "iree/hal/command_buffer_validation.h"
+#include "iree/hal/command_queue.h"
+#include "iree/hal/fence.h"
+#include "iree/hal/host/async_command_queue.h"
+#include "iree/hal/host/host_event.h"
+#include "iree/hal/host/host_submission_queue.h"
+#include "iree/hal/host/inproc_command_buffer.h"
+#include "iree/hal/vmla/vmla_command_processor.h"
+#include "iree/hal/vmla/vmla_module.h"
+
+namespace iree {
+namespace hal {
+namespace vmla {
+
+namespace {
+
+// A CommandQueue that performs no synchronization (semaphores/fences) and just
+// directly executes command buffers inline.
+//
+// This is meant to be wrapped by SyncCommandQueue or AsyncCommandQueue that
+// themselves perform the synchronization/threading/etc. See the interpreter
+// device for details.
+class UnsynchronizedCommandQueue final : public CommandQueue {
+ public:
+  UnsynchronizedCommandQueue(Allocator* allocator, std::string name,
+                             CommandCategoryBitfield supported_categories)
+      : CommandQueue(std::move(name), supported_categories),
+        allocator_(allocator) {}
+  ~UnsynchronizedCommandQueue() override = default;
+
+  Status Submit(absl::Span<const SubmissionBatch> batches,
+                FenceValue fence) override {
+    IREE_TRACE_SCOPE0("UnsynchronizedCommandQueue::Submit");
+    DCHECK_EQ(nullptr, fence.first)
+        << "Fences must be handled by the wrapping queue";
+    for (auto& batch : batches) {
+      DCHECK(batch.wait_semaphores.empty() && batch.signal_semaphores.empty())
+          << "Semaphores must be handled by the wrapping queue";
+      RETURN_IF_ERROR(ProcessCommandBuffers(batch.command_buffers));
+    }
+    return OkStatus();
+  }
+
+  Status WaitIdle(absl::Time deadline) override {
+    // No-op.
+    return OkStatus();
+  }
+
+ private:
+  // Processes each command buffer in-turn with a fresh processor.
+  // This ensures we don't have any state that can carry across buffers.
+  Status ProcessCommandBuffers(
+      absl::Span<CommandBuffer* const> command_buffers) {
+    IREE_TRACE_SCOPE0("UnsynchronizedCommandQueue::ProcessCommandBuffers");
+    for (auto* command_buffer : command_buffers) {
+      auto* inproc_command_buffer =
+          static_cast<InProcCommandBuffer*>(command_buffer->impl());
+      VMLACommandProcessor command_processor(
+          allocator_, command_buffer->mode(), supported_categories());
+      RETURN_IF_ERROR(inproc_command_buffer->Process(&command_processor));
+    }
+    return OkStatus();
+  }
+
+  Allocator* const allocator_;
+};
+
+}  // namespace
+
+// static
+StatusOr<ref_ptr<VMLADevice>> VMLADevice::Create(DeviceInfo device_info) {
+  IREE_TRACE_SCOPE0("VMLADevice::Create");
+  auto device = make_ref<VMLADevice>(std::move(device_info));
+
+  RETURN_IF_ERROR(FromApiStatus(
+      iree_vm_instance_create(IREE_ALLOCATOR_SYSTEM, &device->instance_),
+      IREE_LOC))
+      << "Failed to create the VM instance";
+  ASSIGN_OR_RETURN(device->vmla_module_,
+                   ModuleCreate(IREE_ALLOCATOR_SYSTEM,
+                                &device->kernel_runtime_state_));
+  device->executable_cache_ =
+      make_ref<VMLACache>(device->instance_, device->vmla_module_);
+
+  return device;
+}
+
+VMLADevice::VMLADevice(DeviceInfo device_info)
+    : Device(std::move(device_info)) {
+  allocator_ = make_ref<HostLocalAllocator>();
+
+  // We currently only expose a single command queue. As only the queue thread
+  // executes dispatches the kernel runtime state is never used concurrently.
+  auto command_queue = absl::make_unique<UnsynchronizedCommandQueue>(
+      allocator_.get(), "cpu0",
+      CommandCategory::kTransfer | CommandCategory::kDispatch);
+
+  // TODO(benvanik): allow injection of the wrapper type to support
+  // SyncCommandQueue without always linking in both.
+  auto async_command_queue =
+      absl::make_unique<AsyncCommandQueue>(std::move(command_queue));
+  command_queues_.push_back(std::move(async_command_queue));
+}
+
+VMLADevice::~VMLADevice() {
+  // Drain the queues before tearing down the module they dispatch into.
+  command_queues_.clear();
+  executable_cache_.reset();
+  iree_vm_module_release(vmla_module_);
+  iree_vm_instance_release(instance_);
+}
+
+ref_ptr<ExecutableCache> VMLADevice::CreateExecutableCache() {
+  return add_ref(executable_cache_);
+}
+
+StatusOr<ref_ptr<CommandBuffer>> VMLADevice::CreateCommandBuffer(
+    CommandBufferModeBitfield mode,
+    CommandCategoryBitfield command_categories) {
+  // TODO(b/140026716): conditionally enable validation.
+  auto impl =
+      make_ref<InProcCommandBuffer>(allocator_.get(), mode, command_categories);
+  return WrapCommandBufferWithValidation(std::move(impl));
+}
+
+StatusOr<ref_ptr<Event>> VMLADevice::CreateEvent() {
+  return make_ref<HostEvent>();
+}
+
+StatusOr<ref_ptr<BinarySemaphore>> VMLADevice::CreateBinarySemaphore(
+    bool initial_value) {
+  IREE_TRACE_SCOPE0("VMLADevice::CreateBinarySemaphore");
+  return make_ref<HostBinarySemaphore>(initial_value);
+}
+
+StatusOr<ref_ptr<TimelineSemaphore>> VMLADevice::CreateTimelineSemaphore(
+    uint64_t initial_value) {
+  IREE_TRACE_SCOPE0("VMLADevice::CreateTimelineSemaphore");
+  return make_ref<HostTimelineSemaphore>(initial_value);
+}
+
+StatusOr<ref_ptr<Fence>> VMLADevice::CreateFence(uint64_t initial_value) {
+  IREE_TRACE_SCOPE0("VMLADevice::CreateFence");
+  return make_ref<HostFence>(initial_value);
+}
+
+Status VMLADevice::WaitAllFences(absl::Span<const FenceValue> fences,
+                                 absl::Time deadline) {
+  IREE_TRACE_SCOPE0("VMLADevice::WaitAllFences");
+  return HostFence::WaitForFences(fences, /*wait_all=*/true, deadline);
+}
+
+StatusOr<int> VMLADevice::WaitAnyFence(absl::Span<const FenceValue> fences,
+                                       absl::Time deadline) {
+  IREE_TRACE_SCOPE0("VMLADevice::WaitAnyFence");
+  return HostFence::WaitForFences(fences, /*wait_all=*/false, deadline);
+}
+
+Status VMLADevice::WaitIdle(absl::Time deadline) {
+  for (auto& command_queue : command_queues_) {
+    RETURN_IF_ERROR(command_queue->WaitIdle(deadline));
+  }
+  return OkStatus();
+}
+
+}  // namespace vmla
+}  // namespace hal
+}  // namespace iree
@@ -0,0 +1,162 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/hal/vmla/vmla_executable.h"
+
+#include <utility>
+#include <vector>
+
+#include "absl/base/macros.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/string_view.h"
+#include "iree/base/api_util.h"
+#include "iree/base/source_location.h"
+#include "iree/base/tracing.h"
+#include "iree/vm/bytecode_module.h"
+#include "iree/vm/invocation.h"
+#include "iree/vm/variant_list.h"
+
+namespace iree {
+namespace hal {
+namespace vmla {
+
+// static
+StatusOr<ref_ptr<VMLAExecutable>> VMLAExecutable::Load(
+    iree_vm_instance_t* instance, iree_vm_module_t* vmla_module,
+    ExecutableSpec spec, bool allow_aliasing_data) {
+  IREE_TRACE_SCOPE0("VMLAExecutable::Load");
+  // Allocate the executable now.
+  // We do this here so that if we need to clone the data we are passing that
+  // to the VM loader instead of the data we may not have access to later.
+  auto executable = make_ref<VMLAExecutable>(spec, allow_aliasing_data);
+  RETURN_IF_ERROR(executable->Initialize(instance, vmla_module));
+  return executable;
+}
+
+VMLAExecutable::VMLAExecutable(ExecutableSpec spec, bool allow_aliasing_data)
+    : spec_(spec) {
+  if (!allow_aliasing_data) {
+    // Clone data.
+    cloned_executable_data_ = {spec.executable_data.begin(),
+                               spec.executable_data.end()};
+    spec_.executable_data = absl::MakeConstSpan(cloned_executable_data_);
+  }
+}
+
+VMLAExecutable::~VMLAExecutable() {
+  IREE_TRACE_SCOPE0("VMLAExecutable::dtor");
+  iree_vm_context_release(context_);
+  iree_vm_module_release(bytecode_module_);
+}
+
+Status VMLAExecutable::Initialize(iree_vm_instance_t* instance,
+                                  iree_vm_module_t* vmla_module) {
+  RETURN_IF_ERROR(FromApiStatus(
+      iree_vm_bytecode_module_create(
+          iree_const_byte_span_t{spec_.executable_data.data(),
+                                 spec_.executable_data.size()},
+          IREE_ALLOCATOR_NULL, IREE_ALLOCATOR_SYSTEM, &bytecode_module_),
+      IREE_LOC))
+      << "Failed to load VMLA executable bytecode module";
+
+  // The VMLA module must come first so that the bytecode module can resolve
+  // its imports against it.
+  iree_vm_module_t* modules[2] = {vmla_module, bytecode_module_};
+  RETURN_IF_ERROR(FromApiStatus(
+      iree_vm_context_create_with_modules(instance, modules,
+                                          ABSL_ARRAYSIZE(modules),
+                                          IREE_ALLOCATOR_SYSTEM, &context_),
+      IREE_LOC))
+      << "Failed to create VMLA executable context";
+
+  // Resolve the entry points now so that dispatch does not need to.
+  // VM export ordinals are allocated by name and do not match the HAL entry
+  // point ordinals, so the compiler records the HAL ordinal of each export in
+  // its "hal.entry_point_ordinal" reflection attribute.
+  auto signature = iree_vm_module_signature(bytecode_module_);
+  entry_functions_.resize(signature.export_function_count);
+  std::vector<bool> resolved(entry_functions_.size());
+  for (int i = 0; i < entry_functions_.size(); ++i) {
+    iree_vm_function_t function;
+    RETURN_IF_ERROR(FromApiStatus(
+        iree_vm_module_lookup_function_by_ordinal(
+            bytecode_module_, IREE_VM_FUNCTION_LINKAGE_EXPORT, i, &function),
+        IREE_LOC))
+        << "Failed to resolve VMLA export " << i;
+    iree_string_view_t ordinal_attr = iree_vm_function_reflection_attr(
+        &function, iree_make_cstring_view("hal.entry_point_ordinal"));
+    int entry_point = -1;
+    if (!absl::SimpleAtoi(absl::string_view(ordinal_attr.data,
+                                            ordinal_attr.size),
+                          &entry_point) ||
+        entry_point < 0 ||
+        entry_point >= static_cast<int>(entry_functions_.size())) {
+      return InvalidArgumentErrorBuilder(IREE_LOC)
+             << "VMLA export " << i
+             << " has a missing or invalid HAL entry point ordinal '"
+             << absl::string_view(ordinal_attr.data, ordinal_attr.size)
+             << "'; the executable may need to be recompiled";
+    } else if (resolved[entry_point]) {
+      return InvalidArgumentErrorBuilder(IREE_LOC)
+             << "Multiple VMLA exports map to HAL entry point "
+             << entry_point;
+    }
+    entry_functions_[entry_point] = function;
+    resolved[entry_point] = true;
+  }
+
+  return OkStatus();
+}
+
+Status VMLAExecutable::Invoke(int entry_point,
+                              absl::Span<vm::ref<Buffer>> arguments) {
+  IREE_TRACE_SCOPE0("VMLAExecutable::Invoke");
+  if (entry_point < 0 ||
+      entry_point >= static_cast<int>(entry_functions_.size())) {
+    return InvalidArgumentErrorBuilder(IREE_LOC)
+           << "Entry point ordinal " << entry_point << " out of range; "
+           << "executable has " << entry_functions_.size() << " entry points";
+  }
+
+  iree_vm_variant_list_t* input_list = nullptr;
+  RETURN_IF_ERROR(FromApiStatus(
+      iree_vm_variant_list_alloc(arguments.size(), IREE_ALLOCATOR_SYSTEM,
+                                 &input_list),
+      IREE_LOC));
+  Status status = OkStatus();
+  for (auto& argument : arguments) {
+    iree_vm_ref_t ref = {0};
+    status = FromApiStatus(
+        iree_vm_ref_wrap_assign(argument.release(),
+                                vm::ref_type_descriptor<Buffer>()->type, &ref),
+        IREE_LOC);
+    if (!status.ok()) break;
+    status = FromApiStatus(
+        iree_vm_variant_list_append_ref_move(input_list, &ref), IREE_LOC);
+    if (!status.ok()) break;
+  }
+  if (status.ok()) {
+    status = FromApiStatus(
+        iree_vm_invoke(context_, entry_functions_[entry_point],
+                       /*policy=*/nullptr, input_list, /*outputs=*/nullptr,
+                       IREE_ALLOCATOR_SYSTEM),
+        IREE_LOC);
+  }
+  iree_vm_variant_list_free(input_list);
+  return status;
+}
+
+}  // namespace vmla
+}  // namespace hal
+}  // namespace iree
@@ -0,0 +1,378 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/hal/vmla/vmla_module.h"
+
+#include <cstring>
+#include <initializer_list>
+#include <memory>
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "iree/base/api_util.h"
+#include "iree/base/tracing.h"
+
+namespace iree {
+
+//===----------------------------------------------------------------------===//
+// Type registration
+//===----------------------------------------------------------------------===//
+
+static iree_vm_ref_type_descriptor_t vmla_buffer_descriptor = {0};
+
+namespace vm {
+
+template <>
+const iree_vm_ref_type_descriptor_t* ref_type_descriptor<hal::vmla::Buffer>() {
+  return &vmla_buffer_descriptor;
+}
+
+template <>
+const iree_vm_ref_type_descriptor_t*
+ref_type_descriptor<iree_vm_ro_byte_buffer_t>() {
+  return iree_vm_ro_byte_buffer_get_descriptor();
+}
+
+}  // namespace vm
+
+namespace hal {
+namespace vmla {
+
+Status ModuleRegisterTypes() {
+  static bool has_registered = false;
+  if (has_registered) return OkStatus();
+
+  RETURN_IF_ERROR(FromApiStatus(iree_vm_register_builtin_types(), IREE_LOC));
+
+  vmla_buffer_descriptor.type_name = iree_make_cstring_view("vmla.buffer");
+  vmla_buffer_descriptor.offsetof_counter = Buffer::offsetof_counter();
+  vmla_buffer_descriptor.destroy = Buffer::DirectDestroy;
+  RETURN_IF_ERROR(FromApiStatus(
+      iree_vm_ref_register_type(&vmla_buffer_descriptor), IREE_LOC));
+
+  has_registered = true;
+  return OkStatus();
+}
+
+//===----------------------------------------------------------------------===//
+// Buffer
+//===----------------------------------------------------------------------===//
+
+// static
+StatusOr<vm::ref<Buffer>> Buffer::Allocate(size_t byte_length,
+                                           iree_allocator_t allocator) {
+  void* data = nullptr;
+  RETURN_IF_ERROR(FromApiStatus(
+      iree_allocator_malloc(allocator, byte_length, &data), IREE_LOC))
+      << "Failed to allocate " << byte_length << "b VMLA buffer";
+  return vm::ref<Buffer>(
+      new Buffer(data, byte_length, /*read_only=*/false, allocator));
+}
+
+// static
+StatusOr<vm::ref<Buffer>> Buffer::Wrap(absl::Span<uint8_t> data) {
+  return vm::ref<Buffer>(new Buffer(data.data(), data.size(),
+                                    /*read_only=*/false, IREE_ALLOCATOR_NULL));
+}
+
+// static
+StatusOr<vm::ref<Buffer>> Buffer::WrapReadOnly(
+    absl::Span<const uint8_t> data) {
+  return vm::ref<Buffer>(new Buffer(const_cast<uint8_t*>(data.data()),
+                                    data.size(),
+                                    /*read_only=*/true, IREE_ALLOCATOR_NULL));
+}
+
+// static
+StatusOr<vm::ref<Buffer>> Buffer::WrapConst(
+    vm::ref<iree_vm_ro_byte_buffer_t> rodata) {
+  if (!rodata) {
+    return InvalidArgumentErrorBuilder(IREE_LOC) << "Null rodata reference";
+  }
+  auto buffer = vm::ref<Buffer>(new Buffer(
+      const_cast<uint8_t*>(rodata->data.data), rodata->data.data_length,
+      /*read_only=*/true, IREE_ALLOCATOR_NULL));
+  buffer->rodata_ = std::move(rodata);
+  return std::move(buffer);
+}
+
+Buffer::Buffer(void* data, size_t byte_length, bool read_only,
+               iree_allocator_t allocator)
+    : data_(data),
+      byte_length_(byte_length),
+      read_only_(read_only),
+      allocator_(allocator) {}
+
+Buffer::~Buffer() {
+  if (allocator_.free) {
+    iree_allocator_free(allocator_, data_);
+  }
+}
+
+StatusOr<absl::Span<const uint8_t>> Buffer::Subspan(size_t byte_offset,
+                                                    size_t byte_length) const {
+  if (byte_offset > byte_length_ || byte_length > byte_length_ - byte_offset) {
+    return OutOfRangeErrorBuilder(IREE_LOC)
+           << "Range [" << byte_offset << ", " << byte_offset + byte_length
+           << ") is out of bounds of the " << byte_length_ << "b buffer";
+  }
+  return absl::MakeConstSpan(static_cast<const uint8_t*>(data_) + byte_offset,
+                             byte_length);
+}
+
+StatusOr<absl::Span<uint8_t>> Buffer::MutableSubspan(size_t byte_offset,
+                                                     size_t byte_length) {
+  RETURN_IF_ERROR(ValidateMutable());
+  ASSIGN_OR_RETURN(auto span, Subspan(byte_offset, byte_length));
+  return absl::MakeSpan(const_cast<uint8_t*>(span.data()), span.size());
+}
+
+Status Buffer::ValidateElementSize(size_t element_size) const {
+  if (byte_length_ % element_size != 0) {
+    return InvalidArgumentErrorBuilder(IREE_LOC)
+           << "Buffer byte length " << byte_length_
+           << " is not a multiple of the element size " << element_size;
+  }
+  return OkStatus();
+}
+
+Status Buffer::ValidateMutable() const {
+  if (read_only_) {
+    return PermissionDeniedErrorBuilder(IREE_LOC)
+           << "Constant buffers cannot be written";
+  }
+  return OkStatus();
+}
+
+//===----------------------------------------------------------------------===//
+// Module state and functions
+//===----------------------------------------------------------------------===//
+
+namespace {
+
+// Per-context module state.
+//
+// Thread-compatible; the kernel runtime state is shared by all contexts and
+// the owning device only executes one dispatch at a time.
+class VMLAModuleState final {
+ public:
+  VMLAModuleState(iree_allocator_t allocator,
+                  kernels::RuntimeState* kernel_runtime_state)
+      : allocator_(allocator), kernel_runtime_state_(kernel_runtime_state) {}
+  ~VMLAModuleState() = default;
+
+  //===--------------------------------------------------------------------===//
+  // vmla.buffer.*
+  //===--------------------------------------------------------------------===//
+
+  StatusOr<vm::ref<Buffer>> BufferAlloc(int32_t byte_length) {
+    IREE_TRACE_SCOPE0("VMLAModuleState::BufferAlloc");
+    if (byte_length < 0) {
+      return InvalidArgumentErrorBuilder(IREE_LOC)
+             << "Invalid buffer length " << byte_length;
+    }
+    return Buffer::Allocate(byte_length, allocator_);
+  }
+
+  StatusOr<vm::ref<Buffer>> BufferConst(
+      vm::ref<iree_vm_ro_byte_buffer_t>& value) {
+    IREE_TRACE_SCOPE0("VMLAModuleState::BufferConst");
+    return Buffer::WrapConst(std::move(value));
+  }
+
+  Status BufferCopy(vm::ref<Buffer>& src, int32_t src_byte_offset,
+                    vm::ref<Buffer>& dst, int32_t dst_byte_offset,
+                    int32_t byte_length) {
+    IREE_TRACE_SCOPE0("VMLAModuleState::BufferCopy");
+    RETURN_IF_ERROR(ValidateBuffers({&src, &dst}));
+    if (src_byte_offset < 0 || dst_byte_offset < 0 || byte_length < 0) {
+      return InvalidArgumentErrorBuilder(IREE_LOC)
+             << "Negative copy offsets or length";
+    }
+    ASSIGN_OR_RETURN(auto src_bytes,
+                     src->Subspan(src_byte_offset, byte_length));
+    ASSIGN_OR_RETURN(auto dst_bytes,
+                     dst->MutableSubspan(dst_byte_offset, byte_length));
+    std::memmove(dst_bytes.data(), src_bytes.data(), byte_length);
+    return OkStatus();
+  }
+
+  //===--------------------------------------------------------------------===//
+  // Elementwise math
+  //===--------------------------------------------------------------------===//
+
+  template <typename KERNEL, typename T>
+  Status UnaryOp(vm::ref<Buffer>& src, vm::ref<Buffer>& dst) {
+    IREE_TRACE_SCOPE0("VMLAModuleState::UnaryOp");
+    RETURN_IF_ERROR(ValidateBuffers({&src, &dst}));
+    ASSIGN_OR_RETURN(auto src_span, src->As<T>());
+    ASSIGN_OR_RETURN(auto dst_span, dst->AsMutable<T>());
+    if (src_span.size() != dst_span.size()) {
+      return InvalidArgumentErrorBuilder(IREE_LOC)
+             << "Elementwise operands have mismatched sizes: src="
+             << src_span.size() << ", dst=" << dst_span.size();
+    }
+    return KERNEL::Execute(src_span, dst_span);
+  }
+
+  template <typename KERNEL, typename T>
+  Status BinaryOp(vm::ref<Buffer>& lhs, vm::ref<Buffer>& rhs,
+                  vm::ref<Buffer>& dst) {
+    IREE_TRACE_SCOPE0("VMLAModuleState::BinaryOp");
+    RETURN_IF_ERROR(ValidateBuffers({&lhs, &rhs, &dst}));
+    ASSIGN_OR_RETURN(auto lhs_span, lhs->As<T>());
+    ASSIGN_OR_RETURN(auto rhs_span, rhs->As<T>());
+    ASSIGN_OR_RETURN(auto dst_span, dst->AsMutable<T>());
+    if (lhs_span.size() != dst_span.size() ||
+        rhs_span.size() != dst_span.size()) {
+      return InvalidArgumentErrorBuilder(IREE_LOC)
+             << "Elementwise operands have mismatched sizes: lhs="
+             << lhs_span.size() << ", rhs=" << rhs_span.size()
+             << ", dst=" << dst_span.size();
+    }
+    return KERNEL::Execute(lhs_span, rhs_span, dst_span);
+  }
+
+  //===--------------------------------------------------------------------===//
+  // Linear algebra
+  //===--------------------------------------------------------------------===//
+
+  Status MatMulF32(vm::ref<Buffer>& lhs, vm::ref<Buffer>& rhs,
+                   vm::ref<Buffer>& dst, int32_t m, int32_t k, int32_t n) {
+    IREE_TRACE_SCOPE0("VMLAModuleState::MatMulF32");
+    RETURN_IF_ERROR(ValidateBuffers({&lhs, &rhs, &dst}));
+    kernels::MatMul::Buffers<float, float> buffers;
+    ASSIGN_OR_RETURN(buffers.lhs_buffer, lhs->As<float>());
+    ASSIGN_OR_RETURN(buffers.rhs_buffer, rhs->As<float>());
+    ASSIGN_OR_RETURN(buffers.dst_buffer, dst->AsMutable<float>());
+    buffers.lhs_shape = Shape{m, k};
+    buffers.rhs_shape = Shape{k, n};
+    buffers.dst_shape = Shape{m, n};
+    if (buffers.lhs_buffer.size() != buffers.lhs_shape.element_count() ||
+        buffers.rhs_buffer.size() != buffers.rhs_shape.element_count() ||
+        buffers.dst_buffer.size() != buffers.dst_shape.element_count()) {
+      return InvalidArgumentErrorBuilder(IREE_LOC)
+             << "MatMul buffers do not match the [" << m << ", " << k
+             << "] x [" << k << ", " << n << "] problem size";
+    }
+    return kernels::MatMul::Execute(kernel_runtime_state_->mat_mul_state.get(),
+                                    buffers);
+  }
+
+ private:
+  static Status ValidateBuffers(
+      std::initializer_list<const vm::ref<Buffer>*> buffers) {
+    for (const auto* buffer : buffers) {
+      if (!*buffer) {
+        return InvalidArgumentErrorBuilder(IREE_LOC)
+               << "Null buffer reference";
+      }
+    }
+    return OkStatus();
+  }
+
+  iree_allocator_t allocator_;
+  kernels::RuntimeState* kernel_runtime_state_;
+};
+
+// Function table mapping imported function names to their implementation.
+// The signature of each function must match vmla.imports.mlir.
+static const vm::NativeFunction<VMLAModuleState> kVMLAModuleFunctions[] = {
+    vm::MakeNativeFunction("buffer.alloc", &VMLAModuleState::BufferAlloc),
+    vm::MakeNativeFunction("buffer.const", &VMLAModuleState::BufferConst),
+    vm::MakeNativeFunction("buffer.copy", &VMLAModuleState::BufferCopy),
+
+    vm::MakeNativeFunction(
+        "abs.i32", &VMLAModuleState::UnaryOp<kernels::Abs, int32_t>),
+    vm::MakeNativeFunction(
+        "neg.i32", &VMLAModuleState::UnaryOp<kernels::Neg, int32_t>),
+    vm::MakeNativeFunction(
+        "add.i32", &VMLAModuleState::BinaryOp<kernels::Add, int32_t>),
+    vm::MakeNativeFunction(
+        "sub.i32", &VMLAModuleState::BinaryOp<kernels::Sub, int32_t>),
+    vm::MakeNativeFunction(
+        "mul.i32", &VMLAModuleState::BinaryOp<kernels::Mul, int32_t>),
+    vm::MakeNativeFunction(
+        "div.i32", &VMLAModuleState::BinaryOp<kernels::Div, int32_t>),
+    vm::MakeNativeFunction(
+        "min.i32", &VMLAModuleState::BinaryOp<kernels::Min, int32_t>),
+    vm::MakeNativeFunction(
+        "max.i32", &VMLAModuleState::BinaryOp<kernels::Max, int32_t>),
+
+    vm::MakeNativeFunction("abs.f32",
+                           &VMLAModuleState::UnaryOp<kernels::Abs, float>),
+    vm::MakeNativeFunction("neg.f32",
+                           &VMLAModuleState::UnaryOp<kernels::Neg, float>),
+    vm::MakeNativeFunction("exp.f32",
+                           &VMLAModuleState::UnaryOp<kernels::Exp, float>),
+    vm::MakeNativeFunction("log.f32",
+                           &VMLAModuleState::UnaryOp<kernels::Log, float>),
+    vm::MakeNativeFunction("sqrt.f32",
+                           &VMLAModuleState::UnaryOp<kernels::Sqrt, float>),
+    vm::MakeNativeFunction("rsqrt.f32",
+                           &VMLAModuleState::UnaryOp<kernels::Rsqrt, float>),
+    vm::MakeNativeFunction("tanh.f32",
+                           &VMLAModuleState::UnaryOp<kernels::Tanh, float>),
+    vm::MakeNativeFunction("floor.f32",
+                           &VMLAModuleState::UnaryOp<kernels::Floor, float>),
+    vm::MakeNativeFunction("ceil.f32",
+                           &VMLAModuleState::UnaryOp<kernels::Ceil, float>),
+    vm::MakeNativeFunction("add.f32",
+                           &VMLAModuleState::BinaryOp<kernels::Add, float>),
+    vm::MakeNativeFunction("sub.f32",
+                           &VMLAModuleState::BinaryOp<kernels::Sub, float>),
+    vm::MakeNativeFunction("mul.f32",
+                           &VMLAModuleState::BinaryOp<kernels::Mul, float>),
+    vm::MakeNativeFunction("div.f32",
+                           &VMLAModuleState::BinaryOp<kernels::Div, float>),
+    vm::MakeNativeFunction("min.f32",
+                           &VMLAModuleState::BinaryOp<kernels::Min, float>),
+    vm::MakeNativeFunction("max.f32",
+                           &VMLAModuleState::BinaryOp<kernels::Max, float>),
+
+    vm::MakeNativeFunction("matmul.f32", &VMLAModuleState::MatMulF32),
+};
+
+// The module shared across all contexts of a device.
+class VMLAModule final : public vm::NativeModule<VMLAModuleState> {
+ public:
+  VMLAModule(iree_allocator_t allocator,
+             kernels::RuntimeState* kernel_runtime_state)
+      : vm::NativeModule<VMLAModuleState>(
+            "vmla", allocator, absl::MakeConstSpan(kVMLAModuleFunctions)),
+        kernel_runtime_state_(kernel_runtime_state) {}
+  ~VMLAModule() override = default;
+
+  StatusOr<std::unique_ptr<VMLAModuleState>> CreateState(
+      iree_allocator_t allocator) override {
+    return absl::make_unique<VMLAModuleState>(allocator,
+                                              kernel_runtime_state_);
+  }
+
+ private:
+  kernels::RuntimeState* kernel_runtime_state_;
+};
+
+}  // namespace
+
+StatusOr<iree_vm_module_t*> ModuleCreate(
+    iree_allocator_t allocator, kernels::RuntimeState* kernel_runtime_state) {
+  RETURN_IF_ERROR(ModuleRegisterTypes());
+  auto module = absl::make_unique<VMLAModule>(allocator, kernel_runtime_state);
+  return module.release()->interface();
+}
+
+}  // namespace vmla
+}  // namespace hal
+}  // namespace iree
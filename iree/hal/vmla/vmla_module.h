@@ -0,0 +1,139 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// The VMLA (VM linear algebra) native module.
+//
+// VMLA executables are VM bytecode modules that import the functions defined
+// here to perform all tensor math on !vmla.buffer objects. The compiler lowers
+// dispatch functions to calls of the imports declared in
+// iree/compiler/Dialect/VMLA/vmla.imports.mlir and the functions in the module
+// must match those signatures exactly.
+//
+// Buffers passed into an executable alias the memory of the HAL buffers bound
+// to the dispatch and results are written directly into those bindings.
+// Intermediate buffers are allocated from the system allocator and released
+// as soon as the VM drops its references to them.
+
+#ifndef IREE_HAL_VMLA_VMLA_MODULE_H_
+#define IREE_HAL_VMLA_VMLA_MODULE_H_
+
+#include <cstdint>
+
+#include "absl/types/span.h"
+#include "iree/base/api.h"
+#include "iree/base/ref_ptr.h"
+#include "iree/base/status.h"
+#include "iree/hal/interpreter/bytecode_kernels.h"
+#include "iree/vm/module.h"
+#include "iree/vm/module_abi_cc.h"
+#include "iree/vm/types.h"
+
+namespace iree {
+namespace hal {
+namespace vmla {
+class Buffer;
+}  // namespace vmla
+}  // namespace hal
+
+namespace vm {
+template <>
+const iree_vm_ref_type_descriptor_t* ref_type_descriptor<hal::vmla::Buffer>();
+template <>
+const iree_vm_ref_type_descriptor_t*
+ref_type_descriptor<iree_vm_ro_byte_buffer_t>();
+}  // namespace vm
+
+namespace hal {
+namespace vmla {
+
+// A contiguous range of bytes operated on by VMLA functions.
+//
+// Buffers either own their storage or alias storage owned by something else,
+// such as a mapped HAL buffer or a rodata segment of the executable module.
+// Aliased storage must remain valid for the lifetime of the buffer; rodata is
+// kept alive by retaining the reference it came from.
+class Buffer final : public RefObject<Buffer> {
+ public:
+  // Allocates a new buffer of |byte_length| with undefined contents.
+  static StatusOr<vm::ref<Buffer>> Allocate(size_t byte_length,
+                                            iree_allocator_t allocator);
+
+  // Wraps mutable |data| owned by the caller.
+  static StatusOr<vm::ref<Buffer>> Wrap(absl::Span<uint8_t> data);
+
+  // Wraps read-only |data| owned by the caller.
+  static StatusOr<vm::ref<Buffer>> WrapReadOnly(absl::Span<const uint8_t> data);
+
+  // Wraps the read-only contents of a rodata reference and retains it.
+  static StatusOr<vm::ref<Buffer>> WrapConst(
+      vm::ref<iree_vm_ro_byte_buffer_t> rodata);
+
+  ~Buffer();
+
+  size_t byte_length() const { return byte_length_; }
+
+  // Returns the contents of the buffer as elements of type T.
+  template <typename T>
+  StatusOr<absl::Span<const T>> As() const {
+    RETURN_IF_ERROR(ValidateElementSize(sizeof(T)));
+    return absl::MakeConstSpan(reinterpret_cast<const T*>(data_),
+                               byte_length_ / sizeof(T));
+  }
+
+  // Returns the contents of the buffer as mutable elements of type T.
+  // Fails if the buffer is read-only.
+  template <typename T>
+  StatusOr<absl::Span<T>> AsMutable() {
+    RETURN_IF_ERROR(ValidateElementSize(sizeof(T)));
+    RETURN_IF_ERROR(ValidateMutable());
+    return absl::MakeSpan(reinterpret_cast<T*>(data_),
+                          byte_length_ / sizeof(T));
+  }
+
+  // Returns the byte range [byte_offset, byte_offset + byte_length).
+  StatusOr<absl::Span<const uint8_t>> Subspan(size_t byte_offset,
+                                              size_t byte_length) const;
+  StatusOr<absl::Span<uint8_t>> MutableSubspan(size_t byte_offset,
+                                               size_t byte_length);
+
+ private:
+  Buffer(void* data, size_t byte_length, bool read_only,
+         iree_allocator_t allocator);
+
+  Status ValidateElementSize(size_t element_size) const;
+  Status ValidateMutable() const;
+
+  void* data_ = nullptr;
+  size_t byte_length_ = 0;
+  bool read_only_ = false;
+  // Allocator used to free |data_| when owned; IREE_ALLOCATOR_NULL if aliased.
+  iree_allocator_t allocator_;
+  // Retained to keep aliased rodata alive.
+  vm::ref<iree_vm_ro_byte_buffer_t> rodata_;
+};
+
+// Registers the custom types used by the VMLA module.
+// WARNING: not thread-safe; call at startup before using.
+Status ModuleRegisterTypes();
+
+// Creates the VMLA module. All contexts using the module share
+// |kernel_runtime_state| and must not execute concurrently.
+StatusOr<iree_vm_module_t*> ModuleCreate(
+    iree_allocator_t allocator, kernels::RuntimeState* kernel_runtime_state);
+
+}  // namespace vmla
+}  // namespace hal
+}  // namespace iree
+
+#endif  // IREE_HAL_VMLA_VMLA_MODULE_H_
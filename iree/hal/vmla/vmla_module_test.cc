@@ -0,0 +1,79 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/hal/vmla/vmla_module.h"
+
+#include <cstring>
+#include <vector>
+
+#include "iree/base/status_matchers.h"
+#include "iree/testing/gtest.h"
+
+namespace iree {
+namespace hal {
+namespace vmla {
+namespace {
+
+class VMLABufferTest : public ::testing::Test {
+ protected:
+  static void SetUpTestCase() { ASSERT_OK(ModuleRegisterTypes()); }
+};
+
+// Tests that allocated buffers own writable storage of the requested size.
+TEST_F(VMLABufferTest, Allocate) {
+  ASSERT_OK_AND_ASSIGN(auto buffer,
+                       Buffer::Allocate(16, IREE_ALLOCATOR_SYSTEM));
+  EXPECT_EQ(16, buffer->byte_length());
+  ASSERT_OK_AND_ASSIGN(auto contents, buffer->AsMutable<float>());
+  EXPECT_EQ(4, contents.size());
+  contents[3] = 1.0f;
+  ASSERT_OK_AND_ASSIGN(auto const_contents, buffer->As<float>());
+  EXPECT_EQ(1.0f, const_contents[3]);
+}
+
+// Tests that wrapped buffers alias the caller memory.
+TEST_F(VMLABufferTest, Wrap) {
+  std::vector<uint8_t> storage(8, 0);
+  ASSERT_OK_AND_ASSIGN(auto buffer, Buffer::Wrap(absl::MakeSpan(storage)));
+  ASSERT_OK_AND_ASSIGN(auto bytes, buffer->MutableSubspan(2, 4));
+  std::memset(bytes.data(), 0xFF, bytes.size());
+  EXPECT_EQ(0, storage[1]);
+  EXPECT_EQ(0xFF, storage[2]);
+  EXPECT_EQ(0xFF, storage[5]);
+  EXPECT_EQ(0, storage[6]);
+}
+
+// Tests that read-only buffers cannot be written.
+TEST_F(VMLABufferTest, WrapReadOnly) {
+  std::vector<uint8_t> storage(8, 0);
+  ASSERT_OK_AND_ASSIGN(auto buffer,
+                       Buffer::WrapReadOnly(absl::MakeConstSpan(storage)));
+  EXPECT_OK(buffer->As<uint32_t>().status());
+  EXPECT_TRUE(IsPermissionDenied(buffer->AsMutable<uint32_t>().status()));
+  EXPECT_TRUE(IsPermissionDenied(buffer->MutableSubspan(0, 4).status()));
+}
+
+// Tests that out of bounds ranges and misaligned element types are rejected.
+TEST_F(VMLABufferTest, InvalidRanges) {
+  ASSERT_OK_AND_ASSIGN(auto buffer, Buffer::Allocate(6, IREE_ALLOCATOR_SYSTEM));
+  EXPECT_OK(buffer->Subspan(6, 0).status());
+  EXPECT_TRUE(IsOutOfRange(buffer->Subspan(4, 4).status()));
+  EXPECT_TRUE(IsOutOfRange(buffer->Subspan(8, 0).status()));
+  EXPECT_TRUE(IsInvalidArgument(buffer->As<float>().status()));
+}
+
+}  // namespace
+}  // namespace vmla
+}  // namespace hal
+}  // namespace iree
@@ -14,9 +14,16 @@
 
 #include "iree/modules/hal/hal_module.h"
 
+#include <algorithm>
+#include <deque>
+#include <iterator>
+#include <utility>
+#include <vector>
+
 #include "absl/base/macros.h"
 #include "absl/memory/memory.h"
 #include "absl/strings/str_join.h"
+#include "absl/strings/string_view.h"
 #include "absl/types/span.h"
 #include "iree/base/api.h"
 #include "iree/base/api_util.h"
@@ -55,6 +62,7 @@ static iree_vm_ref_type_descriptor_t iree_hal_command_buffer_descriptor = {0};
 //     {0};
 static iree_vm_ref_type_descriptor_t iree_hal_device_descriptor = {0};
 static iree_vm_ref_type_descriptor_t iree_hal_executable_descriptor = {0};
+static iree_vm_ref_type_descriptor_t iree_hal_fence_descriptor = {0};
 
 #define IREE_HAL_REGISTER_CC_TYPE(type, name, descriptor) \
   descriptor.type_name = iree_make_cstring_view(name);    \
@@ -77,6 +85,7 @@ IREE_API_EXPORT iree_status_t IREE_API_CALL iree_hal_module_register_types() {
   IREE_HAL_REGISTER_CC_TYPE(Device, "hal.device", iree_hal_device_descriptor);
   IREE_HAL_REGISTER_CC_TYPE(Executable, "hal.executable",
                             iree_hal_executable_descriptor);
+  IREE_HAL_REGISTER_CC_TYPE(Fence, "hal.fence", iree_hal_fence_descriptor);
 
   has_registered = true;
   return IREE_STATUS_OK;
@@ -92,6 +101,7 @@ IREE_VM_DEFINE_TYPE_ADAPTERS(iree_hal_command_buffer,
                              iree_hal_command_buffer_t);
 IREE_VM_DEFINE_TYPE_ADAPTERS(iree_hal_device, iree_hal_device_t);
 IREE_VM_DEFINE_TYPE_ADAPTERS(iree_hal_executable, iree_hal_executable_t);
+IREE_VM_DEFINE_TYPE_ADAPTERS(iree_hal_fence, iree_hal_fence_t);
 
 //===----------------------------------------------------------------------===//
 // Module type definitions
@@ -145,10 +155,15 @@ class HALModuleState final {
         executable_cache_(std::move(executable_cache)) {}
 
   ~HALModuleState() {
-    for (auto& ref : deferred_releases_) {
-      iree_vm_ref_release(&ref);
+    // Resources may still be in use by in-flight submissions.
+    if (!pending_submissions_.empty()) {
+      shared_device_->WaitIdle().IgnoreError();
     }
-    deferred_releases_.clear();
+    for (auto& pending_submission : pending_submissions_) {
+      ReleaseAll(&pending_submission.deferred_releases);
+    }
+    pending_submissions_.clear();
+    ReleaseAll(&deferred_releases_);
   }
 
   // NOTE: Ex* APIs are experimental and likely to be removed soon. Modules
@@ -163,6 +178,8 @@ class HALModuleState final {
                                          iree_vm_stack_frame_t* frame);
   Status ExDeferRelease(iree_vm_stack_t* stack, iree_vm_stack_frame_t* frame);
   Status ExSubmitAndWait(iree_vm_stack_t* stack, iree_vm_stack_frame_t* frame);
+  Status ExSubmit(iree_vm_stack_t* stack, iree_vm_stack_frame_t* frame);
+  Status ExWaitFence(iree_vm_stack_t* stack, iree_vm_stack_frame_t* frame);
 
   Status AllocatorComputeSize(iree_vm_stack_t* stack,
                               iree_vm_stack_frame_t* frame);
@@ -215,6 +232,29 @@ class HALModuleState final {
   Status DeviceAllocator(iree_vm_stack_t* stack, iree_vm_stack_frame_t* frame);
 
  private:
+  // Resources retained until a submission has completed execution.
+  struct PendingSubmission {
+    ref_ptr<Fence> fence;
+    std::vector<iree_vm_ref_t> deferred_releases;
+  };
+
+  static void ReleaseAll(std::vector<iree_vm_ref_t>* refs) {
+    for (auto& ref : *refs) {
+      iree_vm_ref_release(&ref);
+    }
+    refs->clear();
+  }
+
+  // Submits |command_buffer| to the primary dispatch queue of |device| and
+  // returns a fence that will be signaled to 1 when it completes. All resources
+  // deferred for release since the last submission are retained until then.
+  StatusOr<ref_ptr<Fence>> SubmitCommandBuffer(Device* device,
+                                               CommandBuffer* command_buffer);
+
+  // Releases the resources of all submissions that have completed.
+  // Returns the failure of any submission that completed with an error.
+  Status RetireCompletedSubmissions();
+
   iree_device_size_t CalculateBufferSize(absl::Span<const int32_t> shape,
                                          uint8_t element_size) {
     iree_device_size_t allocation_size = element_size;
@@ -244,6 +284,7 @@ class HALModuleState final {
   ref_ptr<ExecutableCache> executable_cache_;
 
   std::vector<iree_vm_ref_t> deferred_releases_;
+  std::deque<PendingSubmission> pending_submissions_;
 
   std::vector<BufferBinding> bindings_;
 };
@@ -394,6 +435,42 @@ Status HALModuleState::ExDeferRelease(iree_vm_stack_t* stack,
   return OkStatus();
 }
 
+StatusOr<ref_ptr<Fence>> HALModuleState::SubmitCommandBuffer(
+    Device* device, CommandBuffer* command_buffer) {
+  // Opportunistically release resources from prior submissions.
+  RETURN_IF_ERROR(RetireCompletedSubmissions());
+
+  auto* queue = device->dispatch_queues().front();
+  ASSIGN_OR_RETURN(auto fence, device->CreateFence(0u));
+  SubmissionBatch batch;
+  batch.command_buffers = absl::MakeConstSpan(&command_buffer, 1);
+  RETURN_IF_ERROR(queue->Submit(batch, {fence.get(), 1u}));
+
+  pending_submissions_.push_back({add_ref(fence), {}});
+  std::swap(pending_submissions_.back().deferred_releases, deferred_releases_);
+  bindings_.clear();
+  return fence;
+}
+
+Status HALModuleState::RetireCompletedSubmissions() {
+  // Submissions are made to a single queue and complete in order.
+  while (!pending_submissions_.empty()) {
+    auto& pending_submission = pending_submissions_.front();
+    auto value_or = pending_submission.fence->QueryValue();
+    if (!value_or.ok()) {
+      // The fence has failed and will never be signaled; nothing will retire
+      // the submission after us so drop its resources before reporting it.
+      ReleaseAll(&pending_submission.deferred_releases);
+      pending_submissions_.pop_front();
+      return std::move(value_or).status();
+    }
+    if (value_or.ValueOrDie() < 1u) break;
+    ReleaseAll(&pending_submission.deferred_releases);
+    pending_submissions_.pop_front();
+  }
+  return OkStatus();
+}
+
 Status HALModuleState::ExSubmitAndWait(iree_vm_stack_t* stack,
                                        iree_vm_stack_frame_t* frame) {
   auto* device = iree_hal_device_deref(&frame->registers.ref[0]);
@@ -406,20 +483,57 @@ Status HALModuleState::ExSubmitAndWait(iree_vm_stack_t* stack,
     return InvalidArgumentErrorBuilder(IREE_LOC) << "'command_buffer' invalid";
   }
 
-  auto* queue = reinterpret_cast<Device*>(device)->dispatch_queues().front();
+  auto* device_ptr = reinterpret_cast<Device*>(device);
+  auto* command_buffer_ptr = reinterpret_cast<CommandBuffer*>(command_buffer);
   ASSIGN_OR_RETURN(auto fence,
-                   reinterpret_cast<Device*>(device)->CreateFence(0u));
-  SubmissionBatch batch;
-  batch.command_buffers = absl::MakeConstSpan(
-      reinterpret_cast<CommandBuffer**>(&command_buffer), 1);
-  RETURN_IF_ERROR(queue->Submit(batch, {fence.get(), 1u}));
-  RETURN_IF_ERROR(queue->WaitIdle());
+                   SubmitCommandBuffer(device_ptr, command_buffer_ptr));
+  RETURN_IF_ERROR(device_ptr->WaitAllFences({{fence.get(), 1u}},
+                                            absl::InfiniteFuture()));
+  RETURN_IF_ERROR(RetireCompletedSubmissions());
+
+  ResetStackFrame(frame);
+  return OkStatus();
+}
 
-  for (auto& ref : deferred_releases_) {
-    iree_vm_ref_release(&ref);
+Status HALModuleState::ExSubmit(iree_vm_stack_t* stack,
+                                iree_vm_stack_frame_t* frame) {
+  auto* device = iree_hal_device_deref(&frame->registers.ref[0]);
+  if (!device) {
+    return InvalidArgumentErrorBuilder(IREE_LOC) << "'device' invalid";
+  }
+  auto* command_buffer =
+      iree_hal_command_buffer_deref(&frame->registers.ref[1]);
+  if (!command_buffer) {
+    return InvalidArgumentErrorBuilder(IREE_LOC) << "'command_buffer' invalid";
+  }
+
+  ASSIGN_OR_RETURN(
+      auto fence,
+      SubmitCommandBuffer(reinterpret_cast<Device*>(device),
+                          reinterpret_cast<CommandBuffer*>(command_buffer)));
+
+  ResetStackFrame(frame);
+  frame->return_registers = &kReturnRef.list;
+  frame->registers.ref_register_count = 1;
+  frame->registers.ref[0] = iree_hal_fence_move_ref(
+      reinterpret_cast<iree_hal_fence_t*>(fence.release()));
+  return OkStatus();
+}
+
+Status HALModuleState::ExWaitFence(iree_vm_stack_t* stack,
+                                   iree_vm_stack_frame_t* frame) {
+  auto* device = iree_hal_device_deref(&frame->registers.ref[0]);
+  if (!device) {
+    return InvalidArgumentErrorBuilder(IREE_LOC) << "'device' invalid";
+  }
+  auto* fence = iree_hal_fence_deref(&frame->registers.ref[1]);
+  if (!fence) {
+    return InvalidArgumentErrorBuilder(IREE_LOC) << "'fence' invalid";
   }
-  deferred_releases_.clear();
-  bindings_.clear();
+
+  RETURN_IF_ERROR(reinterpret_cast<Device*>(device)->WaitAllFences(
+      {{reinterpret_cast<Fence*>(fence), 1u}}, absl::InfiniteFuture()));
+  RETURN_IF_ERROR(RetireCompletedSubmissions());
 
   ResetStackFrame(frame);
   return OkStatus();
@@ -436,7 +550,28 @@ Status HALModuleState::AllocatorComputeSize(iree_vm_stack_t* stack,
 
 Status HALModuleState::AllocatorAllocate(iree_vm_stack_t* stack,
                                          iree_vm_stack_frame_t* frame) {
-  return UnimplementedErrorBuilder(IREE_LOC) << "AllocatorAllocate";
+  auto* allocator = iree_hal_allocator_deref(&frame->registers.ref[0]);
+  if (!allocator) {
+    return InvalidArgumentErrorBuilder(IREE_LOC) << "'allocator' invalid";
+  }
+  iree_hal_memory_type_t memory_types =
+      static_cast<iree_hal_memory_type_t>(frame->registers.i32[0]);
+  iree_hal_buffer_usage_t buffer_usage =
+      static_cast<iree_hal_buffer_usage_t>(frame->registers.i32[1]);
+  iree_device_size_t allocation_size = frame->registers.i32[2];
+
+  iree_hal_buffer_t* buffer = nullptr;
+  RETURN_IF_ERROR(FromApiStatus(
+      iree_hal_allocator_allocate_buffer(allocator, memory_types, buffer_usage,
+                                         allocation_size, &buffer),
+      IREE_LOC))
+      << "Failed to allocate buffer";
+
+  ResetStackFrame(frame);
+  frame->return_registers = &kReturnRef.list;
+  frame->registers.ref_register_count = 1;
+  frame->registers.ref[0] = iree_hal_buffer_move_ref(buffer);
+  return OkStatus();
 }
 
 Status HALModuleState::AllocatorAllocateConst(iree_vm_stack_t* stack,
@@ -525,7 +660,25 @@ Status HALModuleState::AllocatorAllocateShaped(iree_vm_stack_t* stack,
 
 Status HALModuleState::BufferSubspan(iree_vm_stack_t* stack,
                                      iree_vm_stack_frame_t* frame) {
-  return UnimplementedErrorBuilder(IREE_LOC) << "BufferSubspan";
+  auto* source_buffer = iree_hal_buffer_deref(&frame->registers.ref[0]);
+  if (!source_buffer) {
+    return InvalidArgumentErrorBuilder(IREE_LOC) << "'source_buffer' invalid";
+  }
+  iree_device_size_t source_offset = frame->registers.i32[0];
+  iree_device_size_t length = frame->registers.i32[1];
+
+  iree_hal_buffer_t* buffer = nullptr;
+  RETURN_IF_ERROR(FromApiStatus(iree_hal_buffer_subspan(source_buffer,
+                                                        source_offset, length,
+                                                        allocator_, &buffer),
+                                IREE_LOC))
+      << "Failed to create subspan";
+
+  ResetStackFrame(frame);
+  frame->return_registers = &kReturnRef.list;
+  frame->registers.ref_register_count = 1;
+  frame->registers.ref[0] = iree_hal_buffer_move_ref(buffer);
+  return OkStatus();
 }
 
 Status HALModuleState::BufferFill(iree_vm_stack_t* stack,
@@ -936,46 +1089,49 @@ struct ExportFunctionInfo {
   const char* name;
 };
 
+// Sorted by name so that lookups can binary search.
 static const ExportFunctionInfo kHALExportFunctionInfos[] = {
-    {&HALModuleState::ExSharedDevice, "ex.shared_device"},
-    {&HALModuleState::ExMatchSupportedExecutableFormat,
-     "ex.match_supported_executable_format"},
-    {&HALModuleState::ExCacheExecutable, "ex.cache_executable"},
-    {&HALModuleState::ExPushBinding, "ex.push_binding"},
-    {&HALModuleState::ExExecutableDescriptorSetLayout,
-     "ex.executable_descriptor_set_layout"},
-    {&HALModuleState::ExDeferRelease, "ex.defer_release"},
-    {&HALModuleState::ExSubmitAndWait, "ex.submit_and_wait"},
-    {&HALModuleState::AllocatorComputeSize, "allocator.compute_size"},
     {&HALModuleState::AllocatorAllocate, "allocator.allocate"},
     {&HALModuleState::AllocatorAllocateConst, "allocator.allocate.const"},
     {&HALModuleState::AllocatorAllocateShaped, "allocator.allocate.shaped"},
-    {&HALModuleState::BufferSubspan, "buffer.subspan"},
-    {&HALModuleState::BufferFill, "buffer.fill"},
-    {&HALModuleState::BufferReadData, "buffer.read_data"},
-    {&HALModuleState::BufferWriteData, "buffer.write_data"},
+    {&HALModuleState::AllocatorComputeSize, "allocator.compute_size"},
     {&HALModuleState::BufferCopyData, "buffer.copy_data"},
+    {&HALModuleState::BufferFill, "buffer.fill"},
     {&HALModuleState::BufferLoad, "buffer.load"},
+    {&HALModuleState::BufferReadData, "buffer.read_data"},
     {&HALModuleState::BufferStore, "buffer.store"},
-    {&HALModuleState::BufferViewComputeOffset, "buffer_view.compute_offset"},
+    {&HALModuleState::BufferSubspan, "buffer.subspan"},
+    {&HALModuleState::BufferWriteData, "buffer.write_data"},
     {&HALModuleState::BufferViewComputeLength, "buffer_view.compute_length"},
+    {&HALModuleState::BufferViewComputeOffset, "buffer_view.compute_offset"},
     {&HALModuleState::BufferViewComputeRange, "buffer_view.compute_range"},
     {&HALModuleState::BufferViewSlice, "buffer_view.slice"},
-    {&HALModuleState::CommandBufferCreate, "command_buffer.create"},
     {&HALModuleState::CommandBufferBegin, "command_buffer.begin"},
-    {&HALModuleState::CommandBufferEnd, "command_buffer.end"},
-    {&HALModuleState::CommandBufferExecutionBarrier,
-     "command_buffer.execution_barrier"},
-    {&HALModuleState::CommandBufferFillBuffer, "command_buffer.fill_buffer"},
-    {&HALModuleState::CommandBufferCopyBuffer, "command_buffer.copy_buffer"},
     {&HALModuleState::CommandBufferBindDescriptorSet,
      "command_buffer.bind_descriptor_set"},
+    {&HALModuleState::CommandBufferCopyBuffer, "command_buffer.copy_buffer"},
+    {&HALModuleState::CommandBufferCreate, "command_buffer.create"},
     {&HALModuleState::CommandBufferDispatch, "command_buffer.dispatch"},
     {&HALModuleState::CommandBufferDispatchIndirect,
      "command_buffer.dispatch.indirect"},
+    {&HALModuleState::CommandBufferEnd, "command_buffer.end"},
+    {&HALModuleState::CommandBufferExecutionBarrier,
+     "command_buffer.execution_barrier"},
+    {&HALModuleState::CommandBufferFillBuffer, "command_buffer.fill_buffer"},
     {&HALModuleState::DescriptorSetAllocate, "descriptor_set.allocate"},
     {&HALModuleState::DescriptorSetUpdate, "descriptor_set.update"},
     {&HALModuleState::DeviceAllocator, "device.allocator"},
+    {&HALModuleState::ExCacheExecutable, "ex.cache_executable"},
+    {&HALModuleState::ExDeferRelease, "ex.defer_release"},
+    {&HALModuleState::ExExecutableDescriptorSetLayout,
+     "ex.executable_descriptor_set_layout"},
+    {&HALModuleState::ExMatchSupportedExecutableFormat,
+     "ex.match_supported_executable_format"},
+    {&HALModuleState::ExPushBinding, "ex.push_binding"},
+    {&HALModuleState::ExSharedDevice, "ex.shared_device"},
+    {&HALModuleState::ExSubmit, "ex.submit"},
+    {&HALModuleState::ExSubmitAndWait, "ex.submit_and_wait"},
+    {&HALModuleState::ExWaitFence, "ex.wait_fence"},
 };
 
 static iree_status_t iree_hal_module_destroy(void* self) {
@@ -1038,15 +1194,19 @@ static iree_status_t iree_hal_module_lookup_function(
   auto* module = HALModule::FromPointer(self);
   out_function->module = module->interface();
   out_function->linkage = IREE_VM_FUNCTION_LINKAGE_EXPORT;
-  for (int i = 0; i < ABSL_ARRAYSIZE(kHALExportFunctionInfos); ++i) {
-    if (iree_string_view_compare(
-            name, iree_make_cstring_view(kHALExportFunctionInfos[i].name)) ==
-        0) {
-      out_function->ordinal = i;
-      return IREE_STATUS_OK;
-    }
+  auto it = std::lower_bound(
+      std::begin(kHALExportFunctionInfos), std::end(kHALExportFunctionInfos),
+      absl::string_view(name.data, name.size),
+      [](const ExportFunctionInfo& info, absl::string_view name) {
+        return absl::string_view(info.name) < name;
+      });
+  if (it == std::end(kHALExportFunctionInfos) ||
+      absl::string_view(it->name) != absl::string_view(name.data, name.size)) {
+    return IREE_STATUS_NOT_FOUND;
   }
-  return IREE_STATUS_NOT_FOUND;
+  out_function->ordinal =
+      static_cast<int32_t>(it - std::begin(kHALExportFunctionInfos));
+  return IREE_STATUS_OK;
 }
 
 static iree_status_t iree_hal_module_alloc_state(
@@ -31,6 +31,7 @@ IREE_VM_DECLARE_TYPE_ADAPTERS(iree_hal_command_buffer,
                               iree_hal_command_buffer_t);
 IREE_VM_DECLARE_TYPE_ADAPTERS(iree_hal_device, iree_hal_device_t);
 IREE_VM_DECLARE_TYPE_ADAPTERS(iree_hal_executable, iree_hal_executable_t);
+IREE_VM_DECLARE_TYPE_ADAPTERS(iree_hal_fence, iree_hal_fence_t);
 
 // Registers the custom types used by the HAL module.
 // WARNING: not thread-safe; call at startup before using.
@@ -328,8 +328,8 @@ using OperandEncodingBitfield = OperandEncoding;
   OPC(0xA5, kReduceMinF, "reduce_min_f", FLAG(kDefault), "ssio", FF)    \
   OPC(0xA6, kReduceMaxI, "reduce_max_i", FLAG(kDefault), "ssio", FF)    \
   OPC(0xA7, kReduceMaxF, "reduce_max_f", FLAG(kDefault), "ssio", FF)    \
-  RSV(0xA8, RESERVED_OPC)                                               \
-  RSV(0xA9, RESERVED_OPC)                                               \
+  OPC(0xA8, kMatMulBiasF, "matmul_bias_f", FLAG(kDefault), "ssso", FF) \
+  OPC(0xA9, kElementwiseF, "elementwise_f", FLAG(kDefault), "SIo", FF) \
   RSV(0xAA, RESERVED_OPC)                                               \
   RSV(0xAB, RESERVED_OPC)                                               \
   RSV(0xAC, RESERVED_OPC)                                               \
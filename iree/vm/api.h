@@ -21,6 +21,7 @@
 #include "iree/vm/invocation.h"
 #include "iree/vm/module.h"
 #include "iree/vm/ref.h"
+#include "iree/vm/scheduler.h"
 #include "iree/vm/stack.h"
 #include "iree/vm/types.h"
 #include "iree/vm/value.h"
@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include <assert.h>
+#include <math.h>
 #include <string.h>
 
 #include "iree/base/target_platform.h"
@@ -43,6 +44,57 @@
 #define VMCHECK(expr)
 #endif  // NDEBUG
 
+// i64, f32, and f64 values are stored in the 32-bit primitive register bank.
+// f32 values use a single register while i64 and f64 values span two
+// consecutive registers starting at the encoded register. As register pairs
+// are not required to be 8-byte aligned all accesses go through memcpy, which
+// compilers lower to (possibly unaligned) native loads and stores.
+static inline int64_t iree_vm_bytecode_load_i64(const int32_t* reg) {
+  int64_t value;
+  memcpy(&value, reg, sizeof(value));
+  return value;
+}
+static inline void iree_vm_bytecode_store_i64(int32_t* reg, int64_t value) {
+  memcpy(reg, &value, sizeof(value));
+}
+static inline float iree_vm_bytecode_load_f32(const int32_t* reg) {
+  float value;
+  memcpy(&value, reg, sizeof(value));
+  return value;
+}
+static inline void iree_vm_bytecode_store_f32(int32_t* reg, float value) {
+  memcpy(reg, &value, sizeof(value));
+}
+static inline double iree_vm_bytecode_load_f64(const int32_t* reg) {
+  double value;
+  memcpy(&value, reg, sizeof(value));
+  return value;
+}
+static inline void iree_vm_bytecode_store_f64(int32_t* reg, double value) {
+  memcpy(reg, &value, sizeof(value));
+}
+static inline float iree_vm_bytecode_bits_to_f32(uint32_t bits) {
+  float value;
+  memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+static inline double iree_vm_bytecode_bits_to_f64(uint64_t bits) {
+  double value;
+  memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+// Returns the number of registers per bank required to pass the arguments in
+// |src_reg_list| to an import and receive the results in |dst_reg_list|.
+// Arguments and results are both left-aligned in the callee banks so this is
+// an upper bound regardless of how they are split between banks.
+static int32_t iree_vm_bytecode_dispatch_call_register_count(
+    const iree_vm_register_list_t* src_reg_list,
+    const iree_vm_register_list_t* dst_reg_list) {
+  return src_reg_list->size > dst_reg_list->size ? src_reg_list->size
+                                                 : dst_reg_list->size;
+}
+
 // Remaps argument registers from a source list to the 0-N ABI registers.
 static void iree_vm_bytecode_dispatch_remap_argument_registers(
     iree_vm_registers_t* src_regs, const iree_vm_register_list_t* src_reg_list,
@@ -56,19 +108,23 @@ static void iree_vm_bytecode_dispatch_remap_argument_registers(
     uint8_t src_reg = src_reg_list->registers[i];
     if (src_reg & IREE_REF_REGISTER_TYPE_BIT) {
       uint8_t dst_reg = ref_reg_offset++;
-      memset(&dst_regs->ref[dst_reg & IREE_REF_REGISTER_MASK], 0,
+      memset(&dst_regs->ref[dst_reg & dst_regs->ref_mask], 0,
              sizeof(iree_vm_ref_t));
       iree_vm_ref_retain_or_move(
           src_reg & IREE_REF_REGISTER_MOVE_BIT,
-          &src_regs->ref[src_reg & IREE_REF_REGISTER_MASK],
-          &dst_regs->ref[dst_reg & IREE_REF_REGISTER_MASK]);
+          &src_regs->ref[src_reg & src_regs->ref_mask],
+          &dst_regs->ref[dst_reg & dst_regs->ref_mask]);
     } else {
       uint8_t dst_reg = i32_reg_offset++;
-      dst_regs->i32[dst_reg & IREE_I32_REGISTER_MASK] =
-          src_regs->i32[src_reg & IREE_I32_REGISTER_MASK];
+      dst_regs->i32[dst_reg & dst_regs->i32_mask] =
+          src_regs->i32[src_reg & src_regs->i32_mask];
     }
   }
-  dst_regs->ref_register_count = ref_reg_offset;
+  // Extra arguments wrapped around the bank; never release past its end.
+  dst_regs->ref_register_count =
+      ref_reg_offset < dst_regs->ref_register_capacity
+          ? ref_reg_offset
+          : dst_regs->ref_register_capacity;
 }
 
 // Remaps registers from source to destination, possibly across frames.
@@ -85,15 +141,28 @@ static void iree_vm_bytecode_dispatch_remap_registers(
     if (src_reg & IREE_REF_REGISTER_TYPE_BIT) {
       iree_vm_ref_retain_or_move(
           src_reg & IREE_REF_REGISTER_MOVE_BIT,
-          &src_regs->ref[src_reg & IREE_REF_REGISTER_MASK],
-          &dst_regs->ref[dst_reg & IREE_REF_REGISTER_MASK]);
+          &src_regs->ref[src_reg & src_regs->ref_mask],
+          &dst_regs->ref[dst_reg & dst_regs->ref_mask]);
     } else {
-      dst_regs->i32[dst_reg & IREE_I32_REGISTER_MASK] =
-          src_regs->i32[src_reg & IREE_I32_REGISTER_MASK];
+      dst_regs->i32[dst_reg & dst_regs->i32_mask] =
+          src_regs->i32[src_reg & src_regs->i32_mask];
     }
   }
 }
 
+// Completes a call to an import by copying the results of |callee_frame| into
+// the return registers of |caller_frame| and leaving the callee frame.
+static void iree_vm_bytecode_dispatch_complete_import_call(
+    iree_vm_stack_t* stack, iree_vm_stack_frame_t* caller_frame,
+    iree_vm_stack_frame_t* callee_frame) {
+  if (callee_frame->return_registers) {
+    iree_vm_bytecode_dispatch_remap_registers(
+        &callee_frame->registers, callee_frame->return_registers,
+        &caller_frame->registers, caller_frame->return_registers);
+  }
+  iree_vm_stack_function_leave(stack);
+}
+
 // Discards ref registers in the list if they are marked move.
 static void iree_vm_bytecode_dispatch_discard_registers(
     iree_vm_registers_t* regs, const iree_vm_register_list_t* reg_list) {
@@ -102,16 +171,19 @@ static void iree_vm_bytecode_dispatch_discard_registers(
     uint8_t reg = reg_list->registers[i];
     if ((reg & (IREE_REF_REGISTER_TYPE_BIT | IREE_REF_REGISTER_MOVE_BIT)) ==
         (IREE_REF_REGISTER_TYPE_BIT | IREE_REF_REGISTER_MOVE_BIT)) {
-      iree_vm_ref_release(&regs->ref[reg & IREE_REF_REGISTER_MASK]);
+      iree_vm_ref_release(&regs->ref[reg & regs->ref_mask]);
     }
   }
 }
 
-// Interleaved src-dst register sets.
+// Interleaved src-dst register sets split by register bank.
+// All i32 pairs come first followed by all ref pairs so that each bank can be
+// remapped without checking the register type of every entry.
 // This structure is an overlay for the bytecode that is serialized in a
 // matching format.
 typedef struct {
-  uint8_t size;
+  uint8_t i32_size;
+  uint8_t ref_size;
   struct pair {
     uint8_t src_reg;
     uint8_t dst_reg;
@@ -119,26 +191,31 @@ typedef struct {
 } iree_vm_register_remap_list_t;
 static_assert(alignof(iree_vm_register_remap_list_t) == 1,
               "Expecting byte alignment (to avoid padding)");
-static_assert(offsetof(iree_vm_register_remap_list_t, pairs) == 1,
+static_assert(offsetof(iree_vm_register_remap_list_t, pairs) == 2,
               "Expect no padding in the struct");
 
+// Returns the total encoded size of |remap_list| in bytes.
+static inline iree_vm_source_offset_t iree_vm_register_remap_list_size(
+    const iree_vm_register_remap_list_t* remap_list) {
+  return 1 + 1 + (remap_list->i32_size + remap_list->ref_size) * 2;
+}
+
 // Remaps registers from a source set to a destination set within the frame.
 static void iree_vm_bytecode_dispatch_remap_branch_registers(
     iree_vm_registers_t* regs,
     const iree_vm_register_remap_list_t* remap_list) {
-  for (int i = 0; i < remap_list->size; ++i) {
-    // TODO(benvanik): change encoding to avoid this branching.
-    // Could write two arrays: one for prims and one for refs.
-    uint8_t src_reg = remap_list->pairs[i].src_reg;
-    uint8_t dst_reg = remap_list->pairs[i].dst_reg;
-    if (src_reg & IREE_REF_REGISTER_TYPE_BIT) {
-      iree_vm_ref_retain_or_move(src_reg & IREE_REF_REGISTER_MOVE_BIT,
-                                 &regs->ref[src_reg & IREE_REF_REGISTER_MASK],
-                                 &regs->ref[dst_reg & IREE_REF_REGISTER_MASK]);
-    } else {
-      regs->i32[dst_reg & IREE_I32_REGISTER_MASK] =
-          regs->i32[src_reg & IREE_I32_REGISTER_MASK];
-    }
+  const struct pair* pairs = remap_list->pairs;
+  for (int i = 0; i < remap_list->i32_size; ++i) {
+    regs->i32[pairs[i].dst_reg & regs->i32_mask] =
+        regs->i32[pairs[i].src_reg & regs->i32_mask];
+  }
+  pairs += remap_list->i32_size;
+  for (int i = 0; i < remap_list->ref_size; ++i) {
+    uint8_t src_reg = pairs[i].src_reg;
+    iree_vm_ref_retain_or_move(
+        src_reg & IREE_REF_REGISTER_MOVE_BIT,
+        &regs->ref[src_reg & regs->ref_mask],
+        &regs->ref[pairs[i].dst_reg & regs->ref_mask]);
   }
 }
 
@@ -208,11 +285,22 @@ iree_status_t iree_vm_bytecode_dispatch(
 #endif  // IREE_DISPATCH_MODE_COMPUTED_GOTO
 
 #define OP_R_I32(i) \
-  regs->i32[bytecode_data[offset + i] & IREE_I32_REGISTER_MASK]
+  regs->i32[bytecode_data[offset + i] & regs->i32_mask]
 #define OP_R_REF(i) \
-  regs->ref[bytecode_data[offset + i] & IREE_REF_REGISTER_MASK]
+  regs->ref[bytecode_data[offset + i] & regs->ref_mask]
 #define OP_R_REF_IS_MOVE(i) \
   (bytecode_data[offset + i] & IREE_REF_REGISTER_MOVE_BIT)
+#define OP_R_I32_PTR(i) \
+  (&regs->i32[bytecode_data[offset + i] & regs->i32_mask])
+#define OP_R_I64(i) iree_vm_bytecode_load_i64(OP_R_I32_PTR(i))
+#define OP_R_I64_SET(i, value) \
+  iree_vm_bytecode_store_i64(OP_R_I32_PTR(i), value)
+#define OP_R_F32(i) iree_vm_bytecode_load_f32(OP_R_I32_PTR(i))
+#define OP_R_F32_SET(i, value) \
+  iree_vm_bytecode_store_f32(OP_R_I32_PTR(i), value)
+#define OP_R_F64(i) iree_vm_bytecode_load_f64(OP_R_I32_PTR(i))
+#define OP_R_F64_SET(i, value) \
+  iree_vm_bytecode_store_f64(OP_R_I32_PTR(i), value)
 #define OP_GLOBAL_I32(ord) module_state->global_i32_table[ord]
 #define OP_GLOBAL_REF(ord) module_state->global_ref_table[ord]
 
@@ -220,6 +308,7 @@ iree_status_t iree_vm_bytecode_dispatch(
 #define OP_I8(i) bytecode_data[offset + i]
 #define OP_I16(i) *((uint16_t*)&bytecode_data[offset + i])
 #define OP_I32(i) *((uint32_t*)&bytecode_data[offset + i])
+#define OP_I64(i) *((uint64_t*)&bytecode_data[offset + i])
 #else
 #define OP_I8(i) bytecode_data[offset + i]
 #define OP_I16(i)                             \
@@ -230,7 +319,41 @@ iree_status_t iree_vm_bytecode_dispatch(
       ((uint32_t)bytecode_data[offset + 1 + i] << 8) |  \
       ((uint32_t)bytecode_data[offset + 2 + i] << 16) | \
       ((uint32_t)bytecode_data[offset + 3 + i] << 24)
+#define OP_I64(i)                   \
+  ((uint64_t)(OP_I32(i)) |          \
+   ((uint64_t)(OP_I32((i) + 4)) << 32))
 #endif  // IREE_IS_LITTLE_ENDIAN
+#define OP_F32(i) iree_vm_bytecode_bits_to_f32(OP_I32(i))
+#define OP_F64(i) iree_vm_bytecode_bits_to_f64(OP_I64(i))
+
+  memset(out_result, 0, sizeof(*out_result));
+
+  // Find the frame to continue execution in. New executions start in
+  // |entry_frame| while suspended executions have left their nested frames on
+  // the stack: we resume the innermost frame of this module above
+  // |entry_frame| after first resuming any import call it was suspended in.
+  // Frames of this module above an import frame belong to a nested dispatch
+  // and are resumed by the import.
+  iree_vm_stack_frame_t* current_frame = iree_vm_stack_current_frame(stack);
+  iree_vm_stack_frame_t* import_frame = NULL;
+  for (iree_vm_stack_frame_t* frame = current_frame;
+       frame && frame != entry_frame; frame = frame->parent) {
+    if (frame->function.module != &module->interface) {
+      current_frame = frame->parent;
+      import_frame = frame;
+    }
+  }
+  if (import_frame) {
+    iree_status_t import_status = import_frame->function.module->execute(
+        import_frame->function.module->self, stack, import_frame, out_result);
+    if (!iree_status_is_ok(import_status)) {
+      return import_status;
+    } else if (out_result->state != IREE_VM_EXECUTION_COMPLETED) {
+      return IREE_STATUS_OK;
+    }
+    iree_vm_bytecode_dispatch_complete_import_call(stack, current_frame,
+                                                   import_frame);
+  }
 
   // Primary dispatch state. This is our 'native stack frame' and really
   // just enough to make dereferencing common addresses (like the current
@@ -239,17 +362,15 @@ iree_status_t iree_vm_bytecode_dispatch(
   // The hope is that the compiler decides to keep these in registers (as
   // they are touched for every instruction executed). The frame will change
   // as we call into different functions.
-  const iree_vm_function_descriptor_t* entry_function_descriptor =
-      &module->function_descriptor_table[entry_frame->function.ordinal];
-  iree_vm_stack_frame_t* current_frame = entry_frame;
+  const iree_vm_function_descriptor_t* current_function_descriptor =
+      &module->function_descriptor_table[current_frame->function.ordinal];
   const uint8_t* bytecode_data =
-      module->bytecode_data.data + entry_function_descriptor->bytecode_offset;
+      module->bytecode_data.data + current_function_descriptor->bytecode_offset;
   iree_vm_source_offset_t offset = current_frame->offset;
   iree_vm_registers_t* regs = &current_frame->registers;
   // TODO(benvanik): hide this register initialization logic in the stack enter.
-  regs->ref_register_count = entry_function_descriptor->ref_register_count;
-
-  memset(out_result, 0, sizeof(*out_result));
+  // Masked register ordinals can reach the entire bank so all of it is live.
+  regs->ref_register_count = regs->ref_register_capacity;
 
   // NOTE: we should generate this with tblgen, as it has the encoding info.
   // TODO(benvanik): at least generate operand reading/writing and sizes.
@@ -342,6 +463,63 @@ iree_status_t iree_vm_bytecode_dispatch(
       offset += 1;
     });
 
+    DISPATCH_OP(ConstI64, {
+      // let encoding = [
+      //   VM_EncOpcode<opcode>,
+      //   VM_EncIntAttr<"value", type.bitwidth>,
+      //   VM_EncResult<"result">,
+      // ];
+      OP_R_I64_SET(8, (int64_t)OP_I64(0));
+      offset += 8 + 1;
+    });
+
+    DISPATCH_OP(ConstI64Zero, {
+      // let encoding = [
+      //   VM_EncOpcode<opcode>,
+      //   VM_EncResult<"result">,
+      // ];
+      OP_R_I64_SET(0, 0);
+      offset += 1;
+    });
+
+    DISPATCH_OP(ConstF32, {
+      // let encoding = [
+      //   VM_EncOpcode<opcode>,
+      //   VM_EncFloatAttr<"value", type.bitwidth>,
+      //   VM_EncResult<"result">,
+      // ];
+      OP_R_F32_SET(4, OP_F32(0));
+      offset += 4 + 1;
+    });
+
+    DISPATCH_OP(ConstF32Zero, {
+      // let encoding = [
+      //   VM_EncOpcode<opcode>,
+      //   VM_EncResult<"result">,
+      // ];
+      OP_R_F32_SET(0, 0.0f);
+      offset += 1;
+    });
+
+    DISPATCH_OP(ConstF64, {
+      // let encoding = [
+      //   VM_EncOpcode<opcode>,
+      //   VM_EncFloatAttr<"value", type.bitwidth>,
+      //   VM_EncResult<"result">,
+      // ];
+      OP_R_F64_SET(8, OP_F64(0));
+      offset += 8 + 1;
+    });
+
+    DISPATCH_OP(ConstF64Zero, {
+      // let encoding = [
+      //   VM_EncOpcode<opcode>,
+      //   VM_EncResult<"result">,
+      // ];
+      OP_R_F64_SET(0, 0.0);
+      offset += 1;
+    });
+
     DISPATCH_OP(ConstRefZero, {
       // let encoding = [
       //   VM_EncOpcode<VM_OPC_ConstRefZero>,
@@ -358,9 +536,12 @@ iree_status_t iree_vm_bytecode_dispatch(
       //   VM_EncResult<"value">,
       // ];
       int32_t rodata_ordinal = OP_I32(0);
-      // TODO(benvanik): allow decompression callbacks to run now (if needed).
-      iree_vm_ref_wrap_retain(&module_state->rodata_ref_table[rodata_ordinal],
-                              iree_vm_ro_byte_buffer_type_id(), &OP_R_REF(4));
+      // Compressed segments are decompressed on first use.
+      iree_vm_ro_byte_buffer_t* rodata = NULL;
+      IREE_RETURN_IF_ERROR(iree_vm_bytecode_module_resolve_rodata(
+          module, module_state, rodata_ordinal, &rodata));
+      iree_vm_ref_wrap_retain(rodata, iree_vm_ro_byte_buffer_type_id(),
+                              &OP_R_REF(4));
       offset += 4 + 1;
     });
 
@@ -380,6 +561,23 @@ iree_status_t iree_vm_bytecode_dispatch(
       offset += 1 + 1 + 1 + 1;
     });
 
+    // let encoding = [
+    //   VM_EncOpcode<opcode>,
+    //   VM_EncOperand<"condition", 0>,
+    //   VM_EncOperand<"true_value", 1>,
+    //   VM_EncOperand<"false_value", 2>,
+    //   VM_EncResult<"result">,
+    // ];
+#define DISPATCH_OP_SELECT(op_name, bank)                               \
+  DISPATCH_OP(op_name, {                                                \
+    OP_R_##bank##_SET(3, OP_R_I32(0) ? OP_R_##bank(1) : OP_R_##bank(2)); \
+    offset += 1 + 1 + 1 + 1;                                            \
+  });
+
+    DISPATCH_OP_SELECT(SelectI64, I64);
+    DISPATCH_OP_SELECT(SelectF32, F32);
+    DISPATCH_OP_SELECT(SelectF64, F64);
+
     DISPATCH_OP(SelectRef, {
       // let encoding = [
       //   VM_EncOpcode<VM_OPC_SelectRef>,
@@ -445,6 +643,70 @@ iree_status_t iree_vm_bytecode_dispatch(
     DISPATCH_OP_BINARY_ALU_I32(OrI32, uint32_t, |);
     DISPATCH_OP_BINARY_ALU_I32(XorI32, uint32_t, ^);
 
+    DISPATCH_OP(AddI32Imm, {
+      // Fused vm.const.i32 + vm.add.i32; see BytecodeEncoder.cpp.
+      // Encoded as: operand register, 32-bit immediate, result register.
+      OP_R_I32(5) = (int32_t)(OP_R_I32(0) + (int32_t)OP_I32(1));
+      offset += 1 + 4 + 1;
+    });
+
+    //===------------------------------------------------------------------===//
+    // Native 64-bit integer arithmetic
+    //===------------------------------------------------------------------===//
+
+#define DISPATCH_OP_UNARY_ALU_I64(op_name, type, op)     \
+  DISPATCH_OP(op_name, {                                 \
+    OP_R_I64_SET(1, (int64_t)(op((type)OP_R_I64(0)))); \
+    offset += 1 + 1;                                     \
+  });
+
+#define DISPATCH_OP_BINARY_ALU_I64(op_name, type, op)                     \
+  DISPATCH_OP(op_name, {                                                  \
+    OP_R_I64_SET(2, (int64_t)(((type)OP_R_I64(0))op((type)OP_R_I64(1)))); \
+    offset += 1 + 1 + 1;                                                  \
+  });
+
+    DISPATCH_OP_BINARY_ALU_I64(AddI64, int64_t, +);
+    DISPATCH_OP_BINARY_ALU_I64(SubI64, int64_t, -);
+    DISPATCH_OP_BINARY_ALU_I64(MulI64, int64_t, *);
+    DISPATCH_OP_BINARY_ALU_I64(DivI64S, int64_t, /);
+    DISPATCH_OP_BINARY_ALU_I64(DivI64U, uint64_t, /);
+    DISPATCH_OP_BINARY_ALU_I64(RemI64S, int64_t, %);
+    DISPATCH_OP_BINARY_ALU_I64(RemI64U, uint64_t, %);
+    DISPATCH_OP_UNARY_ALU_I64(NotI64, uint64_t, ~);
+    DISPATCH_OP_BINARY_ALU_I64(AndI64, uint64_t, &);
+    DISPATCH_OP_BINARY_ALU_I64(OrI64, uint64_t, |);
+    DISPATCH_OP_BINARY_ALU_I64(XorI64, uint64_t, ^);
+
+    //===------------------------------------------------------------------===//
+    // Native floating-point arithmetic
+    //===------------------------------------------------------------------===//
+
+#define DISPATCH_OP_UNARY_ALU_F(op_name, bank, op) \
+  DISPATCH_OP(op_name, {                           \
+    OP_R_##bank##_SET(1, op(OP_R_##bank(0)));      \
+    offset += 1 + 1;                               \
+  });
+
+#define DISPATCH_OP_BINARY_ALU_F(op_name, bank, op)           \
+  DISPATCH_OP(op_name, {                                      \
+    OP_R_##bank##_SET(2, OP_R_##bank(0) op OP_R_##bank(1)); \
+    offset += 1 + 1 + 1;                                      \
+  });
+
+    DISPATCH_OP_BINARY_ALU_F(AddF32, F32, +);
+    DISPATCH_OP_BINARY_ALU_F(SubF32, F32, -);
+    DISPATCH_OP_BINARY_ALU_F(MulF32, F32, *);
+    DISPATCH_OP_BINARY_ALU_F(DivF32, F32, /);
+    DISPATCH_OP_UNARY_ALU_F(NegF32, F32, -);
+    DISPATCH_OP_UNARY_ALU_F(AbsF32, F32, fabsf);
+    DISPATCH_OP_BINARY_ALU_F(AddF64, F64, +);
+    DISPATCH_OP_BINARY_ALU_F(SubF64, F64, -);
+    DISPATCH_OP_BINARY_ALU_F(MulF64, F64, *);
+    DISPATCH_OP_BINARY_ALU_F(DivF64, F64, /);
+    DISPATCH_OP_UNARY_ALU_F(NegF64, F64, -);
+    DISPATCH_OP_UNARY_ALU_F(AbsF64, F64, fabs);
+
     //===------------------------------------------------------------------===//
     // Casting and type conversion/emulation
     //===------------------------------------------------------------------===//
@@ -465,6 +727,28 @@ iree_status_t iree_vm_bytecode_dispatch(
     DISPATCH_OP_CAST_I32(ExtI8I32S, int8_t, int32_t);
     DISPATCH_OP_CAST_I32(ExtI16I32S, int16_t, int32_t);
 
+    // let encoding = [
+    //   VM_EncOpcode<opcode>,
+    //   VM_EncOperand<"operand", 0>,
+    //   VM_EncResult<"result">,
+    // ];
+#define DISPATCH_OP_CONVERT(op_name, src_bank, src_type, dst_bank, dst_type) \
+  DISPATCH_OP(op_name, {                                                     \
+    OP_R_##dst_bank##_SET(1, (dst_type)((src_type)OP_R_##src_bank(0)));      \
+    offset += 1 + 1;                                                         \
+  });
+#define OP_R_I32_SET(i, value) OP_R_I32(i) = (value)
+
+    DISPATCH_OP_CONVERT(ExtI32I64S, I32, int32_t, I64, int64_t);
+    DISPATCH_OP_CONVERT(ExtI32I64U, I32, uint32_t, I64, int64_t);
+    DISPATCH_OP_CONVERT(TruncI64I32, I64, uint64_t, I32, uint32_t);
+    DISPATCH_OP_CONVERT(CastSI32F32, I32, int32_t, F32, float);
+    DISPATCH_OP_CONVERT(CastF32SI32, F32, float, I32, int32_t);
+    DISPATCH_OP_CONVERT(CastSI64F64, I64, int64_t, F64, double);
+    DISPATCH_OP_CONVERT(CastF64SI64, F64, double, I64, int64_t);
+    DISPATCH_OP_CONVERT(ExtF32F64, F32, float, F64, double);
+    DISPATCH_OP_CONVERT(TruncF64F32, F64, double, F32, float);
+
     //===------------------------------------------------------------------===//
     // Native bitwise shifts and rotates
     //===------------------------------------------------------------------===//
@@ -485,6 +769,16 @@ iree_status_t iree_vm_bytecode_dispatch(
     DISPATCH_OP_SHIFT_I32(ShrI32S, int32_t, >>);
     DISPATCH_OP_SHIFT_I32(ShrI32U, uint32_t, >>);
 
+#define DISPATCH_OP_SHIFT_I64(op_name, type, op)                \
+  DISPATCH_OP(op_name, {                                        \
+    OP_R_I64_SET(2, (int64_t)(((type)OP_R_I64(0))op OP_I8(1))); \
+    offset += 1 + 1 + 1;                                        \
+  });
+
+    DISPATCH_OP_SHIFT_I64(ShlI64, int64_t, <<);
+    DISPATCH_OP_SHIFT_I64(ShrI64S, int64_t, >>);
+    DISPATCH_OP_SHIFT_I64(ShrI64U, uint64_t, >>);
+
     //===------------------------------------------------------------------===//
     // Comparison ops
     //===------------------------------------------------------------------===//
@@ -512,6 +806,28 @@ iree_status_t iree_vm_bytecode_dispatch(
     DISPATCH_OP_CMP_I32(CmpGTEI32S, int32_t, >=);
     DISPATCH_OP_CMP_I32(CmpGTEI32U, uint32_t, >=);
 
+#define DISPATCH_OP_CMP(op_name, bank, type, op)                           \
+  DISPATCH_OP(op_name, {                                                   \
+    OP_R_I32(2) =                                                          \
+        (((type)OP_R_##bank(0))op((type)OP_R_##bank(1))) ? 1 : 0;          \
+    offset += 1 + 1 + 1;                                                   \
+  });
+
+    DISPATCH_OP_CMP(CmpEQI64, I64, int64_t, ==);
+    DISPATCH_OP_CMP(CmpNEI64, I64, int64_t, !=);
+    DISPATCH_OP_CMP(CmpLTI64S, I64, int64_t, <);
+    DISPATCH_OP_CMP(CmpLTI64U, I64, uint64_t, <);
+    DISPATCH_OP_CMP(CmpLTEI64S, I64, int64_t, <=);
+    DISPATCH_OP_CMP(CmpLTEI64U, I64, uint64_t, <=);
+    DISPATCH_OP_CMP(CmpEQF32, F32, float, ==);
+    DISPATCH_OP_CMP(CmpNEF32, F32, float, !=);
+    DISPATCH_OP_CMP(CmpLTF32, F32, float, <);
+    DISPATCH_OP_CMP(CmpLTEF32, F32, float, <=);
+    DISPATCH_OP_CMP(CmpEQF64, F64, double, ==);
+    DISPATCH_OP_CMP(CmpNEF64, F64, double, !=);
+    DISPATCH_OP_CMP(CmpLTF64, F64, double, <);
+    DISPATCH_OP_CMP(CmpLTEF64, F64, double, <=);
+
     DISPATCH_OP(CmpEQRef, {
       // let encoding = [
       //   VM_EncOpcode<opcode>,
@@ -561,11 +877,36 @@ iree_status_t iree_vm_bytecode_dispatch(
       int32_t block_offset = OP_I32(0);
       const iree_vm_register_remap_list_t* remap_list =
           (const iree_vm_register_remap_list_t*)&bytecode_data[offset + 4];
-      offset += 4 + 1 + remap_list->size * 2;
+      offset += 4 + iree_vm_register_remap_list_size(remap_list);
       offset = block_offset;
       iree_vm_bytecode_dispatch_remap_branch_registers(regs, remap_list);
     });
 
+    // Decodes the true and false branches of a conditional branch starting
+    // at |branch_offset| bytes past the current offset and takes the one
+    // selected by |cond_value|.
+#define DISPATCH_COND_BRANCH(branch_offset, cond_value)                   \
+  {                                                                       \
+    offset += (branch_offset);                                            \
+    int32_t true_block_offset = OP_I32(0);                                \
+    const iree_vm_register_remap_list_t* true_remap_list =                \
+        (const iree_vm_register_remap_list_t*)&bytecode_data[offset + 4]; \
+    offset += 4 + iree_vm_register_remap_list_size(true_remap_list);      \
+    int32_t false_block_offset = OP_I32(0);                               \
+    const iree_vm_register_remap_list_t* false_remap_list =               \
+        (const iree_vm_register_remap_list_t*)&bytecode_data[offset + 4]; \
+    offset += 4 + iree_vm_register_remap_list_size(false_remap_list);     \
+    if (cond_value) {                                                     \
+      offset = true_block_offset;                                         \
+      iree_vm_bytecode_dispatch_remap_branch_registers(regs,              \
+                                                       true_remap_list);  \
+    } else {                                                              \
+      offset = false_block_offset;                                        \
+      iree_vm_bytecode_dispatch_remap_branch_registers(regs,              \
+                                                       false_remap_list); \
+    }                                                                     \
+  }
+
     DISPATCH_OP(CondBranch, {
       // let encoding = [
       //   VM_EncOpcode<VM_OPC_CondBranch>,
@@ -573,27 +914,29 @@ iree_status_t iree_vm_bytecode_dispatch(
       //   VM_EncBranch<"getTrueDest", "getTrueOperands">,
       //   VM_EncBranch<"getFalseDest", "getFalseOperands">,
       // ];
-
       int32_t cond_value = OP_R_I32(0);
-      int32_t true_block_offset = OP_I32(1);
-      const iree_vm_register_remap_list_t* true_remap_list =
-          (const iree_vm_register_remap_list_t*)&bytecode_data[offset + 1 + 4];
-      offset += 1 + 4 + 1 + true_remap_list->size * 2;
-      int32_t false_block_offset = OP_I32(0);
-      const iree_vm_register_remap_list_t* false_remap_list =
-          (const iree_vm_register_remap_list_t*)&bytecode_data[offset + 4];
-      offset += 4 + 1 + false_remap_list->size * 2;
-
-      if (cond_value) {
-        offset = true_block_offset;
-        iree_vm_bytecode_dispatch_remap_branch_registers(regs, true_remap_list);
-      } else {
-        offset = false_block_offset;
-        iree_vm_bytecode_dispatch_remap_branch_registers(regs,
-                                                         false_remap_list);
-      }
+      DISPATCH_COND_BRANCH(1, cond_value);
     });
 
+    // Fused vm.cmp.*.i32 + vm.cond_br; see BytecodeEncoder.cpp.
+    // Encoded as: lhs register, rhs register, true branch, false branch.
+#define DISPATCH_OP_COND_BRANCH_CMP_I32(op_name, type, op)         \
+  DISPATCH_OP(op_name, {                                           \
+    int32_t cond_value = ((type)OP_R_I32(0))op((type)OP_R_I32(1)); \
+    DISPATCH_COND_BRANCH(1 + 1, cond_value);                       \
+  });
+
+    DISPATCH_OP_COND_BRANCH_CMP_I32(CondBranchEQI32, int32_t, ==);
+    DISPATCH_OP_COND_BRANCH_CMP_I32(CondBranchNEI32, int32_t, !=);
+    DISPATCH_OP_COND_BRANCH_CMP_I32(CondBranchLTI32S, int32_t, <);
+    DISPATCH_OP_COND_BRANCH_CMP_I32(CondBranchLTI32U, uint32_t, <);
+    DISPATCH_OP_COND_BRANCH_CMP_I32(CondBranchLTEI32S, int32_t, <=);
+    DISPATCH_OP_COND_BRANCH_CMP_I32(CondBranchLTEI32U, uint32_t, <=);
+    DISPATCH_OP_COND_BRANCH_CMP_I32(CondBranchGTI32S, int32_t, >);
+    DISPATCH_OP_COND_BRANCH_CMP_I32(CondBranchGTI32U, uint32_t, >);
+    DISPATCH_OP_COND_BRANCH_CMP_I32(CondBranchGTEI32S, int32_t, >=);
+    DISPATCH_OP_COND_BRANCH_CMP_I32(CondBranchGTEI32U, uint32_t, >=);
+
     DISPATCH_OP(Call, {
       // let encoding = [
       //   VM_EncOpcode<VM_OPC_Call>,
@@ -633,10 +976,28 @@ iree_status_t iree_vm_bytecode_dispatch(
       fprintf(stderr, "CALL -> %s\n", target_name.data);
 #endif  // IREE_DISPATCH_LOGGING
 
+      // Size the callee frame: internal functions declare their register
+      // counts while imports only need room for their arguments and results
+      // (and may grow the frame themselves).
+      const iree_vm_function_descriptor_t* function_descriptor = NULL;
+      int32_t i32_register_count;
+      int32_t ref_register_count;
+      if (is_import) {
+        i32_register_count = ref_register_count =
+            iree_vm_bytecode_dispatch_call_register_count(src_reg_list,
+                                                          dst_reg_list);
+      } else {
+        function_descriptor =
+            &module->function_descriptor_table[target_function.ordinal];
+        i32_register_count = function_descriptor->i32_register_count;
+        ref_register_count = function_descriptor->ref_register_count;
+      }
+
       // Remap registers from caller to callee.
       iree_vm_stack_frame_t* callee_frame = NULL;
-      iree_status_t enter_status =
-          iree_vm_stack_function_enter(stack, target_function, &callee_frame);
+      iree_status_t enter_status = iree_vm_stack_function_enter(
+          stack, target_function, i32_register_count, ref_register_count,
+          &callee_frame);
       if (!iree_status_is_ok(enter_status)) {
         // TODO(benvanik): set execution result to stack overflow.
         return enter_status;
@@ -651,28 +1012,25 @@ iree_status_t iree_vm_bytecode_dispatch(
         if (!iree_status_is_ok(call_status)) {
           // TODO(benvanik): set execution result to failure/capture stack.
           return call_status;
+        } else if (out_result->state != IREE_VM_EXECUTION_COMPLETED) {
+          // The import suspended; its frame is left on the stack and the call
+          // is completed when the execution is resumed.
+          return IREE_STATUS_OK;
         }
-        if (callee_frame->return_registers) {
-          iree_vm_bytecode_dispatch_remap_registers(
-              &callee_frame->registers, callee_frame->return_registers,
-              &current_frame->registers, current_frame->return_registers);
-        }
-        iree_vm_stack_function_leave(stack);
+        iree_vm_bytecode_dispatch_complete_import_call(stack, current_frame,
+                                                       callee_frame);
       } else {
         // Switch execution to the target function and continue running in the
         // bytecode dispatcher.
-        const iree_vm_function_descriptor_t* function_descriptor =
-            &module->function_descriptor_table[callee_frame->function.ordinal];
         current_frame = callee_frame;
         bytecode_data =
             module->bytecode_data.data + function_descriptor->bytecode_offset;
         regs = &callee_frame->registers;
         // TODO(benvanik): hide this in the stack.
-        memset(
-            &regs->ref[regs->ref_register_count], 0,
-            sizeof(iree_vm_ref_t) * (function_descriptor->ref_register_count -
-                                     regs->ref_register_count));
-        regs->ref_register_count = function_descriptor->ref_register_count;
+        memset(&regs->ref[regs->ref_register_count], 0,
+               sizeof(iree_vm_ref_t) * (regs->ref_register_capacity -
+                                        regs->ref_register_count));
+        regs->ref_register_count = regs->ref_register_capacity;
         offset = callee_frame->offset;
       }
     });
@@ -723,9 +1081,12 @@ iree_status_t iree_vm_bytecode_dispatch(
 #endif  // IREE_DISPATCH_LOGGING
 
       // Remap registers from caller to callee.
+      int32_t register_count = iree_vm_bytecode_dispatch_call_register_count(
+          src_reg_list, dst_reg_list);
       iree_vm_stack_frame_t* callee_frame = NULL;
-      iree_status_t enter_status =
-          iree_vm_stack_function_enter(stack, target_function, &callee_frame);
+      iree_status_t enter_status = iree_vm_stack_function_enter(
+          stack, target_function, register_count, register_count,
+          &callee_frame);
       if (!iree_status_is_ok(enter_status)) {
         // TODO(benvanik): set execution result to stack overflow.
         return enter_status;
@@ -742,13 +1103,13 @@ iree_status_t iree_vm_bytecode_dispatch(
       if (!iree_status_is_ok(call_status)) {
         // TODO(benvanik): set execution result to failure/capture stack.
         return call_status;
+      } else if (out_result->state != IREE_VM_EXECUTION_COMPLETED) {
+        // The import suspended; its frame is left on the stack and the call is
+        // completed when the execution is resumed.
+        return IREE_STATUS_OK;
       }
-      if (callee_frame->return_registers) {
-        iree_vm_bytecode_dispatch_remap_registers(
-            &callee_frame->registers, callee_frame->return_registers,
-            &current_frame->registers, current_frame->return_registers);
-      }
-      iree_vm_stack_function_leave(stack);
+      iree_vm_bytecode_dispatch_complete_import_call(stack, current_frame,
+                                                     callee_frame);
     });
 
     DISPATCH_OP(Return, {
@@ -764,8 +1125,8 @@ iree_status_t iree_vm_bytecode_dispatch(
 
       if (current_frame == entry_frame) {
         // Return from the top-level entry frame - return back to execute().
-        // TODO(benvanik): clear execution results.
         current_frame->return_registers = src_reg_list;
+        out_result->state = IREE_VM_EXECUTION_COMPLETED;
         return IREE_STATUS_OK;
       }
 
@@ -799,7 +1160,10 @@ iree_status_t iree_vm_bytecode_dispatch(
       // let encoding = [
       //   VM_EncOpcode<VM_OPC_Yield>,
       // ];
-      // TODO(benvanik): yield with execution results.
+      // Suspend with the frame offset pointing at the next op so that
+      // resuming the execution continues from there.
+      current_frame->offset = offset;
+      out_result->state = IREE_VM_EXECUTION_YIELDED;
       return IREE_STATUS_OK;
     });
 
@@ -850,7 +1214,7 @@ iree_status_t iree_vm_bytecode_dispatch(
       int32_t block_offset = OP_I32(0);
       const iree_vm_register_remap_list_t* remap_list =
           (const iree_vm_register_remap_list_t*)&bytecode_data[offset + 4];
-      offset += 4 + 1 + remap_list->size * 2;
+      offset += 4 + iree_vm_register_remap_list_size(remap_list);
       iree_vm_bytecode_dispatch_remap_branch_registers(regs, remap_list);
       offset = block_offset;
     });
@@ -867,7 +1231,7 @@ iree_status_t iree_vm_bytecode_dispatch(
       int32_t block_offset = OP_I32(1);
       const iree_vm_register_remap_list_t* remap_list =
           (const iree_vm_register_remap_list_t*)&bytecode_data[offset + 1 + 4];
-      offset += 1 + 4 + 1 + remap_list->size * 2;
+      offset += 1 + 4 + iree_vm_register_remap_list_size(remap_list);
       iree_vm_bytecode_dispatch_remap_branch_registers(regs, remap_list);
       offset = block_offset;
     });
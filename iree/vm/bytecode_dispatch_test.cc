@@ -27,6 +27,7 @@
 #include "iree/vm/instance.h"
 #include "iree/vm/invocation.h"
 #include "iree/vm/module.h"
+#include "iree/vm/variant_list.h"
 
 namespace {
 
@@ -92,6 +93,9 @@ class VMBytecodeDispatchTest
     iree_vm_instance_release(instance_);
   }
 
+  // Runs |function_name| and returns the status of the invocation. Functions
+  // returning an i32 check their own results: a return value of 0 denotes a
+  // failed check and is reported as IREE_STATUS_FAILED_PRECONDITION.
   iree_status_t RunFunction(absl::string_view function_name) {
     iree_vm_function_t function;
     IREE_CHECK_OK(bytecode_module_->lookup_function(
@@ -99,10 +103,28 @@ class VMBytecodeDispatchTest
         iree_string_view_t{function_name.data(), function_name.size()},
         &function))
         << "Exported function '" << function_name << "' not found";
-
-    return iree_vm_invoke(context_, function,
-                          /*policy=*/nullptr, /*inputs=*/nullptr,
-                          /*outputs=*/nullptr, IREE_ALLOCATOR_SYSTEM);
+    iree_vm_function_signature_t signature;
+    IREE_CHECK_OK(bytecode_module_->get_function(
+        bytecode_module_->self, function.linkage, function.ordinal, nullptr,
+        nullptr, &signature));
+    CHECK_LE(signature.result_count, 1)
+        << "Test functions may only return a single i32";
+
+    iree_vm_variant_list_t* outputs = nullptr;
+    IREE_CHECK_OK(iree_vm_variant_list_alloc(signature.result_count,
+                                             IREE_ALLOCATOR_SYSTEM, &outputs));
+    iree_status_t status =
+        iree_vm_invoke(context_, function,
+                       /*policy=*/nullptr, /*inputs=*/nullptr, outputs,
+                       IREE_ALLOCATOR_SYSTEM);
+    if (iree_status_is_ok(status) && signature.result_count == 1) {
+      iree_vm_variant_t* result = iree_vm_variant_list_get(outputs, 0);
+      if (!result || IREE_VM_VARIANT_IS_REF(result) || result->i32 == 0) {
+        status = IREE_STATUS_FAILED_PRECONDITION;
+      }
+    }
+    IREE_CHECK_OK(iree_vm_variant_list_free(outputs));
+    return status;
   }
 
   iree_vm_instance_t* instance_ = nullptr;
@@ -1,6 +1,7 @@
 // These test functions are called by the bytecode_dispatch_test.cc runner.
+// Functions may return an i32 that is nonzero if all of their checks passed.
 // The prefix of fail_ can be used to denote that the test is expected to fail
-// (error returned from dispatch).
+// (error returned from dispatch or a zero result).
 vm.module @bytecode_dispatch_test {
   // Tests that an empty function (0 args, 0 results, 0 ops) works.
   vm.export @empty
@@ -8,5 +9,723 @@ vm.module @bytecode_dispatch_test {
     vm.return
   }
 
-  // TODO(benvanik): more tests.
+
+  //===-------------------------------------------------------------===//
+  // Failure checks
+  //===-------------------------------------------------------------===//
+
+  // Tests that the comparisons used to check results can fail. Without these
+  // a broken comparison would let every other test pass.
+  vm.export @fail_cmp_eq_i64
+  vm.func @fail_cmp_eq_i64() -> i32 {
+    %lhs = vm.const.i64 4294967296 : i64
+    %rhs = vm.const.i64 0 : i64
+    %eq = vm.cmp.eq.i64 %lhs, %rhs : i64
+    vm.return %eq : i32
+  }
+
+  vm.export @fail_cmp_eq_f32
+  vm.func @fail_cmp_eq_f32() -> i32 {
+    %lhs = vm.const.f32 1.5 : f32
+    %rhs = vm.const.f32 -1.5 : f32
+    %eq = vm.cmp.eq.f32 %lhs, %rhs : f32
+    vm.return %eq : i32
+  }
+
+  vm.export @fail_cmp_eq_f64
+  vm.func @fail_cmp_eq_f64() -> i32 {
+    %lhs = vm.const.f64 1.5 : f64
+    %rhs = vm.const.f64 -1.5 : f64
+    %eq = vm.cmp.eq.f64 %lhs, %rhs : f64
+    vm.return %eq : i32
+  }
+
+  //===-------------------------------------------------------------===//
+  // I64 arithmetic
+  //===-------------------------------------------------------------===//
+
+  vm.export @test_add_i64
+  vm.func @test_add_i64() -> i32 {
+    %lhs = vm.const.i64 4294967295 : i64
+    %rhs = vm.const.i64 1 : i64
+    %v = vm.add.i64 %lhs, %rhs : i64
+    %expected = vm.const.i64 4294967296 : i64
+    %eq = vm.cmp.eq.i64 %v, %expected : i64
+    vm.return %eq : i32
+  }
+
+  vm.export @test_sub_i64
+  vm.func @test_sub_i64() -> i32 {
+    %lhs = vm.const.i64 4294967296 : i64
+    %rhs = vm.const.i64 1 : i64
+    %v = vm.sub.i64 %lhs, %rhs : i64
+    %expected = vm.const.i64 4294967295 : i64
+    %eq = vm.cmp.eq.i64 %v, %expected : i64
+    vm.return %eq : i32
+  }
+
+  vm.export @test_mul_i64
+  vm.func @test_mul_i64() -> i32 {
+    %lhs = vm.const.i64 65536 : i64
+    %rhs = vm.const.i64 65536 : i64
+    %v = vm.mul.i64 %lhs, %rhs : i64
+    %expected = vm.const.i64 4294967296 : i64
+    %eq = vm.cmp.eq.i64 %v, %expected : i64
+    vm.return %eq : i32
+  }
+
+  vm.export @test_div_i64_s
+  vm.func @test_div_i64_s() -> i32 {
+    %lhs = vm.const.i64 -8589934592 : i64
+    %rhs = vm.const.i64 2 : i64
+    %v = vm.div.i64.s %lhs, %rhs : i64
+    %expected = vm.const.i64 -4294967296 : i64
+    %eq = vm.cmp.eq.i64 %v, %expected : i64
+    vm.return %eq : i32
+  }
+
+  vm.export @test_div_i64_u
+  vm.func @test_div_i64_u() -> i32 {
+    %lhs = vm.const.i64 -2 : i64
+    %rhs = vm.const.i64 2 : i64
+    %v = vm.div.i64.u %lhs, %rhs : i64
+    %expected = vm.const.i64 9223372036854775807 : i64
+    %eq = vm.cmp.eq.i64 %v, %expected : i64
+    vm.return %eq : i32
+  }
+
+  vm.export @test_rem_i64_s
+  vm.func @test_rem_i64_s() -> i32 {
+    %lhs = vm.const.i64 -4294967301 : i64
+    %rhs = vm.const.i64 4294967296 : i64
+    %v = vm.rem.i64.s %lhs, %rhs : i64
+    %expected = vm.const.i64 -5 : i64
+    %eq = vm.cmp.eq.i64 %v, %expected : i64
+    vm.return %eq : i32
+  }
+
+  vm.export @test_rem_i64_u
+  vm.func @test_rem_i64_u() -> i32 {
+    %lhs = vm.const.i64 4294967301 : i64
+    %rhs = vm.const.i64 4294967296 : i64
+    %v = vm.rem.i64.u %lhs, %rhs : i64
+    %expected = vm.const.i64 5 : i64
+    %eq = vm.cmp.eq.i64 %v, %expected : i64
+    vm.return %eq : i32
+  }
+
+  vm.export @test_not_i64
+  vm.func @test_not_i64() -> i32 {
+    %operand = vm.const.i64 0 : i64
+    %v = vm.not.i64 %operand : i64
+    %expected = vm.const.i64 -1 : i64
+    %eq = vm.cmp.eq.i64 %v, %expected : i64
+    vm.return %eq : i32
+  }
+
+  vm.export @test_and_i64
+  vm.func @test_and_i64() -> i32 {
+    %lhs = vm.const.i64 8589934595 : i64
+    %rhs = vm.const.i64 4294967297 : i64
+    %v = vm.and.i64 %lhs, %rhs : i64
+    %expected = vm.const.i64 4294967297 : i64
+    %eq = vm.cmp.eq.i64 %v, %expected : i64
+    vm.return %eq : i32
+  }
+
+  vm.export @test_or_i64
+  vm.func @test_or_i64() -> i32 {
+    %lhs = vm.const.i64 8589934592 : i64
+    %rhs = vm.const.i64 1 : i64
+    %v = vm.or.i64 %lhs, %rhs : i64
+    %expected = vm.const.i64 8589934593 : i64
+    %eq = vm.cmp.eq.i64 %v, %expected : i64
+    vm.return %eq : i32
+  }
+
+  vm.export @test_xor_i64
+  vm.func @test_xor_i64() -> i32 {
+    %lhs = vm.const.i64 12884901888 : i64
+    %rhs = vm.const.i64 4294967296 : i64
+    %v = vm.xor.i64 %lhs, %rhs : i64
+    %expected = vm.const.i64 8589934592 : i64
+    %eq = vm.cmp.eq.i64 %v, %expected : i64
+    vm.return %eq : i32
+  }
+
+  //===-------------------------------------------------------------===//
+  // I64 shifts
+  //===-------------------------------------------------------------===//
+
+  vm.export @test_shl_i64
+  vm.func @test_shl_i64() -> i32 {
+    %operand = vm.const.i64 1 : i64
+    %v = vm.shl.i64 %operand, 40 : i64
+    %expected = vm.const.i64 1099511627776 : i64
+    %eq = vm.cmp.eq.i64 %v, %expected : i64
+    vm.return %eq : i32
+  }
+
+  vm.export @test_shr_i64_s
+  vm.func @test_shr_i64_s() -> i32 {
+    %operand = vm.const.i64 -1099511627776 : i64
+    %v = vm.shr.i64.s %operand, 40 : i64
+    %expected = vm.const.i64 -1 : i64
+    %eq = vm.cmp.eq.i64 %v, %expected : i64
+    vm.return %eq : i32
+  }
+
+  vm.export @test_shr_i64_u
+  vm.func @test_shr_i64_u() -> i32 {
+    %operand = vm.const.i64 -1 : i64
+    %v = vm.shr.i64.u %operand, 40 : i64
+    %expected = vm.const.i64 16777215 : i64
+    %eq = vm.cmp.eq.i64 %v, %expected : i64
+    vm.return %eq : i32
+  }
+
+  //===-------------------------------------------------------------===//
+  // I64 comparisons
+  //===-------------------------------------------------------------===//
+
+  vm.export @test_cmp_eq_i64
+  vm.func @test_cmp_eq_i64() -> i32 {
+    %lhs = vm.const.i64 4294967296 : i64
+    %rhs = vm.const.i64 4294967296 : i64
+    %v = vm.cmp.eq.i64 %lhs, %rhs : i64
+    %expected = vm.const.i32 1 : i32
+    %eq = vm.cmp.eq.i32 %v, %expected : i32
+    vm.return %eq : i32
+  }
+
+  vm.export @test_cmp_ne_i64
+  vm.func @test_cmp_ne_i64() -> i32 {
+    %lhs = vm.const.i64 4294967296 : i64
+    %rhs = vm.const.i64 0 : i64
+    %v = vm.cmp.ne.i64 %lhs, %rhs : i64
+    %expected = vm.const.i32 1 : i32
+    %eq = vm.cmp.eq.i32 %v, %expected : i32
+    vm.return %eq : i32
+  }
+
+  vm.export @test_cmp_lt_i64_s
+  vm.func @test_cmp_lt_i64_s() -> i32 {
+    %lhs = vm.const.i64 -4294967296 : i64
+    %rhs = vm.const.i64 1 : i64
+    %v = vm.cmp.lt.i64.s %lhs, %rhs : i64
+    %expected = vm.const.i32 1 : i32
+    %eq = vm.cmp.eq.i32 %v, %expected : i32
+    vm.return %eq : i32
+  }
+
+  vm.export @test_cmp_lt_i64_u
+  vm.func @test_cmp_lt_i64_u() -> i32 {
+    %lhs = vm.const.i64 1 : i64
+    %rhs = vm.const.i64 -4294967296 : i64
+    %v = vm.cmp.lt.i64.u %lhs, %rhs : i64
+    %expected = vm.const.i32 1 : i32
+    %eq = vm.cmp.eq.i32 %v, %expected : i32
+    vm.return %eq : i32
+  }
+
+  vm.export @test_cmp_lte_i64_s
+  vm.func @test_cmp_lte_i64_s() -> i32 {
+    %lhs = vm.const.i64 4294967296 : i64
+    %rhs = vm.const.i64 4294967296 : i64
+    %v = vm.cmp.lte.i64.s %lhs, %rhs : i64
+    %expected = vm.const.i32 1 : i32
+    %eq = vm.cmp.eq.i32 %v, %expected : i32
+    vm.return %eq : i32
+  }
+
+  vm.export @test_cmp_lte_i64_u
+  vm.func @test_cmp_lte_i64_u() -> i32 {
+    %lhs = vm.const.i64 -1 : i64
+    %rhs = vm.const.i64 1 : i64
+    %v = vm.cmp.lte.i64.u %lhs, %rhs : i64
+    %expected = vm.const.i32 0 : i32
+    %eq = vm.cmp.eq.i32 %v, %expected : i32
+    vm.return %eq : i32
+  }
+
+  //===-------------------------------------------------------------===//
+  // F32 arithmetic and comparisons
+  //===-------------------------------------------------------------===//
+
+  vm.export @test_add_f32
+  vm.func @test_add_f32() -> i32 {
+    %lhs = vm.const.f32 1.5 : f32
+    %rhs = vm.const.f32 2.25 : f32
+    %v = vm.add.f32 %lhs, %rhs : f32
+    %expected = vm.const.f32 3.75 : f32
+    %eq = vm.cmp.eq.f32 %v, %expected : f32
+    vm.return %eq : i32
+  }
+
+  vm.export @test_sub_f32
+  vm.func @test_sub_f32() -> i32 {
+    %lhs = vm.const.f32 1.5 : f32
+    %rhs = vm.const.f32 2.25 : f32
+    %v = vm.sub.f32 %lhs, %rhs : f32
+    %expected = vm.const.f32 -0.75 : f32
+    %eq = vm.cmp.eq.f32 %v, %expected : f32
+    vm.return %eq : i32
+  }
+
+  vm.export @test_mul_f32
+  vm.func @test_mul_f32() -> i32 {
+    %lhs = vm.const.f32 1.5 : f32
+    %rhs = vm.const.f32 -4.0 : f32
+    %v = vm.mul.f32 %lhs, %rhs : f32
+    %expected = vm.const.f32 -6.0 : f32
+    %eq = vm.cmp.eq.f32 %v, %expected : f32
+    vm.return %eq : i32
+  }
+
+  vm.export @test_div_f32
+  vm.func @test_div_f32() -> i32 {
+    %lhs = vm.const.f32 3.0 : f32
+    %rhs = vm.const.f32 4.0 : f32
+    %v = vm.div.f32 %lhs, %rhs : f32
+    %expected = vm.const.f32 0.75 : f32
+    %eq = vm.cmp.eq.f32 %v, %expected : f32
+    vm.return %eq : i32
+  }
+
+  vm.export @test_neg_f32
+  vm.func @test_neg_f32() -> i32 {
+    %operand = vm.const.f32 2.5 : f32
+    %v = vm.neg.f32 %operand : f32
+    %expected = vm.const.f32 -2.5 : f32
+    %eq = vm.cmp.eq.f32 %v, %expected : f32
+    vm.return %eq : i32
+  }
+
+  vm.export @test_abs_f32
+  vm.func @test_abs_f32() -> i32 {
+    %operand = vm.const.f32 -2.5 : f32
+    %v = vm.abs.f32 %operand : f32
+    %expected = vm.const.f32 2.5 : f32
+    %eq = vm.cmp.eq.f32 %v, %expected : f32
+    vm.return %eq : i32
+  }
+
+  vm.export @test_cmp_eq_f32
+  vm.func @test_cmp_eq_f32() -> i32 {
+    %lhs = vm.const.f32 0.5 : f32
+    %rhs = vm.const.f32 0.5 : f32
+    %v = vm.cmp.eq.f32 %lhs, %rhs : f32
+    %expected = vm.const.i32 1 : i32
+    %eq = vm.cmp.eq.i32 %v, %expected : i32
+    vm.return %eq : i32
+  }
+
+  vm.export @test_cmp_ne_f32
+  vm.func @test_cmp_ne_f32() -> i32 {
+    %lhs = vm.const.f32 0.5 : f32
+    %rhs = vm.const.f32 0.25 : f32
+    %v = vm.cmp.ne.f32 %lhs, %rhs : f32
+    %expected = vm.const.i32 1 : i32
+    %eq = vm.cmp.eq.i32 %v, %expected : i32
+    vm.return %eq : i32
+  }
+
+  vm.export @test_cmp_lt_f32
+  vm.func @test_cmp_lt_f32() -> i32 {
+    %lhs = vm.const.f32 -0.5 : f32
+    %rhs = vm.const.f32 0.25 : f32
+    %v = vm.cmp.lt.f32 %lhs, %rhs : f32
+    %expected = vm.const.i32 1 : i32
+    %eq = vm.cmp.eq.i32 %v, %expected : i32
+    vm.return %eq : i32
+  }
+
+  vm.export @test_cmp_lte_f32
+  vm.func @test_cmp_lte_f32() -> i32 {
+    %lhs = vm.const.f32 0.5 : f32
+    %rhs = vm.const.f32 0.25 : f32
+    %v = vm.cmp.lte.f32 %lhs, %rhs : f32
+    %expected = vm.const.i32 0 : i32
+    %eq = vm.cmp.eq.i32 %v, %expected : i32
+    vm.return %eq : i32
+  }
+
+  //===-------------------------------------------------------------===//
+  // F64 arithmetic and comparisons
+  //===-------------------------------------------------------------===//
+
+  vm.export @test_add_f64
+  vm.func @test_add_f64() -> i32 {
+    %lhs = vm.const.f64 1.5 : f64
+    %rhs = vm.const.f64 2.25 : f64
+    %v = vm.add.f64 %lhs, %rhs : f64
+    %expected = vm.const.f64 3.75 : f64
+    %eq = vm.cmp.eq.f64 %v, %expected : f64
+    vm.return %eq : i32
+  }
+
+  vm.export @test_sub_f64
+  vm.func @test_sub_f64() -> i32 {
+    %lhs = vm.const.f64 1.5 : f64
+    %rhs = vm.const.f64 2.25 : f64
+    %v = vm.sub.f64 %lhs, %rhs : f64
+    %expected = vm.const.f64 -0.75 : f64
+    %eq = vm.cmp.eq.f64 %v, %expected : f64
+    vm.return %eq : i32
+  }
+
+  vm.export @test_mul_f64
+  vm.func @test_mul_f64() -> i32 {
+    %lhs = vm.const.f64 1.5 : f64
+    %rhs = vm.const.f64 -4.0 : f64
+    %v = vm.mul.f64 %lhs, %rhs : f64
+    %expected = vm.const.f64 -6.0 : f64
+    %eq = vm.cmp.eq.f64 %v, %expected : f64
+    vm.return %eq : i32
+  }
+
+  vm.export @test_div_f64
+  vm.func @test_div_f64() -> i32 {
+    %lhs = vm.const.f64 1.0 : f64
+    %rhs = vm.const.f64 1048576.0 : f64
+    %v = vm.div.f64 %lhs, %rhs : f64
+    %expected = vm.const.f64 9.5367431640625e-07 : f64
+    %eq = vm.cmp.eq.f64 %v, %expected : f64
+    vm.return %eq : i32
+  }
+
+  vm.export @test_neg_f64
+  vm.func @test_neg_f64() -> i32 {
+    %operand = vm.const.f64 2.5 : f64
+    %v = vm.neg.f64 %operand : f64
+    %expected = vm.const.f64 -2.5 : f64
+    %eq = vm.cmp.eq.f64 %v, %expected : f64
+    vm.return %eq : i32
+  }
+
+  vm.export @test_abs_f64
+  vm.func @test_abs_f64() -> i32 {
+    %operand = vm.const.f64 -2.5 : f64
+    %v = vm.abs.f64 %operand : f64
+    %expected = vm.const.f64 2.5 : f64
+    %eq = vm.cmp.eq.f64 %v, %expected : f64
+    vm.return %eq : i32
+  }
+
+  vm.export @test_cmp_eq_f64
+  vm.func @test_cmp_eq_f64() -> i32 {
+    %lhs = vm.const.f64 0.5 : f64
+    %rhs = vm.const.f64 0.5 : f64
+    %v = vm.cmp.eq.f64 %lhs, %rhs : f64
+    %expected = vm.const.i32 1 : i32
+    %eq = vm.cmp.eq.i32 %v, %expected : i32
+    vm.return %eq : i32
+  }
+
+  vm.export @test_cmp_ne_f64
+  vm.func @test_cmp_ne_f64() -> i32 {
+    %lhs = vm.const.f64 0.5 : f64
+    %rhs = vm.const.f64 0.25 : f64
+    %v = vm.cmp.ne.f64 %lhs, %rhs : f64
+    %expected = vm.const.i32 1 : i32
+    %eq = vm.cmp.eq.i32 %v, %expected : i32
+    vm.return %eq : i32
+  }
+
+  vm.export @test_cmp_lt_f64
+  vm.func @test_cmp_lt_f64() -> i32 {
+    %lhs = vm.const.f64 -0.5 : f64
+    %rhs = vm.const.f64 0.25 : f64
+    %v = vm.cmp.lt.f64 %lhs, %rhs : f64
+    %expected = vm.const.i32 1 : i32
+    %eq = vm.cmp.eq.i32 %v, %expected : i32
+    vm.return %eq : i32
+  }
+
+  vm.export @test_cmp_lte_f64
+  vm.func @test_cmp_lte_f64() -> i32 {
+    %lhs = vm.const.f64 0.5 : f64
+    %rhs = vm.const.f64 0.25 : f64
+    %v = vm.cmp.lte.f64 %lhs, %rhs : f64
+    %expected = vm.const.i32 0 : i32
+    %eq = vm.cmp.eq.i32 %v, %expected : i32
+    vm.return %eq : i32
+  }
+
+  //===-------------------------------------------------------------===//
+  // Fused superinstructions
+  //===-------------------------------------------------------------===//
+  // The bytecode encoder fuses these sequences into single opcodes; see
+  // BytecodeEncoder.cpp. i32 ops with constant operands fold away so the
+  // compared values are passed through noinline functions or block args.
+
+  // Tests a counted loop using the fused add-immediate and compare-branch.
+  vm.export @test_loop_sum_i32
+  vm.func @test_loop_sum_i32() -> i32 {
+    %c1 = vm.const.i32 1 : i32
+    %c10 = vm.const.i32 10 : i32
+    %zero = vm.const.i32.zero : i32
+    vm.br ^loop(%zero, %zero : i32, i32)
+  ^loop(%i : i32, %sum : i32):
+    %sumn = vm.add.i32 %sum, %i : i32
+    %in = vm.add.i32 %i, %c1 : i32
+    %cmp = vm.cmp.lt.i32.s %in, %c10 : i32
+    vm.cond_br %cmp, ^loop(%in, %sumn : i32, i32), ^exit(%in, %sumn : i32, i32)
+  ^exit(%count : i32, %result : i32):
+    %count_eq = vm.cmp.eq.i32 %count, %c10 : i32
+    %expected = vm.const.i32 45 : i32
+    %result_eq = vm.cmp.eq.i32 %result, %expected : i32
+    %ok = vm.and.i32 %count_eq, %result_eq : i32
+    vm.return %ok : i32
+  }
+
+  vm.func @cond_br_eq_i32(%lhs : i32, %rhs : i32) -> i32
+      attributes {noinline} {
+    %cmp = vm.cmp.eq.i32 %lhs, %rhs : i32
+    vm.cond_br %cmp, ^true, ^false
+  ^true:
+    %c1 = vm.const.i32 1 : i32
+    vm.return %c1 : i32
+  ^false:
+    %zero = vm.const.i32.zero : i32
+    vm.return %zero : i32
+  }
+  vm.export @test_cond_br_eq_i32
+  vm.func @test_cond_br_eq_i32() -> i32 {
+    %c7 = vm.const.i32 7 : i32
+    %c8 = vm.const.i32 8 : i32
+    %true = vm.call @cond_br_eq_i32(%c7, %c7) : (i32, i32) -> i32
+    %false = vm.call @cond_br_eq_i32(%c7, %c8) : (i32, i32) -> i32
+    %one = vm.const.i32 1 : i32
+    %true_eq = vm.cmp.eq.i32 %true, %one : i32
+    %zero = vm.const.i32.zero : i32
+    %false_eq = vm.cmp.eq.i32 %false, %zero : i32
+    %ok = vm.and.i32 %true_eq, %false_eq : i32
+    vm.return %ok : i32
+  }
+
+  vm.func @cond_br_ne_i32(%lhs : i32, %rhs : i32) -> i32
+      attributes {noinline} {
+    %cmp = vm.cmp.ne.i32 %lhs, %rhs : i32
+    vm.cond_br %cmp, ^true, ^false
+  ^true:
+    %c1 = vm.const.i32 1 : i32
+    vm.return %c1 : i32
+  ^false:
+    %zero = vm.const.i32.zero : i32
+    vm.return %zero : i32
+  }
+  vm.export @test_cond_br_ne_i32
+  vm.func @test_cond_br_ne_i32() -> i32 {
+    %c7 = vm.const.i32 7 : i32
+    %c8 = vm.const.i32 8 : i32
+    %true = vm.call @cond_br_ne_i32(%c7, %c8) : (i32, i32) -> i32
+    %false = vm.call @cond_br_ne_i32(%c7, %c7) : (i32, i32) -> i32
+    %one = vm.const.i32 1 : i32
+    %true_eq = vm.cmp.eq.i32 %true, %one : i32
+    %zero = vm.const.i32.zero : i32
+    %false_eq = vm.cmp.eq.i32 %false, %zero : i32
+    %ok = vm.and.i32 %true_eq, %false_eq : i32
+    vm.return %ok : i32
+  }
+
+  vm.func @cond_br_lt_i32_s(%lhs : i32, %rhs : i32) -> i32
+      attributes {noinline} {
+    %cmp = vm.cmp.lt.i32.s %lhs, %rhs : i32
+    vm.cond_br %cmp, ^true, ^false
+  ^true:
+    %c1 = vm.const.i32 1 : i32
+    vm.return %c1 : i32
+  ^false:
+    %zero = vm.const.i32.zero : i32
+    vm.return %zero : i32
+  }
+  vm.export @test_cond_br_lt_i32_s
+  vm.func @test_cond_br_lt_i32_s() -> i32 {
+    %cn1 = vm.const.i32 -1 : i32
+    %c1 = vm.const.i32 1 : i32
+    %true = vm.call @cond_br_lt_i32_s(%cn1, %c1) : (i32, i32) -> i32
+    %false = vm.call @cond_br_lt_i32_s(%c1, %cn1) : (i32, i32) -> i32
+    %one = vm.const.i32 1 : i32
+    %true_eq = vm.cmp.eq.i32 %true, %one : i32
+    %zero = vm.const.i32.zero : i32
+    %false_eq = vm.cmp.eq.i32 %false, %zero : i32
+    %ok = vm.and.i32 %true_eq, %false_eq : i32
+    vm.return %ok : i32
+  }
+
+  vm.func @cond_br_lt_i32_u(%lhs : i32, %rhs : i32) -> i32
+      attributes {noinline} {
+    %cmp = vm.cmp.lt.i32.u %lhs, %rhs : i32
+    vm.cond_br %cmp, ^true, ^false
+  ^true:
+    %c1 = vm.const.i32 1 : i32
+    vm.return %c1 : i32
+  ^false:
+    %zero = vm.const.i32.zero : i32
+    vm.return %zero : i32
+  }
+  vm.export @test_cond_br_lt_i32_u
+  vm.func @test_cond_br_lt_i32_u() -> i32 {
+    %cn1 = vm.const.i32 -1 : i32
+    %c1 = vm.const.i32 1 : i32
+    %true = vm.call @cond_br_lt_i32_u(%c1, %cn1) : (i32, i32) -> i32
+    %false = vm.call @cond_br_lt_i32_u(%cn1, %c1) : (i32, i32) -> i32
+    %one = vm.const.i32 1 : i32
+    %true_eq = vm.cmp.eq.i32 %true, %one : i32
+    %zero = vm.const.i32.zero : i32
+    %false_eq = vm.cmp.eq.i32 %false, %zero : i32
+    %ok = vm.and.i32 %true_eq, %false_eq : i32
+    vm.return %ok : i32
+  }
+
+  vm.func @cond_br_lte_i32_s(%lhs : i32, %rhs : i32) -> i32
+      attributes {noinline} {
+    %cmp = vm.cmp.lte.i32.s %lhs, %rhs : i32
+    vm.cond_br %cmp, ^true, ^false
+  ^true:
+    %c1 = vm.const.i32 1 : i32
+    vm.return %c1 : i32
+  ^false:
+    %zero = vm.const.i32.zero : i32
+    vm.return %zero : i32
+  }
+  vm.export @test_cond_br_lte_i32_s
+  vm.func @test_cond_br_lte_i32_s() -> i32 {
+    %cn1 = vm.const.i32 -1 : i32
+    %c1 = vm.const.i32 1 : i32
+    %true = vm.call @cond_br_lte_i32_s(%cn1, %cn1) : (i32, i32) -> i32
+    %false = vm.call @cond_br_lte_i32_s(%c1, %cn1) : (i32, i32) -> i32
+    %one = vm.const.i32 1 : i32
+    %true_eq = vm.cmp.eq.i32 %true, %one : i32
+    %zero = vm.const.i32.zero : i32
+    %false_eq = vm.cmp.eq.i32 %false, %zero : i32
+    %ok = vm.and.i32 %true_eq, %false_eq : i32
+    vm.return %ok : i32
+  }
+
+  vm.func @cond_br_lte_i32_u(%lhs : i32, %rhs : i32) -> i32
+      attributes {noinline} {
+    %cmp = vm.cmp.lte.i32.u %lhs, %rhs : i32
+    vm.cond_br %cmp, ^true, ^false
+  ^true:
+    %c1 = vm.const.i32 1 : i32
+    vm.return %c1 : i32
+  ^false:
+    %zero = vm.const.i32.zero : i32
+    vm.return %zero : i32
+  }
+  vm.export @test_cond_br_lte_i32_u
+  vm.func @test_cond_br_lte_i32_u() -> i32 {
+    %cn1 = vm.const.i32 -1 : i32
+    %c1 = vm.const.i32 1 : i32
+    %true = vm.call @cond_br_lte_i32_u(%cn1, %cn1) : (i32, i32) -> i32
+    %false = vm.call @cond_br_lte_i32_u(%cn1, %c1) : (i32, i32) -> i32
+    %one = vm.const.i32 1 : i32
+    %true_eq = vm.cmp.eq.i32 %true, %one : i32
+    %zero = vm.const.i32.zero : i32
+    %false_eq = vm.cmp.eq.i32 %false, %zero : i32
+    %ok = vm.and.i32 %true_eq, %false_eq : i32
+    vm.return %ok : i32
+  }
+
+  vm.func @cond_br_gt_i32_s(%lhs : i32, %rhs : i32) -> i32
+      attributes {noinline} {
+    %cmp = vm.cmp.gt.i32.s %lhs, %rhs : i32
+    vm.cond_br %cmp, ^true, ^false
+  ^true:
+    %c1 = vm.const.i32 1 : i32
+    vm.return %c1 : i32
+  ^false:
+    %zero = vm.const.i32.zero : i32
+    vm.return %zero : i32
+  }
+  vm.export @test_cond_br_gt_i32_s
+  vm.func @test_cond_br_gt_i32_s() -> i32 {
+    %cn1 = vm.const.i32 -1 : i32
+    %c1 = vm.const.i32 1 : i32
+    %true = vm.call @cond_br_gt_i32_s(%c1, %cn1) : (i32, i32) -> i32
+    %false = vm.call @cond_br_gt_i32_s(%cn1, %c1) : (i32, i32) -> i32
+    %one = vm.const.i32 1 : i32
+    %true_eq = vm.cmp.eq.i32 %true, %one : i32
+    %zero = vm.const.i32.zero : i32
+    %false_eq = vm.cmp.eq.i32 %false, %zero : i32
+    %ok = vm.and.i32 %true_eq, %false_eq : i32
+    vm.return %ok : i32
+  }
+
+  vm.func @cond_br_gt_i32_u(%lhs : i32, %rhs : i32) -> i32
+      attributes {noinline} {
+    %cmp = vm.cmp.gt.i32.u %lhs, %rhs : i32
+    vm.cond_br %cmp, ^true, ^false
+  ^true:
+    %c1 = vm.const.i32 1 : i32
+    vm.return %c1 : i32
+  ^false:
+    %zero = vm.const.i32.zero : i32
+    vm.return %zero : i32
+  }
+  vm.export @test_cond_br_gt_i32_u
+  vm.func @test_cond_br_gt_i32_u() -> i32 {
+    %cn1 = vm.const.i32 -1 : i32
+    %c1 = vm.const.i32 1 : i32
+    %true = vm.call @cond_br_gt_i32_u(%cn1, %c1) : (i32, i32) -> i32
+    %false = vm.call @cond_br_gt_i32_u(%c1, %cn1) : (i32, i32) -> i32
+    %one = vm.const.i32 1 : i32
+    %true_eq = vm.cmp.eq.i32 %true, %one : i32
+    %zero = vm.const.i32.zero : i32
+    %false_eq = vm.cmp.eq.i32 %false, %zero : i32
+    %ok = vm.and.i32 %true_eq, %false_eq : i32
+    vm.return %ok : i32
+  }
+
+  vm.func @cond_br_gte_i32_s(%lhs : i32, %rhs : i32) -> i32
+      attributes {noinline} {
+    %cmp = vm.cmp.gte.i32.s %lhs, %rhs : i32
+    vm.cond_br %cmp, ^true, ^false
+  ^true:
+    %c1 = vm.const.i32 1 : i32
+    vm.return %c1 : i32
+  ^false:
+    %zero = vm.const.i32.zero : i32
+    vm.return %zero : i32
+  }
+  vm.export @test_cond_br_gte_i32_s
+  vm.func @test_cond_br_gte_i32_s() -> i32 {
+    %cn1 = vm.const.i32 -1 : i32
+    %c1 = vm.const.i32 1 : i32
+    %true = vm.call @cond_br_gte_i32_s(%c1, %c1) : (i32, i32) -> i32
+    %false = vm.call @cond_br_gte_i32_s(%cn1, %c1) : (i32, i32) -> i32
+    %one = vm.const.i32 1 : i32
+    %true_eq = vm.cmp.eq.i32 %true, %one : i32
+    %zero = vm.const.i32.zero : i32
+    %false_eq = vm.cmp.eq.i32 %false, %zero : i32
+    %ok = vm.and.i32 %true_eq, %false_eq : i32
+    vm.return %ok : i32
+  }
+
+  vm.func @cond_br_gte_i32_u(%lhs : i32, %rhs : i32) -> i32
+      attributes {noinline} {
+    %cmp = vm.cmp.gte.i32.u %lhs, %rhs : i32
+    vm.cond_br %cmp, ^true, ^false
+  ^true:
+    %c1 = vm.const.i32 1 : i32
+    vm.return %c1 : i32
+  ^false:
+    %zero = vm.const.i32.zero : i32
+    vm.return %zero : i32
+  }
+  vm.export @test_cond_br_gte_i32_u
+  vm.func @test_cond_br_gte_i32_u() -> i32 {
+    %cn1 = vm.const.i32 -1 : i32
+    %c1 = vm.const.i32 1 : i32
+    %true = vm.call @cond_br_gte_i32_u(%cn1, %cn1) : (i32, i32) -> i32
+    %false = vm.call @cond_br_gte_i32_u(%c1, %cn1) : (i32, i32) -> i32
+    %one = vm.const.i32 1 : i32
+    %true_eq = vm.cmp.eq.i32 %true, %one : i32
+    %zero = vm.const.i32.zero : i32
+    %false_eq = vm.cmp.eq.i32 %false, %zero : i32
+    %ok = vm.and.i32 %true_eq, %false_eq : i32
+    vm.return %ok : i32
+  }
 }
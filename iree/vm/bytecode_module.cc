@@ -16,8 +16,12 @@
 
 #include <string.h>
 
+#include <mutex>  // NOLINT
+#include <new>
+
 #include "iree/base/api.h"
 #include "iree/base/flatbuffer_util.h"
+#include "iree/base/lz4.h"
 #include "iree/vm/bytecode_module_impl.h"
 #include "iree/vm/ref.h"
 #include "iree/vm/stack.h"
@@ -73,6 +77,69 @@ static iree_status_t iree_vm_bytecode_module_resolve_types(
   return IREE_STATUS_OK;
 }
 
+// Compares |lhs| and |rhs| bytewise, ordering shorter strings first when one
+// is a prefix of the other. This matches the order the compiler sorts the
+// import and export tables in (llvm::StringRef::compare).
+static int iree_vm_bytecode_module_compare_str(const flatbuffers::String* lhs,
+                                               iree_string_view_t rhs) {
+  size_t lhs_size = lhs->size();
+  int cmp =
+      memcmp(lhs->data(), rhs.data, lhs_size < rhs.size ? lhs_size : rhs.size);
+  if (cmp != 0) return cmp;
+  return lhs_size < rhs.size ? -1 : (lhs_size > rhs.size ? 1 : 0);
+}
+
+// Returns true if the names returned by |get_name| for each entry in |defs|
+// are unique and sorted in iree_vm_bytecode_module_compare_str order.
+template <typename T, typename F>
+static bool iree_vm_bytecode_module_is_sorted(
+    const flatbuffers::Vector<flatbuffers::Offset<T>>* defs, F get_name) {
+  for (int i = 1; i < defs->size(); ++i) {
+    const auto* name = get_name(defs->Get(i));
+    if (iree_vm_bytecode_module_compare_str(
+            get_name(defs->Get(i - 1)),
+            iree_string_view_t{name->c_str(), name->size()}) >= 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Searches |defs| for the entry whose name returned by |get_name| is |name|.
+// Tables produced by the compiler are sorted (see
+// iree_vm_bytecode_module_is_sorted) and binary searched; tables from older
+// compilers may not be and are scanned linearly instead.
+// Returns the ordinal of the entry or -1 if not found.
+template <typename T, typename F>
+static int iree_vm_bytecode_module_find(
+    const flatbuffers::Vector<flatbuffers::Offset<T>>* defs, bool sorted,
+    iree_string_view_t name, F get_name) {
+  if (!sorted) {
+    for (int i = 0; i < defs->size(); ++i) {
+      if (iree_vm_bytecode_module_compare_str(get_name(defs->Get(i)), name) ==
+          0) {
+        return i;
+      }
+    }
+    return -1;
+  }
+  int low = 0;
+  int high = static_cast<int>(defs->size()) - 1;
+  while (low <= high) {
+    int mid = low + (high - low) / 2;
+    int cmp =
+        iree_vm_bytecode_module_compare_str(get_name(defs->Get(mid)), name);
+    if (cmp < 0) {
+      low = mid + 1;
+    } else if (cmp > 0) {
+      high = mid - 1;
+    } else {
+      return mid;
+    }
+  }
+  return -1;
+}
+
 // Verifies the structure of the flatbuffer so that we can avoid doing so during
 // runtime. There are still some conditions we must be aware of (such as omitted
 // names on functions with internal linkage), however we shouldn't need to
@@ -195,9 +262,47 @@ static iree_status_t iree_vm_bytecode_module_flatbuffer_verify(
     // TODO(benvanik): run bytecode verifier on contents.
   }
 
+  if (module_def->rodata_segments()) {
+    for (int i = 0; i < module_def->rodata_segments()->size(); ++i) {
+      auto* segment = module_def->rodata_segments()->Get(i);
+      if (!segment || !segment->data()) {
+        // All segments require data, even if empty.
+        return IREE_STATUS_INVALID_ARGUMENT;
+      }
+      switch (segment->compression_type_type()) {
+        case iree::vm::CompressionTypeDef::NONE:
+        case iree::vm::CompressionTypeDef::UncompressedDataDef:
+          break;
+        case iree::vm::CompressionTypeDef::LZ4CompressedDataDef: {
+          auto* lz4_def = segment->compression_type_as_LZ4CompressedDataDef();
+          if (!lz4_def || lz4_def->uncompressed_size() == 0 ||
+              lz4_def->uncompressed_size() > SIZE_MAX) {
+            // Compressed segments must decompress to something addressable.
+            return IREE_STATUS_INVALID_ARGUMENT;
+          }
+          break;
+        }
+        default:
+          // Unknown compression type.
+          return IREE_STATUS_INVALID_ARGUMENT;
+      }
+    }
+  }
+
   return IREE_STATUS_OK;
 }
 
+// Residency of a rodata segment within a module state.
+struct iree_vm_bytecode_rodata_residency_t {
+  // Ordinal of the first compressed segment sharing this segment's data, which
+  // owns the decompressed storage, or -1 if the segment is not compressed.
+  int32_t owner_ordinal = -1;
+  // Guards decompression of the segment when it is an owner.
+  std::once_flag once;
+  // Result of the decompression once it has been attempted.
+  iree_status_t status = IREE_STATUS_OK;
+};
+
 static iree_status_t iree_vm_bytecode_module_destroy(void* self) {
   iree_vm_bytecode_module_t* module = (iree_vm_bytecode_module_t*)self;
 
@@ -346,12 +451,6 @@ static iree_status_t iree_vm_bytecode_module_get_function_reflection_attr(
   return IREE_STATUS_OK;
 }
 
-static bool iree_vm_bytecode_module_compare_str(const flatbuffers::String* lhs,
-                                                iree_string_view_t rhs) {
-  if (!lhs || lhs->size() != rhs.size) return false;
-  return strncmp(lhs->c_str(), rhs.data, rhs.size) == 0;
-}
-
 static iree_status_t iree_vm_bytecode_module_lookup_function(
     void* self, iree_vm_function_linkage_t linkage, iree_string_view_t name,
     iree_vm_function_t* out_function) {
@@ -363,40 +462,42 @@ static iree_status_t iree_vm_bytecode_module_lookup_function(
   iree_vm_bytecode_module_t* module = (iree_vm_bytecode_module_t*)self;
   auto* module_def = IREE_VM_GET_MODULE_DEF(module);
 
-  // NOTE: we could organize imports/exports alphabetically so we could bsearch.
+  // Imports and exports are usually sorted by name so that we can bsearch
+  // them (see iree_vm_bytecode_module_create). Internal function names are
+  // only present for debugging and are scanned linearly.
   if (linkage == IREE_VM_FUNCTION_LINKAGE_IMPORT) {
     if (!module_def->imported_functions()) {
       return IREE_STATUS_NOT_FOUND;
     }
-    for (int ordinal = 0; ordinal < module_def->imported_functions()->size();
-         ++ordinal) {
-      auto* import_def = module_def->imported_functions()->Get(ordinal);
-      if (iree_vm_bytecode_module_compare_str(import_def->full_name(), name)) {
-        out_function->module = &module->interface;
-        out_function->linkage = linkage;
-        out_function->ordinal = ordinal;
-        return IREE_STATUS_OK;
-      }
-    }
-    return IREE_STATUS_NOT_FOUND;
+    int ordinal = iree_vm_bytecode_module_find(
+        module_def->imported_functions(), module->imports_sorted, name,
+        [](const iree::vm::ImportFunctionDef* import_def) {
+          return import_def->full_name();
+        });
+    if (ordinal == -1) return IREE_STATUS_NOT_FOUND;
+    out_function->module = &module->interface;
+    out_function->linkage = linkage;
+    out_function->ordinal = ordinal;
+    return IREE_STATUS_OK;
   } else if (linkage == IREE_VM_FUNCTION_LINKAGE_EXPORT) {
-    for (int ordinal = 0; ordinal < module_def->exported_functions()->size();
-         ++ordinal) {
-      auto* export_def = module_def->exported_functions()->Get(ordinal);
-      if (iree_vm_bytecode_module_compare_str(export_def->local_name(), name)) {
-        out_function->module = &module->interface;
-        out_function->linkage = IREE_VM_FUNCTION_LINKAGE_INTERNAL;
-        out_function->ordinal = export_def->internal_ordinal();
-        return IREE_STATUS_OK;
-      }
-    }
-    return IREE_STATUS_NOT_FOUND;
+    int ordinal = iree_vm_bytecode_module_find(
+        module_def->exported_functions(), module->exports_sorted, name,
+        [](const iree::vm::ExportFunctionDef* export_def) {
+          return export_def->local_name();
+        });
+    if (ordinal == -1) return IREE_STATUS_NOT_FOUND;
+    auto* export_def = module_def->exported_functions()->Get(ordinal);
+    out_function->module = &module->interface;
+    out_function->linkage = IREE_VM_FUNCTION_LINKAGE_INTERNAL;
+    out_function->ordinal = export_def->internal_ordinal();
+    return IREE_STATUS_OK;
   } else {
     for (int ordinal = 0; ordinal < module_def->internal_functions()->size();
          ++ordinal) {
       auto* function_def = module_def->internal_functions()->Get(ordinal);
-      if (iree_vm_bytecode_module_compare_str(function_def->local_name(),
-                                              name)) {
+      if (function_def->local_name() &&
+          iree_vm_bytecode_module_compare_str(function_def->local_name(),
+                                              name) == 0) {
         out_function->module = &module->interface;
         out_function->linkage = IREE_VM_FUNCTION_LINKAGE_INTERNAL;
         out_function->ordinal = ordinal;
@@ -407,6 +508,94 @@ static iree_status_t iree_vm_bytecode_module_lookup_function(
   }
 }
 
+static iree_status_t iree_vm_bytecode_module_free_state(
+    void* self, iree_vm_module_state_t* module_state) {
+  iree_vm_bytecode_module_state_t* state =
+      (iree_vm_bytecode_module_state_t*)module_state;
+  if (!state) return IREE_STATUS_INVALID_ARGUMENT;
+
+  // Release remaining global references.
+  for (int i = 0; i < state->global_ref_count; ++i) {
+    iree_vm_ref_release(&state->global_ref_table[i]);
+  }
+
+  // Free storage of rodata segments that were decompressed. Segments sharing
+  // data alias the storage of their owner.
+  for (int i = 0; i < state->rodata_ref_count; ++i) {
+    if (state->rodata_residency_table[i].owner_ordinal != i ||
+        !state->rodata_ref_table[i].data.data) {
+      continue;
+    }
+    iree_allocator_free(state->allocator,
+                        (void*)state->rodata_ref_table[i].data.data);
+  }
+  for (int i = 0; i < state->rodata_ref_count; ++i) {
+    state->rodata_residency_table[i].~iree_vm_bytecode_rodata_residency_t();
+  }
+
+  return state->allocator.free(state->allocator.self, module_state);
+}
+
+// Decompresses the compressed rodata segment |ordinal| into storage owned by
+// |module_state| and updates all rodata references sharing the segment data.
+// Must only be called once per owner segment (see
+// iree_vm_bytecode_module_resolve_rodata).
+static iree_status_t iree_vm_bytecode_module_decompress_rodata(
+    const iree::vm::BytecodeModuleDef* module_def,
+    iree_vm_bytecode_module_state_t* module_state, int32_t ordinal) {
+  const auto* segments = module_def->rodata_segments();
+  const auto* segment = segments->Get(ordinal);
+  const auto* lz4_def = segment->compression_type_as_LZ4CompressedDataDef();
+
+  iree_byte_span_t storage = {NULL,
+                              (iree_host_size_t)lz4_def->uncompressed_size()};
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      module_state->allocator, storage.data_length, (void**)&storage.data));
+  iree_status_t status = iree_lz4_decompress(
+      {segment->data()->Data(), segment->data()->size()}, storage);
+  if (!iree_status_is_ok(status)) {
+    iree_allocator_free(module_state->allocator, storage.data);
+    return status;
+  }
+
+  // Segments deduplicated by the compiler share their compressed data and can
+  // share the decompressed storage as well.
+  for (int i = ordinal; i < module_state->rodata_ref_count; ++i) {
+    if (module_state->rodata_residency_table[i].owner_ordinal == ordinal) {
+      module_state->rodata_ref_table[i].data.data = storage.data;
+      module_state->rodata_ref_table[i].data.data_length = storage.data_length;
+    }
+  }
+  return IREE_STATUS_OK;
+}
+
+iree_status_t iree_vm_bytecode_module_resolve_rodata(
+    iree_vm_bytecode_module_t* module,
+    iree_vm_bytecode_module_state_t* module_state, int32_t ordinal,
+    iree_vm_ro_byte_buffer_t** out_rodata) {
+  *out_rodata = NULL;
+  if (ordinal < 0 || ordinal >= module_state->rodata_ref_count) {
+    return IREE_STATUS_OUT_OF_RANGE;
+  }
+  iree_vm_bytecode_rodata_residency_t* residency =
+      &module_state->rodata_residency_table[ordinal];
+  if (residency->owner_ordinal >= 0) {
+    // Invocations within a context may run on multiple threads. The owner's
+    // once flag ensures a single decompression and orders the writes to the
+    // table before any caller returns.
+    iree_vm_bytecode_rodata_residency_t* owner =
+        &module_state->rodata_residency_table[residency->owner_ordinal];
+    std::call_once(owner->once, [&]() {
+      owner->status = iree_vm_bytecode_module_decompress_rodata(
+          IREE_VM_GET_MODULE_DEF(module), module_state,
+          residency->owner_ordinal);
+    });
+    IREE_RETURN_IF_ERROR(owner->status);
+  }
+  *out_rodata = &module_state->rodata_ref_table[ordinal];
+  return IREE_STATUS_OK;
+}
+
 static iree_status_t iree_vm_bytecode_module_alloc_state(
     void* self, iree_allocator_t allocator,
     iree_vm_module_state_t** out_module_state) {
@@ -436,6 +625,13 @@ static iree_status_t iree_vm_bytecode_module_alloc_state(
   total_state_struct_size +=
       rodata_ref_count * sizeof(iree_vm_ro_byte_buffer_t);
   total_state_struct_size += import_function_count * sizeof(iree_vm_function_t);
+  const iree_host_size_t residency_alignment =
+      alignof(iree_vm_bytecode_rodata_residency_t);
+  total_state_struct_size =
+      (total_state_struct_size + residency_alignment - 1) &
+      ~(residency_alignment - 1);
+  total_state_struct_size +=
+      rodata_ref_count * sizeof(iree_vm_bytecode_rodata_residency_t);
 
   iree_vm_bytecode_module_state_t* state = NULL;
   IREE_RETURN_IF_ERROR(iree_allocator_malloc(allocator, total_state_struct_size,
@@ -455,34 +651,42 @@ static iree_status_t iree_vm_bytecode_module_alloc_state(
   state->import_count = import_function_count;
   state->import_table = (iree_vm_function_t*)p;
   p += import_function_count * sizeof(*state->import_table);
+  p = (uint8_t*)state + (((p - (uint8_t*)state) + residency_alignment - 1) &
+                          ~(residency_alignment - 1));
+  state->rodata_residency_table = (iree_vm_bytecode_rodata_residency_t*)p;
+  p += rodata_ref_count * sizeof(*state->rodata_residency_table);
 
+  const auto* segments = module_def->rodata_segments();
   for (int i = 0; i < rodata_ref_count; ++i) {
-    const iree::vm::RodataSegmentDef* segment =
-        module_def->rodata_segments()->Get(i);
+    const iree::vm::RodataSegmentDef* segment = segments->Get(i);
     iree_vm_ro_byte_buffer_t* ref = &state->rodata_ref_table[i];
+    iree_vm_bytecode_rodata_residency_t* residency =
+        new (&state->rodata_residency_table[i])
+            iree_vm_bytecode_rodata_residency_t();
     ref->ref_object.counter = 1;
-    ref->data.data = segment->data()->Data();
-    ref->data.data_length = segment->data()->size();
+    ref->destroy = NULL;
+    if (segment->compression_type_type() !=
+        iree::vm::CompressionTypeDef::LZ4CompressedDataDef) {
+      ref->data.data = segment->data()->Data();
+      ref->data.data_length = segment->data()->size();
+      continue;
+    }
+    // Compressed segments are decompressed on first use into storage owned by
+    // the first segment sharing the same data.
+    ref->data = {NULL, 0};
+    residency->owner_ordinal = i;
+    for (int j = 0; j < i; ++j) {
+      if (segments->Get(j)->data() == segment->data()) {
+        residency->owner_ordinal = j;
+        break;
+      }
+    }
   }
 
   *out_module_state = (iree_vm_module_state_t*)state;
   return IREE_STATUS_OK;
 }
 
-static iree_status_t iree_vm_bytecode_module_free_state(
-    void* self, iree_vm_module_state_t* module_state) {
-  iree_vm_bytecode_module_state_t* state =
-      (iree_vm_bytecode_module_state_t*)module_state;
-  if (!state) return IREE_STATUS_INVALID_ARGUMENT;
-
-  // Release remaining global references.
-  for (int i = 0; i < state->global_ref_count; ++i) {
-    iree_vm_ref_release(&state->global_ref_table[i]);
-  }
-
-  return state->allocator.free(state->allocator.self, module_state);
-}
-
 static iree_status_t iree_vm_bytecode_module_resolve_import(
     void* self, iree_vm_module_state_t* module_state, int32_t ordinal,
     iree_vm_function_t function) {
@@ -520,12 +724,17 @@ static iree_status_t iree_vm_bytecode_module_execute(
     return IREE_STATUS_INVALID_ARGUMENT;
   }
 
+  // Callers only size the frame for the arguments and results so grow it to
+  // hold all of the registers used by the function.
   const iree_vm_function_descriptor_t* function_descriptor =
       &module->function_descriptor_table[frame->function.ordinal];
+  IREE_RETURN_IF_ERROR(iree_vm_stack_frame_reserve_registers(
+      stack, frame, function_descriptor->i32_register_count,
+      function_descriptor->ref_register_count));
   iree_vm_registers_t* regs = &frame->registers;
   memset(&regs->ref[regs->ref_register_count], 0,
-         sizeof(iree_vm_ref_t) * (function_descriptor->ref_register_count -
-                                  regs->ref_register_count));
+         sizeof(iree_vm_ref_t) *
+             (regs->ref_register_capacity - regs->ref_register_count));
 
   return iree_vm_bytecode_dispatch(
       module, (iree_vm_bytecode_module_state_t*)frame->module_state, stack,
@@ -578,6 +787,21 @@ IREE_API_EXPORT iree_status_t IREE_API_CALL iree_vm_bytecode_module_create(
                                              sizeof(iree_vm_bytecode_module_t));
   iree_vm_bytecode_module_resolve_types(module_def, module->type_table);
 
+  // Modules from compilers that did not sort their import and export tables
+  // remain loadable but fall back to linear name lookups.
+  module->imports_sorted =
+      !module_def->imported_functions() ||
+      iree_vm_bytecode_module_is_sorted(
+          module_def->imported_functions(),
+          [](const iree::vm::ImportFunctionDef* import_def) {
+            return import_def->full_name();
+          });
+  module->exports_sorted = iree_vm_bytecode_module_is_sorted(
+      module_def->exported_functions(),
+      [](const iree::vm::ExportFunctionDef* export_def) {
+        return export_def->local_name();
+      });
+
   iree_vm_module_init(&module->interface, module);
   module->interface.destroy = iree_vm_bytecode_module_destroy;
   module->interface.name = iree_vm_bytecode_module_name;
@@ -12,14 +12,25 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <memory>
+#include <utility>
+#include <vector>
+
 #include "absl/container/inlined_vector.h"
+#include "absl/memory/memory.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "benchmark/benchmark.h"
 #include "iree/base/api.h"
 #include "iree/base/logging.h"
+#include "iree/base/status.h"
 #include "iree/vm/bytecode_module.h"
 #include "iree/vm/bytecode_module_benchmark_module.h"
+#include "iree/vm/context.h"
+#include "iree/vm/instance.h"
+#include "iree/vm/invocation.h"
 #include "iree/vm/module.h"
+#include "iree/vm/module_abi_cc.h"
 #include "iree/vm/stack.h"
 
 namespace {
@@ -77,7 +88,9 @@ static iree_status_t RunFunction(benchmark::State& state,
       }};
 
   auto stack = std::make_unique<iree_vm_stack_t>();
-  iree_vm_stack_init(state_resolver, stack.get());
+  IREE_ALIGNAS(16) uint8_t frame_storage[IREE_VM_STACK_INLINE_STORAGE_SIZE];
+  iree_vm_stack_init(iree_byte_span_t{frame_storage, sizeof(frame_storage)},
+                     state_resolver, IREE_ALLOCATOR_SYSTEM, stack.get());
 
   iree_vm_function_t function;
   IREE_CHECK_OK(module->lookup_function(
@@ -88,7 +101,9 @@ static iree_status_t RunFunction(benchmark::State& state,
 
   while (state.KeepRunningBatch(batch_size)) {
     iree_vm_stack_frame_t* entry_frame;
-    iree_vm_stack_function_enter(stack.get(), function, &entry_frame);
+    iree_vm_stack_function_enter(stack.get(), function,
+                                 static_cast<int32_t>(i32_args.size()), 0,
+                                 &entry_frame);
     // TODO(benvanik): replace direct register manipulation with setter:
     //   iree_vm_stack_frame_set_arguments(entry_frame, 1, i32_args, 0, {});
     for (int i = 0; i < i32_args.size(); ++i) {
@@ -110,6 +125,93 @@ static iree_status_t RunFunction(benchmark::State& state,
   return IREE_STATUS_OK;
 }
 
+// Native module providing the imports of the benchmark module so that it can
+// be registered in a context.
+class BenchmarkModuleState final {
+ public:
+  iree::StatusOr<int32_t> ImportedFunc(int32_t value) { return value + 1; }
+};
+
+static const iree::vm::NativeFunction<BenchmarkModuleState>
+    kBenchmarkModuleFunctions[] = {
+        iree::vm::MakeNativeFunction("imported_func",
+                                     &BenchmarkModuleState::ImportedFunc),
+};
+
+class BenchmarkModule final
+    : public iree::vm::NativeModule<BenchmarkModuleState> {
+ public:
+  explicit BenchmarkModule(iree_allocator_t allocator)
+      : iree::vm::NativeModule<BenchmarkModuleState>(
+            "benchmark", allocator,
+            absl::MakeConstSpan(kBenchmarkModuleFunctions)) {}
+
+  iree::StatusOr<std::unique_ptr<BenchmarkModuleState>> CreateState(
+      iree_allocator_t allocator) override {
+    return absl::make_unique<BenchmarkModuleState>();
+  }
+};
+
+// Benchmarks the given exported function through a context, either with
+// iree_vm_invoke or with a reusable iree_vm_invoker_t performing |batch_size|
+// calls per iteration.
+static iree_status_t RunContextFunction(benchmark::State& state,
+                                        absl::string_view function_name,
+                                        bool use_invoker, int batch_size = 1) {
+  iree_vm_instance_t* instance = nullptr;
+  IREE_CHECK_OK(iree_vm_instance_create(IREE_ALLOCATOR_SYSTEM, &instance));
+
+  iree_vm_module_t* import_module =
+      (new BenchmarkModule(IREE_ALLOCATOR_SYSTEM))->interface();
+  const auto* module_file_toc =
+      iree::vm::bytecode_module_benchmark_module_create();
+  iree_vm_module_t* bytecode_module = nullptr;
+  IREE_CHECK_OK(iree_vm_bytecode_module_create(
+      iree_const_byte_span_t{
+          reinterpret_cast<const uint8_t*>(module_file_toc->data),
+          module_file_toc->size},
+      IREE_ALLOCATOR_NULL, IREE_ALLOCATOR_SYSTEM, &bytecode_module))
+      << "Bytecode module failed to load";
+
+  std::vector<iree_vm_module_t*> modules = {import_module, bytecode_module};
+  iree_vm_context_t* context = nullptr;
+  IREE_CHECK_OK(iree_vm_context_create_with_modules(
+      instance, modules.data(), modules.size(), IREE_ALLOCATOR_SYSTEM,
+      &context));
+
+  iree_vm_function_t function;
+  IREE_CHECK_OK(bytecode_module->lookup_function(
+      bytecode_module->self, IREE_VM_FUNCTION_LINKAGE_EXPORT,
+      iree_string_view_t{function_name.data(), function_name.size()},
+      &function))
+      << "Exported function '" << function_name << "' not found";
+
+  if (use_invoker) {
+    iree_vm_invoker_t* invoker = nullptr;
+    IREE_CHECK_OK(iree_vm_invoker_create(context, function,
+                                         IREE_ALLOCATOR_SYSTEM, &invoker));
+    while (state.KeepRunningBatch(batch_size)) {
+      IREE_CHECK_OK(iree_vm_invoker_invoke_batch(invoker, batch_size,
+                                                 /*inputs=*/nullptr,
+                                                 /*outputs=*/nullptr));
+    }
+    iree_vm_invoker_release(invoker);
+  } else {
+    while (state.KeepRunning()) {
+      IREE_CHECK_OK(iree_vm_invoke(context, function, /*policy=*/nullptr,
+                                   /*inputs=*/nullptr, /*outputs=*/nullptr,
+                                   IREE_ALLOCATOR_SYSTEM));
+    }
+  }
+
+  iree_vm_context_release(context);
+  iree_vm_module_release(bytecode_module);
+  iree_vm_module_release(import_module);
+  iree_vm_instance_release(instance);
+
+  return IREE_STATUS_OK;
+}
+
 static void BM_ModuleCreate(benchmark::State& state) {
   while (state.KeepRunning()) {
     const auto* module_file_toc =
@@ -156,6 +258,50 @@ static void BM_ModuleCreateState(benchmark::State& state) {
 }
 BENCHMARK(BM_ModuleCreateState);
 
+static void BM_ModuleLookupFunction(benchmark::State& state) {
+  const auto* module_file_toc =
+      iree::vm::bytecode_module_benchmark_module_create();
+  iree_vm_module_t* module = nullptr;
+  IREE_CHECK_OK(iree_vm_bytecode_module_create(
+      iree_const_byte_span_t{
+          reinterpret_cast<const uint8_t*>(module_file_toc->data),
+          module_file_toc->size},
+      IREE_ALLOCATOR_NULL, IREE_ALLOCATOR_SYSTEM, &module))
+      << "Bytecode module failed to load";
+
+  // Resolves every export and import by name as a context would when
+  // resolving imports against this module.
+  std::vector<std::pair<iree_vm_function_linkage_t, iree_string_view_t>>
+      names;
+  auto signature = module->signature(module->self);
+  for (int i = 0; i < signature.export_function_count; ++i) {
+    iree_string_view_t name;
+    IREE_CHECK_OK(module->get_function(module->self,
+                                       IREE_VM_FUNCTION_LINKAGE_EXPORT, i,
+                                       nullptr, &name, nullptr));
+    names.push_back({IREE_VM_FUNCTION_LINKAGE_EXPORT, name});
+  }
+  for (int i = 0; i < signature.import_function_count; ++i) {
+    iree_string_view_t name;
+    IREE_CHECK_OK(module->get_function(module->self,
+                                       IREE_VM_FUNCTION_LINKAGE_IMPORT, i,
+                                       nullptr, &name, nullptr));
+    names.push_back({IREE_VM_FUNCTION_LINKAGE_IMPORT, name});
+  }
+
+  while (state.KeepRunningBatch(names.size())) {
+    for (const auto& linkage_name : names) {
+      iree_vm_function_t function;
+      IREE_CHECK_OK(module->lookup_function(module->self, linkage_name.first,
+                                            linkage_name.second, &function));
+      benchmark::DoNotOptimize(function);
+    }
+  }
+
+  module->destroy(module->self);
+}
+BENCHMARK(BM_ModuleLookupFunction);
+
 static void BM_FullModuleInit(benchmark::State& state) {
   while (state.KeepRunning()) {
     const auto* module_file_toc =
@@ -198,6 +344,22 @@ static void BM_EmptyFuncBytecode(benchmark::State& state) {
 }
 BENCHMARK(BM_EmptyFuncBytecode);
 
+static void BM_EmptyFuncInvoke(benchmark::State& state) {
+  IREE_CHECK_OK(RunContextFunction(state, "empty_func", /*use_invoker=*/false));
+}
+BENCHMARK(BM_EmptyFuncInvoke);
+
+static void BM_EmptyFuncInvoker(benchmark::State& state) {
+  IREE_CHECK_OK(RunContextFunction(state, "empty_func", /*use_invoker=*/true));
+}
+BENCHMARK(BM_EmptyFuncInvoker);
+
+static void BM_EmptyFuncInvokerBatch(benchmark::State& state) {
+  IREE_CHECK_OK(RunContextFunction(state, "empty_func", /*use_invoker=*/true,
+                                   /*batch_size=*/state.range(0)));
+}
+BENCHMARK(BM_EmptyFuncInvokerBatch)->Arg(16)->Arg(256);
+
 static void BM_CallInternalFuncReference(benchmark::State& state) {
   static auto add_fn = +[](int value) {
     benchmark::DoNotOptimize(value += value);
@@ -288,4 +450,29 @@ static void BM_LoopSumBytecode(benchmark::State& state) {
 }
 BENCHMARK(BM_LoopSumBytecode)->Arg(100000);
 
+static void BM_LoopNestedSumReference(benchmark::State& state) {
+  static auto loop = +[](int count) {
+    int sum = 0;
+    for (int i = 0; i < count; i += 10) {
+      for (int j = 0; j < 10; ++j) {
+        benchmark::DoNotOptimize(sum += j);
+      }
+    }
+    return sum;
+  };
+  while (state.KeepRunningBatch(state.range(0))) {
+    int ret = loop(state.range(0));
+    benchmark::DoNotOptimize(ret);
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK(BM_LoopNestedSumReference)->Arg(100000);
+
+static void BM_LoopNestedSumBytecode(benchmark::State& state) {
+  IREE_CHECK_OK(RunFunction(state, "loop_nested_sum",
+                            {static_cast<int32_t>(state.range(0))},
+                            /*batch_size=*/state.range(0)));
+}
+BENCHMARK(BM_LoopNestedSumBytecode)->Arg(100000);
+
 }  // namespace
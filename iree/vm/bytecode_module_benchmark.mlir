@@ -54,4 +54,28 @@ vm.module @bytecode_module_benchmark {
   ^loop_exit(%ie : i32):
     vm.return %ie : i32
   }
+
+  // Measures the cost of a nested loop carrying multiple values across
+  // branches. The inner loop runs 10 times per outer iteration such that
+  // %count total inner iterations are performed.
+  vm.export @loop_nested_sum
+  vm.func @loop_nested_sum(%count : i32) -> i32 {
+    %c1 = vm.const.i32 1 : i32
+    %c10 = vm.const.i32 10 : i32
+    %zero = vm.const.i32.zero : i32
+    vm.br ^outer(%zero, %zero : i32, i32)
+  ^outer(%i : i32, %sum : i32):
+    vm.br ^inner(%zero, %sum : i32, i32)
+  ^inner(%j : i32, %acc : i32):
+    %accn = vm.add.i32 %acc, %j : i32
+    %jn = vm.add.i32 %j, %c1 : i32
+    %jcmp = vm.cmp.lt.i32.s %jn, %c10 : i32
+    vm.cond_br %jcmp, ^inner(%jn, %accn : i32, i32), ^outer_latch(%accn : i32)
+  ^outer_latch(%sumn : i32):
+    %in = vm.add.i32 %i, %c10 : i32
+    %icmp = vm.cmp.lt.i32.s %in, %count : i32
+    vm.cond_br %icmp, ^outer(%in, %sumn : i32, i32), ^exit(%sumn : i32)
+  ^exit(%result : i32):
+    vm.return %result : i32
+  }
 }
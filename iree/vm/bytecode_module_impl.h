@@ -15,6 +15,7 @@
 #ifndef IREE_VM_BYTECODE_MODULE_IMPL_H_
 #define IREE_VM_BYTECODE_MODULE_IMPL_H_
 
+#include <stdbool.h>
 #include <stdint.h>
 
 #include "iree/base/api.h"
@@ -71,6 +72,11 @@ typedef struct {
   // Type table mapping module type IDs to registered VM types.
   int32_t type_count;
   iree_vm_type_def_t* type_table;
+
+  // Whether the import and export tables are sorted by name and can be
+  // binary searched during lookup.
+  bool imports_sorted;
+  bool exports_sorted;
 } iree_vm_bytecode_module_t;
 
 // Per-instance module state.
@@ -91,10 +97,14 @@ typedef struct {
 
   // TODO(benvanik): move to iree_vm_bytecode_module_t if always static.
   // Initialized references to rodata segments.
-  // Right now these don't do much, however we can perform lazy caching and
-  // on-the-fly decompression using this information.
+  // Compressed segments have NULL data until they are first used, at which
+  // point they are decompressed into storage owned by the state. Always access
+  // entries with iree_vm_bytecode_module_resolve_rodata.
   int32_t rodata_ref_count;
   iree_vm_ro_byte_buffer_t* rodata_ref_table;
+  // Per-segment residency tracking guarding the decompression, indexed by
+  // rodata ordinal. Opaque to C; defined in bytecode_module.cc.
+  struct iree_vm_bytecode_rodata_residency_t* rodata_residency_table;
 
   // Resolved function imports.
   int32_t import_count;
@@ -104,6 +114,16 @@ typedef struct {
   iree_allocator_t allocator;
 } iree_vm_bytecode_module_state_t;
 
+// Returns the rodata reference for segment |ordinal| in |out_rodata|.
+// Compressed segments are decompressed into storage owned by |module_state| on
+// first use and all references sharing the segment data are updated. Safe to
+// call concurrently: exactly one caller decompresses a segment and all others
+// wait for (and observe) the published storage.
+iree_status_t iree_vm_bytecode_module_resolve_rodata(
+    iree_vm_bytecode_module_t* module,
+    iree_vm_bytecode_module_state_t* module_state, int32_t ordinal,
+    iree_vm_ro_byte_buffer_t** out_rodata);
+
 // Begins (or resumes) execution of the given |entry_frame| and continues until
 // either a yield or return. |out_result| will contain the result status for
 // continuation, if needed.
@@ -51,12 +51,28 @@ static iree_status_t iree_vm_context_query_module_state(
   return IREE_STATUS_NOT_FOUND;
 }
 
+// Returns the module registered in |context| named |module_name| or NULL.
+// Modules registered later take precedence over earlier ones.
+static iree_vm_module_t* iree_vm_context_find_module(
+    const iree_vm_context_t* context, iree_string_view_t module_name) {
+  for (int i = context->list.count - 1; i >= 0; --i) {
+    iree_vm_module_t* module = context->list.modules[i];
+    if (iree_string_view_compare(module_name, iree_vm_module_name(module)) ==
+        0) {
+      return module;
+    }
+  }
+  return NULL;
+}
+
 static iree_status_t iree_vm_context_resolve_module_imports(
     iree_vm_context_t* context, iree_vm_module_t* module,
     iree_vm_module_state_t* module_state) {
-  // NOTE: this has some bad characteristics, but the number of modules and the
-  // number of imported functions should be relatively small (even if the number
-  // of exported functions for particular modules is large).
+  // Imports are sorted by their fully-qualified name and thus grouped by the
+  // module they come from; we only scan the module list when the module
+  // changes and rely on the exporting module for fast lookup within it.
+  iree_vm_module_t* import_module = NULL;
+  iree_string_view_t import_module_name = {NULL, 0};
   iree_vm_module_signature_t module_signature = module->signature(module->self);
   for (int i = 0; i < module_signature.import_function_count; ++i) {
     iree_string_view_t full_name;
@@ -65,9 +81,22 @@ static iree_status_t iree_vm_context_resolve_module_imports(
                              /*out_function=*/NULL,
                              /*out_name=*/&full_name,
                              /*out_signature=*/NULL));
+    iree_string_view_t module_name;
+    iree_string_view_t function_name;
+    if (iree_string_view_split(full_name, '.', &module_name, &function_name) ==
+        -1) {
+      return IREE_STATUS_INVALID_ARGUMENT;
+    }
+    if (!import_module ||
+        iree_string_view_compare(module_name, import_module_name) != 0) {
+      import_module = iree_vm_context_find_module(context, module_name);
+      if (!import_module) return IREE_STATUS_NOT_FOUND;
+      import_module_name = module_name;
+    }
     iree_vm_function_t import_function;
-    IREE_RETURN_IF_ERROR(
-        iree_vm_context_resolve_function(context, full_name, &import_function));
+    IREE_RETURN_IF_ERROR(iree_vm_module_lookup_function_by_name(
+        import_module, IREE_VM_FUNCTION_LINKAGE_EXPORT, function_name,
+        &import_function));
     IREE_RETURN_IF_ERROR(
         module->resolve_import(module->self, module_state, i, import_function));
   }
@@ -78,7 +107,7 @@ static iree_status_t iree_vm_invoke_empty_function(
     iree_vm_stack_t* stack, iree_vm_function_t function) {
   iree_vm_stack_frame_t* callee_frame = NULL;
   iree_status_t status =
-      iree_vm_stack_function_enter(stack, function, &callee_frame);
+      iree_vm_stack_function_enter(stack, function, 0, 0, &callee_frame);
   if (!iree_status_is_ok(status)) {
     return status;
   }
@@ -198,23 +227,19 @@ static iree_status_t iree_vm_context_destroy(iree_vm_context_t* context) {
   }
 
   if (context->list.count > 0) {
-    // Allocate a scratch stack used for initialization.
-    // If we shrunk the stack (or made it so that it could dynamically grow)
-    // then we could stack-allocate it here and not need the allocator at all.
-    iree_vm_stack_t* stack = NULL;
-    IREE_RETURN_IF_ERROR(iree_allocator_malloc(
-        context->allocator, sizeof(iree_vm_stack_t), (void**)&stack));
-    iree_status_t status =
-        iree_vm_stack_init(iree_vm_context_state_resolver(context), stack);
-    if (!iree_status_is_ok(status)) {
-      iree_allocator_free(context->allocator, stack);
-      return status;
-    }
+    // Allocate a scratch stack used for deinitialization.
+    iree_vm_stack_t stack_storage;
+    iree_vm_stack_t* stack = &stack_storage;
+    IREE_ALIGNAS(16) uint8_t frame_storage[IREE_VM_STACK_INLINE_STORAGE_SIZE];
+    iree_byte_span_t frame_storage_span = {frame_storage,
+                                           sizeof(frame_storage)};
+    IREE_RETURN_IF_ERROR(iree_vm_stack_init(
+        frame_storage_span, iree_vm_context_state_resolver(context),
+        context->allocator, stack));
 
     iree_vm_context_release_modules(context, stack, 0, context->list.count - 1);
 
     iree_vm_stack_deinit(stack);
-    iree_allocator_free(context->allocator, stack);
   }
 
   // Note: For non-static module lists, it is only dynamically allocated if
@@ -314,17 +339,13 @@ IREE_API_EXPORT iree_status_t IREE_API_CALL iree_vm_context_register_modules(
   }
 
   // Allocate a scratch stack used for initialization.
-  // If we shrunk the stack (or made it so that it could dynamically grow)
-  // then we could stack-allocate it here and not need the allocator at all.
-  iree_vm_stack_t* stack = NULL;
-  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
-      context->allocator, sizeof(iree_vm_stack_t), (void**)&stack));
-  iree_status_t status =
-      iree_vm_stack_init(iree_vm_context_state_resolver(context), stack);
-  if (!iree_status_is_ok(status)) {
-    iree_allocator_free(context->allocator, stack);
-    return status;
-  }
+  iree_vm_stack_t stack_storage;
+  iree_vm_stack_t* stack = &stack_storage;
+  IREE_ALIGNAS(16) uint8_t frame_storage[IREE_VM_STACK_INLINE_STORAGE_SIZE];
+  iree_byte_span_t frame_storage_span = {frame_storage, sizeof(frame_storage)};
+  IREE_RETURN_IF_ERROR(iree_vm_stack_init(
+      frame_storage_span, iree_vm_context_state_resolver(context),
+      context->allocator, stack));
 
   // Retain all modules and allocate their state.
   assert(context->list.capacity >= context->list.count + module_count);
@@ -346,7 +367,6 @@ IREE_API_EXPORT iree_status_t IREE_API_CALL iree_vm_context_register_modules(
                                       orig_count + i);
       context->list.count = orig_count;
       iree_vm_stack_deinit(stack);
-      iree_allocator_free(context->allocator, stack);
       return alloc_status;
     }
     context->list.module_states[orig_count + i] = module_state;
@@ -361,7 +381,6 @@ IREE_API_EXPORT iree_status_t IREE_API_CALL iree_vm_context_register_modules(
                                       orig_count + i);
       context->list.count = orig_count;
       iree_vm_stack_deinit(stack);
-      iree_allocator_free(context->allocator, stack);
       return resolve_status;
     }
 
@@ -382,14 +401,12 @@ IREE_API_EXPORT iree_status_t IREE_API_CALL iree_vm_context_register_modules(
                                         orig_count + i);
         context->list.count = orig_count;
         iree_vm_stack_deinit(stack);
-        iree_allocator_free(context->allocator, stack);
         return init_status;
       }
     }
   }
 
   iree_vm_stack_deinit(stack);
-  iree_allocator_free(context->allocator, stack);
   return IREE_STATUS_OK;
 }
 
@@ -408,14 +425,8 @@ IREE_API_EXPORT iree_status_t IREE_API_CALL iree_vm_context_resolve_function(
     return IREE_STATUS_INVALID_ARGUMENT;
   }
 
-  for (int i = context->list.count - 1; i >= 0; --i) {
-    iree_vm_module_t* module = context->list.modules[i];
-    if (iree_string_view_compare(module_name, iree_vm_module_name(module)) ==
-        0) {
-      return iree_vm_module_lookup_function_by_name(
-          module, IREE_VM_FUNCTION_LINKAGE_EXPORT, function_name, out_function);
-    }
-  }
-
-  return IREE_STATUS_NOT_FOUND;
+  iree_vm_module_t* module = iree_vm_context_find_module(context, module_name);
+  if (!module) return IREE_STATUS_NOT_FOUND;
+  return iree_vm_module_lookup_function_by_name(
+      module, IREE_VM_FUNCTION_LINKAGE_EXPORT, function_name, out_function);
 }
@@ -14,6 +14,55 @@
 
 #include "iree/vm/invocation.h"
 
+#include <stdatomic.h>
+#include <string.h>
+
+#include "iree/vm/stack.h"
+
+struct iree_vm_invocation {
+  atomic_intptr_t ref_count;
+  iree_allocator_t allocator;
+  iree_vm_context_t* context;
+  iree_vm_function_t function;
+
+  // Fiber stack the invocation executes on. Frames remain on the stack while
+  // the invocation is suspended.
+  iree_vm_stack_t stack;
+  // Entry frame of the invocation or NULL once the invocation has completed
+  // and the stack has been torn down.
+  iree_vm_stack_frame_t* entry_frame;
+  // Describes how the last execution suspended, if it did.
+  iree_vm_execution_result_t result;
+
+  // Outputs of the function, populated if the invocation completes
+  // successfully.
+  iree_vm_variant_list_t* outputs;
+
+  // Completion status or IREE_STATUS_UNAVAILABLE while in-flight.
+  atomic_int status;
+  // Non-zero if an abort has been requested.
+  atomic_int abort_requested;
+
+  // Inline storage for the first frames of the stack.
+  IREE_ALIGNAS(16) uint8_t stack_storage[IREE_VM_STACK_INLINE_STORAGE_SIZE];
+};
+
+struct iree_vm_invoker {
+  atomic_intptr_t ref_count;
+  iree_allocator_t allocator;
+  iree_vm_context_t* context;
+  iree_vm_function_t function;
+
+  // Register count of each bank in the entry frame, derived from the function
+  // signature once instead of per call.
+  int32_t register_count;
+
+  // Stack reused across calls. Frame storage allocated beyond the inline
+  // storage is retained by the stack for subsequent calls.
+  iree_vm_stack_t stack;
+  IREE_ALIGNAS(16) uint8_t stack_storage[IREE_VM_STACK_INLINE_STORAGE_SIZE];
+};
+
 static iree_status_t iree_vm_validate_function_inputs(
     iree_vm_function_t function, iree_vm_variant_list_t* inputs) {
   // TODO(benvanik): validate inputs.
@@ -50,18 +99,81 @@ static iree_status_t iree_vm_marshal_outputs(
     if (reg & IREE_REF_REGISTER_TYPE_BIT) {
       // Always move (as the stack frame will be destroyed soon).
       IREE_RETURN_IF_ERROR(iree_vm_variant_list_append_ref_move(
-          outputs, &registers->ref[reg & IREE_REF_REGISTER_MASK]));
+          outputs, &registers->ref[reg & registers->ref_mask]));
     } else {
       iree_vm_value_t value;
       value.type = IREE_VM_VALUE_TYPE_I32;
-      value.i32 = registers->i32[reg & IREE_I32_REGISTER_MASK];
+      value.i32 = registers->i32[reg & registers->i32_mask];
       IREE_RETURN_IF_ERROR(iree_vm_variant_list_append_value(outputs, value));
     }
   }
   return IREE_STATUS_OK;
 }
 
-// TODO(benvanik): implement this as an iree_vm_invocation_t sequence.
+// Enters |function| on |stack| and marshals |inputs| into the entry frame.
+static iree_status_t iree_vm_enter_function(
+    iree_vm_stack_t* stack, iree_vm_function_t function,
+    iree_vm_variant_list_t* inputs, iree_vm_stack_frame_t** out_entry_frame) {
+  *out_entry_frame = NULL;
+
+  // Size the entry frame to hold the inputs and results. Callees needing more
+  // registers will grow the frame themselves.
+  int32_t i32_register_count = 0;
+  int32_t ref_register_count = 0;
+  if (inputs) {
+    iree_host_size_t count = iree_vm_variant_list_size(inputs);
+    for (int i = 0; i < count; ++i) {
+      iree_vm_variant_t* variant = iree_vm_variant_list_get(inputs, i);
+      if (IREE_VM_VARIANT_IS_REF(variant)) {
+        ++ref_register_count;
+      } else {
+        ++i32_register_count;
+      }
+    }
+  }
+  iree_vm_function_signature_t signature;
+  if (iree_status_is_ok(function.module->get_function(
+          function.module->self, function.linkage, function.ordinal, NULL,
+          NULL, &signature))) {
+    if (signature.result_count > i32_register_count) {
+      i32_register_count = signature.result_count;
+    }
+    if (signature.result_count > ref_register_count) {
+      ref_register_count = signature.result_count;
+    }
+  }
+
+  iree_vm_stack_frame_t* callee_frame = NULL;
+  IREE_RETURN_IF_ERROR(iree_vm_stack_function_enter(
+      stack, function, i32_register_count, ref_register_count, &callee_frame));
+  *out_entry_frame = callee_frame;
+
+  // Marshal inputs.
+  if (inputs) {
+    IREE_RETURN_IF_ERROR(iree_vm_marshal_inputs(inputs, callee_frame));
+  }
+  return IREE_STATUS_OK;
+}
+
+// Executes |entry_frame| of |function| to completion on the calling thread,
+// resuming it whenever it yields and blocking on any wait handles it suspends
+// on.
+static iree_status_t iree_vm_execute_to_completion(
+    iree_vm_stack_t* stack, iree_vm_function_t function,
+    iree_vm_stack_frame_t* entry_frame) {
+  while (1) {
+    iree_vm_execution_result_t result;
+    IREE_RETURN_IF_ERROR(function.module->execute(function.module->self, stack,
+                                                  entry_frame, &result));
+    if (result.state == IREE_VM_EXECUTION_COMPLETED) {
+      return IREE_STATUS_OK;
+    } else if (result.state == IREE_VM_EXECUTION_WAITING) {
+      IREE_RETURN_IF_ERROR(result.wait_handle.wait(result.wait_handle.self,
+                                                   IREE_TIME_INFINITE_FUTURE));
+    }
+  }
+}
+
 IREE_API_EXPORT iree_status_t IREE_API_CALL iree_vm_invoke(
     iree_vm_context_t* context, iree_vm_function_t function,
     const iree_vm_invocation_policy_t* policy, iree_vm_variant_list_t* inputs,
@@ -71,42 +183,345 @@ IREE_API_EXPORT iree_status_t IREE_API_CALL iree_vm_invoke(
   // TODO(benvanik): validate outputs capacity.
   IREE_RETURN_IF_ERROR(iree_vm_validate_function_inputs(function, inputs));
 
-  // Allocate a stack on the heap and initialize it.
-  // If we shrunk the stack (or made it so that it could dynamically grow)
-  // then we could stack-allocate it here and not need the allocator at all.
-  iree_vm_stack_t* stack = NULL;
-  IREE_RETURN_IF_ERROR(iree_allocator_malloc(allocator, sizeof(iree_vm_stack_t),
-                                             (void**)&stack));
+  // Allocate the stack on the host stack with enough inline storage for
+  // shallow invocations; deeper call sequences will allocate from |allocator|.
+  iree_vm_stack_t stack_storage;
+  iree_vm_stack_t* stack = &stack_storage;
+  IREE_ALIGNAS(16) uint8_t frame_storage[IREE_VM_STACK_INLINE_STORAGE_SIZE];
+  iree_byte_span_t frame_storage_span = {frame_storage, sizeof(frame_storage)};
+  IREE_RETURN_IF_ERROR(
+      iree_vm_stack_init(frame_storage_span,
+                         iree_vm_context_state_resolver(context), allocator,
+                         stack));
+
+  iree_vm_stack_frame_t* callee_frame = NULL;
   iree_status_t status =
-      iree_vm_stack_init(iree_vm_context_state_resolver(context), stack);
+      iree_vm_enter_function(stack, function, inputs, &callee_frame);
+
+  // Perform execution. Synchronous execution blocks the calling thread if the
+  // function suspends on a wait handle.
+  if (iree_status_is_ok(status)) {
+    status = iree_vm_execute_to_completion(stack, function, callee_frame);
+  }
+
+  // Marshal outputs.
+  if (iree_status_is_ok(status) && outputs) {
+    status = iree_vm_marshal_outputs(callee_frame, outputs);
+  }
+
+  if (callee_frame) {
+    iree_vm_stack_function_leave(stack);
+  }
+  iree_vm_stack_deinit(stack);
+  return status;
+}
+
+IREE_API_EXPORT iree_status_t IREE_API_CALL iree_vm_invoker_create(
+    iree_vm_context_t* context, iree_vm_function_t function,
+    iree_allocator_t allocator, iree_vm_invoker_t** out_invoker) {
+  if (!out_invoker) return IREE_STATUS_INVALID_ARGUMENT;
+  *out_invoker = NULL;
+  if (!context || !function.module) return IREE_STATUS_INVALID_ARGUMENT;
+
+  iree_vm_invoker_t* invoker = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      allocator, sizeof(iree_vm_invoker_t), (void**)&invoker));
+  memset(invoker, 0, sizeof(*invoker));
+  atomic_store(&invoker->ref_count, 1);
+  invoker->allocator = allocator;
+  invoker->context = context;
+  iree_vm_context_retain(context);
+  invoker->function = function;
+
+  // Not all modules provide signatures; inputs larger than this are still
+  // handled per call.
+  iree_vm_function_signature_t signature;
+  if (iree_status_is_ok(function.module->get_function(
+          function.module->self, function.linkage, function.ordinal, NULL,
+          NULL, &signature))) {
+    invoker->register_count = signature.argument_count > signature.result_count
+                                  ? signature.argument_count
+                                  : signature.result_count;
+  }
+
+  iree_byte_span_t stack_storage_span = {invoker->stack_storage,
+                                         sizeof(invoker->stack_storage)};
+  iree_status_t status = iree_vm_stack_init(
+      stack_storage_span, iree_vm_context_state_resolver(context), allocator,
+      &invoker->stack);
   if (!iree_status_is_ok(status)) {
-    iree_allocator_free(allocator, stack);
+    iree_vm_context_release(context);
+    iree_allocator_free(allocator, invoker);
     return status;
   }
 
-  iree_vm_stack_frame_t* callee_frame = NULL;
-  status = iree_vm_stack_function_enter(stack, function, &callee_frame);
+  *out_invoker = invoker;
+  return IREE_STATUS_OK;
+}
+
+static void iree_vm_invoker_destroy(iree_vm_invoker_t* invoker) {
+  iree_vm_stack_deinit(&invoker->stack);
+  iree_vm_context_release(invoker->context);
+  iree_allocator_free(invoker->allocator, invoker);
+}
+
+IREE_API_EXPORT iree_status_t IREE_API_CALL
+iree_vm_invoker_retain(iree_vm_invoker_t* invoker) {
+  if (!invoker) return IREE_STATUS_INVALID_ARGUMENT;
+  atomic_fetch_add(&invoker->ref_count, 1);
+  return IREE_STATUS_OK;
+}
+
+IREE_API_EXPORT iree_status_t IREE_API_CALL
+iree_vm_invoker_release(iree_vm_invoker_t* invoker) {
+  if (invoker) {
+    if (atomic_fetch_sub(&invoker->ref_count, 1) == 1) {
+      iree_vm_invoker_destroy(invoker);
+    }
+  }
+  return IREE_STATUS_OK;
+}
 
-  // Marhsal inputs.
-  if (iree_status_is_ok(status) && inputs) {
-    status = iree_vm_marshal_inputs(inputs, callee_frame);
+// Performs a single call of the invoker function on its stack, leaving the
+// stack empty for the next call.
+static iree_status_t iree_vm_invoker_call(iree_vm_invoker_t* invoker,
+                                          iree_vm_variant_list_t* inputs,
+                                          iree_vm_variant_list_t* outputs) {
+  iree_vm_stack_t* stack = &invoker->stack;
+  int32_t register_count = invoker->register_count;
+  if (inputs) {
+    iree_host_size_t input_count = iree_vm_variant_list_size(inputs);
+    if (input_count > register_count) register_count = (int32_t)input_count;
   }
 
-  // Perform execution. Note that for synchronous execution we expect this to
-  // complete without yielding.
+  iree_vm_stack_frame_t* entry_frame = NULL;
+  IREE_RETURN_IF_ERROR(iree_vm_stack_function_enter(
+      stack, invoker->function, register_count, register_count, &entry_frame));
+
+  iree_status_t status = IREE_STATUS_OK;
+  if (inputs) {
+    status = iree_vm_marshal_inputs(inputs, entry_frame);
+  }
   if (iree_status_is_ok(status)) {
-    iree_vm_execution_result_t result;
-    status = function.module->execute(function.module->self, stack,
-                                      callee_frame, &result);
+    status =
+        iree_vm_execute_to_completion(stack, invoker->function, entry_frame);
   }
-
-  // Marshal outputs.
   if (iree_status_is_ok(status) && outputs) {
-    status = iree_vm_marshal_outputs(callee_frame, outputs);
+    status = iree_vm_marshal_outputs(entry_frame, outputs);
   }
 
-  iree_vm_stack_function_leave(stack);
-  iree_vm_stack_deinit(stack);
-  iree_allocator_free(allocator, stack);
+  // Failures may leave callee frames behind; unwind them along with the entry
+  // frame.
+  while (iree_vm_stack_current_frame(stack)) {
+    iree_vm_stack_function_leave(stack);
+  }
+  return status;
+}
+
+IREE_API_EXPORT iree_status_t IREE_API_CALL
+iree_vm_invoker_invoke(iree_vm_invoker_t* invoker,
+                       iree_vm_variant_list_t* inputs,
+                       iree_vm_variant_list_t* outputs) {
+  if (!invoker) return IREE_STATUS_INVALID_ARGUMENT;
+  IREE_RETURN_IF_ERROR(
+      iree_vm_validate_function_inputs(invoker->function, inputs));
+  return iree_vm_invoker_call(invoker, inputs, outputs);
+}
+
+IREE_API_EXPORT iree_status_t IREE_API_CALL iree_vm_invoker_invoke_batch(
+    iree_vm_invoker_t* invoker, iree_host_size_t batch_size,
+    iree_vm_variant_list_t** inputs, iree_vm_variant_list_t** outputs) {
+  if (!invoker) return IREE_STATUS_INVALID_ARGUMENT;
+  for (iree_host_size_t i = 0; i < batch_size; ++i) {
+    iree_vm_variant_list_t* call_inputs = inputs ? inputs[i] : NULL;
+    IREE_RETURN_IF_ERROR(
+        iree_vm_validate_function_inputs(invoker->function, call_inputs));
+    IREE_RETURN_IF_ERROR(iree_vm_invoker_call(invoker, call_inputs,
+                                              outputs ? outputs[i] : NULL));
+  }
+  return IREE_STATUS_OK;
+}
+
+IREE_API_EXPORT iree_status_t IREE_API_CALL iree_vm_invocation_create(
+    iree_vm_context_t* context, iree_vm_function_t function,
+    const iree_vm_invocation_policy_t* policy,
+    const iree_vm_variant_list_t* inputs, iree_allocator_t allocator,
+    iree_vm_invocation_t** out_invocation) {
+  if (!out_invocation) return IREE_STATUS_INVALID_ARGUMENT;
+  *out_invocation = NULL;
+  if (!context || !function.module) return IREE_STATUS_INVALID_ARGUMENT;
+  iree_vm_variant_list_t* mutable_inputs = (iree_vm_variant_list_t*)inputs;
+  IREE_RETURN_IF_ERROR(
+      iree_vm_validate_function_inputs(function, mutable_inputs));
+
+  iree_vm_invocation_t* invocation = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      allocator, sizeof(iree_vm_invocation_t), (void**)&invocation));
+  memset(invocation, 0, sizeof(*invocation));
+  atomic_store(&invocation->ref_count, 1);
+  invocation->allocator = allocator;
+  invocation->context = context;
+  iree_vm_context_retain(context);
+  invocation->function = function;
+  atomic_store(&invocation->status, IREE_STATUS_UNAVAILABLE);
+  atomic_store(&invocation->abort_requested, 0);
+
+  iree_byte_span_t stack_storage_span = {invocation->stack_storage,
+                                         sizeof(invocation->stack_storage)};
+  iree_status_t status = iree_vm_stack_init(
+      stack_storage_span, iree_vm_context_state_resolver(context), allocator,
+      &invocation->stack);
+  if (iree_status_is_ok(status)) {
+    status = iree_vm_enter_function(&invocation->stack, function,
+                                    mutable_inputs, &invocation->entry_frame);
+    if (!iree_status_is_ok(status)) {
+      iree_vm_stack_deinit(&invocation->stack);
+      invocation->entry_frame = NULL;
+    }
+  }
+  if (!iree_status_is_ok(status)) {
+    iree_vm_context_release(context);
+    iree_allocator_free(allocator, invocation);
+    return status;
+  }
+
+  *out_invocation = invocation;
+  return IREE_STATUS_OK;
+}
+
+static void iree_vm_invocation_destroy(iree_vm_invocation_t* invocation) {
+  if (invocation->entry_frame) {
+    iree_vm_stack_deinit(&invocation->stack);
+    invocation->entry_frame = NULL;
+  }
+  if (invocation->outputs) {
+    iree_vm_variant_list_free(invocation->outputs);
+    invocation->outputs = NULL;
+  }
+  iree_vm_context_release(invocation->context);
+  iree_allocator_free(invocation->allocator, invocation);
+}
+
+IREE_API_EXPORT iree_status_t IREE_API_CALL
+iree_vm_invocation_retain(iree_vm_invocation_t* invocation) {
+  if (!invocation) return IREE_STATUS_INVALID_ARGUMENT;
+  atomic_fetch_add(&invocation->ref_count, 1);
+  return IREE_STATUS_OK;
+}
+
+IREE_API_EXPORT iree_status_t IREE_API_CALL
+iree_vm_invocation_release(iree_vm_invocation_t* invocation) {
+  if (invocation) {
+    if (atomic_fetch_sub(&invocation->ref_count, 1) == 1) {
+      iree_vm_invocation_destroy(invocation);
+    }
+  }
+  return IREE_STATUS_OK;
+}
+
+// Completes the invocation with |status|, marshaling the outputs if it
+// succeeded and tearing down the stack.
+static iree_status_t iree_vm_invocation_complete(
+    iree_vm_invocation_t* invocation, iree_status_t status) {
+  if (iree_status_is_ok(status)) {
+    const iree_vm_register_list_t* return_registers =
+        invocation->entry_frame->return_registers;
+    iree_host_size_t result_count =
+        return_registers ? return_registers->size : 0;
+    status = iree_vm_variant_list_alloc(result_count, invocation->allocator,
+                                        &invocation->outputs);
+    if (iree_status_is_ok(status) && return_registers) {
+      status = iree_vm_marshal_outputs(invocation->entry_frame,
+                                       invocation->outputs);
+    }
+  }
+  iree_vm_stack_deinit(&invocation->stack);
+  invocation->entry_frame = NULL;
+  memset(&invocation->result, 0, sizeof(invocation->result));
+  atomic_store(&invocation->status, status);
   return status;
 }
+
+IREE_API_EXPORT iree_status_t IREE_API_CALL
+iree_vm_invocation_query_status(iree_vm_invocation_t* invocation) {
+  if (!invocation) return IREE_STATUS_INVALID_ARGUMENT;
+  return (iree_status_t)atomic_load(&invocation->status);
+}
+
+IREE_API_EXPORT iree_vm_context_t* IREE_API_CALL
+iree_vm_invocation_context(const iree_vm_invocation_t* invocation) {
+  return invocation ? invocation->context : NULL;
+}
+
+IREE_API_EXPORT const iree_vm_variant_list_t* IREE_API_CALL
+iree_vm_invocation_output(iree_vm_invocation_t* invocation) {
+  if (!invocation ||
+      !iree_status_is_ok(iree_vm_invocation_query_status(invocation))) {
+    return NULL;
+  }
+  return invocation->outputs;
+}
+
+IREE_API_EXPORT iree_status_t IREE_API_CALL iree_vm_invocation_wait(
+    iree_vm_invocation_t* invocation, iree_time_t deadline) {
+  if (!invocation) return IREE_STATUS_INVALID_ARGUMENT;
+  if (!invocation->entry_frame ||
+      invocation->result.state != IREE_VM_EXECUTION_WAITING ||
+      atomic_load(&invocation->abort_requested)) {
+    return IREE_STATUS_OK;
+  }
+  iree_vm_wait_handle_t* wait_handle = &invocation->result.wait_handle;
+  iree_status_t status = wait_handle->wait(wait_handle->self, deadline);
+  if (status == IREE_STATUS_DEADLINE_EXCEEDED) {
+    return status;
+  } else if (!iree_status_is_ok(status)) {
+    return iree_vm_invocation_complete(invocation, status);
+  }
+  // Mark the invocation as resumable so that we don't wait again.
+  invocation->result.state = IREE_VM_EXECUTION_YIELDED;
+  return IREE_STATUS_OK;
+}
+
+IREE_API_EXPORT iree_status_t IREE_API_CALL iree_vm_invocation_resume(
+    iree_vm_invocation_t* invocation, iree_vm_execution_result_t* out_result) {
+  if (!invocation || !out_result) return IREE_STATUS_INVALID_ARGUMENT;
+  memset(out_result, 0, sizeof(*out_result));
+  if (!invocation->entry_frame) {
+    return iree_vm_invocation_query_status(invocation);
+  } else if (atomic_load(&invocation->abort_requested)) {
+    return iree_vm_invocation_complete(invocation, IREE_STATUS_ABORTED);
+  } else if (invocation->result.state == IREE_VM_EXECUTION_WAITING) {
+    return IREE_STATUS_FAILED_PRECONDITION;
+  }
+
+  iree_vm_module_t* module = invocation->function.module;
+  iree_status_t status =
+      module->execute(module->self, &invocation->stack,
+                      invocation->entry_frame, &invocation->result);
+  if (iree_status_is_ok(status) &&
+      invocation->result.state != IREE_VM_EXECUTION_COMPLETED) {
+    *out_result = invocation->result;
+    return IREE_STATUS_UNAVAILABLE;
+  }
+  return iree_vm_invocation_complete(invocation, status);
+}
+
+IREE_API_EXPORT iree_status_t IREE_API_CALL iree_vm_invocation_await(
+    iree_vm_invocation_t* invocation, iree_time_t deadline) {
+  if (!invocation) return IREE_STATUS_INVALID_ARGUMENT;
+  while (1) {
+    iree_status_t status = iree_vm_invocation_query_status(invocation);
+    if (status != IREE_STATUS_UNAVAILABLE) return status;
+    IREE_RETURN_IF_ERROR(iree_vm_invocation_wait(invocation, deadline));
+    iree_vm_execution_result_t result;
+    status = iree_vm_invocation_resume(invocation, &result);
+    if (status != IREE_STATUS_UNAVAILABLE) return status;
+  }
+}
+
+IREE_API_EXPORT iree_status_t IREE_API_CALL
+iree_vm_invocation_abort(iree_vm_invocation_t* invocation) {
+  if (!invocation) return IREE_STATUS_INVALID_ARGUMENT;
+  atomic_store(&invocation->abort_requested, 1);
+  return IREE_STATUS_OK;
+}
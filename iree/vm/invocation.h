@@ -27,6 +27,7 @@ extern "C" {
 #endif  // __cplusplus
 
 typedef struct iree_vm_invocation iree_vm_invocation_t;
+typedef struct iree_vm_invoker iree_vm_invoker_t;
 typedef struct iree_vm_invocation_policy iree_vm_invocation_policy_t;
 
 #ifndef IREE_API_NO_PROTOTYPES
@@ -44,12 +45,71 @@ typedef struct iree_vm_invocation_policy iree_vm_invocation_policy_t;
 // |outputs| is populated after the function completes execution with the
 // output values and objects of the function. List ownership remains with the
 // caller.
+//
+// Only i32 values and ref objects can be marshaled as variant lists only hold
+// those types. Functions with i64, f32, or f64 arguments or results cannot be
+// invoked directly and must be called through a function with an i32/ref
+// signature that converts or checks the values.
 IREE_API_EXPORT iree_status_t IREE_API_CALL iree_vm_invoke(
     iree_vm_context_t* context, iree_vm_function_t function,
     const iree_vm_invocation_policy_t* policy, iree_vm_variant_list_t* inputs,
     iree_vm_variant_list_t* outputs, iree_allocator_t allocator);
 
-// TODO(benvanik): document and implement.
+// Creates a reusable invoker of |function| in the VM.
+//
+// Invokers amortize the setup performed by iree_vm_invoke across many calls of
+// the same function: the function signature is queried once and the invoker
+// owns a stack that is reused for each call. Once warm (any frame storage
+// beyond the inline storage has been allocated by the first call) calls perform
+// no heap allocations as long as the output lists have sufficient capacity.
+//
+// Invokers are thread-compatible: only one thread may invoke at a time.
+IREE_API_EXPORT iree_status_t IREE_API_CALL iree_vm_invoker_create(
+    iree_vm_context_t* context, iree_vm_function_t function,
+    iree_allocator_t allocator, iree_vm_invoker_t** out_invoker);
+
+// Retains the given |invoker| for the caller.
+IREE_API_EXPORT iree_status_t IREE_API_CALL
+iree_vm_invoker_retain(iree_vm_invoker_t* invoker);
+
+// Releases the given |invoker| from the caller.
+IREE_API_EXPORT iree_status_t IREE_API_CALL
+iree_vm_invoker_release(iree_vm_invoker_t* invoker);
+
+// Synchronously invokes the function of |invoker|.
+// |inputs| and |outputs| behave as with iree_vm_invoke. The results are
+// appended to |outputs|, which must have sufficient capacity remaining.
+IREE_API_EXPORT iree_status_t IREE_API_CALL
+iree_vm_invoker_invoke(iree_vm_invoker_t* invoker,
+                       iree_vm_variant_list_t* inputs,
+                       iree_vm_variant_list_t* outputs);
+
+// Synchronously invokes the function of |invoker| once for each of the
+// |batch_size| entries in |inputs|, appending the results of each call to the
+// corresponding entry in |outputs|. Either array may be NULL if the function
+// takes no arguments or its results are not needed.
+//
+// Calls are performed in order and execution stops at the first failure.
+IREE_API_EXPORT iree_status_t IREE_API_CALL iree_vm_invoker_invoke_batch(
+    iree_vm_invoker_t* invoker, iree_host_size_t batch_size,
+    iree_vm_variant_list_t** inputs, iree_vm_variant_list_t** outputs);
+
+// Creates a resumable invocation of |function| in the VM.
+//
+// The invocation owns its own stack (fiber) and does not begin executing until
+// it is resumed, either directly with iree_vm_invocation_resume or
+// iree_vm_invocation_await or by submitting it to an iree_vm_scheduler_t.
+// Suspended invocations keep their frames on their stack and do not block any
+// OS thread while waiting.
+//
+// |inputs| is used to pass values and objects into the target function and must
+// match the signature defined by the compiled function. The inputs are copied
+// into the invocation and list ownership remains with the caller. As with
+// iree_vm_invoke only i32 values and ref objects can be marshaled.
+//
+// Invocations are thread-compatible: only one thread may resume or wait on an
+// invocation at a time, though iree_vm_invocation_query_status and
+// iree_vm_invocation_abort may be called from any thread.
 IREE_API_EXPORT iree_status_t IREE_API_CALL iree_vm_invocation_create(
     iree_vm_context_t* context, iree_vm_function_t function,
     const iree_vm_invocation_policy_t* policy,
@@ -74,6 +134,10 @@ iree_vm_invocation_release(iree_vm_invocation_t* invocation);
 IREE_API_EXPORT iree_status_t IREE_API_CALL
 iree_vm_invocation_query_status(iree_vm_invocation_t* invocation);
 
+// Returns the context the invocation executes within.
+IREE_API_EXPORT iree_vm_context_t* IREE_API_CALL
+iree_vm_invocation_context(const iree_vm_invocation_t* invocation);
+
 // Returns a reference to the output of the invocation.
 // The returned structure is valid for the lifetime of the invocation and
 // callers must retain any refs they want to outlive the invocation once
@@ -83,7 +147,29 @@ iree_vm_invocation_query_status(iree_vm_invocation_t* invocation);
 IREE_API_EXPORT const iree_vm_variant_list_t* IREE_API_CALL
 iree_vm_invocation_output(iree_vm_invocation_t* invocation);
 
+// Waits until the invocation can be resumed.
+// Invocations that are suspended on a wait handle wait on it until |deadline|,
+// while all others are immediately resumable. Pass IREE_TIME_INFINITE_PAST to
+// poll without blocking.
+//
+// Returns IREE_STATUS_OK if the invocation can be resumed and
+// IREE_STATUS_DEADLINE_EXCEEDED if it is still waiting. If the wait fails the
+// invocation completes with the failure status, which is returned.
+IREE_API_EXPORT iree_status_t IREE_API_CALL iree_vm_invocation_wait(
+    iree_vm_invocation_t* invocation, iree_time_t deadline);
+
+// Executes the invocation on the calling thread until it completes or
+// suspends. The invocation must be resumable (see iree_vm_invocation_wait).
+//
+// Returns IREE_STATUS_UNAVAILABLE if the invocation suspended, in which case
+// |out_result| describes why and what it is waiting on (if anything), and
+// otherwise returns the completion status of the invocation.
+IREE_API_EXPORT iree_status_t IREE_API_CALL iree_vm_invocation_resume(
+    iree_vm_invocation_t* invocation, iree_vm_execution_result_t* out_result);
+
 // Blocks the caller until the invocation completes (successfully or otherwise).
+// The invocation is executed on the calling thread and must not have been
+// submitted to a scheduler.
 //
 // Returns IREE_STATUS_DEADLINE_EXCEEDED if |deadline| elapses before the
 // invocation completes and otherwise returns iree_vm_invocation_query_status.
@@ -91,7 +177,9 @@ IREE_API_EXPORT iree_status_t IREE_API_CALL iree_vm_invocation_await(
     iree_vm_invocation_t* invocation, iree_time_t deadline);
 
 // Attempts to abort the invocation if it is in-flight.
-// A no-op if the invocation has already completed.
+// A no-op if the invocation has already completed. Suspended invocations
+// complete with IREE_STATUS_ABORTED the next time they are resumed and waiting
+// invocations become resumable immediately so that they abort promptly.
 IREE_API_EXPORT iree_status_t IREE_API_CALL
 iree_vm_invocation_abort(iree_vm_invocation_t* invocation);
 
@@ -0,0 +1,361 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/vm/invocation.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/base/logging.h"
+#include "iree/testing/gtest.h"
+#include "iree/vm/context.h"
+#include "iree/vm/instance.h"
+#include "iree/vm/ref.h"
+#include "iree/vm/testing/test_module.h"
+#include "iree/vm/variant_list.h"
+
+namespace {
+
+using iree::vm::testing::TestModule;
+using iree::vm::testing::TestWaitHandle;
+
+// Wraps the system allocator and counts the allocations made through it.
+class CountingAllocator {
+ public:
+  iree_allocator_t allocator() { return {this, &Allocate, &Free}; }
+
+  int allocation_count() const { return allocation_count_; }
+
+ private:
+  static iree_status_t IREE_API_PTR Allocate(void* self,
+                                             iree_allocation_mode_t mode,
+                                             iree_host_size_t byte_length,
+                                             void** out_ptr) {
+    ++static_cast<CountingAllocator*>(self)->allocation_count_;
+    return iree_allocator_system_allocate(nullptr, mode, byte_length, out_ptr);
+  }
+
+  static iree_status_t IREE_API_PTR Free(void* self, void* ptr) {
+    return iree_allocator_system_free(nullptr, ptr);
+  }
+
+  std::atomic<int> allocation_count_{0};
+};
+
+// A ref object that records when it is destroyed.
+struct TrackedObject {
+  iree_vm_ref_object_t ref_object = {1};
+  bool* destroyed = nullptr;
+};
+
+iree_vm_ref_type_t TrackedObjectType() {
+  static iree_vm_ref_type_descriptor_t descriptor = {0};
+  if (descriptor.type == IREE_VM_REF_TYPE_NULL) {
+    descriptor.type_name = iree_make_cstring_view("TrackedObject");
+    descriptor.offsetof_counter = offsetof(TrackedObject, ref_object.counter);
+    descriptor.destroy = +[](void* ptr) {
+      auto* object = reinterpret_cast<TrackedObject*>(ptr);
+      *object->destroyed = true;
+      delete object;
+    };
+    IREE_CHECK_OK(iree_vm_ref_register_type(&descriptor));
+  }
+  return descriptor.type;
+}
+
+class VMInvocationTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    IREE_ASSERT_OK(iree_vm_instance_create(IREE_ALLOCATOR_SYSTEM, &instance_));
+    iree_vm_module_t* modules[] = {test_module_.module()};
+    IREE_ASSERT_OK(iree_vm_context_create_with_modules(
+        instance_, modules, 1, IREE_ALLOCATOR_SYSTEM, &context_));
+  }
+
+  void TearDown() override {
+    iree_vm_context_release(context_);
+    iree_vm_instance_release(instance_);
+  }
+
+  // Returns a list holding |values|, owned by the fixture.
+  iree_vm_variant_list_t* MakeInputs(std::vector<int32_t> values) {
+    iree_vm_variant_list_t* list = nullptr;
+    IREE_CHECK_OK(iree_vm_variant_list_alloc(values.size(),
+                                             IREE_ALLOCATOR_SYSTEM, &list));
+    for (int32_t value : values) {
+      IREE_CHECK_OK(iree_vm_variant_list_append_value(
+          list, IREE_VM_VALUE_MAKE_I32(value)));
+    }
+    lists_.emplace_back(list, &iree_vm_variant_list_free);
+    return list;
+  }
+
+  iree_vm_invocation_t* CreateInvocation(const char* function_name,
+                                         std::vector<int32_t> inputs) {
+    iree_vm_invocation_t* invocation = nullptr;
+    IREE_CHECK_OK(iree_vm_invocation_create(
+        context_, test_module_.LookupFunction(function_name),
+        /*policy=*/nullptr, MakeInputs(std::move(inputs)),
+        IREE_ALLOCATOR_SYSTEM, &invocation));
+    invocations_.emplace_back(invocation, &iree_vm_invocation_release);
+    return invocation;
+  }
+
+  iree_vm_invoker_t* CreateInvoker(const char* function_name,
+                                   iree_allocator_t allocator) {
+    iree_vm_invoker_t* invoker = nullptr;
+    IREE_CHECK_OK(iree_vm_invoker_create(
+        context_, test_module_.LookupFunction(function_name), allocator,
+        &invoker));
+    invokers_.emplace_back(invoker, &iree_vm_invoker_release);
+    return invoker;
+  }
+
+  // Returns a list with room for |capacity| results, owned by the fixture.
+  iree_vm_variant_list_t* MakeOutputs(iree_host_size_t capacity) {
+    iree_vm_variant_list_t* list = nullptr;
+    IREE_CHECK_OK(
+        iree_vm_variant_list_alloc(capacity, IREE_ALLOCATOR_SYSTEM, &list));
+    lists_.emplace_back(list, &iree_vm_variant_list_free);
+    return list;
+  }
+
+  // Returns the single i32 result of a completed |invocation|.
+  static int32_t Result(iree_vm_invocation_t* invocation) {
+    auto* outputs = const_cast<iree_vm_variant_list_t*>(
+        iree_vm_invocation_output(invocation));
+    EXPECT_NE(nullptr, outputs);
+    if (!outputs) return -1;
+    EXPECT_EQ(1, iree_vm_variant_list_size(outputs));
+    return iree_vm_variant_list_get(outputs, 0)->i32;
+  }
+
+  TestWaitHandle wait_handle_;
+  TestModule test_module_{&wait_handle_};
+  iree_vm_instance_t* instance_ = nullptr;
+  iree_vm_context_t* context_ = nullptr;
+  std::vector<std::unique_ptr<iree_vm_variant_list_t,
+                              iree_status_t (*)(iree_vm_variant_list_t*)>>
+      lists_;
+  std::vector<std::unique_ptr<iree_vm_invocation_t,
+                              iree_status_t (*)(iree_vm_invocation_t*)>>
+      invocations_;
+  std::vector<
+      std::unique_ptr<iree_vm_invoker_t, iree_status_t (*)(iree_vm_invoker_t*)>>
+      invokers_;
+};
+
+TEST_F(VMInvocationTest, ResumesAfterYield) {
+  auto* invocation = CreateInvocation("yield", {3});
+  iree_vm_execution_result_t result;
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(IREE_STATUS_UNAVAILABLE,
+              iree_vm_invocation_resume(invocation, &result));
+    EXPECT_EQ(IREE_VM_EXECUTION_YIELDED, result.state);
+    EXPECT_EQ(IREE_STATUS_UNAVAILABLE,
+              iree_vm_invocation_query_status(invocation));
+    EXPECT_EQ(nullptr, iree_vm_invocation_output(invocation));
+  }
+  IREE_EXPECT_OK(iree_vm_invocation_resume(invocation, &result));
+  IREE_EXPECT_OK(iree_vm_invocation_query_status(invocation));
+  EXPECT_EQ(3, Result(invocation));
+
+  // Resuming a completed invocation returns its status without executing.
+  int execute_count = test_module_.execute_count();
+  IREE_EXPECT_OK(iree_vm_invocation_resume(invocation, &result));
+  EXPECT_EQ(execute_count, test_module_.execute_count());
+}
+
+TEST_F(VMInvocationTest, AwaitRunsToCompletion) {
+  auto* invocation = CreateInvocation("yield", {5});
+  IREE_EXPECT_OK(
+      iree_vm_invocation_await(invocation, IREE_TIME_INFINITE_FUTURE));
+  EXPECT_EQ(5, Result(invocation));
+  EXPECT_EQ(6, test_module_.execute_count());
+}
+
+TEST_F(VMInvocationTest, ReportsExecutionFailure) {
+  auto* invocation = CreateInvocation("fail", {});
+  iree_vm_execution_result_t result;
+  EXPECT_EQ(IREE_STATUS_INTERNAL,
+            iree_vm_invocation_resume(invocation, &result));
+  EXPECT_EQ(IREE_STATUS_INTERNAL, iree_vm_invocation_query_status(invocation));
+  EXPECT_EQ(nullptr, iree_vm_invocation_output(invocation));
+}
+
+TEST_F(VMInvocationTest, ResumesAfterWaitIsSignaled) {
+  auto* invocation = CreateInvocation("wait", {});
+  iree_vm_execution_result_t result;
+  EXPECT_EQ(IREE_STATUS_UNAVAILABLE,
+            iree_vm_invocation_resume(invocation, &result));
+  EXPECT_EQ(IREE_VM_EXECUTION_WAITING, result.state);
+
+  // Waiting invocations are not resumable until their handle is signaled.
+  EXPECT_EQ(IREE_STATUS_DEADLINE_EXCEEDED,
+            iree_vm_invocation_wait(invocation, IREE_TIME_INFINITE_PAST));
+  EXPECT_EQ(IREE_STATUS_FAILED_PRECONDITION,
+            iree_vm_invocation_resume(invocation, &result));
+
+  wait_handle_.Signal();
+  IREE_EXPECT_OK(iree_vm_invocation_wait(invocation, IREE_TIME_INFINITE_PAST));
+  IREE_EXPECT_OK(iree_vm_invocation_resume(invocation, &result));
+  EXPECT_EQ(1, Result(invocation));
+}
+
+TEST_F(VMInvocationTest, FailedWaitCompletesInvocation) {
+  auto* invocation = CreateInvocation("wait", {});
+  iree_vm_execution_result_t result;
+  EXPECT_EQ(IREE_STATUS_UNAVAILABLE,
+            iree_vm_invocation_resume(invocation, &result));
+  wait_handle_.Signal(IREE_STATUS_DATA_LOSS);
+  EXPECT_EQ(IREE_STATUS_DATA_LOSS,
+            iree_vm_invocation_wait(invocation, IREE_TIME_INFINITE_FUTURE));
+  EXPECT_EQ(IREE_STATUS_DATA_LOSS,
+            iree_vm_invocation_query_status(invocation));
+  EXPECT_EQ(IREE_STATUS_DATA_LOSS,
+            iree_vm_invocation_resume(invocation, &result));
+}
+
+TEST_F(VMInvocationTest, AbortsYieldedInvocation) {
+  auto* invocation = CreateInvocation("yield", {100});
+  iree_vm_execution_result_t result;
+  EXPECT_EQ(IREE_STATUS_UNAVAILABLE,
+            iree_vm_invocation_resume(invocation, &result));
+  IREE_EXPECT_OK(iree_vm_invocation_abort(invocation));
+  int execute_count = test_module_.execute_count();
+  EXPECT_EQ(IREE_STATUS_ABORTED,
+            iree_vm_invocation_resume(invocation, &result));
+  EXPECT_EQ(execute_count, test_module_.execute_count());
+  EXPECT_EQ(IREE_STATUS_ABORTED, iree_vm_invocation_query_status(invocation));
+  EXPECT_EQ(nullptr, iree_vm_invocation_output(invocation));
+}
+
+TEST_F(VMInvocationTest, AbortMakesWaitingInvocationResumable) {
+  auto* invocation = CreateInvocation("wait", {});
+  iree_vm_execution_result_t result;
+  EXPECT_EQ(IREE_STATUS_UNAVAILABLE,
+            iree_vm_invocation_resume(invocation, &result));
+  IREE_EXPECT_OK(iree_vm_invocation_abort(invocation));
+  IREE_EXPECT_OK(iree_vm_invocation_wait(invocation, IREE_TIME_INFINITE_PAST));
+  EXPECT_EQ(IREE_STATUS_ABORTED,
+            iree_vm_invocation_resume(invocation, &result));
+}
+
+TEST_F(VMInvocationTest, AbortAfterCompletionIsIgnored) {
+  auto* invocation = CreateInvocation("add", {2, 3});
+  IREE_EXPECT_OK(
+      iree_vm_invocation_await(invocation, IREE_TIME_INFINITE_FUTURE));
+  IREE_EXPECT_OK(iree_vm_invocation_abort(invocation));
+  IREE_EXPECT_OK(iree_vm_invocation_query_status(invocation));
+  EXPECT_EQ(5, Result(invocation));
+}
+
+TEST_F(VMInvocationTest, InvokerReturnsResultsAcrossCalls) {
+  auto* invoker = CreateInvoker("add", IREE_ALLOCATOR_SYSTEM);
+  auto* outputs = MakeOutputs(1);
+  IREE_ASSERT_OK(iree_vm_invoker_invoke(invoker, MakeInputs({2, 3}), outputs));
+  ASSERT_EQ(1, iree_vm_variant_list_size(outputs));
+  EXPECT_EQ(5, iree_vm_variant_list_get(outputs, 0)->i32);
+
+  // Clearing the outputs makes room for the results of the next call.
+  iree_vm_variant_list_clear(outputs);
+  IREE_ASSERT_OK(iree_vm_invoker_invoke(invoker, MakeInputs({7, 8}), outputs));
+  ASSERT_EQ(1, iree_vm_variant_list_size(outputs));
+  EXPECT_EQ(15, iree_vm_variant_list_get(outputs, 0)->i32);
+
+  // Without clearing the outputs have no capacity for more results.
+  EXPECT_EQ(IREE_STATUS_OUT_OF_RANGE,
+            iree_vm_invoker_invoke(invoker, MakeInputs({1, 1}), outputs));
+}
+
+TEST_F(VMInvocationTest, InvokerBatchAppendsResultsPerCall) {
+  auto* invoker = CreateInvoker("add", IREE_ALLOCATOR_SYSTEM);
+  iree_vm_variant_list_t* inputs[] = {MakeInputs({1, 2}), MakeInputs({3, 4}),
+                                      MakeInputs({5, 6})};
+  iree_vm_variant_list_t* outputs[] = {MakeOutputs(1), MakeOutputs(1),
+                                       MakeOutputs(1)};
+  IREE_ASSERT_OK(iree_vm_invoker_invoke_batch(invoker, 3, inputs, outputs));
+  EXPECT_EQ(3, iree_vm_variant_list_get(outputs[0], 0)->i32);
+  EXPECT_EQ(7, iree_vm_variant_list_get(outputs[1], 0)->i32);
+  EXPECT_EQ(11, iree_vm_variant_list_get(outputs[2], 0)->i32);
+}
+
+TEST_F(VMInvocationTest, InvokerUnwindsFailedCalls) {
+  // Each call fails at the maximum stack depth. Without unwinding the frames
+  // left by the previous call the next one would fail to enter its frames.
+  auto* invoker = CreateInvoker("nest_fail", IREE_ALLOCATOR_SYSTEM);
+  auto* inputs = MakeInputs({IREE_MAX_STACK_DEPTH - 1});
+  auto* outputs = MakeOutputs(1);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(IREE_STATUS_INTERNAL,
+              iree_vm_invoker_invoke(invoker, inputs, outputs));
+    EXPECT_EQ(0, iree_vm_variant_list_size(outputs));
+  }
+}
+
+TEST_F(VMInvocationTest, InvokerDoesNotAllocateWhenWarm) {
+  CountingAllocator counting_allocator;
+  auto* invoker = CreateInvoker("nest", counting_allocator.allocator());
+  auto* failing_invoker =
+      CreateInvoker("nest_fail", counting_allocator.allocator());
+  auto* inputs = MakeInputs({16});
+  auto* outputs = MakeOutputs(1);
+
+  // The first calls grow the stacks beyond their inline storage.
+  int create_count = counting_allocator.allocation_count();
+  IREE_ASSERT_OK(iree_vm_invoker_invoke(invoker, inputs, outputs));
+  EXPECT_EQ(IREE_STATUS_INTERNAL,
+            iree_vm_invoker_invoke(failing_invoker, inputs, nullptr));
+  int warm_count = counting_allocator.allocation_count();
+  EXPECT_GT(warm_count, create_count);
+
+  for (int i = 0; i < 4; ++i) {
+    iree_vm_variant_list_clear(outputs);
+    IREE_ASSERT_OK(iree_vm_invoker_invoke(invoker, inputs, outputs));
+    EXPECT_EQ(16, iree_vm_variant_list_get(outputs, 0)->i32);
+    EXPECT_EQ(IREE_STATUS_INTERNAL,
+              iree_vm_invoker_invoke(failing_invoker, inputs, nullptr));
+  }
+  EXPECT_EQ(warm_count, counting_allocator.allocation_count());
+}
+
+TEST_F(VMInvocationTest, VariantListClearReleasesRefs) {
+  iree_vm_variant_list_t* list = MakeOutputs(2);
+  bool destroyed = false;
+  auto* object = new TrackedObject();
+  object->destroyed = &destroyed;
+  iree_vm_ref_t ref = {0};
+  IREE_ASSERT_OK(iree_vm_ref_wrap_assign(object, TrackedObjectType(), &ref));
+  IREE_ASSERT_OK(iree_vm_variant_list_append_ref_move(list, &ref));
+  IREE_ASSERT_OK(
+      iree_vm_variant_list_append_value(list, IREE_VM_VALUE_MAKE_I32(1)));
+
+  iree_vm_variant_list_clear(list);
+  EXPECT_TRUE(destroyed);
+  EXPECT_EQ(0, iree_vm_variant_list_size(list));
+
+  // The capacity is retained for reuse.
+  IREE_EXPECT_OK(
+      iree_vm_variant_list_append_value(list, IREE_VM_VALUE_MAKE_I32(2)));
+  IREE_EXPECT_OK(
+      iree_vm_variant_list_append_value(list, IREE_VM_VALUE_MAKE_I32(3)));
+  EXPECT_EQ(2, iree_vm_variant_list_size(list));
+  EXPECT_EQ(2, iree_vm_variant_list_get(list, 0)->i32);
+}
+
+}  // namespace
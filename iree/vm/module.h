@@ -75,13 +75,46 @@ typedef struct {
 // VM functions and accessing this state.
 typedef struct iree_vm_module_state iree_vm_module_state_t;
 
+// A handle that suspended executions can wait on before being resumed.
+//
+// This is a minimal C interface that host synchronization primitives (such as
+// iree::WaitHandle or HAL fences) can be adapted to. Callers executing on a
+// dedicated thread block in |wait| while schedulers multiplexing many
+// suspended executions over a small number of threads use |notify| so that
+// they neither block nor poll.
+typedef struct {
+  void* self;
+  // Waits until the handle is signaled or |deadline| elapses.
+  // Returns IREE_STATUS_OK if signaled, IREE_STATUS_DEADLINE_EXCEEDED if the
+  // deadline elapsed first, and any other status if the wait failed.
+  iree_status_t(IREE_API_PTR* wait)(void* self, iree_time_t deadline);
+  // Calls |fn| with |user_data| exactly once when the handle is signaled or
+  // its wait fails, after which |wait| returns without blocking. The call may
+  // happen on any thread, including the calling thread before notify returns.
+  // The handle must remain valid until |fn| has been called.
+  void(IREE_API_PTR* notify)(void* self, void* user_data,
+                             void(IREE_API_PTR* fn)(void* user_data));
+} iree_vm_wait_handle_t;
+
+// Describes why an iree_vm_module_execute request returned.
+typedef enum {
+  // The entry frame returned and its results are available.
+  IREE_VM_EXECUTION_COMPLETED = 0,
+  // Execution yielded and may be resumed at any time.
+  IREE_VM_EXECUTION_YIELDED = 1,
+  // Execution is blocked on |wait_handle| and should be resumed once it has
+  // been signaled.
+  IREE_VM_EXECUTION_WAITING = 2,
+} iree_vm_execution_state_t;
+
 // Results of an iree_vm_module_execute request.
+// Suspended executions leave their frames on the stack and are resumed by
+// calling execute again with the same entry frame.
 typedef struct {
-  // TODO(benvanik): yield information.
-  // Yield modes:
-  // - yield (yield instruction)
-  // - await (with 1+ wait handles)
-  // - break
+  iree_vm_execution_state_t state;
+  // Handle to wait on prior to resuming when |state| is
+  // IREE_VM_EXECUTION_WAITING.
+  iree_vm_wait_handle_t wait_handle;
 } iree_vm_execution_result_t;
 
 // Defines an interface that can be used to reflect and execute functions on a
@@ -137,6 +170,8 @@ typedef struct iree_vm_module {
   // Asynchronously executes the function specified in the |frame|.
   // This may be called repeatedly for the same frame if the execution
   // previously yielded. The offset within the frame is preserved across calls.
+  // Implementations that suspend must leave |frame| and any frames they
+  // entered on the stack and set |out_result| to describe the suspension.
   iree_status_t(IREE_API_PTR* execute)(void* self, iree_vm_stack_t* stack,
                                        iree_vm_stack_frame_t* frame,
                                        iree_vm_execution_result_t* out_result);
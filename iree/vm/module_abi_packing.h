@@ -381,6 +381,12 @@ struct DispatchFunctor {
     frame->return_registers =
         reinterpret_cast<const iree_vm_register_list_t*>(kResultList.data());
 
+    // Results are left-aligned in each bank so the frame needs at most
+    // kResultCount registers per bank.
+    RETURN_IF_ERROR(FromApiStatus(iree_vm_stack_frame_reserve_registers(
+                                      stack, frame, kResultCount, kResultCount),
+                                  IREE_LOC));
+
     ResultPackState result_state;
     auto results = std::move(results_or).ValueOrDie();
     auto r = ResultPack<Results>(&result_state, frame, std::move(results));
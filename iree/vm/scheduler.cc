@@ -0,0 +1,357 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/vm/scheduler.h"
+
+#include <atomic>
+#include <deque>
+#include <new>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "iree/base/api_util.h"
+
+namespace {
+
+// An invocation that has been submitted to the scheduler.
+struct Fiber {
+  iree_vm_invocation_t* invocation = nullptr;
+  iree_vm_context_t* context = nullptr;
+  iree_vm_invocation_callback_t callback = {nullptr, nullptr};
+  // Handle the fiber last suspended on, if it is waiting.
+  iree_vm_wait_handle_t wait_handle = {nullptr, nullptr, nullptr};
+};
+
+// Fibers executing within a single context.
+// Module state is owned by the context and is not thread-safe, so at most one
+// fiber per context executes at a time.
+struct ContextQueue {
+  // Fibers that can be resumed, in FIFO order.
+  std::deque<Fiber> ready_fibers;
+  // Submitted fibers within the context that have not yet completed.
+  int fiber_count = 0;
+  // True while a worker is executing one of the fibers.
+  bool running = false;
+};
+
+// A fiber parked until its wait handle notifies the scheduler.
+struct ParkedFiber {
+  enum class State {
+    // The parking worker is registering for notification.
+    kArming,
+    // Notified while arming; the parking worker readies the fiber.
+    kNotified,
+    // Registered and waiting for notification.
+    kParked,
+    // Aborted and readied during shutdown; the notification only frees this.
+    kAbandoned,
+  };
+
+  iree_vm_scheduler_t* scheduler = nullptr;
+  Fiber fiber;
+  State state = State::kArming;
+};
+
+}  // namespace
+
+struct iree_vm_scheduler {
+  explicit iree_vm_scheduler(iree_allocator_t allocator)
+      : allocator(allocator) {}
+
+  // Thread entry point for workers that resume runnable fibers.
+  void WorkerMain();
+
+  // Parks |fiber| until its wait handle has been signaled.
+  void ParkFiber(Fiber fiber);
+
+  // Called by wait handles when the wait of a parked fiber has resolved.
+  static void OnWaitNotified(void* user_data);
+
+  // Issues the callback for a completed |fiber| and drops it.
+  void CompleteFiber(Fiber fiber, iree_status_t status);
+
+  // Queues |fiber| to be resumed once its context is available.
+  void EnqueueFiber(Fiber fiber) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex);
+
+  // Marks |context| as no longer running, making it available to other
+  // workers if it has ready fibers.
+  void ReleaseContext(iree_vm_context_t* context)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex);
+
+  bool HasReadyContextsOrShutdown() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex) {
+    return !ready_contexts.empty() || (shutdown && pending_count == 0);
+  }
+  bool IsIdle() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex) {
+    return pending_count == 0;
+  }
+  bool HasNoParkedFibers() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex) {
+    return parked_count == 0;
+  }
+
+  std::atomic<intptr_t> ref_count{1};
+  iree_allocator_t allocator;
+
+  std::vector<std::thread> workers;
+
+  mutable absl::Mutex mutex;
+  // Fiber queues of all contexts with submitted fibers.
+  absl::flat_hash_map<iree_vm_context_t*, ContextQueue> contexts
+      ABSL_GUARDED_BY(mutex);
+  // Contexts that are not running and have ready fibers, in FIFO order.
+  std::deque<iree_vm_context_t*> ready_contexts ABSL_GUARDED_BY(mutex);
+  // Fibers waiting for notification from their wait handle.
+  std::vector<ParkedFiber*> parked_fibers ABSL_GUARDED_BY(mutex);
+  // Total number of submitted fibers that have not yet completed.
+  int pending_count ABSL_GUARDED_BY(mutex) = 0;
+  // Total number of parked fibers whose notification has not been received,
+  // including those abandoned during shutdown.
+  int parked_count ABSL_GUARDED_BY(mutex) = 0;
+  bool shutdown ABSL_GUARDED_BY(mutex) = false;
+};
+
+void iree_vm_scheduler::WorkerMain() {
+  while (true) {
+    Fiber fiber;
+    {
+      absl::MutexLock lock(&mutex);
+      mutex.Await(absl::Condition(
+          this, &iree_vm_scheduler::HasReadyContextsOrShutdown));
+      if (ready_contexts.empty()) return;
+      auto& queue = contexts[ready_contexts.front()];
+      ready_contexts.pop_front();
+      queue.running = true;
+      fiber = queue.ready_fibers.front();
+      queue.ready_fibers.pop_front();
+    }
+
+    // Fibers readied by a notification observe the signaled handle here and
+    // those whose wait failed complete with the failure.
+    iree_vm_execution_result_t result;
+    iree_status_t status =
+        iree_vm_invocation_wait(fiber.invocation, IREE_TIME_INFINITE_PAST);
+    if (iree_status_is_ok(status)) {
+      status = iree_vm_invocation_resume(fiber.invocation, &result);
+    } else if (status == IREE_STATUS_DEADLINE_EXCEEDED) {
+      result.state = IREE_VM_EXECUTION_WAITING;
+      result.wait_handle = fiber.wait_handle;
+      status = IREE_STATUS_UNAVAILABLE;
+    }
+    if (status != IREE_STATUS_UNAVAILABLE) {
+      CompleteFiber(fiber, status);
+      continue;
+    }
+
+    if (result.state == IREE_VM_EXECUTION_WAITING &&
+        result.wait_handle.notify) {
+      fiber.wait_handle = result.wait_handle;
+      ParkFiber(fiber);
+      continue;
+    }
+
+    // The fiber yielded; requeue it behind other runnable fibers. Waits that
+    // cannot notify would have to be polled and are aborted instead.
+    absl::MutexLock lock(&mutex);
+    if (shutdown || result.state == IREE_VM_EXECUTION_WAITING) {
+      iree_vm_invocation_abort(fiber.invocation);
+    }
+    EnqueueFiber(fiber);
+    ReleaseContext(fiber.context);
+  }
+}
+
+void iree_vm_scheduler::ParkFiber(Fiber fiber) {
+  auto* parked_fiber = new ParkedFiber();
+  parked_fiber->scheduler = this;
+  parked_fiber->fiber = fiber;
+  {
+    // Other fibers in the context can run while this one is parked.
+    absl::MutexLock lock(&mutex);
+    ++parked_count;
+    ReleaseContext(fiber.context);
+  }
+
+  fiber.wait_handle.notify(fiber.wait_handle.self, parked_fiber,
+                           &iree_vm_scheduler::OnWaitNotified);
+
+  absl::MutexLock lock(&mutex);
+  if (parked_fiber->state == ParkedFiber::State::kNotified) {
+    EnqueueFiber(fiber);
+    --parked_count;
+    delete parked_fiber;
+  } else if (shutdown) {
+    iree_vm_invocation_abort(fiber.invocation);
+    EnqueueFiber(fiber);
+    parked_fiber->state = ParkedFiber::State::kAbandoned;
+  } else {
+    parked_fiber->state = ParkedFiber::State::kParked;
+    parked_fibers.push_back(parked_fiber);
+  }
+}
+
+// static
+void iree_vm_scheduler::OnWaitNotified(void* user_data) {
+  auto* parked_fiber = static_cast<ParkedFiber*>(user_data);
+  auto* scheduler = parked_fiber->scheduler;
+  absl::MutexLock lock(&scheduler->mutex);
+  switch (parked_fiber->state) {
+    case ParkedFiber::State::kArming:
+      // ParkFiber is still registering and will ready the fiber itself.
+      parked_fiber->state = ParkedFiber::State::kNotified;
+      return;
+    case ParkedFiber::State::kParked:
+      scheduler->parked_fibers.erase(
+          absl::c_find(scheduler->parked_fibers, parked_fiber));
+      scheduler->EnqueueFiber(parked_fiber->fiber);
+      break;
+    default:
+      // Abandoned fibers were already readied during shutdown.
+      break;
+  }
+  --scheduler->parked_count;
+  delete parked_fiber;
+}
+
+void iree_vm_scheduler::CompleteFiber(Fiber fiber, iree_status_t status) {
+  if (fiber.callback.fn) {
+    fiber.callback.fn(fiber.callback.user_data, fiber.invocation, status);
+  }
+  iree_vm_invocation_release(fiber.invocation);
+  absl::MutexLock lock(&mutex);
+  --contexts[fiber.context].fiber_count;
+  ReleaseContext(fiber.context);
+  --pending_count;
+}
+
+void iree_vm_scheduler::EnqueueFiber(Fiber fiber) {
+  auto& queue = contexts[fiber.context];
+  queue.ready_fibers.push_back(fiber);
+  if (!queue.running && queue.ready_fibers.size() == 1) {
+    ready_contexts.push_back(fiber.context);
+  }
+}
+
+void iree_vm_scheduler::ReleaseContext(iree_vm_context_t* context) {
+  auto it = contexts.find(context);
+  auto& queue = it->second;
+  queue.running = false;
+  if (!queue.ready_fibers.empty()) {
+    ready_contexts.push_back(context);
+  } else if (queue.fiber_count == 0) {
+    contexts.erase(it);
+  }
+}
+
+IREE_API_EXPORT iree_status_t IREE_API_CALL
+iree_vm_scheduler_create(int32_t worker_count, iree_allocator_t allocator,
+                         iree_vm_scheduler_t** out_scheduler) {
+  if (!out_scheduler) return IREE_STATUS_INVALID_ARGUMENT;
+  *out_scheduler = nullptr;
+  if (worker_count < 1) return IREE_STATUS_INVALID_ARGUMENT;
+
+  void* storage = nullptr;
+  IREE_RETURN_IF_ERROR(
+      iree_allocator_malloc(allocator, sizeof(iree_vm_scheduler_t), &storage));
+  auto* scheduler = new (storage) iree_vm_scheduler_t(allocator);
+  scheduler->workers.reserve(worker_count);
+  for (int i = 0; i < worker_count; ++i) {
+    scheduler->workers.emplace_back([scheduler]() { scheduler->WorkerMain(); });
+  }
+
+  *out_scheduler = scheduler;
+  return IREE_STATUS_OK;
+}
+
+static void iree_vm_scheduler_destroy(iree_vm_scheduler_t* scheduler) {
+  {
+    // Abort everything still pending; fibers that are currently running are
+    // aborted by the worker when they next suspend. Parked fibers are readied
+    // so that they complete without waiting for their handles.
+    absl::MutexLock lock(&scheduler->mutex);
+    scheduler->shutdown = true;
+    for (auto& context_queue : scheduler->contexts) {
+      for (auto& fiber : context_queue.second.ready_fibers) {
+        iree_vm_invocation_abort(fiber.invocation);
+      }
+    }
+    for (auto* parked_fiber : scheduler->parked_fibers) {
+      iree_vm_invocation_abort(parked_fiber->fiber.invocation);
+      scheduler->EnqueueFiber(parked_fiber->fiber);
+      parked_fiber->state = ParkedFiber::State::kAbandoned;
+    }
+    scheduler->parked_fibers.clear();
+  }
+  for (auto& worker : scheduler->workers) {
+    worker.join();
+  }
+  {
+    // Outstanding notifications reference the scheduler.
+    absl::MutexLock lock(&scheduler->mutex);
+    scheduler->mutex.Await(absl::Condition(
+        scheduler, &iree_vm_scheduler::HasNoParkedFibers));
+  }
+
+  iree_allocator_t allocator = scheduler->allocator;
+  scheduler->~iree_vm_scheduler();
+  iree_allocator_free(allocator, scheduler);
+}
+
+IREE_API_EXPORT iree_status_t IREE_API_CALL
+iree_vm_scheduler_retain(iree_vm_scheduler_t* scheduler) {
+  if (!scheduler) return IREE_STATUS_INVALID_ARGUMENT;
+  scheduler->ref_count.fetch_add(1);
+  return IREE_STATUS_OK;
+}
+
+IREE_API_EXPORT iree_status_t IREE_API_CALL
+iree_vm_scheduler_release(iree_vm_scheduler_t* scheduler) {
+  if (scheduler && scheduler->ref_count.fetch_sub(1) == 1) {
+    iree_vm_scheduler_destroy(scheduler);
+  }
+  return IREE_STATUS_OK;
+}
+
+IREE_API_EXPORT iree_status_t IREE_API_CALL
+iree_vm_scheduler_submit(iree_vm_scheduler_t* scheduler,
+                         iree_vm_invocation_t* invocation,
+                         iree_vm_invocation_callback_t callback) {
+  if (!scheduler || !invocation) return IREE_STATUS_INVALID_ARGUMENT;
+  absl::MutexLock lock(&scheduler->mutex);
+  if (scheduler->shutdown) return IREE_STATUS_FAILED_PRECONDITION;
+  iree_vm_invocation_retain(invocation);
+  Fiber fiber;
+  fiber.invocation = invocation;
+  fiber.context = iree_vm_invocation_context(invocation);
+  fiber.callback = callback;
+  ++scheduler->contexts[fiber.context].fiber_count;
+  scheduler->EnqueueFiber(fiber);
+  ++scheduler->pending_count;
+  return IREE_STATUS_OK;
+}
+
+IREE_API_EXPORT iree_status_t IREE_API_CALL iree_vm_scheduler_await_idle(
+    iree_vm_scheduler_t* scheduler, iree_time_t deadline) {
+  if (!scheduler) return IREE_STATUS_INVALID_ARGUMENT;
+  absl::MutexLock lock(&scheduler->mutex);
+  if (!scheduler->mutex.AwaitWithDeadline(
+          absl::Condition(scheduler, &iree_vm_scheduler::IsIdle),
+          iree::ToAbslTime(deadline))) {
+    return IREE_STATUS_DEADLINE_EXCEEDED;
+  }
+  return IREE_STATUS_OK;
+}
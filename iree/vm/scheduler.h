@@ -0,0 +1,93 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// See iree/base/api.h for documentation on the API conventions used.
+
+#ifndef IREE_VM_SCHEDULER_H_
+#define IREE_VM_SCHEDULER_H_
+
+#include "iree/base/api.h"
+#include "iree/vm/invocation.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Cooperative scheduler that multiplexes many invocations over a small pool of
+// worker threads.
+//
+// Each invocation executes on its own fiber stack. Workers run invocations
+// until they complete or suspend: yielded invocations are requeued behind
+// other runnable invocations and invocations waiting on a wait handle are
+// parked until the handle notifies the scheduler that it has been signaled.
+// No thread is ever blocked on an individual invocation. Invocations waiting on
+// handles that cannot notify are aborted.
+//
+// Module state is not thread-safe, so invocations sharing a context are
+// executed one at a time while invocations in different contexts run in
+// parallel. An invocation parked on a wait handle does not hold its context.
+//
+// Thread-safe.
+typedef struct iree_vm_scheduler iree_vm_scheduler_t;
+
+// Callback issued from a worker thread when a submitted invocation completes.
+typedef struct {
+  void* user_data;
+  void(IREE_API_PTR* fn)(void* user_data, iree_vm_invocation_t* invocation,
+                         iree_status_t status);
+} iree_vm_invocation_callback_t;
+
+#ifndef IREE_API_NO_PROTOTYPES
+
+// Creates a scheduler with |worker_count| worker threads executing
+// invocations. |worker_count| must be at least 1.
+IREE_API_EXPORT iree_status_t IREE_API_CALL
+iree_vm_scheduler_create(int32_t worker_count, iree_allocator_t allocator,
+                         iree_vm_scheduler_t** out_scheduler);
+
+// Retains the given |scheduler| for the caller.
+IREE_API_EXPORT iree_status_t IREE_API_CALL
+iree_vm_scheduler_retain(iree_vm_scheduler_t* scheduler);
+
+// Releases the given |scheduler| from the caller.
+// When the last reference is released all pending invocations are aborted and
+// the calling thread blocks until their callbacks have been issued and all
+// parked invocations have been notified by their wait handles. Must not be
+// called from a scheduler callback.
+IREE_API_EXPORT iree_status_t IREE_API_CALL
+iree_vm_scheduler_release(iree_vm_scheduler_t* scheduler);
+
+// Submits |invocation| for execution on the scheduler.
+// The invocation is retained until it completes, at which point |callback| (if
+// any) is called with its completion status. The invocation must not have
+// been started and must not be resumed or awaited by the caller directly.
+// Invocations aborted by the caller while parked complete once their wait
+// handle notifies the scheduler.
+IREE_API_EXPORT iree_status_t IREE_API_CALL
+iree_vm_scheduler_submit(iree_vm_scheduler_t* scheduler,
+                         iree_vm_invocation_t* invocation,
+                         iree_vm_invocation_callback_t callback);
+
+// Blocks the caller until all submitted invocations have completed.
+// Returns IREE_STATUS_DEADLINE_EXCEEDED if |deadline| elapses first.
+IREE_API_EXPORT iree_status_t IREE_API_CALL iree_vm_scheduler_await_idle(
+    iree_vm_scheduler_t* scheduler, iree_time_t deadline);
+
+#endif  // IREE_API_NO_PROTOTYPES
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_VM_SCHEDULER_H_
@@ -0,0 +1,265 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/vm/scheduler.h"
+
+#include <algorithm>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "iree/base/api.h"
+#include "iree/base/logging.h"
+#include "iree/testing/gtest.h"
+#include "iree/vm/context.h"
+#include "iree/vm/instance.h"
+#include "iree/vm/invocation.h"
+#include "iree/vm/testing/test_module.h"
+#include "iree/vm/variant_list.h"
+
+namespace {
+
+using iree::vm::testing::TestModule;
+using iree::vm::testing::TestWaitHandle;
+
+// Records the completion of submitted invocations.
+class Completions {
+ public:
+  iree_vm_invocation_callback_t callback() { return {this, &OnComplete}; }
+
+  // Blocks until |count| invocations have completed and returns their
+  // statuses in completion order.
+  std::vector<iree_status_t> Await(int count) {
+    auto has_completed = [this, count]() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+      return statuses_.size() >= count;
+    };
+    absl::MutexLock lock(&mutex_);
+    mutex_.Await(absl::Condition(&has_completed));
+    return statuses_;
+  }
+
+  std::vector<iree_status_t> statuses() {
+    absl::MutexLock lock(&mutex_);
+    return statuses_;
+  }
+
+ private:
+  static void OnComplete(void* user_data, iree_vm_invocation_t* invocation,
+                         iree_status_t status) {
+    auto* completions = static_cast<Completions*>(user_data);
+    absl::MutexLock lock(&completions->mutex_);
+    completions->statuses_.push_back(status);
+  }
+
+  absl::Mutex mutex_;
+  std::vector<iree_status_t> statuses_ ABSL_GUARDED_BY(mutex_);
+};
+
+class VMSchedulerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    IREE_ASSERT_OK(iree_vm_instance_create(IREE_ALLOCATOR_SYSTEM, &instance_));
+  }
+
+  void TearDown() override {
+    for (auto* invocation : invocations_) {
+      iree_vm_invocation_release(invocation);
+    }
+    for (auto* context : contexts_) {
+      iree_vm_context_release(context);
+    }
+    iree_vm_instance_release(instance_);
+  }
+
+  iree_vm_context_t* CreateContext() {
+    iree_vm_module_t* modules[] = {test_module_.module()};
+    iree_vm_context_t* context = nullptr;
+    IREE_CHECK_OK(iree_vm_context_create_with_modules(
+        instance_, modules, 1, IREE_ALLOCATOR_SYSTEM, &context));
+    contexts_.push_back(context);
+    return context;
+  }
+
+  iree_vm_invocation_t* CreateInvocation(iree_vm_context_t* context,
+                                         const char* function_name,
+                                         std::vector<int32_t> inputs) {
+    iree_vm_variant_list_t* input_list = nullptr;
+    IREE_CHECK_OK(iree_vm_variant_list_alloc(inputs.size(),
+                                             IREE_ALLOCATOR_SYSTEM,
+                                             &input_list));
+    for (int32_t value : inputs) {
+      IREE_CHECK_OK(iree_vm_variant_list_append_value(
+          input_list, IREE_VM_VALUE_MAKE_I32(value)));
+    }
+    iree_vm_invocation_t* invocation = nullptr;
+    IREE_CHECK_OK(iree_vm_invocation_create(
+        context, test_module_.LookupFunction(function_name),
+        /*policy=*/nullptr, input_list, IREE_ALLOCATOR_SYSTEM, &invocation));
+    iree_vm_variant_list_free(input_list);
+    invocations_.push_back(invocation);
+    return invocation;
+  }
+
+  // Returns the single i32 result of a completed |invocation|.
+  static int32_t Result(iree_vm_invocation_t* invocation) {
+    auto* outputs = const_cast<iree_vm_variant_list_t*>(
+        iree_vm_invocation_output(invocation));
+    EXPECT_NE(nullptr, outputs);
+    if (!outputs) return -1;
+    return iree_vm_variant_list_get(outputs, 0)->i32;
+  }
+
+  TestWaitHandle wait_handle_;
+  TestModule test_module_{&wait_handle_};
+  iree_vm_instance_t* instance_ = nullptr;
+  std::vector<iree_vm_context_t*> contexts_;
+  std::vector<iree_vm_invocation_t*> invocations_;
+};
+
+TEST_F(VMSchedulerTest, CompletesSubmittedInvocations) {
+  iree_vm_scheduler_t* scheduler = nullptr;
+  IREE_ASSERT_OK(
+      iree_vm_scheduler_create(2, IREE_ALLOCATOR_SYSTEM, &scheduler));
+  Completions completions;
+  std::vector<iree_vm_invocation_t*> invocations;
+  for (int i = 0; i < 3; ++i) {
+    auto* context = CreateContext();
+    for (int j = 0; j < 4; ++j) {
+      invocations.push_back(CreateInvocation(context, "yield", {i * 4 + j}));
+      IREE_ASSERT_OK(iree_vm_scheduler_submit(scheduler, invocations.back(),
+                                              completions.callback()));
+    }
+  }
+  invocations.push_back(CreateInvocation(CreateContext(), "fail", {}));
+  IREE_ASSERT_OK(iree_vm_scheduler_submit(scheduler, invocations.back(),
+                                          completions.callback()));
+
+  IREE_ASSERT_OK(
+      iree_vm_scheduler_await_idle(scheduler, IREE_TIME_INFINITE_FUTURE));
+  auto statuses = completions.statuses();
+  EXPECT_EQ(invocations.size(), statuses.size());
+  EXPECT_EQ(1, std::count(statuses.begin(), statuses.end(),
+                          IREE_STATUS_INTERNAL));
+  for (int i = 0; i < invocations.size() - 1; ++i) {
+    IREE_EXPECT_OK(iree_vm_invocation_query_status(invocations[i]));
+    EXPECT_EQ(i, Result(invocations[i]));
+  }
+  EXPECT_EQ(IREE_STATUS_INTERNAL,
+            iree_vm_invocation_query_status(invocations.back()));
+  iree_vm_scheduler_release(scheduler);
+}
+
+TEST_F(VMSchedulerTest, SerializesInvocationsWithinContext) {
+  iree_vm_scheduler_t* scheduler = nullptr;
+  IREE_ASSERT_OK(
+      iree_vm_scheduler_create(4, IREE_ALLOCATOR_SYSTEM, &scheduler));
+  Completions completions;
+  for (int i = 0; i < 2; ++i) {
+    auto* context = CreateContext();
+    for (int j = 0; j < 8; ++j) {
+      IREE_ASSERT_OK(iree_vm_scheduler_submit(
+          scheduler, CreateInvocation(context, "exclusive", {50}),
+          completions.callback()));
+    }
+  }
+  IREE_ASSERT_OK(
+      iree_vm_scheduler_await_idle(scheduler, IREE_TIME_INFINITE_FUTURE));
+  EXPECT_EQ(0, test_module_.overlap_count());
+  EXPECT_EQ(16 * 51, test_module_.execute_count());
+  iree_vm_scheduler_release(scheduler);
+}
+
+TEST_F(VMSchedulerTest, ResumesParkedInvocationsWhenSignaled) {
+  iree_vm_scheduler_t* scheduler = nullptr;
+  IREE_ASSERT_OK(
+      iree_vm_scheduler_create(1, IREE_ALLOCATOR_SYSTEM, &scheduler));
+  Completions completions;
+  auto* context = CreateContext();
+  auto* waiting_invocation = CreateInvocation(context, "wait", {});
+  IREE_ASSERT_OK(iree_vm_scheduler_submit(scheduler, waiting_invocation,
+                                          completions.callback()));
+
+  // A parked invocation holds neither the only worker nor its context.
+  auto* add_invocation = CreateInvocation(context, "add", {2, 3});
+  IREE_ASSERT_OK(iree_vm_scheduler_submit(scheduler, add_invocation,
+                                          completions.callback()));
+  auto statuses = completions.Await(1);
+  IREE_EXPECT_OK(statuses[0]);
+  EXPECT_EQ(5, Result(add_invocation));
+  EXPECT_EQ(IREE_STATUS_UNAVAILABLE,
+            iree_vm_invocation_query_status(waiting_invocation));
+  EXPECT_EQ(IREE_STATUS_DEADLINE_EXCEEDED,
+            iree_vm_scheduler_await_idle(scheduler, IREE_TIME_INFINITE_PAST));
+
+  wait_handle_.Signal();
+  IREE_ASSERT_OK(
+      iree_vm_scheduler_await_idle(scheduler, IREE_TIME_INFINITE_FUTURE));
+  IREE_EXPECT_OK(iree_vm_invocation_query_status(waiting_invocation));
+  EXPECT_EQ(1, Result(waiting_invocation));
+  iree_vm_scheduler_release(scheduler);
+}
+
+TEST_F(VMSchedulerTest, CompletesInvocationsWhoseWaitFailed) {
+  iree_vm_scheduler_t* scheduler = nullptr;
+  IREE_ASSERT_OK(
+      iree_vm_scheduler_create(1, IREE_ALLOCATOR_SYSTEM, &scheduler));
+  Completions completions;
+  auto* invocation = CreateInvocation(CreateContext(), "wait", {});
+  IREE_ASSERT_OK(
+      iree_vm_scheduler_submit(scheduler, invocation, completions.callback()));
+  wait_handle_.Signal(IREE_STATUS_DATA_LOSS);
+  auto statuses = completions.Await(1);
+  EXPECT_EQ(IREE_STATUS_DATA_LOSS, statuses[0]);
+  iree_vm_scheduler_release(scheduler);
+}
+
+TEST_F(VMSchedulerTest, ReleaseAbortsPendingInvocations) {
+  iree_vm_scheduler_t* scheduler = nullptr;
+  IREE_ASSERT_OK(
+      iree_vm_scheduler_create(1, IREE_ALLOCATOR_SYSTEM, &scheduler));
+  Completions completions;
+  auto* context = CreateContext();
+  auto* waiting_invocation = CreateInvocation(context, "wait", {});
+  IREE_ASSERT_OK(iree_vm_scheduler_submit(scheduler, waiting_invocation,
+                                          completions.callback()));
+  auto* yielding_invocation = CreateInvocation(context, "yield", {1 << 30});
+  IREE_ASSERT_OK(iree_vm_scheduler_submit(scheduler, yielding_invocation,
+                                          completions.callback()));
+
+  // Release blocks until the parked invocation has been notified, but both
+  // invocations are aborted without waiting for the handle.
+  std::thread release_thread(
+      [scheduler]() { iree_vm_scheduler_release(scheduler); });
+  auto statuses = completions.Await(2);
+  EXPECT_EQ(IREE_STATUS_ABORTED, statuses[0]);
+  EXPECT_EQ(IREE_STATUS_ABORTED, statuses[1]);
+  wait_handle_.Signal();
+  release_thread.join();
+  EXPECT_EQ(IREE_STATUS_ABORTED,
+            iree_vm_invocation_query_status(waiting_invocation));
+  EXPECT_EQ(IREE_STATUS_ABORTED,
+            iree_vm_invocation_query_status(yielding_invocation));
+}
+
+TEST_F(VMSchedulerTest, RejectsInvalidArguments) {
+  iree_vm_scheduler_t* scheduler = nullptr;
+  EXPECT_EQ(IREE_STATUS_INVALID_ARGUMENT,
+            iree_vm_scheduler_create(0, IREE_ALLOCATOR_SYSTEM, &scheduler));
+  EXPECT_EQ(nullptr, scheduler);
+  EXPECT_EQ(IREE_STATUS_INVALID_ARGUMENT,
+            iree_vm_scheduler_submit(scheduler, nullptr, {nullptr, nullptr}));
+}
+
+}  // namespace
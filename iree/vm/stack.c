@@ -18,10 +18,100 @@
 
 #include "iree/vm/module.h"
 
+// Alignment of all allocations made from stack blocks.
+#define IREE_VM_STACK_ALIGNMENT 16
+
+static iree_host_size_t iree_vm_stack_align(iree_host_size_t value) {
+  return (value + IREE_VM_STACK_ALIGNMENT - 1) &
+         ~(iree_host_size_t)(IREE_VM_STACK_ALIGNMENT - 1);
+}
+
+// Bump-allocates |size| bytes from the stack, moving on to the next block in
+// the chain (allocating it if needed) when the current block is exhausted.
+static iree_status_t iree_vm_stack_alloc(iree_vm_stack_t* stack,
+                                         iree_host_size_t size,
+                                         void** out_ptr) {
+  size = iree_vm_stack_align(size);
+  iree_vm_stack_block_t* block = stack->current_block;
+  if (stack->current_offset + size <= block->capacity) {
+    *out_ptr = block->data + stack->current_offset;
+    stack->current_offset += size;
+    return IREE_STATUS_OK;
+  }
+
+  // Drop any retained blocks that are too small for the allocation; this only
+  // happens for unusually large frames.
+  iree_vm_stack_block_t** next_ptr = &block->next;
+  while (*next_ptr && (*next_ptr)->capacity < size) {
+    iree_vm_stack_block_t* next = (*next_ptr)->next;
+    iree_allocator_free(stack->allocator, *next_ptr);
+    *next_ptr = next;
+  }
+  if (!*next_ptr) {
+    iree_host_size_t header_size = iree_vm_stack_align(sizeof(**next_ptr));
+    iree_host_size_t capacity =
+        size > IREE_VM_STACK_BLOCK_SIZE ? size : IREE_VM_STACK_BLOCK_SIZE;
+    iree_vm_stack_block_t* new_block = NULL;
+    IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+        stack->allocator, header_size + capacity, (void**)&new_block));
+    new_block->next = NULL;
+    new_block->data = (uint8_t*)new_block + header_size;
+    new_block->capacity = capacity;
+    *next_ptr = new_block;
+  }
+
+  stack->current_block = *next_ptr;
+  stack->current_offset = size;
+  *out_ptr = stack->current_block->data;
+  return IREE_STATUS_OK;
+}
+
+// Returns the register bank capacity for |register_count| registers.
+// Capacities are powers of two so that register ordinals can be masked.
+static int32_t iree_vm_stack_register_capacity(int32_t register_count) {
+  int32_t capacity = 1;
+  while (capacity < register_count) capacity <<= 1;
+  return capacity;
+}
+
+// Allocates storage for the register banks in |registers| with room for at
+// least the given number of registers in each bank.
+static iree_status_t iree_vm_stack_alloc_registers(
+    iree_vm_stack_t* stack, iree_vm_registers_t* registers,
+    int32_t i32_register_count, int32_t ref_register_count) {
+  int32_t i32_capacity = iree_vm_stack_register_capacity(i32_register_count);
+  int32_t ref_capacity = iree_vm_stack_register_capacity(ref_register_count);
+  iree_host_size_t i32_size =
+      iree_vm_stack_align(sizeof(int32_t) * (i32_capacity + 1));
+  iree_host_size_t ref_size = sizeof(iree_vm_ref_t) * ref_capacity;
+  uint8_t* storage = NULL;
+  IREE_RETURN_IF_ERROR(
+      iree_vm_stack_alloc(stack, i32_size + ref_size, (void**)&storage));
+  registers->i32 = (int32_t*)storage;
+  registers->ref = (iree_vm_ref_t*)(storage + i32_size);
+  registers->i32_register_capacity = i32_capacity;
+  registers->ref_register_capacity = ref_capacity;
+  registers->i32_mask = (uint8_t)(i32_capacity - 1);
+  registers->ref_mask = (uint8_t)(ref_capacity - 1);
+  return IREE_STATUS_OK;
+}
+
 IREE_API_EXPORT iree_status_t IREE_API_CALL iree_vm_stack_init(
-    iree_vm_state_resolver_t state_resolver, iree_vm_stack_t* out_stack) {
+    iree_byte_span_t storage, iree_vm_state_resolver_t state_resolver,
+    iree_allocator_t allocator, iree_vm_stack_t* out_stack) {
   memset(out_stack, 0, sizeof(iree_vm_stack_t));
   out_stack->state_resolver = state_resolver;
+  out_stack->allocator = allocator;
+
+  // Align the inline storage to what we need for frames.
+  uintptr_t storage_base = (uintptr_t)storage.data;
+  uintptr_t aligned_base = iree_vm_stack_align(storage_base);
+  if (storage.data && aligned_base - storage_base < storage.data_length) {
+    out_stack->inline_block.data = (uint8_t*)aligned_base;
+    out_stack->inline_block.capacity =
+        storage.data_length - (aligned_base - storage_base);
+  }
+  out_stack->current_block = &out_stack->inline_block;
   return IREE_STATUS_OK;
 }
 
@@ -30,75 +120,163 @@ iree_vm_stack_deinit(iree_vm_stack_t* stack) {
   while (stack->depth) {
     IREE_RETURN_IF_ERROR(iree_vm_stack_function_leave(stack));
   }
+
+  iree_vm_stack_block_t* block = stack->inline_block.next;
+  while (block) {
+    iree_vm_stack_block_t* next = block->next;
+    iree_allocator_free(stack->allocator, block);
+    block = next;
+  }
+  stack->inline_block.next = NULL;
+  stack->current_block = &stack->inline_block;
+  stack->current_offset = 0;
   return IREE_STATUS_OK;
 }
 
 IREE_API_EXPORT iree_vm_stack_frame_t* IREE_API_CALL
 iree_vm_stack_current_frame(iree_vm_stack_t* stack) {
-  return stack->depth > 0 ? &stack->frames[stack->depth - 1] : NULL;
+  return stack->top;
 }
 
 IREE_API_EXPORT iree_vm_stack_frame_t* IREE_API_CALL
 iree_vm_stack_parent_frame(iree_vm_stack_t* stack) {
-  return stack->depth > 1 ? &stack->frames[stack->depth - 2] : NULL;
+  return stack->top ? stack->top->parent : NULL;
 }
 
 IREE_API_EXPORT iree_status_t IREE_API_CALL iree_vm_stack_function_enter(
     iree_vm_stack_t* stack, iree_vm_function_t function,
+    int32_t i32_register_count, int32_t ref_register_count,
     iree_vm_stack_frame_t** out_callee_frame) {
   *out_callee_frame = NULL;
   if (stack->depth == IREE_MAX_STACK_DEPTH) {
     return IREE_STATUS_RESOURCE_EXHAUSTED;
+  } else if (i32_register_count < 0 ||
+             i32_register_count > IREE_I32_REGISTER_COUNT ||
+             ref_register_count < 0 ||
+             ref_register_count > IREE_REF_REGISTER_COUNT) {
+    return IREE_STATUS_INVALID_ARGUMENT;
   }
 
+  // Frame storage is released on leave by resetting the allocation position
+  // to where it was prior to allocating the frame.
+  iree_vm_stack_block_t* prev_block = stack->current_block;
+  iree_host_size_t prev_offset = stack->current_offset;
+  iree_vm_stack_frame_t* callee_frame = NULL;
+  iree_status_t status = iree_vm_stack_alloc(
+      stack, sizeof(iree_vm_stack_frame_t), (void**)&callee_frame);
+  if (iree_status_is_ok(status)) {
+    status = iree_vm_stack_alloc_registers(stack, &callee_frame->registers,
+                                           i32_register_count,
+                                           ref_register_count);
+  }
+  if (!iree_status_is_ok(status)) {
+    stack->current_block = prev_block;
+    stack->current_offset = prev_offset;
+    return status;
+  }
+  callee_frame->prev_block = prev_block;
+  callee_frame->prev_offset = prev_offset;
+  callee_frame->registers.ref_register_count = 0;
+
   // Try to reuse the same module state if the caller and callee are from the
   // same module. Otherwise, query the state from the registered handler.
-  iree_vm_stack_frame_t* callee_frame = &stack->frames[stack->depth];
-  if (stack->depth > 0) {
-    iree_vm_stack_frame_t* caller_frame = &stack->frames[stack->depth - 1];
-    if (caller_frame->function.module == function.module) {
-      callee_frame->module_state = caller_frame->module_state;
-    }
+  iree_vm_stack_frame_t* caller_frame = stack->top;
+  callee_frame->module_state = NULL;
+  if (caller_frame && caller_frame->function.module == function.module) {
+    callee_frame->module_state = caller_frame->module_state;
   }
   if (!callee_frame->module_state) {
-    IREE_RETURN_IF_ERROR(stack->state_resolver.query_module_state(
+    status = stack->state_resolver.query_module_state(
         stack->state_resolver.self, function.module,
-        &callee_frame->module_state));
+        &callee_frame->module_state);
+    if (!iree_status_is_ok(status)) {
+      stack->current_block = prev_block;
+      stack->current_offset = prev_offset;
+      return status;
+    }
   }
 
   ++stack->depth;
+  callee_frame->parent = caller_frame;
+  stack->top = callee_frame;
 
   callee_frame->function = function;
   callee_frame->offset = 0;
-  callee_frame->registers.ref_register_count = 0;
   callee_frame->return_registers = NULL;
 
 #ifndef NDEBUG
   memset(callee_frame->registers.i32, 0xCD,
-         sizeof(callee_frame->registers.i32));
+         sizeof(int32_t) * callee_frame->registers.i32_register_capacity);
   memset(callee_frame->registers.ref, 0xCD,
-         sizeof(callee_frame->registers.ref));
+         sizeof(iree_vm_ref_t) * callee_frame->registers.ref_register_capacity);
 #endif  // !NDEBUG
 
   *out_callee_frame = callee_frame;
   return IREE_STATUS_OK;
 }
 
+IREE_API_EXPORT iree_status_t IREE_API_CALL
+iree_vm_stack_frame_reserve_registers(iree_vm_stack_t* stack,
+                                      iree_vm_stack_frame_t* frame,
+                                      int32_t i32_register_count,
+                                      int32_t ref_register_count) {
+  iree_vm_registers_t* registers = &frame->registers;
+  if (i32_register_count <= registers->i32_register_capacity &&
+      ref_register_count <= registers->ref_register_capacity) {
+    return IREE_STATUS_OK;
+  } else if (frame != stack->top) {
+    // Only the top-most frame can grow as it owns the end of the allocation.
+    return IREE_STATUS_FAILED_PRECONDITION;
+  } else if (i32_register_count > IREE_I32_REGISTER_COUNT ||
+             ref_register_count > IREE_REF_REGISTER_COUNT) {
+    return IREE_STATUS_INVALID_ARGUMENT;
+  }
+  if (i32_register_count < registers->i32_register_capacity) {
+    i32_register_count = registers->i32_register_capacity;
+  }
+  if (ref_register_count < registers->ref_register_capacity) {
+    ref_register_count = registers->ref_register_capacity;
+  }
+
+  // Allocate new storage past the existing registers and move them over. The
+  // old storage is reclaimed along with the rest of the frame on leave.
+  iree_vm_registers_t new_registers = *registers;
+  IREE_RETURN_IF_ERROR(iree_vm_stack_alloc_registers(
+      stack, &new_registers, i32_register_count, ref_register_count));
+  memcpy(new_registers.i32, registers->i32,
+         sizeof(int32_t) * registers->i32_register_capacity);
+  memcpy(new_registers.ref, registers->ref,
+         sizeof(iree_vm_ref_t) * registers->ref_register_count);
+#ifndef NDEBUG
+  memset(new_registers.i32 + registers->i32_register_capacity, 0xCD,
+         sizeof(int32_t) * (new_registers.i32_register_capacity -
+                            registers->i32_register_capacity));
+  memset(new_registers.ref + registers->ref_register_count, 0xCD,
+         sizeof(iree_vm_ref_t) * (new_registers.ref_register_capacity -
+                                  registers->ref_register_count));
+#endif  // !NDEBUG
+  *registers = new_registers;
+  return IREE_STATUS_OK;
+}
+
 IREE_API_EXPORT iree_status_t IREE_API_CALL
 iree_vm_stack_function_leave(iree_vm_stack_t* stack) {
   if (stack->depth <= 0) {
     return IREE_STATUS_FAILED_PRECONDITION;
   }
 
-  iree_vm_stack_frame_t* callee_frame = &stack->frames[stack->depth - 1];
+  iree_vm_stack_frame_t* callee_frame = stack->top;
   --stack->depth;
-  memset(&callee_frame->function, 0, sizeof(callee_frame->function));
-  callee_frame->module_state = NULL;
+  stack->top = callee_frame->parent;
 
   iree_vm_registers_t* registers = &callee_frame->registers;
   for (int i = 0; i < registers->ref_register_count; ++i) {
     iree_vm_ref_release(&registers->ref[i]);
   }
 
+  // Release the frame storage (and anything allocated after it).
+  stack->current_block = callee_frame->prev_block;
+  stack->current_offset = callee_frame->prev_offset;
+
   return IREE_STATUS_OK;
 }
@@ -28,7 +28,18 @@ extern "C" {
 #endif  // __cplusplus
 
 // Maximum stack depth, in frames.
-#define IREE_MAX_STACK_DEPTH 32
+// Frames are allocated on demand so this only bounds runaway recursion.
+#define IREE_MAX_STACK_DEPTH 1024
+
+// Size, in bytes, of each block of frame storage allocated from the stack
+// allocator once any inline storage has been exhausted. Larger frames get
+// dedicated blocks.
+#define IREE_VM_STACK_BLOCK_SIZE (8 * 1024)
+
+// Size, in bytes, of inline frame storage recommended for stacks allocated on
+// the host stack. This is enough for a handful of frames of typical size
+// before needing to allocate from the heap.
+#define IREE_VM_STACK_INLINE_STORAGE_SIZE (2 * 1024)
 
 // Maximum register count per bank.
 // This determines the bits required to reference registers in the VM bytecode.
@@ -48,13 +59,25 @@ extern "C" {
 typedef int64_t iree_vm_source_offset_t;
 
 // Register banks for use within a stack frame.
+// Storage for the banks is allocated from the stack along with the frame and
+// sized to the register counts required by the function rounded up to a power
+// of two. Register ordinals read from bytecode must be masked with the bank
+// mask so that malformed bytecode cannot reach outside of the frame. The i32
+// bank has one additional trailing register such that 64-bit values stored
+// in the last masked register pair remain in bounds.
 typedef struct {
   // Integer registers.
-  IREE_ALIGNAS(16) int32_t i32[IREE_I32_REGISTER_COUNT];
+  int32_t* i32;
   // Reference counted registers.
-  iree_vm_ref_t ref[IREE_REF_REGISTER_COUNT];
+  iree_vm_ref_t* ref;
+  // Number of registers allocated in each bank (excluding the trailing i32
+  // register). Always a power of two.
+  int16_t i32_register_capacity;
+  int16_t ref_register_capacity;
+  // Masks applied to register ordinals of each bank (capacity - 1).
+  uint8_t i32_mask;
+  uint8_t ref_mask;
   // Total number of valid ref registers used by the function.
-  // TODO(benvanik): make the above dynamic and include i32 count.
   int8_t ref_register_count;
 } iree_vm_registers_t;
 
@@ -71,8 +94,24 @@ static_assert(alignof(iree_vm_register_list_t) == 1,
 static_assert(offsetof(iree_vm_register_list_t, registers) == 1,
               "Expect no padding in the struct");
 
+// A block of memory frames are allocated from.
+typedef struct iree_vm_stack_block {
+  // Next block in the chain, retained for reuse once allocated.
+  struct iree_vm_stack_block* next;
+  // Storage for frames.
+  uint8_t* data;
+  iree_host_size_t capacity;
+} iree_vm_stack_block_t;
+
 // A single stack frame within the VM.
 typedef struct iree_vm_stack_frame {
+  // Caller frame or NULL if this is the bottom-most frame on the stack.
+  struct iree_vm_stack_frame* parent;
+  // Stack allocation position prior to allocating this frame. Restored when
+  // the frame is left to release the frame storage.
+  iree_vm_stack_block_t* prev_block;
+  iree_host_size_t prev_offset;
+
   // Function that the stack frame is within.
   iree_vm_function_t function;
   // Cached module state pointer for the module containing |function|.
@@ -80,7 +119,6 @@ typedef struct iree_vm_stack_frame {
   // Offset within the function.
   iree_vm_source_offset_t offset;
   // Registers used within the frame.
-  // TODO(benvanik): pointer to an arena? avoids fixed overheads.
   iree_vm_registers_t registers;
 
   // Pointer to a register list where callers can source their return registers.
@@ -100,12 +138,27 @@ typedef struct iree_vm_state_resolver {
 // A fiber stack used for storing stack frame state during execution.
 // All required state is stored within the stack and no host thread-local state
 // is used allowing us to execute multiple fibers on the same host thread.
+//
+// Frames and their registers are bump-allocated from a chain of blocks. The
+// first block may be storage provided by the caller (such as a buffer on the
+// host stack) and additional blocks are allocated from the stack allocator as
+// needed. Blocks are retained until the stack is deinitialized so that deep
+// call sequences only pay for the allocation once.
 typedef struct iree_vm_stack {
   // TODO(benvanik): add globally useful things (instance/device manager?)
   // Depth of the stack, in frames. 0 indicates an empty stack.
   int32_t depth;
-  // [0-depth) valid stack frames.
-  iree_vm_stack_frame_t frames[IREE_MAX_STACK_DEPTH];
+  // Current (top-most) frame or NULL if the stack is empty.
+  iree_vm_stack_frame_t* top;
+
+  // Block frames are currently being allocated from and the offset of the next
+  // allocation within it.
+  iree_vm_stack_block_t* current_block;
+  iree_host_size_t current_offset;
+  // Block wrapping the caller-provided storage, if any.
+  iree_vm_stack_block_t inline_block;
+  // Allocator used for additional blocks.
+  iree_allocator_t allocator;
 
   // Resolves a module to a module state within a context.
   // This will be called on function entry whenever module transitions occur.
@@ -113,8 +166,12 @@ typedef struct iree_vm_stack {
 } iree_vm_stack_t;
 
 // Constructs a stack in-place in |out_stack|.
+// Frames are allocated from |storage| first, which may be empty and must remain
+// valid until the stack is deinitialized. Once exhausted additional storage is
+// allocated from |allocator|.
 IREE_API_EXPORT iree_status_t IREE_API_CALL iree_vm_stack_init(
-    iree_vm_state_resolver_t state_resolver, iree_vm_stack_t* out_stack);
+    iree_byte_span_t storage, iree_vm_state_resolver_t state_resolver,
+    iree_allocator_t allocator, iree_vm_stack_t* out_stack);
 
 // Destructs |stack|.
 IREE_API_EXPORT iree_status_t IREE_API_CALL
@@ -129,11 +186,25 @@ IREE_API_EXPORT iree_vm_stack_frame_t* IREE_API_CALL
 iree_vm_stack_parent_frame(iree_vm_stack_t* stack);
 
 // Enters into the given |function| and returns the callee stack frame.
+// The frame has room for at least |i32_register_count| and
+// |ref_register_count| registers, which must cover the arguments and results
+// of the call. Callees needing more registers can grow the frame with
+// iree_vm_stack_frame_reserve_registers.
 // Callers must populate the argument registers as defined by the VM API.
 IREE_API_EXPORT iree_status_t IREE_API_CALL iree_vm_stack_function_enter(
     iree_vm_stack_t* stack, iree_vm_function_t function,
+    int32_t i32_register_count, int32_t ref_register_count,
     iree_vm_stack_frame_t** out_callee_frame);
 
+// Ensures that the current stack |frame| has room for at least
+// |i32_register_count| and |ref_register_count| registers. Existing register
+// contents are preserved.
+IREE_API_EXPORT iree_status_t IREE_API_CALL
+iree_vm_stack_frame_reserve_registers(iree_vm_stack_t* stack,
+                                      iree_vm_stack_frame_t* frame,
+                                      int32_t i32_register_count,
+                                      int32_t ref_register_count);
+
 // Leaves the current stack frame.
 // Callers must have retrieved the result registers as defined by the VM API.
 IREE_API_EXPORT iree_status_t IREE_API_CALL
@@ -49,7 +49,9 @@ static iree_status_t SentinelStateResolver(
 TEST(VMStackTest, Usage) {
   auto stack = std::make_unique<iree_vm_stack_t>();
   iree_vm_state_resolver_t state_resolver = {nullptr, SentinelStateResolver};
-  IREE_EXPECT_OK(iree_vm_stack_init(state_resolver, stack.get()));
+  IREE_EXPECT_OK(iree_vm_stack_init(iree_byte_span_t{nullptr, 0},
+                                    state_resolver, IREE_ALLOCATOR_SYSTEM,
+                                    stack.get()));
 
   EXPECT_EQ(nullptr, iree_vm_stack_current_frame(stack.get()));
   EXPECT_EQ(nullptr, iree_vm_stack_parent_frame(stack.get()));
@@ -58,7 +60,7 @@ TEST(VMStackTest, Usage) {
                                    IREE_VM_FUNCTION_LINKAGE_INTERNAL, 0};
   iree_vm_stack_frame_t* frame_a = nullptr;
   IREE_EXPECT_OK(
-      iree_vm_stack_function_enter(stack.get(), function_a, &frame_a));
+      iree_vm_stack_function_enter(stack.get(), function_a, 0, 0, &frame_a));
   EXPECT_EQ(0, frame_a->function.ordinal);
   EXPECT_EQ(frame_a, iree_vm_stack_current_frame(stack.get()));
   EXPECT_EQ(nullptr, iree_vm_stack_parent_frame(stack.get()));
@@ -67,7 +69,7 @@ TEST(VMStackTest, Usage) {
                                    IREE_VM_FUNCTION_LINKAGE_INTERNAL, 1};
   iree_vm_stack_frame_t* frame_b = nullptr;
   IREE_EXPECT_OK(
-      iree_vm_stack_function_enter(stack.get(), function_b, &frame_b));
+      iree_vm_stack_function_enter(stack.get(), function_b, 0, 0, &frame_b));
   EXPECT_EQ(1, frame_b->function.ordinal);
   EXPECT_EQ(frame_b, iree_vm_stack_current_frame(stack.get()));
   EXPECT_EQ(frame_a, iree_vm_stack_parent_frame(stack.get()));
@@ -86,13 +88,15 @@ TEST(VMStackTest, Usage) {
 TEST(VMStackTest, DeinitWithRemainingFrames) {
   auto stack = std::make_unique<iree_vm_stack_t>();
   iree_vm_state_resolver_t state_resolver = {nullptr, SentinelStateResolver};
-  IREE_EXPECT_OK(iree_vm_stack_init(state_resolver, stack.get()));
+  IREE_EXPECT_OK(iree_vm_stack_init(iree_byte_span_t{nullptr, 0},
+                                    state_resolver, IREE_ALLOCATOR_SYSTEM,
+                                    stack.get()));
 
   iree_vm_function_t function_a = {MODULE_A_SENTINEL,
                                    IREE_VM_FUNCTION_LINKAGE_INTERNAL, 0};
   iree_vm_stack_frame_t* frame_a = nullptr;
   IREE_EXPECT_OK(
-      iree_vm_stack_function_enter(stack.get(), function_a, &frame_a));
+      iree_vm_stack_function_enter(stack.get(), function_a, 0, 0, &frame_a));
   EXPECT_EQ(0, frame_a->function.ordinal);
   EXPECT_EQ(frame_a, iree_vm_stack_current_frame(stack.get()));
   EXPECT_EQ(nullptr, iree_vm_stack_parent_frame(stack.get()));
@@ -106,7 +110,9 @@ TEST(VMStackTest, DeinitWithRemainingFrames) {
 TEST(VMStackTest, StackOverflow) {
   auto stack = std::make_unique<iree_vm_stack_t>();
   iree_vm_state_resolver_t state_resolver = {nullptr, SentinelStateResolver};
-  IREE_EXPECT_OK(iree_vm_stack_init(state_resolver, stack.get()));
+  IREE_EXPECT_OK(iree_vm_stack_init(iree_byte_span_t{nullptr, 0},
+                                    state_resolver, IREE_ALLOCATOR_SYSTEM,
+                                    stack.get()));
 
   EXPECT_EQ(nullptr, iree_vm_stack_current_frame(stack.get()));
   EXPECT_EQ(nullptr, iree_vm_stack_parent_frame(stack.get()));
@@ -117,15 +123,16 @@ TEST(VMStackTest, StackOverflow) {
   for (int i = 0; i < IREE_MAX_STACK_DEPTH; ++i) {
     iree_vm_stack_frame_t* frame_a = nullptr;
     IREE_EXPECT_OK(
-        iree_vm_stack_function_enter(stack.get(), function_a, &frame_a));
+        iree_vm_stack_function_enter(stack.get(), function_a, 0, 0, &frame_a));
   }
 
   // Try to push on one more frame.
   iree_vm_function_t function_b = {MODULE_B_SENTINEL,
                                    IREE_VM_FUNCTION_LINKAGE_INTERNAL, 1};
   iree_vm_stack_frame_t* frame_b = nullptr;
-  EXPECT_EQ(IREE_STATUS_RESOURCE_EXHAUSTED,
-            iree_vm_stack_function_enter(stack.get(), function_b, &frame_b));
+  EXPECT_EQ(
+      IREE_STATUS_RESOURCE_EXHAUSTED,
+      iree_vm_stack_function_enter(stack.get(), function_b, 0, 0, &frame_b));
 
   // Should still be frame A.
   EXPECT_EQ(0, iree_vm_stack_current_frame(stack.get())->function.ordinal);
@@ -133,11 +140,146 @@ TEST(VMStackTest, StackOverflow) {
   IREE_EXPECT_OK(iree_vm_stack_deinit(stack.get()));
 }
 
+// Tests that frames are allocated from the inline storage first and spill into
+// heap blocks once it is exhausted.
+TEST(VMStackTest, InlineStorageSpill) {
+  auto stack = std::make_unique<iree_vm_stack_t>();
+  iree_vm_state_resolver_t state_resolver = {nullptr, SentinelStateResolver};
+  IREE_ALIGNAS(16) uint8_t frame_storage[IREE_VM_STACK_INLINE_STORAGE_SIZE];
+  IREE_EXPECT_OK(iree_vm_stack_init(
+      iree_byte_span_t{frame_storage, sizeof(frame_storage)}, state_resolver,
+      IREE_ALLOCATOR_SYSTEM, stack.get()));
+
+  iree_vm_function_t function_a = {MODULE_A_SENTINEL,
+                                   IREE_VM_FUNCTION_LINKAGE_INTERNAL, 0};
+  iree_vm_stack_frame_t* frame_0 = nullptr;
+  IREE_EXPECT_OK(
+      iree_vm_stack_function_enter(stack.get(), function_a, 4, 4, &frame_0));
+  EXPECT_GE(reinterpret_cast<uint8_t*>(frame_0), frame_storage);
+  EXPECT_LT(reinterpret_cast<uint8_t*>(frame_0),
+            frame_storage + sizeof(frame_storage));
+
+  // Recurse well past what fits in the inline storage; each frame must keep
+  // its own registers.
+  static const int kDepth = 256;
+  for (int i = 1; i < kDepth; ++i) {
+    iree_vm_stack_frame_t* frame = nullptr;
+    IREE_EXPECT_OK(
+        iree_vm_stack_function_enter(stack.get(), function_a, 4, 4, &frame));
+    frame->registers.i32[0] = i;
+  }
+  for (int i = kDepth - 1; i > 0; --i) {
+    EXPECT_EQ(i, iree_vm_stack_current_frame(stack.get())->registers.i32[0]);
+    IREE_EXPECT_OK(iree_vm_stack_function_leave(stack.get()));
+  }
+  EXPECT_EQ(frame_0, iree_vm_stack_current_frame(stack.get()));
+
+  IREE_EXPECT_OK(iree_vm_stack_deinit(stack.get()));
+}
+
+// Tests that growing the register banks of a frame preserves their contents.
+TEST(VMStackTest, ReserveRegisters) {
+  auto stack = std::make_unique<iree_vm_stack_t>();
+  iree_vm_state_resolver_t state_resolver = {nullptr, SentinelStateResolver};
+  IREE_EXPECT_OK(iree_vm_stack_init(iree_byte_span_t{nullptr, 0},
+                                    state_resolver, IREE_ALLOCATOR_SYSTEM,
+                                    stack.get()));
+
+  iree_vm_function_t function_a = {MODULE_A_SENTINEL,
+                                   IREE_VM_FUNCTION_LINKAGE_INTERNAL, 0};
+  iree_vm_stack_frame_t* frame_a = nullptr;
+  IREE_EXPECT_OK(
+      iree_vm_stack_function_enter(stack.get(), function_a, 2, 0, &frame_a));
+  EXPECT_LE(2, frame_a->registers.i32_register_capacity);
+  frame_a->registers.i32[0] = 100;
+  frame_a->registers.i32[1] = 101;
+
+  // Already large enough; no-op.
+  IREE_EXPECT_OK(
+      iree_vm_stack_frame_reserve_registers(stack.get(), frame_a, 1, 0));
+  EXPECT_EQ(100, frame_a->registers.i32[0]);
+
+  IREE_EXPECT_OK(iree_vm_stack_frame_reserve_registers(
+      stack.get(), frame_a, IREE_I32_REGISTER_COUNT, IREE_REF_REGISTER_COUNT));
+  EXPECT_LE(IREE_I32_REGISTER_COUNT, frame_a->registers.i32_register_capacity);
+  EXPECT_LE(IREE_REF_REGISTER_COUNT, frame_a->registers.ref_register_capacity);
+  EXPECT_EQ(100, frame_a->registers.i32[0]);
+  EXPECT_EQ(101, frame_a->registers.i32[1]);
+
+  IREE_EXPECT_OK(iree_vm_stack_function_leave(stack.get()));
+  IREE_EXPECT_OK(iree_vm_stack_deinit(stack.get()));
+}
+
+// Tests that register banks are sized so that masked register ordinals stay
+// within the frame.
+TEST(VMStackTest, RegisterMasks) {
+  auto stack = std::make_unique<iree_vm_stack_t>();
+  iree_vm_state_resolver_t state_resolver = {nullptr, SentinelStateResolver};
+  IREE_EXPECT_OK(iree_vm_stack_init(iree_byte_span_t{nullptr, 0},
+                                    state_resolver, IREE_ALLOCATOR_SYSTEM,
+                                    stack.get()));
+
+  iree_vm_function_t function_a = {MODULE_A_SENTINEL,
+                                   IREE_VM_FUNCTION_LINKAGE_INTERNAL, 0};
+  iree_vm_stack_frame_t* frame_a = nullptr;
+  IREE_EXPECT_OK(
+      iree_vm_stack_function_enter(stack.get(), function_a, 5, 0, &frame_a));
+  EXPECT_EQ(8, frame_a->registers.i32_register_capacity);
+  EXPECT_EQ(7, frame_a->registers.i32_mask);
+  EXPECT_EQ(1, frame_a->registers.ref_register_capacity);
+  EXPECT_EQ(0, frame_a->registers.ref_mask);
+
+  IREE_EXPECT_OK(iree_vm_stack_frame_reserve_registers(stack.get(), frame_a,
+                                                       9, 33));
+  EXPECT_EQ(16, frame_a->registers.i32_register_capacity);
+  EXPECT_EQ(15, frame_a->registers.i32_mask);
+  EXPECT_EQ(64, frame_a->registers.ref_register_capacity);
+  EXPECT_EQ(IREE_REF_REGISTER_MASK, frame_a->registers.ref_mask);
+
+  IREE_EXPECT_OK(iree_vm_stack_frame_reserve_registers(
+      stack.get(), frame_a, IREE_I32_REGISTER_COUNT, 0));
+  EXPECT_EQ(IREE_I32_REGISTER_MASK, frame_a->registers.i32_mask);
+
+  // A 64-bit value in the last masked register pair stays within the frame.
+  int64_t value = 0x0123456789ABCDEFll;
+  memcpy(&frame_a->registers.i32[0xFF & frame_a->registers.i32_mask], &value,
+         sizeof(value));
+
+  IREE_EXPECT_OK(iree_vm_stack_function_leave(stack.get()));
+  IREE_EXPECT_OK(iree_vm_stack_deinit(stack.get()));
+}
+
+// Tests that only the top-most frame may grow its register banks.
+TEST(VMStackTest, ReserveRegistersNonTopFrame) {
+  auto stack = std::make_unique<iree_vm_stack_t>();
+  iree_vm_state_resolver_t state_resolver = {nullptr, SentinelStateResolver};
+  IREE_EXPECT_OK(iree_vm_stack_init(iree_byte_span_t{nullptr, 0},
+                                    state_resolver, IREE_ALLOCATOR_SYSTEM,
+                                    stack.get()));
+
+  iree_vm_function_t function_a = {MODULE_A_SENTINEL,
+                                   IREE_VM_FUNCTION_LINKAGE_INTERNAL, 0};
+  iree_vm_stack_frame_t* frame_a = nullptr;
+  IREE_EXPECT_OK(
+      iree_vm_stack_function_enter(stack.get(), function_a, 1, 1, &frame_a));
+  iree_vm_stack_frame_t* frame_b = nullptr;
+  IREE_EXPECT_OK(
+      iree_vm_stack_function_enter(stack.get(), function_a, 1, 1, &frame_b));
+
+  EXPECT_EQ(IREE_STATUS_FAILED_PRECONDITION,
+            iree_vm_stack_frame_reserve_registers(stack.get(), frame_a,
+                                                  IREE_I32_REGISTER_COUNT, 1));
+
+  IREE_EXPECT_OK(iree_vm_stack_deinit(stack.get()));
+}
+
 // Tests unbalanced stack popping.
 TEST(VMStackTest, UnbalancedPop) {
   auto stack = std::make_unique<iree_vm_stack_t>();
   iree_vm_state_resolver_t state_resolver = {nullptr, SentinelStateResolver};
-  IREE_EXPECT_OK(iree_vm_stack_init(state_resolver, stack.get()));
+  IREE_EXPECT_OK(iree_vm_stack_init(iree_byte_span_t{nullptr, 0},
+                                    state_resolver, IREE_ALLOCATOR_SYSTEM,
+                                    stack.get()));
 
   EXPECT_EQ(IREE_STATUS_FAILED_PRECONDITION,
             iree_vm_stack_function_leave(stack.get()));
@@ -149,7 +291,9 @@ TEST(VMStackTest, UnbalancedPop) {
 TEST(VMStackTest, ModuleStateQueries) {
   auto stack = std::make_unique<iree_vm_stack_t>();
   iree_vm_state_resolver_t state_resolver = {nullptr, SentinelStateResolver};
-  IREE_EXPECT_OK(iree_vm_stack_init(state_resolver, stack.get()));
+  IREE_EXPECT_OK(iree_vm_stack_init(iree_byte_span_t{nullptr, 0},
+                                    state_resolver, IREE_ALLOCATOR_SYSTEM,
+                                    stack.get()));
 
   EXPECT_EQ(nullptr, iree_vm_stack_current_frame(stack.get()));
   EXPECT_EQ(nullptr, iree_vm_stack_parent_frame(stack.get()));
@@ -162,7 +306,7 @@ TEST(VMStackTest, ModuleStateQueries) {
                                    IREE_VM_FUNCTION_LINKAGE_INTERNAL, 0};
   iree_vm_stack_frame_t* frame_a = nullptr;
   IREE_EXPECT_OK(
-      iree_vm_stack_function_enter(stack.get(), function_a, &frame_a));
+      iree_vm_stack_function_enter(stack.get(), function_a, 0, 0, &frame_a));
   EXPECT_EQ(MODULE_A_STATE_SENTINEL, frame_a->module_state);
   EXPECT_EQ(1, module_a_state_resolve_count);
 
@@ -171,13 +315,13 @@ TEST(VMStackTest, ModuleStateQueries) {
                                    IREE_VM_FUNCTION_LINKAGE_INTERNAL, 1};
   iree_vm_stack_frame_t* frame_b = nullptr;
   IREE_EXPECT_OK(
-      iree_vm_stack_function_enter(stack.get(), function_b, &frame_b));
+      iree_vm_stack_function_enter(stack.get(), function_b, 0, 0, &frame_b));
   EXPECT_EQ(MODULE_B_STATE_SENTINEL, frame_b->module_state);
   EXPECT_EQ(1, module_b_state_resolve_count);
 
   // [A, B, B (reuse)]
   IREE_EXPECT_OK(
-      iree_vm_stack_function_enter(stack.get(), function_b, &frame_b));
+      iree_vm_stack_function_enter(stack.get(), function_b, 0, 0, &frame_b));
   EXPECT_EQ(MODULE_B_STATE_SENTINEL, frame_b->module_state);
   EXPECT_EQ(1, module_b_state_resolve_count);
 
@@ -198,14 +342,17 @@ TEST(VMStackTest, ModuleStateQueryFailure) {
         // NOTE: always failing.
         return IREE_STATUS_INTERNAL;
       }};
-  IREE_EXPECT_OK(iree_vm_stack_init(state_resolver, stack.get()));
+  IREE_EXPECT_OK(iree_vm_stack_init(iree_byte_span_t{nullptr, 0},
+                                    state_resolver, IREE_ALLOCATOR_SYSTEM,
+                                    stack.get()));
 
   // Push should fail if we can't query state, status should propagate.
   iree_vm_function_t function_a = {MODULE_A_SENTINEL,
                                    IREE_VM_FUNCTION_LINKAGE_INTERNAL, 0};
   iree_vm_stack_frame_t* frame_a = nullptr;
-  EXPECT_EQ(IREE_STATUS_INTERNAL,
-            iree_vm_stack_function_enter(stack.get(), function_a, &frame_a));
+  EXPECT_EQ(
+      IREE_STATUS_INTERNAL,
+      iree_vm_stack_function_enter(stack.get(), function_a, 0, 0, &frame_a));
 
   IREE_EXPECT_OK(iree_vm_stack_deinit(stack.get()));
 }
@@ -234,7 +381,9 @@ iree_vm_ref_type_t DummyObject::kTypeID = IREE_VM_REF_TYPE_NULL;
 TEST(VMStackTest, RefRegisterCleanup) {
   auto stack = std::make_unique<iree_vm_stack_t>();
   iree_vm_state_resolver_t state_resolver = {nullptr, SentinelStateResolver};
-  IREE_EXPECT_OK(iree_vm_stack_init(state_resolver, stack.get()));
+  IREE_EXPECT_OK(iree_vm_stack_init(iree_byte_span_t{nullptr, 0},
+                                    state_resolver, IREE_ALLOCATOR_SYSTEM,
+                                    stack.get()));
 
   dummy_object_count = 0;
   DummyObject::RegisterType();
@@ -243,7 +392,7 @@ TEST(VMStackTest, RefRegisterCleanup) {
                                    IREE_VM_FUNCTION_LINKAGE_INTERNAL, 0};
   iree_vm_stack_frame_t* frame_a = nullptr;
   IREE_EXPECT_OK(
-      iree_vm_stack_function_enter(stack.get(), function_a, &frame_a));
+      iree_vm_stack_function_enter(stack.get(), function_a, 0, 1, &frame_a));
   frame_a->registers.ref_register_count = 1;
   memset(&frame_a->registers.ref[0], 0, sizeof(iree_vm_ref_t));
   IREE_EXPECT_OK(iree_vm_ref_wrap_assign(
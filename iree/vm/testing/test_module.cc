@@ -0,0 +1,274 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/vm/testing/test_module.h"
+
+#include <chrono>  // NOLINT
+#include <cstring>
+#include <thread>  // NOLINT
+
+#include "iree/base/api_util.h"
+#include "iree/vm/stack.h"
+
+namespace iree {
+namespace vm {
+namespace testing {
+
+namespace {
+
+enum FunctionOrdinal {
+  kAdd = 0,
+  kYield,
+  kWait,
+  kFail,
+  kExclusive,
+  kNest,
+  kNestFail,
+  kFunctionCount,
+};
+
+struct FunctionInfo {
+  const char* name;
+  iree_vm_function_signature_t signature;
+};
+
+const FunctionInfo kFunctions[kFunctionCount] = {
+    {"add", {2, 1}},   {"yield", {1, 1}},     {"wait", {0, 1}},
+    {"fail", {0, 0}},  {"exclusive", {1, 1}}, {"nest", {1, 1}},
+    {"nest_fail", {1, 0}},
+};
+
+// Returns the value in i32 register 0.
+const uint8_t kResultRegisters[] = {1, 0};
+
+struct ModuleState {
+  // Number of executions in progress within the context.
+  std::atomic<int> active_count{0};
+};
+
+}  // namespace
+
+iree_vm_wait_handle_t TestWaitHandle::handle() {
+  return {this, &TestWaitHandle::Wait, &TestWaitHandle::Notify};
+}
+
+void TestWaitHandle::Signal(iree_status_t status) {
+  std::vector<Notification> notifications;
+  {
+    absl::MutexLock lock(&mutex_);
+    signaled_ = true;
+    status_ = status;
+    notifications.swap(notifications_);
+  }
+  for (auto& notification : notifications) {
+    notification.second(notification.first);
+  }
+}
+
+// static
+iree_status_t TestWaitHandle::Wait(void* self, iree_time_t deadline) {
+  auto* wait_handle = static_cast<TestWaitHandle*>(self);
+  absl::MutexLock lock(&wait_handle->mutex_);
+  if (!wait_handle->mutex_.AwaitWithDeadline(
+          absl::Condition(wait_handle, &TestWaitHandle::IsSignaled),
+          ToAbslTime(deadline))) {
+    return IREE_STATUS_DEADLINE_EXCEEDED;
+  }
+  return wait_handle->status_;
+}
+
+// static
+void TestWaitHandle::Notify(void* self, void* user_data,
+                            void(IREE_API_PTR* fn)(void* user_data)) {
+  auto* wait_handle = static_cast<TestWaitHandle*>(self);
+  {
+    absl::MutexLock lock(&wait_handle->mutex_);
+    if (!wait_handle->signaled_) {
+      wait_handle->notifications_.emplace_back(user_data, fn);
+      return;
+    }
+  }
+  fn(user_data);
+}
+
+TestModule::TestModule(TestWaitHandle* wait_handle)
+    : wait_handle_(wait_handle) {
+  std::memset(&interface_, 0, sizeof(interface_));
+  iree_vm_module_init(&interface_, this);
+  interface_.destroy = &TestModule::Destroy;
+  interface_.name = &TestModule::Name;
+  interface_.signature = &TestModule::Signature;
+  interface_.get_function = &TestModule::GetFunction;
+  interface_.lookup_function = &TestModule::LookupFunctionByName;
+  interface_.alloc_state = &TestModule::AllocState;
+  interface_.free_state = &TestModule::FreeState;
+  interface_.resolve_import = &TestModule::ResolveImport;
+  interface_.execute = &TestModule::Execute;
+}
+
+iree_vm_function_t TestModule::LookupFunction(const char* name) {
+  iree_vm_function_t function = {nullptr, IREE_VM_FUNCTION_LINKAGE_EXPORT, 0};
+  LookupFunctionByName(this, IREE_VM_FUNCTION_LINKAGE_EXPORT,
+                       iree_make_cstring_view(name), &function);
+  return function;
+}
+
+// static
+iree_status_t TestModule::Destroy(void* self) {
+  // Owned by the test.
+  return IREE_STATUS_OK;
+}
+
+// static
+iree_string_view_t TestModule::Name(void* self) {
+  return iree_make_cstring_view("test");
+}
+
+// static
+iree_vm_module_signature_t TestModule::Signature(void* self) {
+  iree_vm_module_signature_t signature = {0, kFunctionCount, 0};
+  return signature;
+}
+
+// static
+iree_status_t TestModule::GetFunction(
+    void* self, iree_vm_function_linkage_t linkage, int32_t ordinal,
+    iree_vm_function_t* out_function, iree_string_view_t* out_name,
+    iree_vm_function_signature_t* out_signature) {
+  if (linkage != IREE_VM_FUNCTION_LINKAGE_EXPORT || ordinal < 0 ||
+      ordinal >= kFunctionCount) {
+    return IREE_STATUS_NOT_FOUND;
+  }
+  auto* module = static_cast<TestModule*>(self);
+  if (out_function) {
+    out_function->module = &module->interface_;
+    out_function->linkage = linkage;
+    out_function->ordinal = ordinal;
+  }
+  if (out_name) *out_name = iree_make_cstring_view(kFunctions[ordinal].name);
+  if (out_signature) *out_signature = kFunctions[ordinal].signature;
+  return IREE_STATUS_OK;
+}
+
+// static
+iree_status_t TestModule::LookupFunctionByName(
+    void* self, iree_vm_function_linkage_t linkage, iree_string_view_t name,
+    iree_vm_function_t* out_function) {
+  for (int i = 0; i < kFunctionCount; ++i) {
+    if (iree_string_view_compare(
+            name, iree_make_cstring_view(kFunctions[i].name)) == 0) {
+      return GetFunction(self, linkage, i, out_function, nullptr, nullptr);
+    }
+  }
+  return IREE_STATUS_NOT_FOUND;
+}
+
+// static
+iree_status_t TestModule::AllocState(
+    void* self, iree_allocator_t allocator,
+    iree_vm_module_state_t** out_module_state) {
+  *out_module_state =
+      reinterpret_cast<iree_vm_module_state_t*>(new ModuleState());
+  return IREE_STATUS_OK;
+}
+
+// static
+iree_status_t TestModule::FreeState(void* self,
+                                    iree_vm_module_state_t* module_state) {
+  delete reinterpret_cast<ModuleState*>(module_state);
+  return IREE_STATUS_OK;
+}
+
+// static
+iree_status_t TestModule::ResolveImport(void* self,
+                                        iree_vm_module_state_t* module_state,
+                                        int32_t ordinal,
+                                        iree_vm_function_t function) {
+  return IREE_STATUS_NOT_FOUND;
+}
+
+// static
+iree_status_t TestModule::Execute(void* self, iree_vm_stack_t* stack,
+                                  iree_vm_stack_frame_t* frame,
+                                  iree_vm_execution_result_t* out_result) {
+  auto* module = static_cast<TestModule*>(self);
+  ++module->execute_count_;
+  std::memset(out_result, 0, sizeof(*out_result));
+  int32_t* i32 = frame->registers.i32;
+  // The frame offset counts the number of times the frame was executed.
+  int64_t resume_count = frame->offset++;
+  switch (frame->function.ordinal) {
+    case kAdd:
+      i32[0] = i32[0] + i32[1];
+      break;
+    case kYield:
+      if (resume_count < i32[0]) {
+        out_result->state = IREE_VM_EXECUTION_YIELDED;
+        return IREE_STATUS_OK;
+      }
+      break;
+    case kWait:
+      if (resume_count == 0) {
+        out_result->state = IREE_VM_EXECUTION_WAITING;
+        out_result->wait_handle = module->wait_handle_->handle();
+        return IREE_STATUS_OK;
+      }
+      i32[0] = 1;
+      break;
+    case kFail:
+      return IREE_STATUS_INTERNAL;
+    case kExclusive: {
+      auto* state = reinterpret_cast<ModuleState*>(frame->module_state);
+      if (state->active_count.fetch_add(1) != 0) ++module->overlap_count_;
+      // Widen the window in which overlapping executions would be observed.
+      std::this_thread::sleep_for(std::chrono::microseconds(10));
+      state->active_count.fetch_sub(1);
+      if (resume_count < i32[0]) {
+        out_result->state = IREE_VM_EXECUTION_YIELDED;
+        return IREE_STATUS_OK;
+      }
+      break;
+    }
+    case kNest:
+    case kNestFail: {
+      // Enters frames using every register so that the stack outgrows its
+      // inline storage after a few levels.
+      int32_t depth = i32[0];
+      for (int32_t i = 0; i < depth; ++i) {
+        iree_vm_stack_frame_t* callee_frame = nullptr;
+        IREE_RETURN_IF_ERROR(iree_vm_stack_function_enter(
+            stack, frame->function, IREE_I32_REGISTER_COUNT,
+            IREE_REF_REGISTER_COUNT, &callee_frame));
+      }
+      // Failures leave the callee frames for the caller to unwind.
+      if (frame->function.ordinal == kNestFail) return IREE_STATUS_INTERNAL;
+      for (int32_t i = 0; i < depth; ++i) {
+        IREE_RETURN_IF_ERROR(iree_vm_stack_function_leave(stack));
+      }
+      break;
+    }
+    default:
+      return IREE_STATUS_NOT_FOUND;
+  }
+  if (kFunctions[frame->function.ordinal].signature.result_count) {
+    frame->return_registers =
+        reinterpret_cast<const iree_vm_register_list_t*>(kResultRegisters);
+  }
+  out_result->state = IREE_VM_EXECUTION_COMPLETED;
+  return IREE_STATUS_OK;
+}
+
+}  // namespace testing
+}  // namespace vm
+}  // namespace iree
@@ -0,0 +1,117 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef IREE_VM_TESTING_TEST_MODULE_H_
+#define IREE_VM_TESTING_TEST_MODULE_H_
+
+#include <atomic>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "iree/base/api.h"
+#include "iree/vm/module.h"
+
+namespace iree {
+namespace vm {
+namespace testing {
+
+// A wait handle that is signaled manually by tests.
+class TestWaitHandle {
+ public:
+  // Returns the C interface of the handle. The handle must outlive all uses.
+  iree_vm_wait_handle_t handle();
+
+  // Signals the handle, completing waits with |status| and issuing any
+  // pending notifications on the calling thread.
+  void Signal(iree_status_t status = IREE_STATUS_OK);
+
+ private:
+  using Notification = std::pair<void*, void(IREE_API_PTR*)(void*)>;
+
+  static iree_status_t IREE_API_PTR Wait(void* self, iree_time_t deadline);
+  static void IREE_API_PTR Notify(void* self, void* user_data,
+                                  void(IREE_API_PTR* fn)(void* user_data));
+
+  bool IsSignaled() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return signaled_;
+  }
+
+  absl::Mutex mutex_;
+  bool signaled_ ABSL_GUARDED_BY(mutex_) = false;
+  iree_status_t status_ ABSL_GUARDED_BY(mutex_) = IREE_STATUS_OK;
+  std::vector<Notification> notifications_ ABSL_GUARDED_BY(mutex_);
+};
+
+// A native module exporting functions that exercise suspension:
+//   add(a, b) -> (a + b)
+//   yield(n) -> (n): yields n times before returning.
+//   wait() -> (1): suspends on |wait_handle| once before returning.
+//   fail() -> (): fails with IREE_STATUS_INTERNAL.
+//   exclusive(n) -> (n): like yield but records whether any other execution
+//       within the same context was in progress at the same time.
+//   nest(n) -> (n): enters and leaves n frames with full register banks.
+//   nest_fail(n) -> (): enters n frames and fails without leaving them.
+//
+// The module is owned by the caller and must outlive all contexts using it.
+class TestModule {
+ public:
+  explicit TestModule(TestWaitHandle* wait_handle);
+
+  iree_vm_module_t* module() { return &interface_; }
+
+  // Returns the exported function named |name|.
+  iree_vm_function_t LookupFunction(const char* name);
+
+  // Total number of calls to execute.
+  int execute_count() const { return execute_count_; }
+
+  // Number of times exclusive() observed another execution in its context.
+  int overlap_count() const { return overlap_count_; }
+
+ private:
+  static iree_status_t IREE_API_PTR Destroy(void* self);
+  static iree_string_view_t IREE_API_PTR Name(void* self);
+  static iree_vm_module_signature_t IREE_API_PTR Signature(void* self);
+  static iree_status_t IREE_API_PTR GetFunction(
+      void* self, iree_vm_function_linkage_t linkage, int32_t ordinal,
+      iree_vm_function_t* out_function, iree_string_view_t* out_name,
+      iree_vm_function_signature_t* out_signature);
+  static iree_status_t IREE_API_PTR LookupFunctionByName(
+      void* self, iree_vm_function_linkage_t linkage, iree_string_view_t name,
+      iree_vm_function_t* out_function);
+  static iree_status_t IREE_API_PTR
+  AllocState(void* self, iree_allocator_t allocator,
+             iree_vm_module_state_t** out_module_state);
+  static iree_status_t IREE_API_PTR
+  FreeState(void* self, iree_vm_module_state_t* module_state);
+  static iree_status_t IREE_API_PTR
+  ResolveImport(void* self, iree_vm_module_state_t* module_state,
+                int32_t ordinal, iree_vm_function_t function);
+  static iree_status_t IREE_API_PTR
+  Execute(void* self, iree_vm_stack_t* stack, iree_vm_stack_frame_t* frame,
+          iree_vm_execution_result_t* out_result);
+
+  iree_vm_module_t interface_;
+  TestWaitHandle* wait_handle_;
+  std::atomic<int> execute_count_{0};
+  std::atomic<int> overlap_count_{0};
+};
+
+}  // namespace testing
+}  // namespace vm
+}  // namespace iree
+
+#endif  // IREE_VM_TESTING_TEST_MODULE_H_
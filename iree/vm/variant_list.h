@@ -72,6 +72,11 @@ IREE_API_EXPORT iree_status_t IREE_API_CALL iree_vm_variant_list_init(
 IREE_API_EXPORT iree_status_t IREE_API_CALL
 iree_vm_variant_list_free(iree_vm_variant_list_t* list);
 
+// Releases all elements in the list and resets its size to 0. The capacity of
+// the list is retained so that it can be reused without reallocation.
+IREE_API_EXPORT void IREE_API_CALL
+iree_vm_variant_list_clear(iree_vm_variant_list_t* list);
+
 // Returns the total number of elements added to the list.
 IREE_API_EXPORT iree_host_size_t IREE_API_CALL
 iree_vm_variant_list_size(const iree_vm_variant_list_t* list);